@@ -0,0 +1,15596 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "snapshot.h"
+#include "cfgparser/parser.h"
+
+#include "measurement.h"
+#include "dfunctions.h"
+#include "instrument.h"
+#include "logging.h"
+
+#include "cupt/parser.h"
+#include "cupt/load.h"
+#include "jsonl/parser.h"
+#include "jsonl/load.h"
+#include "file_queue.h"
+
+// for Python bundle
+#ifndef DEFINE_UNICODE_CONSTANTS
+#define DEFINE_UNICODE_CONSTANTS
+#endif
+#include "unicode/unicode.h"
+
+enum {
+	ID_ENTROPY_SHANNON_WEAVER,
+	ID_ENTROPY_Q_LOGARITHMIC,
+	ID_ENTROPY_PATIL_TAILLIE,
+	ID_ENTROPY_RENYI,
+	ID_ENTROPY_GOOD,
+	ID_INDEX_SIMPSON_DOMINANCE,
+	ID_INDEX_SIMPSON,
+	ID_INDEX_RICHNESS,
+	ID_INDEX_SPECIES_COUNT,
+	ID_INDEX_HILL_EVENNESS,
+	ID_INDEX_SHANNON_EVENNESS,
+	ID_INDEX_BERGER_PARKER,
+	ID_INDEX_JUNGE1994_PAGE22,
+	ID_INDEX_BRILLOUIN,
+	ID_INDEX_MCINTOSH,
+	ID_INDEX_E_HEIP,
+	ID_INDEX_ONE_MINUS_D,
+	ID_INDEX_ONE_OVER_D_WILLIAMS1964,
+	ID_INDEX_E_MINUS_LN_D_PIELOU1977,
+	ID_INDEX_F_2_1_ALATALO1981,
+	ID_INDEX_G_2_1_MOLINARI1989,
+	ID_INDEX_O_BULLA1994,
+	ID_INDEX_E_BULLA1994,
+	ID_INDEX_E_MCI_PIELOU1969,
+	ID_INDEX_E_PRIME_CAMARGO1993,
+	ID_INDEX_E_VAR_SMITH_AND_WILSON1996,
+	ID_INDEX_TYPE_TOKEN_RATIO,
+	ID_DISPARITY_PAIRWISE,
+	ID_DISPARITY_CHAO_ET_AL_FUNCTIONAL,
+	ID_DISPARITY_LEINSTER_COBBOLD,
+	ID_DISPARITY_SCHEINER,
+	ID_DISPARITY_STIRLING,
+	ID_DISPARITY_RICOTTA_SZEIDL,
+	ID_DISPARITY_FUNCTIONAL_EVENNESS,
+	ID_DISPARITY_AGG_MST,
+};
+
+// what a call may use after releasing the GIL; allocated once per graph, so that its address survives the growth of the arrays below
+struct interface_graph_slot {
+	struct graph g;
+	struct minimum_spanning_tree mst;
+	pthread_mutex_t mutex; // guards g and mst; only ever waited for without the GIL, see interface_lock_graph
+	int32_t word2vec_slots_w2v; // word2vec that g->word2vec_slots were built for by ingest_tokens and ingest_documents
+	uint64_t word2vec_slots_num_nodes; // nodes already entered in g->word2vec_slots
+	uint8_t word2vec_slots_bound;
+};
+
+// same for a word2vec, which several graphs and calls may read at once
+struct interface_word2vec_slot {
+	struct word2vec w2v;
+	pthread_rwlock_t lock; // read-held while w2v is used without the GIL, write-held by free_w2v
+};
+
+static uint32_t num_graphs = 0;
+static uint32_t num_graph_slots = 0; // can exceed num_graphs by one after a failed creation
+static struct interface_graph_slot** global_graph_slots = NULL;
+static uint8_t* global_graphs_freed = NULL;
+static int32_t* global_graphs_word2vec_bindings = NULL;
+
+static uint32_t num_w2v = 0;
+static uint8_t* global_w2v_freed = NULL;
+static struct interface_word2vec_slot** global_word2vec_slots = NULL;
+
+static struct cfg* configurations = NULL;
+
+// Python memory a graph points into; it stays acquired until the graph is freed or the matrix is replaced
+struct interface_held_buffers {
+	Py_buffer** vectors; // one per node whose vector was given as a buffer
+	uint64_t num_vectors;
+	uint64_t capacity_vectors;
+	Py_buffer* dist_mat; // NULL unless the distance matrix was attached from a buffer
+};
+
+static struct interface_held_buffers* global_graphs_held_buffers = NULL;
+// number of live array views per graph; while it is not zero, nothing may move or free the memory they show
+static uint32_t* global_graphs_exports = NULL;
+
+// read-only view of memory owned by a graph, exported through the buffer protocol
+struct interface_array_view {
+	PyObject_HEAD
+	PyObject* module; // keeps the module, hence the graph arrays, alive as long as the view
+	void* bfr;
+	Py_ssize_t shape[2];
+	Py_ssize_t strides[2];
+	Py_ssize_t itemsize;
+	int32_t ndim;
+	int32_t graph_index;
+	char format[2];
+};
+
+static int interface_array_view_getbuffer(PyObject* exporter, Py_buffer* view, int flags){
+	struct interface_array_view* const self = (struct interface_array_view*) exporter;
+
+	if((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE){
+		PyErr_SetString(PyExc_BufferError, "graph views are read-only");
+		view->obj = NULL;
+		return -1;
+	}
+
+	Py_ssize_t len = self->itemsize;
+	for(int32_t i = 0 ; i < self->ndim ; i++){len *= self->shape[i];}
+
+	view->buf = self->bfr;
+	view->obj = exporter;
+	Py_INCREF(exporter);
+	view->len = len;
+	view->readonly = 1;
+	view->itemsize = self->itemsize;
+	view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? self->format : NULL;
+	view->ndim = self->ndim;
+	view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? self->shape : NULL;
+	view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+static void interface_array_view_dealloc(PyObject* exporter){
+	struct interface_array_view* const self = (struct interface_array_view*) exporter;
+	global_graphs_exports[self->graph_index]--;
+	Py_XDECREF(self->module);
+	PyObject_Free(exporter);
+}
+
+static PyBufferProcs interface_array_view_buffer_procs = {
+	.bf_getbuffer = interface_array_view_getbuffer,
+	.bf_releasebuffer = NULL,
+};
+
+static PyTypeObject interface_array_view_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "_diversutils._ArrayView",
+	.tp_basicsize = sizeof(struct interface_array_view),
+	.tp_itemsize = 0,
+	.tp_dealloc = interface_array_view_dealloc,
+	.tp_as_buffer = &interface_array_view_buffer_procs,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_doc = "Read-only view of memory owned by a graph.",
+};
+
+// the returned memoryview holds the view, which holds the graph: the graph cannot be reshaped or freed until it is released
+static PyObject* interface_new_array_view(PyObject* const module, const int32_t graph_index, void* const bfr, const int32_t ndim, const Py_ssize_t* const shape, const char format, const Py_ssize_t itemsize){
+	static double empty_bfr = 0.0; // a buffer may not have a NULL pointer, even when empty
+
+	struct interface_array_view* const self = PyObject_New(struct interface_array_view, &interface_array_view_type);
+	if(self == NULL){return NULL;}
+
+	self->module = module;
+	Py_XINCREF(module);
+	self->bfr = (bfr == NULL) ? (void*) &empty_bfr : bfr;
+	self->itemsize = itemsize;
+	self->ndim = ndim;
+	self->graph_index = graph_index;
+	self->format[0] = format;
+	self->format[1] = '\0';
+	for(int32_t i = ndim - 1 ; i >= 0 ; i--){
+		self->shape[i] = shape[i];
+		self->strides[i] = (i == ndim - 1) ? itemsize : self->strides[i + 1] * shape[i + 1];
+	}
+	global_graphs_exports[graph_index]++;
+
+	PyObject* const res = PyMemoryView_FromObject((PyObject*) self);
+	Py_DECREF(self);
+	return res;
+}
+
+static int32_t interface_graph_not_exported(const int32_t index){
+	if(global_graphs_exports[index] != 0){
+		PyErr_Format(PyExc_BufferError, "graph %i has %u live array view(s); release them first", index, global_graphs_exports[index]);
+		return 0;
+	}
+	return 1;
+}
+
+// native-order format character of a buffer, or '\0' when its items are not plain native scalars
+static char interface_buffer_format(const Py_buffer* const view){
+	const char* f = (view->format == NULL) ? "B" : view->format;
+	if(f[0] == '@' || f[0] == '=' || f[0] == (PY_LITTLE_ENDIAN ? '<' : '>')){f++;}
+	if(f[0] == '\0' || f[1] != '\0'){return '\0';}
+	return f[0];
+}
+
+// acquires a C-contiguous buffer of ndim dimensions; the caller releases it with PyBuffer_Release
+static int32_t interface_get_buffer(PyObject* const obj, Py_buffer* const view, const int32_t ndim, const char* const name){
+	if(PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0){
+		// exporters disagree on the exception (NumPy raises ValueError for non-contiguous arrays)
+		if(PyErr_ExceptionMatches(PyExc_BufferError) || PyErr_ExceptionMatches(PyExc_ValueError) || PyErr_ExceptionMatches(PyExc_TypeError)){
+			PyErr_Clear();
+			PyErr_Format(PyExc_BufferError, "%s must be a C-contiguous buffer (e.g. numpy.ascontiguousarray)", name);
+		}
+		return 1;
+	}
+	if(view->ndim != ndim){
+		PyErr_Format(PyExc_BufferError, "%s must have %i dimension(s), not %i", name, ndim, view->ndim);
+		PyBuffer_Release(view);
+		return 1;
+	}
+	return 0;
+}
+
+// FP32 or FP64 according to the item type of a buffer, -1 otherwise
+static int32_t interface_buffer_fp_mode(const Py_buffer* const view){
+	const char format = interface_buffer_format(view);
+	if(format == 'f' && view->itemsize == sizeof(float)){return FP32;}
+	if(format == 'd' && view->itemsize == sizeof(double)){return FP64;}
+	return -1;
+}
+
+// reads item i of a one-dimensional integer buffer; fails on non-integer items and on unsigned values above INT64_MAX
+static int32_t interface_buffer_integer_at(const Py_buffer* const view, const Py_ssize_t i, const char* const name, int64_t* const value){
+	const char format = interface_buffer_format(view);
+	const char* const item = ((const char*) view->buf) + i * view->itemsize;
+
+	if(format == '\0' || strchr("bBhHiIlLqQ", format) == NULL){
+		PyErr_Format(PyExc_BufferError, "%s must be integers", name);
+		return 1;
+	}
+	const uint8_t is_signed = (format >= 'a' && format <= 'z');
+	// buffers only promise byte alignment
+	switch(view->itemsize){
+		case 1: {
+			uint8_t u; memcpy(&u, item, 1);
+			*value = is_signed ? (int64_t) ((int8_t) u) : (int64_t) u;
+			break;
+		}
+		case 2: {
+			uint16_t u; memcpy(&u, item, 2);
+			*value = is_signed ? (int64_t) ((int16_t) u) : (int64_t) u;
+			break;
+		}
+		case 4: {
+			uint32_t u; memcpy(&u, item, 4);
+			*value = is_signed ? (int64_t) ((int32_t) u) : (int64_t) u;
+			break;
+		}
+		case 8: {
+			uint64_t u; memcpy(&u, item, 8);
+			if(!is_signed && u > INT64_MAX){
+				PyErr_Format(PyExc_ValueError, "%s at index %zd is too large", name, i);
+				return 1;
+			}
+			*value = (int64_t) u;
+			break;
+		}
+		default:
+			PyErr_Format(PyExc_BufferError, "%s have an unsupported item size", name);
+			return 1;
+	}
+	return 0;
+}
+
+static int32_t interface_buffer_count_at(const Py_buffer* const view, const Py_ssize_t i, uint64_t* const count){
+	int64_t value;
+	if(interface_buffer_integer_at(view, i, "counts", &value) != 0){return 1;}
+	if(value < 0){
+		PyErr_Format(PyExc_ValueError, "count at index %zd is negative", i);
+		return 1;
+	}
+	*count = (uint64_t) value;
+	return 0;
+}
+
+static int32_t interface_hold_vector_buffer(const int32_t index, Py_buffer* const view){
+	struct interface_held_buffers* const held = &(global_graphs_held_buffers[index]);
+	if(held->num_vectors == held->capacity_vectors){
+		const uint64_t capacity = (held->capacity_vectors == 0) ? 16 : held->capacity_vectors * 2;
+		Py_buffer** const vectors = realloc(held->vectors, capacity * sizeof(Py_buffer*));
+		if(vectors == NULL){return 1;}
+		held->vectors = vectors;
+		held->capacity_vectors = capacity;
+	}
+	held->vectors[held->num_vectors] = view;
+	held->num_vectors++;
+	return 0;
+}
+
+// the MST and its heap are derived from the nodes and the distance matrix, so they go whenever either changes
+static void interface_reset_mst(const int32_t index){
+	if(global_graph_slots[index]->mst.heap != NULL){
+		free_graph_distance_heap(global_graph_slots[index]->mst.heap);
+		free(global_graph_slots[index]->mst.heap);
+	}
+	free_minimum_spanning_tree(&global_graph_slots[index]->mst);
+}
+
+static void interface_release_distance_matrix(const int32_t index){
+	struct graph* const g = &(global_graph_slots[index]->g);
+	Py_buffer* const view = global_graphs_held_buffers[index].dist_mat;
+	if(view != NULL){
+		free(g->dist_mat.active);
+		free(g->dist_mat.active_final);
+		PyBuffer_Release(view);
+		free(view);
+		global_graphs_held_buffers[index].dist_mat = NULL;
+		g->dist_mat = (struct matrix) { .fp_mode = g->dist_mat.fp_mode, };
+	} else if(g->dist_mat_must_be_freed){
+		free_matrix(&(g->dist_mat));
+		g->dist_mat = (struct matrix) { .fp_mode = g->dist_mat.fp_mode, };
+	}
+	g->dist_mat_must_be_freed = 0;
+}
+
+static void interface_release_held_buffers(const int32_t index){
+	struct interface_held_buffers* const held = &(global_graphs_held_buffers[index]);
+	interface_release_distance_matrix(index);
+	for(uint64_t i = 0 ; i < held->num_vectors ; i++){
+		PyBuffer_Release(held->vectors[i]);
+		free(held->vectors[i]);
+	}
+	free(held->vectors);
+	memset(held, '\0', sizeof(struct interface_held_buffers));
+}
+
+// grows the per-graph arrays by one zeroed slot, at index num_graphs
+static int32_t interface_append_graph_slot(void){
+	size_t alloc_size;
+
+	// a slot left by a failed creation is reused as it is
+	if(num_graph_slots == num_graphs){
+		alloc_size = (num_graphs + 1) * sizeof(struct interface_graph_slot*);
+		global_graph_slots = realloc(global_graph_slots, alloc_size);
+		if(global_graph_slots == NULL){return 1;}
+		struct interface_graph_slot* const slot = calloc(1, sizeof(struct interface_graph_slot));
+		if(slot == NULL){return 1;}
+		if(pthread_mutex_init(&(slot->mutex), NULL) != 0){free(slot); return 1;}
+		global_graph_slots[num_graphs] = slot;
+		num_graph_slots++;
+	}
+	memset(&(global_graph_slots[num_graphs]->g), '\0', sizeof(struct graph));
+	memset(&(global_graph_slots[num_graphs]->mst), '\0', sizeof(struct minimum_spanning_tree));
+
+	alloc_size = (num_graphs + 1) * sizeof(uint8_t);
+	global_graphs_freed = realloc(global_graphs_freed, alloc_size);
+	if(global_graphs_freed == NULL){return 1;}
+	memset((void*) &(global_graphs_freed[num_graphs]), '\0', sizeof(uint8_t));
+
+	alloc_size = (num_graphs + 1) * sizeof(int32_t);
+	global_graphs_word2vec_bindings = realloc(global_graphs_word2vec_bindings, alloc_size);
+	if(global_graphs_word2vec_bindings == NULL){return 1;}
+	global_graphs_word2vec_bindings[num_graphs] = -1;
+
+	alloc_size = (num_graphs + 1) * sizeof(struct cfg);
+	configurations = realloc(configurations, alloc_size);
+	if(configurations == NULL){return 1;}
+	memset((void*) &(configurations[num_graphs]), '\0', sizeof(struct cfg));
+
+	alloc_size = (num_graphs + 1) * sizeof(struct interface_held_buffers);
+	global_graphs_held_buffers = realloc(global_graphs_held_buffers, alloc_size);
+	if(global_graphs_held_buffers == NULL){return 1;}
+	memset((void*) &(global_graphs_held_buffers[num_graphs]), '\0', sizeof(struct interface_held_buffers));
+
+	alloc_size = (num_graphs + 1) * sizeof(uint32_t);
+	global_graphs_exports = realloc(global_graphs_exports, alloc_size);
+	if(global_graphs_exports == NULL){return 1;}
+	global_graphs_exports[num_graphs] = 0;
+
+	return 0;
+}
+
+// the GIL is released while waiting for the mutex, since the thread holding it may itself be waiting for the GIL
+static struct interface_graph_slot* interface_lock_graph_slot(const int32_t index){
+	if(index < 0){PyErr_SetString(PyExc_Exception, "index must be >= 0"); return NULL;}
+	if(((uint32_t) index) >= num_graphs){PyErr_SetString(PyExc_Exception, "index too high"); return NULL;}
+
+	struct interface_graph_slot* const slot = global_graph_slots[index];
+	Py_BEGIN_ALLOW_THREADS
+	pthread_mutex_lock(&(slot->mutex));
+	Py_END_ALLOW_THREADS
+	return slot;
+}
+
+// same as interface_lock_graph_slot, but fails on a freed graph
+static struct interface_graph_slot* interface_lock_graph(const int32_t index){
+	struct interface_graph_slot* const slot = interface_lock_graph_slot(index);
+	if(slot == NULL){return NULL;}
+	if(global_graphs_freed[index]){
+		pthread_mutex_unlock(&(slot->mutex));
+		PyErr_SetString(PyExc_Exception, "graph already freed");
+		return NULL;
+	}
+	return slot;
+}
+
+static void interface_unlock_graph(struct interface_graph_slot* const slot){
+	pthread_mutex_unlock(&(slot->mutex));
+}
+
+// read-locks a word2vec for as long as a call uses it; same rule as interface_lock_graph_slot for the GIL
+static struct interface_word2vec_slot* interface_read_lock_w2v(const int32_t index){
+	if(index < 0){PyErr_SetString(PyExc_Exception, "index_w2v must be >= 0"); return NULL;}
+	if(((uint32_t) index) >= num_w2v){PyErr_SetString(PyExc_Exception, "index_w2v too high"); return NULL;}
+
+	struct interface_word2vec_slot* const slot = global_word2vec_slots[index];
+	Py_BEGIN_ALLOW_THREADS
+	pthread_rwlock_rdlock(&(slot->lock));
+	Py_END_ALLOW_THREADS
+	if(global_w2v_freed[index]){
+		pthread_rwlock_unlock(&(slot->lock));
+		PyErr_SetString(PyExc_Exception, "w2v already freed");
+		return NULL;
+	}
+	return slot;
+}
+
+static void interface_unlock_w2v(struct interface_word2vec_slot* const slot){
+	pthread_rwlock_unlock(&(slot->lock));
+}
+
+/* // DO NOT REMOVE
+static PyObject* interface_measurement_from_cfg(PyObject* self, PyObject* args){
+	char* config_path;
+
+	if(!PyArg_ParseTuple(args, "s", &config_path)){
+		return NULL;
+	}
+
+	struct cfg c;
+	if(create_cfg_from_file(&c, config_path) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call create_cfg_from_file\n");
+		return NULL;
+	}
+
+	if(measurement_from_cfg(&c) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call measurement_from_cfg\n");
+		return NULL;
+	}
+
+	PyObject* res;
+	res = Py_BuildValue("i", 0);
+	return res;
+}
+*/
+
+static PyObject* interface_create_empty_graph(PyObject* self, PyObject* args){
+    (void) self;
+
+	PyObject* res;
+	int32_t num_nodes;
+	int32_t num_dimensions;
+
+	if(!PyArg_ParseTuple(args, "ii", &num_nodes, &num_dimensions)){
+		return NULL;
+	}
+
+	if(interface_append_graph_slot() != 0){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
+
+	if(create_graph(&(global_graph_slots[num_graphs]->g), num_nodes, (int16_t) num_dimensions, FP32) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call create_graph\n");
+		goto exit_failure;
+	}
+
+	res = Py_BuildValue("i", num_graphs);
+
+	num_graphs++;
+
+	return res;
+
+	exit_failure:
+	res = Py_BuildValue("i", -1);
+	return res;
+}
+
+static PyObject* interface_create_graph(PyObject* self, PyObject* args){
+    (void) self;
+
+	PyObject* res;
+	int32_t num_nodes;
+	int32_t num_dimensions;
+	char* config_path;
+
+	if(!PyArg_ParseTuple(args, "iis", &num_nodes, &num_dimensions, &config_path)){
+		return NULL;
+	}
+
+	if(interface_append_graph_slot() != 0){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
+
+	if(create_graph(&(global_graph_slots[num_graphs]->g), num_nodes, (int16_t) num_dimensions, FP32) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call create_graph\n");
+		goto exit_failure;
+	}
+
+	if(create_cfg_from_file(&(configurations[num_graphs]), config_path) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call create_cfg_from_file\n");
+		goto exit_failure;
+	}
+
+	res = Py_BuildValue("i", num_graphs);
+
+	num_graphs++;
+
+	return res;
+
+	exit_failure:
+	res = Py_BuildValue("i", -1);
+	return res;
+}
+
+static PyObject* interface_free_graph(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+
+	if(!PyArg_ParseTuple(args, "i", &index)){
+		return NULL;
+	}
+
+	if(index >= 0 && ((uint32_t) index) < num_graphs && !interface_graph_not_exported(index)){return NULL;}
+
+	// the slot itself stays, so that calls waiting for its mutex find the graph freed
+	struct interface_graph_slot* const slot = interface_lock_graph_slot(index);
+	if(slot == NULL){return NULL;}
+
+	if(global_graphs_freed[index] == 0){
+		interface_reset_mst(index);
+		interface_release_held_buffers(index);
+		free_graph(&(slot->g));
+		free_cfg(&(configurations[index]));
+		global_graphs_freed[index] = 1;
+	} else {
+		printf("graph already freed\n");
+	}
+	interface_unlock_graph(slot);
+
+	PyObject* res = Py_BuildValue("i", 0);
+
+	return res;
+}
+
+static PyObject* interface_free_w2v(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+
+	if(!PyArg_ParseTuple(args, "i", &index)){
+		return NULL;
+	}
+
+	if(index < 0){
+		PyErr_SetString(PyExc_Exception, "index must be >= 0\n");
+		return NULL;
+	}
+	if(((uint32_t) index) >= num_w2v){
+		PyErr_SetString(PyExc_Exception, "index too high\n");
+		return NULL;
+	}
+
+	// waits for every call still reading the vectors
+	struct interface_word2vec_slot* const slot = global_word2vec_slots[index];
+	Py_BEGIN_ALLOW_THREADS
+	pthread_rwlock_wrlock(&(slot->lock));
+	Py_END_ALLOW_THREADS
+
+	if(global_w2v_freed[index] == 0){
+		printf("trying to free\n");
+		free_word2vec(&(slot->w2v));
+		global_w2v_freed[index] = 1;
+	} else {
+		printf("w2v already freed\n");
+	}
+	pthread_rwlock_unlock(&(slot->lock));
+
+	PyObject* res = Py_BuildValue("i", 0);
+
+	return res;
+}
+
+static PyObject* interface_load_w2v(PyObject* self, PyObject* args){
+    (void) self;
+
+	char* w2v_path;
+	size_t alloc_size;
+	PyObject* res;
+	int32_t err;
+
+	if(!PyArg_ParseTuple(args, "s", &w2v_path)){
+		return NULL;
+	}
+
+	struct interface_word2vec_slot* const slot = calloc(1, sizeof(struct interface_word2vec_slot));
+	if(slot == NULL){PyErr_SetString(PyExc_Exception, "failed to calloc\n"); goto exit_failure;}
+	if(pthread_rwlock_init(&(slot->lock), NULL) != 0){free(slot); PyErr_SetString(PyExc_Exception, "failed to call pthread_rwlock_init\n"); goto exit_failure;}
+
+	// the slot is published only once loaded, so that nothing else can see it in the meantime
+	Py_BEGIN_ALLOW_THREADS
+	err = load_word2vec_binary(&(slot->w2v), w2v_path);
+	Py_END_ALLOW_THREADS
+	if(err != 0){
+		pthread_rwlock_destroy(&(slot->lock));
+		free(slot);
+		PyErr_SetString(PyExc_Exception, "failed to call load_word2vec_binary\n");
+		return NULL;
+	}
+
+	alloc_size = (num_w2v + 1) * sizeof(struct interface_word2vec_slot*);
+	global_word2vec_slots = realloc(global_word2vec_slots, alloc_size);
+	if(global_word2vec_slots == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
+	global_word2vec_slots[num_w2v] = slot;
+
+	alloc_size = (num_w2v + 1) * sizeof(uint8_t);
+	global_w2v_freed = realloc(global_w2v_freed, alloc_size);
+	if(global_w2v_freed == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
+	memset((void*) &(global_w2v_freed[num_w2v]), '\0', sizeof(uint8_t));
+
+	res = Py_BuildValue("i", num_w2v);
+
+	num_w2v++;
+
+	return res;
+
+	exit_failure:
+	res = Py_BuildValue("i", -1);
+	return res;
+}
+
+static PyObject* interface_bind_w2v(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index_g, index_w2v;
+
+	if(!PyArg_ParseTuple(args, "ii", &index_g, &index_w2v)){
+		return NULL;
+	}
+
+	if(index_g < 0){PyErr_SetString(PyExc_Exception, "index_g must be >= 0\n"); return NULL;}
+	if(((uint32_t) index_g) >= num_graphs){PyErr_SetString(PyExc_Exception, "index_g too high\n"); return NULL;}
+	if(index_w2v < 0){PyErr_SetString(PyExc_Exception, "index_w2v must be >= 0\n"); return NULL;}
+	if(((uint32_t) index_w2v) >= num_w2v){PyErr_SetString(PyExc_Exception, "index_w2v too high\n"); return NULL;}
+
+	global_graphs_word2vec_bindings[index_g] = index_w2v;
+	
+	printf("connected graph %i and w2v %i\n", index_g, index_w2v);
+
+	return Py_BuildValue("i", 0);
+}
+
+static PyObject* interface_add_node(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+	long long absolute_proportion;
+	PyObject* key_or_vector;
+	char* key;
+	int32_t w2v_index;
+
+	struct word2vec_entry* word2vec_entry_pointer;
+	float* vector_pointer;
+	Py_buffer* vector_view;
+	struct interface_word2vec_slot* w2v_slot;
+
+	key_or_vector = NULL;
+	key = NULL;
+
+	if(!PyArg_ParseTuple(args, "iL|O", &index, &absolute_proportion, &key_or_vector)){return NULL;}
+	if(absolute_proportion < 0){PyErr_SetString(PyExc_Exception, "absolute proportion cannot be negative\n"); return NULL;}
+
+	word2vec_entry_pointer = NULL;
+	vector_pointer = NULL;
+	vector_view = NULL;
+	w2v_slot = NULL;
+
+	if(key_or_vector != NULL && key_or_vector != Py_None && PyUnicode_Check(key_or_vector)){
+		key = (char*) PyUnicode_AsUTF8(key_or_vector);
+		if(key == NULL){return NULL;}
+	} else if(key_or_vector != NULL && key_or_vector != Py_None){
+		// the node reads the vector where the caller keeps it; the buffer is held until the graph is freed
+		vector_view = malloc(sizeof(Py_buffer));
+		if(vector_view == NULL){PyErr_NoMemory(); return NULL;}
+		if(interface_get_buffer(key_or_vector, vector_view, 1, "vector") != 0){free(vector_view); return NULL;}
+	}
+
+	// buffers are acquired before the lock, since an exporter may run Python code
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){goto release_vector;}
+	if(!interface_graph_not_exported(index)){goto unlock;}
+
+	if(key != NULL){
+		if(global_graphs_word2vec_bindings[index] < 0){PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); goto unlock;}
+		w2v_slot = interface_read_lock_w2v(global_graphs_word2vec_bindings[index]);
+		if(w2v_slot == NULL){goto unlock;}
+		w2v_index = word2vec_key_to_index(&(w2v_slot->w2v), key);
+		if(w2v_index == -1){
+            #ifndef NDEBUG
+			fprintf(stdout, "unknown key: %s\n", key);
+            #endif
+			PyErr_Format(PyExc_KeyError, "unknown key: %s", key);
+			goto unlock;
+		}
+		word2vec_entry_pointer = &(w2v_slot->w2v.keys[w2v_index]);
+		vector_pointer = w2v_slot->w2v.keys[w2v_index].vector;
+	} else if(vector_view != NULL){
+		if(interface_buffer_fp_mode(vector_view) != FP32 || vector_view->shape[0] != slot->g.num_dimensions || slot->g.num_dimensions <= 0){
+			PyErr_Format(PyExc_BufferError, "vector must hold %i float32 values", slot->g.num_dimensions);
+			goto unlock;
+		}
+		vector_pointer = (float*) vector_view->buf;
+	}
+
+	struct graph_node local_node = {0};
+	uint64_t node_index;
+	if(create_graph_node(&local_node, slot->g.num_dimensions, FP32) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call create_graph_node\n");
+		goto unlock;
+	}
+	local_node.absolute_proportion = (uint64_t) absolute_proportion;
+	local_node.word2vec_entry_pointer = word2vec_entry_pointer;
+	local_node.vector.fp32 = vector_pointer;
+	local_node.num_dimensions = slot->g.num_dimensions;
+
+	if(vector_view != NULL && interface_hold_vector_buffer(index, vector_view) != 0){
+		PyErr_NoMemory();
+		goto unlock;
+	}
+	vector_view = NULL;
+
+	if(graph_append_node(&(slot->g), &local_node, &node_index) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call graph_append_node\n");
+		goto unlock;
+	}
+
+	// an owned distance matrix and the MST are extended to the new nodes by the next measure that reads them
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	interface_unlock_graph(slot);
+
+	PyObject* res = Py_BuildValue("i", 0);
+
+	return res;
+
+	unlock:
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	interface_unlock_graph(slot);
+	release_vector:
+	if(vector_view != NULL){
+		PyBuffer_Release(vector_view);
+		free(vector_view);
+	}
+	return NULL;
+}
+
+static PyObject* interface_set_counts(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+	PyObject* counts;
+	Py_buffer view;
+
+	if(!PyArg_ParseTuple(args, "iO", &index, &counts)){return NULL;}
+
+	if(interface_get_buffer(counts, &view, 1, "counts") != 0){return NULL;}
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){PyBuffer_Release(&view); return NULL;}
+
+	struct graph* const g = &(slot->g);
+
+	if((uint64_t) view.shape[0] != g->num_nodes){
+		PyErr_Format(PyExc_BufferError, "counts must hold one value per node (%lu), not %zd", (unsigned long) g->num_nodes, view.shape[0]);
+		goto failure;
+	}
+
+	// every value is checked before the first one is written, so that a bad buffer leaves the graph as it was
+	for(Py_ssize_t i = 0 ; i < view.shape[0] ; i++){
+		uint64_t count;
+		if(interface_buffer_count_at(&view, i, &count) != 0){goto failure;}
+	}
+	for(Py_ssize_t i = 0 ; i < view.shape[0] ; i++){
+		interface_buffer_count_at(&view, i, &(graph_node_at(g, (uint64_t) i)->absolute_proportion));
+	}
+	graph_snapshot_mark_stale(g);
+	interface_unlock_graph(slot);
+	PyBuffer_Release(&view);
+
+	return Py_BuildValue("i", 0);
+
+	failure:
+	interface_unlock_graph(slot);
+	PyBuffer_Release(&view);
+	return NULL;
+}
+
+static PyObject* interface_add_nodes(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+	PyObject* vectors = Py_None;
+	PyObject* counts = NULL;
+	PyObject* keys = Py_None;
+	PyObject* keys_fast = NULL;
+	Py_buffer* vectors_view = NULL;
+	Py_buffer counts_view;
+	struct graph_node* nodes = NULL;
+	uint64_t first_index;
+	struct interface_graph_slot* slot = NULL;
+	struct interface_word2vec_slot* w2v_slot = NULL;
+
+	if(!PyArg_ParseTuple(args, "iOO|O", &index, &vectors, &counts, &keys)){return NULL;}
+
+	// buffers and keys are acquired before the lock, since they may run Python code
+	if(interface_get_buffer(counts, &counts_view, 1, "counts") != 0){return NULL;}
+	const Py_ssize_t n = counts_view.shape[0];
+
+	if(vectors != Py_None){
+		vectors_view = malloc(sizeof(Py_buffer));
+		if(vectors_view == NULL){PyErr_NoMemory(); goto failure;}
+		if(interface_get_buffer(vectors, vectors_view, 2, "vectors") != 0){free(vectors_view); vectors_view = NULL; goto failure;}
+	}
+
+	if(keys != Py_None){
+		keys_fast = PySequence_Fast(keys, "keys must be a sequence of str");
+		if(keys_fast == NULL){goto failure;}
+		if(PySequence_Fast_GET_SIZE(keys_fast) != n){
+			PyErr_Format(PyExc_ValueError, "keys must hold one key per node (%zd), not %zd", n, PySequence_Fast_GET_SIZE(keys_fast));
+			goto failure;
+		}
+	}
+
+	slot = interface_lock_graph(index);
+	if(slot == NULL){goto failure;}
+	if(!interface_graph_not_exported(index)){goto failure;}
+
+	struct graph* const g = &(slot->g);
+
+	if(vectors_view != NULL && (interface_buffer_fp_mode(vectors_view) != FP32 || vectors_view->shape[0] != n || vectors_view->shape[1] != g->num_dimensions || g->num_dimensions <= 0)){
+		PyErr_Format(PyExc_BufferError, "vectors must be float32 of shape (%zd, %i)", n, g->num_dimensions);
+		goto failure;
+	}
+	if(keys_fast != NULL){
+		if(global_graphs_word2vec_bindings[index] < 0){PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); goto failure;}
+		w2v_slot = interface_read_lock_w2v(global_graphs_word2vec_bindings[index]);
+		if(w2v_slot == NULL){goto failure;}
+	}
+
+	nodes = malloc((n > 0 ? (size_t) n : 1) * sizeof(struct graph_node));
+	if(nodes == NULL){PyErr_NoMemory(); goto failure;}
+
+	// every node is built and checked before the first one is appended, so that a bad input leaves the graph as it was
+	for(Py_ssize_t i = 0 ; i < n ; i++){
+		struct graph_node* const node = &(nodes[i]);
+		uint64_t count;
+		memset(node, '\0', sizeof(struct graph_node));
+		if(interface_buffer_count_at(&counts_view, i, &count) != 0){goto failure;}
+		if(create_graph_node(node, g->num_dimensions, FP32) != 0){
+			PyErr_SetString(PyExc_Exception, "failed to call create_graph_node\n");
+			goto failure;
+		}
+		node->absolute_proportion = count;
+		node->num_dimensions = g->num_dimensions;
+		node->vector.fp32 = NULL;
+		if(keys_fast != NULL){
+			struct word2vec* const w2v = &(w2v_slot->w2v);
+			const char* const key = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(keys_fast, i));
+			if(key == NULL){goto failure;}
+			const int32_t w2v_index = word2vec_key_to_index(w2v, (char*) key);
+			if(w2v_index == -1){
+				PyErr_Format(PyExc_KeyError, "unknown key at index %zd: %s", i, key);
+				goto failure;
+			}
+			node->word2vec_entry_pointer = &(w2v->keys[w2v_index]);
+			node->vector.fp32 = w2v->keys[w2v_index].vector;
+		}
+		if(vectors_view != NULL){
+			node->vector.fp32 = ((float*) vectors_view->buf) + i * g->num_dimensions;
+		}
+	}
+
+	if(vectors_view != NULL && interface_hold_vector_buffer(index, vectors_view) != 0){PyErr_NoMemory(); goto failure;}
+	if(graph_append_nodes(g, nodes, (uint64_t) n, &first_index) != 0){
+		// the vectors stay held with the graph, which is harmless
+		vectors_view = NULL;
+		PyErr_SetString(PyExc_Exception, "failed to call graph_append_nodes\n");
+		goto failure;
+	}
+	vectors_view = NULL;
+
+	// an owned distance matrix and the MST are extended to the new nodes by the next measure that reads them
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	interface_unlock_graph(slot);
+	free(nodes);
+	Py_XDECREF(keys_fast);
+	PyBuffer_Release(&counts_view);
+
+	return Py_BuildValue("K", (unsigned long long) first_index);
+
+	failure:
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	if(slot != NULL){interface_unlock_graph(slot);}
+	free(nodes);
+	Py_XDECREF(keys_fast);
+	if(vectors_view != NULL){
+		PyBuffer_Release(vectors_view);
+		free(vectors_view);
+	}
+	PyBuffer_Release(&counts_view);
+	return NULL;
+}
+
+static PyObject* interface_update_counts(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+	PyObject* indices;
+	PyObject* deltas;
+	Py_buffer indices_view;
+	Py_buffer deltas_view;
+	Py_ssize_t num_applied = 0;
+	int32_t result = 1;
+
+	if(!PyArg_ParseTuple(args, "iOO", &index, &indices, &deltas)){return NULL;}
+
+	if(interface_get_buffer(indices, &indices_view, 1, "indices") != 0){return NULL;}
+	if(interface_get_buffer(deltas, &deltas_view, 1, "deltas") != 0){PyBuffer_Release(&indices_view); return NULL;}
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){
+		PyBuffer_Release(&indices_view);
+		PyBuffer_Release(&deltas_view);
+		return NULL;
+	}
+
+	struct graph* const g = &(slot->g);
+
+	if(indices_view.shape[0] != deltas_view.shape[0]){
+		PyErr_Format(PyExc_ValueError, "indices and deltas differ in length (%zd and %zd)", indices_view.shape[0], deltas_view.shape[0]);
+		goto release;
+	}
+
+	// indices may repeat, so the deltas are applied in order and undone if one of them would leave [0, INT64_MAX], the range of the counts given by Python
+	for(num_applied = 0 ; num_applied < indices_view.shape[0] ; num_applied++){
+		int64_t node_index;
+		int64_t delta;
+		if(interface_buffer_integer_at(&indices_view, num_applied, "indices", &node_index) != 0 || interface_buffer_integer_at(&deltas_view, num_applied, "deltas", &delta) != 0){goto rollback;}
+		if(node_index < 0 || (uint64_t) node_index >= g->num_nodes){
+			PyErr_Format(PyExc_IndexError, "node index %lld at position %zd is out of range", (long long) node_index, num_applied);
+			goto rollback;
+		}
+		struct graph_node* const node = graph_node_at(g, (uint64_t) node_index);
+		const int64_t count = (int64_t) node->absolute_proportion;
+		if(delta < -count || delta > INT64_MAX - count){
+			PyErr_Format(PyExc_ValueError, "delta at position %zd would take the count of node %lld outside [0, %lld]", num_applied, (long long) node_index, (long long) INT64_MAX);
+			goto rollback;
+		}
+		node->absolute_proportion = (uint64_t) (count + delta);
+	}
+	graph_snapshot_mark_stale(g);
+	result = 0;
+	goto release;
+
+	rollback:
+	// entries before num_applied were read and applied successfully already
+	for(Py_ssize_t i = num_applied - 1 ; i >= 0 ; i--){
+		int64_t node_index;
+		int64_t delta;
+		interface_buffer_integer_at(&indices_view, i, "indices", &node_index);
+		interface_buffer_integer_at(&deltas_view, i, "deltas", &delta);
+		struct graph_node* const node = graph_node_at(g, (uint64_t) node_index);
+		node->absolute_proportion = (uint64_t) (((int64_t) node->absolute_proportion) - delta);
+	}
+
+	release:
+	interface_unlock_graph(slot);
+	PyBuffer_Release(&indices_view);
+	PyBuffer_Release(&deltas_view);
+	if(result != 0){return NULL;}
+	return Py_BuildValue("i", 0);
+}
+
+static PyObject* interface_compute_relative_proportions(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "num_threads", NULL};
+	int32_t index;
+	int32_t num_threads = 1;
+	int32_t err;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "i|i", kwlist, &index, &num_threads)){
+		return NULL;
+	}
+	if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+
+	Py_BEGIN_ALLOW_THREADS
+	err = graph_snapshot_refresh(&(slot->g), 0, (int16_t) num_threads);
+	Py_END_ALLOW_THREADS
+	interface_unlock_graph(slot);
+
+	if(err != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call compute_graph_relative_proportions");
+		return NULL;
+	}
+
+	PyObject* res = Py_BuildValue("i", 0);
+
+	return res;
+}
+
+static PyObject* interface__attach_distance_matrix(PyObject* self, PyObject* args){
+    (void) self;
+
+    int32_t index = -1;
+    PyObject* matrix = NULL;
+    Py_buffer* view = NULL;
+    int32_t fp_mode;
+
+    if(!PyArg_ParseTuple(args, "iO", &index, &matrix)){
+        return NULL;
+    }
+
+    view = malloc(sizeof(Py_buffer));
+    if(view == NULL){return PyErr_NoMemory();}
+    if(interface_get_buffer(matrix, view, 2, "distance matrix") != 0){free(view); return NULL;}
+
+    struct interface_graph_slot* const slot = interface_lock_graph(index);
+    if(slot == NULL){PyBuffer_Release(view); free(view); return NULL;}
+    if(!interface_graph_not_exported(index)){goto release_view;}
+
+    struct graph* const g = &(slot->g);
+    const size_t num_nodes = (size_t) g->num_nodes;
+
+    fp_mode = interface_buffer_fp_mode(view);
+    if(fp_mode == -1){
+        PyErr_SetString(PyExc_BufferError, "distance matrix must hold float32 or float64 values");
+        goto release_view;
+    }
+    if((size_t) view->shape[0] != num_nodes || (size_t) view->shape[1] != num_nodes){
+        PyErr_Format(PyExc_BufferError, "distance matrix must be %lu x %lu, not %zd x %zd", (unsigned long) num_nodes, (unsigned long) num_nodes, view->shape[0], view->shape[1]);
+        goto release_view;
+    }
+
+    // only the flags the MST walk sets are allocated; the distances are read in place
+    uint8_t* const active = calloc(num_nodes * num_nodes + 1, sizeof(uint8_t));
+    uint8_t* const active_final = calloc(num_nodes * num_nodes + 1, sizeof(uint8_t));
+    if(active == NULL || active_final == NULL){
+        free(active);
+        free(active_final);
+        PyErr_NoMemory();
+        goto release_view;
+    }
+
+    #ifndef NDEBUG
+    printf("index: %i; bfr: %p; fp_mode: %i; bfr_size: %zd\n", index, view->buf, fp_mode, view->len);
+    #endif
+
+    interface_reset_mst(index);
+    interface_release_distance_matrix(index);
+
+    g->dist_mat = (struct matrix) {
+        .active = active,
+        .active_final = active_final,
+        .a = (uint32_t) num_nodes,
+        .b = (uint32_t) num_nodes,
+        .fp_mode = (uint8_t) fp_mode,
+    };
+    switch(fp_mode){
+        case FP32:
+            g->dist_mat.bfr.fp32 = (float*) view->buf;
+            break;
+        case FP64:
+            g->dist_mat.bfr.fp64 = (double*) view->buf;
+            break;
+    }
+    global_graphs_held_buffers[index].dist_mat = view;
+    interface_unlock_graph(slot);
+
+    PyObject* res = Py_BuildValue("i", 0);
+    return res;
+
+    release_view:
+    interface_unlock_graph(slot);
+    PyBuffer_Release(view);
+    free(view);
+    return NULL;
+}
+
+static PyObject* interface__node_proportions(PyObject* self, PyObject* args){
+	int32_t index;
+
+	if(!PyArg_ParseTuple(args, "i", &index)){return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+	struct graph* const g = &(slot->g);
+	PyObject* res = NULL;
+
+	// the view shows the proportions of the snapshot, which must cover every node before it is exported
+	if(!graph_snapshot_is_current(g) && compute_graph_relative_proportions(g) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call compute_graph_relative_proportions");
+	} else {
+		const Py_ssize_t shape[1] = {(Py_ssize_t) g->num_nodes};
+		res = interface_new_array_view(self, index, g->snapshot.relative_proportions, 1, shape, 'd', sizeof(double));
+	}
+	interface_unlock_graph(slot);
+	return res;
+}
+
+// a graph without attached matrix gets one computed from the vectors of its nodes, owned by the graph;
+// once nodes were appended, only their rows and columns are added to it, from the panel rows the snapshot gathered for them
+static const char* interface_ensure_distance_matrix(struct graph* const g, const int16_t num_threads){
+	const uint64_t first_new_node = g->dist_mat.bfr.fp32 != NULL ? g->dist_mat.a : 0;
+	if(g->dist_mat.bfr.fp32 != NULL && (g->dist_mat.a != g->dist_mat.b || first_new_node > g->num_nodes || (first_new_node < g->num_nodes && !g->dist_mat_must_be_freed))){
+		return "the distance matrix does not match the number of nodes";
+	}
+	if(g->dist_mat.bfr.fp32 != NULL && first_new_node == g->num_nodes){return NULL;}
+	for(uint64_t i = first_new_node ; i < g->num_nodes ; i++){
+		if(graph_node_at(g, i)->vector.fp32 == NULL){return "no distance matrix attached to graph, and not every node has a vector to compute one";}
+	}
+	if(!graph_snapshot_is_current(g) && graph_snapshot_refresh(g, 1, num_threads) != 0){return "failed to call graph_snapshot_refresh";}
+	if(graph_snapshot_gather_vectors(g, num_threads) != 0){return "failed to call graph_snapshot_gather_vectors";}
+	if(g->dist_mat.bfr.fp32 == NULL){
+		if(create_matrix(&(g->dist_mat), (uint32_t) g->num_nodes, (uint32_t) g->num_nodes, FP32) != 0){return "failed to call create_matrix";}
+		g->dist_mat_must_be_freed = 1;
+		if(distance_matrix_from_graph_multithread(g, &(g->dist_mat), num_threads) != 0){return "failed to call distance_matrix_from_graph_multithread";}
+		return NULL;
+	}
+	if(grow_matrix(&(g->dist_mat), (uint32_t) g->num_nodes) != 0){return "failed to call grow_matrix";}
+	if(distance_matrix_extend_from_graph_multithread(g, &(g->dist_mat), first_new_node, num_threads) != 0){return "failed to call distance_matrix_extend_from_graph_multithread";}
+	return NULL;
+}
+
+static PyObject* interface__distance_matrix(PyObject* self, PyObject* args){
+	int32_t index;
+
+	if(!PyArg_ParseTuple(args, "i", &index)){return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+	struct graph* const g = &(slot->g);
+	PyObject* res = NULL;
+
+	// an owned matrix behind the nodes is extended now, as it cannot move while the view exists
+	const char* const err = g->dist_mat_must_be_freed && g->dist_mat.a != g->num_nodes ? interface_ensure_distance_matrix(g, 1) : NULL;
+	const Py_ssize_t shape[2] = {(Py_ssize_t) g->dist_mat.a, (Py_ssize_t) g->dist_mat.b};
+	if(err != NULL){
+		PyErr_SetString(PyExc_Exception, err);
+	} else if(g->dist_mat.bfr.fp32 == NULL){
+		PyErr_SetString(PyExc_Exception, "no distance matrix attached to graph");
+	} else if(g->dist_mat.fp_mode == FP32){
+		res = interface_new_array_view(self, index, g->dist_mat.bfr.fp32, 2, shape, 'f', sizeof(float));
+	} else if(g->dist_mat.fp_mode == FP64){
+		res = interface_new_array_view(self, index, g->dist_mat.bfr.fp64, 2, shape, 'd', sizeof(double));
+	} else {
+		PyErr_SetString(PyExc_Exception, "unknown FP mode of distance matrix");
+	}
+	interface_unlock_graph(slot);
+	return res;
+}
+
+static uint8_t interface_is_disparity(const int32_t id_function){
+	switch(id_function){
+		case ID_DISPARITY_PAIRWISE:
+		case ID_DISPARITY_CHAO_ET_AL_FUNCTIONAL:
+		case ID_DISPARITY_LEINSTER_COBBOLD:
+		case ID_DISPARITY_SCHEINER:
+		case ID_DISPARITY_STIRLING:
+		case ID_DISPARITY_RICOTTA_SZEIDL:
+		case ID_DISPARITY_FUNCTIONAL_EVENNESS:
+		case ID_DISPARITY_AGG_MST:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+// primitives of the memo read by a function, so that dfunctions_memo_compute gathers them with num_threads threads
+static void interface_request_memo(struct graph* const g, const int32_t id_function, const double alpha, const double beta){
+	switch(id_function){
+		case ID_ENTROPY_SHANNON_WEAVER: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY); break;
+		case ID_ENTROPY_RENYI: dfunctions_memo_request_order(g, alpha); break;
+		case ID_INDEX_HILL_EVENNESS:
+			dfunctions_memo_request_order(g, alpha);
+			dfunctions_memo_request_order(g, beta);
+			break;
+		case ID_INDEX_SIMPSON_DOMINANCE: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX); break;
+		case ID_INDEX_SIMPSON: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SIMPSON_INDEX); break;
+		case ID_INDEX_SHANNON_EVENNESS: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SHANNON_EVENNESS); break;
+		case ID_INDEX_BERGER_PARKER: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_BERGER_PARKER_INDEX); break;
+		case ID_INDEX_JUNGE1994_PAGE22: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_JUNGE1994_PAGE22); break;
+		case ID_INDEX_MCINTOSH: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_MCINTOSH_INDEX); break;
+		case ID_INDEX_E_HEIP: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_HEIP); break;
+		case ID_INDEX_ONE_MINUS_D: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_ONE_MINUS_D); break;
+		case ID_INDEX_ONE_OVER_D_WILLIAMS1964: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_ONE_OVER_D_WILLIAMS1964); break;
+		case ID_INDEX_E_MINUS_LN_D_PIELOU1977: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_MINUS_LN_D_PIELOU1977); break;
+		case ID_INDEX_F_2_1_ALATALO1981: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_F_2_1_ALATALO1981); break;
+		case ID_INDEX_G_2_1_MOLINARI1989: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_G_2_1_MOLINARI1989); break;
+		case ID_INDEX_O_BULLA1994: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_O_BULLA1994); break;
+		case ID_INDEX_E_BULLA1994: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_BULLA1994); break;
+		case ID_INDEX_E_MCI_PIELOU1969: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_MCI_PIELOU1969); break;
+		case ID_INDEX_E_VAR_SMITH_AND_WILSON1996: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_VAR_SMITH_AND_WILSON1996_ORIGINAL); break;
+		case ID_INDEX_TYPE_TOKEN_RATIO: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_TYPE_TOKEN_RATIO); break;
+		default: break;
+	}
+}
+
+// the tree of the nodes it spanned, extended to the nodes appended since, from its own edges and those of the new nodes only
+static const char* interface_extend_minimum_spanning_tree(struct graph* const g, struct minimum_spanning_tree* const mst){
+	const uint64_t num_tree_distances = mst->num_active_distances;
+	const uint64_t first_new_node = mst->num_nodes;
+	struct graph_distance_heap* const heap = mst->heap;
+
+	struct distance_two_nodes* const tree = malloc((num_tree_distances + 1) * sizeof(struct distance_two_nodes));
+	if(tree == NULL){return "failed to alloc";}
+	memcpy(tree, mst->distances, num_tree_distances * sizeof(struct distance_two_nodes));
+	free_minimum_spanning_tree(mst);
+
+	const int32_t err = create_graph_distance_heap_from_tree(heap, g, &(g->dist_mat), tree, num_tree_distances, first_new_node);
+	free(tree);
+	if(err != 0){
+		free_graph_distance_heap(heap);
+		free(heap);
+		return "failed to call create_graph_distance_heap_from_tree";
+	}
+	if(create_minimum_spanning_tree(mst, heap) != 0){return "failed to call create_minimum_spanning_tree";}
+	return NULL;
+}
+
+// what the functions of ids read, built once for all of them: snapshot, memo primitives, distance matrix and MST
+// none of the measure helpers touch the Python API, so that callers can release the GIL around them; they return NULL on success, or the message of the exception to raise
+static const char* interface_prepare_measures(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t * const ids, const uint64_t num_ids, const double alpha, const double beta, const int16_t num_threads){
+	uint8_t needs_matrix = 0, needs_mst = 0;
+
+	// nodes added or counts changed since the last compute_relative_proportion would otherwise be missing from the snapshot
+	if(!graph_snapshot_is_current(g) && graph_snapshot_refresh(g, g->num_dimensions > 0, num_threads) != 0){
+		return "failed to call graph_snapshot_refresh";
+	}
+
+	for(uint64_t k = 0 ; k < num_ids ; k++){
+		interface_request_memo(g, ids[k], alpha, beta);
+		needs_matrix |= interface_is_disparity(ids[k]);
+		needs_mst |= ids[k] == ID_DISPARITY_FUNCTIONAL_EVENNESS || ids[k] == ID_DISPARITY_AGG_MST;
+	}
+	if(dfunctions_memo_compute(g, num_threads) != 0){return "failed to call dfunctions_memo_compute";}
+
+	if(needs_matrix){
+		const char* const err = interface_ensure_distance_matrix(g, num_threads);
+		if(err != NULL){return err;}
+	}
+
+	if(needs_mst){
+		if(mst->heap != NULL && mst->num_nodes > 1 && mst->num_nodes < g->num_nodes && mst->num_active_distances == mst->num_nodes - 1){
+			const char* const err = interface_extend_minimum_spanning_tree(g, mst);
+			if(err != NULL){return err;}
+		} else if(mst->heap != NULL && mst->num_nodes != g->num_nodes){
+			free_graph_distance_heap(mst->heap);
+			free(mst->heap);
+			free_minimum_spanning_tree(mst);
+		}
+		if(mst->heap == NULL){
+			struct graph_distance_heap * heap = malloc(sizeof(struct graph_distance_heap));
+			if(heap == NULL){return "failed to alloc";}
+			memset(heap, '\0', sizeof(struct graph_distance_heap));
+			// this call also min-heapifies
+			if(create_graph_distance_heap(heap, g, &g->dist_mat) != 0){free(heap); return "failed to call create_graph_distance_heap";}
+			if(create_minimum_spanning_tree(mst, heap) != 0){return "failed to call create_minimum_spanning_tree";}
+		}
+		if(mst->num_active_distances != g->num_nodes - 1){
+			// the tree is written into a matrix of its own, as in measurement.c, so that the distance matrix stays as it is
+			struct matrix m_mst = { .fp_mode = FP64, };
+			if(create_matrix(&m_mst, (uint32_t) g->num_nodes, (uint32_t) g->num_nodes, FP64) != 0){return "failed to call create_matrix for MST";}
+			memset(m_mst.active, '\0', g->num_nodes * g->num_nodes * sizeof(uint8_t));
+			const int32_t err = calculate_minimum_spanning_tree(mst, &m_mst, MST_PRIMS_ALGORITHM);
+			free_matrix(&m_mst);
+			if(err != 0){return "failed to call calculate_minimum_spanning_tree";}
+		}
+	}
+
+	return NULL;
+}
+
+// one function, on what interface_prepare_measures built
+static const char* interface_evaluate_measure(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t id_function, const double alpha, const double beta, const int16_t num_threads, double* const res1_out, double* const res2_out){
+	double res1 = NAN, res2 = NAN;
+
+	switch(id_function){
+		case ID_ENTROPY_SHANNON_WEAVER:
+			shannon_weaver_entropy_from_graph(g, &res1, &res2);
+			break;
+		case ID_ENTROPY_Q_LOGARITHMIC:
+			q_logarithmic_entropy_from_graph(g, &res1, &res2, alpha);
+			break;
+		case ID_ENTROPY_PATIL_TAILLIE:
+			patil_taillie_entropy_from_graph(g, &res1, &res2, alpha);
+			break;
+		case ID_ENTROPY_RENYI:
+			renyi_entropy_from_graph(g, &res1, &res2, alpha);
+			break;
+		case ID_ENTROPY_GOOD:
+			good_entropy_from_graph(g, &res1, alpha, beta);
+			break;
+		case ID_INDEX_SIMPSON_DOMINANCE:
+			simpson_dominance_index_from_graph(g, &res1);
+			break;
+		case ID_INDEX_SIMPSON:
+			simpson_index_from_graph(g, &res1);
+			break;
+		case ID_INDEX_RICHNESS:
+			richness_from_graph(g, &res1);
+			break;
+		case ID_INDEX_SPECIES_COUNT:
+			species_count_from_graph(g, &res1);
+			break;
+		case ID_INDEX_HILL_EVENNESS:
+			hill_evenness_from_graph(g, &res1, alpha, beta);
+			break;
+		case ID_INDEX_SHANNON_EVENNESS:
+			shannon_evenness_from_graph(g, &res1);
+			break;
+		case ID_INDEX_BERGER_PARKER:
+			berger_parker_index_from_graph(g, &res1);
+			break;
+		case ID_INDEX_JUNGE1994_PAGE22:
+			junge1994_page22_from_graph(g, &res1);
+			break;
+		case ID_INDEX_BRILLOUIN:
+			brillouin_diversity_from_graph(g, &res1);
+			break;
+		case ID_INDEX_MCINTOSH:
+			mcintosh_index_from_graph(g, &res1);
+			break;
+		case ID_INDEX_E_HEIP:
+			sw_e_heip_from_graph(g, &res1);
+			break;
+		case ID_INDEX_ONE_MINUS_D:
+			sw_e_one_minus_D_from_graph(g, &res1);
+			break;
+		case ID_INDEX_ONE_OVER_D_WILLIAMS1964:
+			sw_e_one_over_D_williams1964_from_graph(g, &res1);
+			break;
+		case ID_INDEX_E_MINUS_LN_D_PIELOU1977:
+			sw_e_minus_ln_D_pielou1977_from_graph(g, &res1);
+			break;
+		case ID_INDEX_F_2_1_ALATALO1981:
+			sw_f_2_1_alatalo1981_from_graph(g, &res1);
+			break;
+		case ID_INDEX_G_2_1_MOLINARI1989:
+			sw_g_2_1_molinari1989_from_graph(g, &res1);
+			break;
+		case ID_INDEX_O_BULLA1994:
+			sw_o_bulla1994_from_graph(g, &res1);
+			break;
+		case ID_INDEX_E_BULLA1994:
+			sw_e_bulla1994_from_graph(g, &res1);
+			break;
+		case ID_INDEX_E_MCI_PIELOU1969:
+			sw_e_mci_pielou1969_from_graph(g, &res1);
+			break;
+		case ID_INDEX_E_PRIME_CAMARGO1993:
+			if(sw_e_prime_camargo1993_from_graph_multithread(g, &res1, num_threads) != 0){return "failed to call sw_e_prime_camargo1993_from_graph_multithread";}
+			break;
+		case ID_INDEX_E_VAR_SMITH_AND_WILSON1996:
+			sw_e_var_smith_and_wilson1996_original_from_graph(g, &res1);
+			break;
+		case ID_INDEX_TYPE_TOKEN_RATIO:
+			type_token_ratio_from_graph(g, &res1);
+			break;
+		case ID_DISPARITY_PAIRWISE:
+			pairwise_from_graph(g, &res1, g->dist_mat.fp_mode, &g->dist_mat);
+			break;
+		case ID_DISPARITY_CHAO_ET_AL_FUNCTIONAL:
+			if(chao_et_al_functional_diversity_from_graph(g, &res1, &res2, alpha, g->dist_mat.fp_mode, &g->dist_mat) != 0){
+				return "failed to call chao_et_al_functional_diversity_from_graph";
+			}
+			break;
+		case ID_DISPARITY_LEINSTER_COBBOLD:
+			leinster_cobbold_diversity_from_graph(g, &res1, &res2, alpha, g->dist_mat.fp_mode, &g->dist_mat);
+			break;
+		case ID_DISPARITY_SCHEINER:
+			if(scheiner_species_phylogenetic_functional_diversity_from_graph(g, &res1, &res2, alpha, g->dist_mat.fp_mode, &g->dist_mat) != 0){
+				return "failed to call scheiner_species_phylogenetic_functional_diversity_from_graph";
+			}
+			break;
+		case ID_DISPARITY_STIRLING:
+			stirling_from_graph(g, &res1, alpha, beta, g->dist_mat.fp_mode, &g->dist_mat);
+			break;
+		case ID_DISPARITY_RICOTTA_SZEIDL:
+			ricotta_szeidl_from_graph(g, &res1, alpha, g->dist_mat.fp_mode, &g->dist_mat);
+			break;
+		case ID_DISPARITY_FUNCTIONAL_EVENNESS:
+			functional_evenness_from_minimum_spanning_tree(mst, &res1);
+			break;
+		case ID_DISPARITY_AGG_MST:
+			agg_mst_from_minimum_spanning_tree(mst, &res1);
+			break;
+		default:
+			return "unknown diversity function";
+	}
+
+
+	*res1_out = res1;
+	*res2_out = res2;
+	return NULL;
+}
+
+static const char* individual_measure(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t id_function, const double alpha, const double beta, const int16_t num_threads, double* const res1_out, double* const res2_out){
+	const char* const err = interface_prepare_measures(g, mst, &id_function, 1, alpha, beta, num_threads);
+	if(err != NULL){return err;}
+	return interface_evaluate_measure(g, mst, id_function, alpha, beta, num_threads, res1_out, res2_out);
+}
+
+// one or two floats, depending on how many values the function has
+static PyObject* individual_measure_result(const double res1, const double res2){
+	if(isnan(res1) && isnan(res2)){return PyTuple_New(0);}
+	if(isnan(res2)){return Py_BuildValue("(d)", res1);}
+	if(isnan(res1)){return Py_BuildValue("(d)", res2);}
+	return Py_BuildValue("(dd)", res1, res2);
+}
+
+static PyObject* interface_individual_measure(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "function", "alpha", "beta", "num_threads", NULL};
+	int32_t index;
+	int32_t id_function;
+	double alpha = 1.0, beta = 1.0;
+	int32_t num_threads = 1;
+	double res1, res2;
+	const char* err;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "ii|ddi", kwlist, &index, &id_function, &alpha, &beta, &num_threads)){
+		return NULL;
+	}
+	if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+
+	Py_BEGIN_ALLOW_THREADS
+	err = individual_measure(&(slot->g), &(slot->mst), id_function, alpha, beta, (int16_t) num_threads, &res1, &res2);
+	Py_END_ALLOW_THREADS
+	interface_unlock_graph(slot);
+
+	if(err != NULL){
+		PyErr_SetString(PyExc_Exception, err);
+		return NULL;
+	}
+	return individual_measure_result(res1, res2);
+}
+
+static PyObject* interface__measure_many(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "functions", "values", "seconds", "alpha", "beta", "num_threads", NULL};
+	int32_t index;
+	PyObject* functions;
+	PyObject* values;
+	PyObject* seconds = Py_None;
+	double alpha = 1.0, beta = 1.0;
+	int32_t num_threads = 1;
+	Py_buffer functions_view, values_view, seconds_view = {0};
+	int32_t* ids = NULL;
+	const char* err = NULL;
+	int64_t shared_ns = 0;
+	PyObject* res = NULL;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "iOO|Oddi", kwlist, &index, &functions, &values, &seconds, &alpha, &beta, &num_threads)){
+		return NULL;
+	}
+	if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+
+	if(interface_get_buffer(functions, &functions_view, 1, "functions") != 0){return NULL;}
+	const Py_ssize_t n = functions_view.shape[0];
+	if(PyObject_GetBuffer(values, &values_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0){PyBuffer_Release(&functions_view); return NULL;}
+	if(values_view.ndim != 2 || values_view.shape[0] != n || values_view.shape[1] != 2 || interface_buffer_fp_mode(&values_view) != FP64){
+		PyErr_Format(PyExc_BufferError, "values must be a writable float64 buffer of shape (%zd, 2)", n);
+		goto release;
+	}
+	if(seconds != Py_None){
+		if(PyObject_GetBuffer(seconds, &seconds_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0){goto release;}
+		if(seconds_view.ndim != 1 || seconds_view.shape[0] != n || interface_buffer_fp_mode(&seconds_view) != FP64){
+			PyErr_Format(PyExc_BufferError, "seconds must be a writable float64 buffer of shape (%zd,)", n);
+			goto release;
+		}
+	}
+
+	ids = malloc((n + 1) * sizeof(int32_t));
+	if(ids == NULL){PyErr_NoMemory(); goto release;}
+	for(Py_ssize_t k = 0 ; k < n ; k++){
+		int64_t id;
+		if(interface_buffer_integer_at(&functions_view, k, "functions", &id) != 0){goto release;}
+		if(id < INT32_MIN || id > INT32_MAX){PyErr_SetString(PyExc_ValueError, "unknown diversity function"); goto release;}
+		ids[k] = (int32_t) id;
+	}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){goto release;}
+
+	double* const out = (double*) values_view.buf;
+	double* const out_seconds = seconds != Py_None ? (double*) seconds_view.buf : NULL;
+
+	Py_BEGIN_ALLOW_THREADS
+	int64_t start_ns = instrument_now_ns();
+	err = interface_prepare_measures(&(slot->g), &(slot->mst), ids, (uint64_t) n, alpha, beta, (int16_t) num_threads);
+	shared_ns = instrument_now_ns() - start_ns;
+	for(Py_ssize_t k = 0 ; k < n && err == NULL ; k++){
+		start_ns = instrument_now_ns();
+		err = interface_evaluate_measure(&(slot->g), &(slot->mst), ids[k], alpha, beta, (int16_t) num_threads, &(out[2 * k]), &(out[2 * k + 1]));
+		if(out_seconds != NULL){out_seconds[k] = ((double) (instrument_now_ns() - start_ns)) * 1e-9;}
+	}
+	Py_END_ALLOW_THREADS
+	interface_unlock_graph(slot);
+
+	if(err != NULL){
+		PyErr_SetString(PyExc_Exception, err);
+		goto release;
+	}
+	// the time spent on what the functions share (snapshot, memo, matrix, MST)
+	res = Py_BuildValue("d", ((double) shared_ns) * 1e-9);
+
+	release:
+	free(ids);
+	if(seconds_view.obj != NULL){PyBuffer_Release(&seconds_view);}
+	PyBuffer_Release(&values_view);
+	PyBuffer_Release(&functions_view);
+	return res;
+}
+
+/* // DO NOT REMOVE
+static PyObject* interface_cfg_get_value(PyObject* self, PyObject* args){
+	int32_t index;
+	char* key;
+
+	if(!PyArg_ParseTuple(args, "is", &index, &key)){
+		return NULL;
+	}
+
+	if(index < 0){
+		PyErr_SetString(PyExc_Exception, "index must be >= 0");
+		return NULL;
+	}
+	if(((uint32_t) index) >= num_graphs){
+		PyErr_SetString(PyExc_Exception, "index too high");
+		return NULL;
+	}
+
+	PyObject* res;
+
+	char* value = cfg_get_value(&(configurations[index]), key);
+	if(value == NULL){
+		res = Py_BuildValue("s", "UNKNOWN_KEY");
+	} else {
+		res = Py_BuildValue("s", value);
+	}
+	return res;
+}
+*/
+
+static void interface_free_paths(char** const paths, const int32_t num_paths){
+    if(paths == NULL){return;}
+    for(int32_t i = 0 ; i < num_paths ; i++){free(paths[i]);}
+    free(paths);
+}
+
+// copies of the str of a list, so that they outlive the GIL
+static char** interface_copy_paths(PyObject* const list, const char* const name){
+    const Py_ssize_t n = PyList_Size(list);
+    char** const paths = calloc(n > 0 ? (size_t) n : 1, sizeof(char*));
+    if(paths == NULL){PyErr_NoMemory(); return NULL;}
+    for(Py_ssize_t i = 0 ; i < n ; i++){
+        const char* s = PyUnicode_Check(PyList_GetItem(list, i)) ? PyUnicode_AsUTF8(PyList_GetItem(list, i)) : NULL;
+        if(s == NULL){
+            PyErr_Clear();
+            PyErr_Format(PyExc_Exception, "Failed to get %s at index %zd.", name, i);
+            interface_free_paths(paths, (int32_t) n);
+            return NULL;
+        }
+        paths[i] = strdup(s);
+        if(paths[i] == NULL){PyErr_NoMemory(); interface_free_paths(paths, (int32_t) n); return NULL;}
+    }
+    return paths;
+}
+
+struct interface_score_file_args {
+    char** paths;
+    char** paths_tp;
+    int32_t cardinality_files;
+    int32_t cardinality_files_tp;
+    const int32_t* id_functions;
+    int32_t cardinality_functions;
+    int32_t target_column;
+    int16_t num_threads;
+    struct word2vec* w2v;
+    double* res1;
+    double* res2;
+    char error[256];
+};
+
+// ingestion and measures of score_file, run without the GIL; returns 0 on success, or 1 with a->error set
+static int32_t interface_score_file_run(struct interface_score_file_args* const a){
+    int32_t result = 1;
+    struct graph g = {0};
+    struct minimum_spanning_tree mst = {0};
+    struct oov_counter oov_discarded_because_not_in_vector_database = {0};
+
+    if(create_graph_empty(&g) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call create_graph_empty.");
+        return 1;
+    }
+    if(graph_bind_word2vec(&g, a->w2v) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call graph_bind_word2vec.");
+        goto free_graph;
+    }
+    if(create_oov_counter(&oov_discarded_because_not_in_vector_database, OOV_MEMORY_CAP) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call create_oov_counter.");
+        goto free_graph;
+    }
+
+    for(int32_t i = 0 ; i < a->cardinality_files ; i++){
+        char * s = a->paths[i];
+        char * s_tp = NULL;
+        if(a->cardinality_files_tp > 0){
+            s_tp = a->paths_tp[i];
+            printf("Processing file %i/%i: %s (gold: %s)\n", i, a->cardinality_files, s, s_tp);
+        } else {
+            printf("Processing file %i/%i: %s\n", i, a->cardinality_files, s);
+        }
+
+        struct measurement_configuration mcfg = {
+            .target_column = a->target_column,
+            .enable_token_utf8_normalisation = 0,
+            .jsonl_content_key = "text",
+            .io = (struct measurement_io) {
+                .input_path = s,
+                .jsonl_content_key = "text",
+            },
+		.threading = (struct measurement_threading) {0},
+		.steps = (struct measurement_step_parameters) { .sentence = (struct measurement_step) {0}, .document = (struct measurement_step) {0} },
+        };
+
+        struct measurement_structure_references sref = {
+            .g = &g,
+            .oov_discarded_because_not_in_vector_database = &oov_discarded_because_not_in_vector_database,
+            .w2v = a->w2v,
+        };
+
+        struct measurement_mutables mmut = { .best_s = 0.0, .prev_best_s = 0.0, .prev_num_nodes = 0, .sentence = (struct measurement_mutable_counters) {0}, .document = (struct measurement_mutable_counters) {0}, .mst_initialised = 0, };
+        if(pthread_mutex_init(&mmut.mutex, NULL) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call pthread_mutex_init.");
+            goto free_oov;
+        }
+
+        size_t len_s = strlen(s);
+        int32_t err = 0;
+
+        if(len_s >= 5 && (strcmp(s + len_s - 5, ".cupt") == 0 || (len_s >= 7 && strcmp(s + len_s - 7, ".conllu") == 0))){
+            err = cupt_to_graph(i, s, s_tp, &mcfg, &sref, &mmut, NULL);
+        } else if(len_s >= 6 && strcmp(s + len_s - 6, ".jsonl") == 0){
+            err = jsonl_to_graph(i, s, &mcfg, &sref, &mmut);
+        }
+        pthread_mutex_destroy(&mmut.mutex);
+        if(err != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to read %s.", s);
+            goto free_oov;
+        }
+    }
+
+    if(graph_snapshot_refresh(&g, g.num_dimensions > 0, a->num_threads) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call graph_snapshot_refresh.");
+        goto free_oov;
+    }
+
+    for(int32_t j = 0 ; j < a->cardinality_functions ; j++){
+        const char* const err = individual_measure(&g, &mst, a->id_functions[j], 1.0, 1.0, a->num_threads, &(a->res1[j]), &(a->res2[j]));
+        if(err != NULL){
+            snprintf(a->error, sizeof(a->error), "%s (function %i)", err, a->id_functions[j]);
+            goto free_oov;
+        }
+    }
+    result = 0;
+
+    free_oov:
+    free_oov_counter(&oov_discarded_because_not_in_vector_database);
+    free_graph:
+    if(mst.heap != NULL){
+        free_graph_distance_heap(mst.heap);
+        free(mst.heap);
+    }
+    free_minimum_spanning_tree(&mst);
+    free_graph(&g);
+    return result;
+}
+
+static PyObject* interface_score_file(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+    static char* kwlist[] = {"paths", "gold_paths", "functions", "w2v_index", "target_column", "num_threads", NULL};
+    PyObject * listFiles;
+    PyObject * listFilesTP;
+    PyObject * listFunctions;
+    PyObject * listResults = NULL;
+    int32_t target_column = -1;
+    int32_t w2v_index = -1;
+    int32_t num_threads = 1;
+    int32_t err;
+    struct interface_score_file_args a = {0};
+    struct interface_word2vec_slot* w2v_slot = NULL;
+    int32_t* id_functions = NULL;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!ii|i", kwlist, &PyList_Type, &listFiles, &PyList_Type, &listFilesTP, &PyList_Type, &listFunctions, &w2v_index, &target_column, &num_threads)){
+        return NULL;
+    }
+    if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+
+    a.cardinality_files = (int32_t) PyList_Size(listFiles);
+    a.cardinality_files_tp = (int32_t) PyList_Size(listFilesTP);
+    a.cardinality_functions = (int32_t) PyList_Size(listFunctions);
+    a.target_column = target_column;
+    a.num_threads = (int16_t) num_threads;
+
+    if(!(a.cardinality_files_tp == 0 || a.cardinality_files_tp == a.cardinality_files)){
+        PyErr_Format(PyExc_Exception, "Second argument (gold paths) must be either of length 0 or of length equal to the first argument (prediction paths). First argument's length: %i; second argument's length: %i.", a.cardinality_files, a.cardinality_files_tp);
+        return NULL;
+    }
+
+    id_functions = malloc((a.cardinality_functions + 1) * sizeof(int32_t));
+    a.res1 = malloc((a.cardinality_functions + 1) * sizeof(double));
+    a.res2 = malloc((a.cardinality_functions + 1) * sizeof(double));
+    if(id_functions == NULL || a.res1 == NULL || a.res2 == NULL){PyErr_NoMemory(); goto release;}
+    for(int32_t j = 0 ; j < a.cardinality_functions ; j++){
+        if(!PyArg_Parse(PyList_GetItem(listFunctions, j), "i", &(id_functions[j]))){
+            PyErr_SetString(PyExc_Exception, "Failed to transform Python object to int32_t.");
+            goto release;
+        }
+    }
+    a.id_functions = id_functions;
+
+    a.paths = interface_copy_paths(listFiles, "file name");
+    if(a.paths == NULL){goto release;}
+    a.paths_tp = interface_copy_paths(listFilesTP, "file name (TP)");
+    if(a.paths_tp == NULL){goto release;}
+
+    w2v_slot = interface_read_lock_w2v(w2v_index);
+    if(w2v_slot == NULL){goto release;}
+    a.w2v = &(w2v_slot->w2v);
+
+    Py_BEGIN_ALLOW_THREADS
+    err = interface_score_file_run(&a);
+    Py_END_ALLOW_THREADS
+    interface_unlock_w2v(w2v_slot);
+
+    if(err != 0){
+        PyErr_SetString(PyExc_Exception, a.error);
+        goto release;
+    }
+
+    listResults = PyList_New(a.cardinality_functions);
+    if(listResults == NULL){goto release;}
+    for(int32_t j = 0 ; j < a.cardinality_functions ; j++){
+        PyObject * diversity_score = individual_measure_result(a.res1[j], a.res2[j]);
+        if(diversity_score == NULL){Py_CLEAR(listResults); goto release;}
+        PyList_SET_ITEM(listResults, j, diversity_score);
+    }
+
+    release:
+    interface_free_paths(a.paths, a.cardinality_files);
+    interface_free_paths(a.paths_tp, a.cardinality_files_tp);
+    free(id_functions);
+    free(a.res1);
+    free(a.res2);
+    return listResults;
+}
+
+// strings pulled from a Python iterator, copied back to back so that they can be read without the GIL
+struct interface_ingest_batch {
+	char* arena;
+	size_t arena_size;
+	size_t arena_capacity;
+	size_t* offsets; // start of string k; strings are NUL-terminated
+	size_t* sizes;
+	Py_ssize_t num_strings;
+	Py_ssize_t capacity;
+};
+
+// the next batch_size strings of the iterator; returns 1 with an exception set on failure, 0 otherwise (an empty batch once the iterator is exhausted)
+static int32_t interface_ingest_pull(PyObject* const iterator, struct interface_ingest_batch* const b, const Py_ssize_t batch_size){
+	b->arena_size = 0;
+	b->num_strings = 0;
+	while(b->num_strings < batch_size){
+		PyObject* const item = PyIter_Next(iterator);
+		if(item == NULL){return PyErr_Occurred() != NULL;}
+		Py_ssize_t size;
+		const char* const utf8 = PyUnicode_Check(item) ? PyUnicode_AsUTF8AndSize(item, &size) : NULL;
+		if(utf8 == NULL){
+			if(!PyErr_Occurred()){PyErr_Format(PyExc_TypeError, "expected str, not %s", Py_TYPE(item)->tp_name);}
+			Py_DECREF(item);
+			return 1;
+		}
+		if(b->num_strings == b->capacity){
+			const Py_ssize_t capacity = b->capacity > 0 ? 2 * b->capacity : 64;
+			size_t* const offsets = realloc(b->offsets, capacity * sizeof(size_t));
+			if(offsets != NULL){b->offsets = offsets;}
+			size_t* const sizes = offsets != NULL ? realloc(b->sizes, capacity * sizeof(size_t)) : NULL;
+			if(sizes != NULL){b->sizes = sizes;}
+			if(offsets == NULL || sizes == NULL){Py_DECREF(item); PyErr_NoMemory(); return 1;}
+			b->capacity = capacity;
+		}
+		if(b->arena_size + (size_t) size + 1 > b->arena_capacity){
+			size_t capacity = b->arena_capacity > 0 ? 2 * b->arena_capacity : 4096;
+			while(capacity < b->arena_size + (size_t) size + 1){capacity *= 2;}
+			char* const arena = realloc(b->arena, capacity);
+			if(arena == NULL){Py_DECREF(item); PyErr_NoMemory(); return 1;}
+			b->arena = arena;
+			b->arena_capacity = capacity;
+		}
+		memcpy(&(b->arena[b->arena_size]), utf8, (size_t) size);
+		b->arena[b->arena_size + (size_t) size] = '\0';
+		b->offsets[b->num_strings] = b->arena_size;
+		b->sizes[b->num_strings] = (size_t) size;
+		b->arena_size += (size_t) size + 1;
+		b->num_strings++;
+		Py_DECREF(item);
+	}
+	return 0;
+}
+
+// graph_add_word2vec_occurrence finds the nodes of the entries through g->word2vec_slots, which also have to know the nodes added by add_node and add_nodes
+static int32_t interface_bind_word2vec_slots(struct interface_graph_slot* const slot, const int32_t index_w2v, const struct word2vec* const w2v){
+	struct graph* const g = &(slot->g);
+	if(slot->word2vec_slots_bound && slot->word2vec_slots_w2v == index_w2v && g->num_word2vec_slots == w2v->num_vectors && slot->word2vec_slots_num_nodes == g->num_nodes){return 0;}
+	if(!(slot->word2vec_slots_bound && slot->word2vec_slots_w2v == index_w2v && g->num_word2vec_slots == w2v->num_vectors)){
+		if(graph_bind_word2vec(g, w2v) != 0){return 1;}
+		slot->word2vec_slots_num_nodes = 0;
+	}
+	for(uint64_t i = slot->word2vec_slots_num_nodes ; i < g->num_nodes ; i++){
+		struct graph_node* const node = graph_node_at(g, i);
+		const struct word2vec_entry* const entry = node->word2vec_entry_pointer;
+		if(entry == NULL || entry < w2v->keys || entry >= w2v->keys + w2v->num_vectors){continue;}
+		struct graph_word2vec_slot* const s = &(g->word2vec_slots[entry - w2v->keys]);
+		if(s->active){continue;}
+		s->active = 1;
+		s->node_index = i;
+		s->node = node;
+	}
+	slot->word2vec_slots_bound = 1;
+	slot->word2vec_slots_w2v = index_w2v;
+	return 0;
+}
+
+// runs without the GIL, with the graph and its word2vec locked
+static int32_t interface_ingest_batch(const struct interface_ingest_batch* const b, const uint8_t documents, struct document* const doc, const struct measurement_configuration* const mcfg, struct measurement_structure_references* const sref, uint64_t* const num_oov_tokens){
+	char token[JSONL_CURRENT_TOKEN_BUFFER_SIZE];
+	for(Py_ssize_t k = 0 ; k < b->num_strings ; k++){
+		const char* const s = &(b->arena[b->offsets[k]]);
+		if(documents){
+			// as in jsonl_to_graph, which skips documents without text
+			if(b->sizes[k] == 0){continue;}
+			if(document_set_text(doc, s, b->sizes[k]) != 0 || jsonl_document_to_graph(doc, mcfg, sref, num_oov_tokens) != 0){return 1;}
+		} else {
+			size_t len = b->sizes[k];
+			if(len > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){len = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;}
+			memcpy(token, s, len);
+			token[len] = '\0';
+			if(jsonl_token_to_graph(token, mcfg, sref, num_oov_tokens) != 0){return 1;}
+		}
+	}
+	return 0;
+}
+
+static PyObject* interface__ingest(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "iterable", "documents", "batch_size", "normalise", NULL};
+	int32_t index;
+	PyObject* iterable;
+	int32_t documents = 0;
+	Py_ssize_t batch_size = 4096;
+	int32_t normalise = 0;
+	PyObject* iterator = NULL;
+	PyObject* res = NULL;
+	struct interface_ingest_batch b = {0};
+	struct document doc = {0};
+	struct oov_counter oov = {0};
+	uint8_t created_doc = 0, created_oov = 0;
+	uint64_t num_strings = 0, num_oov_tokens = 0;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "iO|pnp", kwlist, &index, &iterable, &documents, &batch_size, &normalise)){return NULL;}
+	if(batch_size < 1){PyErr_SetString(PyExc_ValueError, "batch_size must be >= 1"); return NULL;}
+
+	iterator = PyObject_GetIter(iterable);
+	if(iterator == NULL){return NULL;}
+	if(create_oov_counter(&oov, OOV_MEMORY_CAP) != 0){PyErr_SetString(PyExc_Exception, "failed to call create_oov_counter"); goto release;}
+	created_oov = 1;
+	if(documents){
+		if(create_document(&doc) != 0){PyErr_SetString(PyExc_Exception, "failed to call create_document"); goto release;}
+		created_doc = 1;
+	}
+
+	const struct measurement_configuration mcfg = {
+		.target_column = -1,
+		.enable_token_utf8_normalisation = (int8_t) normalise,
+	};
+
+	while(1){
+		if(interface_ingest_pull(iterator, &b, batch_size) != 0){goto release;}
+		if(b.num_strings == 0){break;}
+
+		// the graph is locked once per batch, so that other calls on it can run between two batches
+		struct interface_graph_slot* const slot = interface_lock_graph(index);
+		if(slot == NULL){goto release;}
+		if(!interface_graph_not_exported(index)){interface_unlock_graph(slot); goto release;}
+		const int32_t index_w2v = global_graphs_word2vec_bindings[index];
+		if(index_w2v < 0){interface_unlock_graph(slot); PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); goto release;}
+		struct interface_word2vec_slot* const w2v_slot = interface_read_lock_w2v(index_w2v);
+		if(w2v_slot == NULL){interface_unlock_graph(slot); goto release;}
+
+		struct measurement_structure_references sref = {
+			.g = &(slot->g),
+			.w2v = &(w2v_slot->w2v),
+			.oov_discarded_because_not_in_vector_database = &oov,
+		};
+		int32_t err;
+		Py_BEGIN_ALLOW_THREADS
+		err = interface_bind_word2vec_slots(slot, index_w2v, &(w2v_slot->w2v));
+		if(err == 0){err = interface_ingest_batch(&b, (uint8_t) documents, &doc, &mcfg, &sref, &num_oov_tokens);}
+		slot->word2vec_slots_num_nodes = slot->g.num_nodes;
+		// tokens of nodes already in the graph change counts without adding nodes, even in a batch that failed halfway
+		graph_snapshot_mark_stale(&(slot->g));
+		Py_END_ALLOW_THREADS
+		interface_unlock_w2v(w2v_slot);
+		interface_unlock_graph(slot);
+		if(err != 0){PyErr_SetString(PyExc_Exception, "failed to ingest batch"); goto release;}
+		num_strings += (uint64_t) b.num_strings;
+	}
+
+	res = Py_BuildValue("(KK)", (unsigned long long) num_strings, (unsigned long long) num_oov_tokens);
+
+	release:
+	Py_DECREF(iterator);
+	if(created_doc){free_document(&doc);}
+	if(created_oov){free_oov_counter(&oov);}
+	free(b.arena);
+	free(b.offsets);
+	free(b.sizes);
+	return res;
+}
+
+struct interface_score_files_args;
+
+// one graph of score_files, with what its readers update
+struct interface_score_files_corpus {
+    struct graph g;
+    struct minimum_spanning_tree mst;
+    struct oov_counter oov;
+    struct measurement_mutables mmut;
+    struct measurement_step_hook hook;
+    struct interface_score_files_args* args;
+    int32_t path_index; // -1 for the shared graph, whose steps belong to the file whose reader reached them
+    uint8_t created;
+};
+
+struct interface_score_files_args {
+    char** paths;
+    char** paths_tp;
+    int32_t cardinality_files;
+    int32_t cardinality_files_tp;
+    const int32_t* id_functions;
+    int32_t cardinality_functions;
+    int32_t target_column;
+    int16_t num_threads;
+    uint64_t step;
+    uint8_t shared;
+    struct word2vec* w2v;
+    PyObject* callback; // None unless steps are streamed
+    struct interface_score_files_corpus* corpora;
+    struct measurement_structure_references* srefs;
+    int32_t num_corpora;
+    double* values; // cardinality_functions pairs per corpus, once every file is read
+    PyObject* callback_error[3]; // the exception raised by the callback, restored once the GIL is back with the caller
+    char error[256];
+};
+
+// row handed to the callback and returned for each graph: (path index, num_nodes, num_sentences, num_documents, num_oov_types, (values...))
+static PyObject* interface_score_files_row(const int32_t path_index, const struct graph* const g, const struct measurement_mutables* const mmut, const int64_t num_oov_types, const double* const values, const int32_t num_values){
+    PyObject* const values_py = PyTuple_New(num_values);
+    if(values_py == NULL){return NULL;}
+    for(int32_t k = 0 ; k < num_values ; k++){
+        PyObject* const v = PyFloat_FromDouble(values[k]);
+        if(v == NULL){Py_DECREF(values_py); return NULL;}
+        PyTuple_SET_ITEM(values_py, k, v);
+    }
+    return Py_BuildValue("(iKKKLN)", path_index, (unsigned long long) g->num_nodes, (unsigned long long) mmut->sentence.num_all, (unsigned long long) mmut->document.num_all, (long long) num_oov_types, values_py);
+}
+
+// measurement_step_hook of score_files, called by a reader holding mmut->mutex and g->mutex_nodes, without the GIL
+static int32_t interface_score_files_step(void* const ctx, const uint64_t i, struct graph* const g, const struct measurement_mutables* const mmut){
+    struct interface_score_files_corpus* const corpus = (struct interface_score_files_corpus*) ctx;
+    struct interface_score_files_args* const a = corpus->args;
+    const int32_t num_values = 2 * a->cardinality_functions;
+    int32_t result = 0;
+
+    double* const values = malloc((num_values + 1) * sizeof(double));
+    if(values == NULL){return 1;}
+
+    const char* err = interface_prepare_measures(g, &(corpus->mst), a->id_functions, (uint64_t) a->cardinality_functions, 1.0, 1.0, a->num_threads);
+    for(int32_t k = 0 ; k < a->cardinality_functions && err == NULL ; k++){
+        err = interface_evaluate_measure(g, &(corpus->mst), a->id_functions[k], 1.0, 1.0, a->num_threads, &(values[2 * k]), &(values[2 * k + 1]));
+    }
+    if(err != NULL){
+        error_format(__FILE__, __func__, __LINE__, err);
+        free(values);
+        return 1;
+    }
+
+    const PyGILState_STATE gil = PyGILState_Ensure();
+    if(a->callback_error[0] != NULL){
+        result = 1;
+    } else {
+        PyObject* const row = interface_score_files_row(corpus->path_index >= 0 ? corpus->path_index : (int32_t) i, g, mmut, mmut->num_oov_types, values, num_values);
+        PyObject* const ret = row != NULL ? PyObject_CallOneArg(a->callback, row) : NULL;
+        Py_XDECREF(row);
+        if(ret == NULL){
+            PyErr_Fetch(&(a->callback_error[0]), &(a->callback_error[1]), &(a->callback_error[2]));
+            result = 1;
+        }
+        Py_XDECREF(ret);
+    }
+    PyGILState_Release(gil);
+
+    free(values);
+    return result;
+}
+
+// reads the files of score_files into their graphs, then measures each graph; run without the GIL, returns 0 on success, or 1 with a->error set
+static int32_t interface_score_files_run(struct interface_score_files_args* const a){
+    struct file_queue q;
+    int32_t result = 1;
+
+    const struct measurement_step step = {
+        .recompute_step = a->step,
+        .enable_count_recompute_step = a->step > 0 && a->callback != Py_None,
+    };
+    struct measurement_configuration mcfg = {
+        .target_column = a->target_column,
+        .enable_token_utf8_normalisation = 0,
+        .jsonl_content_key = "text",
+        .io = (struct measurement_io) {
+            .jsonl_content_key = "text",
+        },
+        .threading = (struct measurement_threading) { .num_file_reading_threads = a->num_threads, },
+        .steps = (struct measurement_step_parameters) { .sentence = step, .document = step, },
+    };
+
+    for(int32_t c = 0 ; c < a->num_corpora ; c++){
+        struct interface_score_files_corpus* const corpus = &(a->corpora[c]);
+        corpus->args = a;
+        corpus->path_index = a->shared ? -1 : c;
+        corpus->hook = (struct measurement_step_hook) { .step = interface_score_files_step, .ctx = corpus, };
+        corpus->mmut = (struct measurement_mutables) {
+            .best_s = -1.0,
+            .prev_best_s = -1.0,
+            .sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+            .document = (struct measurement_mutable_counters) { .count_target = 1, },
+        };
+        if(create_graph_empty(&(corpus->g)) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call create_graph_empty.");
+            return 1;
+        }
+        if(create_oov_counter(&(corpus->oov), OOV_MEMORY_CAP) != 0){
+            free_graph(&(corpus->g));
+            snprintf(a->error, sizeof(a->error), "Failed to call create_oov_counter.");
+            return 1;
+        }
+        if(pthread_mutex_init(&(corpus->mmut.mutex), NULL) != 0){
+            free_oov_counter(&(corpus->oov));
+            free_graph(&(corpus->g));
+            snprintf(a->error, sizeof(a->error), "Failed to call pthread_mutex_init.");
+            return 1;
+        }
+        corpus->created = 1;
+        if(graph_bind_word2vec(&(corpus->g), a->w2v) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call graph_bind_word2vec.");
+            return 1;
+        }
+
+        const struct measurement_structure_references sref = {
+            .g = &(corpus->g),
+            .w2v = a->w2v,
+            .oov_discarded_because_not_in_vector_database = &(corpus->oov),
+            .step_hook = a->callback != Py_None ? &(corpus->hook) : NULL,
+        };
+        memcpy(&(a->srefs[c]), &sref, sizeof(struct measurement_structure_references));
+    }
+
+    if(a->shared){
+        if(create_file_queue(&q, a->paths, a->cardinality_files_tp > 0 ? a->paths_tp : NULL, a->cardinality_files, 1) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call create_file_queue.");
+            return 1;
+        }
+        result = file_queue_read(&q, &mcfg, &(a->srefs[0]), &(a->corpora[0].mmut), a->num_threads);
+    } else {
+        struct file_queue_corpus* const queue_corpora = calloc(a->num_corpora > 0 ? a->num_corpora : 1, sizeof(struct file_queue_corpus));
+        if(queue_corpora == NULL){
+            snprintf(a->error, sizeof(a->error), "Failed to calloc.");
+            return 1;
+        }
+        for(int32_t c = 0 ; c < a->num_corpora ; c++){
+            queue_corpora[c] = (struct file_queue_corpus) {
+                .paths = &(a->paths[c]),
+                .paths_tp = a->cardinality_files_tp > 0 ? &(a->paths_tp[c]) : NULL,
+                .num_paths = 1,
+                .mcfg = &mcfg,
+                .sref = &(a->srefs[c]),
+                .mmut = &(a->corpora[c].mmut),
+            };
+        }
+        if(create_file_queue_corpora(&q, queue_corpora, a->num_corpora, 1) != 0){
+            free(queue_corpora);
+            snprintf(a->error, sizeof(a->error), "Failed to call create_file_queue_corpora.");
+            return 1;
+        }
+        result = file_queue_read(&q, NULL, NULL, NULL, a->num_threads);
+        free_file_queue(&q);
+        free(queue_corpora);
+    }
+    if(a->shared){free_file_queue(&q);}
+    if(result != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to read the files.");
+        return 1;
+    }
+
+    for(int32_t c = 0 ; c < a->num_corpora ; c++){
+        struct interface_score_files_corpus* const corpus = &(a->corpora[c]);
+        corpus->mmut.num_oov_types = oov_counter_num_types(&(corpus->oov));
+        if(graph_snapshot_refresh(&(corpus->g), corpus->g.num_dimensions > 0, a->num_threads) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call graph_snapshot_refresh.");
+            return 1;
+        }
+        double* const values = &(a->values[2 * a->cardinality_functions * c]);
+        const char* err = interface_prepare_measures(&(corpus->g), &(corpus->mst), a->id_functions, (uint64_t) a->cardinality_functions, 1.0, 1.0, a->num_threads);
+        for(int32_t k = 0 ; k < a->cardinality_functions && err == NULL ; k++){
+            err = interface_evaluate_measure(&(corpus->g), &(corpus->mst), a->id_functions[k], 1.0, 1.0, a->num_threads, &(values[2 * k]), &(values[2 * k + 1]));
+        }
+        if(err != NULL){
+            snprintf(a->error, sizeof(a->error), "%s (%s)", err, a->shared ? "shared graph" : a->paths[c]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void interface_score_files_free(struct interface_score_files_args* const a){
+    for(int32_t c = 0 ; c < a->num_corpora ; c++){
+        struct interface_score_files_corpus* const corpus = &(a->corpora[c]);
+        if(!corpus->created){continue;}
+        if(corpus->mst.heap != NULL){
+            free_graph_distance_heap(corpus->mst.heap);
+            free(corpus->mst.heap);
+        }
+        free_minimum_spanning_tree(&(corpus->mst));
+        pthread_mutex_destroy(&(corpus->mmut.mutex));
+        free_oov_counter(&(corpus->oov));
+        free_graph(&(corpus->g));
+    }
+    free(a->corpora);
+    free(a->srefs);
+    free(a->values);
+    interface_free_paths(a->paths, a->cardinality_files);
+    interface_free_paths(a->paths_tp, a->cardinality_files_tp);
+}
+
+static PyObject* interface__score_files(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+    static char* kwlist[] = {"paths", "gold_paths", "functions", "w2v_index", "target_column", "shared", "num_threads", "step", "callback", NULL};
+    PyObject * listFiles;
+    PyObject * listFilesTP;
+    PyObject * listFunctions;
+    PyObject * callback = Py_None;
+    PyObject * res = NULL;
+    int32_t target_column = -1;
+    int32_t w2v_index = -1;
+    int32_t shared = 0;
+    int32_t num_threads = 1;
+    unsigned long long step = 0;
+    int32_t err;
+    struct interface_score_files_args a = {0};
+    struct interface_word2vec_slot* w2v_slot = NULL;
+    int32_t* id_functions = NULL;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!ii|piKO", kwlist, &PyList_Type, &listFiles, &PyList_Type, &listFilesTP, &PyList_Type, &listFunctions, &w2v_index, &target_column, &shared, &num_threads, &step, &callback)){
+        return NULL;
+    }
+    if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+    if(callback != Py_None && !PyCallable_Check(callback)){PyErr_SetString(PyExc_TypeError, "callback must be callable or None"); return NULL;}
+
+    a.cardinality_files = (int32_t) PyList_Size(listFiles);
+    a.cardinality_files_tp = (int32_t) PyList_Size(listFilesTP);
+    a.cardinality_functions = (int32_t) PyList_Size(listFunctions);
+    a.target_column = target_column;
+    a.num_threads = (int16_t) num_threads;
+    a.step = (uint64_t) step;
+    a.shared = (uint8_t) shared;
+    a.callback = callback;
+    a.num_corpora = shared ? 1 : a.cardinality_files;
+
+    if(!(a.cardinality_files_tp == 0 || a.cardinality_files_tp == a.cardinality_files)){
+        PyErr_Format(PyExc_Exception, "Second argument (gold paths) must be either of length 0 or of length equal to the first argument (prediction paths). First argument's length: %i; second argument's length: %i.", a.cardinality_files, a.cardinality_files_tp);
+        return NULL;
+    }
+
+    id_functions = malloc((a.cardinality_functions + 1) * sizeof(int32_t));
+    a.corpora = calloc(a.num_corpora + 1, sizeof(struct interface_score_files_corpus));
+    a.srefs = calloc(a.num_corpora + 1, sizeof(struct measurement_structure_references));
+    a.values = malloc((2 * a.cardinality_functions * a.num_corpora + 1) * sizeof(double));
+    if(id_functions == NULL || a.corpora == NULL || a.srefs == NULL || a.values == NULL){PyErr_NoMemory(); goto release;}
+    for(int32_t j = 0 ; j < a.cardinality_functions ; j++){
+        if(!PyArg_Parse(PyList_GetItem(listFunctions, j), "i", &(id_functions[j]))){
+            PyErr_SetString(PyExc_Exception, "Failed to transform Python object to int32_t.");
+            goto release;
+        }
+    }
+    a.id_functions = id_functions;
+
+    a.paths = interface_copy_paths(listFiles, "file name");
+    if(a.paths == NULL){goto release;}
+    a.paths_tp = interface_copy_paths(listFilesTP, "file name (TP)");
+    if(a.paths_tp == NULL){goto release;}
+
+    w2v_slot = interface_read_lock_w2v(w2v_index);
+    if(w2v_slot == NULL){goto release;}
+    a.w2v = &(w2v_slot->w2v);
+
+    // the callback takes the GIL back from the reader threads
+    Py_BEGIN_ALLOW_THREADS
+    err = interface_score_files_run(&a);
+    Py_END_ALLOW_THREADS
+    interface_unlock_w2v(w2v_slot);
+
+    if(a.callback_error[0] != NULL){
+        PyErr_Restore(a.callback_error[0], a.callback_error[1], a.callback_error[2]);
+        goto release;
+    }
+    if(err != 0){
+        PyErr_SetString(PyExc_Exception, a.error);
+        goto release;
+    }
+
+    res = PyList_New(a.num_corpora);
+    if(res == NULL){goto release;}
+    for(int32_t c = 0 ; c < a.num_corpora ; c++){
+        const struct interface_score_files_corpus* const corpus = &(a.corpora[c]);
+        PyObject* const row = interface_score_files_row(corpus->path_index, &(corpus->g), &(corpus->mmut), corpus->mmut.num_oov_types, &(a.values[2 * a.cardinality_functions * c]), 2 * a.cardinality_functions);
+        if(row == NULL){Py_CLEAR(res); goto release;}
+        PyList_SET_ITEM(res, c, row);
+    }
+
+    release:
+    interface_score_files_free(&a);
+    free(id_functions);
+    return res;
+}
+
+void interface_free_globals(void * args){
+    (void) args;
+	if(global_graph_slots != NULL){
+        for(uint32_t i = 0 ; i < num_graph_slots ; i++){
+            struct interface_graph_slot* const slot = global_graph_slots[i];
+            if(i < num_graphs && !global_graphs_freed[i]){
+                interface_release_held_buffers((int32_t) i);
+                free_graph(&(slot->g));
+            }
+
+	    if(slot->mst.heap != NULL){
+		free_graph_distance_heap(slot->mst.heap);
+		free(slot->mst.heap);
+		slot->mst.heap = NULL;
+	    }
+	    free_minimum_spanning_tree(&(slot->mst));
+	    pthread_mutex_destroy(&(slot->mutex));
+	    free(slot);
+        }
+        free(global_graph_slots);
+    }
+	if(global_graphs_freed != NULL){free(global_graphs_freed);}
+	if(global_graphs_word2vec_bindings != NULL){free(global_graphs_word2vec_bindings);}
+	if(global_graphs_held_buffers != NULL){free(global_graphs_held_buffers);}
+	if(global_graphs_exports != NULL){free(global_graphs_exports);}
+	if(global_word2vec_slots != NULL){
+        for(uint32_t i = 0 ; i < num_w2v ; i++){
+            if(!global_w2v_freed[i]){
+                free_word2vec(&(global_word2vec_slots[i]->w2v));
+            }
+            pthread_rwlock_destroy(&(global_word2vec_slots[i]->lock));
+            free(global_word2vec_slots[i]);
+        }
+        free(global_word2vec_slots);
+    }
+	if(global_w2v_freed != NULL){free(global_w2v_freed);}
+	if(configurations != NULL){free(configurations);}
+
+	// return Py_BuildValue("i", 0);
+}
+
+static PyMethodDef diversutilsmethods[] = {
+	// {"__del__", interface_free_globals, METH_VARARGS, "__del__"},
+	{"create_graph", interface_create_graph, METH_VARARGS, "Create a graph. This returns the graph index. ARGS: num_nodes, num_dimensions, config_path."},
+	{"create_empty_graph", interface_create_empty_graph, METH_VARARGS, "Create a an graph. This returns the graph index. ARGS: num_nodes, num_dimensions."},
+	{"free_graph", interface_free_graph, METH_VARARGS, "Free a graph. This requires the graph index."},
+	// {"cfg_get_value", interface_cfg_get_value, METH_VARARGS, "Provide a graph index, and a key to fetch."}, // DO NOT REMOVE
+	// {"measurement_from_cfg", interface_measurement_from_cfg, METH_VARARGS, "Call measurement function."}, // DO NOT REMOVE
+	{"add_node", interface_add_node, METH_VARARGS, "Add a node (args: graph index, absolute proportion, Word2Vec key or C-contiguous float32 vector buffer (optional)). A vector buffer is read in place and held until the graph is freed."},
+	{"individual_measure", (PyCFunction)(void(*)(void)) interface_individual_measure, METH_VARARGS | METH_KEYWORDS, "Compute an individual measure without holding the GIL. ARGS: graph_index, function, alpha (optional), beta (optional), num_threads (optional, default 1). A disparity without attached matrix computes one from the node vectors."},
+	{"compute_relative_proportion", (PyCFunction)(void(*)(void)) interface_compute_relative_proportions, METH_VARARGS | METH_KEYWORDS, "Compute relative proportions without holding the GIL. ARGS: graph_index, num_threads (optional, default 1)."},
+	{"bind_w2v", interface_bind_w2v, METH_VARARGS, "Bind a Word2Vec binary to a graph. ARGS: graph index, Word2Vec index."},
+	{"load_w2v", interface_load_w2v, METH_VARARGS, "Load a Word2Vec binary. ARGS: Word2Vec index."},
+	{"free_w2v", interface_free_w2v, METH_VARARGS, "Free a Word2Vec binary. ARGS: Word2Vec index."},
+    {"score_file", (PyCFunction)(void(*)(void)) interface_score_file, METH_VARARGS | METH_KEYWORDS, "Compute scores for one or more files without holding the GIL. ARGS: List of paths, list of gold paths or empty list, list of measures, index of vector space, index of CUPT column, num_threads (optional, default 1)."},
+    {"_ingest", (PyCFunction)(void(*)(void)) interface__ingest, METH_VARARGS | METH_KEYWORDS, "Add the tokens of strings pulled from an iterable to a graph bound to a Word2Vec, batch_size strings at a time, without the GIL while a batch is added. ARGS: graph index, iterable of str, documents (optional; tokenize each string as the text of a JSONL document instead of taking it as one token), batch_size (optional), normalise (optional; UTF-8 normalisation of the tokens). Returns (number of strings, number of out-of-vocabulary tokens)."},
+    {"_score_files", (PyCFunction)(void(*)(void)) interface__score_files, METH_VARARGS | METH_KEYWORDS, "Read files with num_threads native threads into one graph per file, or into one shared graph, and measure each graph; return one row per graph. ARGS: list of paths, list of gold paths or empty list, list of measures, index of vector space, index of CUPT column, shared (optional), num_threads (optional), step (optional; sentences of CUPT files or documents of JSONL files between two calls of the callback, 0 for none), callback (optional). Rows are (path index or -1, num_nodes, num_sentences, num_documents, num_oov_types, tuple of two values per measure)."},
+    {"_attach_distance_matrix", interface__attach_distance_matrix, METH_VARARGS, "Attach a distance matrix to a graph without copying it; the graph holds the buffer until it is freed or another matrix is attached. ARGS: graph index, C-contiguous float32 or float64 buffer of shape (num_nodes, num_nodes)."},
+    {"add_nodes", interface_add_nodes, METH_VARARGS, "Add several nodes in one call and return the index of the first one. ARGS: graph index, float32 buffer of shape (n, num_dimensions) or None, integer buffer of n counts, list of n Word2Vec keys (optional). Vectors are read in place and held until the graph is freed; they take precedence over the vectors of the keys."},
+    {"update_counts", interface_update_counts, METH_VARARGS, "Add deltas to the absolute proportions of some nodes; nothing changes if one count would leave [0, 2^32 - 1]. ARGS: graph index, integer buffer of node indices, integer buffer of deltas."},
+    {"set_counts", interface_set_counts, METH_VARARGS, "Set the absolute proportion of every node. ARGS: graph index, C-contiguous integer buffer of length num_nodes."},
+    {"_measure_many", (PyCFunction)(void(*)(void)) interface__measure_many, METH_VARARGS | METH_KEYWORDS, "Compute several measures in one call without holding the GIL, sharing the snapshot, memo, distance matrix and MST; return the seconds spent on those. ARGS: graph_index, integer buffer of functions, writable float64 buffer of shape (n, 2) for the values (NaN where a function has a single value), writable float64 buffer of n seconds or None (optional), alpha, beta, num_threads (optional)."},
+    {"_node_proportions", interface__node_proportions, METH_VARARGS, "Read-only memoryview of the relative proportions of the nodes. ARGS: graph index."},
+    {"_distance_matrix", interface__distance_matrix, METH_VARARGS, "Read-only memoryview of the distance matrix. ARGS: graph index."},
+	{NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef diversutilsmodule = {
+	PyModuleDef_HEAD_INIT,
+	"diversutils",
+	NULL, // docs
+	-1,
+	diversutilsmethods,
+	NULL, // PyModuleDef_Slot* m_slots, but NULL if single phase initialisation
+	NULL, // traverseproc m_traverse, "A traversal function to call during GC traversal of the module object, or NULL if not needed"
+	NULL, // inquiry m_clear, "A clear function to call during GC clearing of the module object, or NULL if not needed"
+	// NULL, // freefunc m_free, "A function to call during deallocation of the module object, or NULL if not needed"
+	interface_free_globals, // freefunc m_free, "A function to call during deallocation of the module object, or NULL if not needed"
+};
+
+PyMODINIT_FUNC PyInit__diversutils(void){
+	if(PyType_Ready(&interface_array_view_type) != 0){return NULL;}
+	PyObject* mod = PyModule_Create(&diversutilsmodule);
+	PyModule_AddIntConstant(mod, "DF_ENTROPY_SHANNON_WEAVER", ID_ENTROPY_SHANNON_WEAVER);
+	PyModule_AddIntConstant(mod, "DF_ENTROPY_Q_LOGARITHMIC", ID_ENTROPY_Q_LOGARITHMIC);
+	PyModule_AddIntConstant(mod, "DF_ENTROPY_PATIL_TAILLIE", ID_ENTROPY_PATIL_TAILLIE);
+	PyModule_AddIntConstant(mod, "DF_ENTROPY_RENYI", ID_ENTROPY_RENYI);
+	PyModule_AddIntConstant(mod, "DF_ENTROPY_GOOD", ID_ENTROPY_GOOD);
+	PyModule_AddIntConstant(mod, "DF_INDEX_SIMPSON_DOMINANCE", ID_INDEX_SIMPSON_DOMINANCE);
+	PyModule_AddIntConstant(mod, "DF_INDEX_SIMPSON", ID_INDEX_SIMPSON);
+	PyModule_AddIntConstant(mod, "DF_INDEX_RICHNESS", ID_INDEX_RICHNESS);
+	PyModule_AddIntConstant(mod, "DF_INDEX_SPECIES_COUNT", ID_INDEX_SPECIES_COUNT);
+	PyModule_AddIntConstant(mod, "DF_INDEX_HILL_EVENNESS", ID_INDEX_HILL_EVENNESS);
+	PyModule_AddIntConstant(mod, "DF_INDEX_SHANNON_EVENNESS", ID_INDEX_SHANNON_EVENNESS);
+	PyModule_AddIntConstant(mod, "DF_INDEX_BERGER_PARKER", ID_INDEX_BERGER_PARKER);
+	PyModule_AddIntConstant(mod, "DF_INDEX_JUNGE1994_PAGE22", ID_INDEX_JUNGE1994_PAGE22);
+	PyModule_AddIntConstant(mod, "DF_INDEX_BRILLOUIN", ID_INDEX_BRILLOUIN);
+	PyModule_AddIntConstant(mod, "DF_INDEX_MCINTOSH", ID_INDEX_MCINTOSH);
+	PyModule_AddIntConstant(mod, "DF_INDEX_E_HEIP", ID_INDEX_E_HEIP);
+	PyModule_AddIntConstant(mod, "DF_INDEX_ONE_MINUS_D", ID_INDEX_ONE_MINUS_D);
+	PyModule_AddIntConstant(mod, "DF_INDEX_ONE_OVER_D_WILLIAMS1964", ID_INDEX_ONE_OVER_D_WILLIAMS1964);
+	PyModule_AddIntConstant(mod, "DF_INDEX_E_MINUS_LN_D_PIELOU1977", ID_INDEX_E_MINUS_LN_D_PIELOU1977);
+	PyModule_AddIntConstant(mod, "DF_INDEX_F_2_1_ALATALO1981", ID_INDEX_F_2_1_ALATALO1981);
+	PyModule_AddIntConstant(mod, "DF_INDEX_G_2_1_MOLINARI1989", ID_INDEX_G_2_1_MOLINARI1989);
+	PyModule_AddIntConstant(mod, "DF_INDEX_O_BULLA1994", ID_INDEX_O_BULLA1994);
+	PyModule_AddIntConstant(mod, "DF_INDEX_E_BULLA1994", ID_INDEX_E_BULLA1994);
+	PyModule_AddIntConstant(mod, "DF_INDEX_E_MCI_PIELOU1969", ID_INDEX_E_MCI_PIELOU1969);
+	PyModule_AddIntConstant(mod, "DF_INDEX_E_PRIME_CAMARGO1993", ID_INDEX_E_PRIME_CAMARGO1993);
+	PyModule_AddIntConstant(mod, "DF_INDEX_E_VAR_SMITH_AND_WILSON1996", ID_INDEX_E_VAR_SMITH_AND_WILSON1996);
+	PyModule_AddIntConstant(mod, "DF_INDEX_TYPE_TOKEN_RATIO", ID_INDEX_TYPE_TOKEN_RATIO);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_PAIRWISE", ID_DISPARITY_PAIRWISE);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_CHAO_ET_AL_FUNCTIONAL", ID_DISPARITY_CHAO_ET_AL_FUNCTIONAL);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_LEINSTER_COBBOLD", ID_DISPARITY_LEINSTER_COBBOLD);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_SCHEINER", ID_DISPARITY_SCHEINER);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_STIRLING", ID_DISPARITY_STIRLING);
+	
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_RICOTTA_SZEIDL", ID_DISPARITY_RICOTTA_SZEIDL);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_FUNCTIONAL_EVENNESS", ID_DISPARITY_FUNCTIONAL_EVENNESS);
+	PyModule_AddIntConstant(mod, "DF_DISPARITY_AGG_MST", ID_DISPARITY_AGG_MST);
+    PyModule_AddIntConstant(mod, "UD_ID", UD_ID);
+    PyModule_AddIntConstant(mod, "UD_FORM", UD_FORM);
+    PyModule_AddIntConstant(mod, "UD_LEMMA", UD_LEMMA);
+    PyModule_AddIntConstant(mod, "UD_UPOS", UD_UPOS);
+    PyModule_AddIntConstant(mod, "UD_XPOS", UD_XPOS);
+    PyModule_AddIntConstant(mod, "UD_FEATS", UD_FEATS);
+    PyModule_AddIntConstant(mod, "UD_HEAD", UD_HEAD);
+    PyModule_AddIntConstant(mod, "UD_DEPREL", UD_DEPREL);
+    PyModule_AddIntConstant(mod, "UD_DEPS", UD_DEPS);
+    PyModule_AddIntConstant(mod, "UD_MISC", UD_MISC);
+    PyModule_AddIntConstant(mod, "UD_MWE", UD_MWE);
+    PyModule_AddIntConstant(mod, "FP32", FP32);
+    PyModule_AddIntConstant(mod, "FP64", FP64);
+	return mod;
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <immintrin.h>
+#include <assert.h>
+
+#include "graph.h"
+#include "general_constants.h"
+#include "distances.h"
+#include "snapshot.h"
+#include "cupt/parser.h"
+#include "stats.h"
+#include "logging.h"
+
+const int32_t CONSTANT_RELATIVE_PROPORTION = 1;
+
+const int32_t ENABLE_EXTREMES = 1;
+const int32_t EXTREME_STEP = 50;
+const double EXTREME_RATIO = 4.0;
+
+int32_t create_matrix(struct matrix* const m, const uint32_t a, const uint32_t b, const int8_t fp_mode){
+	if(!(fp_mode == FP32 || fp_mode == FP64)){
+		perror("Unknown fp_mode in create_matrix\n");
+		return 1;
+	}
+
+	m->a = a;
+	m->b = b;
+	uint64_t malloc_size = ((size_t) a) * ((size_t) b);
+	switch(fp_mode){
+		case FP32:
+			malloc_size *= sizeof(float);
+			break;
+		case FP64:
+			malloc_size *= sizeof(double);
+			break;
+	}
+
+	void* malloc_pointer;
+
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){goto malloc_failure;}
+	memset(malloc_pointer, '\0', malloc_size);
+	switch(fp_mode){
+		case FP32:
+			m->bfr.fp32 = (float*) malloc_pointer;
+			break;
+		case FP64:
+			m->bfr.fp64 = (double*) malloc_pointer;
+			break;
+	}
+
+	malloc_size = a * b * sizeof(int8_t);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		switch(fp_mode){
+			case FP32:
+				free(m->bfr.fp32);
+				break;
+			case FP64:
+				free(m->bfr.fp64);
+				break;
+		}
+		goto malloc_failure;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	m->active = (uint8_t*) malloc_pointer;
+
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		switch(fp_mode){
+			case FP32:
+				free(m->bfr.fp32);
+				break;
+			case FP64:
+				free(m->bfr.fp64);
+				break;
+		}
+		goto malloc_failure;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	m->active_final = (uint8_t*) malloc_pointer;
+
+	m->fp_mode = fp_mode;
+
+	// m->to_free = 1;
+
+	return 0;
+
+	malloc_failure:
+	fprintf(stderr, "Failed to malloc %lu bytes\n", malloc_size);
+	return 1;
+}
+
+int32_t distance_matrix_from_graph(const struct graph* const restrict g, struct matrix* const restrict m){
+	if(m->a != m->b){
+		perror("m->a != m->b\n");
+		return 1;
+	}
+	if(((uint32_t) g->num_nodes) != m->a){
+		perror("g->num_nodes != m->a\n");
+		return 1;
+	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
+
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		switch(m->fp_mode){
+			case FP32:
+				m->bfr.fp32[i * m->b + i] = 0.0f;
+				break;
+			case FP64:
+				m->bfr.fp64[i * m->b + i] = 0.0;
+				break;
+		}
+		for(uint64_t j = i + 1 ; j < m->b ; j++){
+			switch(m->fp_mode){
+				case FP32:
+					m->bfr.fp32[i * m->b + j] = (float) graph_snapshot_distance(&(g->snapshot), i, j);
+					m->bfr.fp32[j * m->b + i] = m->bfr.fp32[i * m->b + j];
+					break;
+				case FP64:
+					m->bfr.fp64[i * m->b + j] = (double) cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+					m->bfr.fp64[j * m->b + i] = m->bfr.fp64[i * m->b + j];
+					break;
+			}
+		}
+	}	
+
+	return 0;
+}
+
+void* row_thread(void* args){
+	float* vector = (((struct row_thread_arg*) args)->vector);
+	const struct graph* g = (((struct row_thread_arg*) args)->g);
+	uint64_t i = ((struct row_thread_arg*) args)->i;
+	uint64_t start_j = ((struct row_thread_arg*) args)->start_j;
+	uint64_t end_j = ((struct row_thread_arg*) args)->end_j;
+
+	for(uint64_t j = start_j ; j < end_j ; j++){
+		vector[j] = graph_snapshot_distance(&(g->snapshot), i, j);
+	}
+	return NULL;
+}
+
+void distance_row_from_graph(const struct graph* const restrict g, const int32_t i, float* const restrict vector){
+	for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+		vector[j] = graph_snapshot_distance(&(g->snapshot), i, j);
+	}
+}
+
+int32_t distance_row_from_graph_multithread(const struct graph* const g, const uint64_t i, float* const vector, const int16_t num_row_threads){
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
+	pthread_t threads[num_row_threads];
+	struct row_thread_arg args[num_row_threads];
+	uint64_t start_j = 0;
+	uint64_t end_j;
+	for(int16_t k = 0 ; k < num_row_threads ; k++){
+		end_j = start_j + floor(g->num_nodes / num_row_threads);
+		if(((uint64_t) k) < g->num_nodes % ((uint64_t) num_row_threads)){
+			end_j++;
+		}
+		args[k].i = i;
+		args[k].start_j = start_j;
+		args[k].end_j = end_j;
+		args[k].vector = vector;
+		args[k].g = g;
+		if(pthread_create(&(threads[k]), NULL, row_thread, &(args[k])) != 0){
+			perror("failed to create row thread\n");
+			return 1;
+		}
+		start_j = end_j;
+	}
+
+	for(int16_t a = 0 ; a < num_row_threads ; a++){
+		if(pthread_join(threads[a], NULL) != 0){
+			perror("failed to join matrix thread\n");
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void* batch_row_thread(void* args){
+	float* vector = (((struct row_thread_arg*) args)->vector);
+	const struct graph* g = (((struct row_thread_arg*) args)->g);
+	uint64_t i = ((struct row_thread_arg*) args)->i;
+	uint64_t start_j = ((struct row_thread_arg*) args)->start_j;
+	uint64_t end_j = ((struct row_thread_arg*) args)->end_j;
+
+	for(uint64_t j = start_j ; j < end_j ; j++){
+		vector[j] = graph_snapshot_distance(&(g->snapshot), i, j);
+	}
+	return NULL;
+}
+
+int32_t distance_row_batch_from_graph_multithread(const struct graph* const g, const uint64_t i, float* const vector, const int16_t num_threads, int16_t batch_size){
+	pthread_t threads[num_threads];
+	struct batch_row_thread_arg args[num_threads];
+
+	if(batch_size > num_threads){
+		perror("In distance_row_batch_from_graph_multithread, batch_size must be lower or equal to the number of threads\n");
+		return 1;
+	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
+
+	if(i + batch_size >= g->num_nodes){
+		batch_size = g->num_nodes - i;
+	}
+
+	int16_t thread_index = 0;
+	const int16_t step_threads_to_launch = floor(num_threads / batch_size);
+	for(int16_t a = 0 ; a < batch_size ; a++){
+		int16_t num_threads_to_launch = step_threads_to_launch;
+		if(a < num_threads % batch_size){
+			num_threads_to_launch++;
+		}
+		uint64_t start_j = 0;
+		uint64_t end_j;
+		const uint64_t step_j = floor(g->num_nodes / num_threads_to_launch);
+		for(int16_t k = 0 ; k < num_threads_to_launch ; k++){
+			end_j = start_j + step_j;
+			if(((uint64_t) k) < g->num_nodes % ((uint64_t) num_threads_to_launch)){
+				end_j++;
+			}
+			args[thread_index] = (struct batch_row_thread_arg) {
+				.i = i + a,
+				.start_j = start_j,
+				.end_j = end_j,
+				.vector = &(vector[a * g->num_nodes]),
+				.g = g,
+			};
+			if(pthread_create(&(threads[thread_index]), NULL, batch_row_thread, &(args[thread_index])) != 0){
+				perror("Failed to create batch row thread\n");
+				return 1;
+			}
+			start_j = end_j;
+			thread_index++;
+		}
+	}
+
+	for(int16_t a = 0 ; a < num_threads ; a++){
+		if(pthread_join(threads[a], NULL) != 0){
+			perror("failed to join matrix thread\n");
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+void* matrix_thread(void* args){
+	int32_t thread_rank = (int32_t) (((struct matrix_thread_arg*) args)->thread_rank);
+	int32_t thread_total_count = (int32_t) (((struct matrix_thread_arg*) args)->thread_total_count);
+	struct matrix* m = ((struct matrix_thread_arg*) args)->m;
+	struct graph* g = ((struct matrix_thread_arg*) args)->g;
+	for(uint64_t i = (uint64_t) thread_rank ; i < m->a ; i += thread_total_count){
+		switch(m->fp_mode){
+			case FP32:
+				m->bfr.fp32[i * m->b + i] = 0.0f;
+				break;
+			case FP64:
+				m->bfr.fp64[i * m->b + i] = 0.0;
+				break;
+		}
+		for(uint64_t j = i + 1 ; j < m->b ; j++){
+			switch(m->fp_mode){
+				case FP32:
+					m->bfr.fp32[i * m->b + j] = (float) graph_snapshot_distance(&(g->snapshot), i, j);
+					m->bfr.fp32[j * m->b + i] = m->bfr.fp32[i * m->b + j];
+					break;
+				case FP64:
+					m->bfr.fp64[i * m->b + j] = (double) cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+					m->bfr.fp64[j * m->b + i] = m->bfr.fp64[i * m->b + j];
+					break;
+			}
+		}
+	}
+	return NULL;
+}
+
+int32_t distance_matrix_from_graph_multithread(struct graph* const g, struct matrix* const m, const int16_t num_matrix_threads){
+	if(m->a != m->b){
+		perror("m->a != m->b\n");
+		return 1;
+	}
+	if(((uint32_t) g->num_nodes) != m->a){
+		perror("g->num_nodes != m->a\n");
+		printf("g->num_nodes: %lu\n", g->num_nodes);
+		printf("m->a: %u\n", m->a);
+		return 1;
+	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
+	
+	pthread_t threads[num_matrix_threads];
+	struct matrix_thread_arg args[num_matrix_threads];
+	for(int32_t i = 0 ; i < num_matrix_threads ; i++){
+		args[i].thread_rank = i;
+		args[i].thread_total_count = num_matrix_threads;
+		args[i].m = m;
+		args[i].g = g;
+		if(pthread_create(&(threads[i]), NULL, matrix_thread, &(args[i])) != 0){
+			perror("failed to create matrix thread\n");
+			return 1;
+		}
+	}
+
+	for(int32_t i = 0 ; i < num_matrix_threads ; i++){
+		if(pthread_join(threads[i], NULL) != 0){
+			perror("failed to join matrix thread\n");
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// rows and columns of the nodes from first_new_node on; rows are dealt round-robin, as in matrix_thread
+void* matrix_extend_thread(void* args){
+	const struct matrix_thread_arg* const a = (struct matrix_thread_arg*) args;
+	struct matrix* const m = a->m;
+	const struct graph* const g = a->g;
+	for(uint64_t i = a->first_new_node + a->thread_rank ; i < m->a ; i += a->thread_total_count){
+		switch(m->fp_mode){
+			case FP32:
+				m->bfr.fp32[i * m->b + i] = 0.0f;
+				for(uint64_t j = 0 ; j < i ; j++){
+					m->bfr.fp32[i * m->b + j] = (float) graph_snapshot_distance(&(g->snapshot), i, j);
+					m->bfr.fp32[j * m->b + i] = m->bfr.fp32[i * m->b + j];
+				}
+				break;
+			case FP64:
+				m->bfr.fp64[i * m->b + i] = 0.0;
+				for(uint64_t j = 0 ; j < i ; j++){
+					m->bfr.fp64[i * m->b + j] = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+					m->bfr.fp64[j * m->b + i] = m->bfr.fp64[i * m->b + j];
+				}
+				break;
+		}
+	}
+	return NULL;
+}
+
+// fills what a matrix grown by grow_matrix lacks: the (num_nodes - first_new_node) * num_nodes distances of the new nodes, read from the snapshot
+int32_t distance_matrix_extend_from_graph_multithread(struct graph* const g, struct matrix* const m, const uint64_t first_new_node, const int16_t num_matrix_threads){
+	if(m->a != m->b || ((uint32_t) g->num_nodes) != m->a){
+		perror("matrix does not match the number of nodes\n");
+		return 1;
+	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
+
+	const int16_t num_threads = num_matrix_threads < 1 ? 1 : (num_matrix_threads > UINT8_MAX ? UINT8_MAX : num_matrix_threads);
+	pthread_t threads[num_threads];
+	struct matrix_thread_arg args[num_threads];
+	int16_t num_created = 0;
+	int32_t result = 0;
+	for(int16_t i = 0 ; i < num_threads ; i++){
+		args[i] = (struct matrix_thread_arg) {
+			.m = m,
+			.g = g,
+			.thread_rank = (uint8_t) i,
+			.thread_total_count = (uint8_t) num_threads,
+			.first_new_node = first_new_node,
+		};
+	}
+	if(num_threads == 1){
+		matrix_extend_thread(&(args[0]));
+		return 0;
+	}
+	for(int16_t i = 0 ; i < num_threads ; i++){
+		if(pthread_create(&(threads[i]), NULL, matrix_extend_thread, &(args[i])) != 0){
+			perror("failed to create matrix thread\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int16_t i = 0 ; i < num_created ; i++){
+		if(pthread_join(threads[i], NULL) != 0){
+			perror("failed to join matrix thread\n");
+			result = 1;
+		}
+	}
+	return result;
+}
+
+// n x n matrix whose first a rows and columns are those of m; the new cells and every flag are zero
+int32_t grow_matrix(struct matrix* const m, const uint32_t n){
+	struct matrix grown = { .fp_mode = m->fp_mode, };
+	if(n < m->a || m->a != m->b){
+		perror("grow_matrix only grows square matrices\n");
+		return 1;
+	}
+	if(create_matrix(&grown, n, n, m->fp_mode) != 0){return 1;}
+	const size_t cell_size = m->fp_mode == FP64 ? sizeof(double) : sizeof(float);
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		memcpy(((char*) grown.bfr.fp32) + i * n * cell_size, ((char*) m->bfr.fp32) + i * m->b * cell_size, m->b * cell_size);
+	}
+	free_matrix(m);
+	*m = grown;
+	return 0;
+}
+
+void free_matrix(struct matrix* m){
+	// if(m->to_free == 0){return;}
+	/*
+	switch(m->fp_mode){
+		case FP32:
+			free(m->bfr.fp32);
+			break;
+		case FP64:
+			free(m->bfr.fp64);
+			break;
+		default:
+			perror("Unknown m->fp_mode in free_matrix\n");
+			exit(1);
+	}
+	*/
+	free((void*) m->bfr.fp32);
+	free(m->active);
+	free(m->active_final);
+	// m->to_free = 0;
+}
+
+int32_t stats_matrix(struct matrix* m, double* avg_p, double* std_p, double* min_p, double* max_p){
+	double sum = 0.0;
+	double min;
+	double max;
+	if(m->a <= 0 || m->b <= 0){
+		perror("incorrect matrix dimensions\n");
+		return 1;
+	}
+	switch(m->fp_mode){
+		case FP32:
+			min = (double) m->bfr.fp32[0];
+			max = (double) m->bfr.fp32[0];
+			break;
+		case FP64:
+			min = m->bfr.fp64[0];
+			max = m->bfr.fp64[0];
+			break;
+		default:
+			perror("unknown floating point mode\n");
+			return 1;
+	}
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		for(uint64_t j = 0 ; j < m->b ; j++){
+			double value;
+			switch(m->fp_mode){
+				case FP32:
+					value = (double) m->bfr.fp32[i * m->b + j];
+					break;
+				case FP64:
+					value = m->bfr.fp64[i * m->b + j];
+					break;
+				default:
+					perror("unknown floating point mode\n");
+					return 1;
+			}
+			if(value < min){min = value;}
+			if(value > max){max = value;}
+			sum += value;
+		}
+	}
+	double avg = sum / ((double) (m->a * m->b));
+
+	sum = 0.0;
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		for(uint64_t j = 0 ; j < m->b ; j++){
+			double value;
+			switch(m->fp_mode){
+				case FP32:
+					value = (double) m->bfr.fp32[i * m->b + j];
+					break;
+				case FP64:
+					value = m->bfr.fp64[i * m->b + j];
+					break;
+				default:
+					perror("unknown floating point mode\n");
+					return 1;
+			}
+			sum += pow(value - avg, 2.0);
+		}
+	}
+
+	double std = pow(sum / ((double) (m->a * m->b)), 0.5);
+
+	(*avg_p) = avg;
+	(*std_p) = std;
+	(*min_p) = min;
+	(*max_p) = max;
+
+	return 0;
+}
+
+
+int32_t void_strcmp(const void* a, const void* b){
+	return strcmp((char*) a, (char*) b);
+}
+
+// int32_t create_graph_node(struct graph_node* restrict node, const int16_t num_dimensions, const int8_t fp_mode){
+int32_t create_graph_node(struct graph_node* restrict node, const uint16_t num_dimensions, const uint8_t fp_mode){
+	static int32_t num_graph_node_created = 0;
+
+#if INITIALIZE_GRAPH_WITH_RANDOM_VECTOR == 1
+	uint64_t malloc_size;
+#endif
+
+	node->already_considered = 0;
+
+	node->num_dimensions = num_dimensions;
+
+	// allocated by request_more_neighbour_capacity_graph_node on first use
+	node->num_neighbours = 0;
+	node->capacity_neighbours = 0;
+	node->neighbours = NULL;
+
+#if INITIALIZE_GRAPH_WITH_RANDOM_VECTOR == 1
+		malloc_size = 0;
+		switch(fp_mode){
+			case GRAPH_NODE_FP32:
+				malloc_size = num_dimensions * sizeof(float);
+				break;
+			case GRAPH_NODE_FP64:
+				malloc_size = num_dimensions * sizeof(double);
+				break;
+		}
+		void* malloc_pointer = malloc(malloc_size);
+		if(malloc_pointer == NULL){goto malloc_fail;}
+		memset(malloc_pointer, 0, malloc_size);
+		switch(fp_mode){
+			case GRAPH_NODE_FP32:
+				(*node).vector.fp32 = (float*) malloc_pointer;
+				break;
+			case GRAPH_NODE_FP64:
+				(*node).vector.fp64 = (double*) malloc_pointer;
+				break;
+		}
+	
+		for(int16_t i = 0 ; i < num_dimensions ; i++){
+			double current_rand = (double) (rand() % RANDOM_MODULO);
+			current_rand /= RANDOM_MODULO;
+			current_rand *= (RANDOM_MAX_VALUE - RANDOM_MIN_VALUE);
+			current_rand += RANDOM_MIN_VALUE;
+			if(ENABLE_EXTREMES && __atomic_load_n(&num_graph_node_created, __ATOMIC_RELAXED) % EXTREME_STEP == 0){
+				current_rand *= EXTREME_RATIO;
+			}
+			switch(fp_mode){
+				case GRAPH_NODE_FP32:
+					(*node).vector.fp32[i] = (float) current_rand;
+					break;
+				case GRAPH_NODE_FP64:
+					(*node).vector.fp64[i] = current_rand;
+					break;
+			}
+		}
+#else
+		switch(fp_mode){
+			case GRAPH_NODE_FP32:
+				node->vector.fp32 = NULL;
+				break;
+			case GRAPH_NODE_FP64:
+				node->vector.fp64 = NULL;
+				break;
+		}
+#endif
+
+	node->relative_proportion = 0.0;
+	node->absolute_proportion = 0;
+
+	__atomic_fetch_add(&num_graph_node_created, 1, __ATOMIC_RELAXED);
+
+	return 0;
+
+#if INITIALIZE_GRAPH_WITH_RANDOM_VECTOR == 1
+	malloc_fail:
+	perror("malloc failed\n");
+	return 1;
+#endif
+}
+
+int32_t request_more_neighbour_capacity_graph_node(struct graph_node* node){
+	const int32_t new_capacity = node->capacity_neighbours + GRAPH_NODE_NEIGHBOUR_STEP;
+	const uint64_t malloc_size = new_capacity * sizeof(struct graph_neighbour);
+	node->neighbours = (struct graph_neighbour*) realloc(node->neighbours, malloc_size);
+	if(node->neighbours == NULL){
+		fprintf(stderr, "realloc (graph node neighbours) failed for %lu bytes\n", malloc_size);
+		return 1;
+	}
+	node->capacity_neighbours = new_capacity;
+
+	return 0;
+}
+
+void free_graph_node(struct graph_node* restrict node, const int8_t fp_mode){
+	switch(fp_mode){
+		case GRAPH_NODE_FP32:
+			free((*node).vector.fp32);
+			break;
+		case GRAPH_NODE_FP64:
+			free((*node).vector.fp64);
+			break;
+	}
+	free(node->neighbours);
+}
+
+
+int32_t create_graph(struct graph* restrict const g, const int32_t num_nodes, const int16_t num_dimensions, const int8_t fp_mode){
+	if(create_graph_empty(g) != 0){goto malloc_fail;}
+	while(g->capacity < (uint64_t) num_nodes){
+		if(request_more_capacity_graph(g) != 0){goto malloc_fail;}
+	}
+	g->num_nodes = num_nodes;
+	g->num_dimensions = num_dimensions;
+	// g->dist_mat.to_free = 0;
+	g->dist_mat = (struct matrix) { .fp_mode = fp_mode, };
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		int32_t res;
+		double proportion;
+		res = create_graph_node(graph_node_at(g, i), num_dimensions, fp_mode);
+		if(res != 0){goto create_graph_node_failed;}
+		if(CONSTANT_RELATIVE_PROPORTION){
+			proportion = 1.0;
+		} else {
+			proportion = (double) (rand() % MAX_ABUNDANCE);
+		}
+		graph_node_at(g, i)->absolute_proportion = (uint64_t) proportion;
+	}
+	if(compute_graph_relative_proportions(g) != 0){goto malloc_fail;}
+
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	printf("errno: %i\n", errno);
+	goto return_failure;
+
+	create_graph_node_failed:
+	perror("create_graph_node failed\n");
+	goto return_failure;
+
+	return_failure:
+	g->num_nodes = 0;
+	free_graph(g);
+	return 1;
+}
+
+// adds the next chunk; chunks already handed out are never moved, so pointers to nodes stay valid while the graph grows
+int32_t request_more_capacity_graph(struct graph* restrict const g){
+	if(g->num_chunks >= GRAPH_NUM_CHUNKS){
+		perror("graph chunk directory is full\n");
+		return 1;
+	}
+	const uint64_t chunk_size = ((uint64_t) 1) << (GRAPH_FIRST_CHUNK_SHIFT + g->num_chunks);
+	void* malloc_pointer = calloc(chunk_size, sizeof(struct graph_node));
+	if(malloc_pointer == NULL){
+		perror("failed to calloc\n");
+		return 1;
+	}
+	g->chunks[g->num_chunks] = (struct graph_node*) malloc_pointer;
+	g->num_chunks++;
+	g->capacity += chunk_size;
+
+	return 0;
+}
+
+int32_t create_graph_empty(struct graph* restrict const g){
+	memset(g->chunks, '\0', GRAPH_NUM_CHUNKS * sizeof(struct graph_node*));
+	g->num_chunks = 0;
+	g->num_nodes = 0;
+	g->capacity = 0;
+	g->num_dimensions = 0;
+	g->dist_mat = (struct matrix) { .fp_mode = FP32, };
+	g->dist_mat_must_be_freed = 0;
+	memset(&(g->snapshot), '\0', sizeof(struct graph_snapshot));
+	g->word2vec_slots = NULL;
+	g->num_word2vec_slots = 0;
+	pthread_mutex_init(&(g->mutex_nodes), NULL);
+	pthread_mutex_init(&(g->mutex_matrix), NULL);
+
+	if(request_more_capacity_graph(g) != 0){
+		return 1;
+	}
+
+	return 0;
+}
+
+// copies the node into the next slot and publishes it; readers that do not hold mutex_nodes see it once graph_num_nodes covers its index
+int32_t graph_append_node(struct graph* const g, const struct graph_node* const node, uint64_t* const index){
+	int32_t result = 0;
+
+	pthread_mutex_lock(&(g->mutex_nodes));
+	if(g->num_nodes >= g->capacity && request_more_capacity_graph(g) != 0){
+		perror("failed to call request_more_capacity_graph\n");
+		result = 1;
+		goto unlock;
+	}
+	*graph_node_at(g, g->num_nodes) = *node;
+	*index = g->num_nodes;
+	__atomic_store_n(&(g->num_nodes), g->num_nodes + 1, __ATOMIC_RELEASE);
+
+	unlock:
+	pthread_mutex_unlock(&(g->mutex_nodes));
+	return result;
+}
+
+// same as graph_append_node for num_nodes consecutive nodes, with one lock and the capacity reserved up front; *first_index receives the index of nodes[0]
+int32_t graph_append_nodes(struct graph* const g, const struct graph_node* const nodes, const uint64_t num_nodes, uint64_t* const first_index){
+	int32_t result = 0;
+
+	pthread_mutex_lock(&(g->mutex_nodes));
+	while(g->num_nodes + num_nodes > g->capacity){
+		if(request_more_capacity_graph(g) != 0){
+			perror("failed to call request_more_capacity_graph\n");
+			result = 1;
+			goto unlock;
+		}
+	}
+	for(uint64_t i = 0 ; i < num_nodes ; i++){
+		*graph_node_at(g, g->num_nodes + i) = nodes[i];
+	}
+	*first_index = g->num_nodes;
+	__atomic_store_n(&(g->num_nodes), g->num_nodes + num_nodes, __ATOMIC_RELEASE);
+
+	unlock:
+	pthread_mutex_unlock(&(g->mutex_nodes));
+	return result;
+}
+
+// proportions are computed once, for both the nodes and the snapshot; vectors already in the snapshot are kept but no new row is gathered
+int32_t compute_graph_relative_proportions(struct graph* const g){
+	if(graph_snapshot_refresh(g, 0, 1) != 0){
+		perror("failed to call graph_snapshot_refresh\n");
+		return 1;
+	}
+	return 0;
+}
+
+int32_t compute_graph_dist_mat(struct graph* const g, const int16_t num_matrix_threads){
+	/*
+	size_t alloc_size;
+
+	alloc_size = (size_t) (g->num_nodes * g->num_nodes * sizeof(float));
+	g->dist_mat = (float*) realloc(g->dist_mat, alloc_size);
+	if(g->dist_mat == NULL){
+		perror("failed to realloc\n");
+		return 1;
+	}
+	memset(g->dist_mat, '\0', alloc_size);
+
+	for(i = 0 ; i < g->num_nodes ; i++){
+		for(j = i + 1 ; j
+	}
+	*/
+	if(distance_matrix_from_graph_multithread(g, &(g->dist_mat), num_matrix_threads) != 0){
+		perror("failed to call distance_matrix_from_graph\n");
+		return 1;
+	}
+
+	g->dist_mat_must_be_freed = 1;
+
+	return 0;
+}
+
+int32_t word2vec_entry_cmp(const void* restrict a, const void* restrict b){
+	return strcmp(((struct word2vec_entry*) a)->key, ((struct word2vec_entry*) b)->key);
+}
+
+// makes room for one more key of at most WORD2VEC_KEY_BUFFER_SIZE bytes, NUL included
+static int32_t reserve_word2vec_key(struct word2vec* restrict const w2v, size_t* const capacity){
+	if(w2v->key_blob_size + WORD2VEC_KEY_BUFFER_SIZE <= *capacity){return 0;}
+	void* malloc_pointer = realloc(w2v->key_blob, (*capacity) * 2);
+	if(malloc_pointer == NULL){return 1;}
+	w2v->key_blob = (char*) malloc_pointer;
+	*capacity *= 2;
+	return 0;
+}
+
+int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict path){
+	const int32_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	// printf("Creating graph from word2vec binary %s\n", path);
+	memset(log_bfr, '\0', log_bfr_size * sizeof(char));
+	snprintf(log_bfr, log_bfr_size, "Creating graph from word2vec binary: %s", path);
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+	size_t* key_offsets = NULL;
+	w2v->vectors = NULL;
+	w2v->keys = NULL;
+	w2v->key_blob = NULL;
+
+	FILE* file_p;
+	file_p = fopen(path, "r");
+	if(file_p == NULL){
+		perror("failed to open word2vec file\n");
+		return 1;
+	}
+	const int32_t first_line_buffer_size = 64;
+	char bfr_read[first_line_buffer_size];
+	memset(bfr_read, '\0', first_line_buffer_size);
+	if(fgets(bfr_read, first_line_buffer_size, file_p) == 0){ // compliance
+		perror("initial fgets didn't read anything\n");
+		fclose(file_p);
+		return 1;
+	}
+	char* start_num_dimensions = strchr(bfr_read, ' ');
+	if(start_num_dimensions == NULL){
+		perror("cannot find number of dimensions in word2vec binary\n");
+		fclose(file_p);
+		return 1;
+	}
+	int64_t num_vectors = strtol(bfr_read, &start_num_dimensions, 10);
+	start_num_dimensions++;
+	char* end_num_dimensions = strchr(start_num_dimensions, '\n');
+	if(end_num_dimensions == NULL){
+		perror("cannot find end of number of dimensions in word2vec binary\n");
+		fclose(file_p);
+		return 1;
+	}
+	int16_t num_dimensions = (int16_t) strtol(start_num_dimensions, &end_num_dimensions, 10);
+
+	// printf("number of nodes: %li\nnumber of dimensions: %i\n", num_vectors, num_dimensions);
+	memset(log_bfr, '\0', log_bfr_size * sizeof(char));
+	snprintf(log_bfr, log_bfr_size, "Number of nodes: %li; number of dimensions: %i", num_vectors, num_dimensions);
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+	w2v->num_dimensions = num_dimensions;
+	w2v->num_vectors = num_vectors;
+
+	const size_t word2vec_vector_buffer_read_size = 1024;
+	char vector_buffer_read[word2vec_vector_buffer_read_size];
+	memset(vector_buffer_read, '\0', word2vec_vector_buffer_read_size);
+
+	size_t malloc_size = num_vectors * num_dimensions * sizeof(float);
+	void* malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){goto malloc_fail;}
+	memset(malloc_pointer, '\0', malloc_size);
+	w2v->vectors = (float*) malloc_pointer;
+
+	malloc_size = w2v->num_vectors * sizeof(struct word2vec_entry);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){goto malloc_fail;}
+	memset(malloc_pointer, '\0', malloc_size);
+	w2v->keys = (struct word2vec_entry*) malloc_pointer;
+
+	// keys are appended to a single blob; entries point into it once it has stopped moving
+	size_t key_blob_capacity = w2v->num_vectors * 8 + WORD2VEC_KEY_BUFFER_SIZE;
+	w2v->key_blob = (char*) malloc(key_blob_capacity);
+	if(w2v->key_blob == NULL){goto malloc_fail;}
+	w2v->key_blob_size = 0;
+	key_offsets = (size_t*) malloc(w2v->num_vectors * sizeof(size_t));
+	if(key_offsets == NULL){goto malloc_fail;}
+
+	uint64_t parsing_key = 1;
+	uint64_t h = 0;
+	uint64_t i = 0;
+	uint64_t j = 0;
+	uint64_t k = 0;
+	uint64_t actual_vector_buffer_read_size;
+	actual_vector_buffer_read_size = (uint64_t) fread(vector_buffer_read, 1, word2vec_vector_buffer_read_size, file_p);
+	j = 0;
+	
+	while(i < w2v->num_vectors){
+		if(parsing_key){
+			while(j < actual_vector_buffer_read_size){ // fread
+				if(vector_buffer_read[j] == ' '){
+					parsing_key = 0;
+					j++;
+					break;
+				}
+				if(h < WORD2VEC_KEY_BUFFER_SIZE - 1){
+					if(h == 0){
+						if(reserve_word2vec_key(w2v, &key_blob_capacity) != 0){goto malloc_fail;}
+						key_offsets[i] = w2v->key_blob_size;
+					}
+					w2v->key_blob[w2v->key_blob_size++] = vector_buffer_read[j];
+					h++;
+				}
+				j++;
+			}
+		}
+
+		if(j == actual_vector_buffer_read_size){ // fread
+			actual_vector_buffer_read_size = fread(vector_buffer_read, 1, word2vec_vector_buffer_read_size, file_p);
+			j = 0;
+		}
+
+		if(!parsing_key){
+			while(k < w2v->num_dimensions && j < actual_vector_buffer_read_size){ // fread
+				if(j + sizeof(float) >= (uint64_t) actual_vector_buffer_read_size){
+					fseek(file_p, j - actual_vector_buffer_read_size, SEEK_CUR);
+					actual_vector_buffer_read_size = fread(vector_buffer_read, 1, word2vec_vector_buffer_read_size, file_p);
+					j = 0;
+				}
+				memcpy((void*) &(w2v->vectors[i * w2v->num_dimensions + k]), (void*) &(vector_buffer_read[j]), sizeof(float));
+				k++;
+				j += sizeof(float);
+			}
+			if(k == w2v->num_dimensions){
+				if(h == 0){ // empty key
+					if(reserve_word2vec_key(w2v, &key_blob_capacity) != 0){goto malloc_fail;}
+					key_offsets[i] = w2v->key_blob_size;
+				}
+				w2v->key_blob[w2v->key_blob_size++] = '\0';
+				k = 0;
+				h = 0;
+				parsing_key = 1;
+				w2v->keys[i].vector = &(w2v->vectors[i * w2v->num_dimensions]);
+				i++;
+				while(j < actual_vector_buffer_read_size && vector_buffer_read[j] == '\n'){ // fread
+					j++;
+				}
+			}
+		}
+
+		if(j >= actual_vector_buffer_read_size){
+			actual_vector_buffer_read_size = fread(vector_buffer_read, 1, word2vec_vector_buffer_read_size, file_p);
+			j = 0;
+		}
+	}
+
+	fclose(file_p);
+
+	for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
+		w2v->keys[i].key = w2v->key_blob + key_offsets[i];
+		w2v->keys[i].num_occurrences = 0;
+	}
+	free(key_offsets);
+
+	qsort((void*) w2v->keys, w2v->num_vectors, sizeof(struct word2vec_entry), word2vec_entry_cmp);
+
+	#if MST_SANITY_TESTING == 1
+	w2v->num_dimensions = 2;
+	#endif
+
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	printf("errno: %i\n", errno);
+	if(w2v->vectors != NULL){free(w2v->vectors);}
+	if(w2v->keys != NULL){free(w2v->keys);}
+	free(w2v->key_blob);
+	free(key_offsets);
+	fclose(file_p);
+	goto return_failure;
+
+	return_failure:
+	return 1;
+}
+
+// gives the graph an empty slot per entry of w2v; a graph is bound before its first graph_add_word2vec_occurrence
+int32_t graph_bind_word2vec(struct graph* const g, const struct word2vec* const w2v){
+	free(g->word2vec_slots);
+	g->num_word2vec_slots = 0;
+	g->word2vec_slots = (struct graph_word2vec_slot*) calloc(w2v->num_vectors > 0 ? w2v->num_vectors : 1, sizeof(struct graph_word2vec_slot));
+	if(g->word2vec_slots == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	g->num_word2vec_slots = w2v->num_vectors;
+	return 0;
+}
+
+// adds one occurrence of the entry to the graph; the first thread to see the entry creates its node, the others only increment its count
+int32_t graph_add_word2vec_occurrence(struct graph* const g, const struct word2vec* const w2v, struct word2vec_entry* const entry){
+	if(g->word2vec_slots == NULL || g->num_word2vec_slots != w2v->num_vectors){
+		perror("graph is not bound to this word2vec\n");
+		return 1;
+	}
+	struct graph_word2vec_slot* const slot = &(g->word2vec_slots[entry - w2v->keys]);
+	struct graph_node* node;
+	// the claiming thread may still be appending the node; if it fails, it releases the slot and the next thread claims it
+	while((node = __atomic_load_n(&(slot->node), __ATOMIC_ACQUIRE)) == NULL){
+		uint8_t expected = 0;
+		if(!__atomic_compare_exchange_n(&(slot->active), &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+			sched_yield();
+			continue;
+		}
+		struct graph_node local_node = {0};
+		uint64_t node_index;
+		if(create_graph_node(&local_node, w2v->num_dimensions, FP32) != 0){
+			perror("failed to call create_graph_node\n");
+			goto release_slot;
+		}
+		local_node.word2vec_entry_pointer = entry;
+		local_node.vector.fp32 = entry->vector;
+		local_node.num_dimensions = w2v->num_dimensions;
+		local_node.already_considered = 0;
+		local_node.relative_proportion = 1.0;
+		local_node.absolute_proportion = 1;
+		if(graph_append_node(g, &local_node, &node_index) != 0){
+			perror("failed to call graph_append_node\n");
+			goto release_slot;
+		}
+		slot->node_index = node_index;
+		__atomic_store_n(&(slot->node), graph_node_at(g, node_index), __ATOMIC_RELEASE);
+		return 0;
+
+		release_slot:
+		__atomic_store_n(&(slot->active), 0, __ATOMIC_RELEASE);
+		return 1;
+	}
+	__atomic_fetch_add(&(node->absolute_proportion), 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+void free_word2vec(struct word2vec* restrict w2v){
+	free(w2v->vectors);
+	free(w2v->keys);
+	free(w2v->key_blob);
+}
+
+int32_t word2vec_key_to_index(const struct word2vec* restrict w2v, const char* restrict key){
+	int32_t lower_bound = 0;
+	int32_t higher_bound = ((int32_t) w2v->num_vectors) - 1;
+	while(lower_bound <= higher_bound){
+		int32_t middle_index = lower_bound + floor((higher_bound - lower_bound) / 2.0);
+		int32_t cmp_res = strcmp(w2v->keys[middle_index].key, key);
+		if(cmp_res == 0){
+			return middle_index;
+		} else if(cmp_res < 0){
+			lower_bound = middle_index + 1;
+		} else {
+			higher_bound = middle_index - 1;
+		}
+	}
+	return -1;
+}
+
+
+struct word2vec_entry* word2vec_find_closest(const struct word2vec* restrict w2v, const char* restrict target){
+	const int64_t index_target = word2vec_key_to_index(w2v, target);
+	if(index_target == -1){
+		printf("cannot find target word\n");
+		return NULL;
+	}
+	uint64_t index_best = 0;
+	int32_t found_starting_point = 0;
+	while(index_best < w2v->num_vectors){
+		if(strcmp(w2v->keys[index_best].key, target) != 0){
+			found_starting_point = 1;
+			break;
+		}
+		if(index_best == UINT64_MAX){
+			perror("UINT64 overflow\n");
+			exit(1);
+		}
+		index_best++;
+	}
+	if(!found_starting_point){
+		printf("cannot find starting point\n");
+		return NULL;
+	}
+	float distance_best;
+		
+	#if ENABLE_AVX512 == 1
+	distance_best = cosine_distance_fp32_avx512(w2v->keys[index_best].vector, w2v->keys[index_target].vector, w2v->num_dimensions);
+	#elif ENABLE_AVX256 == 1
+	distance_best = cosine_distance_fp32_avx256(w2v->keys[index_best].vector, w2v->keys[index_target].vector, w2v->num_dimensions);
+	#elif MST_SANITY_TESTING == 1
+	distance_best = minkowski_distance_fp32(w2v->keys[index_best].vector, w2v->keys[index_target].vector, w2v->num_dimensions, 2.0f);
+	#else
+	distance_best = cosine_distance_fp32(w2v->keys[index_best].vector, w2v->keys[index_target].vector, w2v->num_dimensions);
+	#endif
+	for(uint64_t i = 1 ; i < w2v->num_vectors ; i++){
+		if(i == (uint64_t) index_target){
+			continue;
+		}
+		float local_distance;
+		#if ENABLE_AVX512 == 1
+		local_distance = cosine_distance_fp32_avx512(w2v->keys[i].vector, w2v->keys[index_target].vector, w2v->num_dimensions);
+		#elif ENABLE_AVX256 == 1
+		local_distance = cosine_distance_fp32_avx256(w2v->keys[i].vector, w2v->keys[index_target].vector, w2v->num_dimensions);
+		#elif MST_SANITY_TESTING == 1
+		local_distance = minkowski_distance_fp32(w2v->keys[i].vector, w2v->keys[index_target].vector, w2v->num_dimensions, 2.0f);
+		#else
+		local_distance = cosine_distance_fp32(w2v->keys[i].vector, w2v->keys[index_target].vector, w2v->num_dimensions);
+		#endif
+		if(local_distance < distance_best){
+			distance_best = local_distance;
+			index_best = i;
+		}
+	}
+	return &(w2v->keys[index_best]);
+}
+
+
+void free_graph(struct graph* restrict g){
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		// free_graph_node(graph_node_at(g, i), FP32); // not needed as pointers to w2v entries
+		free(graph_node_at(g, i)->neighbours);
+	}
+	for(uint32_t i = 0 ; i < g->num_chunks ; i++){
+		free(g->chunks[i]);
+		g->chunks[i] = NULL;
+	}
+	g->num_chunks = 0;
+	g->capacity = 0;
+    pthread_mutex_destroy(&(g->mutex_nodes));
+	// if(g->dist_mat != NULL){free(g->dist_mat);}
+	if(g->dist_mat_must_be_freed){
+		free_matrix(&(g->dist_mat));
+		g->dist_mat_must_be_freed = 0;
+	}
+	free_graph_snapshot(&(g->snapshot));
+	free(g->word2vec_slots);
+	g->word2vec_slots = NULL;
+	g->num_word2vec_slots = 0;
+    pthread_mutex_destroy(&(g->mutex_matrix));
+}
+
+// void create_distance_two_nodes(struct distance_two_nodes* restrict distance, struct graph_node* restrict a, struct graph_node* restrict b, const int8_t fp_mode, const float* const distance_value){
+// 	if(a < b){
+// 		(*distance).a = a;
+// 		(*distance).b = b;
+// 	} else {
+// 		(*distance).a = b;
+// 		(*distance).b = a;
+// 	}
+// 
+// 	if(distance_value == NULL){
+// 		switch(fp_mode){
+// 			case GRAPH_NODE_FP32:
+// 				#if ENABLE_AVX512 == 1
+// 				distance->distance = cosine_distance_fp32_avx512(distance->a->vector.fp32, distance->b->vector.fp32, (int32_t) a->num_dimensions);
+// 				#elif ENABLE_AVX256 == 1
+// 				distance->distance = cosine_distance_fp32_avx256(distance->a->vector.fp32, distance->b->vector.fp32, (int32_t) a->num_dimensions);
+// 				#else
+// 				distance->distance = cosine_distance_fp32(distance->a->vector.fp32, distance->b->vector.fp32, (int32_t) a->num_dimensions);
+// 				#endif
+// 				break;
+// 			case GRAPH_NODE_FP64:
+// 				distance->distance = cosine_distance(distance->a->vector.fp64, distance->b->vector.fp64, (int32_t) a->num_dimensions);
+// 				break;
+// 		}
+// 	} else {
+// 		distance->distance = (*distance_value);
+// 	}
+// 	/* // DO NOT REMOVE
+// 	(*distance).usable = 1;
+// 	*/
+// }
+
+void create_distance_two_nodes(struct distance_two_nodes* restrict distance, uint32_t a, uint32_t b, const float distance_value){
+	if(a > b){
+		const uint32_t c = a;
+		a = b;
+		b = c;
+	}
+	*distance = (struct distance_two_nodes) { .a = a, .b = b, .distance = distance_value, };
+}
+
+//void siftdown_min_heap(struct graph_distance_heap* const restrict heap, const uint64_t current_index){
+//#ifndef NDEBUG
+//	uint64_t child_a_index;
+//	uint64_t child_b_index;
+//	if((UINT64_MAX - 2) / 2 >= current_index){
+//		child_a_index = (current_index * 2 + 1);
+//		child_b_index = child_a_index + 1;
+//	} else {
+//		perror("UINT64 overflow\n");
+//		exit(1);
+//	}
+//#else
+//	const uint64_t child_a_index = current_index * 2 + 1;
+//	const uint64_t child_b_index = child_a_index + 1;
+//#endif
+//
+//	struct distance_two_nodes * const restrict distances = heap->distances;
+//
+//	const float dist_curr = distances[current_index].distance;
+//	float dist_a = 1.0e100;
+//	float dist_b = 1.0e100;
+//	if(child_a_index < heap->num_distances){
+//		dist_a = distances[child_a_index].distance;
+//		if(child_b_index < heap->num_distances){dist_b = distances[child_b_index].distance;}
+//	}
+//
+//	/**/ // DO NOT REMOVE, WORKS
+//	const int32_t reachable_a = child_a_index < heap->num_distances;
+//	const int32_t reachable_b = child_b_index < heap->num_distances;
+//
+//	if(reachable_a && distances[child_a_index].distance < distances[current_index].distance){ // better_a
+//		if(reachable_b && distances[child_b_index].distance < distances[current_index].distance && !(distances[child_a_index].distance < distances[child_b_index].distance)){ // better_b && !a_better_than_b
+//			struct distance_two_nodes swap = distances[current_index];
+//			distances[current_index] = distances[child_b_index];
+//			distances[child_b_index] = swap;
+//			siftdown_min_heap(heap, child_b_index);
+//		} else {
+//			struct distance_two_nodes swap = distances[current_index];
+//			distances[current_index] = distances[child_a_index];
+//			distances[child_a_index] = swap;
+//			siftdown_min_heap(heap, child_a_index);
+//		}
+//	} else if(reachable_b && distances[child_b_index].distance < distances[current_index].distance){ // better_b
+//		struct distance_two_nodes swap = distances[current_index];
+//		distances[current_index] = distances[child_b_index];
+//		distances[child_b_index] = swap;
+//		siftdown_min_heap(heap, child_b_index);
+//	}  else if(reachable_a && reachable_b && distances[child_b_index].distance < distances[child_a_index].distance){ // modification to potentially improve the speed of pop_graph by always having the lowest of the two childrens on the left
+//		struct distance_two_nodes swap = distances[child_a_index];
+//		distances[child_a_index] = distances[child_b_index];
+//		distances[child_b_index] = swap;
+//		siftdown_min_heap(heap, child_a_index);	
+//		siftdown_min_heap(heap, child_b_index);	
+//	}
+//	/**/
+//	
+//// COMMENTING OUT FOR TESTING
+////	if(dist_a < dist_curr){ // better_a
+////		if(dist_b < dist_curr && !(dist_a < dist_b)){ // better_b && !a_better_than_b
+////			const struct distance_two_nodes swap = distances[current_index];
+////			distances[current_index] = distances[child_b_index];
+////			distances[child_b_index] = swap;
+////			/*
+////			struct distance_two_nodes swap;
+////			memcpy(&swap, distances + current_index, sizeof(struct distance_two_nodes));
+////			memcpy(distances + current_index, distances + child_b_index, sizeof(struct distance_two_nodes));
+////			memcpy(distances + child_b_index, &swap, sizeof(struct distance_two_nodes));
+////			*/
+////			siftdown_min_heap(heap, child_b_index);
+////		} else {
+////			const struct distance_two_nodes swap = distances[current_index];
+////			distances[current_index] = distances[child_a_index];
+////			distances[child_a_index] = swap;
+////			siftdown_min_heap(heap, child_a_index);
+////		}
+////	} else if(dist_b < dist_curr){ // better_b
+////		const struct distance_two_nodes swap = distances[current_index];
+////		distances[current_index] = distances[child_b_index];
+////		distances[child_b_index] = swap;
+////		siftdown_min_heap(heap, child_b_index);
+////	}  else if(dist_b < dist_a){ // modification to potentially improve the speed of pop_graph by always having the lowest of the two childrens on the left
+////		const struct distance_two_nodes swap = distances[child_a_index];
+////		distances[child_a_index] = distances[child_b_index];
+////		distances[child_b_index] = swap;
+////		// siftdown_min_heap(heap, child_a_index);	// this can be removed as we are sure there is no violation of the heap property
+////		siftdown_min_heap(heap, child_b_index);	
+////	}
+////
+////	/*
+////	if(reachable_a && distances[child_a_index].distance < distances[current_index].distance){
+////		const struct distance_two_nodes swap = distances[current_index];
+////		distances[current_index] = distances[child_a_index];
+////		distances[child_a_index] = swap;
+////		siftdown_min_heap(heap, child_a_index);
+////	}
+////	if(reachable_b && distances[child_b_index].distance < distances[current_index].distance){
+////		const struct distance_two_nodes swap = distances[current_index];
+////		distances[current_index] = distances[child_b_index];
+////		distances[child_b_index] = swap;
+////		siftdown_min_heap(heap, child_b_index);
+////	}
+////	*/
+//}
+
+int32_t heap_is_min_heapified(struct graph_distance_heap* const heap){
+	struct distance_two_nodes * const restrict distances = heap->distances;
+	const struct graph * const restrict nodes_graph = heap->g;
+
+	// for(uint64_t i = 0 ; i < heap->num_distances ; i++){
+	for(uint64_t i = 0 ; i * 2 < heap->num_distances ; i++){
+	#ifndef NDEBUG
+		uint64_t child_a_index;
+		uint64_t child_b_index;
+		if((UINT64_MAX - 2) / 2 >= i){
+			child_a_index = (i * 2 + 1);
+			child_b_index = child_a_index + 1;
+		} else {
+			perror("UINT64 overflow\n");
+			exit(1);
+		}
+	#else
+		uint64_t child_a_index = i * 2 + 1;
+		uint64_t child_b_index = child_a_index + 1;
+	#endif
+
+		
+		uint64_t considered_count_i = (graph_node_at(nodes_graph, distances[i].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[i].b)->already_considered >= 1);
+		uint64_t considered_count_a = (graph_node_at(nodes_graph, distances[child_a_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_a_index].b)->already_considered >= 1);
+		uint64_t considered_count_b = (graph_node_at(nodes_graph, distances[child_b_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_b_index].b)->already_considered >= 1);
+
+		float dist_i = distances[i].distance;
+		float dist_a = distances[child_a_index].distance;
+		float dist_b = distances[child_b_index].distance;
+
+		uint64_t a_lt_curr;
+		uint64_t b_lt_curr;
+
+		if(considered_count_a != considered_count_i){a_lt_curr = considered_count_a == 1 || (considered_count_a == 0 && considered_count_i == 2);} else {a_lt_curr = dist_a < dist_i;}
+		if(considered_count_b != considered_count_i){b_lt_curr = considered_count_b == 1 || (considered_count_b == 0 && considered_count_i == 2);} else {b_lt_curr = dist_b < dist_i;}
+
+		// if(child_a_index < heap->num_distances && heap->distances[child_a_index].distance < heap->distances[i].distance){printf("%lu %f %f\n", i, heap->distances[i].distance, heap->distances[child_a_index].distance); return 0;}
+		// if(child_b_index < heap->num_distances && heap->distances[child_b_index].distance < heap->distances[i].distance){printf("%lu %f %f\n", i, heap->distances[i].distance, heap->distances[child_b_index].distance); return 0;}
+		if(child_a_index < heap->num_distances && a_lt_curr){printf("%lu %f %lu %f %lu\n", i, heap->distances[i].distance, considered_count_i, heap->distances[child_a_index].distance, considered_count_a); return 0;}
+		if(child_b_index < heap->num_distances && b_lt_curr){printf("%lu %f %lu %f %lu\n", i, heap->distances[i].distance, considered_count_i, heap->distances[child_b_index].distance, considered_count_b); return 0;}
+		// if(child_a_index < heap->num_distances && child_b_index < heap->num_distances && heap->distances[child_a_index].distance > heap->distances[child_b_index].distance){printf("%lu %f %f\n", i, heap->distances[child_a_index].distance, heap->distances[child_b_index].distance);}
+	}
+
+	return 1;
+}
+
+void siftdown_min_heap_v2(struct graph_distance_heap* const restrict heap, uint64_t current_index){
+#ifndef NDEBUG
+	uint64_t child_a_index;
+	uint64_t child_b_index;
+	if((UINT64_MAX - 2) / 2 >= current_index){
+		child_a_index = (current_index * 2 + 1);
+		child_b_index = child_a_index + 1;
+	} else {
+		perror("UINT64 overflow\n");
+		exit(1);
+	}
+#else
+	uint64_t child_a_index = current_index * 2 + 1;
+	uint64_t child_b_index = child_a_index + 1;
+#endif
+
+	struct distance_two_nodes * const restrict distances = heap->distances;
+	// const struct graph * const restrict nodes_graph = heap->g;
+
+	/*
+	if(current_index >= heap->num_distances){ // to handle case when doing popping when sifting?
+		return;
+	}
+	*/
+
+	/* // COMMENTING OUT FOR TESTING
+	// if(distances[current_index].a->already_considered && distances[current_index].b->already_considered){
+	if(graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){ // ok but stack overflow?
+	// if(current_index < 100000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
+	// if(current_index < 1000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
+		pop_graph_distance_min_heap_v2(heap, current_index); // pop_graph_distance_min_heap_v2 will call back siftdown_heap_v2 for current_index, so we can just return
+		return;
+	}
+	*/
+
+	const float dist_curr = distances[current_index].distance;
+
+	uint64_t reachable_a = 1;
+	uint64_t reachable_b = 1;
+
+	while(reachable_a || reachable_b){
+		child_a_index = current_index * 2 + 1;
+		child_b_index = child_a_index + 1;
+
+		reachable_a = child_a_index < heap->num_distances;
+		reachable_b = child_b_index < heap->num_distances;
+
+		float dist_a = 1.0e100;
+		float dist_b = 1.0e100;
+		if(reachable_a){
+			dist_a = distances[child_a_index].distance;
+			if(reachable_b){dist_b = distances[child_b_index].distance;}
+		}
+
+		if(reachable_a && reachable_b){
+			// if(dist_b < dist_a){ // modification to potentially improve the speed of pop_graph by always having the lowest of the two childrens on the left
+			while(dist_b < dist_a){ // modification to potentially improve the speed of pop_graph by always having the lowest of the two childrens on the left
+				const struct distance_two_nodes swap = distances[child_a_index];
+				distances[child_a_index] = distances[child_b_index];
+				distances[child_b_index] = swap;
+				
+				siftdown_min_heap_v2(heap, child_a_index); // not necessary?
+				siftdown_min_heap_v2(heap, child_b_index);
+
+				dist_a = distances[child_a_index].distance;
+				dist_b = distances[child_b_index].distance;
+			}
+		}
+
+		// DO NOT REMOVE
+		if(dist_a < dist_curr){ // better_a
+			if(dist_b < dist_curr && !(dist_a < dist_b)){ // better_b && !a_better_than_b
+				// printf("better b (1)\n");
+				const struct distance_two_nodes swap = distances[current_index];
+				distances[current_index] = distances[child_b_index];
+				distances[child_b_index] = swap;
+				// siftdown_min_heap(heap, child_b_index);
+				current_index = child_b_index;
+			} else {
+				const struct distance_two_nodes swap = distances[current_index];
+				distances[current_index] = distances[child_a_index];
+				distances[child_a_index] = swap;
+				// siftdown_min_heap(heap, child_a_index);
+				current_index = child_a_index;
+			}
+		} else if(dist_b < dist_curr){ // better_b
+			// printf("better b (2)\n");
+			const struct distance_two_nodes swap = distances[current_index];
+			distances[current_index] = distances[child_b_index];
+			distances[child_b_index] = swap;
+			// siftdown_min_heap(heap, child_b_index);
+			current_index = child_b_index;
+		} else {
+			break; // no need to siftdown anymore
+		}
+		
+
+		/*
+		if(dist_a < dist_curr){
+			const struct distance_two_nodes swap = distances[current_index];
+			distances[current_index] = distances[child_a_index];
+			distances[child_a_index] = swap;
+			// siftdown_min_heap(heap, child_a_index);
+			current_index = child_a_index;	
+		} else {
+			break; // no need to siftdown anymore
+		}
+		*/
+	}
+}
+
+void siftdown_min_heap_v3(struct graph_distance_heap* const restrict heap, uint64_t current_index){
+#ifndef NDEBUG
+	uint64_t child_a_index;
+	uint64_t child_b_index;
+	if((UINT64_MAX - 2) / 2 >= current_index){
+		child_a_index = (current_index * 2 + 1);
+		child_b_index = child_a_index + 1;
+	} else {
+		perror("UINT64 overflow\n");
+		exit(1);
+	}
+#else
+	uint64_t child_a_index = current_index * 2 + 1;
+	uint64_t child_b_index = child_a_index + 1;
+#endif
+
+	struct distance_two_nodes * const restrict distances = heap->distances;
+	const struct graph * const restrict nodes_graph = heap->g;
+
+	/*
+	if(current_index >= heap->num_distances){ // to handle case when doing popping when sifting?
+		return;
+	}
+	*/
+
+	/* // COMMENTING OUT FOR TESTING
+	// if(distances[current_index].a->already_considered && distances[current_index].b->already_considered){
+	if(graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){ // ok but stack overflow?
+	// if(current_index < 100000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
+	// if(current_index < 1000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
+		pop_graph_distance_min_heap_v2(heap, current_index); // pop_graph_distance_min_heap_v2 will call back siftdown_heap_v2 for current_index, so we can just return
+		return;
+	}
+	*/
+
+	const float dist_curr = distances[current_index].distance;
+
+	uint64_t reachable_a = 1;
+	uint64_t reachable_b = 1;
+
+	uint64_t considered_count_curr;
+	/*
+	do{
+		// considered_count_curr = graph_node_at(nodes_graph, distances[current_index].a)->already_considered + graph_node_at(nodes_graph, distances[current_index].b)->already_considered;
+		considered_count_curr = (graph_node_at(nodes_graph, distances[current_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[current_index].b)->already_considered >= 1);
+		// REMOVING THIS FIXED AN ISSUE
+		if(considered_count_curr == 2){
+			printf("popping %lu %lu\n", current_index, heap->num_distances);
+			pop_graph_distance_min_heap_v3(heap, current_index);
+			if(current_index >= heap->num_distances){return;}
+		} else {
+			break;
+		}
+		
+		//break;
+	} while(1);
+	*/
+	considered_count_curr = (graph_node_at(nodes_graph, distances[current_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[current_index].b)->already_considered >= 1);
+	// REMOVING THIS FIXED AN ISSUE
+	/*
+		if(considered_count_curr == 2){
+			printf("popping %lu %lu\n", current_index, heap->num_distances);
+			pop_graph_distance_min_heap_v3(heap, current_index);
+			considered_count_curr = (graph_node_at(nodes_graph, distances[current_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[current_index].b)->already_considered >= 1);
+			if(current_index >= heap->num_distances){return;}
+		}
+	*/
+	uint64_t considered_count_a;
+	uint64_t considered_count_b;
+
+	// if(considered_count_curr == 2){pop_graph_distance_min_heap_v3(heap, current_index);}
+	// uint64_t curr_lt_a = (considered_count_curr == 1 && dist_curr <= dist_a) || (considered_count
+	// uint64_t b_lt_a = (considered_count_b == 1 && (considered_count
+	// uint64_t a_lt_curr = (considered_count_a == 0 && (considered_count_curr == 2 || dist_a < dist_curr)) || (considered_count_a == 1 && (considered_count_curr != 1 || dist_a < dist_curr))
+	uint64_t a_lt_curr;
+	uint64_t b_lt_curr;
+	uint64_t b_lt_a;
+
+	while(reachable_a || reachable_b){
+		child_a_index = current_index * 2 + 1;
+		child_b_index = child_a_index + 1;
+
+		reachable_a = child_a_index < heap->num_distances;
+		reachable_b = child_b_index < heap->num_distances;
+
+		considered_count_a = 2;
+		considered_count_b = 2;
+
+		float dist_a = 1.0e100;
+		float dist_b = 1.0e100;
+		if(reachable_a){
+			dist_a = distances[child_a_index].distance;
+			// considered_count_a = graph_node_at(nodes_graph, distances[child_a_index].a)->already_considered + graph_node_at(nodes_graph, distances[child_a_index].b)->already_considered;
+			considered_count_a = (graph_node_at(nodes_graph, distances[child_a_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_a_index].b)->already_considered >= 1);
+			if(reachable_b){
+				dist_b = distances[child_b_index].distance;
+				considered_count_b = (graph_node_at(nodes_graph, distances[child_b_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_b_index].b)->already_considered >= 1);
+			}
+		}
+
+		if(considered_count_a != considered_count_curr){a_lt_curr = considered_count_a == 1 || (considered_count_a == 0 && considered_count_curr == 2);} else {a_lt_curr = dist_a < dist_curr;}
+		if(considered_count_b != considered_count_curr){b_lt_curr = considered_count_b == 1 || (considered_count_b == 0 && considered_count_curr == 2);} else {b_lt_curr = dist_b < dist_curr;}
+		if(considered_count_b != considered_count_a){b_lt_a = considered_count_b == 1 || (considered_count_b == 0 && considered_count_a == 2);} else {b_lt_a = dist_b < dist_a;}
+
+		/*
+		if(reachable_a && reachable_b){
+			// if(dist_b < dist_a){ // modification to potentially improve the speed of pop_graph by always having the lowest of the two childrens on the left
+			while(dist_b < dist_a){ // modification to potentially improve the speed of pop_graph by always having the lowest of the two childrens on the left
+				const struct distance_two_nodes swap = distances[child_a_index];
+				distances[child_a_index] = distances[child_b_index];
+				distances[child_b_index] = swap;
+				
+				siftdown_min_heap_v2(heap, child_a_index); // not necessary?
+				siftdown_min_heap_v2(heap, child_b_index);
+
+				dist_a = distances[child_a_index].distance;
+				dist_b = distances[child_b_index].distance;
+			}
+		}
+		*/
+
+		// DO NOT REMOVE
+		uint64_t swap_index;
+		// uint64_t considered_count_swap;
+		if(a_lt_curr){ // better_a
+			if(b_lt_curr && b_lt_a){ // better_b && b_better_than_a
+				swap_index = child_b_index;
+				// considered_count_swap = considered_count_b;
+			} else {
+				swap_index = child_a_index;
+				// considered_count_swap = considered_count_a;
+			}
+		} else if(b_lt_curr){ // better_b
+			swap_index = child_b_index;
+			// considered_count_swap = considered_count_b;
+		} else {
+			break; // no need to siftdown anymore
+		}
+		// printf("%lu / %f %lu / %f %lu / %f %lu / %f %lu\n", current_index, distances[current_index].distance, considered_count_curr, distances[child_a_index].distance, considered_count_a, distances[child_b_index].distance, considered_count_b, distances[swap_index].distance, considered_count_swap);
+
+		const struct distance_two_nodes swap = distances[current_index];
+		distances[current_index] = distances[swap_index];
+		distances[swap_index] = swap;
+		current_index = swap_index;
+		
+
+		/*
+		if(dist_a < dist_curr){
+			const struct distance_two_nodes swap = distances[current_index];
+			distances[current_index] = distances[child_a_index];
+			distances[child_a_index] = swap;
+			// siftdown_min_heap(heap, child_a_index);
+			current_index = child_a_index;	
+		} else {
+			break; // no need to siftdown anymore
+		}
+		*/
+	}
+
+}
+
+int32_t siftdown(struct graph_distance_heap* const restrict heap, const int32_t direction, const int64_t current_index){
+	if(direction == MIN_HEAP){
+		#if MST_IMPLEMENTATION_VERSION == 1
+		siftdown_min_heap(heap, current_index);
+		#elif MST_IMPLEMENTATION_VERSION == 2
+		siftdown_min_heap_v2(heap, current_index);
+		#elif MST_IMPLEMENTATION_VERSION == 3
+		siftdown_min_heap_v3(heap, current_index);
+		#else
+		#error "Unknown MST_IMPLEMENTATION_VERSION"
+		#endif
+	} else if(direction == MAX_HEAP){
+		/* ... */
+	} else {
+		return 1;
+	}
+
+	return 0;
+}
+
+// void heapify_min_heap(struct graph_distance_heap* restrict heap, const uint64_t current_index){
+void heapify_min_heap(struct graph_distance_heap* const restrict heap){
+	/* // DO NOT REMOVE
+#ifndef NDEBUG
+	uint64_t child_a_index;
+	uint64_t child_b_index;
+	if((UINT64_MAX - 2) / 2 >= current_index){
+		child_a_index = (current_index * 2 + 1);
+		child_b_index = child_a_index + 1;
+	} else {
+		perror("UINT64 overflow\n");
+		exit(1);
+	}
+#else
+	const uint64_t child_a_index = current_index * 2 + 1;
+	const uint64_t child_b_index = child_a_index + 1;
+#endif
+
+	if(child_a_index < heap->num_distances){heapify_min_heap(heap, child_a_index);}
+	if(child_b_index < heap->num_distances){heapify_min_heap(heap, child_b_index);}
+
+	siftdown_min_heap(heap, current_index);
+	*/
+
+	// heap->num_distances = heap->num_distances_memory;
+
+	#if MST_IMPLEMENTATION_VERSION == 3
+	while(heap->num_distances > 0){
+		uint64_t n = heap->num_distances - 1;
+		uint64_t considered_count = (graph_node_at(heap->g, heap->distances[n].a)->already_considered >= 1) + (graph_node_at(heap->g, heap->distances[n].b)->already_considered >= 1);
+		if(considered_count == 2){
+			heap->num_distances--;
+			// printf("reduced to %lu distances\n", heap->num_distances);
+		} else {
+			break;
+		}
+	}
+	#endif
+
+	// uint64_t i = (uint64_t) pow(2.0, floor(log2((double) heap->num_distances))); // COMMENTING OUT FOR TESTING ALTHOUGH SHOULD BE OK
+	uint64_t i = heap->num_distances;
+	do {
+		i--;
+		// printf("siftdown for %lu\n", i);
+#if MST_IMPLEMENTATION_VERSION == 1
+		siftdown_min_heap(heap, i);
+#elif MST_IMPLEMENTATION_VERSION == 2
+		siftdown_min_heap_v2(heap, i);
+#elif MST_IMPLEMENTATION_VERSION == 3
+		uint64_t considered_count = (graph_node_at(heap->g, heap->distances[i].a)->already_considered >= 1) + (graph_node_at(heap->g, heap->distances[i].b)->already_considered >= 1);
+		if(considered_count == 2){
+			if(i == heap->num_distances - 1){
+				heap->num_distances--;
+			} else {
+				const struct distance_two_nodes swap = heap->distances[i];
+				heap->distances[i] = heap->distances[heap->num_distances - 1];
+				heap->distances[heap->num_distances - 1] = swap;
+				heap->num_distances--;
+			}
+			/*
+			uint64_t n = heap->num_distances - 1;
+			uint64_t considered_count_n = (graph_node_at(heap->g, heap->distances[n].a)->already_considered >= 1) + (graph_node_at(heap->g, heap->distances[n].b)->already_considered >= 1);
+			if(considered_count_n == 2){
+				heap->num_distances--;
+				// printf("reduced to %lu distances\n", heap->num_distances);
+			} else {
+				break;
+			}
+			*/
+		}
+		siftdown_min_heap_v3(heap, i);
+#else
+#error "Unknown MST_IMPLEMENTATION_VERSION"
+#endif
+	} while (i > 0);
+}
+
+int32_t heapify(struct graph_distance_heap* restrict heap, const int32_t direction){
+/*
+#ifndef NDEBUG
+	uint64_t child_a_index;
+	uint64_t child_b_index;
+	if((UINT64_MAX - 2) / 2 >= current_index){
+		child_a_index = (current_index * 2 + 1);
+		child_b_index = child_a_index + 1;
+	} else {
+		perror("UINT64 overflow\n");
+		return 1;
+	}
+#else
+	const uint64_t child_a_index = current_index * 2 + 1;
+	const uint64_t child_b_index = child_a_index + 1;
+#endif
+*/
+
+	if(direction == MIN_HEAP){
+		// heapify_min_heap(heap, current_index);
+		heapify_min_heap(heap);
+	} else if(direction == MAX_HEAP){
+		/* ... */	
+	} else {
+		return 1;
+	}
+	return 0;
+
+}
+
+int32_t create_graph_distance_heap(struct graph_distance_heap* restrict heap, struct graph* restrict g, const struct matrix* const m_){
+	if(m_ == NULL){
+		perror("for efficiency reasons, pass an actual matrix to create_graph_distance_heap instead of NULL\n");
+	}
+
+	(*heap).g = g;
+
+	/*
+	int64_t num_distances = 0;
+	for(uint64_t i = (*g).num_nodes - 1 ; i >= 1 ; i--){
+		num_distances += (int64_t) i;
+	}
+	*/
+	const int64_t num_distances = (g->num_nodes * (g->num_nodes - 1)) / 2;
+
+	size_t malloc_size;
+	void* alloc_pointer;
+	malloc_size = num_distances * sizeof(struct distance_two_nodes);
+	// alloc_pointer = malloc(malloc_size);
+	alloc_pointer = realloc(heap->distances, malloc_size);
+	if(alloc_pointer == NULL){goto malloc_fail;}
+	memset(alloc_pointer, 0, malloc_size);
+	heap->distances = (struct distance_two_nodes*) alloc_pointer;
+	heap->num_distances = num_distances;
+	heap->num_distances_memory = heap->num_distances;
+
+	uint64_t distance_index = 0;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
+			/*
+			if(m_ == NULL){
+				create_distance_two_nodes(&(heap->distances[distance_index]), graph_node_at(g, i), graph_node_at(g, j), fp_mode, NULL);
+			} else {
+				create_distance_two_nodes(&(heap->distances[distance_index]), graph_node_at(g, i), graph_node_at(g, j), fp_mode, &(m_->bfr.fp32[i * m_->b + j]));	
+			}
+			*/
+			create_distance_two_nodes(heap->distances + distance_index, i, j, m_->bfr.fp32[i * m_->b + j]);
+#ifndef NDEBUG
+			if(distance_index == UINT64_MAX){
+				perror("UINT64 overflow\n");
+				goto return_failure;
+			}
+#endif
+			distance_index++;
+		}
+	}
+	if(distance_index != (*heap).num_distances){
+		perror("distance_index != (*heap).num_distances\n");
+		return 1;
+	}
+
+	heapify(heap, MIN_HEAP);
+
+	/*
+	if(heap_is_min_heapified(heap) != 1){
+		perror("heap is not min-heapified\n");
+		return 1;
+	}
+	*/
+
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	goto return_failure;
+
+	return_failure:
+	return 1;
+}
+
+// heap of the edges that can be in the minimum spanning tree of g once nodes were appended from first_new_node on:
+// by the cycle property, the tree of the previous nodes (num_tree_distances edges) and the distances of the new nodes
+int32_t create_graph_distance_heap_from_tree(struct graph_distance_heap* restrict heap, struct graph* restrict g, const struct matrix* const m, const struct distance_two_nodes* const tree, const uint64_t num_tree_distances, const uint64_t first_new_node){
+	const uint64_t n = g->num_nodes;
+	const uint64_t num_distances = num_tree_distances + (n > 0 ? (n * (n - 1)) / 2 : 0) - (first_new_node > 0 ? (first_new_node * (first_new_node - 1)) / 2 : 0);
+
+	void* const alloc_pointer = realloc(heap->distances, (num_distances + 1) * sizeof(struct distance_two_nodes));
+	if(alloc_pointer == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	heap->g = g;
+	heap->distances = (struct distance_two_nodes*) alloc_pointer;
+
+	memcpy(heap->distances, tree, num_tree_distances * sizeof(struct distance_two_nodes));
+	uint64_t distance_index = num_tree_distances;
+	for(uint64_t j = first_new_node ; j < n ; j++){
+		for(uint64_t i = 0 ; i < j ; i++){
+			const float distance = m->fp_mode == FP64 ? (float) m->bfr.fp64[i * m->b + j] : m->bfr.fp32[i * m->b + j];
+			create_distance_two_nodes(heap->distances + distance_index, i, j, distance);
+			distance_index++;
+		}
+	}
+	if(distance_index != num_distances){
+		perror("distance_index != num_distances\n");
+		return 1;
+	}
+	heap->num_distances = num_distances;
+	heap->num_distances_memory = num_distances;
+
+	heapify(heap, MIN_HEAP);
+
+	return 0;
+}
+
+void pop_graph_distance_min_heap(struct graph_distance_heap* restrict heap, const uint64_t current_index){
+	uint64_t child_a_index;
+	uint64_t child_b_index;
+	if((UINT64_MAX - 2) / 2 >= current_index){
+		child_a_index = (current_index * 2 + 1);
+		child_b_index = child_a_index + 1;
+	} else {
+		perror("UINT64 overflow\n");
+		exit(1);
+	}
+	int32_t reachable_a = child_a_index < heap->num_distances;
+	int32_t reachable_b = child_b_index < heap->num_distances;
+	struct distance_two_nodes swap;
+
+	/* // DO NOT REMOVE, NECESSARY FOR THIS FUNCTION
+	heap->distances[current_index].usable = 0;
+
+	if(reachable_a){reachable_a &= heap->distances[child_a_index].usable;}
+	if(reachable_b){reachable_b &= heap->distances[child_b_index].usable;}
+	*/
+
+	if(reachable_a){
+		if(reachable_b){
+			if(heap->distances[child_a_index].distance <= heap->distances[child_b_index].distance){ // a_better_than_b
+				swap = heap->distances[current_index];
+				heap->distances[current_index] = heap->distances[child_a_index];
+				heap->distances[child_a_index] = swap;
+		
+				pop_graph_distance_min_heap(heap, child_a_index);
+
+			} else {
+				swap = heap->distances[current_index];
+				heap->distances[current_index] = heap->distances[child_b_index];
+				heap->distances[child_b_index] = swap;
+		
+				pop_graph_distance_min_heap(heap, child_b_index);
+			
+			}
+		} else {
+				swap = heap->distances[current_index];
+				heap->distances[current_index] = heap->distances[child_a_index];
+				heap->distances[child_a_index] = swap;
+		
+				pop_graph_distance_min_heap(heap, child_a_index);
+		}
+	}
+}
+
+void pop_graph_distance_min_heap_v2(struct graph_distance_heap* restrict heap, const uint64_t current_index){
+	// struct distance_two_nodes swap; // actually, not swapping, we can just hard erase
+	struct distance_two_nodes swap;
+	if(current_index < heap->num_distances - 1){
+		// heap->distances[current_index] = heap->distances[heap->num_distances - 1];
+		swap = heap->distances[current_index];
+		heap->distances[current_index] = heap->distances[heap->num_distances - 1];
+		heap->distances[heap->num_distances - 1] = swap;
+		heap->num_distances--;
+		siftdown_min_heap_v2(heap, current_index);
+	} else {
+		heap->num_distances--;
+	}
+}
+
+void pop_graph_distance_min_heap_v3(struct graph_distance_heap* restrict heap, const uint64_t current_index){
+	// struct distance_two_nodes swap; // actually, not swapping, we can just hard erase
+	struct distance_two_nodes swap;
+	if(current_index < heap->num_distances - 1){
+		// heap->distances[current_index] = heap->distances[heap->num_distances - 1];
+		swap = heap->distances[current_index];
+		heap->distances[current_index] = heap->distances[heap->num_distances - 1];
+		heap->distances[heap->num_distances - 1] = swap;
+		heap->num_distances--;
+		siftdown_min_heap_v3(heap, current_index);
+	} else {
+		heap->num_distances--;
+	}
+}
+
+int32_t pop_graph_distance_heap(struct graph_distance_heap* heap, const int32_t direction, const int32_t current_index){
+	if(direction == MIN_HEAP){
+		#if MST_IMPLEMENTATION_VERSION == 1
+		pop_graph_distance_min_heap(heap, current_index);
+		#elif MST_IMPLEMENTATION_VERSION == 2
+		pop_graph_distance_min_heap_v2(heap, current_index);
+		#elif MST_IMPLEMENTATION_VERSION == 3
+		pop_graph_distance_min_heap_v3(heap, current_index);
+		#else
+		#error "Unknown MST_IMPLEMENTATION_VERSION"
+		#endif
+	} else if(direction == MAX_HEAP){
+		/* ... */
+	} else {
+		return 1;
+	}
+
+	return 0;
+}
+
+void free_graph_distance_heap(struct graph_distance_heap* heap){
+	free(heap->distances);
+	*heap = (struct graph_distance_heap) {0};
+}
+
+int32_t create_minimum_spanning_tree(struct minimum_spanning_tree* mst, struct graph_distance_heap* heap){
+	size_t malloc_size;
+	void* malloc_pointer;
+
+	int32_t num_nodes;
+	int32_t num_distances;
+
+	mst->heap = heap;
+
+	num_nodes = heap->g->num_nodes;
+	num_distances = num_nodes - 1;
+
+	malloc_size = num_distances * sizeof(struct distance_two_nodes);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){goto malloc_fail;}
+	memset(malloc_pointer, 0, malloc_size);
+	mst->distances = (struct distance_two_nodes*) malloc_pointer;
+	mst->num_distances = num_distances;
+	mst->num_active_distances = 0;
+
+	malloc_size = num_nodes * sizeof(struct graph_node*);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){goto malloc_fail;}
+	memset(malloc_pointer, 0, malloc_size);
+	mst->nodes = (struct graph_node**) malloc_pointer;
+	mst->num_nodes = num_nodes;
+	mst->num_active_nodes = 0;
+
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	return 1;
+}
+
+void free_minimum_spanning_tree(struct minimum_spanning_tree* mst){
+	free(mst->distances);
+	free(mst->nodes);
+	*mst = (struct minimum_spanning_tree) {0};
+}
+
+int32_t find_minimum_acceptable_arc(struct minimum_spanning_tree* mst, uint64_t current_index, double distance_to_beat, int32_t consider_distance_to_beat){
+	if(consider_distance_to_beat && mst->heap->distances[current_index].distance > distance_to_beat){
+		return -1;
+	}
+
+	int32_t current_node_usable = 1;
+
+	// int32_t a_already_present = mst->heap->distances[current_index].a->already_considered;
+	// int32_t b_already_present = mst->heap->distances[current_index].b->already_considered;
+	const int32_t a_already_present = graph_node_at(mst->heap->g, mst->heap->distances[current_index].a)->already_considered;
+	const int32_t b_already_present = graph_node_at(mst->heap->g, mst->heap->distances[current_index].b)->already_considered;
+
+	// trying to add a pop (new here)
+	if(a_already_present && b_already_present){
+		// pop_graph_distance_min_heap(mst->heap, current_index);
+		pop_graph_distance_min_heap_v2(mst->heap, current_index);
+		return find_minimum_acceptable_arc(mst, current_index, distance_to_beat, consider_distance_to_beat);
+	}
+
+	current_node_usable = a_already_present ^ b_already_present;
+	if(current_node_usable){
+		return current_index;
+	}
+
+	uint64_t child_a_index;
+	uint64_t child_b_index;
+	if((UINT64_MAX - 2) / 2 >= current_index){
+		child_a_index = (current_index * 2 + 1);
+		child_b_index = child_a_index + 1;
+	} else {
+		perror("UINT64 overflow\n");
+		exit(1);
+	}
+	int32_t reachable_a = child_a_index < mst->heap->num_distances;
+	int32_t reachable_b = child_b_index < mst->heap->num_distances;
+
+	/* // DO NOT REMOVE
+	if(reachable_a){reachable_a &= mst->heap->distances[child_a_index].usable;}
+	if(reachable_b){reachable_b &= mst->heap->distances[child_b_index].usable;}
+	*/
+
+	int32_t result_a = -1;
+	int32_t result_b = -1;
+	if(reachable_a){
+		result_a = find_minimum_acceptable_arc(mst, child_a_index, distance_to_beat, consider_distance_to_beat);
+		if(result_a != -1){
+			double new_distance = mst->heap->distances[result_a].distance;
+			if(!consider_distance_to_beat || new_distance < distance_to_beat){
+				distance_to_beat = new_distance;
+				consider_distance_to_beat = 1;
+			}
+		}
+	}
+	if(reachable_b){
+		result_b = find_minimum_acceptable_arc(mst, child_b_index, distance_to_beat, consider_distance_to_beat);
+	}
+
+	if(result_a == -1){
+		return result_b;
+	} else {
+		if(result_b == -1){
+			return result_a;
+		} else {
+			if(
+				mst->heap->distances[result_a].distance < mst->heap->distances[result_b].distance
+			){
+				return result_a;
+			} else {
+				return result_b;
+			}
+		}
+	}
+}
+
+int32_t calculate_minimum_spanning_tree(struct minimum_spanning_tree* mst, struct matrix* m_in, int32_t method){
+	const uint64_t n = mst->heap->g->num_nodes;
+	for(uint64_t i = 0 ; i < n ; i++){
+		graph_node_at(mst->heap->g, i)->already_considered = 0;
+	}
+	mst->heap->num_distances = mst->heap->num_distances_memory;
+	mst->num_active_nodes = 0;
+	mst->num_active_distances = 0;
+	heapify_min_heap(mst->heap);
+	#if MST_SANITY_TESTING == 1
+	if(heap_is_min_heapified(mst->heap) != 1){
+		perror("heap is not min-heapified\n");
+		return 1;
+	}
+	#endif
+
+	if(method == MST_PRIMS_ALGORITHM){
+		if(mst->num_active_nodes == 0){
+			mst->distances[mst->num_active_distances] = mst->heap->distances[0];
+			mst->num_active_distances++;
+			// mst->nodes[mst->num_active_nodes] = mst->heap->distances[0].a;
+			mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[0].a);
+			mst->num_active_nodes++;
+			// mst->nodes[mst->num_active_nodes] = mst->heap->distances[0].b;
+			mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[0].b);
+			mst->num_active_nodes++;
+
+			// mst->heap->distances[0].a->already_considered = 1;
+			// mst->heap->distances[0].b->already_considered = 1;
+			graph_node_at(mst->heap->g, mst->heap->distances[0].a)->already_considered = 1;
+			graph_node_at(mst->heap->g, mst->heap->distances[0].b)->already_considered = 1;
+
+			pop_graph_distance_heap(mst->heap, MIN_HEAP, 0);
+		}
+
+		while(mst->num_active_nodes < mst->num_nodes){
+			int32_t a_already_present = 0;
+			int32_t b_already_present = 0;
+
+			#if MST_IMPLEMENTATION_VERSION == 1 || MST_IMPLEMENTATION_VERSION == 2
+			int64_t index_of_arc_to_add = find_minimum_acceptable_arc(mst, 0, 0.0, 0);
+			#elif MST_IMPLEMENTATION_VERSION == 3
+			// printf("heapifying\n");
+			/**/
+			heapify_min_heap(mst->heap);
+			#if MST_SANITY_TESTING == 1
+			if(heap_is_min_heapified(mst->heap) != 1){
+				perror("heap is not min-heapified\n");
+				return 1;
+			}
+			#endif
+			// printf("heapified\n");
+			int64_t index_of_arc_to_add = 0;
+			/*
+			int64_t index_of_arc_to_add = -1;
+			for(int32_t k = 0 ; k < mst->heap->num_distances ; k++){
+				int64_t a_present = graph_node_at(mst->heap->g, mst->heap->distances[k].a)->already_considered;
+				int64_t b_present = graph_node_at(mst->heap->g, mst->heap->distances[k].b)->already_considered;
+				if(a_present ^ b_present && (index_of_arc_to_add == -1 || mst->heap->distances[k].distance < mst->heap->distances[index_of_arc_to_add].distance)){
+					index_of_arc_to_add = k;
+				}
+			}
+			if(index_of_arc_to_add != 0){
+				printf("index_of_arc_to_add: %li\n", index_of_arc_to_add);
+			}
+			*/
+			#else
+			#error "Unknown MST_IMPLEMENTATION_VERSION"
+			#endif
+			#ifndef NDEBUG
+			printf("%lu / %lu\n", mst->num_active_nodes, mst->num_nodes);
+			#endif
+			
+			if(index_of_arc_to_add < 0 || ((uint64_t) index_of_arc_to_add) >= mst->heap->num_distances){
+				break;
+			}
+
+			// a_already_present = mst->heap->distances[index_of_arc_to_add].a->already_considered;
+			// b_already_present = mst->heap->distances[index_of_arc_to_add].b->already_considered;
+			a_already_present = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].a)->already_considered;
+			b_already_present = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].b)->already_considered;
+
+			if(!(a_already_present ^ b_already_present)){
+				printf("a_already_present: %i, b_already_present: %i\n", a_already_present, b_already_present);
+			}
+			mst->distances[mst->num_active_distances] = mst->heap->distances[index_of_arc_to_add];
+			mst->num_active_distances++;
+			if(!a_already_present){
+				// mst->nodes[mst->num_active_nodes] = mst->heap->distances[index_of_arc_to_add].a;
+				mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].a);
+				mst->num_active_nodes++;
+
+				// mst->heap->distances[index_of_arc_to_add].a->already_considered = 1;
+				graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].a)->already_considered = 1;
+			}
+			if(!b_already_present){
+				// mst->nodes[mst->num_active_nodes] = mst->heap->distances[index_of_arc_to_add].b;
+				mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].b);
+				mst->num_active_nodes++;
+
+				// mst->heap->distances[index_of_arc_to_add].b->already_considered = 1;
+				graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].b)->already_considered = 1;
+			}
+			// #if MST_IMPLEMENTATION_VERSION == 1 || MST_IMPLEMENTATION_VERSION == 2
+			pop_graph_distance_heap(mst->heap, MIN_HEAP, index_of_arc_to_add);
+			// #endif
+		}
+	}
+	
+	for(uint64_t i = 0 ; i < mst->num_distances ; i++){
+		// int64_t index_a = (int64_t) (mst->distances[i].a - mst->heap->g->nodes);
+		// int64_t index_b = (int64_t) (mst->distances[i].b - mst->heap->g->nodes);
+		const int64_t index_a = (int64_t) mst->distances[i].a;
+		const int64_t index_b = (int64_t) mst->distances[i].b;
+
+		m_in->active[index_a * m_in->b + index_b] = 1;
+		m_in->active[index_b * m_in->b + index_a] = 1;
+		// assumes symmetry
+		switch(m_in->fp_mode){
+			case FP32:
+				m_in->bfr.fp32[index_a * m_in->b + index_b] = (float) mst->heap->distances[i].distance;
+				m_in->bfr.fp32[index_b * m_in->b + index_a] = (float) mst->heap->distances[i].distance;
+				break;
+			case FP64:
+				m_in->bfr.fp64[index_a * m_in->b + index_b] = mst->heap->distances[i].distance;
+				m_in->bfr.fp64[index_b * m_in->b + index_a] = mst->heap->distances[i].distance;
+				break;
+		}
+	}
+
+	if(mst->num_active_nodes != mst->num_nodes || mst->num_active_distances != mst->num_distances){
+		printf("num_active_nodes: %lu, num_nodes: %lu, num_active_distances: %lu, num_distances: %lu\n", mst->num_active_nodes, mst->num_nodes, mst->num_active_distances, mst->num_distances);
+
+		perror("improper number of nodes or distances when calculating minimum spanning tree\n");
+	}
+	return 0;
+}
+
+int32_t agg_mst_from_minimum_spanning_tree(struct minimum_spanning_tree* mst, double* result_buffer){
+	double sum = 0.0;
+	for(uint64_t i = 0 ; i < mst->num_active_distances ; i++){
+		sum += mst->distances[i].distance;
+	}
+	*result_buffer = sum;
+	return 0;
+}
+
+int32_t functional_evenness_from_minimum_spanning_tree(struct minimum_spanning_tree* mst, double* result_buffer){
+	// see Villéger et al. (2008)
+	
+	void* malloc_pointer;
+	size_t malloc_size;
+	double ew_sum;
+	double* all_ew;
+	double upper_sum;
+	double one_over_n_minus_one;
+	double result;
+
+	malloc_size = mst->num_active_distances * sizeof(double);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){goto malloc_fail;}
+	memset(malloc_pointer, 0, malloc_size);
+	all_ew = (double*) malloc_pointer;
+
+	ew_sum = 0.0;
+	one_over_n_minus_one = (1.0 / (mst->num_active_nodes - 1.0));
+
+	for(uint64_t i = 0 ; i < mst->num_active_distances ; i++){
+		// double weight_a = (*(mst->distances[i].a)).relative_proportion;
+		// double weight_b = (*(mst->distances[i].b)).relative_proportion;
+		const double weight_a = mst->heap->g->snapshot.relative_proportions[mst->distances[i].a];
+		const double weight_b = mst->heap->g->snapshot.relative_proportions[mst->distances[i].b];
+		all_ew[i] = mst->distances[i].distance / (weight_a + weight_b);
+		ew_sum += all_ew[i];
+	}
+
+	upper_sum = 0.0;
+
+	for(uint64_t i = 0 ; i < mst->num_active_distances ; i++){
+		double pew = all_ew[i] / ew_sum;
+		if(pew < one_over_n_minus_one){
+			upper_sum += pew;
+		} else {
+			upper_sum += one_over_n_minus_one;
+		}
+	}
+
+	result = (upper_sum - one_over_n_minus_one) / (1.0 - one_over_n_minus_one);
+	(*result_buffer) = result;
+
+	free(all_ew);
+
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	return 1;
+}
+
+
+int32_t functional_dispersion_from_graph(struct graph* const g, double* const result_buffer, const int8_t fp_mode){
+	// see Laliberté & Legendre (2010)
+	
+	struct graph_node centroid = {0};
+	int32_t res;
+	double result;
+	double sum_relative_proportion;
+
+	res = create_graph_node(&centroid, graph_node_at(g, 0)->num_dimensions, fp_mode);
+	if(res != 0){goto create_graph_node_failed;}
+
+	centroid.num_dimensions = graph_node_at(g, 0)->num_dimensions;
+	size_t malloc_size;
+	switch(fp_mode){
+		case FP32:
+			if(centroid.vector.fp32 == NULL){
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(float);
+				void * p = malloc(malloc_size);
+				if(p == NULL){
+					perror("malloc failed\n");
+					return 1;
+				}
+				centroid.vector.fp32 = p;
+				memset(centroid.vector.fp32, '\0', malloc_size);
+			}
+			break;
+		case FP64:
+			if(centroid.vector.fp64 == NULL){
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(double);
+				void * p = malloc(malloc_size);
+				if(p == NULL){
+					perror("malloc failed\n");
+					return 1;
+				}
+				centroid.vector.fp64 = p;
+				memset(centroid.vector.fp64, '\0', malloc_size);
+			}
+			break;
+	}
+
+	for(uint64_t i = 0 ; i < (*g).num_nodes ; i++){
+		for(uint64_t j = 0 ; j < g->snapshot.num_dimensions ; j++){
+			switch(fp_mode){
+				case GRAPH_NODE_FP32:
+					centroid.vector.fp32[j] += graph_snapshot_row(&(g->snapshot), i)[j] * g->snapshot.relative_proportions[i];
+					break;
+				case GRAPH_NODE_FP64:
+					centroid.vector.fp64[j] += graph_node_at(g, i)->vector.fp64[j] * g->snapshot.relative_proportions[i];
+					break;
+			}
+		}
+	}
+
+	result = 0.0;
+	sum_relative_proportion = 0.0;
+	for(uint64_t i = 0 ; i < (*g).num_nodes ; i++){
+		switch(fp_mode){
+			case GRAPH_NODE_FP32:
+				#if ENABLE_AVX512 == 1
+				result += cosine_distance_fp32_avx512(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
+				#elif ENABLE_AVX256 == 1
+				result += cosine_distance_fp32_avx256(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
+				#elif MST_SANITY_TESTING == 1
+				result += minkowski_distance_fp32((float*) graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions, 2.0f) * g->snapshot.relative_proportions[i];
+				#else
+				result += cosine_distance_fp32(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
+				#endif
+				break;
+			case GRAPH_NODE_FP64:
+				result += cosine_distance(graph_node_at(g, i)->vector.fp64, centroid.vector.fp64, graph_node_at(g, i)->num_dimensions) * g->snapshot.relative_proportions[i];
+				break;
+		}
+		sum_relative_proportion += g->snapshot.relative_proportions[i];
+	}
+	result /= sum_relative_proportion;
+	(*result_buffer) = result;
+
+	free(centroid.vector.fp32);
+
+	return 0;
+
+	create_graph_node_failed:
+	perror("created_graph_node_failed\n");
+	return 1;
+}
+
+int32_t functional_divergence_modified_from_graph(struct graph* const g, double* const result_buffer, const int8_t fp_mode){
+	// see Villéger et al. (2008)
+	// modifications: compute centroids based on all points instead of convex hull; cosine distance instead of euclidean
+	
+	struct graph_node centroid = {0};
+	int32_t res;
+
+	res = create_graph_node(&centroid, graph_node_at(g, 0)->num_dimensions, fp_mode);
+	if(res != 0){
+		perror("created_graph_node_failed\n");
+		return 1;
+	}
+
+	centroid.num_dimensions = graph_node_at(g, 0)->num_dimensions;
+	size_t malloc_size;
+	switch(fp_mode){
+		case FP32:
+			if(centroid.vector.fp32 == NULL){
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(float);
+				void * p = malloc(malloc_size);
+				if(p == NULL){
+					perror("malloc failed\n");
+					return 1;
+				}
+				centroid.vector.fp32 = p;
+				memset(centroid.vector.fp32, '\0', malloc_size);
+			}
+			break;
+		case FP64:
+			if(centroid.vector.fp64 == NULL){
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(double);
+				void * p = malloc(malloc_size);
+				if(p == NULL){
+					perror("malloc failed\n");
+					return 1;
+				}
+				centroid.vector.fp64 = p;
+				memset(centroid.vector.fp64, '\0', malloc_size);
+			}
+			break;
+	}
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = 0 ; j < g->snapshot.num_dimensions ; j++){
+			switch(fp_mode){
+				case GRAPH_NODE_FP32:
+					centroid.vector.fp32[j] += graph_snapshot_row(&(g->snapshot), i)[j] * g->snapshot.relative_proportions[i];
+					break;
+				case GRAPH_NODE_FP64:
+					centroid.vector.fp64[j] += graph_node_at(g, i)->vector.fp64[j] * g->snapshot.relative_proportions[i];
+					break;
+			}
+		}
+	}
+	double distances_to_centroid[g->num_nodes];
+	memset(distances_to_centroid, '\0', g->num_nodes * sizeof(double));
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		switch(fp_mode){
+			case GRAPH_NODE_FP32:
+				#if ENABLE_AVX512 == 1
+				distances_to_centroid[i] = (double) cosine_distance_fp32_avx512(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
+				#elif ENABLE_AVX256 == 1
+				distances_to_centroid[i] = (double) cosine_distance_fp32_avx256(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
+				#elif MST_SANITY_TESTING == 1
+				distances_to_centroid[i] = (double) minkowski_distance_fp32((float*) graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions, 2.0f) * g->snapshot.relative_proportions[i];
+				#else
+				distances_to_centroid[i] = (double) cosine_distance_fp32(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
+				#endif
+				break;
+			case GRAPH_NODE_FP64:
+				distances_to_centroid[i] = cosine_distance(graph_node_at(g, i)->vector.fp64, centroid.vector.fp64, graph_node_at(g, i)->num_dimensions) * g->snapshot.relative_proportions[i];
+				break;
+		}
+	}
+	double sum_distances_to_centroid = 0.0;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		sum_distances_to_centroid += distances_to_centroid[i];
+	}
+	double avg_distances_to_centroid = sum_distances_to_centroid / g->num_nodes;
+	double weighted_deviance = 0.0;
+	double weighted_deviance_abs = 0.0;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		double local_deviance = distances_to_centroid[i] - avg_distances_to_centroid;
+		double local_deviance_abs = local_deviance;
+		if(local_deviance_abs < 0.0){
+			local_deviance_abs *= -1.0;
+		}
+		weighted_deviance += g->snapshot.relative_proportions[i] * local_deviance;
+		weighted_deviance_abs += g->snapshot.relative_proportions[i] * local_deviance_abs;
+	}
+
+	double functional_divergence = (weighted_deviance + avg_distances_to_centroid) / (weighted_deviance_abs + avg_distances_to_centroid);
+	(*result_buffer) = functional_divergence;
+
+	free(centroid.vector.fp32);
+
+	return 0;
+}
+
+/* ==== ITERATIVE FUNCTIONS ==== */
+
+/* ---- PAIRWISE ---- */
+
+int32_t create_iterative_state_pairwise_from_graph(struct iterative_state_pairwise_from_graph* const restrict iter_state, struct graph* const g){
+	iter_state->i = 0; // single-threaded version uses this one, but multi-threaded version uses other i
+	iter_state->n = (g->num_nodes * (g->num_nodes - 1)) / 2;
+	iter_state->result = 0.0;
+	iter_state->g = g;
+	pthread_mutex_init(&(iter_state->mutex), NULL);
+	return 0;
+}
+
+void iterate_iterative_state_pairwise_from_graph(struct iterative_state_pairwise_from_graph* const restrict iter_state, const float* const vector){
+	for(uint64_t j = (uint64_t) (iter_state->i + 1) ; j < (uint64_t) iter_state->g->num_nodes ; j++){
+		iter_state->result += (double) vector[j];
+	}
+	iter_state->i++;
+}
+
+void* iterate_iterative_state_pairwise_from_graph_thread(void* args){
+	struct iterative_state_pairwise_from_graph* iter_state = ((struct thread_args_aggregator*) args)->iter_state.pairwise;
+	const float* const vector = ((struct thread_args_aggregator*) args)->vector;
+	uint64_t j = ((struct thread_args_aggregator*) args)->i + 1;
+
+	float sum = 0.0f;
+
+	const uint64_t n = (uint64_t) iter_state->g->num_nodes;
+	while(j < n){
+		sum += vector[j];
+		j++;
+	}
+
+	pthread_mutex_lock(&(iter_state->mutex));
+	iter_state->result += sum;
+	pthread_mutex_unlock(&(iter_state->mutex));
+
+	return NULL;
+}
+
+#if ENABLE_AVX256 == 1
+void* iterate_iterative_state_pairwise_from_graph_avx_thread(void* args){
+	struct iterative_state_pairwise_from_graph* iter_state = ((struct thread_args_aggregator*) args)->iter_state.pairwise;
+	const float* const vector = ((struct thread_args_aggregator*) args)->vector;
+	uint64_t j = ((struct thread_args_aggregator*) args)->i + 1;
+
+	__m256 avx_sum = _mm256_setzero_ps();
+
+	const uint64_t n = (uint64_t) iter_state->g->num_nodes;
+	while(j < n){
+		avx_sum = _mm256_add_ps(avx_sum, _mm256_loadu_ps(&(vector[j])));
+		j += 8;
+	}
+
+	float sum = 0.0;
+	float local_vec[8];
+	_mm256_storeu_ps(local_vec, avx_sum);
+	for(int32_t k = 0 ; k < 8 ; k++){
+		sum += local_vec[k];
+	}
+
+	while(j < n){
+		sum += vector[j];
+		j++;
+	}
+
+	pthread_mutex_lock(&(iter_state->mutex));
+	iter_state->result += sum;
+	pthread_mutex_unlock(&(iter_state->mutex));
+
+	return NULL;
+}
+#endif
+
+void finalise_iterative_state_pairwise_from_graph(struct iterative_state_pairwise_from_graph* const restrict iter_state){
+	iter_state->result /= (double) iter_state->n;
+	pthread_mutex_destroy(&(iter_state->mutex));
+}
+
+/* ---- STIRLING ---- */
+
+int32_t create_iterative_state_stirling_from_graph(struct iterative_state_stirling_from_graph* const restrict iter_state, struct graph* const g, double alpha, double beta){
+	iter_state->i = 0;
+	iter_state->n = (g->num_nodes * (g->num_nodes - 1)) / 2;
+	iter_state->alpha = alpha;
+	iter_state->beta = beta;
+	iter_state->result = 0.0;
+	iter_state->g = g;
+	pthread_mutex_init(&(iter_state->mutex), NULL);
+	return 0;
+}
+
+void iterate_iterative_state_stirling_from_graph(struct iterative_state_stirling_from_graph* const restrict iter_state, const float* const vector){
+	for(uint64_t j = 0 ; j < iter_state->g->num_nodes ; j++){
+		iter_state->result += pow((double) vector[j], iter_state->alpha) * pow(iter_state->g->snapshot.relative_proportions[iter_state->i] * iter_state->g->snapshot.relative_proportions[j], iter_state->beta);
+	}
+	iter_state->i++;
+}
+
+void* iterate_iterative_state_stirling_from_graph_thread(void* args){
+	struct iterative_state_stirling_from_graph* iter_state = ((struct thread_args_aggregator*) args)->iter_state.stirling;
+	const float* const vector = ((struct thread_args_aggregator*) args)->vector;
+	uint64_t j = ((struct thread_args_aggregator*) args)->i + 1;
+
+	double sum = 0.0;
+
+	const uint64_t n = (uint64_t) iter_state->g->num_nodes;
+	while(j < n){
+		sum += pow((double) vector[j], iter_state->alpha) * pow(iter_state->g->snapshot.relative_proportions[iter_state->i] * iter_state->g->snapshot.relative_proportions[j], iter_state->beta);
+		j++;
+	}
+
+	pthread_mutex_lock(&(iter_state->mutex));
+	iter_state->result += sum;
+	pthread_mutex_unlock(&(iter_state->mutex));
+
+	return NULL;
+}
+
+void finalise_iterative_state_stirling_from_graph(struct iterative_state_stirling_from_graph* const restrict iter_state){
+	pthread_mutex_destroy(&(iter_state->mutex));
+}
+
+/* ---- LEINSTER_COBBOLD ---- */
+
+int32_t create_iterative_state_leinster_cobbold_from_graph(struct iterative_state_leinster_cobbold_from_graph* const restrict iter_state, struct graph* const g, double alpha){
+	iter_state->i = 0;
+	iter_state->n = (g->num_nodes * (g->num_nodes - 1)) / 2;
+	iter_state->alpha = alpha;
+	if(alpha != 1.0){
+		iter_state->hill_number = 0.0;
+	} else {
+		iter_state->hill_number = 1.0;
+	}
+	iter_state->entropy = 0.0;
+	iter_state->g = g;
+	pthread_mutex_init(&(iter_state->mutex), NULL);
+	return 0;
+}
+
+void iterate_iterative_state_leinster_cobbold_from_graph(struct iterative_state_leinster_cobbold_from_graph* const restrict iter_state, const float* const vector){
+	const double u = 1.0;
+
+	double local_agg = 0.0;
+	for(uint64_t j = 0 ; j < iter_state->g->num_nodes ; j++){
+		double distance = (double) vector[j];
+		double similarity = 1.0 - distance;
+		local_agg += iter_state->g->snapshot.relative_proportions[j] * pow(E, -u * similarity);
+	}
+	if(iter_state->alpha != 1.0){
+		iter_state->hill_number += pow(local_agg, iter_state->alpha - 1.0);
+	} else {
+		iter_state->hill_number *= pow(local_agg, iter_state->g->snapshot.relative_proportions[iter_state->i]);
+	}
+	iter_state->i++;
+}
+
+void* iterate_iterative_state_leinster_cobbold_from_graph_thread(void* args){
+	struct iterative_state_leinster_cobbold_from_graph* iter_state = ((struct thread_args_aggregator*) args)->iter_state.leinster_cobbold;
+	const float* const vector = ((struct thread_args_aggregator*) args)->vector;
+	// uint64_t j = ((struct thread_args_aggregator*) args)->i + 1;
+	uint64_t j = 0;
+
+	const double u = 1.0;
+
+	double local_agg = 0.0;
+
+	const uint64_t n = (uint64_t) iter_state->g->num_nodes;
+	while(j < n){
+		double distance = (double) vector[j];
+		double similarity = 1.0 - distance;
+		local_agg += iter_state->g->snapshot.relative_proportions[j] * pow(E, -u * similarity);
+		j++;
+	}
+
+	pthread_mutex_lock(&(iter_state->mutex));
+	if(iter_state->alpha != 1.0){
+		iter_state->hill_number += pow(local_agg, iter_state->alpha - 1.0);
+	} else {
+		iter_state->hill_number *= pow(local_agg, iter_state->g->snapshot.relative_proportions[iter_state->i]);
+	}
+	pthread_mutex_unlock(&(iter_state->mutex));
+
+	return NULL;
+}
+
+void finalise_iterative_state_leinster_cobbold_from_graph(struct iterative_state_leinster_cobbold_from_graph* const restrict iter_state){
+	const double LOGARITHMIC_BASE = E;
+
+	if(iter_state->alpha != 1.0){
+		iter_state->hill_number = pow(iter_state->hill_number, 1.0 / (1.0 - iter_state->alpha));
+	} else {
+		iter_state->hill_number = pow(iter_state->hill_number, -1.0);
+	}
+
+	iter_state->entropy = log(iter_state->hill_number) / log(LOGARITHMIC_BASE);
+
+	pthread_mutex_destroy(&(iter_state->mutex));
+}
+
+// ================
+
+
+int32_t pairwise_from_graph(struct graph* const g, double* const result_buffer, const int8_t fp_mode, const struct matrix* const m_){
+	// see Mouchet et al. (2010) referencing Walker, Kinzig & Langridge (1999)
+	
+	double result;
+
+	result = 0.0;
+	int64_t n = (g->num_nodes * (g->num_nodes - 1)) / 2;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
+			if(m_ != NULL){
+				switch(m_->fp_mode){
+					case FP32:
+						result += m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						result += m_->bfr.fp64[i * m_->b + j];
+						break;
+				}
+				continue;
+			}
+			switch(fp_mode){
+				case GRAPH_NODE_FP32:
+					result += graph_snapshot_distance(&(g->snapshot), i, j);
+					break;
+				case GRAPH_NODE_FP64:
+					result += cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+					break;
+			}
+		}
+	}
+
+	result /= n;
+
+	(*result_buffer) = result;
+
+	return 0;
+}
+
+int32_t word2vec_to_graph_fp32(struct graph* g, struct word2vec* w2v, char** cupt_paths, char** cupt_paths_true_positives, int32_t num_cupt_paths, int32_t ud_column, const char * const ec_cfg){
+	for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
+		w2v->keys[i].num_occurrences = 0;
+	}
+	int32_t num_nodes = 0;
+	for(int32_t i = 0 ; i < num_cupt_paths ; i++){
+		if(cupt_paths_true_positives == NULL){
+			printf("processing %s\n", cupt_paths[i]);
+		} else {
+			printf("processing %s (true positives: %s)\n", cupt_paths[i], cupt_paths_true_positives[i]);
+		}
+		struct cupt_sentence_iterator csi;
+		struct cupt_sentence_iterator csi_tp;
+		int32_t err = create_cupt_sentence_iterator(&csi, cupt_paths[i], ec_cfg);
+		if(err != 0){
+			perror("failed to call create_cupt_sentence_iterator\n");
+			return 1;
+		}
+		if(cupt_paths_true_positives != NULL){
+			err = create_cupt_sentence_iterator(&csi_tp, cupt_paths_true_positives[i], ec_cfg);
+			if(err != 0){
+				perror("failed to call create_cupt_sentence_iterator\n");
+				free_cupt_sentence_iterator(&csi);
+				return 1;
+			}
+		}
+		err = iterate_cupt_sentence_iterator(&csi);
+		if(err != 0){
+			perror("failed to call iterate_cupt_sentence_iterator\n");
+			free_cupt_sentence_iterator(&csi);
+			if(cupt_paths_true_positives != NULL){
+				free_cupt_sentence_iterator(&csi_tp);
+			}
+			return 1;
+		}
+		if(cupt_paths_true_positives != NULL){
+			err = iterate_cupt_sentence_iterator(&csi_tp);
+			if(err != 0){
+				perror("failed to call iterate_cupt_sentence_iterator\n");
+				free_cupt_sentence_iterator(&csi);
+				free_cupt_sentence_iterator(&csi_tp);
+				return 1;
+			}
+		}
+		while(!csi.file_is_done){
+			const size_t max_mwe = 32;
+			const size_t max_tokens_per_mwe = 32;
+			const size_t size_token_mwe = 32;
+			size_t mwe_bfr_size = max_mwe * max_tokens_per_mwe * size_token_mwe;
+			char mwe[mwe_bfr_size];
+			memset(mwe, '\0', mwe_bfr_size);
+			char mwe_tp[mwe_bfr_size];
+			memset(mwe_tp, '\0', mwe_bfr_size);
+			int32_t mwe_lengths[max_mwe];
+			memset(mwe_lengths, '\0', max_mwe * sizeof(int32_t));
+			int32_t mwe_tp_lengths[max_mwe];
+			memset(mwe_tp_lengths, '\0', max_mwe * sizeof(int32_t));
+			int8_t mwe_correct_span[max_mwe];
+			memset(mwe_correct_span, 1, max_mwe * sizeof(int8_t));
+			for(int32_t j = 0 ; j < csi.current_sentence.num_tokens ; j++){
+				if(ud_column == UD_MWE){
+					if(strcmp(csi.current_sentence.tokens[j].mwe, "") == 0 || strcmp(csi.current_sentence.tokens[j].mwe, "_") == 0 || strcmp(csi.current_sentence.tokens[j].mwe, "-") == 0 || strcmp(csi.current_sentence.tokens[j].mwe, "*") == 0){
+						continue;
+					}
+
+					char* strtok_placeholder = NULL;
+					strtok_placeholder = strtok(csi.current_sentence.tokens[j].mwe, ";");
+					while(strtok_placeholder != NULL){
+						size_t mwe_num = strtol(strtok_placeholder, NULL, 10);
+						if(mwe_num < max_mwe){
+							size_t bytes_to_cpy = strlen(csi.current_sentence.tokens[j].lemma);
+							if(bytes_to_cpy > size_token_mwe - 1){
+								bytes_to_cpy = size_token_mwe - 1;
+							}
+							memcpy(&(mwe[mwe_num * max_tokens_per_mwe * size_token_mwe + mwe_lengths[mwe_num] * size_token_mwe]), csi.current_sentence.tokens[j].lemma, bytes_to_cpy);
+							mwe_lengths[mwe_num]++;
+						}
+
+						if(cupt_paths_true_positives != NULL && (strcmp(csi_tp.current_sentence.tokens[j].mwe, "") == 0 || strcmp(csi_tp.current_sentence.tokens[j].mwe, "_") == 0 || strcmp(csi_tp.current_sentence.tokens[j].mwe, "-") == 0 || strcmp(csi_tp.current_sentence.tokens[j].mwe, "*") == 0)){
+							mwe_correct_span[mwe_num] = 0;
+						}
+
+						strtok_placeholder = strtok(NULL, ";");
+					}
+
+					continue;
+				}
+				int32_t index;
+				switch(ud_column){
+					case UD_FORM:
+						index = word2vec_key_to_index(w2v, csi.current_sentence.tokens[j].form);
+						break;
+					case UD_LEMMA:
+						index = word2vec_key_to_index(w2v, csi.current_sentence.tokens[j].lemma);
+						break;
+					default:
+						perror("unknown UD column\n");
+						return 1;
+				}
+				if(index != -1){
+					if(w2v->keys[index].num_occurrences == 0){
+						num_nodes++;
+					}
+					w2v->keys[index].num_occurrences++;
+				}
+			}
+
+			for(size_t k = 0  ; k < max_mwe ; k++){
+				if(mwe_lengths[k] == 0){
+					continue;
+				}
+
+				if(cupt_paths_true_positives != NULL && !(mwe_correct_span[k])){
+					continue;
+				}
+
+				qsort(&(mwe[k * max_tokens_per_mwe * size_token_mwe]), mwe_lengths[k], size_token_mwe, void_strcmp);
+
+				const int32_t bfr_size = 512;
+				int32_t index_bfr = 0;
+				char bfr[bfr_size];
+				memset(bfr, '\0', bfr_size);
+				memcpy(bfr + index_bfr, "_MWE_", 5);
+				index_bfr += 5;
+				size_t bytes_to_cpy = 0;
+				for(int32_t m = 0 ; m < mwe_lengths[k] ; m++){
+					bytes_to_cpy = strlen(&(mwe[k * max_tokens_per_mwe * size_token_mwe + m * size_token_mwe]));
+					if(m < mwe_lengths[k] - 1){
+						bytes_to_cpy++;
+					}
+					if(bytes_to_cpy > ((size_t) bfr_size - 1 - index_bfr)){
+						bytes_to_cpy = bfr_size - 1 - index_bfr;
+					}
+					if(m < mwe_lengths[k] - 1){
+						memcpy(bfr + index_bfr, &(mwe[k * max_tokens_per_mwe * size_token_mwe + m * size_token_mwe]), bytes_to_cpy - 1);
+						index_bfr += bytes_to_cpy - 1;
+						bfr[index_bfr] = '_';
+						index_bfr++;
+					} else {
+						memcpy(bfr + index_bfr, &(mwe[k * max_tokens_per_mwe * size_token_mwe + m * size_token_mwe]), bytes_to_cpy);
+						index_bfr += bytes_to_cpy;
+					}
+				}
+
+				int32_t index = word2vec_key_to_index(w2v, bfr);
+				if(index != -1){
+					if(w2v->keys[index].num_occurrences == 0){
+						num_nodes++;
+					}
+					w2v->keys[index].num_occurrences++;
+				}
+			}
+
+			err = iterate_cupt_sentence_iterator(&csi);
+			if(err != 0){
+				perror("failed to call iterate_cupt_sentence_iterator\n");
+				free_cupt_sentence_iterator(&csi);
+				if(cupt_paths_true_positives != NULL){
+					free_cupt_sentence_iterator(&csi_tp);
+				}
+				return 1;
+			}
+			if(cupt_paths_true_positives != NULL){
+				err = iterate_cupt_sentence_iterator(&csi_tp);
+				if(err != 0){
+					perror("failed to call iterate_cupt_sentence_iterator\n");
+					free_cupt_sentence_iterator(&csi);
+					free_cupt_sentence_iterator(&csi_tp);
+					return 1;
+				}
+			}
+		}
+		free_cupt_sentence_iterator(&csi);
+		if(cupt_paths_true_positives != NULL){
+			free_cupt_sentence_iterator(&csi_tp);
+		}
+	}
+
+	if(create_graph_empty(g) != 0){goto malloc_fail;}
+	while(g->capacity < (uint64_t) num_nodes){
+		if(request_more_capacity_graph(g) != 0){goto malloc_fail;}
+	}
+	g->num_nodes = num_nodes;
+
+	uint64_t i = 0; // changes for iterative update -> disabled
+	uint64_t j = 0;
+	while(i < g->num_nodes && j < w2v->num_vectors){
+		if(w2v->keys[j].num_occurrences > 0){
+			graph_node_at(g, i)->num_dimensions = w2v->num_dimensions;
+			graph_node_at(g, i)->vector.fp32 = w2v->keys[j].vector;
+			graph_node_at(g, i)->absolute_proportion = w2v->keys[j].num_occurrences;
+			i++;
+		}
+		j++;
+	}
+
+	if(compute_graph_relative_proportions(g) != 0){goto malloc_fail;}
+
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	printf("errno: %i\n", errno);
+	goto return_failure;
+
+	return_failure:
+	return 1;
+}
+
+
+int32_t _weitzman(struct matrix* m, double* res){
+	int32_t argmin_dim1_index = 0;
+	int32_t argmin_dim2_index = 1;
+	int32_t found_a_value = 0;
+	
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		for(uint64_t j = i + 1 ; j < m->b ; j++){
+			int32_t index_in_buffer = (i * m->b) + j;
+			if(m->active[index_in_buffer] == 0){
+				continue;
+			}
+			switch(m->fp_mode){
+				case FP32:
+					if(found_a_value == 0 || m->bfr.fp32[index_in_buffer] < m->bfr.fp32[(argmin_dim1_index * m->b) + argmin_dim2_index]){
+						argmin_dim1_index = i;
+						argmin_dim2_index = j;
+					}
+					break;
+				case FP64:
+					if(found_a_value == 0 || m->bfr.fp64[index_in_buffer] < m->bfr.fp64[(argmin_dim1_index * m->b) + argmin_dim2_index]){
+						argmin_dim1_index = i;
+						argmin_dim2_index = j;
+					}
+					break;
+			}
+			found_a_value = 1;
+		}
+	}
+	if(!found_a_value){
+		return 0;
+	}
+
+	double local_res_a = -1.0;
+	double local_res_b = -1.0;
+
+	size_t malloc_size_a = m->a;
+	size_t malloc_size_b = m->b;
+	void* malloc_pointer;
+	malloc_pointer = malloc(malloc_size_a);
+	if(malloc_pointer == NULL){goto malloc_failure;}
+	int8_t* a_mem = (int8_t*) malloc_pointer;
+
+	for(int32_t i = 0 ; i < (int32_t) m->a ; i++){
+		int32_t index_in_buffer = (i * m->b) + argmin_dim2_index;
+		a_mem[i] = m->active[index_in_buffer];
+		m->active[index_in_buffer] = 0;
+	}
+
+	int32_t err = _weitzman(m, &local_res_a);
+	if(err != 0){goto _weitzman_failure;}
+	for(int32_t i = 0 ; i < (int32_t) m->a ; i++){
+		int32_t index_in_buffer = (i * m->b) + argmin_dim2_index;
+		m->active[index_in_buffer] = a_mem[i];
+	}
+	free(a_mem);
+
+
+
+	malloc_pointer = malloc(malloc_size_b);
+	if(malloc_pointer == NULL){
+		goto malloc_failure;
+	}
+	int8_t* b_mem = (int8_t*) malloc_pointer;
+
+	for(uint64_t j = 0 ; j < m->b ; j++){
+		int32_t index_in_buffer = (argmin_dim1_index * m->b) + j;
+		b_mem[j] = m->active[index_in_buffer];
+		m->active[index_in_buffer] = 0;
+	}
+	err = _weitzman(m, &local_res_b);
+	if(err != 0){goto _weitzman_failure;}
+	for(uint64_t j = 0 ; j < m->b ; j++){
+		int32_t index_in_buffer = (argmin_dim1_index * m->b) + j;
+		m->active[index_in_buffer] = b_mem[j];
+	}
+	free(b_mem);
+
+	double result = 0.0;
+	switch(m->fp_mode){
+		case FP32:
+			result = (double) m->bfr.fp32[(argmin_dim1_index * m->b) + argmin_dim2_index];
+			break;
+		case FP64:
+			result = (double) m->bfr.fp64[(argmin_dim1_index * m->b) + argmin_dim2_index];
+			break;
+	}
+	if(local_res_a > local_res_b){
+		result += local_res_a;
+	} else {
+		result += local_res_b;
+	}
+	(*res) = result;
+	
+	
+	return 0;
+
+	malloc_failure:
+	perror("failed to malloc\n");
+	return 1;
+
+	_weitzman_failure:
+	perror("failed to call _weitzman\n");
+	return 1;
+}
+
+int32_t weitzman_from_graph(struct graph* const g, double* const res, const int8_t fp_mode){
+	struct matrix m;
+	int32_t err = create_matrix(&m, g->num_nodes, g->num_nodes, fp_mode);
+	if(err != 0){
+		perror("failed to call create_matrix\n");
+		return 1;
+	}
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
+			int32_t index_in_buffer = (i * m.b) + j;
+			double distance = 0.0;
+			switch(fp_mode){
+				case FP32:
+					distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+					m.bfr.fp32[index_in_buffer] = (float) distance;
+					break;
+				case FP64:
+					distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+					m.bfr.fp64[index_in_buffer] = distance;
+					break;
+			}
+			m.active[index_in_buffer] = 1;
+		}
+	}
+
+	err = _weitzman(&m, res);
+	if(err != 0){
+		free_matrix(&m);
+		perror("failed to call _weitzman\n");
+		return 1;
+	}
+
+	free_matrix(&m);
+	return 0;
+} 
+
+int32_t double_cmp(const void* a, const void* b){
+	double a_ = *((double*) a);
+	double b_ = *((double*) b);
+	if(a_ < b_){
+		return -1;
+	} else if(a_ > b_){
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+int32_t _lexicographic(const struct matrix* const m, double* const res, long double* const res_hybrid){
+	long double _m = (long double) m->a;
+	// long double c_m = (long double) (pow(M_PI, (_m / 2.0)) / lgamma((_m / 2.0) + 1.0));
+	long double c_m = (long double) (pow(PI, (_m / 2.0)) / lgamma((_m / 2.0) + 1.0));
+
+	int32_t argmin_dim1_index = 0;
+	int32_t argmin_dim2_index = 1;
+	int32_t found_a_value = 0;
+
+	void* malloc_pointer;
+
+	size_t malloc_size_champion;
+	malloc_size_champion = m->b * sizeof(double);
+	malloc_pointer = malloc(malloc_size_champion);
+	if(malloc_pointer == NULL){goto malloc_failure;}
+	memset(malloc_pointer, '\0', malloc_size_champion);
+	double* is_min_champion = (double*) malloc_pointer;
+	int32_t length_champion = 0;
+	int32_t i_champion = -1;
+	int32_t j_champion = -1;
+
+	size_t malloc_size_challenger;
+	malloc_size_challenger = m->b * sizeof(double);
+	malloc_pointer = malloc(malloc_size_challenger);
+	if(malloc_pointer == NULL){goto malloc_failure;}
+	memset(malloc_pointer, '\0', malloc_size_challenger);
+	double* is_min_challenger = (double*) malloc_pointer;
+	int32_t length_challenger = 0;
+	
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		if(m->active[i * m->b + i] == 0){
+			continue;
+		}
+		memset(is_min_challenger, '\0', m->b * sizeof(double));
+		length_challenger = 0;
+
+		int32_t local_i_challenger = -1;
+		int32_t local_j_challenger = -1;
+		double local_d_challenger = -1.0;
+
+		for(uint64_t j = 0 ; j < m->b ; j++){ // necessary if we want proper challengers?
+			if(i == j){continue;}
+			if(m->active[j * m->b + j] == 0){
+				continue;
+			}
+			int32_t index_in_buffer = (i * m->b) + j;
+			if(m->active[index_in_buffer] == 0){
+				continue;
+			}
+			double distance = -1.0;
+			switch(m->fp_mode){
+				case FP32:
+					distance = (double) m->bfr.fp32[index_in_buffer];
+					break;
+				case FP64:
+					distance = m->bfr.fp64[index_in_buffer];
+					break;
+			}
+
+			if(length_challenger == 0 || distance < local_d_challenger){
+				local_i_challenger = i;
+				local_j_challenger = j;
+				local_d_challenger = distance;
+			}
+
+			is_min_challenger[length_challenger] = distance;
+			length_challenger++;
+		}
+
+		if(length_challenger == 0){
+			continue;
+		}
+		qsort(is_min_challenger, length_challenger, sizeof(double), double_cmp);
+		if(found_a_value == 0){
+			memcpy(is_min_champion, is_min_challenger, m->b * sizeof(double));
+			length_champion = length_challenger;
+			i_champion = local_i_challenger;
+			j_champion = local_j_challenger;
+			found_a_value = 1;
+			continue;
+		}
+
+		for(int32_t k = 0 ; k < length_challenger && k < length_champion ; k++){
+			if(is_min_challenger[k] == is_min_champion[k]){
+				continue;
+			} else if(is_min_challenger[k] < is_min_champion[k]){
+				memcpy(is_min_champion, is_min_challenger, m->b * sizeof(double));
+				length_champion = length_challenger;
+				i_champion = local_i_challenger;
+				j_champion = local_j_challenger;
+				break;
+			} else {
+				break;
+			}
+		}
+	}
+	if(!found_a_value){
+		return 0;
+	}
+
+	argmin_dim1_index = i_champion;
+	argmin_dim2_index = j_champion;
+
+	m->active_final[(argmin_dim1_index * m->b) + argmin_dim2_index] = 1;
+
+	double local_res_a = 0.0;
+	long double local_res_hybrid_a = 0.0;
+
+	// changing to dim1 as it is the point itself, not the closest point in the rest of graph
+	for(uint64_t j = 0 ; j < m->a ; j++){
+		m->active[argmin_dim1_index * m->b + j] = 0;
+		m->active[j * m->b + argmin_dim1_index] = 0; // assuming square matrix
+	}
+
+	int32_t err = _lexicographic(m, &local_res_a, &local_res_hybrid_a);
+	if(err != 0){goto _lexicographic_failure;}
+
+	double result = 0.0;
+	switch(m->fp_mode){
+		case FP32:
+			result = (double) m->bfr.fp32[(argmin_dim1_index * m->b) + argmin_dim2_index];
+			break;
+		case FP64:
+			result = (double) m->bfr.fp64[(argmin_dim1_index * m->b) + argmin_dim2_index];
+			break;
+	}
+	long double result_hybrid = c_m * ((long double) pow(result, (double) _m));
+	result += local_res_a;
+	result_hybrid += local_res_hybrid_a;
+
+	(*res) = result;
+	(*res_hybrid) = result_hybrid;
+
+	free(is_min_challenger);
+	free(is_min_champion);
+	
+	return 0;
+
+	malloc_failure:
+	perror("failed to malloc\n");
+	return 1;
+
+	_lexicographic_failure:
+	perror("failed to call _lexicographic\n");
+	return 1;
+}
+
+int32_t lexicographic_from_graph(struct graph* const g, double* const res, long double* const res_hybrid, const int8_t fp_mode, const struct matrix* const m_){
+	if(m_ != NULL){
+		memset(m_->active, 1, m_->a * m_->b * sizeof(int8_t));
+		memset(m_->active_final, '\0', m_->a * m_->b * sizeof(int8_t));
+		if(_lexicographic(m_, res, res_hybrid) != 0){
+			perror("failed to call _lexicographic with matrix given as argument\n");
+			return 1;
+		}
+		return 0;
+	} else {
+		struct matrix m;
+		int32_t err = create_matrix(&m, g->num_nodes, g->num_nodes, fp_mode);
+		if(err != 0){
+			perror("failed to call create_matrix\n");
+			return 1;
+		}
+	
+		for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+			for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
+				int32_t index_in_buffer = (i * m.b) + j;
+				double distance = 0.0;
+				switch(fp_mode){
+					case FP32:
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+						m.bfr.fp32[index_in_buffer] = (float) distance;
+						break;
+					case FP64:
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						m.bfr.fp64[index_in_buffer] = distance;
+						break;
+				}
+				m.active[index_in_buffer] = 1;
+				m.active_final[index_in_buffer] = 0;
+			}
+		}
+	
+		err = _lexicographic(&m, res, res_hybrid);
+		if(err != 0){
+			free_matrix(&m);
+			perror("failed to call _lexicographic\n");
+			return 1;
+		}
+	
+		free_matrix(&m);
+	}
+	return 0;
+} 
+
+
+int32_t stirling_from_graph(struct graph* g, double* restrict const result, const double alpha_arg, const double beta_arg, const int8_t fp_mode, const struct matrix* restrict const m_){
+	double local_result = 0.0;
+
+	assert((!isnan(alpha_arg)) && isfinite(alpha_arg));
+	assert((!isnan(beta_arg)) && isfinite(beta_arg));
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+			if(i == j){
+				continue;
+			}
+			double distance = 0.0;
+			if(m_ != NULL){
+				switch(m_->fp_mode){
+					case FP32:
+						distance = (double) m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						distance = m_->bfr.fp64[i * m_->b + j];
+						break;
+				}
+			} else {
+				switch(fp_mode){
+					case FP32:
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+						break;
+					case FP64:
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						break;
+				}
+			}
+			double proportion_product = g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j];
+			local_result += pow(distance, alpha_arg) * pow(proportion_product, beta_arg);
+			assert((!isnan(local_result)) && isfinite(local_result));
+		}
+	}
+
+	(*result) = local_result;
+
+	return 0;
+
+}
+
+int32_t ricotta_szeidl_from_graph(struct graph* const g, double* const result, const double alpha_arg, const int8_t fp_mode, const struct matrix* const m_){
+	double local_result = 0.0;
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		// double local_neg_sum = 1.0;
+        double local_sum;
+        if(alpha_arg == 1.0){
+            local_sum = 0.0;
+        } else {
+            local_sum = 1.0;
+        }
+		for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+			if(i == j){continue;}
+			double distance = 0.0;
+			if(m_ != NULL){
+				switch(m_->fp_mode){
+					case FP32:
+						distance = (double) m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						distance = m_->bfr.fp64[i * m_->b + j];
+						break;
+				}
+			} else {
+				switch(fp_mode){
+					case FP32:
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+						break;
+					case FP64:
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						break;
+				}
+			}
+			if(distance < 0.0){
+				printf("distance is negative: %f\n", distance);
+			}
+
+            if(alpha_arg != 1.0){
+			    local_sum -= distance * g->snapshot.relative_proportions[j];
+            } else {
+                local_sum += (1.0 - distance) * g->snapshot.relative_proportions[j];
+            }
+		}
+
+        if(alpha_arg != 1.0){
+    		double product = g->snapshot.relative_proportions[i] * pow(local_sum, alpha_arg - 1.0);
+    		if(isnan(product)){
+    			printf("product is nan; relative_proportion: %f, pow: %f, local_sum: %f, alpha[k] - 1.0: %f\r", g->snapshot.relative_proportions[i], pow(local_sum, alpha_arg - 1.0), local_sum, alpha_arg - 1.0);
+    			continue;
+    		}
+    		local_result += product;
+        } else {
+	    assert(local_sum >= 0.0);
+            if(local_sum != 0.0){local_result += g->snapshot.relative_proportions[i] * log(local_sum);}
+        }
+	}
+
+    if(alpha_arg != 1.0){
+	    local_result = (1.0 - local_result) / (alpha_arg - 1.0);
+    } else {
+        local_result = -local_result;
+    }
+	(*result) = local_result;
+	return 0;
+}
+
+int32_t chao_et_al_functional_diversity_from_graph(struct graph* const g, double* const div_result, double* const hill_result, const double alpha, const int8_t fp_mode, const struct matrix* const m_){
+	// see Chao et al. (2014)
+	
+	const double LOGARITHMIC_BASE = E;
+
+	double rao_q = 0.0;
+	double* matrix = NULL;
+	if(m_ == NULL){
+		void* malloc_pointer = NULL;
+		size_t malloc_size = g->num_nodes * g->num_nodes * sizeof(double);
+		malloc_pointer = malloc(malloc_size);
+		if(malloc_pointer == NULL){
+			perror("failed to malloc\n");
+			return 1;
+		}
+		memset(malloc_pointer, '\0', malloc_size);
+		matrix = (double*) malloc_pointer;
+	}
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+			double distance = 0.0;
+			if(m_ != NULL){
+				switch(m_->fp_mode){
+					case FP32:
+						distance = (double) m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						distance = m_->bfr.fp64[i * m_->b + j];
+						break;
+					default:
+						perror("unknown FP mode\n");
+						return 1;
+				}
+			} else {
+				switch(fp_mode){
+					case FP32:
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+						break;
+					case FP64:
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						break;
+					default:
+						perror("unknown FP mode\n");
+						return 1;
+				}
+			}
+			if(m_ == NULL){
+				matrix[(i * g->num_nodes) + j] = distance;
+			}
+			rao_q += distance * g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j];
+		}
+	}
+
+	double diversity = 0.0;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+			double distance;
+			if(m_ == NULL){
+				distance = matrix[(i * g->num_nodes) + j];
+			} else {
+				switch(m_->fp_mode){
+					case FP32:
+						distance = (double) m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						distance = m_->bfr.fp64[i * m_->b + j];
+						break;
+					default:
+						perror("unknown FP mode\n");
+						return 1;
+				}
+			}
+			if(alpha != 1.0){
+				diversity += distance * pow((g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j]) / rao_q, alpha);
+			} else {
+				double product_ratio = (g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j]) / rao_q;
+				diversity += distance * product_ratio * (log(product_ratio) / log(LOGARITHMIC_BASE));
+			}
+		}
+	}
+	if(alpha != 1.0){
+		diversity = pow(diversity, 1.0 / (1.0 - alpha));
+	} else {
+		diversity *= -1.0;
+		diversity = pow(LOGARITHMIC_BASE, diversity);
+	}
+
+	double hill_number = pow(diversity / rao_q, 0.5);
+
+	(*div_result) = diversity;
+	(*hill_result) = hill_number;
+
+	free(matrix);
+
+	return 0;
+}
+
+int32_t leinster_cobbold_diversity_from_graph(struct graph* const g, double* const div_result, double* const hill_result, const double alpha, const int8_t fp_mode, const struct matrix* const m_){
+	// see Leinster & Cobbold (2012)
+	
+	const double LOGARITHMIC_BASE = E;
+
+	const double u = 1.0;
+
+	double hill_number;
+	if(alpha != 1.0){
+		hill_number = 0.0;
+	} else {
+		hill_number = 1.0;
+	}
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		double local_agg = 0.0;
+		for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+			double distance = 0.0;
+			if(m_ != NULL){
+				switch(m_->fp_mode){
+					case FP32:
+						distance = (double) m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						distance = m_->bfr.fp64[i * m_->b + j];
+						break;
+				}
+			} else {
+				switch(fp_mode){
+					case FP32:
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+						break;
+					case FP64:
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						break;
+				}
+			}
+
+			double similarity = 1.0 - distance;
+
+			local_agg += g->snapshot.relative_proportions[j] * pow(E, -u * similarity);
+		}
+		if(alpha != 1.0){
+			hill_number += pow(local_agg, alpha - 1.0);
+		} else {
+			hill_number *= pow(local_agg, g->snapshot.relative_proportions[i]);
+		}
+	}
+	if(alpha != 1.0){
+		hill_number = pow(hill_number, 1.0 / (1.0 - alpha));
+	} else {
+		hill_number = pow(hill_number, -1.0);
+	}
+
+	double entropy = log(hill_number) / log(LOGARITHMIC_BASE);
+
+	(*div_result) = entropy;
+	(*hill_result) = hill_number;
+
+	return 0;
+}
+
+int32_t scheiner_species_phylogenetic_functional_diversity_from_graph(struct graph* const g, double* const div_result, double* const hill_result, const double alpha, const int8_t fp_mode, const struct matrix* const m_){
+	// see Scheiner (2012)
+	
+	const long double LOGARITHMIC_BASE = E;
+
+	const int8_t USE_LOGARITHM = 0;
+	
+	void* malloc_pointer = NULL;
+	size_t malloc_size = g->num_nodes * sizeof(long double);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		perror("failed to malloc\n");
+		return 1;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	long double* vector = (long double*) malloc_pointer;
+	long double norm_sum = 0.0;
+
+	long double m = (long double) graph_node_at(g, 0)->num_dimensions;
+	// long double c_m = (long double) (pow(M_PI, (m / 2.0)) / lgamma((m / 2.0) + 1.0));
+	long double c_m = (long double) (pow(PI, (m / 2.0)) / lgamma((m / 2.0) + 1.0));
+	// long double c_m_ln = log(c_m);
+
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		int32_t index_min_distance = -1;
+		long double min_distance = -1.0;
+		for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+			if(i == j){
+				continue;
+			}
+			long double distance = 0.0;
+			if(m_ != NULL){
+				switch(m_->fp_mode){
+					case FP32:
+						distance = (long double) m_->bfr.fp32[i * m_->b + j];
+						break;
+					case FP64:
+						distance = (long double) m_->bfr.fp64[i * m_->b + j];
+						break;
+				}
+			} else {
+				// the paper makes use of euclidean distance
+				switch(fp_mode){
+					case FP32:
+						distance = (long double) graph_snapshot_distance(&(g->snapshot), i, j);
+	
+						// distance = (long double) minkowski_distance_fp32(graph_node_at(g, i)->vector.fp32, graph_node_at(g, j)->vector.fp32, 2.0,  graph_node_at(g, i)->num_dimensions);
+						break;
+					case FP64:
+						distance = (long double) cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						// distance = minkowski_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, 2.0, graph_node_at(g, i)->num_dimensions);
+						break;
+				}
+			}
+
+			if(index_min_distance == -1 || distance < min_distance){
+				index_min_distance = j;
+				min_distance = distance;
+			}
+
+		}
+
+		// long double v_i = c_m * pow(min_distance, m);
+		long double d_pow = (long double) pow(min_distance, m);
+		// long double d_pow_ln = log(d_pow);
+		// long double v_i_ln = c_m_ln + d_pow_ln;
+		// long double v_i = pow(M_E, v_i_ln);
+		long double v_i = (long double) (c_m * d_pow);
+
+		long double abundance = (long double) g->snapshot.absolute_proportions[i];
+		// long double abundance_ln = log(abundance);
+
+		long double phylogenetic_distance = 1.0; // !
+		// long double phylogenetic_distance_ln = log(phylogenetic_distance);
+
+		// matrix[(i * g->num_nodes) + j] = abundance * phylogenetic_distance * v_i;
+		// vector[i] = abundance * phylogenetic_distance * v_i;
+		// vector[i] = abundance_ln + phylogenetic_distance_ln + v_i_ln;
+		long double local_agg;
+		/*
+		if(USE_LOGARITHM){
+			local_agg = abundance_ln + phylogenetic_distance_ln + v_i_ln;
+		} else {
+			local_agg = abundance * phylogenetic_distance * v_i;
+		}
+		*/
+		local_agg = abundance * phylogenetic_distance * v_i;
+		vector[i] = local_agg;
+		norm_sum += local_agg;
+	}
+
+	long double diversity = 0.0;
+	// modification, not like Chao et al. (2014) (?)
+	long double hill_number = 0.0;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		long double distance = vector[i];
+		long double product_ratio = distance / norm_sum;
+		if(USE_LOGARITHM){
+			product_ratio = pow(LOGARITHMIC_BASE, product_ratio); // change
+		}
+		if(alpha != 1.0){
+			hill_number += pow(product_ratio, alpha);
+		} else {
+			diversity += product_ratio * (log(product_ratio) / log(LOGARITHMIC_BASE));
+		}
+	}
+	if(alpha != 1.0){
+		hill_number = pow(hill_number, 1.0 / (1.0 - alpha));
+		diversity = pow(hill_number, 1.0 / alpha);
+	} else {
+		diversity *= -1.0;
+		hill_number = pow(LOGARITHMIC_BASE, diversity);
+	}
+
+	(*div_result) = (double) diversity;
+	(*hill_result) = (double) hill_number;
+
+	free(vector);
+
+	return 0;
+}
+
+int32_t nhc_e_q_from_graph(struct graph* const g, double* const res_nhc, double* const res_e_q){
+	size_t alloc_size = g->num_nodes * sizeof(double);
+	double* proportions = malloc(alloc_size);
+	if(proportions == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	for(uint32_t i = 0 ; i < g->num_nodes ; i++){
+		proportions[i] = (double) g->snapshot.absolute_proportions[i]; // abundances, not relative
+	}
+
+	qsort(proportions, g->num_nodes, sizeof(double), double_cmp);
+
+	// reverse order
+	for(uint32_t i = 0 ; i < floor(((double) g->num_nodes) / 2.0) ; i++){
+		double placeholder = proportions[i];
+		proportions[i] = proportions[g->num_nodes - 1 - i];
+		proportions[g->num_nodes - 1 - i] = placeholder;
+	}
+
+	for(uint32_t i = 0 ; i < g->num_nodes ; i++){
+		proportions[i] = log(proportions[i]);
+	}
+
+	double diff_min_max = 100.0;
+	const double update_divider = 10.0;
+	double min_b = -diff_min_max;
+	double max_b = 0.0;
+	double min_b_prime = -diff_min_max;
+	double max_b_prime = diff_min_max;
+	const uint32_t total_subiter = 32;
+	const uint32_t total_iter = 8;
+	double least_mse = 0.0;
+	double best_b = 0.0;
+	double least_mse_prime = 0.0;
+	double best_b_prime = 0.0;
+	for(uint32_t current_iter = 0 ; current_iter < total_iter ; current_iter++){
+		least_mse = 0.0;
+		best_b = 0.0;
+		least_mse_prime = 0.0;
+		best_b_prime = 0.0;
+		for(uint32_t current_subiter = 0 ; current_subiter < total_subiter ; current_subiter++){
+			double b = min_b + (max_b - min_b) * (((double) current_subiter) / ((double) (total_subiter-1)));
+			double mse = 0.0;
+			double b_prime = min_b_prime + (max_b_prime - min_b_prime) * (((double) current_subiter) / ((double) (total_subiter-1)));
+			double mse_prime = 0.0;
+			for(uint32_t i = 0 ; i < g->num_nodes ; i++){
+				double rank = ((double) i) + 1.0;
+				double real_value = proportions[i] / rank; // log of abundance on rank of abundance
+				double prediction = b * rank;
+				mse += pow(real_value - prediction, 2.0);
+
+				double rank_scaled = rank / ((double) g->num_nodes);
+				double real_value_prime = rank_scaled / proportions[i]; // scaled rank over log of abundance
+				double prediction_prime = b_prime * rank;
+				mse_prime += pow(real_value_prime - prediction_prime, 2.0);
+			}
+			if(current_subiter == 0 || mse < least_mse){
+				least_mse = mse;
+				best_b = b;
+			}
+			if(current_subiter == 0 || mse_prime < least_mse_prime){
+				least_mse_prime = mse_prime;
+				best_b_prime = b_prime;
+			}
+		}
+		diff_min_max /= update_divider;
+		min_b = best_b - diff_min_max / 2.0;
+		max_b = best_b + diff_min_max / 2.0;
+		min_b_prime = best_b_prime - diff_min_max / 2.0;
+		max_b_prime = best_b_prime + diff_min_max / 2.0;
+	}
+
+	(*res_nhc) = best_b;
+	(*res_e_q) = -(2.0/PI) * atan(best_b_prime);
+
+	free(proportions);
+
+	return 0;
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for posix_memalign
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "graph.h"
+#include "distances.h"
+
+struct graph_snapshot_thread_args {
+	struct graph* g;
+	uint64_t start;
+	uint64_t end;
+	uint64_t first_new_node;
+	uint64_t first_new_vector;
+	uint64_t sum;
+	const uint64_t* counts; // NULL to read the counts of the nodes
+	uint8_t gather_counts;
+	uint8_t gather_vectors;
+};
+
+// counts of every node, plus keys and panel rows of the nodes that are new since the previous refresh (nodes never move nor change vector)
+static void* graph_snapshot_gather_thread(void* args){
+	struct graph_snapshot_thread_args* const a = (struct graph_snapshot_thread_args*) args;
+	struct graph_snapshot* const s = &(a->g->snapshot);
+	uint64_t sum = 0;
+
+	for(uint64_t i = a->start ; i < a->end ; i++){
+		const struct graph_node* const node = graph_node_at(a->g, i);
+		if(a->gather_counts){
+			const uint64_t count = a->counts != NULL ? a->counts[i] : __atomic_load_n(&(node->absolute_proportion), __ATOMIC_RELAXED);
+			s->absolute_proportions[i] = count;
+			sum += count;
+			if(i >= a->first_new_node){
+				s->keys[i] = node->word2vec_entry_pointer != NULL ? node->word2vec_entry_pointer->key : NULL;
+			}
+		}
+		if(a->gather_vectors && i >= a->first_new_vector){
+			float* const row = &(s->panel[i * s->stride]);
+			if(node->vector.fp32 != NULL){
+				memcpy(row, node->vector.fp32, s->num_dimensions * sizeof(float));
+				memset(&(row[s->num_dimensions]), '\0', (s->stride - s->num_dimensions) * sizeof(float));
+			} else {
+				memset(row, '\0', s->stride * sizeof(float));
+			}
+			s->norms[i] = vector_norm_fp32(row, s->stride);
+		}
+	}
+	a->sum = sum;
+	return NULL;
+}
+
+static void* graph_snapshot_proportion_thread(void* args){
+	struct graph_snapshot_thread_args* const a = (struct graph_snapshot_thread_args*) args;
+	struct graph_snapshot* const s = &(a->g->snapshot);
+
+	for(uint64_t i = a->start ; i < a->end ; i++){
+		const double relative_proportion = ((double) s->absolute_proportions[i]) / ((double) a->sum);
+		s->relative_proportions[i] = relative_proportion;
+		graph_node_at(a->g, i)->relative_proportion = relative_proportion;
+	}
+	return NULL;
+}
+
+static int32_t graph_snapshot_run(void* (*function)(void*), struct graph_snapshot_thread_args* const args, const int16_t num_threads){
+	pthread_t threads[num_threads];
+	int16_t num_created = 0;
+	int32_t result = 0;
+
+	if(num_threads == 1){
+		function(&(args[0]));
+		return 0;
+	}
+	for(int16_t k = 0 ; k < num_threads ; k++){
+		if(pthread_create(&(threads[k]), NULL, function, &(args[k])) != 0){
+			perror("failed to create snapshot thread\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int16_t k = 0 ; k < num_created ; k++){
+		if(pthread_join(threads[k], NULL) != 0){
+			perror("failed to join snapshot thread\n");
+			result = 1;
+		}
+	}
+	return result;
+}
+
+static int32_t graph_snapshot_reserve(struct graph_snapshot* const s, const uint64_t num_nodes, const uint8_t gather_vectors){
+	void* malloc_pointer;
+
+	if(num_nodes > s->capacity){
+		uint64_t capacity = s->capacity * 2;
+		if(capacity < num_nodes){capacity = num_nodes;}
+		malloc_pointer = realloc(s->norms, capacity * sizeof(float));
+		if(malloc_pointer == NULL){return 1;}
+		s->norms = (float*) malloc_pointer;
+		malloc_pointer = realloc(s->relative_proportions, capacity * sizeof(double));
+		if(malloc_pointer == NULL){return 1;}
+		s->relative_proportions = (double*) malloc_pointer;
+		malloc_pointer = realloc(s->absolute_proportions, capacity * sizeof(uint64_t));
+		if(malloc_pointer == NULL){return 1;}
+		s->absolute_proportions = (uint64_t*) malloc_pointer;
+		malloc_pointer = realloc((void*) s->keys, capacity * sizeof(const char*));
+		if(malloc_pointer == NULL){return 1;}
+		s->keys = (const char**) malloc_pointer;
+		s->capacity = capacity;
+	}
+
+	// the panel cannot be realloc'd without losing its alignment
+	if(gather_vectors && num_nodes > s->panel_capacity){
+		uint64_t panel_capacity = s->panel_capacity * 2;
+		if(panel_capacity < num_nodes){panel_capacity = num_nodes;}
+		if(posix_memalign(&malloc_pointer, GRAPH_SNAPSHOT_ALIGNMENT, panel_capacity * s->stride * sizeof(float)) != 0){return 1;}
+		if(s->panel != NULL){
+			memcpy(malloc_pointer, s->panel, s->num_vectors * s->stride * sizeof(float));
+			free(s->panel);
+		}
+		s->panel = (float*) malloc_pointer;
+		s->panel_capacity = panel_capacity;
+	}
+
+	return 0;
+}
+
+// without gather_counts, the snapshot keeps its node count and proportions, and only the missing panel rows are filled
+static int32_t graph_snapshot_update(struct graph* const g, const uint64_t* const counts, const uint8_t gather_counts, const uint8_t gather_vectors, const int16_t num_threads){
+	struct graph_snapshot* const s = &(g->snapshot);
+	const uint64_t num_nodes = gather_counts ? g->num_nodes : s->num_nodes;
+	uint8_t actually_gather_vectors = gather_vectors;
+
+	if(num_nodes < s->num_vectors){
+		// the graph was emptied and refilled
+		s->num_vectors = 0;
+	}
+	if(actually_gather_vectors && s->num_vectors == 0){
+		const uint16_t num_dimensions = num_nodes > 0 ? graph_node_at(g, 0)->num_dimensions : 0;
+		const uint16_t stride = (uint16_t) (((num_dimensions + GRAPH_SNAPSHOT_STRIDE_STEP - 1) / GRAPH_SNAPSHOT_STRIDE_STEP) * GRAPH_SNAPSHOT_STRIDE_STEP);
+		if(stride != s->stride){
+			free(s->panel);
+			s->panel = NULL;
+			s->panel_capacity = 0;
+		}
+		s->num_dimensions = num_dimensions;
+		s->stride = stride;
+	}
+	if(actually_gather_vectors && s->stride == 0){actually_gather_vectors = 0;}
+
+	if(graph_snapshot_reserve(s, num_nodes, actually_gather_vectors) != 0){
+		perror("failed to allocate graph snapshot\n");
+		return 1;
+	}
+
+	int16_t num_threads_used = num_threads < 1 ? 1 : num_threads;
+	if(((uint64_t) num_threads_used) * GRAPH_SNAPSHOT_MIN_NODES_PER_THREAD > num_nodes){
+		num_threads_used = (int16_t) (num_nodes / GRAPH_SNAPSHOT_MIN_NODES_PER_THREAD);
+		if(num_threads_used < 1){num_threads_used = 1;}
+	}
+
+	struct graph_snapshot_thread_args args[num_threads_used];
+	uint64_t start = 0;
+	for(int16_t k = 0 ; k < num_threads_used ; k++){
+		uint64_t end = start + num_nodes / ((uint64_t) num_threads_used);
+		if(((uint64_t) k) < num_nodes % ((uint64_t) num_threads_used)){end++;}
+		args[k] = (struct graph_snapshot_thread_args) {
+			.g = g,
+			.start = start,
+			.end = end,
+			.first_new_node = s->num_nodes < num_nodes ? s->num_nodes : num_nodes,
+			.first_new_vector = s->num_vectors,
+			.sum = 0,
+			.counts = counts,
+			.gather_counts = gather_counts,
+			.gather_vectors = actually_gather_vectors,
+		};
+		start = end;
+	}
+
+	if(graph_snapshot_run(graph_snapshot_gather_thread, args, num_threads_used) != 0){return 1;}
+	if(!gather_counts){
+		if(actually_gather_vectors){s->num_vectors = num_nodes;}
+		return 0;
+	}
+	uint64_t sum = 0;
+	for(int16_t k = 0 ; k < num_threads_used ; k++){sum += args[k].sum;}
+	for(int16_t k = 0 ; k < num_threads_used ; k++){args[k].sum = sum;}
+	if(graph_snapshot_run(graph_snapshot_proportion_thread, args, num_threads_used) != 0){return 1;}
+
+	s->num_nodes = num_nodes;
+	s->sum_absolute_proportions = sum;
+	s->stale = 0;
+	memset(&(s->memo), '\0', sizeof(struct graph_snapshot_memo));
+	if(actually_gather_vectors){s->num_vectors = num_nodes;}
+
+	return 0;
+}
+
+// brings the snapshot up to date with g, which must not grow meanwhile (callers hold mutex_nodes or own g);
+// counts and proportions are always re-read, while keys and panel rows are only gathered for nodes added since the previous refresh
+int32_t graph_snapshot_refresh(struct graph* const g, const uint8_t gather_vectors, const int16_t num_threads){
+	return graph_snapshot_update(g, NULL, 1, gather_vectors, num_threads);
+}
+
+// same as graph_snapshot_refresh, but with counts[i] standing for the count of node i, as captured earlier by whoever owned g
+int32_t graph_snapshot_refresh_from_counts(struct graph* const g, const uint64_t* const counts, const uint8_t gather_vectors, const int16_t num_threads){
+	return graph_snapshot_update(g, counts, 1, gather_vectors, num_threads);
+}
+
+// only gathers the panel rows missing for the nodes of the last refresh, leaving counts and proportions as they are
+int32_t graph_snapshot_gather_vectors(struct graph* const g, const int16_t num_threads){
+	return graph_snapshot_update(g, NULL, 0, 1, num_threads);
+}
+
+void free_graph_snapshot(struct graph_snapshot* const s){
+	free(s->panel);
+	free(s->norms);
+	free(s->relative_proportions);
+	free(s->absolute_proportions);
+	free((void*) s->keys);
+	memset(s, '\0', sizeof(struct graph_snapshot));
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include "cfgparser/parser.h"
+
+int32_t create_cfg_from_file(struct cfg* const c, const char* const path){
+	size_t alloc_size = CFGPARSER_BFR_SIZE_READ * sizeof(char);
+
+	char* bfr = (char*) malloc(alloc_size);
+	if(bfr == NULL){
+		perror("failed to malloc\n");
+		return 1;
+	}
+	memset(bfr, '\0', alloc_size);
+
+	FILE* f = fopen(path, "r");
+	if(f == NULL){
+		fprintf(stderr, "failed to open %s\n", path);
+		free(bfr);
+		return 1;
+	}
+
+	c->keys = NULL;
+	c->values = NULL;
+	c->num_entries = 0;
+
+	while(fgets(bfr, CFGPARSER_BFR_SIZE_READ, f)){
+		if(bfr[0] == '#' || bfr[0] == '\n' || bfr[0] == '\r'){
+			continue;
+		}
+		char* equal_pointer = strchr(bfr, '=');
+		if(equal_pointer == NULL){
+			fprintf(stderr, "failed to parse a line: %s\n", bfr);
+			continue;
+		}
+		char* end_of_key_pointer = equal_pointer;
+		while(end_of_key_pointer != bfr && (end_of_key_pointer - 1)[0] == ' '){
+			end_of_key_pointer--;
+		}
+		size_t key_size = end_of_key_pointer - bfr;
+		char* value_start_pointer = equal_pointer + 1;
+		while(value_start_pointer[0] == ' '){
+			value_start_pointer++;
+		}
+		size_t value_size = strlen(value_start_pointer);
+		while(value_size > 0 && value_start_pointer[value_size - 1] == '\n'){
+			value_size--;
+		}
+
+
+		size_t local_alloc_size = (c->num_entries + 1) * sizeof(char*);
+		c->keys = realloc(c->keys, local_alloc_size);
+		if(c->keys == NULL){
+			perror("failed to realloc\n");
+			free(bfr);
+			return 1;
+		}
+		// memset((void*) &(c->keys[c->num_entries]), '\0', sizeof(char*));
+
+		// size_t local_alloc_size = (c->num_entries + 1) * sizeof(char*);
+		c->values = realloc(c->values, local_alloc_size);
+		if(c->values == NULL){
+			perror("failed to realloc\n");
+			free(bfr);
+			return 1;
+		}
+
+		local_alloc_size = (key_size + 1) * sizeof(char);
+		c->keys[c->num_entries] = malloc(local_alloc_size);
+		if(c->keys[c->num_entries] == NULL){
+			perror("failed to malloc for key\n");
+			free(bfr);
+			return 1;
+		}
+		strncpy(c->keys[c->num_entries], bfr, key_size);
+		c->keys[c->num_entries][key_size] = '\0';
+
+		local_alloc_size = (value_size + 1) * sizeof(char);
+		c->values[c->num_entries] = malloc(local_alloc_size);
+		if(c->values[c->num_entries] == NULL){
+			perror("failed to malloc for value\n");
+			free(bfr);
+			return 1;
+		}
+		strncpy(c->values[c->num_entries], value_start_pointer, value_size);
+		c->values[c->num_entries][value_size] = '\0';
+
+		c->num_entries++;		
+	}
+
+	fclose(f);
+	free(bfr);
+
+	for(uint32_t i = 0 ; i < c->num_entries - 1 ; i++){
+		uint32_t j = i + 1;
+		while(j >= 1){
+			int32_t str_cmp_result = strcmp(c->keys[j-1], c->keys[j]);
+			if(str_cmp_result > 0){
+				char* placeholder = c->keys[j-1];
+				c->keys[j-1] = c->keys[j];
+				c->keys[j] = placeholder;
+				placeholder = c->values[j-1];
+				c->values[j-1] = c->values[j];
+				c->values[j] = placeholder;
+				j--;
+			} else {
+				break;
+			}
+		}
+	}
+
+	for(uint32_t i = 0 ; i < c->num_entries ; i++){
+		printf("[cfg] %s: %s\n", c->keys[i], c->values[i]);
+	}
+
+	return 0;
+}
+
+void free_cfg(struct cfg* const c){
+	for(uint32_t i = 0 ; i < c->num_entries ; i++){
+		free(c->keys[i]);
+		free(c->values[i]);
+	}
+	free(c->keys);
+	free(c->values);
+}
+
+char* cfg_get_value(const struct cfg* const c, const char* const key){
+	int32_t lower_bound = 0;
+	int32_t higher_bound = (int32_t) c->num_entries;
+	while(lower_bound <= higher_bound){
+		int32_t index = lower_bound + floor(((float) (higher_bound - lower_bound)) / 2.0f);
+		int32_t str_cmp_result = strcmp(key, c->keys[index]);
+		if(str_cmp_result > 0){
+			lower_bound = index + 1;
+		} else if(str_cmp_result < 0){
+			higher_bound = index - 1;
+		} else {
+			return c->values[index];
+		}
+	}
+	return NULL;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for clock_gettime in time.h: https://stackoverflow.com/questions/69145941/why-does-clock-gettime-not-compile-when-using-c99
+// #define _POSIX_C_SOURCE >= 199309L
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <time.h>
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "dfunctions.h"
+#include "distributions.h"
+#include "graph.h"
+#include "instrument.h"
+#include "measurement.h"
+#include "oov/counter.h"
+#include "logging.h"
+#include "schedule.h"
+#include "shard.h"
+#include "snapshot.h"
+#include "stats.h"
+
+// time since the previous call on the same thread, so that worker threads do not skew each other's timings
+int32_t time_ns_delta(int64_t* const delta){
+	return instrument_lap_ns(delta);
+}
+
+int32_t virtual_memory_consumption(int64_t* const res){
+	FILE* f;
+	const int32_t bfr_size = 2048;
+	char bfr[bfr_size];
+	char* strtok_pointer;
+
+	if(res == NULL){
+		perror("Cannot pass NULL pointer to virtual_memory_consumption\n");
+		return 1;
+	}
+
+	memset(bfr, '\0', bfr_size * sizeof(char));
+
+	f = fopen("/proc/self/stat", "r");
+
+	if(f == NULL){
+		perror("Failed to open /proc/self/stat\n");
+		return 1;
+	}
+
+	if(fgets(bfr, bfr_size, f) == 0){
+		perror("No bytes could be read from /proc/self/stat\n");
+		fclose(f);
+		return 1;
+	}
+
+	strtok_pointer = strtok(bfr, " ");
+	for(int32_t i = 0 ; i < 23 ; i++){
+		strtok_pointer = strtok(NULL, " ");
+	}
+	(*res) = strtol(strtok_pointer, NULL, 10);
+
+	fclose(f);
+
+	return 0;
+}
+
+void timing_and_memory(struct output_stream* const output_timing, struct output_stream* const output_memory, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	int64_t ns_delta, virtual_mem;
+	if(enable_output_timing){if(time_ns_delta(&ns_delta) != 0){perror("Failed to call time_ns_delta\n"); exit(1);} else {output_int(output_timing, ns_delta);}}
+	if(enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){perror("Failed to call virtual_memory_consumption\n"); exit(1);} else {output_int(output_memory, virtual_mem);}}
+}
+
+int32_t wrap_diversity_1r_0a(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	double res1;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
+	char bfr[bfr_size];
+	instrument_span_begin(&span, name);
+	if(df(g, &res1, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_1r_0a\n"); return EXIT_FAILURE;}
+	const int64_t delta_ns = instrument_span_end(&span);
+	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
+	memset(bfr, '\0', bfr_size * sizeof(char));
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
+	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
+	output_double(output, res1);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
+	return 0;
+}
+
+int32_t wrap_diversity_1r_0a_no_matrix(const char* const name, struct graph* const g, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, const int8_t), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	double res1;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
+	char bfr[bfr_size];
+	instrument_span_begin(&span, name);
+	if(df(g, &res1, fp_mode) != 0){perror("Failed to call diversity function in wrap_diversity_1r_0a\n"); return EXIT_FAILURE;}
+	const int64_t delta_ns = instrument_span_end(&span);
+	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
+	memset(bfr, '\0', bfr_size * sizeof(char));
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
+	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
+	output_double(output, res1);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
+	return 0;
+}
+
+int32_t wrap_diversity_2r_1a(const char* const name, struct graph* const g, struct matrix* const m, const double alpha, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, double* const, double, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	double res1, res2;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
+	char bfr[bfr_size];
+	instrument_span_begin(&span, name);
+	if(df(g, &res1, &res2, alpha, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_2r_1a\n"); return EXIT_FAILURE;}
+	const int64_t delta_ns = instrument_span_end(&span);
+	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
+	memset(bfr, '\0', bfr_size * sizeof(char));
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
+	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
+	output_double(output, res1); output_double(output, res2);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
+	return 0;
+}
+
+int32_t wrap_diversity_2r_0a(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	double res1, res2;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
+	char bfr[bfr_size];
+	instrument_span_begin(&span, name);
+	if(df(g, &res1, &res2, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_2r_0a\n"); return EXIT_FAILURE;}
+	const int64_t delta_ns = instrument_span_end(&span);
+	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
+	memset(bfr, '\0', bfr_size * sizeof(char));
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
+	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
+	output_double(output, res1); output_double(output, res2);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
+	return 0;
+}
+
+int32_t wrap_diversity_2r_0a_long_double_alt(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, long double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	double res1;
+	long double res2;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
+	char bfr[bfr_size];
+	instrument_span_begin(&span, name);
+	if(df(g, &res1, &res2, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_2r_0a\n"); return EXIT_FAILURE;}
+	const int64_t delta_ns = instrument_span_end(&span);
+	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
+	memset(bfr, '\0', bfr_size * sizeof(char));
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
+	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
+	output_double(output, res1); output_long_double(output, res2);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
+	return 0;
+}
+
+/*
+int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double*, const int8_t, struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+	double res1;
+	time_t t, delta_t;
+	const int32_t bfr_size = 64;
+	char bfr[bfr_size];
+	t = time(NULL);
+	if(df(g, &res1, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_1r_0a\n"); return EXIT_FAILURE;}
+	delta_t = time(NULL) - t;
+	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
+	memset(bfr, '\0', bfr_size * sizeof(char));
+	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
+	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
+	output_double(output, res1);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
+	return 0;
+}
+*/
+
+// requests the primitives of every enabled non-disparity function, so that those shared by several of them are computed once per step
+static void measurement_request_dfunctions_memo(const struct measurement_configuration * const mcfg, struct graph * const g){
+	const struct {uint8_t enabled; uint32_t needs;} table[] = {
+		#if ENABLE_NON_DISPARITY_MULTITHREADING != 1
+		{mcfg->enable.shannon_weaver_entropy, DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY},
+		#endif
+		{mcfg->enable.simpson_index, DFUNCTIONS_NEEDS_SIMPSON_INDEX},
+		{mcfg->enable.simpson_dominance_index, DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX},
+		{mcfg->enable.berger_parker_index, DFUNCTIONS_NEEDS_BERGER_PARKER_INDEX},
+		{mcfg->enable.junge1994_page22, DFUNCTIONS_NEEDS_JUNGE1994_PAGE22},
+		{mcfg->enable.mcintosh_index, DFUNCTIONS_NEEDS_MCINTOSH_INDEX},
+		{mcfg->enable.sw_entropy_over_log_n_species_pielou1975, DFUNCTIONS_NEEDS_SW_ENTROPY_OVER_LOG_N_SPECIES_PIELOU1975},
+		{mcfg->enable.sw_e_heip, DFUNCTIONS_NEEDS_SW_E_HEIP},
+		{mcfg->enable.sw_e_one_minus_d, DFUNCTIONS_NEEDS_SW_E_ONE_MINUS_D},
+		{mcfg->enable.sw_e_one_over_ln_d_williams1964, DFUNCTIONS_NEEDS_SW_E_ONE_OVER_D_WILLIAMS1964},
+		{mcfg->enable.sw_e_minus_ln_d_pielou1977, DFUNCTIONS_NEEDS_SW_E_MINUS_LN_D_PIELOU1977},
+		{mcfg->enable.sw_f_2_1_alatalo1981, DFUNCTIONS_NEEDS_SW_F_2_1_ALATALO1981},
+		{mcfg->enable.sw_g_2_1_molinari1989, DFUNCTIONS_NEEDS_SW_G_2_1_MOLINARI1989},
+		{mcfg->enable.sw_e_bulla1994, DFUNCTIONS_NEEDS_SW_E_BULLA1994},
+		{mcfg->enable.sw_o_bulla1994, DFUNCTIONS_NEEDS_SW_O_BULLA1994},
+		{mcfg->enable.sw_e_mci_pielou1969, DFUNCTIONS_NEEDS_SW_E_MCI_PIELOU1969},
+		{mcfg->enable.sw_e_var_smith_and_wilson1996_original, DFUNCTIONS_NEEDS_SW_E_VAR_SMITH_AND_WILSON1996_ORIGINAL},
+	};
+	for(size_t k = 0 ; k < sizeof(table) / sizeof(table[0]) ; k++){
+		if(table[k].enabled){dfunctions_memo_request(g, table[k].needs);}
+	}
+	#if ENABLE_NON_DISPARITY_MULTITHREADING != 1
+	if(mcfg->enable.renyi_entropy){dfunctions_memo_request_order(g, mcfg->div_param.renyi_alpha);}
+	#endif
+	if(mcfg->enable.hill_number_standard){dfunctions_memo_request_order(g, mcfg->div_param.hill_number_standard_alpha);}
+	if(mcfg->enable.hill_evenness){
+		dfunctions_memo_request_order(g, mcfg->div_param.hill_evenness_alpha);
+		dfunctions_memo_request_order(g, mcfg->div_param.hill_evenness_beta);
+	}
+}
+
+// columns shared by the measurement, timing and memory files, in front of the functions
+static void measurement_output_step_columns(struct output_stream* const output, const uint64_t i, const struct measurement_configuration * const mcfg, const struct measurement_structure_references * const sref, const struct measurement_mutables * const mmut){
+	output_uint(output, i + 1);
+	output_uint(output, mmut->sentence.num_containing_mwe);
+	output_uint(output, mmut->sentence.num_containing_mwe_tp_only);
+	output_uint(output, mmut->sentence.num_all);
+	output_uint(output, mmut->document.num_all);
+	output_string(output, mcfg->io.w2v_path);
+	output_int(output, mmut->num_oov_types);
+	output_double(output, mmut->best_s);
+	output_uint(output, sref->g->num_nodes);
+}
+
+int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut){
+	const uint8_t enable_distance_computation = mcfg->enable.disparity_functions && (mcfg->enable.stirling || mcfg->enable.ricotta_szeidl || mcfg->enable.pairwise || mcfg->enable.chao_et_al_functional_diversity || mcfg->enable.scheiner_species_phylogenetic_functional_diversity || mcfg->enable.leinster_cobbold_diversity || mcfg->enable.lexicographic || mcfg->enable.functional_evenness || mcfg->enable.mst || mcfg->enable.functional_dispersion || mcfg->enable.functional_divergence_modified);
+
+	int32_t err;
+
+	// split between the disparity and non-disparity parts of the step, for the adaptive schedule
+	const int64_t schedule_start_ns = sref->schedule != NULL ? recompute_schedule_now() : 0;
+	int64_t schedule_middle_ns = 0;
+
+	// every kernel below reads the snapshot, whose proportions were refreshed by the caller for the zipfian fit; vectors are only gathered when some distance is needed
+	if(enable_distance_computation && graph_snapshot_gather_vectors(sref->g, mcfg->threading.num_matrix_threads) != 0){
+		perror("failed to call graph_snapshot_gather_vectors\n");
+		return 1;
+	}
+
+	// if(enable_iterative_distance_computation){
+	if(mcfg->threading.enable_iterative_distance_computation){
+		size_t local_malloc_size = sref->g->num_nodes * sizeof(float) * mcfg->threading.row_generation_batch_size;
+		float* vector_batch = (float*) malloc(local_malloc_size);
+		if(vector_batch == NULL){goto malloc_fail;}
+		memset(vector_batch, '\0', local_malloc_size);
+
+		local_malloc_size = sref->g->num_nodes * sizeof(uint8_t) * mcfg->threading.row_generation_batch_size;
+		uint8_t* used = (uint8_t*) malloc(local_malloc_size);
+		if(used == NULL){goto malloc_fail;}
+		memset(used, '\0', local_malloc_size);
+
+		struct iterative_state_pairwise_from_graph iter_state_pairwise;
+		struct iterative_state_stirling_from_graph iter_state_stirling;
+		struct iterative_state_leinster_cobbold_from_graph iter_state_leinster_cobbold;
+		if(create_iterative_state_pairwise_from_graph(&iter_state_pairwise, sref->g) != 0){
+			perror("failled to call create_iterative_state_pairwise_from_graph\n");
+			return 1;
+		}
+		if(create_iterative_state_stirling_from_graph(&iter_state_stirling, sref->g, mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta) != 0){
+			perror("failled to call create_iterative_state_stirling_from_graph\n");
+			return 1;
+		}
+		if(create_iterative_state_leinster_cobbold_from_graph(&iter_state_leinster_cobbold, sref->g, mcfg->div_param.leinster_cobbold_diversity_alpha) != 0){
+			perror("failled to call create_iterative_state_leinster_cobbold_from_graph\n");
+			return 1;
+		}
+
+		int32_t i_index = 0;
+		double sum = 0.0;
+		for(uint64_t h = 0 ; h < sref->g->num_nodes ; h += mcfg->threading.row_generation_batch_size){
+			if(mcfg->threading.enable_multithreaded_row_generation){
+				distance_row_batch_from_graph_multithread(sref->g, i_index, vector_batch, mcfg->threading.num_row_threads, mcfg->threading.row_generation_batch_size);
+			} else {
+				perror("single-threaded version of row computation has been disabled\n");
+				return 1;
+			}
+
+			/* // DO NOT REMOVE
+			// for(uint64_t m = h ; m < sref->g->num_nodes ; m++){
+			for(uint64_t m = 0 ; m < row_generation_batch_size && h + m < sref->g->num_nodes ; m++){
+				for(uint64_t p = i_index + 1 ; p < sref->g->num_nodes ; p++){
+					sum += (double) vector_batch[m * sref->g->num_nodes + p];
+				}
+	
+				if(mcfg->enable.stirling){iterate_iterative_state_stirling_from_graph(&iter_state_stirling, &(vector_batch[m * sref->g->num_nodes]));}
+				if(mcfg->enable.pairwise){iterate_iterative_state_pairwise_from_graph(&iter_state_pairwise, &(vector_batch[m * sref->g->num_nodes]));}
+	
+				i_index = h + m + 1;
+				iter_state_stirling.i = i_index;
+				iter_state_pairwise.i = i_index;
+			}
+			*/
+
+			uint64_t actual_row_generation_batch_size = mcfg->threading.row_generation_batch_size;
+			if(h + mcfg->threading.row_generation_batch_size >= sref->g->num_nodes){
+			// if(sref->g->num_nodes - h < row_generation_batch_size){
+				actual_row_generation_batch_size = sref->g->num_nodes - h;
+			}
+
+			if(mcfg->enable.pairwise){
+				pthread_t agg_threads[mcfg->threading.row_generation_batch_size]; // still have full buffer to make it writeable?
+				struct thread_args_aggregator agg_thread_args[mcfg->threading.row_generation_batch_size];
+				i_index = 0; // ?
+				for(uint64_t m = 0 ; m < actual_row_generation_batch_size ; m++){
+					struct thread_args_aggregator local_args = (struct thread_args_aggregator) {
+						.iter_state.pairwise = &iter_state_pairwise,
+						.i = i_index,
+						.vector = &(vector_batch[m * sref->g->num_nodes]),
+					};
+					memcpy(&(agg_thread_args[m]), &local_args, sizeof(struct thread_args_aggregator));
+
+					#if ENABLE_AVX256 == 1
+					if(pthread_create(&(agg_threads[m]), NULL, iterate_iterative_state_pairwise_from_graph_avx_thread, &(agg_thread_args[m])) != 0){
+					#else
+					if(pthread_create(&(agg_threads[m]), NULL, iterate_iterative_state_pairwise_from_graph_thread, &(agg_thread_args[m])) != 0){
+					#endif
+						perror("Failed to call pthread_create\n");
+						return 1;
+					}
+
+					i_index = h + m + 1; // !
+					iter_state_pairwise.i = i_index; // !
+				}
+
+				for(uint64_t m = 0 ; m < actual_row_generation_batch_size ; m++){
+					pthread_join(agg_threads[m], NULL);
+				}
+			}
+			if(mcfg->enable.stirling){
+				pthread_t agg_threads[mcfg->threading.row_generation_batch_size];
+				struct thread_args_aggregator agg_thread_args[mcfg->threading.row_generation_batch_size];
+				i_index = 0; // ?
+				for(uint64_t m = 0 ; m < actual_row_generation_batch_size ; m++){
+					struct thread_args_aggregator local_args = (struct thread_args_aggregator) {
+						.iter_state.stirling = &iter_state_stirling,
+						.i = i_index,
+						.vector = &(vector_batch[m * sref->g->num_nodes]),
+					};
+					memcpy(&(agg_thread_args[m]), &local_args, sizeof(struct thread_args_aggregator));
+
+					#if ENABLE_AVX256 == 1
+					// if(pthread_create(&(agg_threads[m]), NULL, iterate_iterative_state_stirling_from_graph_avx_thread, &(agg_thread_args[m])) != 0){
+					perror("iterate_iterative_state_stirling_from_graph_avx_thread not implemented\n");
+					return 1;
+					#else
+					if(pthread_create(&(agg_threads[m]), NULL, iterate_iterative_state_stirling_from_graph_thread, &(agg_thread_args[m])) != 0){
+						perror("Failed to call pthread_create\n");
+						return 1;
+					}
+					#endif
+
+					i_index = h + m + 1; // !
+					iter_state_stirling.i = i_index; // !
+				}
+
+				for(uint64_t m = 0 ; m < actual_row_generation_batch_size ; m++){
+					pthread_join(agg_threads[m], NULL);
+				}
+			}
+			if(mcfg->enable.leinster_cobbold_diversity){
+				pthread_t agg_threads[mcfg->threading.row_generation_batch_size];
+				struct thread_args_aggregator agg_thread_args[mcfg->threading.row_generation_batch_size];
+				i_index = 0; // ?
+				for(uint64_t m = 0 ; m < actual_row_generation_batch_size ; m++){
+					struct thread_args_aggregator local_args = (struct thread_args_aggregator) {
+						.iter_state.leinster_cobbold = &iter_state_leinster_cobbold,
+						.i = i_index,
+						.vector = &(vector_batch[m * sref->g->num_nodes]),
+					};
+					memcpy(&(agg_thread_args[m]), &local_args, sizeof(struct thread_args_aggregator));
+
+					#if ENABLE_AVX256 == 1
+					// if(pthread_create(&(agg_threads[m]), NULL, iterate_iterative_state_leinster_cobbold_from_graph_avx_thread, &(agg_thread_args[m])) != 0){
+					perror("iterate_iterative_state_leinster_cobbold_from_graph_avx_thread not implemented\n");
+					return 1;
+					#else
+					if(pthread_create(&(agg_threads[m]), NULL, iterate_iterative_state_leinster_cobbold_from_graph_thread, &(agg_thread_args[m])) != 0){
+						perror("Failed to call pthread_create\n");
+						return 1;
+					}
+					#endif
+
+					i_index = h + m + 1; // !
+					iter_state_leinster_cobbold.i = i_index; // !
+				}
+
+				for(uint64_t m = 0 ; m < actual_row_generation_batch_size ; m++){
+					pthread_join(agg_threads[m], NULL);
+				}
+			}
+		}
+		free(vector_batch);
+		free(used);
+
+
+		finalise_iterative_state_pairwise_from_graph(&iter_state_pairwise);
+		finalise_iterative_state_stirling_from_graph(&iter_state_stirling);
+		finalise_iterative_state_leinster_cobbold_from_graph(&iter_state_leinster_cobbold);
+
+		double mu_dist = sum / ((double) (sref->g->num_nodes * (sref->g->num_nodes - 1) / 2));
+
+		// fprintf(mcfg->io.f_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu\t%.10e\t%c", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes, mu_dist, '?'); // recomputing sigma dist would be expensive // DO NOT REMOVE
+		measurement_output_step_columns(mcfg->io.output, i, mcfg, sref, mmut);
+		output_double(mcfg->io.output, mu_dist);
+		output_string(mcfg->io.output, "?"); // recomputing sigma dist would be expensive
+
+		/*
+		if(mcfg->enable.pairwise){printf("[log] [end iter] pairwise: %f\n", iter_state_pairwise.result); fprintf(mcfg->io.f_ptr, "\t%.10e", iter_state_pairwise.result);}
+		if(mcfg->enable.stirling){printf("[log] [end iter] stirling: %f\n", iter_state_stirling.result); fprintf(mcfg->io.f_ptr, "\t%.10e", iter_state_stirling.result);}
+		if(mcfg->enable.leinster_cobbold_diversity){printf("[log] [end iter] leinster_cobbold: %f, %f\n", iter_state_leinster_cobbold.entropy, iter_state_leinster_cobbold.hill_number); fprintf(mcfg->io.f_ptr, "\t%.10e\t%.10e", iter_state_leinster_cobbold.entropy, iter_state_leinster_cobbold.hill_number);}
+		*/
+
+		const int32_t log_bfr_size = 128;
+		char log_bfr[log_bfr_size];
+
+		if(mcfg->enable.pairwise){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] pairwise: %f", iter_state_pairwise.result); info_format(__FILE__, __func__, __LINE__, log_bfr); output_double(mcfg->io.output, iter_state_pairwise.result);}
+		if(mcfg->enable.stirling){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] stirling: %f", iter_state_stirling.result); info_format(__FILE__, __func__, __LINE__, log_bfr); output_double(mcfg->io.output, iter_state_stirling.result);}
+		if(mcfg->enable.leinster_cobbold_diversity){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] leinster_cobbold: %f, %f", iter_state_leinster_cobbold.entropy, iter_state_leinster_cobbold.hill_number); info_format(__FILE__, __func__, __LINE__, log_bfr); output_double(mcfg->io.output, iter_state_leinster_cobbold.entropy); output_double(mcfg->io.output, iter_state_leinster_cobbold.hill_number);}
+
+		if(output_end_row(mcfg->io.output) != 0){goto output_end_row_failure;}
+	} else {
+		int64_t ns_delta, virtual_mem;
+
+		if(mcfg->io.enable_output_timing){
+			// fprintf(mcfg->io.f_timing_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes); // DO NOT REMOVE
+			measurement_output_step_columns(mcfg->io.output_timing, i, mcfg, sref, mmut);
+			if(time_ns_delta(NULL) != 0){goto time_ns_delta_failure;}
+		}
+		if(mcfg->io.enable_output_memory){
+			// fprintf(mcfg->io.f_memory_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes); // DO NOT REMOVE
+			measurement_output_step_columns(mcfg->io.output_memory, i, mcfg, sref, mmut);
+		}
+
+		struct matrix m_mst = { .fp_mode = FP64, };
+		if(mcfg->enable.functional_evenness || mcfg->enable.mst){
+			if(create_matrix(&m_mst, sref->g->num_nodes, sref->g->num_nodes, FP64) != 0){
+				perror("failed to call create_matrix for MST\n");
+				return 1;
+			}
+			memset(m_mst.active, '\0', sref->g->num_nodes * sref->g->num_nodes * sizeof(uint8_t));
+			memset(m_mst.active_final, '\0', sref->g->num_nodes * sref->g->num_nodes * sizeof(uint8_t));
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+		}
+
+
+		struct matrix m = { .fp_mode = FP32, };
+		if(enable_distance_computation){
+			if(create_matrix(&m, (uint32_t) sref->g->num_nodes, (uint32_t) sref->g->num_nodes, FP32) != 0){
+				perror("failed to call create_matrix\n");
+				return 1;
+			}
+			struct instrument_scope span;
+			instrument_span_begin(&span, "dist_matrix_computation");
+			if(mcfg->threading.enable_multithreaded_matrix_generation){
+				if(distance_matrix_from_graph_multithread(sref->g, &m, mcfg->threading.num_matrix_threads) != 0){
+					perror("failed to call distance_matrix_from_graph_multithread\n");
+					return 1;
+				}
+			} else {
+				// if(distance_matrix_from_graph(sref->g, ANGULAR_MINKOWSKI_DISTANCE_ORDER, &m) != 0){
+				if(distance_matrix_from_graph(sref->g, &m) != 0){
+					perror("failed to call distance_matrix_from_graph\n");
+					return 1;
+				}
+			}
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			const int64_t delta_ns = instrument_span_end(&span);
+			if(mcfg->io.enable_timings){
+				printf("[log] [time] Computed matrix in %.9fs\n", ((double) delta_ns) * 1e-9);
+			}
+		}
+
+		if(mmut->mst_initialised){
+			free_graph_distance_heap(sref->heap);
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){
+				free_minimum_spanning_tree(sref->mst);
+			}
+		}
+
+		// struct graph_distance_heap local_heap;
+		struct graph_distance_heap local_heap = {0};
+
+		double mu_dist = NAN;
+		double sigma_dist = NAN;
+		float mu_dist_fp32 = NAN;
+		float sigma_dist_fp32 = NAN;
+		if(enable_distance_computation && (mcfg->enable.functional_evenness || mcfg->enable.mst)){
+			if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
+			err = create_graph_distance_heap(&local_heap, sref->g, &m);
+			if(err != 0){
+				perror("failed to call create_graph_distance_sref->heap\n");
+				return EXIT_FAILURE;
+			}
+	
+			(*sref->heap) = local_heap;
+
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+
+			#if MST_SANITYT_TESTING == 1
+			printf("create_graph_distance_heap: %lis\n", ns_delta / 1000000000);
+			#endif
+		}
+
+		if(enable_distance_computation){
+			switch(m.fp_mode){
+				case FP32:
+					avg_and_std_fp32(m.bfr.fp32, m.a * m.b, &mu_dist_fp32, &sigma_dist_fp32);
+					mu_dist = (double) mu_dist_fp32;
+					sigma_dist = (double) sigma_dist_fp32;
+					break;
+				case FP64:
+					avg_and_std_fp64(m.bfr.fp64, m.a * m.b, &mu_dist, &sigma_dist);
+					break;
+				default:
+					perror("unknown FP mode\n");
+					return 1;
+			}
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+		}
+
+		// fprintf(mcfg->io.f_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu\t%.10e\t%.10e", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes, mu_dist, sigma_dist); // DO NOT REMOVE
+		measurement_output_step_columns(mcfg->io.output, i, mcfg, sref, mmut);
+		output_double(mcfg->io.output, mu_dist);
+		output_double(mcfg->io.output, sigma_dist);
+
+		if(mcfg->enable.disparity_functions){
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(NULL) != 0){goto time_ns_delta_failure;}}
+	
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){
+				struct instrument_scope span;
+				instrument_span_begin(&span, "mst_computation");
+				struct minimum_spanning_tree local_mst;
+	
+				if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
+				err = create_minimum_spanning_tree(&local_mst, &local_heap);
+				if(err != 0){
+					perror("failed to call create_minimum_spanning_tree\n");
+					return EXIT_FAILURE;
+				}
+	
+				#if MST_SANITY_TESTING == 1
+				printf("calculate_minimum_spanning_tree\n");
+				#endif
+				err = calculate_minimum_spanning_tree(&local_mst, &m_mst, MST_PRIMS_ALGORITHM);
+				if(err != 0){
+					perror("failed to call calculate_minimum_spanning_tree\n");
+					return EXIT_FAILURE;	
+				}
+				
+				(*sref->mst) = local_mst;
+				mmut->mst_initialised = 1;
+	
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){
+					printf("[log] [time] Computed MST in %.9fs\n", ((double) delta_ns) * 1e-9);
+				}
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+				#if MST_SANITY_TESTING == 1
+				printf("mst: %lis\n", ns_delta / 1000000000);
+				#endif
+
+				/*
+				 * Printing the MST's state to output.
+				 */
+
+				FILE * const f_mst = fopen("mst_output.tsv", "w");
+				if(f_mst == NULL){perror("Failed to open file for MST output\n"); return 1;}
+				fputs("a_key\tb_key\tdistance", f_mst);
+				int32_t n = graph_node_at(sref->g, 0)->num_dimensions;
+				#if MST_SANITY_TESTING == 1
+				if(n > 2){n = 2;}
+				#endif
+				for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\ta%i", d);}
+				for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\tb%i", d);}
+				fputc('\n', f_mst);
+
+				for(uint64_t a = 0 ; a < sref->g->num_nodes ; a++){
+					for(uint64_t b = a + 1 ; b < sref->g->num_nodes ; b++){
+						const uint8_t local_active = m_mst.active[a * m_mst.b + b];
+						if(local_active){
+							fprintf(f_mst, "%s\t%s\t%f", graph_node_at(sref->g, a)->word2vec_entry_pointer->key, graph_node_at(sref->g, b)->word2vec_entry_pointer->key, m.bfr.fp32[a * m.b + b]);
+							for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\t%f", graph_node_at(sref->g, a)->word2vec_entry_pointer->vector[d]);}
+							for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\t%f", graph_node_at(sref->g, b)->word2vec_entry_pointer->vector[d]);}
+							fputc('\n', f_mst);
+						}
+					}
+				}
+
+				fclose(f_mst);
+
+				/*
+				 * ***********************************
+				 */
+			}
+			mmut->prev_num_nodes = sref->g->num_nodes;
+	
+			if(mcfg->enable.stirling){
+				double stirling;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "stirling");
+				if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
+				err = stirling_from_graph(sref->g, &stirling, mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta, GRAPH_NODE_FP32, &m);
+				if(err != 0){
+					perror("failed to call stirling_from_graph\n");
+					return EXIT_FAILURE;
+				}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){
+					printf("[log] [time] Computed Stirling in %.9fs\n", ((double) delta_ns) * 1e-9);
+				}
+				output_double(mcfg->io.output, stirling);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+	
+			if(mcfg->enable.ricotta_szeidl){
+				double ricotta_szeidl;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "ricotta_szeidl");
+				if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
+				err = ricotta_szeidl_from_graph(sref->g, &ricotta_szeidl, mcfg->div_param.ricotta_szeidl_alpha, GRAPH_NODE_FP32, &m);
+				if(err != 0){
+					perror("failed to call ricotta_szeidl_from_graph\n");
+					return EXIT_FAILURE;
+				}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){
+					printf("[log] [time] Computed Ricotta-Szeidl in %.9fs\n", ((double) delta_ns) * 1e-9);
+				}
+				output_double(mcfg->io.output, ricotta_szeidl);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+	
+			if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
+			if(mcfg->enable.pairwise){
+				if(wrap_diversity_1r_0a("pairwise", sref->g, &m, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, pairwise_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+	
+			if(mcfg->enable.chao_et_al_functional_diversity){
+				if(wrap_diversity_2r_1a("chao_et_al_functional_diversity", sref->g, &m, mcfg->div_param.chao_et_al_functional_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, chao_et_al_functional_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+	
+			if(mcfg->enable.scheiner_species_phylogenetic_functional_diversity){
+				if(wrap_diversity_2r_1a("scheiner_species_phylogenetic_functional_diversity", sref->g, &m, mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, scheiner_species_phylogenetic_functional_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+	
+			if(mcfg->enable.leinster_cobbold_diversity){
+				if(wrap_diversity_2r_1a("leinster_cobbold_diversity", sref->g, &m, mcfg->div_param.leinster_cobbold_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, leinster_cobbold_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+	
+			if(mcfg->enable.lexicographic){
+				if(wrap_diversity_2r_0a_long_double_alt("lexicographic", sref->g, &m, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, lexicographic_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+	
+			if(mcfg->enable.functional_evenness){
+				if(!mmut->mst_initialised){
+					perror("sref->mst not initialised\n");
+					return 1;
+				}
+				double functional_evenness;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "functional_evenness");
+				err = functional_evenness_from_minimum_spanning_tree(sref->mst, &functional_evenness);
+				if(err != 0){
+					perror("failed to call functional_evenness_from_minimum_spanning_tree\n");
+					return EXIT_FAILURE;
+				}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){
+					printf("[log] [time] Computed FEve in %.9fs\n", ((double) delta_ns) * 1e-9);
+				}
+				output_double(mcfg->io.output, functional_evenness);
+				timing_and_memory(mcfg->io.output_timing, mcfg->io.output_memory, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory);
+			}
+	
+			if(mcfg->enable.mst){
+				if(!mmut->mst_initialised){
+					perror("sref->mst not initialised\n");
+					return 1;
+				}
+				double mst_agg;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "mst");
+				err = agg_mst_from_minimum_spanning_tree(sref->mst, &mst_agg);
+				if(err != 0){
+					perror("failed to call agg_mst_from_minimum_spanning_tree\n");
+					return EXIT_FAILURE;
+				}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){
+					printf("[log] [time] Computed MST (agg) in %.9fs\n", ((double) delta_ns) * 1e-9);
+				}
+				output_double(mcfg->io.output, mst_agg);
+				timing_and_memory(mcfg->io.output_timing, mcfg->io.output_memory, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory);
+			}
+	
+			if(mcfg->enable.functional_dispersion){
+				if(wrap_diversity_1r_0a_no_matrix("functional_dispersion", sref->g, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, functional_dispersion_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+	
+			if(mcfg->enable.functional_divergence_modified){
+				if(wrap_diversity_1r_0a_no_matrix("functional_divergence_modified", sref->g, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, functional_divergence_modified_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+			}
+		}
+
+		if(sref->schedule != NULL){schedule_middle_ns = recompute_schedule_now();}
+
+		if(mcfg->enable.non_disparity_functions){
+            struct cpu_info local_cpu_info = {0};
+            if(get_cpu_info(&local_cpu_info) != 0){
+                perror("Failed to call get_cpu_info\n");
+                return 1;
+            }
+			measurement_request_dfunctions_memo(mcfg, sref->g);
+			struct instrument_scope memo_span;
+			instrument_span_begin(&memo_span, "dfunctions_memo");
+			const int32_t memo_status = dfunctions_memo_compute(sref->g, (int16_t) local_cpu_info.cardinality_virtual_cores);
+			instrument_span_end(&memo_span);
+			if(memo_status != 0){
+				perror("Failed to call dfunctions_memo_compute\n");
+				return 1;
+			}
+			if(mcfg->enable.shannon_weaver_entropy){
+				double res_entropy;
+				double res_hill_number;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "shannon_weaver_entropy");
+
+                #if ENABLE_NON_DISPARITY_MULTITHREADING == 1
+                if(non_disparity_multithread(
+                    entropy_shannon_weaver_transform_proportion,
+                    agregate_local_add,
+                    NULL,
+                    0.0,
+                    sref->g,
+                    0.0,
+                    0.0,
+                    &res_entropy,
+                    &res_hill_number,
+                    (int32_t) local_cpu_info.cardinality_virtual_cores
+                ) != 0){
+                    perror("Failed to call non_disparity_multithread\n");
+                    return 1;
+                }
+                res_hill_number = entropy_shannon_weaver_to_hill_number(res_entropy);
+                #else
+				shannon_weaver_entropy_from_graph(sref->g, &res_entropy, &res_hill_number);
+                #endif
+
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed SW entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.good_entropy){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "good_entropy");
+
+                #if ENABLE_NON_DISPARITY_MULTITHREADING == 1
+                if(non_disparity_multithread(
+                    entropy_good_transform_proportion,
+                    agregate_local_add,
+                    NULL,
+                    0.0,
+                    sref->g,
+                    mcfg->div_param.good_alpha,
+                    mcfg->div_param.good_beta,
+                    &res,
+                    NULL,
+                    (int32_t) local_cpu_info.cardinality_virtual_cores
+                ) != 0){
+                    perror("Failed to call non_disparity_multithread\n");
+                    return 1;
+                }
+                #else
+				good_entropy_from_graph(sref->g, &res, mcfg->div_param.good_alpha, mcfg->div_param.good_beta);
+                #endif
+
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Good entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.renyi_entropy){
+				double res_entropy;
+				double res_hill_number;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "renyi_entropy");
+
+                #if ENABLE_NON_DISPARITY_MULTITHREADING == 1
+                if(non_disparity_multithread(
+                    entropy_renyi_transform_proportion,
+                    agregate_local_add,
+                    entropy_renyi_finalise,
+                    0.0,
+                    sref->g,
+                    mcfg->div_param.renyi_alpha,
+                    0.0,
+                    &res_entropy,
+                    &res_hill_number,
+                    (int32_t) local_cpu_info.cardinality_virtual_cores
+                ) != 0){
+                    perror("Failed to call non_disparity_multithread\n");
+                    return 1;
+                }
+                res_hill_number = entropy_renyi_to_hill_number(res_entropy); 
+                #else
+				renyi_entropy_from_graph(sref->g, &res_entropy, &res_hill_number, mcfg->div_param.renyi_alpha);
+                #endif
+
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Renyi entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.patil_taillie_entropy){
+				double res_entropy;
+				double res_hill_number;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "patil_taillie_entropy");
+				patil_taillie_entropy_from_graph(sref->g, &res_entropy, &res_hill_number, mcfg->div_param.patil_taillie_alpha);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Patil-Taillie entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.q_logarithmic_entropy){
+				double res_entropy;
+				double res_hill_number;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "q_logarithmic_entropy");
+				q_logarithmic_entropy_from_graph(sref->g, &res_entropy, &res_hill_number, mcfg->div_param.q_logarithmic_q);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed q-logarithmic entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.simpson_index){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "simpson_index");
+				simpson_index_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Simpson index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.simpson_dominance_index){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "simpson_dominance_index");
+				simpson_dominance_index_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Simpson dominance index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.hill_number_standard){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "hill_number_standard");
+				hill_number_standard_from_graph(sref->g, &res, mcfg->div_param.hill_number_standard_alpha);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Hill number (standard) in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.hill_evenness){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "hill_evenness");
+				hill_evenness_from_graph(sref->g, &res, mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Hill evenness in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.berger_parker_index){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "berger_parker_index");
+				berger_parker_index_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Berger Parker index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.junge1994_page22){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "junge1994_page22");
+				junge1994_page22_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Junge 1994 p22 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.brillouin_diversity){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "brillouin_diversity");
+				brillouin_diversity_from_graph(sref->g, &res);
+				// printf("res: %f\n", res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Brillouin diversity in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.mcintosh_index){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "mcintosh_index");
+				mcintosh_index_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed McIntosh index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_entropy_over_log_n_species_pielou1975");
+				sw_entropy_over_log_n_species_pielou1975_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) entropy over log n species Pielou 1975 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_heip){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_heip");
+				sw_e_heip_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E Heip in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_one_minus_d){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_one_minus_d");
+				sw_e_one_minus_D_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E one minus D in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_one_over_ln_d_williams1964){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_one_over_ln_d_williams1964");
+				sw_e_one_over_D_williams1964_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E one over ln D Williams 1964 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_minus_ln_d_pielou1977){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_minus_ln_d_pielou1977");
+				sw_e_minus_ln_D_pielou1977_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E minus ln D Pielou 1977 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_f_2_1_alatalo1981){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_f_2_1_alatalo1981");
+				sw_f_2_1_alatalo1981_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) F_2_1 Alatalo 1981 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_g_2_1_molinari1989){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_g_2_1_molinari1989");
+				sw_g_2_1_molinari1989_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) G_2_1 Molinari 1989 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_bulla1994){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_bulla1994");
+				sw_e_bulla1994_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E Bulla 1994 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_o_bulla1994){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_o_bulla1994");
+				sw_o_bulla1994_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) O bulla 1994 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_mci_pielou1969){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_mci_pielou1969");
+				sw_e_mci_pielou1969_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E MCI Pielou 1969 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_prime_camargo1993){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_prime_camargo1993");
+                if(mcfg->threading.enable_sw_e_prime_camargo1993_multithreading){
+				    sw_e_prime_camargo1993_from_graph_multithread(sref->g, &res, mcfg->threading.num_matrix_threads);
+                } else {
+				    sw_e_prime_camargo1993_from_graph(sref->g, &res);
+                }
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E prime Camargo 1993 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+			if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){
+				double res;
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_var_smith_and_wilson1996_original");
+				sw_e_var_smith_and_wilson1996_original_from_graph(sref->g, &res);
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E var Smith and Wilson 1996 original in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			}
+		}
+
+		// every row is ended, so that the three files stay aligned as far as they can
+		int32_t output_status = output_end_row(mcfg->io.output);
+		if(mcfg->io.enable_output_timing && output_end_row(mcfg->io.output_timing) != 0){output_status = 1;}
+		if(mcfg->io.enable_output_memory && output_end_row(mcfg->io.output_memory) != 0){output_status = 1;}
+
+		if(enable_distance_computation){free_matrix(&m);}
+		// created above whether or not the disparity functions are enabled
+		if(mcfg->enable.functional_evenness || mcfg->enable.mst){free_matrix(&m_mst);}
+		if(output_status != 0){goto output_end_row_failure;}
+	}
+
+	if(sref->schedule != NULL){
+		const int64_t schedule_end_ns = recompute_schedule_now();
+		if(schedule_middle_ns == 0){schedule_middle_ns = schedule_end_ns;}
+		if(mcfg->enable.disparity_functions){recompute_schedule_observe_compute(sref->schedule, RECOMPUTE_COST_DISPARITY, sref->g->num_nodes, schedule_middle_ns - schedule_start_ns);}
+		if(mcfg->enable.non_disparity_functions){recompute_schedule_observe_compute(sref->schedule, RECOMPUTE_COST_NON_DISPARITY, sref->g->num_nodes, schedule_end_ns - schedule_middle_ns);}
+	}
+
+	return 0;
+
+	time_ns_delta_failure:
+	perror("Failed to call time_ns_delta\n");
+	return 1;
+
+	virtual_memory_consumption_failure:
+	perror("Failed to call virtual_memory_consumption\n");
+	return 1;
+
+	output_end_row_failure:
+	perror("Failed to call output_end_row\n");
+	return 1;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	return 1;
+}
+
+// one recompute step on sref->g, whose snapshot proportions must already match the counts of the step;
+// unless forced, the functions are skipped when neither the zipfian fit nor the number of nodes changed since the previous step
+int32_t measurement_recompute_step(const uint64_t i, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, const uint8_t force){
+	const int32_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	if(sref->step_hook != NULL){return sref->step_hook->step(sref->step_hook->ctx, i, sref->g, mmut);}
+
+	const int64_t schedule_start_ns = sref->schedule != NULL ? recompute_schedule_now() : 0;
+
+	if(zipfian_fit_from_graph(sref->g, &mmut->best_s) != 0){
+		perror("failed to call zipfian_fit_from_graph\n");
+		return 1;
+	}
+	if(sref->schedule != NULL){recompute_schedule_observe_compute(sref->schedule, RECOMPUTE_COST_FIT, sref->g->num_nodes, recompute_schedule_now() - schedule_start_ns);}
+
+	if(force || mmut->best_s != mmut->prev_best_s || sref->g->num_nodes != ((uint64_t) mmut->prev_num_nodes)){
+		memset(log_bfr, '\0', log_bfr_size);
+		snprintf(log_bfr, log_bfr_size, "best_s: %f; num_nodes: %lu; num_sentences: %lu; num_documents: %lu", mmut->best_s, sref->g->num_nodes, mmut->sentence.num_all, mmut->document.num_all);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+		struct instrument_scope span;
+		instrument_span_begin(&span, "recompute_step");
+		const int32_t apply_status = apply_diversity_functions_to_graph(i, mcfg, sref, mmut);
+		instrument_span_end(&span);
+		if(apply_status != 0){
+			perror("failed to call apply_diversity_functions_to_graph\n");
+			return 1;
+		}
+		mmut->prev_best_s = mmut->best_s;
+	} else {
+		printf("ignoring because best_s (%.12f) == previous_best_s (%.12f) && g->num_nodes (%lu) == previous_g_num_nodes (%li)\n", mmut->best_s, mmut->prev_best_s, sref->g->num_nodes, mmut->prev_num_nodes);
+	}
+
+	return 0;
+}
+
+// the counts of sref->g and of the OOV counter, once every reader is done
+int32_t measurement_capture_shard(struct shard * const s, const struct measurement_structure_references * const sref, const struct measurement_mutables * const mmut, const uint64_t num_files){
+	struct oov_counter_entry * oov_entries = NULL;
+	int64_t num_oov_entries = 0;
+	if(oov_counter_entries(sref->oov_discarded_because_not_in_vector_database, &oov_entries, &num_oov_entries) != 0){
+		perror("failed to call oov_counter_entries\n");
+		return 1;
+	}
+
+	const uint64_t num_nodes = graph_num_nodes(sref->g);
+	size_t key_blob_size = 0;
+	for(uint64_t k = 0 ; k < num_nodes ; k++){key_blob_size += strlen(graph_node_at(sref->g, k)->word2vec_entry_pointer->key) + 1;}
+	for(int64_t k = 0 ; k < num_oov_entries ; k++){key_blob_size += strlen(oov_entries[k].key) + 1;}
+	if(create_shard(s, num_nodes, (uint64_t) num_oov_entries, key_blob_size) != 0){
+		perror("failed to call create_shard\n");
+		free(oov_entries);
+		return 1;
+	}
+
+	// first_seen is the index of the node, so that the nodes are created in the same order when the shard is measured
+	size_t blob_position = 0;
+	for(uint64_t k = 0 ; k < num_nodes ; k++){
+		const struct graph_node * const node = graph_node_at(sref->g, k);
+		const size_t length = strlen(node->word2vec_entry_pointer->key) + 1;
+		memcpy(s->key_blob + blob_position, node->word2vec_entry_pointer->key, length);
+		s->entries[k].key = s->key_blob + blob_position;
+		s->entries[k].count = __atomic_load_n(&(node->absolute_proportion), __ATOMIC_RELAXED);
+		s->entries[k].first_seen = k;
+		s->num_tokens += s->entries[k].count;
+		blob_position += length;
+	}
+	for(int64_t k = 0 ; k < num_oov_entries ; k++){
+		const size_t length = strlen(oov_entries[k].key) + 1;
+		memcpy(s->key_blob + blob_position, oov_entries[k].key, length);
+		s->oov_entries[k].key = s->key_blob + blob_position;
+		s->oov_entries[k].count = (uint64_t) oov_entries[k].value;
+		s->num_oov_tokens += s->oov_entries[k].count;
+		blob_position += length;
+	}
+	free(oov_entries);
+
+	s->oov_exact = oov_counter_is_exact(sref->oov_discarded_because_not_in_vector_database);
+	s->num_oov_types = oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database);
+	s->num_files = num_files;
+	s->num_documents = mmut->document.num_all;
+	s->num_sentences = mmut->sentence.num_all;
+	s->num_sentences_containing_mwe = mmut->sentence.num_containing_mwe;
+	s->num_sentences_containing_mwe_tp_only = mmut->sentence.num_containing_mwe_tp_only;
+
+	if(shard_sort(s) != 0){
+		perror("failed to call shard_sort\n");
+		free_shard(s);
+		return 1;
+	}
+	return 0;
+}
+
+static int32_t measurement_shard_entry_cmp_first_seen(const void * const a, const void * const b){
+	const uint64_t x = (*((const struct shard_entry * const *) a))->first_seen;
+	const uint64_t y = (*((const struct shard_entry * const *) b))->first_seen;
+	return (x > y) - (x < y);
+}
+
+// fills the empty graph sref->g (bound to sref->w2v) and the counters of mmut; the OOV counter stays empty, its number of types is given back instead
+int32_t measurement_restore_shard(const struct shard * const s, const struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, int64_t * const num_oov_types){
+	const struct shard_entry ** const order = (const struct shard_entry **) malloc((s->num_entries > 0 ? s->num_entries : 1) * sizeof(struct shard_entry *));
+	if(order == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	for(uint64_t k = 0 ; k < s->num_entries ; k++){order[k] = &(s->entries[k]);}
+	qsort(order, s->num_entries, sizeof(struct shard_entry *), measurement_shard_entry_cmp_first_seen);
+
+	for(uint64_t k = 0 ; k < s->num_entries ; k++){
+		const int32_t index = word2vec_key_to_index(sref->w2v, order[k]->key);
+		if(index < 0){
+			fprintf(stderr, "shard key not in the vector database: %s\n", order[k]->key);
+			goto failure;
+		}
+		struct word2vec_entry * const entry = &(sref->w2v->keys[index]);
+		if(graph_add_word2vec_occurrence(sref->g, sref->w2v, entry) != 0){
+			perror("failed to call graph_add_word2vec_occurrence\n");
+			goto failure;
+		}
+		graph_word2vec_node(sref->g, sref->w2v, entry)->absolute_proportion = order[k]->count;
+	}
+	free(order);
+
+	mmut->document.num_all = s->num_documents;
+	mmut->sentence.num_all = s->num_sentences;
+	mmut->sentence.num_containing_mwe = s->num_sentences_containing_mwe;
+	mmut->sentence.num_containing_mwe_tp_only = s->num_sentences_containing_mwe_tp_only;
+	*num_oov_types = s->num_oov_types;
+	return 0;
+
+	failure:
+	free(order);
+	return 1;
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for fileno and ftruncate
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "output.h"
+
+struct output_buffer {
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+};
+
+static int32_t output_buffer_reserve(struct output_buffer* const b, const size_t size){
+	if(b->size + size <= b->capacity){return 0;}
+	size_t capacity = b->capacity == 0 ? 4096 : b->capacity * 2;
+	while(capacity < b->size + size){capacity *= 2;}
+	void* const malloc_pointer = realloc(b->data, capacity);
+	if(malloc_pointer == NULL){return 1;}
+	b->data = (uint8_t*) malloc_pointer;
+	b->capacity = capacity;
+	return 0;
+}
+
+static int32_t output_buffer_bytes(struct output_buffer* const b, const void* const bytes, const size_t size){
+	if(output_buffer_reserve(b, size) != 0){return 1;}
+	memcpy(&(b->data[b->size]), bytes, size);
+	b->size += size;
+	return 0;
+}
+
+static int32_t output_buffer_le(struct output_buffer* const b, const uint64_t value, const uint32_t num_bytes){
+	if(output_buffer_reserve(b, num_bytes) != 0){return 1;}
+	for(uint32_t k = 0 ; k < num_bytes ; k++){b->data[b->size++] = (uint8_t) (value >> (8 * k));}
+	return 0;
+}
+
+static int32_t output_buffer_varint(struct output_buffer* const b, uint64_t value){
+	if(output_buffer_reserve(b, 10) != 0){return 1;}
+	while(value >= 0x80){
+		b->data[b->size++] = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	b->data[b->size++] = (uint8_t) value;
+	return 0;
+}
+
+static char* output_copy_string(const char* const value){
+	const char* const source = value != NULL ? value : "(null)"; // as printf would have written it
+	const size_t size = strlen(source) + 1;
+	char* const copy = malloc(size);
+	if(copy != NULL){memcpy(copy, source, size);}
+	return copy;
+}
+
+static void output_free_cells(const uint8_t* const types, const uint32_t num_columns, union output_cell* const cells, const uint32_t num_rows){
+	if(types == NULL){return;}
+	for(uint32_t c = 0 ; c < num_columns ; c++){
+		if(types[c] != OUTPUT_TYPE_STRING){continue;}
+		for(uint32_t r = 0 ; r < num_rows ; r++){free(cells[r * num_columns + c].s);}
+	}
+}
+
+static void output_free_row_group(const struct output_stream* const s, struct output_row_group* const group){
+	output_free_cells(s->types, s->num_columns, group->cells, group->num_rows);
+	free(group->cells);
+	free(group);
+}
+
+static int32_t output_write_tsv(FILE* const f, const uint8_t* const types, const uint32_t num_columns, const union output_cell* const cells, const uint32_t num_rows){
+	for(uint32_t r = 0 ; r < num_rows ; r++){
+		for(uint32_t c = 0 ; c < num_columns ; c++){
+			const union output_cell* const cell = &(cells[r * num_columns + c]);
+			if(c > 0){fputc('\t', f);}
+			switch(types[c]){
+				case OUTPUT_TYPE_UINT64: fprintf(f, "%lu", cell->u); break;
+				case OUTPUT_TYPE_INT64: fprintf(f, "%li", cell->i); break;
+				case OUTPUT_TYPE_DOUBLE: fprintf(f, "%.10e", cell->d); break;
+				case OUTPUT_TYPE_LONG_DOUBLE: fprintf(f, "%.10Le", cell->ld); break;
+				case OUTPUT_TYPE_STRING: fputs(cell->s, f); break;
+				default: return 1;
+			}
+		}
+		fputc('\n', f);
+	}
+	return ferror(f) ? 1 : 0;
+}
+
+static uint64_t output_zigzag(const int64_t value){
+	return (((uint64_t) value) << 1) ^ (uint64_t) (value >> 63);
+}
+
+static int64_t output_unzigzag(const uint64_t value){
+	return (int64_t) (value >> 1) ^ -((int64_t) (value & 1));
+}
+
+static uint64_t output_double_bits(const double value){
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(uint64_t));
+	return bits;
+}
+
+static int32_t output_encode_row_group(const struct output_stream* const s, const struct output_row_group* const group, struct output_buffer* const b){
+	const uint32_t n = s->num_columns;
+
+	if(output_buffer_le(b, group->num_rows, 4) != 0){return 1;}
+	for(uint32_t c = 0 ; c < n ; c++){
+		// every group starts from zero, so that it can be decoded on its own
+		uint64_t previous = 0;
+		const char* previous_string = NULL;
+		for(uint32_t r = 0 ; r < group->num_rows ; r++){
+			const union output_cell* const cell = &(group->cells[r * n + c]);
+			int32_t err = 0;
+			switch(s->types[c]){
+				case OUTPUT_TYPE_UINT64:
+				case OUTPUT_TYPE_INT64:
+					if(s->compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						err = output_buffer_varint(b, output_zigzag((int64_t) (cell->u - previous)));
+						previous = cell->u;
+					} else {
+						err = output_buffer_le(b, cell->u, 8);
+					}
+					break;
+				case OUTPUT_TYPE_DOUBLE:
+					if(s->compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						// neighbouring rows mostly share their sign, exponent and leading mantissa bits
+						const uint64_t bits = output_double_bits(cell->d);
+						const uint64_t x = bits ^ previous;
+						const uint32_t num_bytes = x == 0 ? 0 : 8 - ((uint32_t) __builtin_clzll(x)) / 8;
+						err = output_buffer_le(b, num_bytes, 1);
+						if(err == 0){err = output_buffer_le(b, x, num_bytes);}
+						previous = bits;
+					} else {
+						err = output_buffer_le(b, output_double_bits(cell->d), 8);
+					}
+					break;
+				case OUTPUT_TYPE_LONG_DOUBLE:
+					err = output_buffer_bytes(b, &(cell->ld), sizeof(long double));
+					break;
+				case OUTPUT_TYPE_STRING: {
+					const size_t length = strlen(cell->s);
+					if(s->compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						if(previous_string != NULL && strcmp(previous_string, cell->s) == 0){
+							err = output_buffer_varint(b, 0);
+						} else {
+							err = output_buffer_varint(b, ((uint64_t) length) + 1);
+							if(err == 0){err = output_buffer_bytes(b, cell->s, length);}
+						}
+						previous_string = cell->s;
+					} else {
+						err = output_buffer_varint(b, (uint64_t) length);
+						if(err == 0){err = output_buffer_bytes(b, cell->s, length);}
+					}
+					break;
+				}
+				default:
+					err = 1;
+			}
+			if(err != 0){return 1;}
+		}
+	}
+	return 0;
+}
+
+// header, then the schema for the columnar format; called by whichever thread writes first, once no more row can be added to the schema
+static int32_t output_write_preamble(struct output_stream* const s){
+	s->preamble_written = 1;
+	if(s->format == OUTPUT_FORMAT_TSV){
+		if(s->header_size > 0 && fwrite(s->header, 1, s->header_size, s->f) != s->header_size){return 1;}
+		return 0;
+	}
+
+	struct output_buffer b = {0};
+	int32_t err = output_buffer_bytes(&b, OUTPUT_COLUMNAR_MAGIC, OUTPUT_COLUMNAR_MAGIC_SIZE);
+	if(err == 0){err = output_buffer_le(&b, s->compression, 1);}
+	if(err == 0){err = output_buffer_le(&b, sizeof(long double), 1);}
+	if(err == 0){err = output_buffer_le(&b, s->row_group_size, 4);}
+	if(err == 0){err = output_buffer_le(&b, s->header_size, 8);}
+	if(err == 0 && s->header_size > 0){err = output_buffer_bytes(&b, s->header, s->header_size);}
+	if(err == 0){err = output_buffer_le(&b, s->num_columns, 4);}
+	if(err == 0 && s->num_columns > 0){err = output_buffer_bytes(&b, s->types, s->num_columns);}
+	if(err == 0 && fwrite(b.data, 1, b.size, s->f) != b.size){err = 1;}
+	free(b.data);
+	return err;
+}
+
+static int32_t output_write_row_group(struct output_stream* const s, const struct output_row_group* const group, struct output_buffer* const b){
+	if(!(s->preamble_written) && output_write_preamble(s) != 0){return 1;}
+	if(s->format == OUTPUT_FORMAT_TSV){
+		return output_write_tsv(s->f, s->types, s->num_columns, group->cells, group->num_rows);
+	}
+	b->size = 0;
+	if(output_encode_row_group(s, group, b) != 0){return 1;}
+	return fwrite(b->data, 1, b->size, s->f) != b->size ? 1 : 0;
+}
+
+static void* output_writer_thread(void* args){
+	struct output_stream* const s = (struct output_stream*) args;
+	struct output_buffer b = {0};
+
+	while(1){
+		pthread_mutex_lock(&(s->mutex));
+		while(s->queue_head == NULL && !(s->closing)){pthread_cond_wait(&(s->cond_not_empty), &(s->mutex));}
+		struct output_row_group* const group = s->queue_head;
+		if(group == NULL){
+			pthread_mutex_unlock(&(s->mutex));
+			break;
+		}
+		s->queue_head = group->next;
+		if(s->queue_head == NULL){s->queue_tail = NULL;}
+		s->queue_length--;
+		s->writing = 1;
+		const int32_t failed = s->status;
+		pthread_cond_signal(&(s->cond_not_full));
+		pthread_mutex_unlock(&(s->mutex));
+
+		// after a failure, groups are only drained so that the producer never blocks
+		const int32_t write_failed = !failed && output_write_row_group(s, group, &b) != 0;
+		if(write_failed){perror("failed to write output row group\n");}
+		output_free_row_group(s, group);
+
+		pthread_mutex_lock(&(s->mutex));
+		if(write_failed){s->status = 1;}
+		s->writing = 0;
+		pthread_cond_broadcast(&(s->cond_not_full)); // output_stream_sync waits for the writer to be idle
+		pthread_mutex_unlock(&(s->mutex));
+	}
+
+	free(b.data);
+	return NULL;
+}
+
+// resume_size < 0 creates the file, otherwise the file is cut at resume_size and written after it
+static int32_t output_stream_open(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size, const int64_t resume_size){
+	memset(s, '\0', sizeof(struct output_stream));
+	if(format != OUTPUT_FORMAT_TSV && format != OUTPUT_FORMAT_COLUMNAR){
+		perror("unknown output format\n");
+		return 1;
+	}
+	s->format = format;
+	s->compression = compression ? OUTPUT_COMPRESSION_DELTA_XOR : OUTPUT_COMPRESSION_NONE;
+	s->row_group_size = format == OUTPUT_FORMAT_TSV || row_group_size == 0 ? 1 : row_group_size;
+
+	if(resume_size < 0){
+		s->f = fopen(path, format == OUTPUT_FORMAT_TSV ? "w" : "wb");
+	} else {
+		s->f = fopen(path, "r+b");
+	}
+	if(s->f == NULL){
+		fprintf(stderr, "Failed to open file: %s\n", path);
+		return 1;
+	}
+	if(resume_size >= 0){
+		if(ftruncate(fileno(s->f), (off_t) resume_size) != 0 || fseek(s->f, 0, SEEK_END) != 0){
+			fprintf(stderr, "Failed to cut file: %s\n", path);
+			goto failure_mutex;
+		}
+		s->preamble_written = resume_size > 0; // the header and the schema are already in the file
+	}
+	if(pthread_mutex_init(&(s->mutex), NULL) != 0){goto failure_mutex;}
+	if(pthread_cond_init(&(s->cond_not_empty), NULL) != 0){goto failure_cond_not_empty;}
+	if(pthread_cond_init(&(s->cond_not_full), NULL) != 0){goto failure_cond_not_full;}
+	if(pthread_create(&(s->writer), NULL, output_writer_thread, s) != 0){
+		perror("failed to create output writer thread\n");
+		goto failure_thread;
+	}
+	return 0;
+
+	failure_thread:
+	pthread_cond_destroy(&(s->cond_not_full));
+	failure_cond_not_full:
+	pthread_cond_destroy(&(s->cond_not_empty));
+	failure_cond_not_empty:
+	pthread_mutex_destroy(&(s->mutex));
+	failure_mutex:
+	fclose(s->f);
+	s->f = NULL;
+	return 1;
+}
+
+int32_t create_output_stream(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size){
+	return output_stream_open(s, path, format, compression, row_group_size, -1);
+}
+
+// the header must be declared again, as for a new stream, but is not written twice
+int32_t create_output_stream_resumed(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size, const int64_t size){
+	return output_stream_open(s, path, format, compression, row_group_size, size < 0 ? 0 : size);
+}
+
+int32_t output_header(struct output_stream* const s, const char* const format, ...){
+	va_list args;
+
+	va_start(args, format);
+	const int32_t size = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+	if(size < 0){return 1;}
+
+	if(s->header_size + ((size_t) size) + 1 > s->header_capacity){
+		size_t capacity = s->header_capacity == 0 ? 1024 : s->header_capacity * 2;
+		while(capacity < s->header_size + ((size_t) size) + 1){capacity *= 2;}
+		void* const malloc_pointer = realloc(s->header, capacity);
+		if(malloc_pointer == NULL){perror("malloc failed\n"); return 1;}
+		s->header = (char*) malloc_pointer;
+		s->header_capacity = capacity;
+	}
+
+	va_start(args, format);
+	vsnprintf(&(s->header[s->header_size]), ((size_t) size) + 1, format, args);
+	va_end(args);
+	s->header_size += (size_t) size;
+	return 0;
+}
+
+// the writer thread reads the status as well
+static void output_set_failed(struct output_stream* const s){
+	pthread_mutex_lock(&(s->mutex));
+	s->status = 1;
+	pthread_mutex_unlock(&(s->mutex));
+}
+
+static int32_t output_push(struct output_stream* const s, const enum output_type type, const union output_cell* const cell){
+	if(s->row_length == s->row_capacity){
+		const uint32_t capacity = s->row_capacity == 0 ? 64 : s->row_capacity * 2;
+		void* malloc_pointer = realloc(s->row, capacity * sizeof(union output_cell));
+		if(malloc_pointer == NULL){goto malloc_fail;}
+		s->row = (union output_cell*) malloc_pointer;
+		malloc_pointer = realloc(s->row_types, capacity * sizeof(uint8_t));
+		if(malloc_pointer == NULL){goto malloc_fail;}
+		s->row_types = (uint8_t*) malloc_pointer;
+		s->row_capacity = capacity;
+	}
+	s->row[s->row_length] = *cell;
+	s->row_types[s->row_length] = (uint8_t) type;
+	s->row_length++;
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	if(type == OUTPUT_TYPE_STRING){free(cell->s);}
+	s->row_failed = 1;
+	output_set_failed(s);
+	return 1;
+}
+
+int32_t output_uint(struct output_stream* const s, const uint64_t value){
+	return output_push(s, OUTPUT_TYPE_UINT64, &(union output_cell) {.u = value});
+}
+
+int32_t output_int(struct output_stream* const s, const int64_t value){
+	return output_push(s, OUTPUT_TYPE_INT64, &(union output_cell) {.i = value});
+}
+
+int32_t output_double(struct output_stream* const s, const double value){
+	return output_push(s, OUTPUT_TYPE_DOUBLE, &(union output_cell) {.d = value});
+}
+
+int32_t output_long_double(struct output_stream* const s, const long double value){
+	// the columnar format writes sizeof(long double) bytes, padding included, which must not depend on the stack
+	union output_cell cell;
+	memset(&cell, '\0', sizeof(union output_cell));
+	cell.ld = value;
+	return output_push(s, OUTPUT_TYPE_LONG_DOUBLE, &cell);
+}
+
+int32_t output_string(struct output_stream* const s, const char* const value){
+	char* const copy = output_copy_string(value);
+	if(copy == NULL){
+		perror("malloc failed\n");
+		s->row_failed = 1;
+		output_set_failed(s);
+		return 1;
+	}
+	return output_push(s, OUTPUT_TYPE_STRING, &(union output_cell) {.s = copy});
+}
+
+static void output_discard_row(struct output_stream* const s){
+	output_free_cells(s->row_types, s->row_length, s->row, 1);
+	s->row_length = 0;
+	s->row_failed = 0;
+}
+
+static int32_t output_enqueue(struct output_stream* const s, struct output_row_group* const group){
+	pthread_mutex_lock(&(s->mutex));
+	while(s->queue_length >= OUTPUT_QUEUE_CAPACITY){pthread_cond_wait(&(s->cond_not_full), &(s->mutex));}
+	group->next = NULL;
+	if(s->queue_tail != NULL){
+		s->queue_tail->next = group;
+	} else {
+		s->queue_head = group;
+	}
+	s->queue_tail = group;
+	s->queue_length++;
+	pthread_cond_signal(&(s->cond_not_empty));
+	pthread_mutex_unlock(&(s->mutex));
+	return 0;
+}
+
+// also reports the values of the row that output_uint and the like failed to add
+int32_t output_end_row(struct output_stream* const s){
+	if(s->row_failed){
+		output_discard_row(s);
+		return 1;
+	}
+	if(!(s->schema_set)){
+		if(s->row_length > 0){
+			s->types = malloc(s->row_length * sizeof(uint8_t));
+			if(s->types == NULL){perror("malloc failed\n"); output_discard_row(s); output_set_failed(s); return 1;}
+			memcpy(s->types, s->row_types, s->row_length * sizeof(uint8_t));
+		}
+		s->num_columns = s->row_length;
+		s->schema_set = 1;
+	} else if(s->row_length != s->num_columns || (s->num_columns > 0 && memcmp(s->row_types, s->types, s->num_columns) != 0)){
+		perror("row does not match the columns of the output stream\n");
+		output_discard_row(s);
+		output_set_failed(s);
+		return 1;
+	}
+
+	if(s->current == NULL){
+		s->current = malloc(sizeof(struct output_row_group));
+		if(s->current == NULL){goto malloc_fail;}
+		s->current->num_rows = 0;
+		s->current->next = NULL;
+		s->current->cells = malloc(((size_t) s->row_group_size) * ((size_t) s->num_columns) * sizeof(union output_cell) + 1);
+		if(s->current->cells == NULL){free(s->current); s->current = NULL; goto malloc_fail;}
+	}
+	memcpy(&(s->current->cells[((size_t) s->current->num_rows) * s->num_columns]), s->row, s->num_columns * sizeof(union output_cell));
+	s->current->num_rows++;
+	s->row_length = 0;
+
+	if(s->current->num_rows == s->row_group_size){
+		struct output_row_group* const group = s->current;
+		s->current = NULL;
+		return output_enqueue(s, group);
+	}
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	output_discard_row(s);
+	output_set_failed(s);
+	return 1;
+}
+
+// hands over the complete rows, even if their group is not full, and waits until they are in the file; *size is where a resumed stream starts over
+int32_t output_stream_sync(struct output_stream* const s, int64_t* const size){
+	if(s->f == NULL){return 1;}
+	if(s->current != NULL){
+		struct output_row_group* const group = s->current;
+		s->current = NULL;
+		output_enqueue(s, group);
+	}
+
+	pthread_mutex_lock(&(s->mutex));
+	while((s->queue_head != NULL || s->writing) && s->status == 0){pthread_cond_wait(&(s->cond_not_full), &(s->mutex));}
+	const int32_t status = s->status;
+	pthread_mutex_unlock(&(s->mutex));
+	if(status != 0){return 1;}
+
+	// the writer thread stays idle until the next group
+	if(fflush(s->f) != 0){return 1;}
+	const long position = ftell(s->f);
+	if(position < 0){return 1;}
+	*size = s->preamble_written ? (int64_t) position : 0;
+	return 0;
+}
+
+// hands over the last rows, waits for the writer thread and closes the file; a row left unfinished is dropped
+int32_t output_stream_finish(struct output_stream* const s){
+	int32_t result = 0;
+
+	if(s->f == NULL){return 1;}
+	if(s->row_length > 0){output_discard_row(s);}
+	if(s->current != NULL){
+		struct output_row_group* const group = s->current;
+		s->current = NULL;
+		output_enqueue(s, group);
+	}
+
+	pthread_mutex_lock(&(s->mutex));
+	s->closing = 1;
+	pthread_cond_signal(&(s->cond_not_empty));
+	pthread_mutex_unlock(&(s->mutex));
+	if(pthread_join(s->writer, NULL) != 0){
+		perror("failed to join output writer thread\n");
+		result = 1;
+	}
+
+	if(s->status != 0){result = 1;}
+	if(result == 0 && !(s->preamble_written) && output_write_preamble(s) != 0){result = 1;}
+	if(result == 0 && s->format == OUTPUT_FORMAT_COLUMNAR){
+		const uint8_t end[4] = {0};
+		if(fwrite(end, 1, 4, s->f) != 4){result = 1;}
+	}
+	if(fclose(s->f) != 0){result = 1;}
+	s->f = NULL;
+
+	return result;
+}
+
+void free_output_stream(struct output_stream* const s){
+	if(s->f != NULL){output_stream_finish(s);}
+	output_discard_row(s);
+	free(s->row);
+	free(s->row_types);
+	free(s->header);
+	free(s->types);
+	pthread_cond_destroy(&(s->cond_not_full));
+	pthread_cond_destroy(&(s->cond_not_empty));
+	pthread_mutex_destroy(&(s->mutex));
+	memset(s, '\0', sizeof(struct output_stream));
+}
+
+/* ======== CONVERSION ======== */
+
+static int32_t output_read_le(FILE* const f, uint64_t* const value, const uint32_t num_bytes){
+	uint8_t bytes[8];
+	if(fread(bytes, 1, num_bytes, f) != num_bytes){return 1;}
+	*value = 0;
+	for(uint32_t k = 0 ; k < num_bytes ; k++){*value |= ((uint64_t) bytes[k]) << (8 * k);}
+	return 0;
+}
+
+static int32_t output_read_varint(FILE* const f, uint64_t* const value){
+	*value = 0;
+	for(uint32_t shift = 0 ; shift < 64 ; shift += 7){
+		const int c = fgetc(f);
+		if(c == EOF){return 1;}
+		*value |= ((uint64_t) (c & 0x7f)) << shift;
+		if(!(c & 0x80)){return 0;}
+	}
+	return 1;
+}
+
+static int32_t output_read_string(FILE* const f, const uint64_t length, char** const value){
+	*value = malloc(length + 1);
+	if(*value == NULL){return 1;}
+	if(length > 0 && fread(*value, 1, length, f) != length){free(*value); *value = NULL; return 1;}
+	(*value)[length] = '\0';
+	return 0;
+}
+
+static int32_t output_decode_row_group(FILE* const f, const uint8_t* const types, const uint32_t num_columns, const uint8_t compression, union output_cell* const cells, const uint32_t num_rows){
+	for(uint32_t c = 0 ; c < num_columns ; c++){
+		uint64_t previous = 0;
+		for(uint32_t r = 0 ; r < num_rows ; r++){
+			union output_cell* const cell = &(cells[r * num_columns + c]);
+			uint64_t value;
+			switch(types[c]){
+				case OUTPUT_TYPE_UINT64:
+				case OUTPUT_TYPE_INT64:
+					if(compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						if(output_read_varint(f, &value) != 0){return 1;}
+						previous += (uint64_t) output_unzigzag(value);
+						cell->u = previous;
+					} else {
+						if(output_read_le(f, &(cell->u), 8) != 0){return 1;}
+					}
+					break;
+				case OUTPUT_TYPE_DOUBLE:
+					if(compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						uint64_t num_bytes;
+						if(output_read_le(f, &num_bytes, 1) != 0 || num_bytes > 8){return 1;}
+						if(output_read_le(f, &value, (uint32_t) num_bytes) != 0){return 1;}
+						previous ^= value;
+					} else {
+						if(output_read_le(f, &previous, 8) != 0){return 1;}
+					}
+					memcpy(&(cell->d), &previous, sizeof(double));
+					break;
+				case OUTPUT_TYPE_LONG_DOUBLE:
+					if(fread(&(cell->ld), 1, sizeof(long double), f) != sizeof(long double)){return 1;}
+					break;
+				case OUTPUT_TYPE_STRING:
+					cell->s = NULL;
+					if(output_read_varint(f, &value) != 0){return 1;}
+					if(compression == OUTPUT_COMPRESSION_DELTA_XOR && value == 0){
+						if(r == 0){return 1;}
+						cell->s = output_copy_string(cells[(r - 1) * num_columns + c].s);
+						if(cell->s == NULL){return 1;}
+					} else {
+						if(compression == OUTPUT_COMPRESSION_DELTA_XOR){value--;}
+						if(output_read_string(f, value, &(cell->s)) != 0){return 1;}
+					}
+					break;
+				default:
+					return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+// writes back the TSV file that the same rows would have produced with OUTPUT_FORMAT_TSV
+int32_t output_columnar_to_tsv(FILE* const f_in, FILE* const f_out){
+	char magic[OUTPUT_COLUMNAR_MAGIC_SIZE];
+	uint64_t compression, long_double_size, row_group_size, header_size, num_columns;
+	char* header = NULL;
+	uint8_t* types = NULL;
+	union output_cell* cells = NULL;
+	int32_t result = 1;
+
+	if(fread(magic, 1, OUTPUT_COLUMNAR_MAGIC_SIZE, f_in) != OUTPUT_COLUMNAR_MAGIC_SIZE || memcmp(magic, OUTPUT_COLUMNAR_MAGIC, OUTPUT_COLUMNAR_MAGIC_SIZE) != 0){
+		perror("not a columnar output file\n");
+		return 1;
+	}
+	if(output_read_le(f_in, &compression, 1) != 0 || output_read_le(f_in, &long_double_size, 1) != 0 || output_read_le(f_in, &row_group_size, 4) != 0 || output_read_le(f_in, &header_size, 8) != 0){goto truncated;}
+	if(long_double_size != sizeof(long double)){
+		perror("columnar output file written with another long double layout\n");
+		return 1;
+	}
+	if(output_read_string(f_in, header_size, &header) != 0){goto truncated;}
+	if(header_size > 0 && fwrite(header, 1, header_size, f_out) != header_size){goto write_failure;}
+	if(output_read_le(f_in, &num_columns, 4) != 0){goto truncated;}
+	if(num_columns > 0){
+		types = malloc(num_columns);
+		if(types == NULL || fread(types, 1, num_columns, f_in) != num_columns){goto truncated;}
+	}
+	if(row_group_size == 0){row_group_size = 1;}
+	cells = malloc(row_group_size * num_columns * sizeof(union output_cell) + 1);
+	if(cells == NULL){goto truncated;}
+
+	while(1){
+		uint64_t num_rows;
+		if(output_read_le(f_in, &num_rows, 4) != 0){goto truncated;}
+		if(num_rows == 0){break;}
+		if(num_rows > row_group_size){goto truncated;}
+		memset(cells, '\0', num_rows * num_columns * sizeof(union output_cell));
+		const int32_t err = output_decode_row_group(f_in, types, (uint32_t) num_columns, (uint8_t) compression, cells, (uint32_t) num_rows);
+		if(err == 0 && output_write_tsv(f_out, types, (uint32_t) num_columns, cells, (uint32_t) num_rows) != 0){
+			output_free_cells(types, (uint32_t) num_columns, cells, (uint32_t) num_rows);
+			goto write_failure;
+		}
+		output_free_cells(types, (uint32_t) num_columns, cells, (uint32_t) num_rows);
+		if(err != 0){goto truncated;}
+	}
+	result = 0;
+	goto cleanup;
+
+	truncated:
+	perror("truncated or corrupted columnar output file\n");
+	goto cleanup;
+
+	write_failure:
+	perror("failed to write TSV file\n");
+
+	cleanup:
+	free(cells);
+	free(types);
+	free(header);
+	return result;
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GNU_SOURCE
+// for syscall in unistd.h, as well as clock_gettime and getrusage
+#define _GNU_SOURCE
+#endif
+
+#include <time.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+#include "instrument.h"
+
+static pthread_once_t instrument_once = PTHREAD_ONCE_INIT;
+static pthread_key_t instrument_key;
+static pthread_mutex_t instrument_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct instrument_thread* instrument_threads = NULL;
+static uint32_t instrument_num_threads = 0;
+static int32_t instrument_key_status = 0;
+
+// read without the mutex by every thread
+static uint8_t instrument_enabled = 0;
+static uint8_t instrument_counters_enabled = 0;
+static uint32_t instrument_generation = 0;
+static int64_t instrument_origin_ns = 0;
+static uint8_t instrument_counters_opened = 0; // set once a thread could open every counter
+
+// not part of struct instrument_thread, so that laps never register the thread
+static __thread int64_t instrument_last_lap_ns = 0;
+
+int64_t instrument_now_ns(void){
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0){return 0;}
+	return ((int64_t) ts.tv_sec) * 1000000000 + (int64_t) ts.tv_nsec;
+}
+
+static void instrument_close_counters(struct instrument_thread* const t){
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		if(t->counter_fds[c] >= 0){close(t->counter_fds[c]);}
+		t->counter_fds[c] = -1;
+	}
+}
+
+static void instrument_unlink_thread(struct instrument_thread* const t){
+	for(struct instrument_thread** p = &instrument_threads ; (*p) != NULL ; p = &((*p)->next)){
+		if((*p) == t){
+			(*p) = t->next;
+			break;
+		}
+	}
+	pthread_mutex_destroy(&(t->mutex));
+	free(t->spans);
+	free(t);
+}
+
+// key destructor, run when a registered thread exits: its counters are closed, and the structure is freed unless it holds spans of the current session, in which case instrument_free frees it
+static void instrument_thread_exit(void* arg){
+	struct instrument_thread* const t = (struct instrument_thread*) arg;
+
+	pthread_mutex_lock(&instrument_mutex);
+	instrument_close_counters(t);
+	pthread_mutex_lock(&(t->mutex));
+	const uint8_t has_spans = t->num_spans > 0 && t->generation == __atomic_load_n(&instrument_generation, __ATOMIC_ACQUIRE);
+	t->retired = 1;
+	pthread_mutex_unlock(&(t->mutex));
+	if(!has_spans){instrument_unlink_thread(t);}
+	pthread_mutex_unlock(&instrument_mutex);
+}
+
+static void instrument_create_key(void){
+	instrument_key_status = pthread_key_create(&instrument_key, instrument_thread_exit);
+}
+
+// counters of the calling thread only, user space only so that the default perf_event_paranoid allows them
+static void instrument_open_counters(struct instrument_thread* const t){
+	#ifdef __linux__
+	const uint64_t configs[INSTRUMENT_NUM_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES};
+	int32_t num_opened = 0;
+
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		struct perf_event_attr attr;
+		memset(&attr, '\0', sizeof(struct perf_event_attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(struct perf_event_attr);
+		attr.config = configs[c];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		t->counter_fds[c] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if(t->counter_fds[c] < 0){t->counter_fds[c] = -1;} else {num_opened++;}
+	}
+	if(num_opened == INSTRUMENT_NUM_COUNTERS){__atomic_store_n(&instrument_counters_opened, 1, __ATOMIC_RELAXED);}
+	#else
+	(void) t;
+	#endif
+}
+
+static void instrument_read_counters(const struct instrument_thread* const t, int64_t* const values){
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		uint64_t value;
+		values[c] = -1;
+		if(t == NULL || t->counter_fds[c] < 0){continue;}
+		if(read(t->counter_fds[c], &value, sizeof(uint64_t)) == (ssize_t) sizeof(uint64_t)){values[c] = (int64_t) value;}
+	}
+}
+
+// the structure of the calling thread, registered by its first recorded span; it is retired by instrument_thread_exit
+static struct instrument_thread* instrument_thread_get(void){
+	if(pthread_once(&instrument_once, instrument_create_key) != 0 || instrument_key_status != 0){return NULL;}
+
+	struct instrument_thread* t = (struct instrument_thread*) pthread_getspecific(instrument_key);
+	if(t == NULL){
+		t = (struct instrument_thread*) calloc(1, sizeof(struct instrument_thread));
+		if(t == NULL){return NULL;}
+		for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){t->counter_fds[c] = -1;}
+		t->os_tid = (int64_t) syscall(SYS_gettid);
+		if(pthread_mutex_init(&(t->mutex), NULL) != 0){free(t); return NULL;}
+		if(pthread_setspecific(instrument_key, t) != 0){pthread_mutex_destroy(&(t->mutex)); free(t); return NULL;}
+		pthread_mutex_lock(&instrument_mutex);
+		t->index = instrument_num_threads++;
+		t->next = instrument_threads;
+		instrument_threads = t;
+		pthread_mutex_unlock(&instrument_mutex);
+	}
+
+	// spans and counters of a previous instrument_init are dropped by the thread itself
+	const uint32_t generation = __atomic_load_n(&instrument_generation, __ATOMIC_ACQUIRE);
+	if(t->generation != generation){
+		pthread_mutex_lock(&(t->mutex));
+		t->num_spans = 0;
+		pthread_mutex_unlock(&(t->mutex));
+		t->depth = 0;
+		instrument_close_counters(t);
+		if(__atomic_load_n(&instrument_counters_enabled, __ATOMIC_RELAXED)){instrument_open_counters(t);}
+		t->generation = generation;
+	}
+	return t;
+}
+
+int32_t instrument_init(const uint8_t enable_counters){
+	if(pthread_once(&instrument_once, instrument_create_key) != 0 || instrument_key_status != 0){
+		perror("failed to create instrument key\n");
+		return 1;
+	}
+	pthread_mutex_lock(&instrument_mutex);
+	__atomic_store_n(&instrument_origin_ns, instrument_now_ns(), __ATOMIC_RELAXED);
+	__atomic_store_n(&instrument_counters_opened, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&instrument_counters_enabled, enable_counters ? 1 : 0, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&instrument_generation, 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&instrument_enabled, 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&instrument_mutex);
+	return 0;
+}
+
+// stops recording and releases the spans of every thread, as well as the threads that exited; spans still open are dropped when they end
+void instrument_free(void){
+	pthread_mutex_lock(&instrument_mutex);
+	__atomic_store_n(&instrument_enabled, 0, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&instrument_generation, 1, __ATOMIC_RELEASE);
+	struct instrument_thread* next;
+	for(struct instrument_thread* t = instrument_threads ; t != NULL ; t = next){
+		next = t->next;
+		if(t->retired){
+			instrument_unlink_thread(t);
+			continue;
+		}
+		pthread_mutex_lock(&(t->mutex));
+		free(t->spans);
+		t->spans = NULL;
+		t->num_spans = 0;
+		t->capacity = 0;
+		pthread_mutex_unlock(&(t->mutex));
+	}
+	pthread_mutex_unlock(&instrument_mutex);
+}
+
+uint8_t instrument_counters_available(void){
+	return __atomic_load_n(&instrument_counters_opened, __ATOMIC_RELAXED);
+}
+
+// time since the previous call on the same thread, whether or not spans are recorded
+int32_t instrument_lap_ns(int64_t* const delta){
+	const int64_t now = instrument_now_ns();
+	if(delta != NULL){(*delta) = now - instrument_last_lap_ns;}
+	instrument_last_lap_ns = now;
+	return 0;
+}
+
+void instrument_span_begin(struct instrument_scope* const scope, const char* const name){
+	scope->name = name;
+	scope->thread = NULL;
+	if(__atomic_load_n(&instrument_enabled, __ATOMIC_ACQUIRE)){
+		scope->thread = instrument_thread_get();
+		if(scope->thread != NULL){
+			scope->thread->depth++;
+			instrument_read_counters(scope->thread, scope->counters);
+		}
+	}
+	scope->start_ns = instrument_now_ns();
+}
+
+// returns the duration of the span, which is measured whether or not spans are recorded
+int64_t instrument_span_end(struct instrument_scope* const scope){
+	const int64_t end_ns = instrument_now_ns();
+	const int64_t duration_ns = end_ns - scope->start_ns;
+	struct instrument_thread* const t = scope->thread;
+
+	if(t == NULL){return duration_ns;}
+	scope->thread = NULL;
+	if(t->depth > 0){t->depth--;}
+	if(!__atomic_load_n(&instrument_enabled, __ATOMIC_ACQUIRE) || t->generation != __atomic_load_n(&instrument_generation, __ATOMIC_ACQUIRE)){return duration_ns;}
+
+	struct instrument_span span = {
+		.name = scope->name,
+		.start_ns = scope->start_ns - __atomic_load_n(&instrument_origin_ns, __ATOMIC_RELAXED),
+		.duration_ns = duration_ns,
+		.peak_rss_kb = -1,
+		.depth = t->depth,
+		.thread_index = t->index,
+		.os_tid = t->os_tid,
+	};
+	instrument_read_counters(t, span.counters);
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		if(span.counters[c] >= 0 && scope->counters[c] >= 0){span.counters[c] -= scope->counters[c];} else {span.counters[c] = -1;}
+	}
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) == 0){span.peak_rss_kb = (int64_t) usage.ru_maxrss;}
+
+	pthread_mutex_lock(&(t->mutex));
+	if(t->num_spans == t->capacity){
+		const uint64_t capacity = t->capacity == 0 ? INSTRUMENT_INITIAL_CAPACITY : 2 * t->capacity;
+		void* const malloc_pointer = realloc(t->spans, capacity * sizeof(struct instrument_span));
+		if(malloc_pointer == NULL){
+			pthread_mutex_unlock(&(t->mutex));
+			return duration_ns; // the span is lost, not the measurement
+		}
+		t->spans = (struct instrument_span*) malloc_pointer;
+		t->capacity = capacity;
+	}
+	t->spans[t->num_spans++] = span;
+	pthread_mutex_unlock(&(t->mutex));
+
+	return duration_ns;
+}
+
+static int instrument_compare_spans(const void* a, const void* b){
+	const struct instrument_span* const x = (const struct instrument_span*) a;
+	const struct instrument_span* const y = (const struct instrument_span*) b;
+	if(x->thread_index != y->thread_index){return x->thread_index < y->thread_index ? -1 : 1;}
+	if(x->start_ns != y->start_ns){return x->start_ns < y->start_ns ? -1 : 1;}
+	if(x->depth != y->depth){return x->depth < y->depth ? -1 : 1;}
+	return 0;
+}
+
+// copies the spans of every thread, by thread then by start; the caller frees *spans
+int32_t instrument_collect(struct instrument_span** const spans, uint64_t* const num_spans){
+	uint64_t n = 0;
+
+	pthread_mutex_lock(&instrument_mutex);
+	for(struct instrument_thread* t = instrument_threads ; t != NULL ; t = t->next){
+		pthread_mutex_lock(&(t->mutex));
+		n += t->num_spans;
+		pthread_mutex_unlock(&(t->mutex));
+	}
+	(*spans) = (struct instrument_span*) malloc((n + 1) * sizeof(struct instrument_span));
+	if((*spans) == NULL){
+		pthread_mutex_unlock(&instrument_mutex);
+		perror("malloc failed\n");
+		return 1;
+	}
+	uint64_t k = 0;
+	for(struct instrument_thread* t = instrument_threads ; t != NULL ; t = t->next){
+		pthread_mutex_lock(&(t->mutex));
+		const uint64_t num_copied = t->num_spans < n - k ? t->num_spans : n - k; // spans ended since they were counted are left out
+		if(num_copied > 0){memcpy(&((*spans)[k]), t->spans, num_copied * sizeof(struct instrument_span));}
+		k += num_copied;
+		pthread_mutex_unlock(&(t->mutex));
+	}
+	pthread_mutex_unlock(&instrument_mutex);
+
+	qsort(*spans, k, sizeof(struct instrument_span), instrument_compare_spans);
+	(*num_spans) = k;
+	return 0;
+}
+
+static void instrument_print_json_string(FILE* const f, const char* const s){
+	fputc('"', f);
+	for(const char* c = s ; c != NULL && *c != '\0' ; c++){
+		if(*c == '"' || *c == '\\'){
+			fputc('\\', f);
+			fputc(*c, f);
+		} else if((unsigned char) *c < 0x20){
+			fprintf(f, "\\u%04x", (unsigned int) (unsigned char) *c);
+		} else {
+			fputc(*c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+// complete events ("ph": "X") in the Chrome trace event format, which chrome://tracing and Perfetto open
+int32_t instrument_export_chrome_trace(const char* const path){
+	struct instrument_span* spans;
+	uint64_t num_spans;
+	const long pid = (long) getpid();
+
+	if(instrument_collect(&spans, &num_spans) != 0){return 1;}
+
+	FILE* const f = fopen(path, "w");
+	if(f == NULL){
+		fprintf(stderr, "Failed to open file: %s\n", path);
+		free(spans);
+		return 1;
+	}
+
+	fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+	int64_t previous_tid = -1;
+	uint8_t first = 1;
+	for(uint64_t k = 0 ; k < num_spans ; k++){
+		const struct instrument_span* const s = &(spans[k]);
+		if(s->os_tid != previous_tid){
+			fprintf(f, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %li, \"tid\": %li, \"args\": {\"name\": \"thread %u\"}}", first ? "" : ",", pid, (long) s->os_tid, s->thread_index);
+			previous_tid = s->os_tid;
+			first = 0;
+		}
+		fprintf(f, ",\n{\"name\": ");
+		instrument_print_json_string(f, s->name);
+		fprintf(f, ", \"cat\": \"diversutils\", \"ph\": \"X\", \"ts\": %li.%03li, \"dur\": %li.%03li, \"pid\": %li, \"tid\": %li, \"args\": {\"depth\": %u, \"peak_rss_kb\": %li", (long) (s->start_ns / 1000), (long) (s->start_ns % 1000), (long) (s->duration_ns / 1000), (long) (s->duration_ns % 1000), pid, (long) s->os_tid, s->depth, (long) s->peak_rss_kb);
+		if(s->counters[INSTRUMENT_COUNTER_CYCLES] >= 0){fprintf(f, ", \"cycles\": %li", (long) s->counters[INSTRUMENT_COUNTER_CYCLES]);}
+		if(s->counters[INSTRUMENT_COUNTER_LLC_MISSES] >= 0){fprintf(f, ", \"llc_misses\": %li", (long) s->counters[INSTRUMENT_COUNTER_LLC_MISSES]);}
+		fprintf(f, "}}");
+	}
+	fprintf(f, "\n]}\n");
+
+	free(spans);
+	const int32_t write_failed = ferror(f) ? 1 : 0;
+	if(fclose(f) != 0 || write_failed){
+		fprintf(stderr, "Failed to write file: %s\n", path);
+		return 1;
+	}
+	return 0;
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for open_memstream, fmemopen, fsync and clock_gettime
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "graph.h"
+#include "measurement.h"
+#include "output.h"
+#include "recompute.h"
+#include "schedule.h"
+#include "logging.h"
+#include "oov/counter.h"
+
+static uint64_t checkpoint_checksum(const char* const bfr, const size_t size){
+	uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+	for(size_t k = 0 ; k < size ; k++){
+		h ^= (uint64_t) ((uint8_t) bfr[k]);
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static int32_t checkpoint_write(FILE* const f, const void* const p, const size_t size){
+	return fwrite(p, 1, size, f) != size;
+}
+
+static int32_t checkpoint_read(FILE* const f, void* const p, const size_t size){
+	return fread(p, 1, size, f) != size;
+}
+
+// paths are not copied, and must outlive the checkpoint
+int32_t create_checkpoint(struct checkpoint* const cp, const char* const path, const double interval_seconds, char* const * const paths, const int32_t num_files){
+	memset(cp, '\0', sizeof(struct checkpoint));
+	cp->interval_ns = (int64_t) (interval_seconds * 1e9);
+	if(cp->interval_ns < 1){cp->interval_ns = 1;}
+	cp->paths = paths;
+	cp->num_files = num_files;
+	for(int32_t k = 0 ; k < CHECKPOINT_NUM_OUTPUTS ; k++){cp->output_sizes[k] = -1;}
+
+	const size_t path_size = strlen(path) + 1;
+	cp->path = (char*) malloc(path_size);
+	cp->tmp_path = (char*) malloc(path_size + 4);
+	cp->files = (struct checkpoint_file*) calloc(num_files > 0 ? num_files : 1, sizeof(struct checkpoint_file));
+	if(cp->path == NULL || cp->tmp_path == NULL || cp->files == NULL){
+		perror("malloc failed\n");
+		goto failure;
+	}
+	memcpy(cp->path, path, path_size);
+	snprintf(cp->tmp_path, path_size + 4, "%s.tmp", path);
+
+	if(pthread_mutex_init(&(cp->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		goto failure;
+	}
+	if(pthread_cond_init(&(cp->cond_parked), NULL) != 0 || pthread_cond_init(&(cp->cond_resume), NULL) != 0){
+		perror("failed to call pthread_cond_init\n");
+		pthread_mutex_destroy(&(cp->mutex));
+		goto failure;
+	}
+	return 0;
+
+	failure:
+	free(cp->path);
+	free(cp->tmp_path);
+	free(cp->files);
+	memset(cp, '\0', sizeof(struct checkpoint));
+	return 1;
+}
+
+// ---- capture ----
+
+// the file progress and the output sizes come first, so that checkpoint_open can reopen the outputs before anything else is restored
+static int32_t checkpoint_serialize_progress(const struct checkpoint* const cp, FILE* const f){
+	const uint32_t num_files = (uint32_t) cp->num_files;
+	if(checkpoint_write(f, &num_files, sizeof(uint32_t)) != 0){return 1;}
+	for(int32_t k = 0 ; k < cp->num_files ; k++){
+		const uint32_t length = (uint32_t) strlen(cp->paths[k]);
+		if(checkpoint_write(f, &length, sizeof(uint32_t)) != 0 || checkpoint_write(f, cp->paths[k], length) != 0){return 1;}
+		if(checkpoint_write(f, &(cp->files[k].offset), sizeof(int64_t)) != 0 || checkpoint_write(f, &(cp->files[k].offset_tp), sizeof(int64_t)) != 0){return 1;}
+		if(checkpoint_write(f, &(cp->files[k].state), sizeof(uint8_t)) != 0 || checkpoint_write(f, &(cp->files[k].found_at_least_one_mwe), sizeof(int8_t)) != 0){return 1;}
+	}
+	return checkpoint_write(f, cp->output_sizes, CHECKPOINT_NUM_OUTPUTS * sizeof(int64_t));
+}
+
+static int32_t checkpoint_serialize_state(const struct checkpoint* const cp, FILE* const f){
+	const struct measurement_structure_references* const sref = cp->sref;
+	const struct measurement_mutables* const mmut = cp->mmut;
+
+	const uint64_t num_vectors = sref->w2v->num_vectors;
+	if(checkpoint_write(f, &num_vectors, sizeof(uint64_t)) != 0){return 1;}
+
+	// with a recompute thread, the zipfian fit of the last step lives in its own mutables
+	const struct measurement_mutables* const fit = sref->recompute != NULL ? &(sref->recompute->mmut) : mmut;
+	if(checkpoint_write(f, &(fit->best_s), sizeof(double)) != 0 || checkpoint_write(f, &(fit->prev_best_s), sizeof(double)) != 0 || checkpoint_write(f, &(fit->prev_num_nodes), sizeof(int64_t)) != 0){return 1;}
+	if(checkpoint_write(f, &(mmut->num_oov_types), sizeof(int64_t)) != 0){return 1;}
+	if(checkpoint_write(f, &(mmut->sentence), sizeof(struct measurement_mutable_counters)) != 0 || checkpoint_write(f, &(mmut->document), sizeof(struct measurement_mutable_counters)) != 0){return 1;}
+
+	const uint8_t has_schedule = sref->schedule != NULL;
+	if(checkpoint_write(f, &has_schedule, sizeof(uint8_t)) != 0){return 1;}
+	if(has_schedule){
+		struct recompute_schedule* const s = sref->schedule;
+		pthread_mutex_lock(&(s->mutex));
+		const int32_t failed = checkpoint_write(f, s->costs, sizeof(s->costs)) != 0 || checkpoint_write(f, &(s->sentence), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_write(f, &(s->document), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_write(f, &(s->compute_ns), sizeof(int64_t)) != 0;
+		pthread_mutex_unlock(&(s->mutex));
+		if(failed){return 1;}
+	}
+
+	// nodes in the order they were appended, each as the index of its vector and its count
+	const uint64_t num_nodes = graph_num_nodes(sref->g);
+	if(checkpoint_write(f, &num_nodes, sizeof(uint64_t)) != 0){return 1;}
+	for(uint64_t k = 0 ; k < num_nodes ; k++){
+		const struct graph_node* const node = graph_node_at(sref->g, k);
+		const uint64_t index = (uint64_t) (node->word2vec_entry_pointer - sref->w2v->keys);
+		const uint64_t count = __atomic_load_n(&(node->absolute_proportion), __ATOMIC_RELAXED);
+		if(checkpoint_write(f, &index, sizeof(uint64_t)) != 0 || checkpoint_write(f, &count, sizeof(uint64_t)) != 0){return 1;}
+	}
+
+	if(oov_counter_save(sref->oov_discarded_because_not_in_vector_database, f) != 0){
+		perror("failed to call oov_counter_save\n");
+		return 1;
+	}
+	return 0;
+}
+
+// called with cp->mutex locked and every reader parked at a unit boundary
+static int32_t checkpoint_capture(struct checkpoint* const cp, char** const bfr, size_t* const size){
+	const struct measurement_structure_references* const sref = cp->sref;
+	struct output_stream* const outputs[CHECKPOINT_NUM_OUTPUTS] = {cp->mcfg->io.output, cp->mcfg->io.output_timing, cp->mcfg->io.output_memory};
+
+	// the steps reached so far must be in the outputs, and nothing more
+	if(sref->recompute != NULL && recompute_worker_drain(sref->recompute) != 0){
+		perror("failed to call recompute_worker_drain\n");
+		return 1;
+	}
+	for(int32_t k = 0 ; k < CHECKPOINT_NUM_OUTPUTS ; k++){
+		cp->output_sizes[k] = -1;
+		if(outputs[k] != NULL && output_stream_sync(outputs[k], &(cp->output_sizes[k])) != 0){
+			perror("failed to call output_stream_sync\n");
+			return 1;
+		}
+	}
+
+	FILE* const f = open_memstream(bfr, size);
+	if(f == NULL){
+		perror("failed to call open_memstream\n");
+		return 1;
+	}
+	pthread_mutex_lock(&(cp->mmut->mutex));
+	pthread_mutex_lock(&(sref->g->mutex_nodes));
+	const int32_t failed = checkpoint_serialize_progress(cp, f) != 0 || checkpoint_serialize_state(cp, f) != 0;
+	pthread_mutex_unlock(&(sref->g->mutex_nodes));
+	pthread_mutex_unlock(&(cp->mmut->mutex));
+	if(fclose(f) != 0 || failed){
+		perror("failed to serialize checkpoint\n");
+		free(*bfr);
+		*bfr = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+// written next to the previous checkpoint and renamed over it, so that a kill at any time leaves a complete one behind
+static int32_t checkpoint_write_file(const struct checkpoint* const cp, const char* const payload, const size_t payload_size){
+	const uint32_t version = CHECKPOINT_VERSION;
+	const uint32_t byte_order_mark = CHECKPOINT_BYTE_ORDER_MARK;
+	const uint64_t size = (uint64_t) payload_size;
+	const uint64_t checksum = checkpoint_checksum(payload, payload_size);
+
+	FILE* const f = fopen(cp->tmp_path, "wb");
+	if(f == NULL){
+		fprintf(stderr, "Failed to open file: %s\n", cp->tmp_path);
+		return 1;
+	}
+	int32_t failed = checkpoint_write(f, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0 || checkpoint_write(f, &version, sizeof(uint32_t)) != 0 || checkpoint_write(f, &byte_order_mark, sizeof(uint32_t)) != 0 || checkpoint_write(f, &size, sizeof(uint64_t)) != 0;
+	failed = failed || checkpoint_write(f, payload, payload_size) != 0 || checkpoint_write(f, &checksum, sizeof(uint64_t)) != 0;
+	failed = failed || fflush(f) != 0 || fsync(fileno(f)) != 0;
+	if(fclose(f) != 0 || failed){
+		fprintf(stderr, "Failed to write file: %s\n", cp->tmp_path);
+		remove(cp->tmp_path);
+		return 1;
+	}
+	if(rename(cp->tmp_path, cp->path) != 0){
+		fprintf(stderr, "Failed to rename %s to %s\n", cp->tmp_path, cp->path);
+		remove(cp->tmp_path);
+		return 1;
+	}
+	return 0;
+}
+
+static void* checkpoint_thread(void* args){
+	struct checkpoint* const cp = (struct checkpoint*) args;
+	const int32_t log_bfr_size = 256;
+	char log_bfr[256];
+
+	pthread_mutex_lock(&(cp->mutex));
+	while(!(cp->stop)){
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		const int64_t deadline_ns = (int64_t) deadline.tv_nsec + cp->interval_ns;
+		deadline.tv_sec += (time_t) (deadline_ns / 1000000000);
+		deadline.tv_nsec = (long) (deadline_ns % 1000000000);
+		while(!(cp->stop) && pthread_cond_timedwait(&(cp->cond_parked), &(cp->mutex), &deadline) != ETIMEDOUT){}
+		if(cp->stop){break;}
+
+		cp->requested = 1;
+		while(!(cp->stop) && cp->num_parked < cp->num_active){
+			pthread_cond_wait(&(cp->cond_parked), &(cp->mutex));
+		}
+		char* bfr = NULL;
+		size_t size = 0;
+		const int32_t captured = !(cp->stop) && checkpoint_capture(cp, &bfr, &size) == 0;
+		const uint8_t stopped = cp->stop;
+		cp->requested = 0;
+		cp->generation++;
+		pthread_cond_broadcast(&(cp->cond_resume));
+		pthread_mutex_unlock(&(cp->mutex));
+
+		if(captured && checkpoint_write_file(cp, bfr, size) == 0){
+			__atomic_add_fetch(&(cp->num_written), 1, __ATOMIC_RELEASE);
+			snprintf(log_bfr, log_bfr_size, "checkpoint written: %s (%zu bytes)", cp->path, size);
+			info_format(__FILE__, __func__, __LINE__, log_bfr);
+		} else if(!stopped){
+			// the measurement goes on; the previous checkpoint, if any, is still there
+			warning_format(__FILE__, __func__, __LINE__, "failed to write checkpoint");
+			cp->status = 1;
+		}
+		free(bfr);
+		pthread_mutex_lock(&(cp->mutex));
+	}
+	pthread_mutex_unlock(&(cp->mutex));
+	return NULL;
+}
+
+// ---- resume ----
+
+// found is set to 0 when there is no checkpoint to resume from; a checkpoint that cannot be trusted, or that belongs to another input list, is an error
+int32_t checkpoint_open(struct checkpoint* const cp, uint8_t* const found){
+	char magic[CHECKPOINT_MAGIC_SIZE];
+	uint32_t version = 0;
+	uint32_t byte_order_mark = 0;
+	uint64_t size = 0;
+	uint64_t checksum = 0;
+	FILE* m = NULL;
+
+	*found = 0;
+	FILE* const f = fopen(cp->path, "rb");
+	if(f == NULL){
+		if(errno == ENOENT){return 0;}
+		fprintf(stderr, "Failed to open file: %s\n", cp->path);
+		return 1;
+	}
+	if(checkpoint_read(f, magic, CHECKPOINT_MAGIC_SIZE) != 0 || memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0){
+		fprintf(stderr, "Not a checkpoint: %s\n", cp->path);
+		goto failure_file;
+	}
+	if(checkpoint_read(f, &version, sizeof(uint32_t)) != 0 || version != CHECKPOINT_VERSION){
+		fprintf(stderr, "Unsupported checkpoint version %u (expected %u): %s\n", version, CHECKPOINT_VERSION, cp->path);
+		goto failure_file;
+	}
+	if(checkpoint_read(f, &byte_order_mark, sizeof(uint32_t)) != 0 || byte_order_mark != CHECKPOINT_BYTE_ORDER_MARK){
+		fprintf(stderr, "Checkpoint written on a machine with another byte order: %s\n", cp->path);
+		goto failure_file;
+	}
+	if(checkpoint_read(f, &size, sizeof(uint64_t)) != 0 || size == 0){goto failure_truncated;}
+	cp->loaded = (char*) malloc((size_t) size);
+	if(cp->loaded == NULL){
+		perror("malloc failed\n");
+		goto failure_file;
+	}
+	cp->loaded_size = (size_t) size;
+	if(checkpoint_read(f, cp->loaded, cp->loaded_size) != 0 || checkpoint_read(f, &checksum, sizeof(uint64_t)) != 0){goto failure_truncated;}
+	if(checksum != checkpoint_checksum(cp->loaded, cp->loaded_size)){
+		fprintf(stderr, "Checkpoint checksum mismatch: %s\n", cp->path);
+		goto failure_file;
+	}
+	fclose(f);
+
+	m = fmemopen(cp->loaded, cp->loaded_size, "rb");
+	if(m == NULL){
+		perror("failed to call fmemopen\n");
+		goto failure;
+	}
+	uint32_t num_files = 0;
+	if(checkpoint_read(m, &num_files, sizeof(uint32_t)) != 0 || num_files != (uint32_t) cp->num_files){
+		fprintf(stderr, "Checkpoint was taken on %u input files, not %i: %s\n", num_files, cp->num_files, cp->path);
+		goto failure;
+	}
+	for(int32_t k = 0 ; k < cp->num_files ; k++){
+		uint32_t length = 0;
+		if(checkpoint_read(m, &length, sizeof(uint32_t)) != 0 || length != (uint32_t) strlen(cp->paths[k])){goto failure_input;}
+		char* const path = (char*) malloc(length + 1);
+		if(path == NULL){
+			perror("malloc failed\n");
+			goto failure;
+		}
+		const int32_t same = checkpoint_read(m, path, length) == 0 && memcmp(path, cp->paths[k], length) == 0;
+		free(path);
+		if(!same){goto failure_input;}
+		struct checkpoint_file* const file = &(cp->files[k]);
+		if(checkpoint_read(m, &(file->offset), sizeof(int64_t)) != 0 || checkpoint_read(m, &(file->offset_tp), sizeof(int64_t)) != 0){goto failure;}
+		if(checkpoint_read(m, &(file->state), sizeof(uint8_t)) != 0 || checkpoint_read(m, &(file->found_at_least_one_mwe), sizeof(int8_t)) != 0 || file->state > CHECKPOINT_FILE_DONE){goto failure;}
+	}
+	if(checkpoint_read(m, cp->output_sizes, CHECKPOINT_NUM_OUTPUTS * sizeof(int64_t)) != 0){goto failure;}
+	cp->loaded_position = (size_t) ftell(m);
+	fclose(m);
+
+	*found = 1;
+	return 0;
+
+	failure_input:
+	fprintf(stderr, "Checkpoint was taken on other input files: %s\n", cp->path);
+	goto failure;
+	failure_truncated:
+	fprintf(stderr, "Truncated checkpoint: %s\n", cp->path);
+	failure_file:
+	fclose(f);
+	failure:
+	if(m != NULL){fclose(m);}
+	free(cp->loaded);
+	cp->loaded = NULL;
+	cp->loaded_size = 0;
+	memset(cp->files, '\0', cp->num_files * sizeof(struct checkpoint_file));
+	return 1;
+}
+
+// called once checkpoint_open found a checkpoint, on an empty graph and OOV counter, before any reader or recompute thread is started
+int32_t checkpoint_restore(struct checkpoint* const cp, const struct measurement_structure_references* const sref, struct measurement_mutables* const mmut){
+	if(cp->loaded == NULL){return 1;}
+	FILE* const m = fmemopen(cp->loaded + cp->loaded_position, cp->loaded_size - cp->loaded_position, "rb");
+	if(m == NULL){
+		perror("failed to call fmemopen\n");
+		return 1;
+	}
+
+	uint64_t num_vectors = 0;
+	if(checkpoint_read(m, &num_vectors, sizeof(uint64_t)) != 0 || num_vectors != sref->w2v->num_vectors){
+		fprintf(stderr, "Checkpoint was taken with another vector database (%lu vectors, not %lu): %s\n", num_vectors, sref->w2v->num_vectors, cp->path);
+		goto failure;
+	}
+
+	if(checkpoint_read(m, &(mmut->best_s), sizeof(double)) != 0 || checkpoint_read(m, &(mmut->prev_best_s), sizeof(double)) != 0 || checkpoint_read(m, &(mmut->prev_num_nodes), sizeof(int64_t)) != 0){goto failure_read;}
+	if(checkpoint_read(m, &(mmut->num_oov_types), sizeof(int64_t)) != 0){goto failure_read;}
+	if(checkpoint_read(m, &(mmut->sentence), sizeof(struct measurement_mutable_counters)) != 0 || checkpoint_read(m, &(mmut->document), sizeof(struct measurement_mutable_counters)) != 0){goto failure_read;}
+	mmut->mst_initialised = 0; // nothing was allocated yet in this process
+
+	uint8_t has_schedule = 0;
+	if(checkpoint_read(m, &has_schedule, sizeof(uint8_t)) != 0){goto failure_read;}
+	if(has_schedule != (sref->schedule != NULL)){
+		fprintf(stderr, "Checkpoint was taken with %s: %s\n", has_schedule ? "adaptive steps" : "no adaptive steps", cp->path);
+		goto failure;
+	}
+	if(has_schedule){
+		struct recompute_schedule* const s = sref->schedule;
+		if(checkpoint_read(m, s->costs, sizeof(s->costs)) != 0 || checkpoint_read(m, &(s->sentence), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_read(m, &(s->document), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_read(m, &(s->compute_ns), sizeof(int64_t)) != 0){goto failure_read;}
+		// the time spent between the capture and the resume is not ingestion time
+		const int64_t now_ns = recompute_schedule_now();
+		if(s->sentence.last_ns != 0){s->sentence.last_ns = now_ns;}
+		if(s->document.last_ns != 0){s->document.last_ns = now_ns;}
+	}
+
+	uint64_t num_nodes = 0;
+	if(checkpoint_read(m, &num_nodes, sizeof(uint64_t)) != 0){goto failure_read;}
+	for(uint64_t k = 0 ; k < num_nodes ; k++){
+		uint64_t index = 0;
+		uint64_t count = 0;
+		if(checkpoint_read(m, &index, sizeof(uint64_t)) != 0 || checkpoint_read(m, &count, sizeof(uint64_t)) != 0){goto failure_read;}
+		if(index >= num_vectors || count == 0 || graph_word2vec_node(sref->g, sref->w2v, &(sref->w2v->keys[index])) != NULL){goto failure_read;}
+		if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+			perror("failed to call graph_add_word2vec_occurrence\n");
+			goto failure;
+		}
+		graph_node_at(sref->g, k)->absolute_proportion = count;
+	}
+
+	if(oov_counter_load(sref->oov_discarded_because_not_in_vector_database, m) != 0){
+		perror("failed to call oov_counter_load\n");
+		goto failure;
+	}
+	fclose(m);
+
+	free(cp->loaded);
+	cp->loaded = NULL;
+	cp->loaded_size = 0;
+	return 0;
+
+	failure_read:
+	fprintf(stderr, "Corrupt checkpoint: %s\n", cp->path);
+	failure:
+	fclose(m);
+	return 1;
+}
+
+// ---- readers ----
+
+int32_t checkpoint_start(struct checkpoint* const cp, struct measurement_configuration* const mcfg, const struct measurement_structure_references* const sref, struct measurement_mutables* const mmut){
+	cp->mcfg = mcfg;
+	cp->sref = sref;
+	cp->mmut = mmut;
+	if(pthread_create(&(cp->thread), NULL, checkpoint_thread, cp) != 0){
+		perror("failed to call pthread_create\n");
+		return 1;
+	}
+	cp->started = 1;
+	return 0;
+}
+
+uint8_t checkpoint_file_is_done(struct checkpoint* const cp, const int32_t i){
+	pthread_mutex_lock(&(cp->mutex));
+	const uint8_t done = cp->files[i].state == CHECKPOINT_FILE_DONE;
+	pthread_mutex_unlock(&(cp->mutex));
+	return done;
+}
+
+// a file is not started while a capture is pending, since its reader would not be waited for
+void checkpoint_file_begin(struct checkpoint* const cp, const int32_t i){
+	pthread_mutex_lock(&(cp->mutex));
+	while(cp->requested){pthread_cond_wait(&(cp->cond_resume), &(cp->mutex));}
+	cp->num_active++;
+	cp->files[i].state = CHECKPOINT_FILE_STARTED;
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+void checkpoint_file_resume_point(struct checkpoint* const cp, const int32_t i, int64_t* const offset, int64_t* const offset_tp, int8_t* const found_at_least_one_mwe){
+	pthread_mutex_lock(&(cp->mutex));
+	*offset = cp->files[i].offset;
+	*offset_tp = cp->files[i].offset_tp;
+	if(found_at_least_one_mwe != NULL){*found_at_least_one_mwe = cp->files[i].found_at_least_one_mwe;}
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+// called by a reader between two units, holding no lock; parks it while a capture is pending
+void checkpoint_unit_done(struct checkpoint* const cp, const int32_t i, const int64_t offset, const int64_t offset_tp, const int8_t found_at_least_one_mwe){
+	pthread_mutex_lock(&(cp->mutex));
+	if(offset >= 0){cp->files[i].offset = offset;}
+	if(offset_tp >= 0){cp->files[i].offset_tp = offset_tp;}
+	cp->files[i].found_at_least_one_mwe = found_at_least_one_mwe;
+	if(cp->requested){
+		const uint64_t generation = cp->generation;
+		cp->num_parked++;
+		pthread_cond_signal(&(cp->cond_parked));
+		while(cp->generation == generation){pthread_cond_wait(&(cp->cond_resume), &(cp->mutex));}
+		cp->num_parked--;
+	}
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+// a file that failed stays started, so that a resume reads it again from its last unit
+void checkpoint_file_end(struct checkpoint* const cp, const int32_t i, const int32_t status){
+	pthread_mutex_lock(&(cp->mutex));
+	cp->num_active--;
+	if(status == 0){cp->files[i].state = CHECKPOINT_FILE_DONE;}
+	pthread_cond_signal(&(cp->cond_parked));
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+uint64_t checkpoint_num_written(struct checkpoint* const cp){
+	return __atomic_load_n(&(cp->num_written), __ATOMIC_ACQUIRE);
+}
+
+// stops the checkpoint thread without a last capture; returns 1 if some checkpoint could not be written
+int32_t checkpoint_stop(struct checkpoint* const cp){
+	if(!(cp->started)){return 0;}
+	pthread_mutex_lock(&(cp->mutex));
+	cp->stop = 1;
+	pthread_cond_broadcast(&(cp->cond_parked));
+	pthread_mutex_unlock(&(cp->mutex));
+	if(pthread_join(cp->thread, NULL) != 0){
+		perror("failed to call pthread_join\n");
+		return 1;
+	}
+	cp->started = 0;
+	return cp->status;
+}
+
+// once the measurement is complete, there is nothing left to resume
+int32_t checkpoint_remove(const struct checkpoint* const cp){
+	if(remove(cp->path) != 0 && errno != ENOENT){
+		fprintf(stderr, "Failed to remove file: %s\n", cp->path);
+		return 1;
+	}
+	return 0;
+}
+
+void free_checkpoint(struct checkpoint* const cp){
+	checkpoint_stop(cp);
+	pthread_mutex_destroy(&(cp->mutex));
+	pthread_cond_destroy(&(cp->cond_parked));
+	pthread_cond_destroy(&(cp->cond_resume));
+	free(cp->path);
+	free(cp->tmp_path);
+	free(cp->files);
+	free(cp->loaded);
+	memset(cp, '\0', sizeof(struct checkpoint));
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shard.h"
+
+// ---- file format ----
+
+// every byte goes through the running checksum, which is written after the last entry
+struct shard_stream {
+	FILE * f;
+	uint64_t checksum;
+};
+
+static void shard_checksum(struct shard_stream * const s, const void * const p, const size_t size){
+	for(size_t k = 0 ; k < size ; k++){
+		s->checksum ^= (uint64_t) ((const uint8_t *) p)[k]; // FNV-1a
+		s->checksum *= 0x100000001b3ULL;
+	}
+}
+
+static int32_t shard_put(struct shard_stream * const s, const void * const p, const size_t size){
+	shard_checksum(s, p, size);
+	return fwrite(p, 1, size, s->f) != size;
+}
+
+static int32_t shard_get(struct shard_stream * const s, void * const p, const size_t size){
+	if(fread(p, 1, size, s->f) != size){return 1;}
+	shard_checksum(s, p, size);
+	return 0;
+}
+
+static int32_t shard_entry_cmp(const void * const a, const void * const b){
+	return strcmp(((const struct shard_entry *) a)->key, ((const struct shard_entry *) b)->key);
+}
+
+int32_t create_shard(struct shard * const s, const uint64_t num_entries, const uint64_t num_oov_entries, const size_t key_blob_size){
+	memset(s, '\0', sizeof(struct shard));
+	s->entries = calloc(num_entries > 0 ? num_entries : 1, sizeof(struct shard_entry));
+	s->oov_entries = calloc(num_oov_entries > 0 ? num_oov_entries : 1, sizeof(struct shard_entry));
+	s->key_blob = malloc(key_blob_size > 0 ? key_blob_size : 1);
+	if(s->entries == NULL || s->oov_entries == NULL || s->key_blob == NULL){
+		perror("malloc failed\n");
+		free_shard(s);
+		return 1;
+	}
+	s->num_entries = num_entries;
+	s->num_oov_entries = num_oov_entries;
+	s->key_blob_size = key_blob_size;
+	s->oov_exact = 1;
+	return 0;
+}
+
+// entries are filled in any order; shard_write and shard_merge expect them sorted, with no key twice
+int32_t shard_sort(struct shard * const s){
+	qsort(s->entries, s->num_entries, sizeof(struct shard_entry), shard_entry_cmp);
+	qsort(s->oov_entries, s->num_oov_entries, sizeof(struct shard_entry), shard_entry_cmp);
+	for(uint64_t k = 1 ; k < s->num_entries ; k++){
+		if(strcmp(s->entries[k - 1].key, s->entries[k].key) == 0){goto duplicate_key;}
+	}
+	for(uint64_t k = 1 ; k < s->num_oov_entries ; k++){
+		if(strcmp(s->oov_entries[k - 1].key, s->oov_entries[k].key) == 0){goto duplicate_key;}
+	}
+	return 0;
+
+	duplicate_key:
+	perror("shard has a key twice\n");
+	return 1;
+}
+
+static int32_t shard_write_entries(struct shard_stream * const w, const struct shard_entry * const entries, const uint64_t num_entries, const uint8_t with_rank){
+	for(uint64_t k = 0 ; k < num_entries ; k++){
+		const size_t length = strlen(entries[k].key);
+		if(length > SHARD_KEY_MAX_SIZE){
+			fprintf(stderr, "shard key too long (%zu bytes)\n", length);
+			return 1;
+		}
+		const uint16_t length_u16 = (uint16_t) length;
+		if(shard_put(w, &length_u16, sizeof(uint16_t)) != 0 || shard_put(w, entries[k].key, length) != 0 || shard_put(w, &(entries[k].count), sizeof(uint64_t)) != 0){return 1;}
+		if(with_rank && shard_put(w, &(entries[k].first_seen), sizeof(uint64_t)) != 0){return 1;}
+	}
+	return 0;
+}
+
+int32_t shard_write(const struct shard * const s, const char * const path){
+	const uint32_t version = SHARD_VERSION;
+	const uint32_t byte_order_mark = SHARD_BYTE_ORDER_MARK;
+	const uint64_t key_blob_size = (uint64_t) s->key_blob_size;
+	const uint64_t totals[7] = {s->num_files, s->num_documents, s->num_sentences, s->num_sentences_containing_mwe, s->num_sentences_containing_mwe_tp_only, s->num_tokens, s->num_oov_tokens};
+	const uint64_t sizes[3] = {s->num_entries, s->num_oov_entries, key_blob_size};
+
+	struct shard_stream w = {.f = fopen(path, "wb"), .checksum = 0xcbf29ce484222325ULL};
+	if(w.f == NULL){
+		fprintf(stderr, "failed to open %s for write\n", path);
+		return 1;
+	}
+	int32_t failed = shard_put(&w, SHARD_MAGIC, SHARD_MAGIC_SIZE) != 0 || shard_put(&w, &version, sizeof(uint32_t)) != 0 || shard_put(&w, &byte_order_mark, sizeof(uint32_t)) != 0;
+	failed = failed || shard_put(&w, &(s->oov_exact), sizeof(uint8_t)) != 0 || shard_put(&w, totals, sizeof(totals)) != 0 || shard_put(&w, &(s->num_oov_types), sizeof(int64_t)) != 0 || shard_put(&w, sizes, sizeof(sizes)) != 0;
+	failed = failed || shard_write_entries(&w, s->entries, s->num_entries, 1) != 0 || shard_write_entries(&w, s->oov_entries, s->num_oov_entries, 0) != 0;
+	const uint64_t checksum = w.checksum;
+	failed = failed || fwrite(&checksum, sizeof(uint64_t), 1, w.f) != 1;
+	if(fclose(w.f) != 0){failed = 1;}
+	if(failed){
+		fprintf(stderr, "failed to write shard: %s\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+// keys are appended to the blob at *blob_position; entries must come in strictly increasing key order
+static int32_t shard_read_entries(struct shard_stream * const r, struct shard * const s, struct shard_entry * const entries, const uint64_t num_entries, const uint8_t with_rank, size_t * const blob_position, uint64_t * const total){
+	*total = 0;
+	for(uint64_t k = 0 ; k < num_entries ; k++){
+		uint16_t length = 0;
+		if(shard_get(r, &length, sizeof(uint16_t)) != 0 || *blob_position + length + 1 > s->key_blob_size){return 1;}
+		char * const key = s->key_blob + *blob_position;
+		if(shard_get(r, key, length) != 0 || memchr(key, '\0', length) != NULL){return 1;}
+		key[length] = '\0';
+		*blob_position += length + 1;
+		entries[k].key = key;
+		if(shard_get(r, &(entries[k].count), sizeof(uint64_t)) != 0 || entries[k].count == 0){return 1;}
+		if(with_rank && shard_get(r, &(entries[k].first_seen), sizeof(uint64_t)) != 0){return 1;}
+		if(k > 0 && strcmp(entries[k - 1].key, key) >= 0){return 1;}
+		*total += entries[k].count;
+	}
+	return 0;
+}
+
+int32_t shard_read(struct shard * const s, const char * const path){
+	char magic[SHARD_MAGIC_SIZE];
+	uint32_t version = 0;
+	uint32_t byte_order_mark = 0;
+	uint8_t oov_exact = 0;
+	uint64_t totals[7];
+	int64_t num_oov_types = 0;
+	uint64_t sizes[3];
+	uint64_t checksum = 0;
+	uint64_t num_tokens = 0;
+	uint64_t num_oov_tokens = 0;
+	size_t blob_position = 0;
+
+	memset(s, '\0', sizeof(struct shard));
+	struct shard_stream r = {.f = fopen(path, "rb"), .checksum = 0xcbf29ce484222325ULL};
+	if(r.f == NULL){
+		fprintf(stderr, "failed to open %s for read\n", path);
+		return 1;
+	}
+	if(shard_get(&r, magic, SHARD_MAGIC_SIZE) != 0 || memcmp(magic, SHARD_MAGIC, SHARD_MAGIC_SIZE) != 0){
+		fprintf(stderr, "Not a shard: %s\n", path);
+		goto failure;
+	}
+	if(shard_get(&r, &version, sizeof(uint32_t)) != 0 || version != SHARD_VERSION){
+		fprintf(stderr, "Unsupported shard version %u (expected %u): %s\n", version, SHARD_VERSION, path);
+		goto failure;
+	}
+	if(shard_get(&r, &byte_order_mark, sizeof(uint32_t)) != 0 || byte_order_mark != SHARD_BYTE_ORDER_MARK){
+		fprintf(stderr, "Shard was written with another byte order: %s\n", path);
+		goto failure;
+	}
+	if(shard_get(&r, &oov_exact, sizeof(uint8_t)) != 0 || shard_get(&r, totals, sizeof(totals)) != 0 || shard_get(&r, &num_oov_types, sizeof(int64_t)) != 0 || shard_get(&r, sizes, sizeof(sizes)) != 0){goto failure_corrupt;}
+
+	if(create_shard(s, sizes[0], sizes[1], (size_t) sizes[2]) != 0){
+		perror("failed to call create_shard\n");
+		goto failure;
+	}
+	s->oov_exact = oov_exact;
+	s->num_files = totals[0];
+	s->num_documents = totals[1];
+	s->num_sentences = totals[2];
+	s->num_sentences_containing_mwe = totals[3];
+	s->num_sentences_containing_mwe_tp_only = totals[4];
+	s->num_tokens = totals[5];
+	s->num_oov_tokens = totals[6];
+	s->num_oov_types = num_oov_types;
+
+	if(shard_read_entries(&r, s, s->entries, s->num_entries, 1, &blob_position, &num_tokens) != 0 || shard_read_entries(&r, s, s->oov_entries, s->num_oov_entries, 0, &blob_position, &num_oov_tokens) != 0){goto failure_corrupt;}
+	const uint64_t expected_checksum = r.checksum;
+	if(fread(&checksum, sizeof(uint64_t), 1, r.f) != 1 || checksum != expected_checksum || fgetc(r.f) != EOF){goto failure_corrupt;}
+	if(num_tokens != s->num_tokens || num_oov_tokens != s->num_oov_tokens || blob_position != s->key_blob_size){goto failure_corrupt;}
+
+	fclose(r.f);
+	return 0;
+
+	failure_corrupt:
+	fprintf(stderr, "Corrupt shard: %s\n", path);
+	failure:
+	fclose(r.f);
+	free_shard(s);
+	return 1;
+}
+
+// ---- merge ----
+
+/*
+ * The keys are split into as many ranges as there are threads, at keys sampled from the largest input;
+ * each thread merges its range of every input with a min-heap of cursors, and the ranges are concatenated.
+ */
+struct shard_merge_range {
+	const struct shard * inputs;
+	int32_t num_inputs;
+	uint8_t oov; // merges oov_entries instead of entries
+	const uint64_t * begin; // per input
+	const uint64_t * end;
+	const uint64_t * rank_offsets; // per input, added to first_seen so that earlier inputs come first
+	struct shard_entry * out; // keys still point into the inputs
+	uint64_t num_out;
+	size_t key_bytes;
+	int32_t status;
+};
+
+static const struct shard_entry * shard_merge_list(const struct shard * const s, const uint8_t oov){
+	return oov ? s->oov_entries : s->entries;
+}
+
+static uint64_t shard_merge_list_size(const struct shard * const s, const uint8_t oov){
+	return oov ? s->num_oov_entries : s->num_entries;
+}
+
+// first entry whose key is not less than key
+static uint64_t shard_merge_lower_bound(const struct shard_entry * const entries, const uint64_t num_entries, const char * const key){
+	uint64_t lo = 0;
+	uint64_t hi = num_entries;
+	while(lo < hi){
+		const uint64_t mid = lo + (hi - lo) / 2;
+		if(strcmp(entries[mid].key, key) < 0){lo = mid + 1;} else {hi = mid;}
+	}
+	return lo;
+}
+
+static void shard_merge_sift_down(int32_t * const heap, const int32_t size, const struct shard_entry * const * const cursors, int32_t k){
+	while(1){
+		const int32_t left = 2 * k + 1;
+		const int32_t right = left + 1;
+		int32_t smallest = k;
+		if(left < size && strcmp(cursors[heap[left]]->key, cursors[heap[smallest]]->key) < 0){smallest = left;}
+		if(right < size && strcmp(cursors[heap[right]]->key, cursors[heap[smallest]]->key) < 0){smallest = right;}
+		if(smallest == k){return;}
+		const int32_t tmp = heap[k];
+		heap[k] = heap[smallest];
+		heap[smallest] = tmp;
+		k = smallest;
+	}
+}
+
+static void* shard_merge_thread(void* args){
+	struct shard_merge_range * const range = (struct shard_merge_range *) args;
+	const int32_t n = range->num_inputs;
+	uint64_t capacity = 0;
+	for(int32_t k = 0 ; k < n ; k++){capacity += range->end[k] - range->begin[k];}
+
+	const struct shard_entry ** const cursors = malloc(n * sizeof(struct shard_entry *));
+	const struct shard_entry ** const ends = malloc(n * sizeof(struct shard_entry *));
+	int32_t * const heap = malloc(n * sizeof(int32_t));
+	range->out = malloc((capacity > 0 ? capacity : 1) * sizeof(struct shard_entry));
+	if(cursors == NULL || ends == NULL || heap == NULL || range->out == NULL){
+		perror("malloc failed\n");
+		range->status = 1;
+		goto free_memory;
+	}
+
+	int32_t heap_size = 0;
+	for(int32_t k = 0 ; k < n ; k++){
+		const struct shard_entry * const list = shard_merge_list(&(range->inputs[k]), range->oov);
+		cursors[k] = list + range->begin[k];
+		ends[k] = list + range->end[k];
+		if(cursors[k] != ends[k]){heap[heap_size++] = k;}
+	}
+	for(int32_t k = heap_size / 2 - 1 ; k >= 0 ; k--){shard_merge_sift_down(heap, heap_size, cursors, k);}
+
+	while(heap_size > 0){
+		const int32_t first = heap[0];
+		struct shard_entry * const out = &(range->out[range->num_out]);
+		out->key = cursors[first]->key;
+		out->count = 0;
+		out->first_seen = UINT64_MAX;
+		// every input positioned on the same key is at the top of the heap in turn
+		while(heap_size > 0 && strcmp(cursors[heap[0]]->key, out->key) == 0){
+			const int32_t k = heap[0];
+			out->count += cursors[k]->count;
+			const uint64_t rank = range->oov ? 0 : range->rank_offsets[k] + cursors[k]->first_seen;
+			if(rank < out->first_seen){out->first_seen = rank;}
+			cursors[k]++;
+			if(cursors[k] == ends[k]){heap[0] = heap[--heap_size];}
+			shard_merge_sift_down(heap, heap_size, cursors, 0);
+		}
+		range->key_bytes += strlen(out->key) + 1;
+		range->num_out++;
+	}
+
+	free_memory:
+	free(cursors);
+	free(ends);
+	free(heap);
+	return NULL;
+}
+
+// merges entries (or oov_entries) of the inputs into ranges[0 .. *num_ranges - 1]
+static int32_t shard_merge_lists(const struct shard * const inputs, const int32_t num_inputs, const uint8_t oov, const uint64_t * const rank_offsets, const int32_t num_threads, struct shard_merge_range * const ranges, int32_t * const num_ranges){
+	int32_t largest = 0;
+	for(int32_t k = 1 ; k < num_inputs ; k++){
+		if(shard_merge_list_size(&(inputs[k]), oov) > shard_merge_list_size(&(inputs[largest]), oov)){largest = k;}
+	}
+	const struct shard_entry * const samples = shard_merge_list(&(inputs[largest]), oov);
+	const uint64_t num_samples = shard_merge_list_size(&(inputs[largest]), oov);
+	const int32_t num_splits = num_samples < (uint64_t) num_threads ? (num_samples > 0 ? (int32_t) num_samples : 1) : num_threads;
+
+	// bounds[t * num_inputs + k] is where range t starts in input k
+	uint64_t * const bounds = malloc((num_splits + 1) * num_inputs * sizeof(uint64_t));
+	pthread_t * const threads = malloc(num_splits * sizeof(pthread_t));
+	if(bounds == NULL || threads == NULL){
+		perror("malloc failed\n");
+		free(bounds);
+		free(threads);
+		return 1;
+	}
+	for(int32_t k = 0 ; k < num_inputs ; k++){
+		const struct shard_entry * const list = shard_merge_list(&(inputs[k]), oov);
+		const uint64_t size = shard_merge_list_size(&(inputs[k]), oov);
+		bounds[k] = 0;
+		for(int32_t t = 1 ; t < num_splits ; t++){
+			bounds[t * num_inputs + k] = shard_merge_lower_bound(list, size, samples[(uint64_t) t * num_samples / num_splits].key);
+		}
+		bounds[num_splits * num_inputs + k] = size;
+	}
+
+	int32_t result = 0;
+	int32_t num_created = 0;
+	for(int32_t t = 0 ; t < num_splits ; t++){
+		ranges[t] = (struct shard_merge_range) {
+			.inputs = inputs,
+			.num_inputs = num_inputs,
+			.oov = oov,
+			.begin = &(bounds[t * num_inputs]),
+			.end = &(bounds[(t + 1) * num_inputs]),
+			.rank_offsets = rank_offsets,
+		};
+	}
+	for(int32_t t = 0 ; t < num_splits ; t++){
+		if(pthread_create(&(threads[t]), NULL, shard_merge_thread, &(ranges[t])) != 0){
+			perror("failed to call pthread_create\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int32_t t = 0 ; t < num_created ; t++){
+		pthread_join(threads[t], NULL);
+		if(ranges[t].status != 0){result = 1;}
+	}
+	*num_ranges = num_created;
+
+	free(bounds);
+	free(threads);
+	return result;
+}
+
+// copies the merged ranges into entries, with their keys in the blob of result
+static void shard_merge_collect(struct shard * const result, const struct shard_merge_range * const ranges, const int32_t num_ranges, struct shard_entry * const entries, size_t * const blob_position){
+	uint64_t j = 0;
+	for(int32_t t = 0 ; t < num_ranges ; t++){
+		for(uint64_t k = 0 ; k < ranges[t].num_out ; k++){
+			const size_t length = strlen(ranges[t].out[k].key) + 1;
+			char * const key = result->key_blob + *blob_position;
+			memcpy(key, ranges[t].out[k].key, length);
+			*blob_position += length;
+			entries[j] = ranges[t].out[k];
+			entries[j].key = key;
+			j++;
+		}
+	}
+}
+
+// result holds the sum of the inputs; the inputs must be sorted (as shard_read and shard_sort leave them)
+int32_t shard_merge(struct shard * const result, const struct shard * const inputs, const int32_t num_inputs, const int32_t num_threads){
+	memset(result, '\0', sizeof(struct shard));
+	if(num_inputs <= 0){
+		perror("no shard to merge\n");
+		return 1;
+	}
+	const int32_t num_ranges_max = num_threads > 0 ? num_threads : 1;
+	uint64_t * const rank_offsets = malloc(num_inputs * sizeof(uint64_t));
+	struct shard_merge_range * const ranges = calloc(num_ranges_max, sizeof(struct shard_merge_range));
+	struct shard_merge_range * const oov_ranges = calloc(num_ranges_max, sizeof(struct shard_merge_range));
+	int32_t num_ranges = 0;
+	int32_t num_oov_ranges = 0;
+	int32_t status = 0;
+	if(rank_offsets == NULL || ranges == NULL || oov_ranges == NULL){
+		perror("malloc failed\n");
+		status = 1;
+		goto free_memory;
+	}
+
+	// the types of an input rank after every type of the inputs before it, as if their files had been read first
+	uint64_t rank_offset = 0;
+	for(int32_t k = 0 ; k < num_inputs ; k++){
+		rank_offsets[k] = rank_offset;
+		uint64_t max_rank = 0;
+		for(uint64_t j = 0 ; j < inputs[k].num_entries ; j++){
+			if(inputs[k].entries[j].first_seen > max_rank){max_rank = inputs[k].entries[j].first_seen;}
+		}
+		if(inputs[k].num_entries > 0){rank_offset += max_rank + 1;}
+	}
+
+	if(shard_merge_lists(inputs, num_inputs, 0, rank_offsets, num_ranges_max, ranges, &num_ranges) != 0 || shard_merge_lists(inputs, num_inputs, 1, rank_offsets, num_ranges_max, oov_ranges, &num_oov_ranges) != 0){
+		perror("failed to call shard_merge_lists\n");
+		status = 1;
+		goto free_memory;
+	}
+
+	uint64_t num_entries = 0;
+	uint64_t num_oov_entries = 0;
+	size_t key_blob_size = 0;
+	for(int32_t t = 0 ; t < num_ranges ; t++){num_entries += ranges[t].num_out; key_blob_size += ranges[t].key_bytes;}
+	for(int32_t t = 0 ; t < num_oov_ranges ; t++){num_oov_entries += oov_ranges[t].num_out; key_blob_size += oov_ranges[t].key_bytes;}
+	if(create_shard(result, num_entries, num_oov_entries, key_blob_size) != 0){
+		perror("failed to call create_shard\n");
+		status = 1;
+		goto free_memory;
+	}
+	size_t blob_position = 0;
+	shard_merge_collect(result, ranges, num_ranges, result->entries, &blob_position);
+	shard_merge_collect(result, oov_ranges, num_oov_ranges, result->oov_entries, &blob_position);
+
+	// a type counted by several inputs is counted once; with approximate inputs, the largest lower bound is kept
+	result->num_oov_types = (int64_t) num_oov_entries;
+	for(int32_t k = 0 ; k < num_inputs ; k++){
+		result->num_files += inputs[k].num_files;
+		result->num_documents += inputs[k].num_documents;
+		result->num_sentences += inputs[k].num_sentences;
+		result->num_sentences_containing_mwe += inputs[k].num_sentences_containing_mwe;
+		result->num_sentences_containing_mwe_tp_only += inputs[k].num_sentences_containing_mwe_tp_only;
+		result->num_tokens += inputs[k].num_tokens;
+		result->num_oov_tokens += inputs[k].num_oov_tokens;
+		if(!inputs[k].oov_exact){
+			result->oov_exact = 0;
+			if(inputs[k].num_oov_types > result->num_oov_types){result->num_oov_types = inputs[k].num_oov_types;}
+		}
+	}
+
+	free_memory:
+	if(ranges != NULL){for(int32_t t = 0 ; t < num_ranges_max ; t++){free(ranges[t].out);}}
+	if(oov_ranges != NULL){for(int32_t t = 0 ; t < num_ranges_max ; t++){free(oov_ranges[t].out);}}
+	free(ranges);
+	free(oov_ranges);
+	free(rank_offsets);
+	return status;
+}
+
+void free_shard(struct shard * const s){
+	free(s->entries);
+	free(s->oov_entries);
+	free(s->key_blob);
+	memset(s, '\0', sizeof(struct shard));
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "measurement.h"
+#include "recompute.h"
+#include "snapshot.h"
+
+static int32_t recompute_worker_run(struct recompute_worker* const w, const struct recompute_job* const job){
+	// nodes below job->num_nodes are never moved nor given another vector, so only the counts had to be captured
+	memcpy(w->view.chunks, job->chunks, GRAPH_NUM_CHUNKS * sizeof(struct graph_node*));
+	w->view.num_nodes = job->num_nodes;
+	if(graph_snapshot_refresh_from_counts(&(w->view), job->counts, 0, w->mcfg->threading.num_matrix_threads) != 0){
+		perror("failed to call graph_snapshot_refresh_from_counts\n");
+		return 1;
+	}
+
+	w->mmut.num_oov_types = job->num_oov_types;
+	w->mmut.sentence = job->sentence;
+	w->mmut.document = job->document;
+	if(measurement_recompute_step(job->i, w->mcfg, &(w->sref), &(w->mmut), job->force) != 0){
+		perror("failed to call measurement_recompute_step\n");
+		return 1;
+	}
+	return 0;
+}
+
+static void* recompute_worker_thread(void* args){
+	struct recompute_worker* const w = (struct recompute_worker*) args;
+
+	while(1){
+		pthread_mutex_lock(&(w->mutex));
+		while(w->num_jobs == 0 && !(w->stop)){
+			pthread_cond_wait(&(w->cond_not_empty), &(w->mutex));
+		}
+		if(w->num_jobs == 0){
+			pthread_mutex_unlock(&(w->mutex));
+			break;
+		}
+		const struct recompute_job job = w->jobs[w->head];
+		w->head = (w->head + 1) % w->capacity;
+		w->num_jobs--;
+		w->busy = 1;
+		const int32_t status = w->status;
+		pthread_cond_signal(&(w->cond_not_full));
+		pthread_mutex_unlock(&(w->mutex));
+
+		// after a failure, the remaining steps are dropped so that the readers are never left waiting
+		const int32_t failed = status == 0 && recompute_worker_run(w, &job) != 0;
+		free(job.counts);
+
+		pthread_mutex_lock(&(w->mutex));
+		if(failed){w->status = 1;}
+		w->busy = 0;
+		pthread_cond_broadcast(&(w->cond_not_full)); // recompute_worker_drain waits for the worker to be idle
+		pthread_mutex_unlock(&(w->mutex));
+	}
+
+	return NULL;
+}
+
+// the worker takes over sref->mst and sref->heap, and starts from the zipfian fit and node count found in mmut
+int32_t create_recompute_worker(struct recompute_worker* const w, struct measurement_configuration* const mcfg, const struct measurement_structure_references* const sref, const struct measurement_mutables* const mmut, const uint32_t capacity){
+	memset(w, '\0', sizeof(struct recompute_worker));
+	w->mcfg = mcfg;
+	w->capacity = capacity < 1 ? 1 : capacity;
+	w->view.dist_mat = (struct matrix) { .fp_mode = FP32, };
+
+	const struct measurement_structure_references local_sref = {
+		.g = &(w->view),
+		.mst = sref->mst,
+		.heap = sref->heap,
+		.w2v = sref->w2v,
+		.oov_discarded_because_not_in_vector_database = NULL,
+		.recompute = NULL,
+		.schedule = sref->schedule,
+		.checkpoint = NULL,
+		.step_hook = sref->step_hook,
+	};
+	memcpy(&(w->sref), &local_sref, sizeof(struct measurement_structure_references));
+
+	w->mmut.best_s = mmut->best_s;
+	w->mmut.prev_best_s = mmut->prev_best_s;
+	w->mmut.prev_num_nodes = mmut->prev_num_nodes;
+	w->mmut.mst_initialised = mmut->mst_initialised;
+
+	w->jobs = (struct recompute_job*) malloc(w->capacity * sizeof(struct recompute_job));
+	if(w->jobs == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	if(pthread_mutex_init(&(w->view.mutex_nodes), NULL) != 0 || pthread_mutex_init(&(w->view.mutex_matrix), NULL) != 0 || pthread_mutex_init(&(w->mmut.mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		free(w->jobs);
+		return 1;
+	}
+	if(pthread_mutex_init(&(w->mutex), NULL) != 0 || pthread_cond_init(&(w->cond_not_empty), NULL) != 0 || pthread_cond_init(&(w->cond_not_full), NULL) != 0){
+		perror("failed to initialise the recompute queue\n");
+		free(w->jobs);
+		return 1;
+	}
+	if(pthread_create(&(w->thread), NULL, recompute_worker_thread, w) != 0){
+		perror("failed to call pthread_create\n");
+		free(w->jobs);
+		return 1;
+	}
+
+	return 0;
+}
+
+// called by a reader holding g->mutex_nodes, so that neither nodes nor counts change while they are copied; blocks while the queue is full
+int32_t recompute_worker_submit(struct recompute_worker* const w, const uint64_t i, const struct graph* const g, const struct measurement_mutables* const mmut, const int64_t num_oov_types, const uint8_t force){
+	struct recompute_job job = {
+		.num_nodes = g->num_nodes,
+		.i = i,
+		.num_oov_types = num_oov_types,
+		.sentence = mmut->sentence,
+		.document = mmut->document,
+		.force = force,
+	};
+	memcpy(job.chunks, g->chunks, GRAPH_NUM_CHUNKS * sizeof(struct graph_node*));
+	job.counts = (uint64_t*) malloc((job.num_nodes > 0 ? job.num_nodes : 1) * sizeof(uint64_t));
+	if(job.counts == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	for(uint64_t k = 0 ; k < job.num_nodes ; k++){
+		job.counts[k] = __atomic_load_n(&(graph_node_at(g, k)->absolute_proportion), __ATOMIC_RELAXED);
+	}
+
+	pthread_mutex_lock(&(w->mutex));
+	while(w->num_jobs == w->capacity && w->status == 0){
+		pthread_cond_wait(&(w->cond_not_full), &(w->mutex));
+	}
+	if(w->status != 0){
+		pthread_mutex_unlock(&(w->mutex));
+		free(job.counts);
+		perror("a previous recompute step failed\n");
+		return 1;
+	}
+	w->jobs[(w->head + w->num_jobs) % w->capacity] = job;
+	w->num_jobs++;
+	pthread_cond_signal(&(w->cond_not_empty));
+	pthread_mutex_unlock(&(w->mutex));
+
+	return 0;
+}
+
+// waits until every submitted step is computed, leaving the thread running; returns 1 if any step failed
+int32_t recompute_worker_drain(struct recompute_worker* const w){
+	pthread_mutex_lock(&(w->mutex));
+	while((w->num_jobs > 0 || w->busy) && w->status == 0){
+		pthread_cond_wait(&(w->cond_not_full), &(w->mutex));
+	}
+	const int32_t status = w->status;
+	pthread_mutex_unlock(&(w->mutex));
+	return status;
+}
+
+// waits for every submitted step, then stops the thread; returns 1 if any step failed
+int32_t recompute_worker_finish(struct recompute_worker* const w){
+	pthread_mutex_lock(&(w->mutex));
+	w->stop = 1;
+	pthread_cond_signal(&(w->cond_not_empty));
+	pthread_mutex_unlock(&(w->mutex));
+
+	if(pthread_join(w->thread, NULL) != 0){
+		perror("failed to call pthread_join\n");
+		return 1;
+	}
+	return w->status;
+}
+
+// the nodes belong to the live graph and are left alone
+void free_recompute_worker(struct recompute_worker* const w){
+	free(w->jobs);
+	w->jobs = NULL;
+	free_graph_snapshot(&(w->view.snapshot));
+	if(w->view.dist_mat_must_be_freed){
+		free_matrix(&(w->view.dist_mat));
+		w->view.dist_mat_must_be_freed = 0;
+	}
+	pthread_mutex_destroy(&(w->view.mutex_nodes));
+	pthread_mutex_destroy(&(w->view.mutex_matrix));
+	pthread_mutex_destroy(&(w->mmut.mutex));
+	pthread_mutex_destroy(&(w->mutex));
+	pthread_cond_destroy(&(w->cond_not_empty));
+	pthread_cond_destroy(&(w->cond_not_full));
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for clock_gettime
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <time.h>
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "schedule.h"
+
+static const double recompute_schedule_prior_exponents[RECOMPUTE_COST_NUM_FUNCTIONS] = {
+	[RECOMPUTE_COST_FIT] = 1.0,
+	[RECOMPUTE_COST_DISPARITY] = 2.0,
+	[RECOMPUTE_COST_NON_DISPARITY] = 1.0,
+};
+
+static void power_law_observe(struct recompute_power_law* const p, const double x, const double y){
+	if(x <= 0.0 || y <= 0.0){return;}
+	const double lx = log(x);
+	const double ly = log(y);
+	p->sum_x += lx;
+	p->sum_y += ly;
+	p->sum_xx += lx * lx;
+	p->sum_xy += lx * ly;
+	p->num_observations++;
+}
+
+static double power_law_exponent(const struct recompute_power_law* const p){
+	if(p->num_observations < 2){return p->prior_exponent;}
+	const double n = (double) p->num_observations;
+	const double denominator = n * p->sum_xx - p->sum_x * p->sum_x;
+	// every observation at the same x
+	if(denominator <= 1e-9 * n * p->sum_xx){return p->prior_exponent;}
+	double exponent = (n * p->sum_xy - p->sum_x * p->sum_y) / denominator;
+	if(exponent < 0.0){exponent = 0.0;}
+	if(exponent > RECOMPUTE_SCHEDULE_MAX_EXPONENT){exponent = RECOMPUTE_SCHEDULE_MAX_EXPONENT;}
+	return exponent;
+}
+
+static double power_law_evaluate(const struct recompute_power_law* const p, const double x){
+	if(p->num_observations == 0 || x <= 0.0){return 0.0;}
+	const double exponent = power_law_exponent(p);
+	const double log_coefficient = (p->sum_y - exponent * p->sum_x) / ((double) p->num_observations);
+	return exp(log_coefficient + exponent * log(x));
+}
+
+static void create_recompute_schedule_progress(struct recompute_schedule_progress* const p){
+	memset(p, '\0', sizeof(struct recompute_schedule_progress));
+	// every unit bringing new types, until the vocabulary growth is measured
+	p->growth.prior_exponent = 1.0;
+	p->ingest_ns_per_unit = -1.0;
+}
+
+int32_t create_recompute_schedule(struct recompute_schedule* const s, const uint32_t enabled_functions, const double compute_fraction, const uint64_t min_step, const uint64_t max_step, const uint8_t deterministic){
+	memset(s, '\0', sizeof(struct recompute_schedule));
+	for(int32_t k = 0 ; k < RECOMPUTE_COST_NUM_FUNCTIONS ; k++){
+		s->costs[k].prior_exponent = recompute_schedule_prior_exponents[k];
+	}
+	create_recompute_schedule_progress(&(s->sentence));
+	create_recompute_schedule_progress(&(s->document));
+	s->enabled_functions = enabled_functions;
+	s->compute_fraction = compute_fraction;
+	s->min_step = min_step < 1 ? 1 : min_step;
+	s->max_step = max_step;
+	s->deterministic = deterministic;
+
+	if(pthread_mutex_init(&(s->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		return 1;
+	}
+	return 0;
+}
+
+int64_t recompute_schedule_now(void){
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0){return 0;}
+	return ((int64_t) ts.tv_sec) * 1000000000 + (int64_t) ts.tv_nsec;
+}
+
+// called by whichever thread computed the step; ignored in deterministic mode, where costs are the declared complexities
+void recompute_schedule_observe_compute(struct recompute_schedule* const s, const int32_t function, const uint64_t num_nodes, const int64_t ns){
+	if(s->deterministic){return;}
+	pthread_mutex_lock(&(s->mutex));
+	power_law_observe(&(s->costs[function]), (double) num_nodes, (double) ns);
+	s->compute_ns += ns;
+	pthread_mutex_unlock(&(s->mutex));
+}
+
+static double recompute_schedule_cost_locked(const struct recompute_schedule* const s, const double num_nodes){
+	double cost = 0.0;
+	for(int32_t k = 0 ; k < RECOMPUTE_COST_NUM_FUNCTIONS ; k++){
+		if(!(s->enabled_functions & (1u << k))){continue;}
+		if(s->deterministic){
+			cost += RECOMPUTE_SCHEDULE_VIRTUAL_NS_PER_NODE * pow(num_nodes, s->costs[k].prior_exponent);
+		} else {
+			cost += power_law_evaluate(&(s->costs[k]), num_nodes);
+		}
+	}
+	return cost;
+}
+
+// predicted ns for a step on num_nodes nodes
+double recompute_schedule_cost(struct recompute_schedule* const s, const double num_nodes){
+	pthread_mutex_lock(&(s->mutex));
+	const double cost = recompute_schedule_cost_locked(s, num_nodes);
+	pthread_mutex_unlock(&(s->mutex));
+	return cost;
+}
+
+// whether a step after delta more units costs at most the share of wall time allowed by compute_fraction
+static int32_t recompute_schedule_fits(const struct recompute_schedule* const s, const struct recompute_schedule_progress* const p, const uint64_t units, const uint64_t delta){
+	const double num_nodes = power_law_evaluate(&(p->growth), (double) (units + delta));
+	const double ratio = s->compute_fraction / (1.0 - s->compute_fraction);
+	return recompute_schedule_cost_locked(s, num_nodes) <= ratio * p->ingest_ns_per_unit * ((double) delta);
+}
+
+// called when a step is taken at units; returns the number of units at which the next step should be taken,
+// rounded up to the next 10^(k * log10_spacing) when log10_spacing > 0
+uint64_t recompute_schedule_next(struct recompute_schedule* const s, struct recompute_schedule_progress* const p, const uint64_t units, const uint64_t num_nodes, const int64_t now_ns, const uint8_t compute_on_reader, const double log10_spacing){
+	uint64_t delta;
+
+	pthread_mutex_lock(&(s->mutex));
+
+	power_law_observe(&(p->growth), (double) units, (double) num_nodes);
+
+	if(s->deterministic){
+		p->ingest_ns_per_unit = RECOMPUTE_SCHEDULE_VIRTUAL_NS_PER_UNIT;
+	} else if(p->last_ns != 0 && units > p->last_units){
+		// steps computed by the reader are not ingestion time
+		int64_t elapsed = now_ns - p->last_ns;
+		if(compute_on_reader){elapsed -= s->compute_ns - p->last_compute_ns;}
+		if(elapsed < 1){elapsed = 1;}
+		const double rate = ((double) elapsed) / ((double) (units - p->last_units));
+		p->ingest_ns_per_unit = p->ingest_ns_per_unit < 0.0 ? rate : RECOMPUTE_SCHEDULE_INGEST_SMOOTHING * rate + (1.0 - RECOMPUTE_SCHEDULE_INGEST_SMOOTHING) * p->ingest_ns_per_unit;
+	}
+	p->last_units = units;
+	p->last_ns = now_ns;
+	p->last_compute_ns = s->compute_ns;
+
+	const uint64_t min_step = s->min_step;
+	const uint64_t max_step = s->max_step > 0 ? (s->max_step > min_step ? s->max_step : min_step) : (units > min_step ? units : min_step);
+	uint8_t has_costs = s->deterministic;
+	for(int32_t k = 0 ; k < RECOMPUTE_COST_NUM_FUNCTIONS ; k++){
+		if((s->enabled_functions & (1u << k)) && s->costs[k].num_observations > 0){has_costs = 1;}
+	}
+
+	if(!has_costs || p->ingest_ns_per_unit <= 0.0 || s->compute_fraction >= 1.0 || recompute_schedule_fits(s, p, units, min_step)){
+		// nothing to go by yet, or already cheap enough
+		delta = min_step;
+	} else if(s->compute_fraction <= 0.0){
+		delta = max_step;
+	} else {
+		// doubling up to a step that fits, then bisection down to the smallest one
+		uint64_t low = min_step;
+		uint64_t high = min_step;
+		uint8_t found = 0;
+		while(high < max_step){
+			high = high * 2 < max_step ? high * 2 : max_step;
+			if(recompute_schedule_fits(s, p, units, high)){found = 1; break;}
+			low = high;
+		}
+		if(found){
+			while(high - low > 1){
+				const uint64_t middle = low + (high - low) / 2;
+				if(recompute_schedule_fits(s, p, units, middle)){high = middle;} else {low = middle;}
+			}
+		}
+		delta = high;
+	}
+
+	pthread_mutex_unlock(&(s->mutex));
+
+	uint64_t target = units + delta;
+	if(log10_spacing > 0.0){
+		double k = ceil(log10((double) target) / log10_spacing);
+		uint64_t snapped = (uint64_t) floor(pow(10.0, k * log10_spacing));
+		while(snapped < target){
+			k += 1.0;
+			snapped = (uint64_t) floor(pow(10.0, k * log10_spacing));
+		}
+		target = snapped;
+	}
+	return target;
+}
+
+void free_recompute_schedule(struct recompute_schedule* const s){
+	pthread_mutex_destroy(&(s->mutex));
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for stat
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "file_queue.h"
+#include "checkpoint.h"
+#include "instrument.h"
+#include "measurement.h"
+#include "logging.h"
+#include "jsonl/load.h"
+#include "cupt/load.h"
+
+static int32_t file_queue_has_suffix(const char* const filename, const char* const suffix){
+	const size_t len = strlen(filename);
+	const size_t suffix_len = strlen(suffix);
+	return len >= suffix_len && strcmp(&(filename[len - suffix_len]), suffix) == 0;
+}
+
+// largest files first, ties in input order
+static int file_queue_compare_entries(const void* a, const void* b){
+	const struct file_queue_entry* const x = (const struct file_queue_entry*) a;
+	const struct file_queue_entry* const y = (const struct file_queue_entry*) b;
+	if(x->size != y->size){return x->size < y->size ? 1 : -1;}
+	if(x->i != y->i){return (x->i > y->i) - (x->i < y->i);}
+	return (x->corpus > y->corpus) - (x->corpus < y->corpus);
+}
+
+static int32_t file_queue_init_entry(struct file_queue* const q, struct file_queue_entry* const entry, const char* const path, const char* const path_tp, const int32_t i, const int32_t corpus){
+	struct stat st;
+
+	entry->filename = path;
+	entry->filename_tp = path_tp;
+	entry->i = i;
+	entry->corpus = corpus;
+	if(file_queue_has_suffix(path, ".cupt") || file_queue_has_suffix(path, ".conllu")){
+		entry->format = FILE_QUEUE_CUPT;
+	} else if(file_queue_has_suffix(path, ".jsonl")){
+		entry->format = FILE_QUEUE_JSONL;
+	} else {
+		snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "unknown file type: %s", path);
+		fprintf(stderr, "%s\n", q->error);
+		return 1;
+	}
+	if(stat(path, &st) != 0){
+		snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "cannot stat %s: %s", path, strerror(errno));
+		fprintf(stderr, "%s\n", q->error);
+		return 1;
+	}
+	entry->size = (int64_t) st.st_size;
+	q->total_size += entry->size;
+	return 0;
+}
+
+static int32_t file_queue_finish_creation(struct file_queue* const q, const uint8_t largest_first){
+	if(largest_first && q->num_entries > 1){qsort(q->entries, q->num_entries, sizeof(struct file_queue_entry), file_queue_compare_entries);}
+
+	if(pthread_mutex_init(&(q->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		free(q->entries);
+		q->entries = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+int32_t create_file_queue(struct file_queue* const q, char* const * const paths, char* const * const paths_tp, const int32_t num_paths, const uint8_t largest_first){
+	memset(q, '\0', sizeof(struct file_queue));
+
+	if(num_paths > 0){
+		q->entries = (struct file_queue_entry*) malloc(num_paths * sizeof(struct file_queue_entry));
+		if(q->entries == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+	}
+
+	for(int32_t i = 0 ; i < num_paths ; i++){
+		if(file_queue_init_entry(q, &(q->entries[i]), paths[i], paths_tp != NULL ? paths_tp[i] : NULL, i, 0) != 0){goto failure;}
+	}
+	q->num_entries = num_paths;
+
+	return file_queue_finish_creation(q, largest_first);
+
+	failure:
+	free(q->entries);
+	q->entries = NULL;
+	return 1;
+}
+
+// one queue for the files of several corpora; in input order, the corpora take turns so that all of them progress from the start
+int32_t create_file_queue_corpora(struct file_queue* const q, struct file_queue_corpus* const corpora, const int32_t num_corpora, const uint8_t largest_first){
+	int32_t num_paths = 0;
+	int32_t max_num_paths = 0;
+
+	memset(q, '\0', sizeof(struct file_queue));
+	for(int32_t c = 0 ; c < num_corpora ; c++){
+		corpora[c].num_done = 0;
+		num_paths += corpora[c].num_paths;
+		if(corpora[c].num_paths > max_num_paths){max_num_paths = corpora[c].num_paths;}
+	}
+
+	if(num_paths > 0){
+		q->entries = (struct file_queue_entry*) malloc(num_paths * sizeof(struct file_queue_entry));
+		if(q->entries == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+	}
+
+	for(int32_t i = 0 ; i < max_num_paths ; i++){
+		for(int32_t c = 0 ; c < num_corpora ; c++){
+			if(i >= corpora[c].num_paths){continue;}
+			if(file_queue_init_entry(q, &(q->entries[q->num_entries]), corpora[c].paths[i], corpora[c].paths_tp != NULL ? corpora[c].paths_tp[i] : NULL, i, c) != 0){goto failure;}
+			q->num_entries++;
+		}
+	}
+	q->corpora = corpora;
+
+	return file_queue_finish_creation(q, largest_first);
+
+	failure:
+	free(q->entries);
+	q->entries = NULL;
+	return 1;
+}
+
+// returns 1 once the queue is drained, or as soon as a reader failed; progress is logged under the queue mutex
+int32_t file_queue_pop(struct file_queue* const q, const struct file_queue_entry** const entry){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+	int32_t result = 1;
+
+	pthread_mutex_lock(&(q->mutex));
+	if(q->status == 0 && q->next < q->num_entries){
+		*entry = &(q->entries[q->next]);
+		q->next++;
+		result = 0;
+		snprintf(log_bfr, log_bfr_size, "%s: %s", (*entry)->format == FILE_QUEUE_CUPT ? "CUPT" : "JSONL", (*entry)->filename);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	}
+	pthread_mutex_unlock(&(q->mutex));
+
+	return result;
+}
+
+void file_queue_done(struct file_queue* const q, const struct file_queue_entry* const entry, const int32_t status){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+
+	pthread_mutex_lock(&(q->mutex));
+	if(status != 0){
+		q->status = status;
+		if(q->error[0] == '\0'){
+			if(entry != NULL){
+				snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "failed to read %s", entry->filename);
+			} else {
+				snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "failed to start the reader threads");
+			}
+		}
+	} else {
+		q->num_done++;
+		q->done_size += entry->size;
+		if(q->corpora != NULL){q->corpora[entry->corpus].num_done++;}
+		snprintf(log_bfr, log_bfr_size, "done %i/%i files (%.1f%% of bytes): %s", q->num_done, q->num_entries, q->total_size > 0 ? (100.0 * q->done_size) / q->total_size : 100.0, entry->filename);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+		if(q->progress != NULL){q->progress->file_done(q->progress->ctx, entry->filename, q->num_done, q->num_entries, q->total_size > 0 ? ((double) q->done_size) / q->total_size : 1.0);}
+	}
+	pthread_mutex_unlock(&(q->mutex));
+}
+
+struct file_queue_thread_args {
+	struct file_queue* q;
+	struct measurement_configuration* mcfg;
+	struct measurement_structure_references* sref;
+	struct measurement_mutables* mmut;
+};
+
+static void* file_queue_thread(void* args){
+	const struct file_queue_thread_args* const a = (const struct file_queue_thread_args*) args;
+	const struct file_queue_entry* entry;
+
+	while(file_queue_pop(a->q, &entry) == 0){
+		const struct file_queue_corpus* const corpus = a->q->corpora != NULL ? &(a->q->corpora[entry->corpus]) : NULL;
+		struct measurement_configuration* const mcfg = corpus != NULL ? corpus->mcfg : a->mcfg;
+		struct measurement_structure_references* const sref = corpus != NULL ? corpus->sref : a->sref;
+		struct measurement_mutables* const mmut = corpus != NULL ? corpus->mmut : a->mmut;
+		struct checkpoint* const cp = sref->checkpoint;
+		struct instrument_scope span;
+		int32_t status;
+
+		// read to the end by the run that wrote the checkpoint
+		if(cp != NULL && checkpoint_file_is_done(cp, entry->i)){
+			file_queue_done(a->q, entry, 0);
+			continue;
+		}
+
+		if(cp != NULL){checkpoint_file_begin(cp, entry->i);}
+		instrument_span_begin(&span, "read_file");
+		if(entry->format == FILE_QUEUE_CUPT){
+			status = cupt_to_graph(entry->i, entry->filename, entry->filename_tp, mcfg, sref, mmut, NULL);
+		} else {
+			status = jsonl_to_graph(entry->i, entry->filename, mcfg, sref, mmut);
+		}
+		instrument_span_end(&span);
+		if(cp != NULL){checkpoint_file_end(cp, entry->i, status);}
+		if(status != 0){
+			fprintf(stderr, "failed to read %s\n", entry->filename);
+		}
+		file_queue_done(a->q, entry, status);
+	}
+
+	return NULL;
+}
+
+// reads every file of the queue with num_threads reader threads, each taking the next file as soon as it is done with the previous one;
+// mcfg, sref and mmut are ignored (and may be NULL) for a queue created with create_file_queue_corpora
+int32_t file_queue_read(struct file_queue* const q, struct measurement_configuration* const mcfg, struct measurement_structure_references* const sref, struct measurement_mutables* const mmut, const int32_t num_threads){
+	const int32_t num_threads_used = num_threads < 1 ? 1 : (num_threads > q->num_entries && q->num_entries > 0 ? q->num_entries : num_threads);
+	struct file_queue_thread_args args = {
+		.q = q,
+		.mcfg = mcfg,
+		.sref = sref,
+		.mmut = mmut,
+	};
+	int32_t num_created = 0;
+	int32_t result = 0;
+
+	pthread_t* const threads = (pthread_t*) malloc(num_threads_used * sizeof(pthread_t));
+	if(threads == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+
+	for(int32_t k = 0 ; k < num_threads_used ; k++){
+		if(pthread_create(&(threads[k]), NULL, file_queue_thread, &args) != 0){
+			perror("failed to call pthread_create\n");
+			file_queue_done(q, NULL, 1);
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int32_t k = 0 ; k < num_created ; k++){
+		if(pthread_join(threads[k], NULL) != 0){
+			perror("failed to call pthread_join\n");
+			result = 1;
+		}
+	}
+	free(threads);
+
+	if(q->status != 0){result = 1;}
+	return result;
+}
+
+void free_file_queue(struct file_queue* const q){
+	pthread_mutex_destroy(&(q->mutex));
+	free(q->entries);
+	memset(q, '\0', sizeof(struct file_queue));
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dfunctions.h"
+#include "graph.h"
+#include "general_constants.h"
+
+#define LOGARITHMIC_BASE E
+
+// static const double NORMALISATION_BASE = log(LOGARITHMIC_BASE);
+
+#define NORMALISATION_BASE log(LOGARITHMIC_BASE)
+
+double q_logarithm(const double x, const double q){
+	if(q == 1.0){
+		return log(x);
+	} else {
+		return (pow(x, 1.0 - q) - 1) / (1.0 - q);
+	}
+}
+
+/* ======== MEMO ======== */
+
+struct dfunctions_memo_thread_args {
+	const struct graph* g;
+	uint64_t start;
+	uint64_t end;
+	uint32_t primitives;
+	uint32_t first_order;
+	uint32_t num_orders;
+	double log_mean; // for LOG_VARIANCE
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+};
+
+// one pass over [start, end) for every requested primitive; the terms are those of the original loops, so that a single chunk gives the same sums
+static void* dfunctions_memo_thread(void* args){
+	struct dfunctions_memo_thread_args* const a = (struct dfunctions_memo_thread_args*) args;
+	const struct graph_snapshot* const s = &(a->g->snapshot);
+	const uint32_t primitives = a->primitives;
+	const double n = (double) a->g->snapshot.num_nodes;
+	const double division = 1.0 / n;
+	double sum_p_log_p = 0.0;
+	double sum_squares = 0.0;
+	double sum = 0.0;
+	double max = -INFINITY;
+	double sum_min_even = 0.0;
+	double log_mean = 0.0;
+	double log_variance = 0.0;
+	double tokens = 0.0;
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS] = {0.0};
+
+	for(uint64_t i = a->start ; i < a->end ; i++){
+		const double p = s->relative_proportions[i];
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P)){
+			if(p > 0.0){sum_p_log_p += p * (log(p) / NORMALISATION_BASE);}
+		}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES)){sum_squares += pow(p, 2.0);}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM)){sum += p;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_MAX)){
+			if(p > max){max = p;}
+		}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN)){sum_min_even += p < division ? p : division;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN)){log_mean += (log(p) / NORMALISATION_BASE) / n;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE)){log_variance += pow((log(p) / NORMALISATION_BASE) - a->log_mean, 2.0) / n;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_TOKENS)){tokens += (double) s->absolute_proportions[i];}
+		for(uint32_t k = 0 ; k < a->num_orders ; k++){
+			power_sums[k] += pow(p, s->memo.orders[a->first_order + k]);
+		}
+	}
+
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P] = sum_p_log_p;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES] = sum_squares;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM] = sum;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_MAX] = max;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN] = sum_min_even;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN] = log_mean;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE] = log_variance;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_TOKENS] = tokens;
+	for(uint32_t k = 0 ; k < a->num_orders ; k++){a->power_sums[k] = power_sums[k];}
+
+	return NULL;
+}
+
+// computes the primitives and the orders [first_order, num_orders) of the memo into values and power_sums, merging the chunks in order so that the result does not depend on scheduling
+static int32_t dfunctions_memo_run(const struct graph* const g, const uint32_t primitives, const uint32_t first_order, const double log_mean, const int16_t num_threads, double* const values, double* const power_sums){
+	const uint64_t num_nodes = g->snapshot.num_nodes;
+	int16_t num_threads_used = num_threads < 1 ? 1 : num_threads;
+	if(((uint64_t) num_threads_used) * DFUNCTIONS_MEMO_MIN_NODES_PER_THREAD > num_nodes){
+		num_threads_used = (int16_t) (num_nodes / DFUNCTIONS_MEMO_MIN_NODES_PER_THREAD);
+		if(num_threads_used < 1){num_threads_used = 1;}
+	}
+
+	struct dfunctions_memo_thread_args args[num_threads_used];
+	pthread_t threads[num_threads_used];
+	int16_t num_created = 0;
+	int32_t result = 0;
+	uint64_t start = 0;
+	for(int16_t k = 0 ; k < num_threads_used ; k++){
+		uint64_t end = start + num_nodes / ((uint64_t) num_threads_used);
+		if(((uint64_t) k) < num_nodes % ((uint64_t) num_threads_used)){end++;}
+		args[k] = (struct dfunctions_memo_thread_args) {
+			.g = g,
+			.start = start,
+			.end = end,
+			.primitives = primitives,
+			.first_order = first_order,
+			.num_orders = g->snapshot.memo.num_orders - first_order,
+			.log_mean = log_mean,
+		};
+		start = end;
+	}
+
+	if(num_threads_used == 1){
+		dfunctions_memo_thread(&(args[0]));
+	} else {
+		for(int16_t k = 0 ; k < num_threads_used ; k++){
+			if(pthread_create(&(threads[k]), NULL, dfunctions_memo_thread, &(args[k])) != 0){
+				perror("failed to create memo thread\n");
+				result = 1;
+				break;
+			}
+			num_created++;
+		}
+		for(int16_t k = 0 ; k < num_created ; k++){
+			if(pthread_join(threads[k], NULL) != 0){
+				perror("failed to join memo thread\n");
+				result = 1;
+			}
+		}
+		if(result != 0){return 1;}
+	}
+
+	for(uint32_t primitive = 0 ; primitive < GRAPH_SNAPSHOT_NUM_PRIMITIVES ; primitive++){
+		values[primitive] = primitive == GRAPH_SNAPSHOT_PRIMITIVE_MAX ? -INFINITY : 0.0;
+	}
+	for(uint32_t k = 0 ; k < args[0].num_orders ; k++){power_sums[k] = 0.0;}
+	for(int16_t t = 0 ; t < num_threads_used ; t++){
+		for(uint32_t primitive = 0 ; primitive < GRAPH_SNAPSHOT_NUM_PRIMITIVES ; primitive++){
+			if(primitive == GRAPH_SNAPSHOT_PRIMITIVE_MAX){
+				if(args[t].values[primitive] > values[primitive]){values[primitive] = args[t].values[primitive];}
+			} else {
+				values[primitive] += args[t].values[primitive];
+			}
+		}
+		for(uint32_t k = 0 ; k < args[t].num_orders ; k++){power_sums[k] += args[t].power_sums[k];}
+	}
+
+	return 0;
+}
+
+void dfunctions_memo_request(struct graph* const g, const uint32_t needs){
+	g->snapshot.memo.requested |= needs;
+}
+
+// alpha == 1.0 stands for the Shannon-Weaver entropy, whose primitive is requested instead
+void dfunctions_memo_request_order(struct graph* const g, const double alpha){
+	struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	if(alpha == 1.0){
+		memo->requested |= DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P);
+		return;
+	}
+	for(uint32_t k = 0 ; k < memo->num_orders ; k++){
+		if(memo->orders[k] == alpha){return;}
+	}
+	// further orders are simply recomputed by their functions
+	if(memo->num_orders < GRAPH_SNAPSHOT_MEMO_MAX_ORDERS){
+		memo->orders[memo->num_orders] = alpha;
+		memo->num_orders++;
+	}
+}
+
+// computes whatever was requested since the last refresh and is not known yet: every primitive that does not depend on another is gathered in one parallel pass, then LOG_VARIANCE in a second one
+int32_t dfunctions_memo_compute(struct graph* const g, const int16_t num_threads){
+	struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+
+	if(memo->requested & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE)){memo->requested |= DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN);}
+
+	const uint32_t first_pass = memo->requested & ~(memo->computed) & ~DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE);
+	if(first_pass != 0 || memo->num_orders_computed < memo->num_orders){
+		if(dfunctions_memo_run(g, first_pass, memo->num_orders_computed, 0.0, num_threads, values, power_sums) != 0){return 1;}
+		for(uint32_t primitive = 0 ; primitive < GRAPH_SNAPSHOT_NUM_PRIMITIVES ; primitive++){
+			if(first_pass & DFUNCTIONS_NEEDS(primitive)){memo->values[primitive] = values[primitive];}
+		}
+		for(uint32_t k = memo->num_orders_computed ; k < memo->num_orders ; k++){memo->power_sums[k] = power_sums[k - memo->num_orders_computed];}
+		memo->computed |= first_pass;
+		memo->num_orders_computed = memo->num_orders;
+	}
+
+	const uint32_t second_pass = memo->requested & ~(memo->computed);
+	if(second_pass != 0){
+		if(dfunctions_memo_run(g, second_pass, memo->num_orders, memo->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN], num_threads, values, power_sums) != 0){return 1;}
+		memo->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE] = values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE];
+		memo->computed |= second_pass;
+	}
+
+	return 0;
+}
+
+// the memoised value when there is one, otherwise a sequential pass over the snapshot, which gives the same value bit for bit
+static double dfunctions_primitive(const struct graph* const g, const enum graph_snapshot_primitive primitive){
+	const struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+	double log_mean = 0.0;
+
+	if(memo->computed & DFUNCTIONS_NEEDS(primitive)){return memo->values[primitive];}
+	if(primitive == GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE){log_mean = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN);}
+	dfunctions_memo_run(g, DFUNCTIONS_NEEDS(primitive), memo->num_orders, log_mean, 1, values, power_sums);
+	return values[primitive];
+}
+
+static double dfunctions_power_sum(const struct graph* const g, const double alpha){
+	const struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	for(uint32_t k = 0 ; k < memo->num_orders_computed ; k++){
+		if(memo->orders[k] == alpha){return memo->power_sums[k];}
+	}
+	double sum = 0.0;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		sum += pow(g->snapshot.relative_proportions[i], alpha);
+	}
+	return sum;
+}
+
+/* ======== FUNCTIONS ======== */
+
+void shannon_weaver_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number){
+	double loc_res = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P);
+	loc_res *= -1.0;
+	(*res_entropy) = loc_res;
+	(*res_hill_number) = pow(LOGARITHMIC_BASE, loc_res);
+}
+
+void good_entropy_from_graph(const struct graph* const g, double* const res, double alpha, double beta){
+	double loc_res = 0.0;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		loc_res += pow(g->snapshot.relative_proportions[i], alpha) * pow(-log(g->snapshot.relative_proportions[i]) / log(LOGARITHMIC_BASE), beta);
+	}
+	(*res) = loc_res;
+}
+
+void renyi_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number, double alpha){
+	if(alpha == 1.0){
+		shannon_weaver_entropy_from_graph(g, res_entropy, res_hill_number);
+	} else {
+		double loc_res = 1.0e-300 + dfunctions_power_sum(g, alpha);
+		loc_res = (1.0 / (1.0 - alpha)) * (log(loc_res) / log(LOGARITHMIC_BASE));
+		(*res_entropy) = loc_res;
+		(*res_hill_number) = pow(LOGARITHMIC_BASE, loc_res);
+	}
+}
+
+void patil_taillie_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number, double alpha){
+	if(alpha == 0.0){
+		shannon_weaver_entropy_from_graph(g, res_entropy, res_hill_number);
+	} else {
+		double loc_res = 1.0;
+		for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+			loc_res -= pow(g->snapshot.relative_proportions[i], alpha + 1.0);
+		}
+		loc_res /= alpha;
+		(*res_entropy) = loc_res;
+		(*res_hill_number) = 1.0 / pow(1.0 - (alpha * loc_res), 1.0 / alpha);
+	}
+}
+
+void q_logarithmic_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number, double q){
+	double loc_res = 0.0;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		loc_res += g->snapshot.relative_proportions[i] * q_logarithm(1.0 / g->snapshot.relative_proportions[i], q);
+	}
+	(*res_entropy) = loc_res;
+	if(q == 1.0){
+		(*res_hill_number) = pow(LOGARITHMIC_BASE, loc_res); // ?
+	} else {
+		(*res_hill_number) = pow(1.0 - (q - 1.0) * loc_res, 1.0 / (1.0 - q));
+	}
+}
+
+void simpson_dominance_index_from_graph(const struct graph* const g, double* const res){
+	(*res) = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
+}
+
+void simpson_index_from_graph(const struct graph* const g, double* const res){
+	double loc_res;
+	simpson_dominance_index_from_graph(g, &loc_res);
+	(*res) = 1.0 - loc_res;
+}
+
+void richness_from_graph(const struct graph* const g, double* const res){
+	(*res) = (double) g->snapshot.num_nodes;
+}
+
+void species_count_from_graph(const struct graph* const g, double* const res){
+	(*res) = ((double) g->snapshot.num_nodes) - 1.0;
+}
+
+void hill_number_standard_from_graph(const struct graph* const g, double* const res, double alpha){
+	double renyi_entropy;
+	double hill_number;
+	renyi_entropy_from_graph(g, &renyi_entropy, &hill_number, alpha);
+	(*res) = hill_number;
+}
+
+void hill_evenness_from_graph(const struct graph* const g, double* const res, double alpha, double beta){
+	double loc_res_upper;
+	double loc_res_lower;
+	hill_number_standard_from_graph(g, &loc_res_upper, alpha);
+	hill_number_standard_from_graph(g, &loc_res_lower, beta);
+	(*res) = loc_res_upper / loc_res_lower;
+}
+
+void berger_parker_index_from_graph(const struct graph* const g, double* const res){
+	(*res) = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_MAX);
+}
+
+void shannon_evenness_from_graph(const struct graph* const g, double* const res){
+	double sw_entropy;
+	double hill_number;
+	shannon_weaver_entropy_from_graph(g, &sw_entropy, &hill_number);
+	double max_entropy = log((double) g->snapshot.num_nodes) / log(LOGARITHMIC_BASE);
+	(*res) = sw_entropy / max_entropy;
+}
+
+
+void junge1994_page22_from_graph(const struct graph* const g, double *res){
+	const double sum = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
+	(*res) = 1.0 - pow(sum, 0.5);
+}
+
+void brillouin_diversity_from_graph(const struct graph* const g, double* const res){
+	/*
+	double sum_left = 0.0;
+	double sum_right = 0.0;
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		sum_left += log((double) (i+1)) / log(LOGARITHMIC_BASE);
+		int64_t fact = 1;
+		for(uint64_t j = 1 ; j <= graph_node_at(g, i)->absolute_proportion ; j++){
+			fact *= (int64_t) j;
+		}
+		printf("fact(%i): %li\n", graph_node_at(g, i)->absolute_proportion, fact);
+		sum_right += log((double) fact) / log(LOGARITHMIC_BASE);
+	}
+	(*res) = sum_left - sum_right;
+	*/
+
+	double sum_left = 0.0;
+	double sum_right = 0.0;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		sum_left += log((double) (i+1)) / log(LOGARITHMIC_BASE);
+		for(uint64_t j = 0 ; j < (uint64_t) g->snapshot.absolute_proportions[i] ; j++){
+			sum_right += log((double) (j+1)) / log(LOGARITHMIC_BASE);
+		}
+	}
+	(*res) = sum_left - sum_right;
+}
+
+void mcintosh_index_from_graph(const struct graph* const g, double* const res){	
+	const double sum = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
+	(*res) = 1.0 - pow(sum, 0.5);
+}
+
+void type_token_ratio_from_graph(const struct graph * const g, double * const res){
+	uint64_t type_count = (uint64_t) g->snapshot.num_nodes;
+	const double token_count = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_TOKENS);
+	*res = ((double) type_count) / token_count;
+}
+
+void sw_entropy_over_log_n_species_pielou1975_from_graph(const struct graph* const g, double* const res){
+	// should it necessarily be logarithmic of base e?
+	shannon_evenness_from_graph(g, res);
+}
+
+void sw_e_heip_from_graph(const struct graph* const g, double* const res){
+	double sw_entropy;
+	double hill_number;
+	shannon_weaver_entropy_from_graph(g, &sw_entropy, &hill_number);
+	(*res) = (pow(E, sw_entropy) - 1.0) / ((double) (g->snapshot.num_nodes - 1));
+}
+
+void sw_e_one_minus_D_from_graph(const struct graph* const g, double* const res){
+	double dom_index;
+	simpson_dominance_index_from_graph(g, &dom_index);
+	(*res) = (1.0 - dom_index) / (1.0 - (1.0 / ((double) g->snapshot.num_nodes)));
+}
+
+void sw_e_one_over_D_williams1964_from_graph(const struct graph* const g, double* const res){
+	double dom_index;
+	simpson_dominance_index_from_graph(g, &dom_index);
+	(*res) = (1.0 / dom_index) / ((double) g->snapshot.num_nodes);
+}
+
+void sw_e_minus_ln_D_pielou1977_from_graph(const struct graph* const g, double* const res){
+	double dom_index;
+	simpson_dominance_index_from_graph(g, &dom_index);
+	(*res) = (- (log(dom_index) / log(LOGARITHMIC_BASE))) / (log((double) g->snapshot.num_nodes) / log(LOGARITHMIC_BASE));
+}
+
+void sw_f_2_1_alatalo1981_from_graph(const struct graph* const g, double* const res){
+	double dom_index;
+	simpson_dominance_index_from_graph(g, &dom_index);
+	double sw_entropy;
+	double hill_number;
+	shannon_weaver_entropy_from_graph(g, &sw_entropy, &hill_number);
+	(*res) = ((1.0 / dom_index) - 1.0) / (pow(LOGARITHMIC_BASE, sw_entropy) - 1.0);
+}
+
+void sw_g_2_1_molinari1989_from_graph(const struct graph* const g, double* const res){
+	double f_2_1;
+	sw_f_2_1_alatalo1981_from_graph(g, &f_2_1);
+	if(f_2_1 > pow(0.5, 0.5)){
+		(*res) = f_2_1 * 0.636611 * asin(f_2_1);
+	} else {
+		(*res) = pow(f_2_1, 3.0);
+	}
+}
+
+void sw_o_bulla1994_from_graph(const struct graph* const g, double* const res){
+	(*res) = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN);
+}
+
+void sw_e_bulla1994_from_graph(const struct graph* const g, double* const res){
+	double o_bulla;
+	sw_o_bulla1994_from_graph(g, &o_bulla);
+	(*res) = (o_bulla - (1.0 / ((double) g->snapshot.num_nodes))) / (1.0 - (1.0 / ((double) g->snapshot.num_nodes)));
+}
+
+void sw_e_mci_pielou1969_from_graph(const struct graph* const g, double* const res){
+	const double sum_x = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM);
+	const double sum_x_square = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
+	(*res) = (sum_x - pow(sum_x_square, 0.5)) / (sum_x - (sum_x / pow((double) g->snapshot.num_nodes, 0.5)));
+}
+
+void sw_e_prime_camargo1993_from_graph(const struct graph* const g, double* const res){
+	double sum = 0.0;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		for(uint64_t j = i + 1 ; j < g->snapshot.num_nodes ; j++){
+			double val = g->snapshot.relative_proportions[i] - g->snapshot.relative_proportions[j];
+			if(val < 0.0){
+				val *= -1.0;
+			}
+			sum += val;
+		}
+	}
+    sum /= ((double) g->snapshot.num_nodes);
+	(*res) = 1.0 - sum;
+}
+
+void* sw_e_prime_camargo1993_thread(void* const args){
+    const int16_t thread_number = ((struct sw_e_prime_camargo1993_thread_args*) args)->thread_number;
+    const int16_t num_threads = ((struct sw_e_prime_camargo1993_thread_args*) args)->num_threads;
+    const struct graph* const g = ((struct sw_e_prime_camargo1993_thread_args*) args)->g;
+
+    double sum_local = 0.0;
+    for(uint64_t i = (uint64_t) thread_number ; i < g->snapshot.num_nodes ; i += (uint64_t) num_threads){
+        for(uint64_t j = i + 1 ; j < g->snapshot.num_nodes ; j++){
+            double delta = g->snapshot.relative_proportions[i] - g->snapshot.relative_proportions[j];
+            if(delta < 0.0){delta = -delta;}
+            sum_local += delta;
+        }
+    }
+    sum_local /= ((double) g->snapshot.num_nodes);
+
+    ((struct sw_e_prime_camargo1993_thread_args*) args)->sum_local = sum_local;
+
+    return NULL;
+}
+
+int32_t sw_e_prime_camargo1993_from_graph_multithread(const struct graph* g, double* const res, const int16_t num_threads){
+    double sum = 0.0;
+    const size_t alloc_size_thread_args = num_threads * sizeof(struct sw_e_prime_camargo1993_thread_args);
+
+    struct sw_e_prime_camargo1993_thread_args* const thread_args = malloc(alloc_size_thread_args);
+    if(thread_args == NULL){goto malloc_failure;}
+    memset(thread_args, '\0', alloc_size_thread_args);
+
+    const size_t alloc_size_threads = num_threads * sizeof(pthread_t);
+    pthread_t* const threads = malloc(alloc_size_threads);
+    if(threads == NULL){free(thread_args); goto malloc_failure;}
+    memset(threads, '\0', alloc_size_threads);
+    
+    for(int16_t thread_number = 0 ; thread_number < num_threads ; thread_number++){
+        thread_args[thread_number] = (struct sw_e_prime_camargo1993_thread_args) {
+            .sum_local = 0.0,
+            .thread_number = thread_number,
+            .num_threads = num_threads,
+            .g = g,
+        };
+
+        if(pthread_create(&threads[thread_number], NULL, sw_e_prime_camargo1993_thread, &thread_args[thread_number]) != 0){
+            perror("Failed to call pthread_create\n");
+            free(threads);
+            free(thread_args);
+            return 1;
+        }
+    }
+
+    for(int16_t thread_number = 0 ; thread_number < num_threads ; thread_number++){
+        if(pthread_join(threads[thread_number], NULL) != 0){
+            perror("Failed to call pthread_join\n");
+            free(threads);
+            free(thread_args);
+            return 1;
+        }
+        sum += thread_args[thread_number].sum_local;
+    }
+
+    *res = 1.0 - sum;
+
+    free(threads);
+    free(thread_args);
+    
+    return 0;
+
+    malloc_failure:
+    perror("malloc failure\n");
+    return 1;
+}
+
+void sw_e_var_smith_and_wilson1996_original_from_graph(const struct graph* const g, double* const res){
+	// the variance of log p, around the mean of log p
+	const double outer_sum = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE);
+	(*res) = 1.0 - ((2.0 / PI) * atan(outer_sum));
+}
+
+/* ======== MULTITHREAD ======== */
+
+void * non_disparity_thread(void * args){
+    double (* function_transform_proportion)(const double, const double, const double) = ((struct non_disparity_multithread_args *) args)->function_transform_proportion;
+    double (* function_agregate_local)(const double, const double) = ((struct non_disparity_multithread_args *) args)->function_agregate_local;
+    // double (* function_finalise)(double, double, double),
+    // double thread_result = ((struct non_disparity_multithread_args *) args)->thread_result;
+    struct graph * g = ((struct non_disparity_multithread_args *) args)->g;
+    const int32_t start_index = ((struct non_disparity_multithread_args *) args)->start_index;
+    const int32_t end_index = ((struct non_disparity_multithread_args *) args)->end_index;
+    double local_result = ((struct non_disparity_multithread_args *) args)->agregation_identity;
+    double order0 = ((struct non_disparity_multithread_args *) args)->order0;
+    double order1 = ((struct non_disparity_multithread_args *) args)->order1;
+
+    for(int32_t i = start_index ; i < end_index ; i++){
+        double local_transformation = function_transform_proportion(g->snapshot.relative_proportions[i], order0, order1);
+        if(isnan(local_transformation)){continue;}
+        local_result = function_agregate_local(local_result, local_transformation);
+    }
+
+    ((struct non_disparity_multithread_args*) args)->thread_result = local_result;
+
+    return NULL;
+}
+
+int32_t non_disparity_multithread(
+    double (* function_transform_proportion)(const double, const double, const double),
+    double (* function_agregate_local)(const double, const double),
+    double (* function_finalise)(const double, const double, const double),
+    double agregation_identity,
+    struct graph * g,
+    double order0,
+    double order1,
+    double * res0,
+    double * res1,
+    int32_t num_threads
+){
+    pthread_t threads[num_threads];
+    struct non_disparity_multithread_args args[num_threads];
+
+    int32_t start_index = 0;
+    int32_t base_step = (int32_t) floor(((double) g->snapshot.num_nodes) / ((double) num_threads));
+    for(int32_t i = 0 ; i < num_threads ; i++){
+        // int32_t num_elements_for_current_thread = base_step + ((g->num_nodes % num_threads) < num_threads);
+        int32_t num_elements_for_current_thread = base_step + (i < (int32_t) (g->snapshot.num_nodes % num_threads));
+        int32_t end_index = start_index + num_elements_for_current_thread;
+        // printf("%i to %i\n", start_index, end_index);
+        args[i] = (struct non_disparity_multithread_args) {
+            .function_transform_proportion = function_transform_proportion,
+            .function_agregate_local = function_agregate_local,
+            .thread_result = agregation_identity,
+            .g = g,
+            .start_index = start_index,
+            .end_index = end_index,
+            .agregation_identity = agregation_identity,
+            .order0 = order0,
+            .order1 = order1,
+        };
+        if(pthread_create(&(threads[i]), NULL, non_disparity_thread, &(args[i])) != 0){
+            perror("Failed to call pthread_create\n");
+            return 1;
+        }
+        start_index = end_index;
+    }
+
+    double global_result = agregation_identity;
+
+    for(int32_t i = 0 ; i < num_threads ; i++){
+        if(pthread_join(threads[i], NULL) != 0){
+            perror("Failed to call pthread_join\n");
+            return 1;
+        }
+        // printf("thread %i finished with result %f\n", i, args[i].thread_result);
+        global_result = function_agregate_local(global_result, args[i].thread_result);
+    }
+
+    if(function_finalise != NULL){
+        global_result = function_finalise(global_result, order0, order1);
+    }
+
+    (*res0) = global_result;
+    (void) res1; // ...
+
+    return 0;
+}
+
+double agregate_local_add(const double a, const double b){
+    return a + b;
+}
+
+double agregate_local_multiply(const double a, const double b){
+    return a * b;
+}
+
+double entropy_shannon_weaver_transform_proportion(const double p, const double order0, const double order1){
+    (void) order0;
+    (void) order1;
+
+    return p * (-(log(p) / NORMALISATION_BASE));
+}
+double entropy_shannon_weaver_to_hill_number(const double h){
+    return pow(LOGARITHMIC_BASE, h);
+}
+
+double entropy_good_transform_proportion(const double p, const double order0, const double order1){
+    return pow(p, order0) * pow(-(log(p) / NORMALISATION_BASE), order1);
+}
+
+double entropy_renyi_transform_proportion(const double p, const double order0, const double order1){
+    (void) order1;
+
+    if(order0 == 1.0){
+        return entropy_shannon_weaver_transform_proportion(p, order0, order1);
+    } else {
+        return pow(p, order0);
+    }
+}
+
+double entropy_renyi_finalise(const double x, const double order0, const double order1){
+    (void) order1;
+
+    if(order0 == 1.0){
+        return x;
+    } else {
+        return (log(x) / NORMALISATION_BASE) / (1.0 - order0);
+    }
+}
+
+double entropy_renyi_to_hill_number(const double h){
+    return pow(LOGARITHMIC_BASE, h);
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include "cupt/parser.h"
+#include "cupt/constants.h"
+#include "cupt/extended_categories.h"
+
+int32_t create_token(struct token* const t, char* const id_raw, char* const form, char* const lemma, char* const upos, char* const xpos, char* const feats, char* const head, char* const deprel, char* const deps, char* const misc, char* const mwe){
+	memset(t->id_raw, '\0', TOKEN_ID_RAW_SIZE);
+	memset(t->form, '\0', TOKEN_FORM_SIZE);
+	memset(t->lemma, '\0', TOKEN_LEMMA_SIZE);
+	memset(t->upos, '\0', TOKEN_UPOS_SIZE);
+	memset(t->xpos, '\0', TOKEN_XPOS_SIZE);
+	memset(t->feats, '\0', TOKEN_FEATS_SIZE);
+	memset(t->head, '\0', TOKEN_HEAD_SIZE);
+	memset(t->deprel, '\0', TOKEN_DEPREL_SIZE);
+	memset(t->deps, '\0', TOKEN_DEPS_SIZE);
+	memset(t->misc, '\0', TOKEN_MISC_SIZE);
+	memset(t->mwe, '\0', TOKEN_MWE_SIZE);
+
+	strncpy(t->id_raw, id_raw, TOKEN_ID_RAW_SIZE - 1);
+	strncpy(t->form, form, TOKEN_FORM_SIZE - 1);
+	strncpy(t->lemma, lemma, TOKEN_LEMMA_SIZE - 1);
+	strncpy(t->upos, upos, TOKEN_UPOS_SIZE - 1);
+	strncpy(t->xpos, xpos, TOKEN_XPOS_SIZE - 1);
+	strncpy(t->feats, feats, TOKEN_FEATS_SIZE - 1);
+	strncpy(t->head, head, TOKEN_HEAD_SIZE - 1);
+	strncpy(t->deprel, deprel, TOKEN_DEPREL_SIZE - 1);
+	strncpy(t->deps, deps, TOKEN_DEPS_SIZE - 1);
+	strncpy(t->misc, misc, TOKEN_MISC_SIZE - 1);
+	strncpy(t->mwe, mwe, TOKEN_MWE_SIZE - 1);
+
+	return 0;
+}
+
+int32_t serialize_token(struct token* const t, char* const bfr, int32_t* const bytes_written, const int8_t null_terminate){
+	size_t offset = 0;
+	size_t length = 0;
+
+	length = strlen(t->id_raw);
+	strcpy(&(bfr[offset]), t->id_raw);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->form);
+	strcpy(&(bfr[offset]), t->form);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->lemma);
+	strcpy(&(bfr[offset]), t->lemma);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->upos);
+	strcpy(&(bfr[offset]), t->upos);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->xpos);
+	strcpy(&(bfr[offset]), t->xpos);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->feats);
+	strcpy(&(bfr[offset]), t->feats);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->head);
+	strcpy(&(bfr[offset]), t->head);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->deprel);
+	strcpy(&(bfr[offset]), t->deprel);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->deps);
+	strcpy(&(bfr[offset]), t->deps);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->misc);
+	strcpy(&(bfr[offset]), t->misc);
+	offset += length;
+	bfr[offset] = '\t';
+	offset++;
+
+	length = strlen(t->mwe);
+	strcpy(&(bfr[offset]), t->mwe);
+	offset += length;
+	if(null_terminate){
+		bfr[offset] = '\0';
+		offset++;
+	}
+
+	(*bytes_written) = (int32_t) offset;
+
+	return 0;
+}
+
+
+/* ======== SENTENCE ======== */
+
+int32_t create_sentence(struct sentence* const s, const char* const sentence_id){
+	void* malloc_pointer;
+
+	memset(s->sentence_id, '\0', SENTENCE_SENT_ID_SIZE);
+
+	strncpy(s->sentence_id, sentence_id, SENTENCE_SENT_ID_SIZE - 1);
+
+	size_t malloc_size = SENTENCE_TOKEN_CAPACITY_STEP * sizeof(struct token);
+	malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	s->tokens = (struct token*) malloc_pointer;
+	s->capacity = SENTENCE_TOKEN_CAPACITY_STEP;
+	s->num_tokens = 0;
+
+	if(s->tokens == NULL){
+		printf("(create_sentence) s->tokens == NULL\n");
+		exit(1);
+	}
+
+	return 0;
+}
+
+int32_t recreate_sentence(struct sentence* const s, const char* const sentence_id){
+	memset(s->sentence_id, '\0', SENTENCE_SENT_ID_SIZE);
+
+	strncpy(s->sentence_id, sentence_id, SENTENCE_SENT_ID_SIZE - 1);
+
+	const size_t malloc_size = SENTENCE_TOKEN_CAPACITY_STEP * sizeof(struct token);
+	if(s->tokens == NULL){
+		printf("s->tokens == NULL\n");
+		printf("s->sentence_id: %s\n", s->sentence_id);
+		exit(1);
+		/* // do not remove
+		void* malloc_pointer = malloc(malloc_size);
+		if(malloc_pointer == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+		printf("malloc: %p\n", malloc_pointer);
+		s->tokens = (struct token*) malloc_pointer;
+		*/
+	} else {
+		s->tokens = (struct token*) realloc((void*) s->tokens, malloc_size);
+		if(s->tokens == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+	}
+	memset(s->tokens, '\0', malloc_size);
+	s->capacity = SENTENCE_TOKEN_CAPACITY_STEP;
+	s->num_tokens = 0;
+
+	/*
+	if(s->tokens == NULL){
+		printf("(recreate_sentence) s->tokens == NULL\n");
+		exit(1);
+	}
+	*/
+
+	return 0;
+}
+
+void free_sentence(struct sentence* const s){
+	free(s->tokens);
+        s->tokens = NULL;
+}
+
+int32_t add_token_to_sentence(struct sentence* const s, struct token* const t){
+	if(s->num_tokens >= s->capacity){
+		size_t new_size = (size_t) ((((size_t) s->capacity) + SENTENCE_TOKEN_CAPACITY_STEP) * sizeof(struct token)); // compliance
+		s->tokens = realloc(s->tokens, new_size);
+		if(s->tokens == NULL){
+			perror("realloc failed\n");
+			return 1;
+		}
+		memset(&(s->tokens[s->capacity]), '\0', (size_t) (new_size - (((size_t) s->capacity) * sizeof(struct token))));
+		s->capacity += SENTENCE_TOKEN_CAPACITY_STEP;
+	}
+	s->tokens[s->num_tokens] = *t;
+	s->num_tokens++;
+	return 0;
+}
+
+size_t buffer_size_for_serialization_of_sentence(struct sentence* const s){
+	size_t output = 0;
+	output += 10; /* # sent_id= */
+	output += SENTENCE_SENT_ID_SIZE;
+	output += sizeof(struct token) * ((size_t) s->num_tokens);
+	return output;
+}
+
+int32_t serialize_sentence(struct sentence* const s, char* const bfr, int32_t* const bytes_written){
+	size_t offset = 0;
+	size_t length = 0;
+	char* sent_id_init = "# sent_id=";
+	int32_t bytes_written_by_token = 0;
+	int32_t err = 0;
+
+	length = strlen(sent_id_init);
+	strcpy(&(bfr[offset]), sent_id_init);
+	offset += length;
+
+	length = strlen(s->sentence_id);
+	strcpy(&(bfr[offset]), s->sentence_id);
+	offset += length;
+
+	bfr[offset] = '\n';
+	offset++;
+	for(int32_t i = 0 ; i < s->num_tokens ; i++){
+		err = serialize_token(&(s->tokens[i]), &(bfr[offset]), &bytes_written_by_token, i == s->num_tokens - 1);
+		if(err != 0){
+			perror("failed to serialize token during sentence serialization\n");
+			return 1;
+		}
+		offset += (size_t) bytes_written_by_token;
+		bfr[offset] = '\n';
+		offset++;
+	}
+
+	(*bytes_written) = (int32_t) offset;
+
+	return 0;
+}
+
+/* ======== FILE READER ======= */
+
+int32_t create_cupt_sentence_iterator(struct cupt_sentence_iterator* const csi, const char* const file_name, char * const ec_cfg){
+	int32_t err = 0;
+
+	FILE* fp;
+    if(strcmp(file_name, "-") == 0){
+        fp = stdin;
+    } else {
+        fp = fopen(file_name, "r");
+    }
+	if(fp == NULL){
+		perror("failed to open file\n");
+		printf("errno: %i\n", errno);
+		return 1;
+	}
+	csi->file_ptr = fp;
+	csi->file_is_open = 1;
+	csi->file_is_done = 0;
+	memset(csi->bfr_read, '\0', FILE_READ_BUFFER_SIZE);
+
+	memset(&(csi->current_sentence), '\0', sizeof(struct sentence));
+
+	csi->current_sentence.tokens = NULL;
+	
+	err = create_sentence(&(csi->current_sentence), "default_sentence");
+	if(err != 0){
+		perror("failed to create default_sentence in create_cupt_sentence_iterator\n");
+		return 1;
+	}
+
+	csi->sentence_to_free = 1;
+
+        csi->ec_cfg = ec_cfg;
+
+	return 0;
+}
+
+void free_cupt_sentence_iterator(struct cupt_sentence_iterator* const csi){
+	free_sentence(&(csi->current_sentence));
+	if(csi->file_ptr != stdin){fclose(csi->file_ptr);}
+}
+
+int32_t iterate_cupt_sentence_iterator(struct cupt_sentence_iterator* const restrict csi){
+	printf("starting iterate_cupt_sentence_iterator\n");
+
+	if(csi->current_sentence.tokens == NULL){
+		printf("csi->current_sentence.tokens == NULL\n");
+		exit(1);
+	}
+
+
+	const char* sent_id_pattern = "# sent_id = ";
+	const size_t sent_id_pattern_len = strlen(sent_id_pattern);
+	const char* source_sent_id_pattern = "# source_sent_id = ";
+	const size_t source_sent_id_pattern_len = strlen(source_sent_id_pattern);
+
+	int32_t err = 0;
+	void* strstr_ptr;
+	char new_sent_id[SENTENCE_SENT_ID_SIZE];
+
+	memset(new_sent_id, '\0', SENTENCE_SENT_ID_SIZE);
+
+	while(fgets(csi->bfr_read, FILE_READ_BUFFER_SIZE, csi->file_ptr)){
+		strstr_ptr = strstr(csi->bfr_read, sent_id_pattern);
+		int64_t len_to_consider;
+		if(strstr_ptr == NULL){
+			strstr_ptr = strstr(csi->bfr_read, source_sent_id_pattern);
+			if(strstr_ptr == NULL){
+				continue;
+			}
+			len_to_consider = (int64_t) source_sent_id_pattern_len; // compliance
+		} else {
+			len_to_consider = (int64_t) sent_id_pattern_len; // compliance
+		}
+		char* p_null = strchr(&(csi->bfr_read[len_to_consider]), '\0');
+		char* p_linefeed = strchr(&(csi->bfr_read[len_to_consider]), '\n');
+		size_t bytes_to_cpy = (size_t) (p_null - &(csi->bfr_read[len_to_consider]));
+		if(p_linefeed < p_null){
+			bytes_to_cpy = (size_t) (p_linefeed - &(csi->bfr_read[len_to_consider]));
+		}
+		if(SENTENCE_SENT_ID_SIZE - 1 < bytes_to_cpy){
+			bytes_to_cpy = SENTENCE_SENT_ID_SIZE - 1;
+		}
+		strncpy(new_sent_id, &(csi->bfr_read[len_to_consider]), bytes_to_cpy);
+		break;
+	}
+	err = recreate_sentence(&(csi->current_sentence), new_sent_id);
+	if(err != 0){
+		perror("failed to create sentence in file parsing\n");
+		return 1;
+	}
+
+	char id_raw[TOKEN_ID_RAW_SIZE];
+	char form[TOKEN_FORM_SIZE];
+	char lemma[TOKEN_LEMMA_SIZE];
+	char upos[TOKEN_UPOS_SIZE];
+	char xpos[TOKEN_XPOS_SIZE];
+	char feats[TOKEN_FEATS_SIZE];
+	char head[TOKEN_HEAD_SIZE];
+	char deprel[TOKEN_DEPREL_SIZE];
+	char deps[TOKEN_DEPS_SIZE];
+	char misc[TOKEN_MISC_SIZE];
+	char mwe[TOKEN_MWE_SIZE];
+	memset(id_raw, '\0', TOKEN_ID_RAW_SIZE);
+	memset(form, '\0', TOKEN_FORM_SIZE);
+	memset(lemma, '\0', TOKEN_LEMMA_SIZE);
+	memset(upos, '\0', TOKEN_UPOS_SIZE);
+	memset(xpos, '\0', TOKEN_XPOS_SIZE);
+	memset(feats, '\0', TOKEN_FEATS_SIZE);
+	memset(head, '\0', TOKEN_HEAD_SIZE);
+	memset(deprel, '\0', TOKEN_DEPREL_SIZE);
+	memset(deps, '\0', TOKEN_DEPS_SIZE);
+	memset(misc, '\0', TOKEN_MISC_SIZE);
+	memset(mwe, '\0', TOKEN_MWE_SIZE);
+
+	int32_t current_column = 0;
+	int32_t current_index_in_column = 0;
+	int32_t column_sizes[11] = {TOKEN_ID_RAW_SIZE, TOKEN_FORM_SIZE, TOKEN_LEMMA_SIZE, TOKEN_UPOS_SIZE, TOKEN_XPOS_SIZE, TOKEN_FEATS_SIZE, TOKEN_HEAD_SIZE, TOKEN_DEPREL_SIZE, TOKEN_DEPS_SIZE, TOKEN_MISC_SIZE, TOKEN_MWE_SIZE};
+	char* columns[11] = {id_raw, form, lemma, upos, xpos, feats, head, deprel, deps, misc, mwe};
+
+	// printf("number of columns: %li\n", sizeof(column_sizes) / sizeof(column_sizes[0]));
+
+	int8_t previous_line_finished = 1;
+	if(feof(csi->file_ptr)){
+		csi->file_is_done = 1;
+		return 0;
+	}
+	int8_t currently_in_text_line = 0;
+	while(fgets(csi->bfr_read, FILE_READ_BUFFER_SIZE, csi->file_ptr)){
+		if(previous_line_finished && (csi->bfr_read[0] == '\n' || csi->bfr_read[0] == '\r')){
+			break;
+		}
+		if(currently_in_text_line == 1){
+			for(int32_t i = 0 ; i < FILE_READ_BUFFER_SIZE ; i++){
+				if(csi->bfr_read[i] == '\0'){
+					break;
+				}
+				if(csi->bfr_read[i] == '\r' || csi->bfr_read[i] == '\n'){
+					currently_in_text_line = 0;
+					break;
+				}
+			}
+			memset(csi->bfr_read, '\0', FILE_READ_BUFFER_SIZE);
+			continue;
+		}
+		if(strncmp(csi->bfr_read, "# text =", strlen("# text =")) == 0 || strncmp(csi->bfr_read, "# text=", strlen("# text=")) == 0 || strncmp(csi->bfr_read, "# text_en =", strlen("# text_en =")) == 0 || strncmp(csi->bfr_read, "# text_en=", strlen("# text_en=")) == 0){
+			if(strchr(csi->bfr_read, '\n') != NULL || strchr(csi->bfr_read, '\r') != NULL){
+				currently_in_text_line = 0;
+			} else {
+				currently_in_text_line = 1;
+			}
+			memset(csi->bfr_read, '\0', FILE_READ_BUFFER_SIZE);
+			continue;
+		}
+		if(previous_line_finished && csi->bfr_read[0] == '#'){ // filtering out non-standard metadata lines
+			while(1){
+				size_t local_len = strlen(csi->bfr_read);
+				if(csi->bfr_read[local_len - 1] == '\n'){break;}
+				memset(csi->bfr_read, '\0', FILE_READ_BUFFER_SIZE);
+				if(feof(csi->file_ptr) || fgets(csi->bfr_read, FILE_READ_BUFFER_SIZE, csi->file_ptr) == 0){break;}
+			}
+			// previous_line_finished = 1; // useless?
+			continue;
+		}
+
+		previous_line_finished = 0;
+		int32_t i = 0;
+		while(i < FILE_READ_BUFFER_SIZE){
+			if(csi->bfr_read[i] == '\0'){break;}
+
+			int32_t unicode_length = 1;
+			if(((unsigned char) csi->bfr_read[i]) >= 240){unicode_length = 4;} // 0b11110000
+			else if(((unsigned char) csi->bfr_read[i]) >= 224){unicode_length = 3;} // 0b11100000
+			else if(((unsigned char) csi->bfr_read[i]) >= 192){unicode_length = 2;} // 0b11000000
+			else {unicode_length = 1;}
+
+			if(unicode_length == 1){
+				if(csi->bfr_read[i] == '\t'){
+					current_column++;
+					if(current_column >= (int32_t) (sizeof(column_sizes) / sizeof(column_sizes[0]))){
+						printf("Failed to parse a token correctly (sent_id=%s)\n", csi->current_sentence.sentence_id);
+						current_column = 0;
+						current_index_in_column = 0;
+						previous_line_finished = 1; // ?
+						break;
+					}
+					current_index_in_column = 0;
+				} else if(csi->bfr_read[i] == '\r' || csi->bfr_read[i] == '\n'){
+					struct token t;
+
+					/*
+					if(current_column != sizeof(column_sizes) / sizeof(column_sizes[0])){
+						perror("Failed to parse a token\n");
+						i += unicode_length;
+					}
+					*/
+
+					if(current_column >= 9){
+						err = create_token(&t, id_raw, form, lemma, upos, xpos, feats, head, deprel, deps, misc, mwe);
+						if(err != 0){
+							perror("failed to create token in parsing\n");
+							return 1;
+						}
+						err = add_token_to_sentence(&(csi->current_sentence), &t);
+						if(err != 0){
+							perror("failed to add token to sentence in parsing\n");
+							return 1;
+						}
+					} else {
+						fprintf(stderr, "Failed to parse a token; current_column (%i) < 9; csi->bfr_read: %s\n", current_column, csi->bfr_read);
+					}					
+
+					memset(id_raw, '\0', TOKEN_ID_RAW_SIZE);
+					memset(form, '\0', TOKEN_FORM_SIZE);
+					memset(lemma, '\0', TOKEN_LEMMA_SIZE);
+					memset(upos, '\0', TOKEN_UPOS_SIZE);
+					memset(xpos, '\0', TOKEN_XPOS_SIZE);
+					memset(feats, '\0', TOKEN_FEATS_SIZE);
+					memset(head, '\0', TOKEN_HEAD_SIZE);
+					memset(deprel, '\0', TOKEN_DEPREL_SIZE);
+					memset(deps, '\0', TOKEN_DEPS_SIZE);
+					memset(misc, '\0', TOKEN_MISC_SIZE);
+					memset(mwe, '\0', TOKEN_MWE_SIZE);
+	
+					current_column = 0;
+					current_index_in_column = 0;
+					previous_line_finished = 1;
+				} else {
+					if(current_index_in_column < column_sizes[current_column] - 1){
+						columns[current_column][current_index_in_column] = csi->bfr_read[i];
+					}
+					current_index_in_column++;
+				}
+			} else {
+				if(current_index_in_column + (unicode_length - 1) < column_sizes[current_column] - 1 && i + unicode_length < FILE_READ_BUFFER_SIZE){
+					for(int32_t j = 0 ; j < unicode_length ; j++){
+						columns[current_column][current_index_in_column + j] = csi->bfr_read[i + j];
+					}
+				}
+				current_index_in_column += unicode_length;
+			}
+
+            if(unicode_length == 1 && csi->bfr_read[i] == '\r' && csi->bfr_read[i+1] == '\n'){i++;} // to handle CRLF
+			i += unicode_length;
+		}
+		memset(csi->bfr_read, '\0', FILE_READ_BUFFER_SIZE);
+	}
+
+	csi->sentence_to_free = 1;
+
+	if(feof(csi->file_ptr)){
+		csi->file_is_done = 1;
+	}
+
+	printf("finished first part of iterate_cupt_sentence_iterator\n");
+
+        // ========================================
+
+#if TOKENIZATION_METHOD != 0
+        if(csi->ec_cfg != NULL){
+	  /*
+          if(recreate_sentence(&(csi->current_sentence), csi->current_sentence.sentence_id) != 0){
+            perror("Failed to call recreate_sentence\n");
+            return 1;
+          }
+	  */
+
+
+	  // first transform it to conllu
+
+
+          const size_t bfr_size_tsv = 1024;
+          char * tsv = malloc(bfr_size_tsv);
+          if(tsv == NULL){perror("malloc failed\n"); return 1;}
+          memset(tsv, '\0', bfr_size_tsv);
+          cupt_ec_process_sentence(csi, &tsv, bfr_size_tsv);
+
+          FILE * result = fopen(tsv, "r");
+          if(result == NULL){
+            fprintf(stderr, "Failed to open \"%s\"\n", tsv);
+            free(tsv);
+            return 1;
+          }
+
+          // int32_t col_tree = -1;
+          // int32_t col_abs_freq = -1;
+
+          // parse header
+          
+          int8_t is_header = 1;
+          char * tree = NULL;
+          char * abs_freq = NULL;
+
+          uint64_t id_count = 0;
+
+          const size_t bfr_read_size = 65536;
+          char * bfr_read = malloc(bfr_read_size);
+          char * fgets_result = NULL;
+          do {
+            memset(bfr_read, '\0', bfr_read_size);
+            fgets_result = fgets(bfr_read, bfr_read_size, result);
+            if(is_header){
+              for(size_t i = 0 ; i < bfr_read_size ; i++){
+                if(bfr_read[i] == '\n'){
+                  is_header = 0;
+                  break;
+                }
+                if(bfr_read[i] == '\0'){break;}
+              }
+            } else {
+              tree = strtok(bfr_read, "\t");
+	      if(tree == NULL){break;}
+              abs_freq = strtok(bfr_read, "\t");
+
+              tok_t tok = {};
+              char id_str[TOKEN_ID_RAW_SIZE];
+              memset(id_str, '\0', TOKEN_ID_RAW_SIZE);
+              snprintf(id_str, TOKEN_ID_RAW_SIZE, "%lu", id_count);
+              if(create_token(&tok, id_str, tree, "_", "_", "_", "_", "_", "_", "_", "_", "_") != 0){
+                perror("Failed to call create_token\n");
+                return 1;
+              }
+              int64_t freq = strtol(abs_freq, NULL, 10);
+              while(freq > 0){
+                if(add_token_to_sentence(&(csi->current_sentence), &tok) != 0){
+                  perror("Failed to call add_token_to_sentence\n");
+                  return 1;
+                }
+                id_count++;
+                freq--;
+              }
+
+
+
+
+
+              char * ptr = abs_freq;
+              while(*ptr != '\0' && *ptr != '\n'){ptr++;}
+              if(*ptr == '\0'){ptr++;}
+              while(1){
+                while(*ptr != '\0' && *ptr != '\n'){ptr++;}
+                char last_char = *ptr;
+                memset(bfr_read, '\0', bfr_read_size);
+                fgets_result = fgets(bfr_read, bfr_read_size, result);
+                if(last_char == '\n'){
+                  break;
+                }
+              }
+            }
+          } while(fgets_result != NULL);
+
+          free(bfr_read);
+          
+          fclose(result);
+          free(tsv);
+          tsv = NULL;
+          return 0;
+        }
+#endif
+
+        // ========================================
+
+	return 0;	
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "oov/counter.h"
+#include "cupt/parser.h"
+#include "cupt/load.h"
+#include "distributions.h"
+#include "measurement.h"
+#include "checkpoint.h"
+#include "recompute.h"
+#include "schedule.h"
+#include "logging.h"
+#include "unicode/utf8.h"
+
+int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char * const filename_tp, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, const char * const ec_cfg){
+    const int32_t log_bfr_size = 256;
+    char log_bfr[log_bfr_size];
+
+    struct cupt_sentence_iterator csi = {0};
+    struct cupt_sentence_iterator csi_tp = {0};
+    if(create_cupt_sentence_iterator(&csi, filename, ec_cfg) != 0){goto failure_create_cupt_sentence_iterator;}
+    if(filename_tp != NULL){
+        if(create_cupt_sentence_iterator(&csi_tp, filename_tp, ec_cfg) != 0){goto failure_create_cupt_sentence_iterator;}
+    }
+
+    int8_t found_at_least_one_mwe = 0;
+
+    // the sentences before the resume point were read by the run that wrote the checkpoint
+    if(sref->checkpoint != NULL){
+        int64_t offset = 0;
+        int64_t offset_tp = 0;
+        checkpoint_file_resume_point(sref->checkpoint, (int32_t) i, &offset, &offset_tp, &found_at_least_one_mwe);
+        if(offset > 0 && fseek(csi.file_ptr, (long) offset, SEEK_SET) != 0){goto failure_seek;}
+        if(filename_tp != NULL && offset_tp > 0 && fseek(csi_tp.file_ptr, (long) offset_tp, SEEK_SET) != 0){goto failure_seek;}
+    }
+
+    if(iterate_cupt_sentence_iterator(&csi) != 0){goto failure_iterate_cupt_sentence_iterator;}
+    if(filename_tp != NULL){if(iterate_cupt_sentence_iterator(&csi_tp) != 0){goto failure_iterate_cupt_sentence_iterator;}}
+
+    while(!(csi.file_is_done)){
+        const size_t max_mwe = 32;
+		const size_t max_tokens_per_mwe = 32;
+		const size_t size_token_mwe = 32;
+        const size_t size_mwe_class = 16;
+		size_t mwe_bfr_size = max_mwe * max_tokens_per_mwe * size_token_mwe;
+        size_t mwe_bfr_size_mwe_class = max_mwe * size_mwe_class;
+
+		char mwe[mwe_bfr_size];
+		memset(mwe, '\0', mwe_bfr_size);
+
+		char mwe_tp[mwe_bfr_size];
+		memset(mwe_tp, '\0', mwe_bfr_size);
+
+        char mwe_class[mwe_bfr_size_mwe_class];
+        memset(mwe_class, '\0', mwe_bfr_size_mwe_class);
+
+        /*
+        char mwe_class_tp[mwe_bfr_size_mwe_class];
+        memset(mwe_class_tp, '\0', mwe_bfr_size_mwe_class);
+        */
+
+		int32_t mwe_lengths[max_mwe];
+		memset(mwe_lengths, '\0', max_mwe * sizeof(int32_t));
+
+		int32_t mwe_tp_lengths[max_mwe];
+		memset(mwe_tp_lengths, '\0', max_mwe * sizeof(int32_t));
+
+		int8_t mwe_correct_span[max_mwe];
+		memset(mwe_correct_span, 1, max_mwe * sizeof(int8_t));
+
+		for(int32_t j = 0 ; j < csi.current_sentence.num_tokens ; j++){
+            if(mcfg->target_column == UD_MWE){
+				if(strcmp(csi.current_sentence.tokens[j].mwe, "") == 0 || strcmp(csi.current_sentence.tokens[j].mwe, "_") == 0 || strcmp(csi.current_sentence.tokens[j].mwe, "-") == 0 || strcmp(csi.current_sentence.tokens[j].mwe, "*") == 0){
+					continue;
+				}
+	
+				char* strtok_placeholder = NULL;
+				strtok_placeholder = strtok(csi.current_sentence.tokens[j].mwe, ";");
+				while(strtok_placeholder != NULL){
+					size_t mwe_num = (size_t) strtol(strtok_placeholder, NULL, 10);
+					if(mwe_num < max_mwe){
+						size_t bytes_to_cpy = strlen(csi.current_sentence.tokens[j].lemma);
+						if(bytes_to_cpy > size_token_mwe - 1){
+							bytes_to_cpy = size_token_mwe - 1;
+						}
+						memcpy(&(mwe[mwe_num * max_tokens_per_mwe * size_token_mwe + mwe_lengths[mwe_num] * size_token_mwe]), csi.current_sentence.tokens[j].lemma, bytes_to_cpy);
+						mwe_lengths[mwe_num]++;
+
+                        char * ptr_colon = strchr(strtok_placeholder, ':');
+                        if(ptr_colon != NULL){
+                            bytes_to_cpy = strlen(ptr_colon + 1);
+                            if(bytes_to_cpy > size_mwe_class - 1){bytes_to_cpy = size_mwe_class - 1;}
+                            memcpy(&(mwe_class[mwe_num * size_mwe_class]), ptr_colon + 1, bytes_to_cpy);
+                        }
+					}
+	
+                    /**/ // DO NOT REMOVE
+					if(filename_tp != NULL && (strcmp(csi_tp.current_sentence.tokens[j].mwe, "") == 0 || strcmp(csi_tp.current_sentence.tokens[j].mwe, "_") == 0 || strcmp(csi_tp.current_sentence.tokens[j].mwe, "-") == 0 || strcmp(csi_tp.current_sentence.tokens[j].mwe, "*") == 0)){
+						mwe_correct_span[mwe_num] = 0;
+					}
+                    /**/
+	
+					strtok_placeholder = strtok(NULL, ";");
+				}
+	
+				continue;
+			}
+
+
+
+
+    		int32_t index;
+    		const size_t key_size = 256;
+    		char key[key_size];
+    		memset(key, '\0', key_size);
+    		size_t len = 0;
+    		switch(mcfg->target_column){
+    			case UD_FORM:
+    				len = strlen(csi.current_sentence.tokens[j].form);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].form, len);
+    				break;
+    			case UD_LEMMA:
+    				len = strlen(csi.current_sentence.tokens[j].lemma);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].lemma, len);
+    				break;
+    			case UD_UPOS:
+    				len = strlen(csi.current_sentence.tokens[j].upos);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].upos, len);
+    				break;
+    			case UD_XPOS:
+    				len = strlen(csi.current_sentence.tokens[j].xpos);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].xpos, len);
+    				break;
+    			case UD_FEATS:
+    				len = strlen(csi.current_sentence.tokens[j].feats);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].feats, len);
+    				break;
+    			case UD_HEAD:
+    				len = strlen(csi.current_sentence.tokens[j].head);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].head, len);
+    				break;
+    			case UD_DEPREL:
+    				len = strlen(csi.current_sentence.tokens[j].deprel);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].deprel, len);
+    				break;
+    			case UD_DEPS:
+    				len = strlen(csi.current_sentence.tokens[j].deps);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].deps, len);
+    				break;
+    			case UD_MISC:
+    				len = strlen(csi.current_sentence.tokens[j].misc);
+    				if(len > key_size - 1){len = key_size - 1;}
+    				memcpy(key, csi.current_sentence.tokens[j].misc, len);
+    				break;
+    			default:
+    				index = -1;
+    				perror("target_column not properly defined\n");
+    				return 1;
+    		}
+
+            // UTF-8 normalisation
+
+            if(mcfg->enable_token_utf8_normalisation){
+                char * utf8_normalised_key = utf8_normalise(key);
+                if(utf8_normalised_key != key){
+                    // printf("Normalising \"%s\" to \"%s\"\n", key, utf8_normalised_key);
+                    size_t bytes_to_cpy = strlen(utf8_normalised_key);
+                    if(bytes_to_cpy > key_size - 1){bytes_to_cpy = key_size - 1;}
+                    memcpy(key, utf8_normalised_key, bytes_to_cpy);
+                    key[bytes_to_cpy] = '\0';
+                }
+            }
+
+            // retrieval in word2vec
+    
+			index = word2vec_key_to_index(sref->w2v, key);
+	
+			if(index != -1){
+				if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+					perror("failed to call graph_add_word2vec_occurrence\n");
+					return 1;
+				}
+				__atomic_fetch_add(&(sref->w2v->keys[index].num_occurrences), 1, __ATOMIC_RELAXED);
+			} else {
+                if(oov_counter_increment(sref->oov_discarded_because_not_in_vector_database, key) != 0){
+                    perror("failed to call oov_counter_increment\n");
+                    return 1;
+                }
+			}
+        }
+
+
+
+
+
+
+
+        // MWE
+
+        if(mcfg->target_column == UD_MWE){
+            uint8_t in_this_specific_sentence_found_at_least_one_correct_mwe = 0;
+            uint8_t in_this_specific_sentence_found_at_least_one_mwe = 0;
+			for(size_t k = 0 ; k < max_mwe ; k++){
+				if(mwe_lengths[k] == 0){
+					continue;
+				}
+                in_this_specific_sentence_found_at_least_one_mwe = 1;
+
+                /**/ // DO NOT REMOVE
+				if(filename_tp != NULL && !(mwe_correct_span[k])){
+					continue;
+				}
+                in_this_specific_sentence_found_at_least_one_correct_mwe = 1;
+                /**/
+
+				qsort(&(mwe[k * max_tokens_per_mwe * size_token_mwe]), mwe_lengths[k], size_token_mwe, void_strcmp);
+
+				const int32_t bfr_size = 512;
+				int32_t index_bfr = 0;
+				char bfr[bfr_size];
+				memset(bfr, '\0', bfr_size);
+
+				// memcpy(bfr + index_bfr, "_MWE_", 5);
+				// index_bfr += 5;
+				memcpy(bfr + index_bfr, "_MWE-", 5);
+				index_bfr += 5;
+
+                const size_t len_mwe_class = strlen(&(mwe_class[k * size_mwe_class]));
+                memcpy(bfr + index_bfr, &(mwe_class[k * size_mwe_class]), len_mwe_class);
+                index_bfr += len_mwe_class;
+
+                bfr[index_bfr] = '_';
+                index_bfr++;
+
+				size_t bytes_to_cpy = 0;
+				for(int32_t m = 0 ; m < mwe_lengths[k] ; m++){
+					bytes_to_cpy = strlen(&(mwe[k * max_tokens_per_mwe * size_token_mwe + m * size_token_mwe]));
+					if(m < mwe_lengths[k] - 1){
+						bytes_to_cpy++;
+					}
+					if(bytes_to_cpy > (size_t) (bfr_size - 1 - index_bfr)){
+						bytes_to_cpy = bfr_size - 1 - index_bfr;
+					}
+					if(m < mwe_lengths[k] - 1){
+						memcpy(bfr + index_bfr, &(mwe[k * max_tokens_per_mwe * size_token_mwe + m * size_token_mwe]), bytes_to_cpy - 1);
+						index_bfr += bytes_to_cpy - 1;
+						bfr[index_bfr] = '_';
+						index_bfr++;
+					} else {
+						memcpy(bfr + index_bfr, &(mwe[k * max_tokens_per_mwe * size_token_mwe + m * size_token_mwe]), bytes_to_cpy);
+						index_bfr += bytes_to_cpy;
+					}
+				}
+
+                // printf("created key: %s\n", bfr);
+
+                // pthread_mutex_lock(&sref->w2v->mutex);
+				int32_t index = word2vec_key_to_index(sref->w2v, bfr);
+				if(index != -1){
+					found_at_least_one_mwe = 1;
+                    
+					if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+						perror("failed to call graph_add_word2vec_occurrence\n");
+						return 1;
+					}
+					__atomic_fetch_add(&(sref->w2v->keys[index].num_occurrences), 1, __ATOMIC_RELAXED);
+				} else {
+                    if(oov_counter_increment(sref->oov_discarded_because_not_in_vector_database, bfr) != 0){
+                        perror("failed to call oov_counter_increment\n");
+                        return 1;
+                    }
+				}
+                // pthread_mutex_unlock(&sref->w2v->mutex);
+			}
+
+            /*
+			if(found_at_least_one_mwe){ // for efficient recomputation
+                pthread_mutex_lock(&mmut->mutex);
+				// mmut->sentence.num_all++;
+                pthread_mutex_unlock(&mmut->mutex);
+			}
+            */
+            if(in_this_specific_sentence_found_at_least_one_mwe){
+                pthread_mutex_lock(&mmut->mutex);
+                mmut->sentence.num_containing_mwe++;
+                if(in_this_specific_sentence_found_at_least_one_correct_mwe){
+                    mmut->sentence.num_containing_mwe_tp_only++;
+                }
+                pthread_mutex_unlock(&mmut->mutex);
+            }
+		}
+
+
+
+
+
+
+
+
+
+
+
+
+        pthread_mutex_lock(&mmut->mutex);
+        pthread_mutex_lock(&sref->g->mutex_nodes);
+		// sentence level recomputation
+		// if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.sentence.enable_count_recompute_step && (((!mcfg->steps.sentence.use_log10) && mmut->sentence.num % mcfg->steps.sentence.recompute_step == 0) || (mcfg->steps.sentence.use_log10 && mmut->sentence.num >= mmut->sentence.count_target))) && sref->g->num_nodes > 1){ // DO NOT REMOVE
+		if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.sentence.enable_count_recompute_step && (((!mcfg->steps.sentence.use_log10) && (!mcfg->steps.sentence.use_adaptive) && mmut->sentence.num_all % mcfg->steps.sentence.recompute_step == 0) || ((mcfg->steps.sentence.use_log10 || mcfg->steps.sentence.use_adaptive) && mmut->sentence.num_all >= mmut->sentence.count_target))) && sref->g->num_nodes > 1){
+			// printf("found_at_least_one_mwe: %i; g->num_nodes: %lu\n", found_at_least_one_mwe, sref->g->num_nodes);
+                    memset(log_bfr, '\0', log_bfr_size);
+			snprintf(log_bfr, log_bfr_size, "found_at_least_one_mwe: %i; g->num_nodes: %lu", found_at_least_one_mwe, sref->g->num_nodes);
+                    info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+                    if(sref->recompute != NULL){
+                        if(recompute_worker_submit(sref->recompute, i, sref->g, mmut, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), 0) != 0){
+                            perror("failed to call recompute_worker_submit\n");
+                            goto panic_exit;
+                        }
+                    } else {
+                        mmut->num_oov_types = oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database);
+                        if(compute_graph_relative_proportions(sref->g) != 0 || measurement_recompute_step(i, mcfg, sref, mmut, 0) != 0){
+                            perror("failed to call measurement_recompute_step\n");
+                            goto panic_exit;
+                        }
+                    }
+
+			if(mcfg->steps.sentence.use_adaptive){
+				mmut->sentence.count_target = recompute_schedule_next(sref->schedule, &(sref->schedule->sentence), mmut->sentence.num_all, sref->g->num_nodes, recompute_schedule_now(), sref->recompute == NULL, mcfg->steps.sentence.use_log10 ? mcfg->steps.sentence.recompute_step_log10 : 0.0);
+                        memset(log_bfr, '\0', log_bfr_size);
+				snprintf(log_bfr, log_bfr_size, "New sentence count target: %lu (adaptive)", mmut->sentence.count_target);
+                        info_format(__FILE__, __func__, __LINE__, log_bfr);
+			} else if(mcfg->steps.sentence.use_log10){
+				mmut->sentence.stacked_log += mcfg->steps.sentence.recompute_step_log10;
+				mmut->sentence.count_target = (uint64_t) floor(pow(10.0, mmut->sentence.stacked_log));
+                        memset(log_bfr, '\0', log_bfr_size);
+				snprintf(log_bfr, log_bfr_size, "New sentence count target: %lu (10.0^%.3f)", mmut->sentence.count_target, mmut->sentence.stacked_log);
+                        info_format(__FILE__, __func__, __LINE__, log_bfr);
+			}
+        }
+        pthread_mutex_unlock(&sref->g->mutex_nodes);
+
+        mmut->sentence.num_all++;
+
+        pthread_mutex_unlock(&mmut->mutex);
+
+        if(sref->checkpoint != NULL){checkpoint_unit_done(sref->checkpoint, (int32_t) i, (int64_t) ftell(csi.file_ptr), filename_tp != NULL ? (int64_t) ftell(csi_tp.file_ptr) : -1, found_at_least_one_mwe);}
+
+
+        if(iterate_cupt_sentence_iterator(&csi) != 0){goto failure_iterate_cupt_sentence_iterator;}
+        if(filename_tp != NULL){if(iterate_cupt_sentence_iterator(&csi_tp) != 0){goto failure_iterate_cupt_sentence_iterator;}}
+    }
+
+    free_cupt_sentence_iterator(&csi);
+    if(filename_tp != NULL){free_cupt_sentence_iterator(&csi_tp);}
+
+    return 0;
+
+    failure_iterate_cupt_sentence_iterator:
+    perror("failed to call iterate_cupt_sentence_iterator\n");
+    goto panic_exit;
+
+    failure_seek:
+    fprintf(stderr, "failed to seek to the resume point of %s\n", filename);
+    goto panic_exit;
+
+    failure_create_cupt_sentence_iterator:
+    perror("failed to call create_cupt_sentence_iterator\n");
+
+    panic_exit:
+
+    free_cupt_sentence_iterator(&csi);
+    if(filename_tp != NULL){free_cupt_sentence_iterator(&csi_tp);}
+
+    return 1;
+}
+
+void * cupt_to_graph_thread(void * args){
+    if(cupt_to_graph(
+        ((struct measurement_file_thread *) args)->i,
+        ((struct measurement_file_thread *) args)->filename,
+        ((struct measurement_file_thread *) args)->filename_tp,
+        ((struct measurement_file_thread *) args)->mcfg,
+        ((struct measurement_file_thread *) args)->sref,
+        ((struct measurement_file_thread *) args)->mmut,
+        ((struct measurement_file_thread *) args)->ec_cfg
+    ) != 0){
+        perror("Failed to call cupt_to_graph in cupt_to_graph_thread\n");
+        exit(1);
+    }
+    return NULL;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+extern int pclose (FILE *__stream); // somehow not detected
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/types.h> // ?
+#include <sys/stat.h>
+#include <unistd.h> // ?
+#if TOKENIZATION_METHOD == 0
+#include <regex.h>
+#endif
+
+#include "jsonl/constants.h"
+#include "sorted_array/array.h"
+#include "sanitize.h"
+#if (TOKENIZATION_METHOD == 1 || TOKENIZATION_METHOD == 2)
+#include "udpipe/interface/cinterface.h" // external declarations
+#include "udpipe/interface/conversion.h" // transformation to pipes
+#endif
+
+#include "jsonl/parser.h"
+
+#if TOKENIZATION_METHOD == 0
+// const char* const REGEX_STD_PATTERN = "[a-zéèêàç\\-]+'?|[\\.\\-,;:!\\?]";
+// const char* const REGEX_STD_PATTERN = "([a-zéèêàç\\-]+'?)|[\\.\\-,;:!\\?]";
+// const char* const REGEX_STD_PATTERN = "([a-zéèêàç\\-]+'?)|[,;:!\\?]"; // works
+// const char* const REGEX_STD_PATTERN = "[a-zéèêàç\\-]+'?|[,;:!\\?]"; // works but not for accents?
+// const char* const REGEX_STD_PATTERN = "[^\\s]+"; // approximate but faster
+// const char* const REGEX_STD_PATTERN = "\\S(\\B\\S)*"; // slower
+// const char* const REGEX_STD_PATTERN = "[a-z]+";
+// const char* const REGEX_STD_PATTERN = "[^ \t\r\n]+'?"; // working?
+const char* const REGEX_STD_PATTERN = "[^ \t\r\n,;:!\\?\\./']+'?";
+const size_t NMATCH = 1;
+// const size_t NMATCH = 2;
+const int32_t REGEX_FLAGS = REG_EXTENDED | REG_ICASE;
+#elif TOKENIZATION_METHOD == 1
+const char* udpipe_repo_directory = "./udpipe";
+const char* udpipe_model_directory = "./udpipe/sandbox_models";
+const char* udpipe_model_name = "english-ewt-ud-2.5-191206.udpipe";
+// const char* udpipe_model_name = "french-sequoia-ud-2.5-191206.udpipe";
+#define UDPIPE_PATH_BUFFER_SIZE 1024
+static char udpipe_binary_path[UDPIPE_PATH_BUFFER_SIZE];
+static char udpipe_model_path[UDPIPE_PATH_BUFFER_SIZE];
+static char* udpipe_coprocess_argv[] = {udpipe_binary_path, "--tokenize", "--immediate", "--output=vertical", udpipe_model_path, NULL};
+#elif TOKENIZATION_METHOD == 2
+#else
+	#error "Unknown TOKENIZATION_METHOD"
+#endif
+
+void jsonl_init_tokenization(const int32_t num_workers){
+	#if TOKENIZATION_METHOD != 1
+	(void) num_workers;
+	#else
+	const int32_t bfr_size = 256;
+	char bfr[bfr_size];
+	memset(bfr, '\0', bfr_size);
+	printf("UDPipe initialization ...\n");
+	printf("Checking repository ...\n");
+	snprintf(bfr, bfr_size, "if [ -d \"%s\" ]; then\ncurrentdirectory=$(pwd)\ncd %s\ngit pull\ncd src\nmake\ncd $currentdirectory\nelse\ngit clone https://github.com/ufal/udpipe %s\ncurrentdirectory=$(pwd)\ncd udpipe/src\nmake\ncd $currentdirectory\nfi\n", udpipe_repo_directory, udpipe_repo_directory, udpipe_repo_directory);
+	// printf("trying to run: %s\n", bfr);
+	if(system(bfr) != 0){goto system_failure;}
+	printf("Creating model directory ...\n");
+
+	struct stat local_st = (struct stat) {};
+	if(stat(udpipe_model_directory, &local_st) == -1){
+		if(mkdir(udpipe_model_directory, 0664) != 0){
+			fprintf(stderr, "failed to create %s\n", udpipe_model_directory);
+			exit(1);
+		}
+	}
+
+	snprintf(udpipe_binary_path, UDPIPE_PATH_BUFFER_SIZE, "%s/src/udpipe", udpipe_repo_directory);
+	snprintf(udpipe_model_path, UDPIPE_PATH_BUFFER_SIZE, "%s/%s", udpipe_model_directory, udpipe_model_name);
+	if(udpipe_coprocess_pool_create(udpipe_coprocess_argv, num_workers) != 0){
+		fprintf(stderr, "Failed to start UDPipe processes: %s\n", udpipe_binary_path);
+		exit(1);
+	}
+
+	return;
+
+	system_failure:
+		fprintf(stderr, "Failed to launch process: %s\n", bfr);
+		exit(1);
+	#endif
+}
+
+void jsonl_free_tokenization(void){
+	#if TOKENIZATION_METHOD == 1
+	udpipe_coprocess_pool_free();
+	#endif
+}
+
+#if (TOKENIZATION_METHOD == 1 || TOKENIZATION_METHOD == 2)
+int32_t launch_udpipe(struct document* const doc){
+	#if TOKENIZATION_METHOD == 1
+	if(doc->coprocess == NULL){
+		doc->coprocess = udpipe_coprocess_pool_acquire();
+	}
+	if(udpipe_coprocess_submit(doc->coprocess, doc->text, doc->text_size) != 0){
+		fprintf(stderr, "Failed to submit document to UDPipe: %s\n", udpipe_binary_path);
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
+		return 1;
+	}
+	#elif TOKENIZATION_METHOD == 2
+	const char* const texts[1] = {doc->text};
+	if(udpipe_pool_process_batch(texts, 1, &(doc->tokens)) != 0){
+		perror("Failed to call udpipe_pool_process_batch\n");
+		return 1;
+	}
+	doc->current_span = 0;
+	doc->tokenized = 1;
+	#endif
+	return 0;
+}
+#endif
+
+int32_t create_document(struct document* doc){
+	#if TOKENIZATION_METHOD == 1
+	/*
+	static uint32_t document_counter = 0;
+	if(document_counter < UINT32_MAX){
+		document_counter++;
+	} else {
+		perror("document_counter reached UINT32_MAX\n");
+		return 1;
+	}
+	*/
+	#endif
+
+	size_t malloc_size = JSONL_DOCUMENT_IDENTIFIER_DEFAULT_CAPACITY * sizeof(char);
+	doc->identifier = (char*) malloc(malloc_size);
+	if(doc->identifier == NULL){goto malloc_fail;}
+	memset(doc->identifier, '\0', malloc_size);
+	doc->identifier_capacity = JSONL_DOCUMENT_IDENTIFIER_DEFAULT_CAPACITY;
+	doc->identifier_size = 0;
+
+	malloc_size = JSONL_DOCUMENT_TEXT_DEFAULT_CAPACITY * sizeof(char);
+	doc->text = (char*) malloc(malloc_size);
+	if(doc->text == NULL){goto malloc_fail;}
+	memset(doc->text, '\0', malloc_size);
+	doc->text_capacity = JSONL_DOCUMENT_TEXT_DEFAULT_CAPACITY;
+	doc->text_size = 0;
+
+	#if TOKENIZATION_METHOD == 0
+	if(regcomp(&(doc->reg), REGEX_STD_PATTERN, REGEX_FLAGS) != 0){
+		perror("failed to call regcomp\n");
+		return 1;
+	}
+	doc->latest_rm_eo = 0;
+	#endif
+	doc->reached_last_token = 0;
+	doc->usable = 1;
+
+	memset(doc->current_token, '\0', JSONL_CURRENT_TOKEN_BUFFER_SIZE);
+
+	return 0;
+
+	malloc_fail:
+	if(doc->identifier != NULL){
+		free(doc->identifier);
+	}
+	perror("[err] failed to malloc\n");
+	return 1;
+}
+
+int32_t iterate_document_current_token(struct document* const doc){
+	#if TOKENIZATION_METHOD == 0
+	regmatch_t pmatch[NMATCH];
+	int32_t err = regexec(&(doc->reg), doc->text + doc->latest_rm_eo, NMATCH, pmatch, 0);
+	if(err == REG_NOMATCH){
+		doc->reached_last_token = 1;
+		return 0;
+	} else if(err != 0){
+		perror("failed to call regexec\n");
+		return 1;
+	}
+	size_t len = pmatch[0].rm_eo - pmatch[0].rm_so;
+	size_t objective_eo = doc->latest_rm_eo + pmatch[0].rm_eo;
+	if(len > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){
+		len = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;
+	}
+	memcpy(doc->current_token, doc->text + doc->latest_rm_eo + pmatch[0].rm_so, len);
+	doc->current_token[len] = '\0';
+	doc->latest_rm_eo = objective_eo;
+	return 0;
+	#elif TOKENIZATION_METHOD == 2
+	if(!doc->tokenized){
+		if(launch_udpipe(doc) != 0){
+			perror("failed to call launch_udpipe\n");
+			return 1;
+		}
+		doc->reached_last_token = 0;
+		doc->usable = 0;
+	}
+	if(doc->current_span == doc->tokens.num_spans){
+		doc->reached_last_token = 1;
+		doc->usable = 0;
+		doc->tokenized = 0;
+		return 0;
+	}
+	const struct udpipe_token_span span = doc->tokens.spans[doc->current_span];
+	size_t len = span.length;
+	if(len > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){
+		len = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;
+	}
+	memcpy(doc->current_token, doc->tokens.arena + span.offset, len);
+	doc->current_token[len] = '\0';
+	doc->current_span++;
+	return 0;
+	#elif TOKENIZATION_METHOD == 1
+	if(doc->coprocess == NULL){
+		if(launch_udpipe(doc) != 0){
+			perror("failed to call launch_udpipe\n");
+			return 1;
+		}
+		doc->reached_last_token = 0;
+		doc->usable = 0;
+	}
+	int8_t end_of_document = 0;
+	if(udpipe_coprocess_next_token(doc->coprocess, doc->current_token, JSONL_CURRENT_TOKEN_BUFFER_SIZE, &end_of_document) != 0){
+		perror("failed to call udpipe_coprocess_next_token\n");
+		return 1;
+	}
+	if(end_of_document){
+		doc->reached_last_token = 1;
+		doc->usable = 0;
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
+	}
+	// printf("newly found token: %s\n", doc->current_token);
+	return 0;
+	#endif
+}
+
+
+// text of a document that does not come from a JSONL file, tokenized from its start on the next call of iterate_document_current_token
+int32_t document_set_text(struct document* const doc, const char* const text, const size_t text_size){
+	if(text_size + 1 > doc->text_capacity){
+		char* const realloc_pointer = realloc(doc->text, text_size + 1);
+		if(realloc_pointer == NULL){
+			perror("[err] failed to realloc\n");
+			return 1;
+		}
+		doc->text = realloc_pointer;
+		doc->text_capacity = text_size + 1;
+	}
+	memcpy(doc->text, text, text_size);
+	doc->text[text_size] = '\0';
+	doc->text_size = text_size;
+
+	#if TOKENIZATION_METHOD == 0
+	doc->latest_rm_eo = 0;
+	#elif TOKENIZATION_METHOD == 1
+	if(doc->coprocess != NULL){ // previous document not read until the end
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
+	}
+	#elif TOKENIZATION_METHOD == 2
+	doc->tokenized = 0;
+	#endif
+	doc->reached_last_token = 0;
+	doc->usable = 1;
+	return 0;
+}
+
+void free_document(struct document* doc){
+	free(doc->identifier);
+	free(doc->text);
+	#if TOKENIZATION_METHOD == 0
+	regfree(&(doc->reg));
+	#elif TOKENIZATION_METHOD == 1
+	if(doc->coprocess != NULL){
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
+	}
+	#elif TOKENIZATION_METHOD == 2
+	udpipe_tokens_free(&(doc->tokens));
+	#endif
+}
+
+int32_t jsonl_document_iterator_request_more_capacity_current_line(struct jsonl_document_iterator * const jdi){
+    const size_t new_capacity = jdi->current_line_capacity + JSONL_FILE_READ_BUFFER_SIZE;
+    const size_t alloc_size = new_capacity * sizeof(char);
+    void * realloc_ptr = realloc(jdi->current_line, alloc_size);
+    if(realloc_ptr == NULL){
+        perror("Failed to realloc\n");
+        return 1;
+    }
+    jdi->current_line = realloc_ptr;
+    memset(&(jdi->current_line[jdi->current_line_capacity]), '\0', JSONL_FILE_READ_BUFFER_SIZE * sizeof(char));
+
+    jdi->current_line_capacity = new_capacity;
+
+    return 0;
+}
+
+int32_t create_jsonl_document_iterator(struct jsonl_document_iterator* jdi, const char* file_name, const char* const content_key){
+    if(strcmp(file_name, "-") == 0){
+        jdi->file_ptr = stdin;
+    } else {
+	    jdi->file_ptr = fopen(file_name, "r");
+    }
+	if(jdi->file_ptr == NULL){
+		fprintf(stderr, "[err] failed to open file (%s); errno: %i\n", file_name, errno);
+		return 1;
+	}
+	jdi->file_is_open = 1;
+	jdi->file_is_done = 0;
+	memset(jdi->bfr_read, '\0', JSONL_FILE_READ_BUFFER_SIZE);
+	memset(jdi->content_key, '\0', JSONL_CONTENT_KEY_BUFFER_SIZE);
+	size_t bytes_to_cpy = strlen(content_key);
+	if(bytes_to_cpy > JSONL_CONTENT_KEY_BUFFER_SIZE - 1){
+		bytes_to_cpy = JSONL_CONTENT_KEY_BUFFER_SIZE - 1;
+	}
+	memcpy(jdi->content_key, content_key, bytes_to_cpy);
+
+	memset(&(jdi->current_document), '\0', sizeof(struct document));
+
+	if(create_document(&(jdi->current_document)) != 0){
+		perror("[err] failed to call create_document\n");
+		return 1;
+	}
+
+	jdi->document_to_free = 1;
+
+    const size_t alloc_size = JSONL_FILE_READ_BUFFER_SIZE * sizeof(char);
+    jdi->current_line = malloc(alloc_size);
+    if(jdi->current_line == NULL){
+        perror("Failed to malloc\n");
+        return 1;
+    }
+    memset(jdi->current_line, '\0', alloc_size);
+    jdi->current_line_cardinality = 0;
+    jdi->current_line_capacity = JSONL_FILE_READ_BUFFER_SIZE;
+
+	return 0;
+}
+
+void free_jsonl_document_iterator(struct jsonl_document_iterator* jdi){
+	free_document(&(jdi->current_document));
+	if(jdi->file_ptr != stdin){fclose(jdi->file_ptr);}
+    free(jdi->current_line);
+}
+
+int32_t iterate_jsonl_document_iterator(struct jsonl_document_iterator* restrict const jdi){
+	memset(jdi->bfr_read, '\0', JSONL_FILE_READ_BUFFER_SIZE);
+    memset(jdi->current_line, '\0', jdi->current_line_capacity); // cardinality instead?
+    jdi->current_line_cardinality = 0;
+
+	int8_t in_key = 0;
+	int8_t in_value = 0;
+	int8_t escape_char = 0;
+
+	char* key;
+	char* value;
+	int32_t key_size = 0;
+	int32_t value_size = 0;
+
+	const int32_t key_capacity_step = 16;
+	const int32_t value_capacity_step = 64;
+
+	int32_t key_capacity = key_capacity_step;
+	int32_t value_capacity = value_capacity_step;
+
+	int8_t colon_passed = 0;
+
+	int8_t in_brackets = 0;
+
+	#if TOKENIZATION_METHOD == 0
+	jdi->current_document.latest_rm_eo = 0;
+	#elif TOKENIZATION_METHOD == 1
+	if(jdi->current_document.coprocess != NULL){ // previous document not read until the end
+		udpipe_coprocess_pool_release(jdi->current_document.coprocess);
+		jdi->current_document.coprocess = NULL;
+	}
+	#elif TOKENIZATION_METHOD == 2
+	jdi->current_document.tokenized = 0;
+	#endif
+	jdi->current_document.reached_last_token = 0;
+	jdi->current_document.usable = 1;
+
+	size_t malloc_size = key_capacity * sizeof(char);
+	key = (char*) malloc(malloc_size);
+	if(key == NULL){goto malloc_fail;}
+	memset(key, '\0', malloc_size);
+
+	malloc_size = value_capacity * sizeof(char);
+	value = (char*) malloc(malloc_size);
+	if(value == NULL){goto malloc_fail;}
+	memset(value, '\0', malloc_size);
+
+	if(feof(jdi->file_ptr)){
+		jdi->file_is_done = 1;
+		jdi->current_document.usable = 0;
+		free(key);
+		free(value);
+		return 0;
+	}
+
+	while(fgets(jdi->bfr_read, JSONL_FILE_READ_BUFFER_SIZE, jdi->file_ptr) != NULL && strlen(jdi->bfr_read) != 0){
+        // update jdi current line
+        const size_t len_bfr_read = strlen(jdi->bfr_read);
+        if(jdi->current_line_cardinality + len_bfr_read + 1 >= jdi->current_line_capacity){
+            if(jsonl_document_iterator_request_more_capacity_current_line(jdi) != 0){
+                perror("Failed to call jsonl_document_iterator_request_more_capacity_current_line\n");
+                return 1;
+            }
+        }
+        memcpy(&(jdi->current_line[jdi->current_line_cardinality]), jdi->bfr_read, len_bfr_read);
+        jdi->current_line_cardinality += len_bfr_read;
+        
+
+		int32_t i = 0;
+		int32_t bytes_read = 0;
+		while(i < JSONL_FILE_READ_BUFFER_SIZE && jdi->bfr_read[i] != '\0'){
+
+            // update jdi current line
+            /*
+            if(jdi->current_line_cardinality >= jdi->current_line_capacity - 1){ // -1 to ensure null byte at the end
+                if(jsonl_document_iterator_request_more_capacity_current_line(jdi) != 0){
+                    perror("Failed to call jsonl_document_iterator_request_more_capacity_current_line\n");
+                    return 1;
+                }
+            }
+            jdi->current_line[jdi->current_line_cardinality] = jdi->bfr_read[i];
+            jdi->current_line_cardinality++;
+            */
+
+			bytes_read++;
+			if(jdi->bfr_read[i] == '\n'){
+				free(key);
+				free(value);
+				/* // DO NOT REMOVE
+				if(strcmp(key, "id") == 0){
+					printf("setting id: %s\n", value);
+					if(jdi->current_document.identifier != NULL){free(jdi->current_document.identifier);}
+					jdi->current_document.identifier = value;
+					jdi->current_document.identifier_size = value_size;
+					jdi->current_document.identifier_capacity = value_capacity;
+				} else if(strcmp(key, "text") == 0){
+					printf("setting text: %s\n", value);
+					if(jdi->current_document.text != NULL){free(jdi->current_document.text);}
+					jdi->current_document.text = value;
+					jdi->current_document.text_size = value_size;
+					jdi->current_document.text_capacity = value_capacity;
+				} else {
+					free(value);
+				}
+				free(key);
+				*/
+				if(feof(jdi->file_ptr)){
+					jdi->file_is_done = 1;
+				}
+
+                // memset(jdi->current_line, '\0', jdi->current_line_cardinality * sizeof(char)); // should not be here
+
+				return 0; // ?
+			}
+
+			if(in_brackets){
+				while(i < JSONL_FILE_READ_BUFFER_SIZE - 1 && (escape_char || jdi->bfr_read[i] != ']') && jdi->bfr_read[i] != '\0'){
+					if(escape_char){
+						escape_char = 0;
+						i++;
+					} else {
+						if(jdi->bfr_read[i] == '\\'){
+							i++;
+						}
+						i++;
+					}
+				}	
+				if(i < JSONL_FILE_READ_BUFFER_SIZE - 1 && jdi->bfr_read[i] == ']' && escape_char == 0){
+					in_brackets = 0;
+					in_value = 0;
+				}
+			} else if(in_key == 1){
+				if(escape_char){
+					if(key_size >= key_capacity - 1){
+						int32_t new_capacity = key_capacity + key_capacity_step;
+						size_t realloc_size = new_capacity * sizeof(char);
+						void * realloc_ptr = (char*) realloc(key, realloc_size);
+						if(realloc_ptr == NULL){goto realloc_fail;}
+						key = realloc_ptr;
+						memset(&(key[key_capacity]), '\0', key_capacity_step);
+						key_capacity = new_capacity;
+					}
+					key[key_size] = jdi->bfr_read[i];
+					key_size++;
+					escape_char = 0;
+				} else {
+					switch(jdi->bfr_read[i]){
+						case '\\':
+							escape_char = 1;
+							break;
+						case '"':
+							in_key = 0;
+							break;
+						default:
+							if(key_size >= key_capacity - 1){
+								int32_t new_capacity = key_capacity + key_capacity_step;
+								size_t realloc_size = new_capacity * sizeof(char);
+								void * realloc_ptr = (char*) realloc(key, realloc_size);
+								if(realloc_ptr == NULL){goto realloc_fail;}
+								key = realloc_ptr;
+								memset(&(key[key_capacity]), '\0', key_capacity_step);
+								key_capacity = new_capacity;
+							}
+							key[key_size] = jdi->bfr_read[i];
+							key_size++;
+							break;
+
+					}
+				}
+			} else if(in_value == 1 || ('0' <= jdi->bfr_read[i] && jdi->bfr_read[i] <= '9')){
+				if(escape_char){
+					if(value_size >= value_capacity - 1){
+						int32_t new_capacity = value_capacity + value_capacity_step;
+						size_t realloc_size = new_capacity * sizeof(char);
+						void * realloc_ptr = (char*) realloc(value, realloc_size);
+						if(realloc_ptr == NULL){goto realloc_fail;}
+						value = realloc_ptr;
+						memset(&(value[value_capacity]), '\0', value_capacity_step);
+						value_capacity = new_capacity;
+					}
+					switch(jdi->bfr_read[i]){
+						case 'n':
+							value[value_size] = '\n';
+							break;
+						case 'r':
+							value[value_size] = '\r';
+							break;
+						case 't':
+							value[value_size] = '\t';
+							break;
+						default:
+							value[value_size] = jdi->bfr_read[i];
+							break;
+					}
+					value_size++;
+					escape_char = 0;
+				} else {
+					switch(jdi->bfr_read[i]){
+						case '\\':
+							escape_char = 1;
+							break;
+						case '"':
+							if(strcmp(key, "id") == 0){
+								jdi->current_document.identifier = realloc(jdi->current_document.identifier, value_size + 1);
+								memcpy(jdi->current_document.identifier, value, value_size);
+								jdi->current_document.identifier[value_size] = '\0';
+								jdi->current_document.identifier_size = value_size;
+								jdi->current_document.identifier_capacity = value_size + 1;
+							} else if(strcmp(key, jdi->content_key) == 0){
+								jdi->current_document.text = realloc(jdi->current_document.text, value_size + 1);
+								memcpy(jdi->current_document.text, value, value_size);
+								jdi->current_document.text[value_size] = '\0';
+								jdi->current_document.text_size = value_size;
+								jdi->current_document.text_capacity = value_size + 1;
+							}
+							in_value = 0;
+							colon_passed = 0;
+							break;
+						default:
+							if(value_size >= value_capacity - 1){
+								int32_t new_capacity = value_capacity + value_capacity_step;
+								size_t realloc_size = new_capacity * sizeof(char);
+								void * realloc_ptr = (char*) realloc(value, realloc_size);
+								if(realloc_ptr == NULL){goto realloc_fail;}
+								value = realloc_ptr;
+								memset(&(value[value_capacity]), '\0', value_capacity_step);
+								value_capacity = new_capacity;
+							}
+							value[value_size] = jdi->bfr_read[i];
+							value_size++;
+							break;
+
+					}
+				}
+			} else if(jdi->bfr_read[i] == ':'){
+				colon_passed = 1;
+			} else if(jdi->bfr_read[i] == '"'){
+				if(colon_passed){
+					in_value = 1;
+				} else {
+					memset(key, '\0', key_size);
+					key_size = 0;
+					memset(value, '\0', value_size);
+					value_size = 0;
+					in_key = 1;
+				}
+			} else if(jdi->bfr_read[i] == '['){
+				i++;
+				while(i < JSONL_FILE_READ_BUFFER_SIZE - 1 && (escape_char || jdi->bfr_read[i] != ']') && jdi->bfr_read[i] != '\0'){
+					if(escape_char){
+						escape_char = 0;
+						i++;
+					} else {
+						if(jdi->bfr_read[i] == '\\'){
+							// i++;
+							escape_char = 1;
+						}
+						i++;
+					}
+				}
+				if(i < JSONL_FILE_READ_BUFFER_SIZE - 1 && jdi->bfr_read[i] != ']' && escape_char == 0){
+					in_brackets = 1;
+				}
+			} else if(jdi->bfr_read[i] == ',' || jdi->bfr_read[i] == '}'){
+				if(strcmp(key, "id") == 0){
+					jdi->current_document.identifier = realloc(jdi->current_document.identifier, value_size + 1);
+					memcpy(jdi->current_document.identifier, value, value_size);
+					jdi->current_document.identifier[value_size] = '\0';
+					jdi->current_document.identifier_size = value_size;
+					jdi->current_document.identifier_capacity = value_size + 1;
+				} else if(strcmp(key, jdi->content_key) == 0){
+					jdi->current_document.text = realloc(jdi->current_document.text, value_size + 1);
+					memcpy(jdi->current_document.text, value, value_size);
+					jdi->current_document.text[value_size] = '\0';
+					jdi->current_document.text_size = value_size;
+					jdi->current_document.text_capacity = value_size + 1;
+				}
+				in_value = 0;
+				colon_passed = 0;
+			}
+			i++;
+		}
+		if(feof(jdi->file_ptr)){
+			jdi->file_is_done = 1;
+		} else {
+			memset(jdi->bfr_read, '\0', bytes_read);
+		}
+	} 
+	free(key);
+	free(value);
+
+	if(feof(jdi->file_ptr)){
+		jdi->file_is_done = 1;
+	}
+
+	return 0;
+
+	realloc_fail:
+	perror("[err] failed to realloc\n");
+	return 1;
+	malloc_fail:
+	perror("[err] failed to malloc\n");
+	return 1;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "oov/counter.h"
+#include "jsonl/parser.h"
+#include "jsonl/load.h"
+#include "distributions.h"
+#include "logging.h"
+#include "measurement.h"
+#include "checkpoint.h"
+#include "recompute.h"
+#include "schedule.h"
+#include "unicode/utf8.h"
+#include "filter.h"
+#include "cupt/constants.h"
+
+// one occurrence of token, added to the graph if the vector space has it and to the OOV counter otherwise; token may be normalised in place
+int32_t jsonl_token_to_graph(char * const token, const struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, uint64_t * const num_oov_tokens){
+    // UTF-8 normalisation
+
+    if(mcfg->enable_token_utf8_normalisation){
+        char * utf8_normalised_key = utf8_normalise(token);
+        if(utf8_normalised_key != token){
+            size_t bytes_to_cpy = strlen(utf8_normalised_key);
+            if(bytes_to_cpy > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){bytes_to_cpy = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;}
+            memcpy(token, utf8_normalised_key, bytes_to_cpy);
+            token[bytes_to_cpy] = '\0';
+        }
+    }
+
+    // add to graph
+    int32_t index = word2vec_key_to_index(sref->w2v, token);
+    if(index != -1){
+        if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+            perror("failed to call graph_add_word2vec_occurrence\n");
+            return 1;
+        }
+    } else { // added from cupt
+        if(oov_counter_increment(sref->oov_discarded_because_not_in_vector_database, token) != 0){
+            perror("failed to call oov_counter_increment\n");
+            return 1;
+        }
+        if(num_oov_tokens != NULL){(*num_oov_tokens)++;}
+    }
+    return 0;
+}
+
+// every token of a document whose text is set, as the JSONL loader reads them
+int32_t jsonl_document_to_graph(struct document * const doc, const struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, uint64_t * const num_oov_tokens){
+    while(!(doc->reached_last_token)){
+        if(iterate_document_current_token(doc) != 0){
+            perror("failed to call iterate_document_current_token\n");
+            return 1;
+        }
+        if(jsonl_token_to_graph(doc->current_token, mcfg, sref, num_oov_tokens) != 0){
+            perror("failed to call jsonl_token_to_graph\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int32_t jsonl_to_graph(const uint64_t i, const char * const filename, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut){
+    struct jsonl_document_iterator jdi = {0};
+    if(create_jsonl_document_iterator(&jdi, filename, mcfg->jsonl_content_key) != 0){
+        perror("failed to call create_jsonl_document_iterator\n");
+        return 1;
+    }
+
+    // the documents before the resume point were read by the run that wrote the checkpoint
+    if(sref->checkpoint != NULL){
+        int64_t offset = 0;
+        int64_t offset_tp = 0;
+        checkpoint_file_resume_point(sref->checkpoint, (int32_t) i, &offset, &offset_tp, NULL);
+        if(offset > 0 && fseek(jdi.file_ptr, (long) offset, SEEK_SET) != 0){
+            fprintf(stderr, "failed to seek to offset %li in %s\n", offset, filename);
+            free_jsonl_document_iterator(&jdi);
+            return 1;
+        }
+    }
+
+    #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+    struct filter_workspace fw = {0};
+    if(create_filter_workspace(&fw) != 0){
+        perror("failed to call create_filter_workspace\n");
+        free_jsonl_document_iterator(&jdi);
+        return 1;
+    }
+    #endif
+
+    const int32_t log_bfr_size = 256;
+    char log_bfr[log_bfr_size];
+
+    int8_t found_at_least_one_mwe = 0;
+	while(!(jdi.file_is_done)){
+		memset(jdi.current_document.identifier, '\0', jdi.current_document.identifier_size); // ?
+		jdi.current_document.identifier_size = 0;
+		memset(jdi.current_document.text, '\0', jdi.current_document.text_size); // ?
+		jdi.current_document.text_size = 0;
+		if(iterate_jsonl_document_iterator(&jdi) != 0){
+			perror("failed to call iterate_jsonl_document_iterator\n");
+			goto panic_exit;
+		}
+		if(jdi.current_document.text_size == 0 || jdi.current_document.identifier_size == 0){
+			continue;
+		}
+
+        #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+        if(filter_substitute_all_workspace(&fw, &jdi.current_document.text, &jdi.current_document.text_size, &jdi.current_document.text_capacity)){
+            perror("failed to call filter_substitute_all_workspace\n");
+            goto panic_exit;
+        }
+        #endif
+
+		if(jsonl_document_to_graph(&(jdi.current_document), mcfg, sref, NULL) != 0){
+			perror("failed to call jsonl_document_to_graph\n");
+			goto panic_exit;
+		}
+
+        pthread_mutex_lock(&mmut->mutex);
+        pthread_mutex_lock(&sref->g->mutex_nodes);
+		// if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.document.enable_count_recompute_step && (((!mcfg->steps.document.use_log10) && mmut->document.num % mcfg->steps.document.recompute_step == 0) || (mcfg->steps.document.use_log10 && mmut->document.num >= mmut->document.count_target)) && sref->g->num_nodes > 1)){ // DO NOT REMOVE
+		if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.document.enable_count_recompute_step && (((!mcfg->steps.document.use_log10) && (!mcfg->steps.document.use_adaptive) && mmut->document.num_all % mcfg->steps.document.recompute_step == 0) || ((mcfg->steps.document.use_log10 || mcfg->steps.document.use_adaptive) && mmut->document.num_all >= mmut->document.count_target)) && sref->g->num_nodes > 1)){
+            if(sref->recompute != NULL){
+                if(recompute_worker_submit(sref->recompute, i, sref->g, mmut, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), 0) != 0){
+                    perror("failed to call recompute_worker_submit\n");
+                    goto panic_exit;
+                }
+            } else {
+                mmut->num_oov_types = oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database);
+                if(compute_graph_relative_proportions(sref->g) != 0 || measurement_recompute_step(i, mcfg, sref, mmut, 0) != 0){
+                    perror("failed to call measurement_recompute_step\n");
+                    goto panic_exit;
+                }
+            }
+
+			if(mcfg->steps.document.use_adaptive){
+				mmut->document.count_target = recompute_schedule_next(sref->schedule, &(sref->schedule->document), mmut->document.num_all, sref->g->num_nodes, recompute_schedule_now(), sref->recompute == NULL, mcfg->steps.document.use_log10 ? mcfg->steps.document.recompute_step_log10 : 0.0);
+				memset(log_bfr, '\0', log_bfr_size);
+				snprintf(log_bfr, log_bfr_size, "New document count target: %lu (adaptive)", mmut->document.count_target);
+				info_format(__FILE__, __func__, __LINE__, log_bfr);
+			} else if(mcfg->steps.document.use_log10){
+				mmut->document.stacked_log += mcfg->steps.document.recompute_step_log10;
+				mmut->document.count_target = (uint64_t) floor(pow(10.0, mmut->document.stacked_log));
+				memset(log_bfr, '\0', log_bfr_size);
+				snprintf(log_bfr, log_bfr_size, "New document count target: %lu (10.0^%.3f)", mmut->document.count_target, mmut->document.stacked_log);
+				info_format(__FILE__, __func__, __LINE__, log_bfr);
+			}
+		}
+        pthread_mutex_unlock(&sref->g->mutex_nodes);
+
+		// mmut->document.num++; // DO NOT REMOVE
+		mmut->document.num_all++;
+        pthread_mutex_unlock(&mmut->mutex);
+
+        if(sref->checkpoint != NULL){checkpoint_unit_done(sref->checkpoint, (int32_t) i, (int64_t) ftell(jdi.file_ptr), -1, found_at_least_one_mwe);}
+	}
+
+    free_jsonl_document_iterator(&jdi);
+    #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+    free_filter_workspace(&fw);
+    #endif
+
+    return 0;
+
+    panic_exit:
+
+    free_jsonl_document_iterator(&jdi);
+    #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+    free_filter_workspace(&fw);
+    #endif
+
+    return 1;
+}
+
+void * jsonl_to_graph_thread(void * args){
+    if(jsonl_to_graph(
+        ((struct measurement_file_thread *) args)->i,
+        ((struct measurement_file_thread *) args)->filename,
+        ((struct measurement_file_thread *) args)->mcfg,
+        ((struct measurement_file_thread *) args)->sref,
+        ((struct measurement_file_thread *) args)->mmut
+    ) != 0){
+        perror("Failed to call jsonl_to_graph in jsonl_to_graph_thread\n");
+        exit(1);
+    }
+    return NULL;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sorted_array/array.h"
+#include "sorted_array/constants.h"
+
+int32_t create_sorted_array_default_element(struct sorted_array_default_element* elem){
+	memset(elem->key, '\0', SORTED_ARRAY_DEFAULT_KEY_SIZE);
+	memset(elem->value, '\0', SORTED_ARRAY_DEFAULT_VALUE_SIZE);
+	return 0;
+}
+
+int32_t create_sorted_array_str_int_element(struct sorted_array_str_int_element* elem){
+	memset(elem->key, '\0', SORTED_ARRAY_DEFAULT_KEY_SIZE);
+	elem->value = 0;
+	return 0;
+}
+
+int32_t create_sorted_array_int_int_element(struct sorted_array_int_int_element* elem){
+	elem->key = 0;
+	elem->value = 0;
+	return 0;
+}
+
+int32_t create_sorted_array_int_str_element(struct sorted_array_int_str_element* elem){
+	elem->key = 0;
+	memset(elem->value, '\0', SORTED_ARRAY_DEFAULT_VALUE_SIZE);
+	return 0;
+}
+
+int32_t create_sorted_array(struct sorted_array * const array, int64_t num_elements, size_t element_size, int32_t (*comp)(const void* a, const void* b), const uint8_t method){
+	size_t malloc_size;
+	if(num_elements > 0){
+		malloc_size = num_elements * element_size;
+		array->capacity = num_elements;
+	} else {
+		malloc_size = SORTED_ARRAY_STEP * element_size;
+		array->capacity = SORTED_ARRAY_STEP;
+	}
+	array->num_elements = 0;
+	void* malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		perror("failed to malloc\n");
+		return 1;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	array->bfr = malloc_pointer;
+	array->to_free = 1;
+	array->element_size = element_size;
+	array->comp = comp;
+    array->num_elements_sorted = 0;
+	if(array->bfr == NULL){
+		printf("array->bfr == NULL\n");
+		exit(1);
+	}
+    array->method = method;
+
+    if(pthread_mutex_init(&(array->mutex), NULL) != 0){
+        perror("Failed to call pthread_mutex_init in create_sorted_array\n");
+        return 1;
+    }
+    // array->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+
+	return 0;
+}
+
+int32_t recreate_sorted_array(struct sorted_array* array, int64_t num_elements, size_t element_size, int32_t (*comp)(const void* a, const void* b), const uint8_t method){
+	size_t malloc_size;
+	if(num_elements > 0){
+		malloc_size = num_elements * element_size;
+		array->capacity = num_elements;
+	} else {
+		malloc_size = SORTED_ARRAY_STEP * element_size;
+		array->capacity = SORTED_ARRAY_STEP;
+	}
+	array->num_elements = 0;
+	if(malloc_size == 0){
+		printf("new_size == 0\n");
+		exit(1);
+	}
+	array->bfr = realloc(array->bfr, malloc_size);
+	if(array->bfr == NULL){
+		perror("failed to realloc\n");
+		/* perror("failed to malloc\n"); */
+		return 1;
+	}
+	memset(array->bfr, '\0', malloc_size);
+	array->to_free = 1;
+	array->capacity = num_elements;
+	array->num_elements = num_elements;
+	array->element_size = element_size;
+	array->comp = comp;
+    array->num_elements_sorted = 0;
+	if(array->bfr == NULL){
+		printf("array->bfr == NULL\n");
+		exit(1);
+	}
+    array->method = method;
+    pthread_mutex_destroy(&(array->mutex));
+    pthread_mutex_init(&(array->mutex), NULL);
+	return 0;
+}
+
+void free_sorted_array(struct sorted_array* array){
+	if(array->to_free == 1){
+		free(array->bfr);
+		array->to_free = 0;
+	}
+    pthread_mutex_destroy(&(array->mutex));
+}
+
+int32_t key_to_index_sorted_array_tree(const struct sorted_array * const array, const void * const key){
+    int64_t current_index = 0;
+
+    while(1){
+        if(current_index >= array->num_elements){break;}
+        int32_t cmp_result = array->comp((void*) (((uint64_t) array->bfr) + (current_index * array->element_size)), key);
+        if(cmp_result == 0){
+            return current_index;
+        } else if(cmp_result > 0){
+            current_index = current_index * 2 + 1;
+        } else if(cmp_result < 0){
+            current_index = current_index * 2 + 2;
+        }
+    }
+
+    return -1;
+}
+
+int32_t key_to_index_sorted_array_linear(const struct sorted_array * const array, const void * const key){
+	if(array->num_elements == 0){return -1;}
+	int32_t lower_bound = 0;
+	int32_t upper_bound = array->num_elements_sorted - 1;
+
+	while(lower_bound <= upper_bound){
+		int32_t middle_index = lower_bound + ((upper_bound - lower_bound) >> 1);
+		int32_t cmp_result = array->comp((void*) (((uint64_t) array->bfr) + (middle_index * array->element_size)), key); // compliance
+		if(cmp_result == 0){
+			return middle_index;
+		} else if(cmp_result < 0){
+			lower_bound = middle_index + 1;
+		} else if(cmp_result > 0){
+			upper_bound = middle_index - 1;
+		}
+	}
+
+    for(int64_t i = array->num_elements_sorted ; i < array->num_elements ; i++){
+		int32_t cmp_result = array->comp((void*) (((uint64_t) array->bfr) + (i * array->element_size)), key);
+        
+        if(cmp_result == 0){return i;}
+    }
+
+	return -1;
+}
+
+int32_t key_to_index_sorted_array(const struct sorted_array * const array, const void * const key){
+    switch (array->method) {
+        case SORTED_ARRAY_METHOD_LINEAR:
+            return key_to_index_sorted_array_linear(array, key);
+        case SORTED_ARRAY_METHOD_TREE:
+            return key_to_index_sorted_array_tree(array, key);
+        default:
+            fprintf(stderr, "incorrect sorted_array method: %u\n", array->method);
+            exit(1);
+    }
+}
+
+void* key_to_elem_sorted_array(const struct sorted_array* const array, const void* const key){
+	int32_t index = key_to_index_sorted_array(array, key);
+	return ((void*) (((uint64_t) array->bfr) + (index * array->element_size))); // compliance
+}
+
+int32_t bulk_insert_sorted_array(struct sorted_array* array, void* alt_array, size_t n){
+	size_t available_space = (array->capacity - array->num_elements) * array->element_size;
+	size_t size_delta = n - available_space;
+	if(size_delta > 0){
+		size_t new_size = array->capacity * array->element_size + (size_delta + (array->element_size - (size_delta % array->element_size)) % array->element_size);
+	    	if(new_size == 0){
+	    		printf("new_size == 0\n");
+	    		exit(1);
+	    	}
+		array->bfr = realloc(array->bfr, new_size);
+		if(array->bfr == NULL){
+			perror("failed to realloc\n");
+			return 1;
+		}
+		memset((void*) (((uint64_t) array->bfr) + (array->capacity * array->element_size)), '\0', new_size - (array->capacity * array->element_size)); // compliance
+		array->capacity = new_size / array->element_size;
+	}
+	memcpy((void*) (((uint64_t) array->bfr) + (array->num_elements * array->element_size)), alt_array, n); // compliance
+	array->num_elements += n / array->element_size;
+
+	qsort(array->bfr, array->num_elements, n, array->comp);
+
+	return 0;
+}
+
+int32_t sorted_array_request_more_capacity(struct sorted_array * const array){
+    size_t new_size = (array->capacity + SORTED_ARRAY_STEP) * array->element_size;
+    array->bfr = realloc(array->bfr, new_size);
+    if(array->bfr == NULL){
+    	perror("failed to realloc\n");
+    	return 1;
+    }
+    memset((void*) (((uint64_t) array->bfr) + (array->capacity * array->element_size)), '\0', SORTED_ARRAY_STEP * array->element_size); // compliance
+    array->capacity += SORTED_ARRAY_STEP;
+    return 0;
+}
+
+int32_t insert_sorted_array_tree(struct sorted_array* array, void* alt, int8_t insert_mode){
+	/*
+	 * insert_mode == 0 -> insert whatever happens
+	 * insert_mode == 1 -> insert only if not present
+	 * insert_mode == 2 -> overwrite if present, otherwise insert
+	 * */
+
+    int32_t index = key_to_index_sorted_array_tree(array, alt);
+    int32_t index_parent, is_left_child, is_right_child, index_child_left, index_child_right, index_current, cmp_result, direction;
+
+    enum {
+        DIRECTION_UP = 0,
+        DIRECTION_DOWN = 1,
+        DIRECTION_STOP = 2,
+    };
+
+    direction = DIRECTION_UP;
+
+    if(insert_mode == 2){
+        if(index != -1){
+            memcpy((void*) (((uint64_t) array->bfr) + (index * array->element_size)), alt, array->element_size);
+            return 0;
+        }
+    }
+
+    assert(array->element_size > 0);
+
+    void * swap_buffer = malloc(array->element_size);
+    if(swap_buffer == NULL){
+        perror("alloc failed\n");
+        return 1;
+    }
+
+    if(!(insert_mode == 0 || insert_mode == 1)){
+        fprintf(stderr, "incorrect insert_mode: %i\n", insert_mode);
+	free(swap_buffer);
+        return 1;
+    }
+    if(index == -1 || insert_mode == 0){
+    	if(array->num_elements == array->capacity){
+            if(sorted_array_request_more_capacity(array) != 0){
+                perror("Failed to call sorted_array_request_more_capacity\n");
+		free(swap_buffer);
+                return 1;
+            }
+    	}
+        
+        memcpy((void*) (((uint64_t) array->bfr) + (array->num_elements * array->element_size)), alt, array->element_size);
+
+        index_current = array->num_elements;
+        if(index_current == 0){
+            direction = DIRECTION_DOWN;
+        }
+
+        array->num_elements++;
+
+        while(1){
+
+            if(direction == DIRECTION_UP){
+                index_parent = ((index_current - 1) % 2) >> 1;
+                is_left_child = index_current % 2;
+                is_right_child = (!is_left_child) & (index_parent != 0);
+                cmp_result = array->comp((void*) (((uint64_t) array->bfr) + (index_parent * array->element_size)), (void*) (((uint64_t) array->bfr) + (index_current * array->element_size)));
+                if((is_left_child && cmp_result < 0) || (is_right_child && cmp_result > 0)){
+                    memcpy(swap_buffer, (void*) (((uint64_t) array->bfr) + (index_current * array->element_size)), array->element_size);
+                    memcpy((void*) (((uint64_t) array->bfr) + (index_current * array->element_size)), (void*) (((uint64_t) array->bfr) + (index_parent * array->element_size)), array->element_size);
+                    memcpy((void*) (((uint64_t) array->bfr) + (index_parent * array->element_size)), swap_buffer, array->element_size);
+                    index_current = index_parent;
+                    if(index_current == 0){
+                        direction = DIRECTION_DOWN;
+                    }
+                } else {
+                    direction = DIRECTION_DOWN;
+                }
+            } else if(direction == DIRECTION_DOWN){
+                index_child_left = index_current * 2 + 1;
+                index_child_right = index_current * 2 + 2;
+                
+                // left
+
+                if(index_child_left < array->num_elements){
+                    cmp_result = array->comp((void*) (((uint64_t) array->bfr) + (index_child_left * array->element_size)), (void*) (((uint64_t) array->bfr) + (index_current * array->element_size)));
+                    if(cmp_result > 0){
+                        memcpy(swap_buffer, (void*) (((uint64_t) array->bfr) + (index_current * array->element_size)), array->element_size);
+                        memcpy((void*) (((uint64_t) array->bfr) + (index_current * array->element_size)), (void*) (((uint64_t) array->bfr) + (index_child_left * array->element_size)), array->element_size);
+                        memcpy((void*) (((uint64_t) array->bfr) + (index_child_left * array->element_size)), swap_buffer, array->element_size);
+                        index_current = index_child_left;
+                        continue;
+                    }
+                }
+
+                // right
+
+                if(index_child_right < array->num_elements){
+                    cmp_result = array->comp((void*) (((uint64_t) array->bfr) + (index_child_right * array->element_size)), (void*) (((uint64_t) array->bfr) + (index_current * array->element_size)));
+                    if(cmp_result < 0){
+                        memcpy(swap_buffer, (void*) (((uint64_t) array->bfr) + (index_current * array->element_size)), array->element_size);
+                        memcpy((void*) (((uint64_t) array->bfr) + (index_current * array->element_size)), (void*) (((uint64_t) array->bfr) + (index_child_right * array->element_size)), array->element_size);
+                        memcpy((void*) (((uint64_t) array->bfr) + (index_child_right * array->element_size)), swap_buffer, array->element_size);
+                        index_current = index_child_right;
+                        continue;
+                    }
+                }
+
+                direction = DIRECTION_STOP;
+            } else {
+                break;
+            }
+        }
+    }
+
+    free(swap_buffer);
+
+    return 0;
+}
+
+int32_t insert_sorted_array_linear(struct sorted_array* array, void* alt, int8_t insert_mode){
+	/*
+	 * insert_mode == 0 -> insert whatever happens
+	 * insert_mode == 1 -> insert only if not present
+	 * insert_mode == 2 -> overwrite if present, otherwise insert
+	 * */
+	if(insert_mode > 0){
+		int32_t index = key_to_index_sorted_array(array, alt);
+		if(insert_mode == 1){
+			if(index != -1){
+				return 0;
+			}
+		} else if(insert_mode == 2){
+			if(index != -1){
+				memcpy((void*) (((uint64_t) array->bfr) + (index * array->element_size)), alt, array->element_size); // compliance
+				return 0;
+			}
+		} else {
+            fprintf(stderr, "Unknown insert mode: %i\n", insert_mode);
+            return 1;
+        }
+	}
+	if(array->num_elements == array->capacity){
+        if(sorted_array_request_more_capacity(array) != 0){
+            perror("Failed to call sorted_array_request_more_capacity\n");
+            return 1;
+        }
+	}
+	memcpy((void*) (((uint64_t) array->bfr) + (array->num_elements * array->element_size)), alt, array->element_size); // compliance
+	array->num_elements++;
+
+    if(array->num_elements - array->num_elements_sorted >= SORTED_ARRAY_UNSORTED_PART_MAX_SIZE){
+	    qsort(array->bfr, array->num_elements, array->element_size, array->comp);
+        array->num_elements_sorted = array->num_elements;
+    }
+
+	return 0;
+}
+
+int32_t insert_sorted_array(struct sorted_array* array, void* alt, int8_t insert_mode){
+    switch (array->method) {
+        case SORTED_ARRAY_METHOD_LINEAR:
+            return insert_sorted_array_linear(array, alt, insert_mode);
+        case SORTED_ARRAY_METHOD_TREE:
+            return insert_sorted_array_tree(array, alt, insert_mode);
+        default:
+            fprintf(stderr, "incorrect sorted_array method: %u\n", array->method);
+            exit(1);
+    }
+}
+
+int32_t sorted_array_default_cmp(const void* a, const void* b){
+    return strcmp(((struct sorted_array_default_element*) a)->key, ((struct sorted_array_default_element*) b)->key);
+}
+
+int32_t sorted_array_str_int_cmp(const void* a, const void* b){
+	return sorted_array_default_cmp(a, b);
+}
+
+int32_t sorted_array_int_int_cmp(const void* a, const void* b){
+	return (int32_t) (((struct sorted_array_int_int_element*) a)->key - ((struct sorted_array_int_int_element*) b)->key);
+}
+
+int32_t sorted_array_int_str_cmp(const void* a, const void* b){
+	return sorted_array_int_int_cmp(a, b);
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oov/counter.h"
+#include "oov/constants.h"
+#include "logging.h"
+
+static uint64_t oov_counter_mix(uint64_t h){
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// copies at most OOV_COUNTER_KEY_SIZE - 1 bytes of key into truncated_key (zero-padded), as the sorted_array used to
+static uint64_t oov_counter_hash(const char * const key, char * const truncated_key){
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    size_t i = 0;
+    memset(truncated_key, '\0', OOV_COUNTER_KEY_SIZE);
+    while(i < OOV_COUNTER_KEY_SIZE - 1 && key[i] != '\0'){
+        truncated_key[i] = key[i];
+        h ^= (uint64_t) ((uint8_t) key[i]);
+        h *= 0x100000001b3ULL;
+        i++;
+    }
+    return oov_counter_mix(h);
+}
+
+static struct oov_counter_shard * oov_counter_shard_of(struct oov_counter * const counter, const uint64_t hash){
+    return &(counter->shards[hash >> (64 - OOV_COUNTER_NUM_SHARDS_LOG2)]);
+}
+
+static struct oov_counter_entry * oov_counter_shard_find(const struct oov_counter_shard * const shard, const uint64_t hash, const char * const key){
+    const uint64_t mask = (uint64_t) (shard->capacity - 1);
+    uint64_t j = hash & mask;
+    while(shard->bfr[j].value != 0){
+        if(shard->bfr[j].hash == hash && strcmp(shard->bfr[j].key, key) == 0){return &(shard->bfr[j]);}
+        j = (j + 1) & mask;
+    }
+    return &(shard->bfr[j]); // empty slot
+}
+
+static int32_t oov_counter_shard_grow(struct oov_counter_shard * const shard){
+    const int64_t new_capacity = shard->capacity << 1;
+    const uint64_t mask = (uint64_t) (new_capacity - 1);
+    size_t alloc_size = new_capacity * sizeof(struct oov_counter_entry);
+    struct oov_counter_entry * new_bfr = malloc(alloc_size);
+    if(new_bfr == NULL){
+        perror("malloc failed\n");
+        return 1;
+    }
+    memset(new_bfr, '\0', alloc_size);
+
+    for(int64_t i = 0 ; i < shard->capacity ; i++){
+        if(shard->bfr[i].value == 0){continue;}
+        uint64_t j = shard->bfr[i].hash & mask;
+        while(new_bfr[j].value != 0){j = (j + 1) & mask;}
+        memcpy(&(new_bfr[j]), &(shard->bfr[i]), sizeof(struct oov_counter_entry));
+    }
+
+    free(shard->bfr);
+    shard->bfr = new_bfr;
+    shard->capacity = new_capacity;
+    return 0;
+}
+
+static uint64_t oov_counter_sketch_index(const struct oov_counter_sketch * const sketch, const uint64_t hash, const uint64_t row){
+    return (row * sketch->width) + (oov_counter_mix(hash + (row + 1) * 0x9e3779b97f4a7c15ULL) & sketch->mask);
+}
+
+static uint32_t oov_counter_sketch_add(struct oov_counter_sketch * const sketch, const uint64_t hash, const uint32_t weight){
+    uint32_t estimate = UINT32_MAX;
+    for(uint64_t row = 0 ; row < OOV_COUNTER_SKETCH_DEPTH ; row++){
+        uint32_t local_value = __atomic_add_fetch(&(sketch->table[oov_counter_sketch_index(sketch, hash, row)]), weight, __ATOMIC_RELAXED);
+        if(local_value < estimate){estimate = local_value;}
+    }
+    return estimate;
+}
+
+static uint32_t oov_counter_sketch_estimate(const struct oov_counter_sketch * const sketch, const uint64_t hash){
+    uint32_t estimate = UINT32_MAX;
+    for(uint64_t row = 0 ; row < OOV_COUNTER_SKETCH_DEPTH ; row++){
+        uint32_t local_value = __atomic_load_n(&(sketch->table[oov_counter_sketch_index(sketch, hash, row)]), __ATOMIC_RELAXED);
+        if(local_value < estimate){estimate = local_value;}
+    }
+    return estimate;
+}
+
+static void oov_counter_top_k_update_min(struct oov_counter_top_k * const top_k){
+    int64_t min_value = INT64_MAX;
+    if(top_k->num_entries < OOV_COUNTER_TOP_K){
+        min_value = 0;
+    } else {
+        for(int32_t i = 0 ; i < top_k->num_entries ; i++){
+            if(top_k->entries[i].value < min_value){min_value = top_k->entries[i].value;}
+        }
+    }
+    __atomic_store_n(&(top_k->min_value), min_value, __ATOMIC_RELAXED);
+}
+
+// must be called with top_k->mutex locked
+static void oov_counter_top_k_offer(struct oov_counter_top_k * const top_k, const uint64_t hash, const char * const key, const int64_t estimate){
+    int32_t i;
+    int32_t index_min = 0;
+    for(i = 0 ; i < top_k->num_entries ; i++){
+        if(top_k->entries[i].hash == hash && strcmp(top_k->entries[i].key, key) == 0){
+            if(estimate > top_k->entries[i].value){top_k->entries[i].value = estimate;}
+            oov_counter_top_k_update_min(top_k);
+            return;
+        }
+        if(top_k->entries[i].value < top_k->entries[index_min].value){index_min = i;}
+    }
+    if(top_k->num_entries < OOV_COUNTER_TOP_K){
+        index_min = top_k->num_entries;
+        top_k->num_entries++;
+    } else if(estimate <= top_k->entries[index_min].value){
+        return;
+    }
+    top_k->entries[index_min].hash = hash;
+    top_k->entries[index_min].value = estimate;
+    memcpy(top_k->entries[index_min].key, key, OOV_COUNTER_KEY_SIZE);
+    oov_counter_top_k_update_min(top_k);
+}
+
+static void oov_counter_add_approximate(struct oov_counter * const counter, const uint64_t hash, const char * const key, const uint32_t weight){
+    const uint32_t estimate = oov_counter_sketch_add(&(counter->sketch), hash, weight);
+    if(estimate == weight){ // every row was empty beforehand: the type has never been seen
+        __atomic_add_fetch(&(counter->num_types), 1, __ATOMIC_RELAXED);
+    }
+    if(((int64_t) estimate) > __atomic_load_n(&(counter->top_k.min_value), __ATOMIC_RELAXED)){
+        pthread_mutex_lock(&(counter->top_k.mutex));
+        oov_counter_top_k_offer(&(counter->top_k), hash, key, (int64_t) estimate);
+        pthread_mutex_unlock(&(counter->top_k.mutex));
+    }
+}
+
+static int32_t oov_counter_switch_to_approximate(struct oov_counter * const counter){
+    const int32_t log_bfr_size = 256;
+    char log_bfr[log_bfr_size];
+
+    pthread_mutex_lock(&(counter->mutex_mode));
+    if(counter->mode == OOV_COUNTER_MODE_APPROXIMATE){
+        pthread_mutex_unlock(&(counter->mutex_mode));
+        return 0;
+    }
+
+    uint64_t width = OOV_COUNTER_SKETCH_MIN_WIDTH;
+    while(width < OOV_COUNTER_SKETCH_MAX_WIDTH && (width << 1) * OOV_COUNTER_SKETCH_DEPTH * sizeof(uint32_t) <= counter->memory_cap){
+        width <<= 1;
+    }
+    size_t alloc_size = width * OOV_COUNTER_SKETCH_DEPTH * sizeof(uint32_t);
+    counter->sketch.table = malloc(alloc_size);
+    if(counter->sketch.table == NULL){
+        perror("malloc failed\n");
+        pthread_mutex_unlock(&(counter->mutex_mode));
+        return 1;
+    }
+    memset(counter->sketch.table, '\0', alloc_size);
+    counter->sketch.width = width;
+    counter->sketch.mask = width - 1;
+
+    int32_t i;
+    for(i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        pthread_mutex_lock(&(counter->shards[i].mutex));
+    }
+
+    pthread_mutex_lock(&(counter->top_k.mutex));
+    for(i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        struct oov_counter_shard * const shard = &(counter->shards[i]);
+        for(int64_t j = 0 ; j < shard->capacity ; j++){
+            if(shard->bfr[j].value == 0){continue;}
+            const uint32_t weight = shard->bfr[j].value > UINT32_MAX ? UINT32_MAX : (uint32_t) shard->bfr[j].value;
+            const uint32_t estimate = oov_counter_sketch_add(&(counter->sketch), shard->bfr[j].hash, weight);
+            oov_counter_top_k_offer(&(counter->top_k), shard->bfr[j].hash, shard->bfr[j].key, (int64_t) estimate);
+        }
+        free(shard->bfr);
+        shard->bfr = NULL;
+        shard->capacity = 0;
+        shard->num_elements = 0;
+    }
+    pthread_mutex_unlock(&(counter->top_k.mutex));
+
+    // num_types is kept: the exact count so far, to which sketch misses are added
+    counter->memory_used = alloc_size + sizeof(struct oov_counter_top_k);
+    __atomic_store_n(&(counter->mode), OOV_COUNTER_MODE_APPROXIMATE, __ATOMIC_RELEASE);
+
+    for(i = OOV_COUNTER_NUM_SHARDS - 1 ; i >= 0 ; i--){
+        pthread_mutex_unlock(&(counter->shards[i].mutex));
+    }
+
+    memset(log_bfr, '\0', log_bfr_size);
+    snprintf(log_bfr, log_bfr_size, "OOV counter exceeded its memory cap (%zu bytes); switching to approximate counting (Count-Min sketch: %i x %lu, top-%i)", counter->memory_cap, OOV_COUNTER_SKETCH_DEPTH, width, OOV_COUNTER_TOP_K);
+    warning_format(__FILE__, __func__, __LINE__, log_bfr);
+
+    pthread_mutex_unlock(&(counter->mutex_mode));
+    return 0;
+}
+
+int32_t create_oov_counter(struct oov_counter * const counter, const size_t memory_cap){
+    memset(counter, '\0', sizeof(struct oov_counter));
+    size_t alloc_size = OOV_COUNTER_SHARD_INITIAL_CAPACITY * sizeof(struct oov_counter_entry);
+    int32_t i;
+
+    for(i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        counter->shards[i].bfr = malloc(alloc_size);
+        if(counter->shards[i].bfr == NULL){goto malloc_fail;}
+        memset(counter->shards[i].bfr, '\0', alloc_size);
+        counter->shards[i].capacity = OOV_COUNTER_SHARD_INITIAL_CAPACITY;
+        counter->shards[i].num_elements = 0;
+        if(pthread_mutex_init(&(counter->shards[i].mutex), NULL) != 0){
+            perror("Failed to call pthread_mutex_init in create_oov_counter\n");
+            free(counter->shards[i].bfr);
+            goto failure;
+        }
+    }
+
+    if(pthread_mutex_init(&(counter->top_k.mutex), NULL) != 0){
+        perror("Failed to call pthread_mutex_init in create_oov_counter\n");
+        goto failure;
+    }
+    if(pthread_mutex_init(&(counter->mutex_mode), NULL) != 0){
+        perror("Failed to call pthread_mutex_init in create_oov_counter\n");
+        pthread_mutex_destroy(&(counter->top_k.mutex));
+        goto failure;
+    }
+
+    counter->memory_cap = memory_cap;
+    counter->memory_used = OOV_COUNTER_NUM_SHARDS * alloc_size;
+    counter->num_types = 0;
+    counter->mode = OOV_COUNTER_MODE_EXACT;
+
+    if(counter->memory_cap != 0 && counter->memory_used > counter->memory_cap){
+        if(oov_counter_switch_to_approximate(counter) != 0){
+            perror("failed to call oov_counter_switch_to_approximate\n");
+            free_oov_counter(counter);
+            return 1;
+        }
+    }
+
+    return 0;
+
+    malloc_fail:
+    perror("malloc failed\n");
+    failure:
+    for(int32_t j = 0 ; j < i ; j++){
+        free(counter->shards[j].bfr);
+        pthread_mutex_destroy(&(counter->shards[j].mutex));
+    }
+    memset(counter, '\0', sizeof(struct oov_counter));
+    return 1;
+}
+
+void free_oov_counter(struct oov_counter * const counter){
+    for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        if(counter->shards[i].bfr != NULL){free(counter->shards[i].bfr);}
+        pthread_mutex_destroy(&(counter->shards[i].mutex));
+    }
+    if(counter->sketch.table != NULL){free(counter->sketch.table);}
+    pthread_mutex_destroy(&(counter->top_k.mutex));
+    pthread_mutex_destroy(&(counter->mutex_mode));
+    memset(counter, '\0', sizeof(struct oov_counter));
+}
+
+int32_t oov_counter_increment(struct oov_counter * const counter, const char * const key){
+    char local_key[OOV_COUNTER_KEY_SIZE];
+    const uint64_t hash = oov_counter_hash(key, local_key);
+
+    if(__atomic_load_n(&(counter->mode), __ATOMIC_ACQUIRE) == OOV_COUNTER_MODE_EXACT){
+        struct oov_counter_shard * const shard = oov_counter_shard_of(counter, hash);
+        int8_t grown = 0;
+
+        pthread_mutex_lock(&(shard->mutex));
+        // mode only changes while every shard is locked
+        if(counter->mode == OOV_COUNTER_MODE_EXACT){
+            struct oov_counter_entry * const entry = oov_counter_shard_find(shard, hash, local_key);
+            if(entry->value != 0){
+                entry->value++;
+            } else {
+                entry->hash = hash;
+                entry->value = 1;
+                memcpy(entry->key, local_key, OOV_COUNTER_KEY_SIZE);
+                shard->num_elements++;
+                __atomic_add_fetch(&(counter->num_types), 1, __ATOMIC_RELAXED);
+                if(shard->num_elements * 4 >= shard->capacity * 3){
+                    const size_t delta = shard->capacity * sizeof(struct oov_counter_entry);
+                    if(oov_counter_shard_grow(shard) != 0){
+                        perror("failed to call oov_counter_shard_grow\n");
+                        pthread_mutex_unlock(&(shard->mutex));
+                        return 1;
+                    }
+                    __atomic_add_fetch(&(counter->memory_used), delta, __ATOMIC_RELAXED);
+                    grown = 1;
+                }
+            }
+            pthread_mutex_unlock(&(shard->mutex));
+
+            if(grown && counter->memory_cap != 0 && __atomic_load_n(&(counter->memory_used), __ATOMIC_RELAXED) > counter->memory_cap){
+                if(oov_counter_switch_to_approximate(counter) != 0){
+                    perror("failed to call oov_counter_switch_to_approximate\n");
+                    return 1;
+                }
+            }
+            return 0;
+        }
+        pthread_mutex_unlock(&(shard->mutex));
+    }
+
+    oov_counter_add_approximate(counter, hash, local_key, 1);
+    return 0;
+}
+
+int64_t oov_counter_get(struct oov_counter * const counter, const char * const key){
+    char local_key[OOV_COUNTER_KEY_SIZE];
+    const uint64_t hash = oov_counter_hash(key, local_key);
+    int64_t value = -1;
+
+    if(__atomic_load_n(&(counter->mode), __ATOMIC_ACQUIRE) == OOV_COUNTER_MODE_EXACT){
+        struct oov_counter_shard * const shard = oov_counter_shard_of(counter, hash);
+        pthread_mutex_lock(&(shard->mutex));
+        if(counter->mode == OOV_COUNTER_MODE_EXACT){
+            value = oov_counter_shard_find(shard, hash, local_key)->value;
+        }
+        pthread_mutex_unlock(&(shard->mutex));
+        if(value != -1){return value;}
+    }
+
+    return (int64_t) oov_counter_sketch_estimate(&(counter->sketch), hash);
+}
+
+int64_t oov_counter_num_types(const struct oov_counter * const counter){
+    return __atomic_load_n(&(counter->num_types), __ATOMIC_RELAXED);
+}
+
+uint8_t oov_counter_is_exact(const struct oov_counter * const counter){
+    return __atomic_load_n(&(counter->mode), __ATOMIC_ACQUIRE) == OOV_COUNTER_MODE_EXACT;
+}
+
+static int oov_counter_entry_cmp_desc(const void * a, const void * b){
+    const struct oov_counter_entry * const x = (const struct oov_counter_entry *) a;
+    const struct oov_counter_entry * const y = (const struct oov_counter_entry *) b;
+    if(x->value != y->value){return x->value < y->value ? 1 : -1;}
+    return strcmp(x->key, y->key);
+}
+
+// keeps the n heaviest entries of the exact tables in bfr, sorted in descending order
+static void oov_counter_keep_heaviest(struct oov_counter_entry * const bfr, const int32_t n, int32_t * const num_written, const struct oov_counter_entry * const entry){
+    int32_t j = *num_written;
+    if(j == n){
+        if(oov_counter_entry_cmp_desc(entry, &(bfr[n - 1])) >= 0){return;}
+        j--;
+    } else {
+        (*num_written)++;
+    }
+    while(j > 0 && oov_counter_entry_cmp_desc(entry, &(bfr[j - 1])) < 0){
+        memcpy(&(bfr[j]), &(bfr[j - 1]), sizeof(struct oov_counter_entry));
+        j--;
+    }
+    memcpy(&(bfr[j]), entry, sizeof(struct oov_counter_entry));
+}
+
+int32_t oov_counter_most_frequent(struct oov_counter * const counter, struct oov_counter_entry * const bfr, const int32_t n, int32_t * const num_written){
+    *num_written = 0;
+    if(n <= 0){return 0;}
+
+    pthread_mutex_lock(&(counter->mutex_mode)); // no switch in the meantime
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            struct oov_counter_shard * const shard = &(counter->shards[i]);
+            pthread_mutex_lock(&(shard->mutex));
+            for(int64_t j = 0 ; j < shard->capacity ; j++){
+                if(shard->bfr[j].value != 0){oov_counter_keep_heaviest(bfr, n, num_written, &(shard->bfr[j]));}
+            }
+            pthread_mutex_unlock(&(shard->mutex));
+        }
+    } else {
+        pthread_mutex_lock(&(counter->top_k.mutex));
+        int32_t num_entries = counter->top_k.num_entries < n ? counter->top_k.num_entries : n;
+        struct oov_counter_entry local_entries[OOV_COUNTER_TOP_K];
+        memcpy(local_entries, counter->top_k.entries, counter->top_k.num_entries * sizeof(struct oov_counter_entry));
+        qsort(local_entries, counter->top_k.num_entries, sizeof(struct oov_counter_entry), oov_counter_entry_cmp_desc);
+        memcpy(bfr, local_entries, num_entries * sizeof(struct oov_counter_entry));
+        *num_written = num_entries;
+        pthread_mutex_unlock(&(counter->top_k.mutex));
+    }
+    pthread_mutex_unlock(&(counter->mutex_mode));
+
+    return 0;
+}
+
+// every entry of the exact tables, or the top-k list in approximate mode, in no particular order; *entries is to be freed
+int32_t oov_counter_entries(struct oov_counter * const counter, struct oov_counter_entry ** const entries, int64_t * const num_entries){
+    *entries = NULL;
+    *num_entries = 0;
+
+    pthread_mutex_lock(&(counter->mutex_mode)); // no switch in the meantime
+    int64_t capacity = 0;
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){capacity += counter->shards[i].num_elements;}
+    } else {
+        capacity = OOV_COUNTER_TOP_K;
+    }
+    *entries = (struct oov_counter_entry *) malloc((capacity > 0 ? capacity : 1) * sizeof(struct oov_counter_entry));
+    if(*entries == NULL){
+        pthread_mutex_unlock(&(counter->mutex_mode));
+        perror("malloc failed\n");
+        return 1;
+    }
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            struct oov_counter_shard * const shard = &(counter->shards[i]);
+            pthread_mutex_lock(&(shard->mutex));
+            for(int64_t j = 0 ; j < shard->capacity && *num_entries < capacity ; j++){
+                if(shard->bfr[j].value != 0){memcpy(&((*entries)[(*num_entries)++]), &(shard->bfr[j]), sizeof(struct oov_counter_entry));}
+            }
+            pthread_mutex_unlock(&(shard->mutex));
+        }
+    } else {
+        pthread_mutex_lock(&(counter->top_k.mutex));
+        memcpy(*entries, counter->top_k.entries, counter->top_k.num_entries * sizeof(struct oov_counter_entry));
+        *num_entries = counter->top_k.num_entries;
+        pthread_mutex_unlock(&(counter->top_k.mutex));
+    }
+    pthread_mutex_unlock(&(counter->mutex_mode));
+
+    return 0;
+}
+
+// writes the whole state, in native byte order; no increment may run meanwhile
+int32_t oov_counter_save(const struct oov_counter * const counter, FILE * const f){
+    const uint64_t header[3] = {(uint64_t) counter->mode, (uint64_t) counter->num_types, (uint64_t) counter->memory_used};
+    if(fwrite(header, sizeof(uint64_t), 3, f) != 3){goto write_fail;}
+
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            const struct oov_counter_shard * const shard = &(counter->shards[i]);
+            const int64_t sizes[2] = {shard->capacity, shard->num_elements};
+            if(fwrite(sizes, sizeof(int64_t), 2, f) != 2){goto write_fail;}
+            for(int64_t j = 0 ; j < shard->capacity ; j++){
+                if(shard->bfr[j].value != 0 && fwrite(&(shard->bfr[j]), sizeof(struct oov_counter_entry), 1, f) != 1){goto write_fail;}
+            }
+        }
+    } else {
+        const int64_t sizes[3] = {(int64_t) counter->sketch.width, (int64_t) counter->top_k.num_entries, counter->top_k.min_value};
+        if(fwrite(sizes, sizeof(int64_t), 3, f) != 3){goto write_fail;}
+        const size_t table_size = counter->sketch.width * OOV_COUNTER_SKETCH_DEPTH;
+        if(fwrite(counter->sketch.table, sizeof(uint32_t), table_size, f) != table_size){goto write_fail;}
+        if(fwrite(counter->top_k.entries, sizeof(struct oov_counter_entry), counter->top_k.num_entries, f) != (size_t) counter->top_k.num_entries){goto write_fail;}
+    }
+    return 0;
+
+    write_fail:
+    perror("failed to write OOV counter\n");
+    return 1;
+}
+
+// replaces the state of a counter made by create_oov_counter with the one written by oov_counter_save; memory_cap is kept
+int32_t oov_counter_load(struct oov_counter * const counter, FILE * const f){
+    uint64_t header[3];
+    if(fread(header, sizeof(uint64_t), 3, f) != 3 || header[0] > OOV_COUNTER_MODE_APPROXIMATE){goto read_fail;}
+
+    for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        free(counter->shards[i].bfr);
+        counter->shards[i].bfr = NULL;
+        counter->shards[i].capacity = 0;
+        counter->shards[i].num_elements = 0;
+    }
+    free(counter->sketch.table);
+    counter->sketch.table = NULL;
+    counter->sketch.width = 0;
+    counter->sketch.mask = 0;
+    counter->top_k.num_entries = 0;
+    counter->top_k.min_value = 0;
+
+    counter->mode = (uint8_t) header[0];
+    counter->num_types = (int64_t) header[1];
+    counter->memory_used = (size_t) header[2];
+
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            struct oov_counter_shard * const shard = &(counter->shards[i]);
+            int64_t sizes[2];
+            if(fread(sizes, sizeof(int64_t), 2, f) != 2 || sizes[0] <= 0 || (sizes[0] & (sizes[0] - 1)) != 0 || sizes[1] < 0 || sizes[1] >= sizes[0]){goto read_fail;}
+            shard->bfr = malloc(sizes[0] * sizeof(struct oov_counter_entry));
+            if(shard->bfr == NULL){
+                perror("malloc failed\n");
+                return 1;
+            }
+            memset(shard->bfr, '\0', sizes[0] * sizeof(struct oov_counter_entry));
+            shard->capacity = sizes[0];
+            // same capacity, so probing from the hash finds every entry where it was
+            const uint64_t mask = (uint64_t) (shard->capacity - 1);
+            for(int64_t k = 0 ; k < sizes[1] ; k++){
+                struct oov_counter_entry entry;
+                if(fread(&entry, sizeof(struct oov_counter_entry), 1, f) != 1 || entry.value == 0){goto read_fail;}
+                uint64_t j = entry.hash & mask;
+                while(shard->bfr[j].value != 0){j = (j + 1) & mask;}
+                memcpy(&(shard->bfr[j]), &entry, sizeof(struct oov_counter_entry));
+                shard->num_elements++;
+            }
+        }
+    } else {
+        int64_t sizes[3];
+        if(fread(sizes, sizeof(int64_t), 3, f) != 3 || sizes[0] <= 0 || (sizes[0] & (sizes[0] - 1)) != 0 || sizes[1] < 0 || sizes[1] > OOV_COUNTER_TOP_K){goto read_fail;}
+        const size_t table_size = (size_t) sizes[0] * OOV_COUNTER_SKETCH_DEPTH;
+        counter->sketch.table = malloc(table_size * sizeof(uint32_t));
+        if(counter->sketch.table == NULL){
+            perror("malloc failed\n");
+            return 1;
+        }
+        counter->sketch.width = (uint64_t) sizes[0];
+        counter->sketch.mask = counter->sketch.width - 1;
+        if(fread(counter->sketch.table, sizeof(uint32_t), table_size, f) != table_size){goto read_fail;}
+        if(fread(counter->top_k.entries, sizeof(struct oov_counter_entry), (size_t) sizes[1], f) != (size_t) sizes[1]){goto read_fail;}
+        counter->top_k.num_entries = (int32_t) sizes[1];
+        counter->top_k.min_value = sizes[2];
+    }
+    return 0;
+
+    read_fail:
+    perror("failed to read OOV counter\n");
+    return 1;
+}
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "logging.h"
+
+static int32_t num_calls_info = 0;
+static int32_t num_calls_warning = 0;
+static int32_t num_calls_error = 0;
+
+void custom_format(const char* const log_type, const int32_t log_num, const char* const filename, const char* const func, const int32_t line, const char* const msg){
+	assert(log_type != NULL);
+	assert(log_num >= 0);
+	assert(filename != NULL);
+	assert(func != NULL);
+	assert(line >= 0);
+	assert(msg != NULL);
+
+	const int32_t isodate_capacity = 64;
+	char isodate[isodate_capacity];
+	memset(isodate, '\0', isodate_capacity);
+	time_t now;
+	const struct tm* timeinfo = NULL;
+	time(&now);
+	timeinfo = localtime(&now);
+
+	strftime(isodate, isodate_capacity, "%Y-%m-%dT%H:%M:%S%z", timeinfo);
+
+	#if PYTHON_BUILD == 1 || !defined(NDEBUG)
+	fprintf(
+		stderr,
+		"%s [%s %i\x1b[0m] <\x1b[1m\x1b[34m%s\x1b[0m@\x1b[1m\x1b[33m%s:%i\x1b[0m> %s\n",
+		isodate,
+		log_type,
+		log_num,
+		func,
+		filename,
+		line,
+		msg
+	);
+	#else
+	fprintf(
+		stderr,
+		"%s [%s %i\x1b[0m] %s\n",
+		isodate,
+		log_type,
+		log_num,
+		msg
+	);
+	#endif
+}
+
+void error_format(const char* const filename, const char* const func, const int32_t line, const char* const msg){
+	num_calls_error++;
+
+	custom_format("\x1b[31m\x1b[1mERROR  ", num_calls_error, filename, func, line, msg);
+}
+
+void warning_format(const char* const filename, const char* const func, const int32_t line, const char* const msg){
+	num_calls_warning++;
+
+	custom_format("\x1b[33m\x1b[1mWARNING", num_calls_warning, filename, func, line, msg);
+}
+
+void info_format(const char* const filename, const char* const func, const int32_t line, const char* const msg){
+	num_calls_info++;
+
+	custom_format("\x1b[32m\x1b[1mINFO   ", num_calls_info, filename, func, line, msg);
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#if (ENABLE_AVX256 == 1 || ENABLE_AVX512 == 1)
+#include <immintrin.h>
+#endif
+
+#include "distances.h"
+
+// double minkowski_distance(double* restrict a, double* restrict b, int n, double order){
+double minkowski_distance(double* restrict a, double* restrict b, int n, double order){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double sum_ = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double diff = a[i] - b[i];
+		if(diff < 0.0){
+			diff *= -1.0;
+		}
+		sum_ += pow(diff, order);
+	}
+	return pow(sum_, 1.0 / order);
+}
+
+float minkowski_distance_fp32(float* restrict a, float* restrict b, int n, float order){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	// printf("n: %i\n", n);
+	float sum_ = 0.0f;
+	for(int i = 0 ; i < n ; i++){
+		float diff = a[i] - b[i];
+		if(diff < 0.0f){
+			diff *= -1.0f;
+		}
+		sum_ += (float) pow(diff, order);
+	}
+	return (float) pow(sum_, 1.0f / order);
+}
+
+float cosine_distance_fp32(const float* restrict const a, const float* restrict const b, int32_t n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	// printf("n: %i\n", n);
+	float upper_sum = 0.0;
+	float lower_sum_a = 0.0;
+	float lower_sum_b = 0.0;
+	for(int32_t i = 0 ; i < n ; i++){
+		upper_sum += a[i] * b[i];
+		lower_sum_a += powf(a[i], 2.0f);
+		lower_sum_b += powf(b[i], 2.0f);
+	}
+	float cosine_similarity = (upper_sum / (sqrtf(lower_sum_a) * sqrtf(lower_sum_b)));
+	return (1.0f - cosine_similarity);
+}
+
+float cosine_distance_norm_fp32(float* restrict a, float* restrict b, int32_t n){
+	return cosine_distance_fp32(a, b, n) / 2.0f;
+}
+
+#if ENABLE_AVX256 == 1
+float cosine_distance_fp32_avx256(const float* restrict const a, const float* restrict const b, int32_t n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	float upper_sum = 0.0;
+	float lower_sum_a = 0.0;
+	float lower_sum_b = 0.0;
+
+	__m256 avx256_upper_sum = _mm256_setzero_ps();
+	__m256 avx256_lower_sum_a = _mm256_setzero_ps();
+	__m256 avx256_lower_sum_b = _mm256_setzero_ps();
+
+	float vec_upper_sum[8];
+	float vec_lower_sum_a[8];
+	float vec_lower_sum_b[8];
+
+	int32_t i = 0;
+	while(i < n){
+		__m256 avx256_a = _mm256_loadu_ps(&(a[i])); // had to load unaligned
+		__m256 avx256_b = _mm256_loadu_ps(&(b[i]));
+
+		__m256 avx256_local_upper_sum = _mm256_mul_ps(avx256_a, avx256_b);
+		avx256_upper_sum = _mm256_add_ps(avx256_upper_sum, avx256_local_upper_sum);
+
+		// ----
+
+		__m256 avx256_local_lower_sum_a = _mm256_mul_ps(avx256_a, avx256_a);
+		avx256_lower_sum_a = _mm256_add_ps(avx256_lower_sum_a, avx256_local_lower_sum_a);
+
+		__m256 avx256_local_lower_sum_b = _mm256_mul_ps(avx256_b, avx256_b);
+		avx256_lower_sum_b = _mm256_add_ps(avx256_lower_sum_b, avx256_local_lower_sum_b);
+
+		i += 8;
+	}
+
+	_mm256_storeu_ps(vec_upper_sum, avx256_upper_sum);
+	_mm256_storeu_ps(vec_lower_sum_a, avx256_lower_sum_a);
+	_mm256_storeu_ps(vec_lower_sum_b, avx256_lower_sum_b);
+
+	for(int32_t j = 0 ; j < 8 ; j++){
+		upper_sum += vec_upper_sum[j];
+		lower_sum_a += vec_lower_sum_a[j];
+		lower_sum_b += vec_lower_sum_b[j];
+	}
+	while(i < n){
+		upper_sum += a[i] * b[i];
+		lower_sum_a += powf(a[i], 2.0f);
+		lower_sum_b += powf(b[i], 2.0f);
+		i++;
+	}
+	// printf("upper_sum: %f; lower_sum_a: %f; lower_sum_b: %f\n", upper_sum, lower_sum_a, lower_sum_b);
+	float cosine_similarity = (upper_sum / (sqrtf(lower_sum_a) * sqrtf(lower_sum_b)));
+	return (1.0f - cosine_similarity);
+}
+#endif
+
+#if ENABLE_AVX512 == 1
+float cosine_distance_fp32_avx512(const float* restrict const a, const float* restrict const b, int32_t n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	float upper_sum = 0.0;
+	float lower_sum_a = 0.0;
+	float lower_sum_b = 0.0;
+
+	__m512 avx512_upper_sum = _mm512_setzero_ps();
+	__m512 avx512_lower_sum_a = _mm512_setzero_ps();
+	__m512 avx512_lower_sum_b = _mm512_setzero_ps();
+
+	float vec_upper_sum[16];
+	float vec_lower_sum_a[16];
+	float vec_lower_sum_b[16];
+
+	int32_t i = 0;
+	while(i < n){
+		__m512 avx512_a = _mm512_loadu_ps(&(a[i])); // had to load unaligned
+		__m512 avx512_b = _mm512_loadu_ps(&(b[i]));
+
+		__m512 avx512_local_upper_sum = _mm512_mul_ps(avx512_a, avx512_b);
+		avx512_upper_sum = _mm512_add_ps(avx512_upper_sum, avx512_local_upper_sum);
+
+		// ----
+
+		__m512 avx512_local_lower_sum_a = _mm512_mul_ps(avx512_a, avx512_a);
+		avx512_lower_sum_a = _mm512_add_ps(avx512_lower_sum_a, avx512_local_lower_sum_a);
+
+		__m512 avx512_local_lower_sum_b = _mm512_mul_ps(avx512_b, avx512_b);
+		avx512_lower_sum_b = _mm512_add_ps(avx512_lower_sum_b, avx512_local_lower_sum_b);
+
+		i += 16;
+	}
+
+	_mm512_storeu_ps(vec_upper_sum, avx512_upper_sum);
+	_mm512_storeu_ps(vec_lower_sum_a, avx512_lower_sum_a);
+	_mm512_storeu_ps(vec_lower_sum_b, avx512_lower_sum_b);
+
+	for(int32_t j = 0 ; j < 16 ; j++){
+		upper_sum += vec_upper_sum[j];
+		lower_sum_a += vec_lower_sum_a[j];
+		lower_sum_b += vec_lower_sum_b[j];
+	}
+	while(i < n){
+		upper_sum += a[i] * b[i];
+		lower_sum_a += powf(a[i], 2.0f);
+		lower_sum_b += powf(b[i], 2.0f);
+		i++;
+	}
+	// printf("upper_sum: %f; lower_sum_a: %f; lower_sum_b: %f\n", upper_sum, lower_sum_a, lower_sum_b);
+	float cosine_similarity = (upper_sum / (sqrtf(lower_sum_a) * sqrtf(lower_sum_b)));
+	return (1.0f - cosine_similarity);
+}
+#endif
+
+// the two functions below split cosine_distance_fp32(_avx256/_avx512) in two, summing in the same order so that results are bit-identical;
+// n must be a multiple of 16 and a, b 64-byte aligned (rows of a graph snapshot panel, zero-padded)
+float vector_norm_fp32(const float* restrict const a, const int32_t n){
+	float lower_sum = 0.0f;
+	#if ENABLE_AVX512 == 1
+	__m512 avx512_lower_sum = _mm512_setzero_ps();
+	float vec_lower_sum[16];
+	for(int32_t i = 0 ; i < n ; i += 16){
+		__m512 avx512_a = _mm512_load_ps(&(a[i]));
+		avx512_lower_sum = _mm512_add_ps(avx512_lower_sum, _mm512_mul_ps(avx512_a, avx512_a));
+	}
+	_mm512_storeu_ps(vec_lower_sum, avx512_lower_sum);
+	for(int32_t j = 0 ; j < 16 ; j++){lower_sum += vec_lower_sum[j];}
+	#elif ENABLE_AVX256 == 1
+	__m256 avx256_lower_sum = _mm256_setzero_ps();
+	float vec_lower_sum[8];
+	for(int32_t i = 0 ; i < n ; i += 8){
+		__m256 avx256_a = _mm256_load_ps(&(a[i]));
+		avx256_lower_sum = _mm256_add_ps(avx256_lower_sum, _mm256_mul_ps(avx256_a, avx256_a));
+	}
+	_mm256_storeu_ps(vec_lower_sum, avx256_lower_sum);
+	for(int32_t j = 0 ; j < 8 ; j++){lower_sum += vec_lower_sum[j];}
+	#else
+	for(int32_t i = 0 ; i < n ; i++){
+		lower_sum += powf(a[i], 2.0f);
+	}
+	#endif
+	return sqrtf(lower_sum);
+}
+
+float cosine_distance_from_norms_fp32(const float* restrict const a, const float* restrict const b, const int32_t n, const float norm_a, const float norm_b){
+	float upper_sum = 0.0f;
+	#if ENABLE_AVX512 == 1
+	__m512 avx512_upper_sum = _mm512_setzero_ps();
+	float vec_upper_sum[16];
+	for(int32_t i = 0 ; i < n ; i += 16){
+		avx512_upper_sum = _mm512_add_ps(avx512_upper_sum, _mm512_mul_ps(_mm512_load_ps(&(a[i])), _mm512_load_ps(&(b[i]))));
+	}
+	_mm512_storeu_ps(vec_upper_sum, avx512_upper_sum);
+	for(int32_t j = 0 ; j < 16 ; j++){upper_sum += vec_upper_sum[j];}
+	#elif ENABLE_AVX256 == 1
+	__m256 avx256_upper_sum = _mm256_setzero_ps();
+	float vec_upper_sum[8];
+	for(int32_t i = 0 ; i < n ; i += 8){
+		avx256_upper_sum = _mm256_add_ps(avx256_upper_sum, _mm256_mul_ps(_mm256_load_ps(&(a[i])), _mm256_load_ps(&(b[i]))));
+	}
+	_mm256_storeu_ps(vec_upper_sum, avx256_upper_sum);
+	for(int32_t j = 0 ; j < 8 ; j++){upper_sum += vec_upper_sum[j];}
+	#else
+	for(int32_t i = 0 ; i < n ; i++){
+		upper_sum += a[i] * b[i];
+	}
+	#endif
+	float cosine_similarity = (upper_sum / (norm_a * norm_b));
+	return (1.0f - cosine_similarity);
+}
+
+double cosine_distance(const double* restrict const a, const double* restrict const b, int n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double upper_sum = 0.0;
+	double lower_sum_a = 0.0;
+	double lower_sum_b = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		upper_sum += a[i] * b[i];
+		lower_sum_a += pow(a[i], 2.0);
+		lower_sum_b += pow(b[i], 2.0);
+	}
+	double cosine_similarity = (upper_sum / (pow(lower_sum_a, 0.5) * pow(lower_sum_b, 0.5)));
+	return (1.0 - cosine_similarity);
+}
+
+double cosine_distance_norm(double* restrict a, double* restrict b, int32_t n){
+	return cosine_distance(a, b, n) / 2.0;
+}
+
+double chebyshev_distance(double* restrict a, double* restrict b, int n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double result = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double diff = a[i] - b[i];
+		if(diff < 0.0){
+			diff *= -1.0;
+		}
+		if(diff > result){
+			result = diff;
+		}
+	}
+	return result;
+}
+
+double canberra_distance(double* restrict a, double* restrict b, int n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double result = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double diff = a[i] - b[i];
+		if(diff < 0.0){
+			diff *= -1.0;
+		}
+		double a_ = a[i];
+		if(a_ < 0.0){
+			a_ *= -1.0;
+		}
+		double b_ = b[i];
+		if(b_ < 0.0){
+			b_ *= -1.0;
+		}
+		if(a_ + b_ != 0.0){
+			result += diff / (a_ + b_);
+		}
+	}
+	return result;
+}
+
+double bray_curtis_distance(double* restrict a, double* restrict b, int n){
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double upper_sum = 0.0;
+	double lower_sum = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		if(a[i] < b[i]){
+			upper_sum += a[i];
+		}
+		else{
+			upper_sum += b[i];
+		}
+		lower_sum += a[i] + b[i];
+	}
+	return (1.0 - ((2.0 * upper_sum) / lower_sum));
+}
+
+/*
+double rootless_angular_minkowski_distance(double* restrict a, double* restrict b, int n, double order){
+	// Lenz and Cornelis (2023)
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double a_p_norm = 0.0;
+	double b_p_norm = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double a_ = a[i];
+		double b_ = b[i];
+		a_ = pow(a_, order);
+		b_ = pow(b_, order);
+		if(a_ < 0.0){a_ *= -1.0;}
+		if(b_ < 0.0){b_ *= -1.0;}
+		a_p_norm += a_;
+		b_p_norm += b_;
+	}
+	a_p_norm = pow(a_p_norm, 1.0 / order);
+	b_p_norm = pow(b_p_norm, 1.0 / order);
+
+	
+	double global_norm = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double value = 0.0;
+		if(b_p_norm != 0.0){
+			value = (b[i] / b_p_norm);
+		}
+		if(a_p_norm != 0.0){
+			value -= (a[i] / a_p_norm);
+		}
+
+		value = pow(value, order);
+		if(value < 0.0){value *= -1.0;}
+		global_norm += value;
+	}
+	// return global_norm;
+	return (1.0 / order) * global_norm;
+	
+}
+
+double angular_minkowski_distance(double* restrict a, double* restrict b, int n, double order){
+	// Lenz and Cornelis (2023)
+	return pow(rootless_angular_minkowski_distance(a, b, n, order), 1.0 / order);
+}
+*/
+
+double angular_minkowski_distance(double* restrict a, double* restrict b, int32_t n, double order){
+	// Lenz and Cornelis (2023)
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	double a_p_norm = 0.0;
+	double b_p_norm = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double a_ = a[i];
+		double b_ = b[i];
+		a_ = pow(a_, order);
+		b_ = pow(b_, order);
+		if(a_ < 0.0){a_ *= -1.0;}
+		if(b_ < 0.0){b_ *= -1.0;}
+		a_p_norm += a_;
+		b_p_norm += b_;
+	}
+	a_p_norm = pow(a_p_norm, 1.0 / order);
+	b_p_norm = pow(b_p_norm, 1.0 / order);
+
+	
+	double global_norm = 0.0;
+	for(int i = 0 ; i < n ; i++){
+		double value = 0.0;
+		if(b_p_norm != 0.0){
+			value = (b[i] / b_p_norm);
+		}
+		if(a_p_norm != 0.0){
+			value -= (a[i] / a_p_norm);
+		}
+		if(value < 0.0){
+			value *= -1.0;
+		}
+
+		value = pow(value, order);
+		if(value < 0.0){value *= -1.0;}
+		global_norm += value;
+	}
+	/*
+	// return global_norm;
+	return (1.0 / order) * global_norm;
+	*/
+	double result = pow(global_norm, 1.0 / order);
+	return result;
+}
+
+double rootless_angular_minkowski_distance(double* restrict a, double* restrict b, int32_t n, double order){
+	return pow(angular_minkowski_distance(a, b, n, order), order);
+}
+
+float angular_minkowski_distance_fp32(float* restrict a, float* restrict b, int32_t n, float order){
+	// Lenz and Cornelis (2023)
+	#if MST_SANITY_TESTING == 1
+	if(n > 2){n = 2;}
+	#endif
+	float a_p_norm = 0.0f;
+	float b_p_norm = 0.0f;
+	for(int i = 0 ; i < n ; i++){
+		float a_ = a[i];
+		float b_ = b[i];
+		a_ = powf(a_, order);
+		b_ = powf(b_, order);
+		if(a_ < 0.0f){a_ *= -1.0f;}
+		if(b_ < 0.0f){b_ *= -1.0f;}
+		a_p_norm += a_;
+		b_p_norm += b_;
+	}
+	a_p_norm = powf(a_p_norm, 1.0f / order);
+	b_p_norm = powf(b_p_norm, 1.0f / order);
+
+	
+	float global_norm = 0.0f;
+	for(int i = 0 ; i < n ; i++){
+		float value = 0.0f;
+		if(b_p_norm != 0.0f){
+			value = (b[i] / b_p_norm);
+		}
+		if(a_p_norm != 0.0f){
+			value -= (a[i] / a_p_norm);
+		}
+		if(value < 0.0f){
+			value *= -1.0f;
+		}
+
+		value = powf(value, order);
+		if(value < 0.0f){value *= -1.0f;}
+		global_norm += value;
+	}
+	/*
+	// return global_norm;
+	return (1.0 / order) * global_norm;
+	*/
+	float result = powf(global_norm, 1.0f / order);
+	return result;
+}
+
+float rootless_angular_minkowski_distance_fp32(float* restrict a, float* restrict b, int32_t n, float order){
+	return powf(angular_minkowski_distance_fp32(a, b, n, order), order);
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+#include "stats.h"
+
+float avg_fp32(const float* p, const int32_t n){
+	float sum = 0.0f;
+	for(int32_t i = 0 ; i < n ; i++){
+		sum += p[i];
+	}
+	sum /= (float) n;
+	return sum;
+}
+
+float std_fp32(const float* p, const int32_t n){
+	float avg = avg_fp32(p, n);
+	float sum = 0.0f;
+	for(int32_t i = 0 ; i < n ; i++){
+		sum += powf(p[i] - avg, 2.0f);
+	}
+	sum /= (float) n;
+	float result = powf(sum, 0.5f);
+	return result;
+}
+
+void avg_and_std_fp32(const float* p, const int32_t n, float* avg_p, float* std_p){
+	float avg = avg_fp32(p, n);
+	float sum = 0.0f;
+	for(int32_t i = 0 ; i < n ; i++){
+		sum += powf(p[i] - avg, 2.0f);
+	}
+	sum /= (float) n;
+	float result = powf(sum, 0.5f);
+	(*avg_p) = avg;
+	(*std_p) = result;
+}
+
+double avg_fp64(const double* p, const int32_t n){
+	double sum = 0.0;
+	for(int32_t i = 0 ; i < n ; i++){
+		sum += p[i];
+	}
+	sum /= (double) n;
+	return sum;
+}
+
+double std_fp64(const double* p, const int32_t n){
+	double avg = avg_fp64(p, n);
+	double sum = 0.0;
+	for(int32_t i = 0 ; i < n ; i++){
+		sum += pow(p[i] - avg, 2.0);
+	}
+	sum /= (double) n;
+	double result = pow(sum, 0.5);
+	return result;
+}
+
+void avg_and_std_fp64(const double* p, const int32_t n, double* avg_p, double* std_p){
+	double avg = avg_fp64(p, n);
+	double sum = 0.0;
+	for(int32_t i = 0 ; i < n ; i++){
+		sum += pow(p[i] - avg, 2.0);
+	}
+	sum /= (double) n;
+	double result = pow(sum, 0.5);
+	(*avg_p) = avg;
+	(*std_p) = result;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sanitize.h"
+
+int32_t sanitize_for_shell(const char* const s, const size_t n, char** const z){
+	size_t alloc_size = n + 1024;
+	size_t i, j;
+
+	(*z) = malloc(alloc_size * sizeof(char));
+	if((*z) == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	memset((*z), '\0', alloc_size * sizeof(char));
+
+	j = 0;
+	for(i = 0 ; i < n ; i++){
+		if(j + 2 >= alloc_size){alloc_size += 1024; (*z) = realloc((*z), alloc_size * sizeof(char)); if((*z) == NULL){perror("failed to realloc\n"); return 1;}}
+		switch(s[i]){
+			case '\\':
+				(*z)[j] = '\\';
+				j++;
+				(*z)[j] = '\\';
+				j++;
+				break;
+			case '\n':
+				(*z)[j] = '\\';
+				j++;
+				(*z)[j] = 'n';
+				j++;
+				break;
+			case '\r':
+				(*z)[j] = '\\';
+				j++;
+				(*z)[j] = 'r';
+				j++;
+				break;
+			case '"':
+				(*z)[j] = '\\';
+				j++;
+				(*z)[j] = '"';
+				j++;
+				break;
+			default:
+				(*z)[j] = s[i];
+				j++;
+				break;
+		}
+	}
+	return 0;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+
+#define DEFINE_UNICODE_CONSTANTS
+#include "unicode/utf8.h"
+#include "unicode/unicode.h"
+#ifndef UTF8_NO_TABLES
+#include "unicode/utf8_tables.h" // generated in the build directory by generate_tables.c
+#endif
+
+int8_t utf8_get_length(const char * const s){
+    if((s[0] & 0xf8) == 0xf0){return 4;}      // if((s[0] & 0b11111000) == 0b11110000){return 4;} // starts with 11110
+    else if((s[0] & 0xf0) == 0xe0){return 3;} // else if((s[0] & 0b11110000) == 0b11100000){return 3;} // starts with 1110
+    else if((s[0] & 0xe0) == 0xc0){return 2;} // else if((s[0] & 0b11100000) == 0b11000000){return 2;} // starts with 110
+    else if((s[0] & 0x80) == 0x00){return 1;} // else if((s[0] & 0b10000000) == 0b00000000){return 1;} // starts with 0
+    else {return -1;} // not well-formed
+}
+
+int32_t utf8_is_well_formed(const char * const s, int8_t * const len_p){
+    const int8_t len = utf8_get_length(s);
+
+    *len_p = len;
+
+    if(len == -1){return 0;} // not well-formed
+
+    int8_t i;
+    for(i = 1 ; i < len ; i++){
+        if((s[i] & 0xc0) != 0x80){return 0;} // if((s[i] & 0b11000000) != 0b10000000){return 0;} // not well-formed
+    }
+
+    return 1; // well-formed
+}
+
+unicode_t utf8_to_unicode(const char * const s, int8_t * const len_p){
+    unicode_t unicode = 0;
+    int8_t len = utf8_get_length(s);
+
+    *len_p = len;
+
+    if(len == -1){return -1;}
+
+    if(len == 1){
+        unicode = (unicode_t) ((uint8_t) s[0]);
+    } else if(len == 2){
+        unicode = ((unicode_t) ((uint8_t) s[0] & 0x1f)) << 6; // unicode = ((unicode_t) ((uint8_t) s[0] & 0b00011111)) << 6;
+        unicode += ((unicode_t) ((uint8_t) s[1] & 0x3f)); // unicode += ((unicode_t) ((uint8_t) s[1] & 0b00111111));
+    } else if(len == 3){
+        unicode = ((unicode_t) ((uint8_t) s[0] & 0x0f)) << 12; // unicode = ((unicode_t) ((uint8_t) s[0] & 0b00001111)) << 12;
+        unicode += ((unicode_t) ((uint8_t) s[1] & 0x3f)) << 6; // unicode += ((unicode_t) ((uint8_t) s[1] & 0b00111111)) << 6;
+        unicode += ((unicode_t) ((uint8_t) s[2] & 0x3f)); // unicode += ((unicode_t) ((uint8_t) s[2] & 0b00111111));
+    } else if(len == 4){
+        unicode = ((unicode_t) ((uint8_t) s[0] & 0x07)) << 18; // unicode = ((unicode_t) ((uint8_t) s[0] & 0b00000111)) << 18;
+        unicode += ((unicode_t) ((uint8_t) s[1] & 0x3f)) << 12; // unicode += ((unicode_t) ((uint8_t) s[1] & 0b00111111)) << 12;
+        unicode += ((unicode_t) ((uint8_t) s[2] & 0x3f)) << 6; // unicode += ((unicode_t) ((uint8_t) s[2] & 0b00111111)) << 6;
+        unicode += ((unicode_t) ((uint8_t) s[3] & 0x3f)); // unicode += ((unicode_t) ((uint8_t) s[3] & 0b00111111));
+    }
+    return unicode;
+}
+
+// reference classification, from which the tables are generated
+int32_t unicode_to_subset_ranges(const unicode_t code){
+   //  if(UNICODE_BASIC_LATIN_BEG <= code && code <= UNICODE_BASIC_LATIN_END){return UNICODE_BASIC_LATIN;}
+    if(UNICODE_LATIN_UPPER_BEG <= code && code <= UNICODE_LATIN_UPPER_END){return UNICODE_LETTER;}
+    if(UNICODE_LATIN_LOWER_BEG <= code && code <= UNICODE_LATIN_LOWER_END){return UNICODE_LETTER;}
+    if(UNICODE_NUMBER_BEG <= code && code <= UNICODE_NUMBER_END){return UNICODE_NUMBER;}
+    if(UNICODE_LATIN_PUNCTUATION1_BEG <= code && code <= UNICODE_LATIN_PUNCTUATION1_END){return UNICODE_PUNCTUATION;}
+    if(UNICODE_LATIN_PUNCTUATION2_BEG <= code && code <= UNICODE_LATIN_PUNCTUATION2_END){return UNICODE_PUNCTUATION;}
+    if(UNICODE_LATIN_PUNCTUATION3_BEG <= code && code <= UNICODE_LATIN_PUNCTUATION3_END){return UNICODE_PUNCTUATION;}
+    if(UNICODE_LATIN_PUNCTUATION4_BEG <= code && code <= UNICODE_LATIN_PUNCTUATION4_END){return UNICODE_PUNCTUATION;}
+    if(UNICODE_SUPPLEMENTAL_PUNCTUATION_BEG <= code && code <= UNICODE_SUPPLEMENTAL_PUNCTUATION_END){return UNICODE_PUNCTUATION;}
+    if(UNICODE_CURRENCY_BEG <= code && code <= UNICODE_CURRENCY_END){return UNICODE_CURRENCY;}
+    if(UNICODE_EMOTICON_BEG <= code && code <= UNICODE_EMOTICON_END){return UNICODE_EMOTICON;}
+    if(UNICODE_PHONETIC_EXTENSION_BEG <= code && code <= UNICODE_PHONETIC_EXTENSION_END){return UNICODE_PHONETIC;}
+
+    return UNICODE_OTHER;
+}
+
+int32_t unicode_to_subset(const unicode_t code){
+    #ifdef UTF8_NO_TABLES
+    return unicode_to_subset_ranges(code);
+    #else
+    if(code < 0 || code >= (((unicode_t) UTF8_TABLES_NUM_BLOCKS) << UTF8_TABLES_BLOCK_SHIFT)){return UNICODE_OTHER;}
+    return utf8_tables_blocks[utf8_tables_index[code >> UTF8_TABLES_BLOCK_SHIFT]][code & UTF8_TABLES_BLOCK_MASK];
+    #endif
+}
+
+int32_t utf8_to_unicode_subset(const char * const s, int8_t * const len_p){
+    unicode_t code = utf8_to_unicode(s, len_p);
+    if(code == -1){return -1;}
+    return unicode_to_subset(code);
+}
+
+char * utf8_normalise(char * const s){
+    // int32_t count_letter = 0;
+    int32_t count_number = 0;
+    int32_t count_punctuation = 0;
+    int32_t count_currency = 0;
+    int32_t count_emoticon = 0;
+    // int32_t count_phonetic = 0;
+    // int32_t count_other = 0;
+
+    int8_t found_hyphen = 0;
+    int8_t found_non_hyphen = 0;
+
+    int8_t len;
+
+    int32_t index = 0;
+    while(index < 64 && s[index] != '\0'){
+        int32_t unicode_subset;
+        #ifdef UTF8_NO_TABLES
+        unicode_subset = utf8_to_unicode_subset(&s[index], &len);
+        if(len == -1){index++; continue;}
+        #else
+        // ASCII fast path: one table lookup, no decoding
+        const uint8_t c = (uint8_t) s[index];
+        if(c < 0x80){
+            unicode_subset = utf8_tables_ascii[c];
+            len = 1;
+        } else {
+            const unicode_t code = utf8_to_unicode(&s[index], &len);
+            if(len == -1){index++; continue;}
+            unicode_subset = unicode_to_subset(code);
+        }
+        #endif
+
+        switch(unicode_subset){
+//            case UNICODE_LETTER:
+//                count_letter++;
+//                break;
+            case UNICODE_NUMBER:
+                count_number++;
+                break;
+            case UNICODE_PUNCTUATION:
+                count_punctuation++;
+                if(len == 1){
+                    if(s[index] == '-'){found_hyphen = 1;}
+                    else {found_non_hyphen = 1;}
+                }
+                break;
+            case UNICODE_CURRENCY:
+                count_currency++;
+                break;
+            case UNICODE_EMOTICON:
+                count_emoticon++;
+                break;
+//            case UNICODE_PHONETIC:
+//                count_phonetic++;
+//                break;
+//            case UNICODE_OTHER:
+//                count_other++;
+//                break;
+            default:
+		break;
+        }
+
+        index += len;
+    }
+
+    if(found_hyphen && !found_non_hyphen){return s;}
+    if(count_number >= 2){return "[NUMBER]";}
+    if(count_emoticon >= 1){return "[EMOTICON]";}
+    if(count_punctuation >= 2){return "[PUNCTUATION_GROUP]";}
+    if(count_currency >= 1){return "[CURRENCY]";}
+
+    return s;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "distributions.h"
+
+#ifndef FP_MODES
+#define FP_MODES
+enum {
+	FP32,
+	FP64
+};
+#endif
+
+int32_t create_zipfian_distribution(struct zipfian_distribution* z, double s, uint32_t n, const int8_t fp_mode){
+	size_t malloc_size = n;
+	switch(fp_mode){
+		case FP32:
+			malloc_size *= 4;
+			break;
+		case FP64:
+			malloc_size *= 8;
+			break;
+	}
+	void* malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		perror("failed to malloc\n");
+		return 1;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	switch(fp_mode){
+		case FP32:
+			z->vector.fp32 = (float*) malloc_pointer;
+			break;
+		case FP64:
+			z->vector.fp64 = (double*) malloc_pointer;
+			break;
+	}
+
+	double p_sum = 0.0;
+	for(uint32_t i = 1 ; i <= n ; i++){
+		double p = pow(((double) i), -s);
+		switch(fp_mode){
+			case FP32:
+				z->vector.fp32[i-1] = p;
+				break;
+			case FP64:
+				z->vector.fp64[i-1] = p;
+				break;
+		}
+		p_sum += p;
+	}
+	for(uint32_t i = 0 ; i < n ; i++){
+		switch(fp_mode){
+			case FP32:
+				z->vector.fp32[i] /= p_sum;
+				break;
+			case FP64:
+				z->vector.fp64[i] /= p_sum;
+				break;
+		}
+	}
+
+	z->s = s;
+	z->n = n;
+
+	return 0;
+}
+
+void free_zipfian_distribution(struct zipfian_distribution* z, const int8_t fp_mode){
+	switch(fp_mode){
+		case FP32:
+			free(z->vector.fp32);
+			break;
+		case FP64:
+			free(z->vector.fp64);
+			break;
+	}
+}
+
+double mean_squared_error(double* v, double* w, uint32_t n){
+	double sum = 0.0;
+	for(uint32_t i = 0 ; i < n ; i++){
+		sum += pow(w[i] - v[i], 2.0);
+	}
+	return (sum / ((double) n));
+}
+
+int32_t double_cmp_reverse(const void* a, const void* b){
+	double a_ = (*((double*) a));
+	double b_ = (*((double*) b));
+	if(a_ > b_){
+		return -1;
+	} else if(a_ < b_){
+		return 1;
+	}
+	return 0;
+}
+
+int32_t zipfian_fit(double* v, uint32_t n, double* result){
+	const int32_t num_precision_levels = 8;
+	const int32_t num_iter = 32;
+	double lower_bound = 0.0;
+	double upper_bound = 10.0;
+	double best_s = -1.0;
+	double best_mse = -1.0;
+	double *v_copy;
+	size_t alloc_size;
+    /*
+    time_t t_start, t_end;
+
+    t_start = time(NULL);
+    */
+
+	alloc_size = n * sizeof(double);
+	v_copy = malloc(alloc_size);
+	if(v_copy == NULL){perror("failed to malloc\n"); return 1;}
+	memcpy(v_copy, v, alloc_size);
+
+	qsort((void*) v_copy, n, sizeof(double), double_cmp_reverse);
+
+	for(int32_t i = 0 ; i < num_precision_levels ; i++){
+		double window = (upper_bound - lower_bound);
+		double step = window / (((double) num_iter) - 1.0);
+		best_s = -1.0;
+		best_mse = -1.0;
+		for(int32_t j = 0 ; j < num_iter ; j++){
+			double s = lower_bound + step * ((double) j);
+			struct zipfian_distribution z;
+			int32_t err = create_zipfian_distribution(&z, s, n, FP64);
+			if(err != 0){
+				perror("failed to call create_zipfian_distribution\n");
+				free(v_copy);
+				return 1;
+			}
+
+			double mse = mean_squared_error(v_copy, z.vector.fp64, n);
+			if(j == 0 || mse < best_mse){
+				best_s = s;
+				best_mse = mse;
+			}
+
+			free_zipfian_distribution(&z, FP64);
+		}
+
+		lower_bound = best_s - ((window / 10.0) / 2.0);
+		upper_bound = best_s + ((window / 10.0) / 2.0);
+		if(lower_bound < 0.0){
+			lower_bound = 0.0;
+		}
+
+	}
+
+	(*result) = best_s;
+
+	free(v_copy);
+
+    /*
+    t_end = time(NULL);
+    printf("Zipfian curvature computed in %lus\n", t_end - t_start);
+    */
+
+	return 0;
+}
+
+// fits the proportions of the snapshot, which may hold fewer nodes than g
+int32_t zipfian_fit_from_graph(struct graph* g, double* result){
+	const uint64_t num_nodes = g->snapshot.num_nodes;
+	size_t malloc_size = num_nodes * sizeof(double);
+	void* malloc_pointer = malloc(malloc_size);
+	if(malloc_pointer == NULL){
+		perror("failed to malloc\n");
+		return 1;
+	}
+	memset(malloc_pointer, '\0', malloc_size);
+	double* series = (double*) malloc_pointer;
+
+	for(uint64_t i = 0 ; i < num_nodes ; i++){
+		series[i] = g->snapshot.relative_proportions[i];
+	}
+
+	int32_t err = zipfian_fit(series, num_nodes, result);
+	if(err != 0){
+		perror("failed to call zipfian_fit\n");
+		free(series);
+		return 1;
+	}
+
+	free(series);
+
+	return 0;
+}
+
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+
+int32_t get_cpu_info(struct cpu_info * const result){
+    FILE * f;
+    const int32_t bfr_size = 2048;
+    char bfr[bfr_size];
+    const char processor_key[] = "processor\t: ";
+    const size_t processor_key_length = strlen(processor_key);
+    const char flag_key[] = "flags\t\t: ";
+    const size_t flag_key_length = strlen(flag_key);
+    const char avx256_key[] = "avx2";
+    const size_t avx256_key_length = strlen(avx256_key);
+    const char avx512_key[] = "avx512";
+    const size_t avx512_key_length = strlen(avx512_key);
+    int64_t max_proc, current_proc;
+    uint8_t avx256_capable, avx512_capable;
+    char * strtok_placeholder;
+
+    f = fopen("/proc/cpuinfo", "r");
+    if(f == NULL){
+        perror("Failed to open \"/proc/cpuinfo\"\n");
+        return 1;
+    }
+
+    memset(bfr, '\0', bfr_size);
+
+    max_proc = -1;
+    avx256_capable = 0;
+    avx512_capable = 0;
+    while(fgets(bfr, bfr_size, f)){
+        if(strncmp(processor_key, bfr, processor_key_length) == 0){
+            current_proc = strtol(&(bfr[processor_key_length]), NULL, 10);
+            if(current_proc > max_proc){max_proc = current_proc;}
+        } else if(strncmp(flag_key, bfr, flag_key_length) == 0){
+            strtok_placeholder = strtok(&(bfr[flag_key_length]), " ");
+            while((avx256_capable == 0 || avx512_capable == 0) && strtok_placeholder != NULL){
+                // printf("current_token: %s\n", strtok_placeholder);
+                if(strncmp(avx256_key, strtok_placeholder, avx256_key_length) == 0){avx256_capable = 1;}
+                else if(strncmp(avx512_key, strtok_placeholder, avx512_key_length) == 0){avx512_capable = 1;}
+                strtok_placeholder = strtok(NULL, " ");
+            }
+        }
+    }
+
+    fclose(f);
+
+    if(max_proc == -1){
+        perror("Could not find number of virtual cores in \"/proc/cpuinfo\"\n");
+        return 1;
+    }
+
+    (*result) = (struct cpu_info) {
+        .cardinality_virtual_cores = (uint16_t) (max_proc + 1),
+        .avx256_capable = avx256_capable,
+        .avx512_capable = avx512_capable,
+    };
+
+    return 0;
+}
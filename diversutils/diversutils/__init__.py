@@ -1,26 +1,103 @@
-from _diversutils import _attach_distance_matrix
+from _diversutils import _attach_distance_matrix, _node_proportions, _distance_matrix
+from _diversutils import add_nodes as _add_nodes, update_counts as _update_counts, _measure_many, _score_files, _ingest
 from _diversutils import *
 import numpy as _np
-import ctypes as _ct
 
-def attach_distance_matrix(graph_index: int, matrix: _np.ndarray, fp_mode: int = FP32):
+def attach_distance_matrix(graph_index: int, matrix: _np.ndarray, fp_mode: int = None):
+    """The graph reads the matrix in place and keeps a reference to it: writing into the array changes the distances the graph sees.
+    A matrix of another dtype than the one of fp_mode is converted once, and the graph keeps the converted copy."""
     if type(graph_index) != int:
         raise Exception("graph_index must be of type int")
     if type(matrix) != _np.ndarray:
         raise Exception("matrix must be of type numpy.ndarray")
+    if fp_mode is None:
+        fp_mode = FP64 if matrix.dtype == _np.float64 else FP32
     if type(fp_mode) != int:
         raise Exception("fp_mode must be of type int")
     if fp_mode == FP32:
-        matrix = matrix.astype(_np.float32)
+        dtype = _np.float32
     elif fp_mode == FP64:
-        matrix = matrix.astype(_np.float64)
+        dtype = _np.float64
     else:
         raise Exception("fp_mode must be either FP32 or FP64")
 
-    bfr = matrix.tobytes()
-    #void_p = _ct.addressof(bfr)
-    c_bfr = _ct.c_buffer(bfr)
-    void_p = _ct.addressof(c_bfr)
+    if matrix.dtype != dtype:
+        matrix = matrix.astype(dtype, order="C")
 
-    _attach_distance_matrix(graph_index, void_p, fp_mode)
+    return _attach_distance_matrix(graph_index, matrix)
 
+def node_proportions(graph_index: int) -> _np.ndarray:
+    """Read-only array over the relative proportions of the nodes, without copy.
+    While the array (or any array derived from it) is alive, the graph cannot gain nodes, change its matrix or be freed."""
+    return _np.asarray(_node_proportions(graph_index))
+
+def distance_matrix(graph_index: int) -> _np.ndarray:
+    """Read-only array over the distance matrix of the graph, without copy; same lifetime rules as node_proportions."""
+    return _np.asarray(_distance_matrix(graph_index))
+
+def _integers(values):
+    # lists are converted; buffers are passed as they are, so that the C side sees (and rejects) non-contiguous ones
+    return _np.asarray(values, dtype=_np.int64) if isinstance(values, (list, tuple)) else values
+
+def add_nodes(graph_index: int, vectors, counts, keys=None) -> int:
+    """Adds len(counts) nodes in one call and returns the index of the first one.
+    vectors is None or a float32 array of shape (len(counts), num_dimensions), read in place; keys are Word2Vec keys of the bound vector space."""
+    return _add_nodes(graph_index, vectors, _integers(counts), keys)
+
+def update_counts(graph_index: int, indices, deltas):
+    """Adds deltas[i] to the count of node indices[i]; if any count would become negative, no count changes."""
+    return _update_counts(graph_index, _integers(indices), _integers(deltas))
+
+def measure_many(graph_index: int, ids, params: dict = None, num_threads: int = 1, timings: bool = False):
+    """Computes several functions in one native call, building the distance matrix and MST once for all of them.
+    Returns a float64 array of shape (len(ids), 2): the values of each function, NaN where it has a single one.
+    params may hold "alpha" and "beta", as in individual_measure. With timings=True, returns (values, seconds, shared_seconds):
+    the seconds of each function, and those spent on what they share (snapshot, memo, matrix, MST)."""
+    params = dict() if params is None else params
+    unknown = set(params) - {"alpha", "beta"}
+    if unknown:
+        raise ValueError(f"unknown parameters: {sorted(unknown)}")
+    ids = _np.ascontiguousarray(ids, dtype=_np.int64)
+    values = _np.full((len(ids), 2), _np.nan)
+    seconds = _np.zeros(len(ids)) if timings else None
+    shared_seconds = _measure_many(graph_index, ids, values, seconds, alpha=float(params.get("alpha", 1.0)), beta=float(params.get("beta", 1.0)), num_threads=num_threads)
+    return (values, seconds, shared_seconds) if timings else values
+
+def ingest_tokens(graph_index: int, tokens, batch_size: int = 4096, normalise: bool = False):
+    """Adds one occurrence per str of tokens to the graph, which must be bound to a Word2Vec; tokens are looked up as they are, as the JSONL loader does after tokenization.
+    tokens may be any iterable, read batch_size at a time; the GIL is released while each batch is added. Returns (number of tokens, number of them out of the vocabulary)."""
+    return _ingest(graph_index, tokens, documents=False, batch_size=batch_size, normalise=normalise)
+
+def ingest_documents(graph_index: int, documents, batch_size: int = 256, normalise: bool = False):
+    """Same as ingest_tokens, but each str is tokenized by the tokenizer of the JSONL loader, as the text of one document.
+    Returns (number of documents, number of out-of-vocabulary tokens)."""
+    return _ingest(graph_index, documents, documents=True, batch_size=batch_size, normalise=normalise)
+
+def _function_names():
+    names = dict()
+    for name, value in sorted(globals().items()):
+        if name.startswith("DF_"):
+            names.setdefault(value, name)
+    return names
+
+def score_files(paths, functions, w2v_index: int, gold_paths=None, target_column: int = -1, shared: bool = False, num_threads: int = 1, step: int = 0, callback=None) -> _np.ndarray:
+    """Reads the files with num_threads native threads, into one graph per file or, with shared=True, into a single graph, and measures each graph.
+    Returns a record array with one row per graph: path (None for the shared graph), num_nodes, num_sentences, num_documents, num_oov_types,
+    and, for each function, a field named after its DF_ constant holding its two values (NaN where it has a single one).
+    With step > 0 and a callback, the callback receives such a row (as a record) every step sentences of a CUPT file or documents of a JSONL file;
+    the graph being read is locked meanwhile, and an exception raised by the callback stops the reading and propagates."""
+    paths = [str(p) for p in paths]
+    functions = [int(f) for f in functions]
+    names = _function_names()
+    fields = [(names.get(f, f"f{f}"), _np.float64, (2,)) for f in functions]
+    dtype = _np.dtype([("path", object), ("num_nodes", _np.uint64), ("num_sentences", _np.uint64), ("num_documents", _np.uint64), ("num_oov_types", _np.int64)] + fields)
+
+    def record(row):
+        path_index, num_nodes, num_sentences, num_documents, num_oov_types, values = row
+        path = paths[path_index] if 0 <= path_index < len(paths) else None
+        pairs = [tuple(values[2 * k:2 * k + 2]) for k in range(len(functions))]
+        return (path, num_nodes, num_sentences, num_documents, num_oov_types, *pairs)
+
+    step_callback = None if callback is None else (lambda row: callback(_np.rec.array([record(row)], dtype=dtype)[0]))
+    rows = _score_files(paths, [] if gold_paths is None else [str(p) for p in gold_paths], functions, w2v_index, target_column, shared=shared, num_threads=num_threads, step=step, callback=step_callback)
+    return _np.rec.array([record(row) for row in rows], dtype=dtype)
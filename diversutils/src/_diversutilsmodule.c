@@ -30,15 +30,19 @@
 #include <stdint.h>
 
 #include "graph.h"
+#include "snapshot.h"
 #include "cfgparser/parser.h"
 
 #include "measurement.h"
 #include "dfunctions.h"
+#include "instrument.h"
+#include "logging.h"
 
 #include "cupt/parser.h"
 #include "cupt/load.h"
 #include "jsonl/parser.h"
 #include "jsonl/load.h"
+#include "file_queue.h"
 
 // for Python bundle
 #ifndef DEFINE_UNICODE_CONSTANTS
@@ -84,19 +88,377 @@ enum {
 	ID_DISPARITY_AGG_MST,
 };
 
+// what a call may use after releasing the GIL; allocated once per graph, so that its address survives the growth of the arrays below
+struct interface_graph_slot {
+	struct graph g;
+	struct minimum_spanning_tree mst;
+	pthread_mutex_t mutex; // guards g and mst; only ever waited for without the GIL, see interface_lock_graph
+	int32_t word2vec_slots_w2v; // word2vec that g->word2vec_slots were built for by ingest_tokens and ingest_documents
+	uint64_t word2vec_slots_num_nodes; // nodes already entered in g->word2vec_slots
+	uint8_t word2vec_slots_bound;
+};
+
+// same for a word2vec, which several graphs and calls may read at once
+struct interface_word2vec_slot {
+	struct word2vec w2v;
+	pthread_rwlock_t lock; // read-held while w2v is used without the GIL, write-held by free_w2v
+};
+
 static uint32_t num_graphs = 0;
-static struct graph* global_graphs = NULL;
+static uint32_t num_graph_slots = 0; // can exceed num_graphs by one after a failed creation
+static struct interface_graph_slot** global_graph_slots = NULL;
 static uint8_t* global_graphs_freed = NULL;
 static int32_t* global_graphs_word2vec_bindings = NULL;
 
-static struct minimum_spanning_tree* msts = NULL;
-
 static uint32_t num_w2v = 0;
 static uint8_t* global_w2v_freed = NULL;
-static struct word2vec* global_word2vecs = NULL;
+static struct interface_word2vec_slot** global_word2vec_slots = NULL;
 
 static struct cfg* configurations = NULL;
 
+// Python memory a graph points into; it stays acquired until the graph is freed or the matrix is replaced
+struct interface_held_buffers {
+	Py_buffer** vectors; // one per node whose vector was given as a buffer
+	uint64_t num_vectors;
+	uint64_t capacity_vectors;
+	Py_buffer* dist_mat; // NULL unless the distance matrix was attached from a buffer
+};
+
+static struct interface_held_buffers* global_graphs_held_buffers = NULL;
+// number of live array views per graph; while it is not zero, nothing may move or free the memory they show
+static uint32_t* global_graphs_exports = NULL;
+
+// read-only view of memory owned by a graph, exported through the buffer protocol
+struct interface_array_view {
+	PyObject_HEAD
+	PyObject* module; // keeps the module, hence the graph arrays, alive as long as the view
+	void* bfr;
+	Py_ssize_t shape[2];
+	Py_ssize_t strides[2];
+	Py_ssize_t itemsize;
+	int32_t ndim;
+	int32_t graph_index;
+	char format[2];
+};
+
+static int interface_array_view_getbuffer(PyObject* exporter, Py_buffer* view, int flags){
+	struct interface_array_view* const self = (struct interface_array_view*) exporter;
+
+	if((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE){
+		PyErr_SetString(PyExc_BufferError, "graph views are read-only");
+		view->obj = NULL;
+		return -1;
+	}
+
+	Py_ssize_t len = self->itemsize;
+	for(int32_t i = 0 ; i < self->ndim ; i++){len *= self->shape[i];}
+
+	view->buf = self->bfr;
+	view->obj = exporter;
+	Py_INCREF(exporter);
+	view->len = len;
+	view->readonly = 1;
+	view->itemsize = self->itemsize;
+	view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? self->format : NULL;
+	view->ndim = self->ndim;
+	view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? self->shape : NULL;
+	view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+static void interface_array_view_dealloc(PyObject* exporter){
+	struct interface_array_view* const self = (struct interface_array_view*) exporter;
+	global_graphs_exports[self->graph_index]--;
+	Py_XDECREF(self->module);
+	PyObject_Free(exporter);
+}
+
+static PyBufferProcs interface_array_view_buffer_procs = {
+	.bf_getbuffer = interface_array_view_getbuffer,
+	.bf_releasebuffer = NULL,
+};
+
+static PyTypeObject interface_array_view_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "_diversutils._ArrayView",
+	.tp_basicsize = sizeof(struct interface_array_view),
+	.tp_itemsize = 0,
+	.tp_dealloc = interface_array_view_dealloc,
+	.tp_as_buffer = &interface_array_view_buffer_procs,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_doc = "Read-only view of memory owned by a graph.",
+};
+
+// the returned memoryview holds the view, which holds the graph: the graph cannot be reshaped or freed until it is released
+static PyObject* interface_new_array_view(PyObject* const module, const int32_t graph_index, void* const bfr, const int32_t ndim, const Py_ssize_t* const shape, const char format, const Py_ssize_t itemsize){
+	static double empty_bfr = 0.0; // a buffer may not have a NULL pointer, even when empty
+
+	struct interface_array_view* const self = PyObject_New(struct interface_array_view, &interface_array_view_type);
+	if(self == NULL){return NULL;}
+
+	self->module = module;
+	Py_XINCREF(module);
+	self->bfr = (bfr == NULL) ? (void*) &empty_bfr : bfr;
+	self->itemsize = itemsize;
+	self->ndim = ndim;
+	self->graph_index = graph_index;
+	self->format[0] = format;
+	self->format[1] = '\0';
+	for(int32_t i = ndim - 1 ; i >= 0 ; i--){
+		self->shape[i] = shape[i];
+		self->strides[i] = (i == ndim - 1) ? itemsize : self->strides[i + 1] * shape[i + 1];
+	}
+	global_graphs_exports[graph_index]++;
+
+	PyObject* const res = PyMemoryView_FromObject((PyObject*) self);
+	Py_DECREF(self);
+	return res;
+}
+
+static int32_t interface_graph_not_exported(const int32_t index){
+	if(global_graphs_exports[index] != 0){
+		PyErr_Format(PyExc_BufferError, "graph %i has %u live array view(s); release them first", index, global_graphs_exports[index]);
+		return 0;
+	}
+	return 1;
+}
+
+// native-order format character of a buffer, or '\0' when its items are not plain native scalars
+static char interface_buffer_format(const Py_buffer* const view){
+	const char* f = (view->format == NULL) ? "B" : view->format;
+	if(f[0] == '@' || f[0] == '=' || f[0] == (PY_LITTLE_ENDIAN ? '<' : '>')){f++;}
+	if(f[0] == '\0' || f[1] != '\0'){return '\0';}
+	return f[0];
+}
+
+// acquires a C-contiguous buffer of ndim dimensions; the caller releases it with PyBuffer_Release
+static int32_t interface_get_buffer(PyObject* const obj, Py_buffer* const view, const int32_t ndim, const char* const name){
+	if(PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0){
+		// exporters disagree on the exception (NumPy raises ValueError for non-contiguous arrays)
+		if(PyErr_ExceptionMatches(PyExc_BufferError) || PyErr_ExceptionMatches(PyExc_ValueError) || PyErr_ExceptionMatches(PyExc_TypeError)){
+			PyErr_Clear();
+			PyErr_Format(PyExc_BufferError, "%s must be a C-contiguous buffer (e.g. numpy.ascontiguousarray)", name);
+		}
+		return 1;
+	}
+	if(view->ndim != ndim){
+		PyErr_Format(PyExc_BufferError, "%s must have %i dimension(s), not %i", name, ndim, view->ndim);
+		PyBuffer_Release(view);
+		return 1;
+	}
+	return 0;
+}
+
+// FP32 or FP64 according to the item type of a buffer, -1 otherwise
+static int32_t interface_buffer_fp_mode(const Py_buffer* const view){
+	const char format = interface_buffer_format(view);
+	if(format == 'f' && view->itemsize == sizeof(float)){return FP32;}
+	if(format == 'd' && view->itemsize == sizeof(double)){return FP64;}
+	return -1;
+}
+
+// reads item i of a one-dimensional integer buffer; fails on non-integer items and on unsigned values above INT64_MAX
+static int32_t interface_buffer_integer_at(const Py_buffer* const view, const Py_ssize_t i, const char* const name, int64_t* const value){
+	const char format = interface_buffer_format(view);
+	const char* const item = ((const char*) view->buf) + i * view->itemsize;
+
+	if(format == '\0' || strchr("bBhHiIlLqQ", format) == NULL){
+		PyErr_Format(PyExc_BufferError, "%s must be integers", name);
+		return 1;
+	}
+	const uint8_t is_signed = (format >= 'a' && format <= 'z');
+	// buffers only promise byte alignment
+	switch(view->itemsize){
+		case 1: {
+			uint8_t u; memcpy(&u, item, 1);
+			*value = is_signed ? (int64_t) ((int8_t) u) : (int64_t) u;
+			break;
+		}
+		case 2: {
+			uint16_t u; memcpy(&u, item, 2);
+			*value = is_signed ? (int64_t) ((int16_t) u) : (int64_t) u;
+			break;
+		}
+		case 4: {
+			uint32_t u; memcpy(&u, item, 4);
+			*value = is_signed ? (int64_t) ((int32_t) u) : (int64_t) u;
+			break;
+		}
+		case 8: {
+			uint64_t u; memcpy(&u, item, 8);
+			if(!is_signed && u > INT64_MAX){
+				PyErr_Format(PyExc_ValueError, "%s at index %zd is too large", name, i);
+				return 1;
+			}
+			*value = (int64_t) u;
+			break;
+		}
+		default:
+			PyErr_Format(PyExc_BufferError, "%s have an unsupported item size", name);
+			return 1;
+	}
+	return 0;
+}
+
+static int32_t interface_buffer_count_at(const Py_buffer* const view, const Py_ssize_t i, uint64_t* const count){
+	int64_t value;
+	if(interface_buffer_integer_at(view, i, "counts", &value) != 0){return 1;}
+	if(value < 0){
+		PyErr_Format(PyExc_ValueError, "count at index %zd is negative", i);
+		return 1;
+	}
+	*count = (uint64_t) value;
+	return 0;
+}
+
+static int32_t interface_hold_vector_buffer(const int32_t index, Py_buffer* const view){
+	struct interface_held_buffers* const held = &(global_graphs_held_buffers[index]);
+	if(held->num_vectors == held->capacity_vectors){
+		const uint64_t capacity = (held->capacity_vectors == 0) ? 16 : held->capacity_vectors * 2;
+		Py_buffer** const vectors = realloc(held->vectors, capacity * sizeof(Py_buffer*));
+		if(vectors == NULL){return 1;}
+		held->vectors = vectors;
+		held->capacity_vectors = capacity;
+	}
+	held->vectors[held->num_vectors] = view;
+	held->num_vectors++;
+	return 0;
+}
+
+// the MST and its heap are derived from the nodes and the distance matrix, so they go whenever either changes
+static void interface_reset_mst(const int32_t index){
+	if(global_graph_slots[index]->mst.heap != NULL){
+		free_graph_distance_heap(global_graph_slots[index]->mst.heap);
+		free(global_graph_slots[index]->mst.heap);
+	}
+	free_minimum_spanning_tree(&global_graph_slots[index]->mst);
+}
+
+static void interface_release_distance_matrix(const int32_t index){
+	struct graph* const g = &(global_graph_slots[index]->g);
+	Py_buffer* const view = global_graphs_held_buffers[index].dist_mat;
+	if(view != NULL){
+		free(g->dist_mat.active);
+		free(g->dist_mat.active_final);
+		PyBuffer_Release(view);
+		free(view);
+		global_graphs_held_buffers[index].dist_mat = NULL;
+		g->dist_mat = (struct matrix) { .fp_mode = g->dist_mat.fp_mode, };
+	} else if(g->dist_mat_must_be_freed){
+		free_matrix(&(g->dist_mat));
+		g->dist_mat = (struct matrix) { .fp_mode = g->dist_mat.fp_mode, };
+	}
+	g->dist_mat_must_be_freed = 0;
+}
+
+static void interface_release_held_buffers(const int32_t index){
+	struct interface_held_buffers* const held = &(global_graphs_held_buffers[index]);
+	interface_release_distance_matrix(index);
+	for(uint64_t i = 0 ; i < held->num_vectors ; i++){
+		PyBuffer_Release(held->vectors[i]);
+		free(held->vectors[i]);
+	}
+	free(held->vectors);
+	memset(held, '\0', sizeof(struct interface_held_buffers));
+}
+
+// grows the per-graph arrays by one zeroed slot, at index num_graphs
+static int32_t interface_append_graph_slot(void){
+	size_t alloc_size;
+
+	// a slot left by a failed creation is reused as it is
+	if(num_graph_slots == num_graphs){
+		alloc_size = (num_graphs + 1) * sizeof(struct interface_graph_slot*);
+		global_graph_slots = realloc(global_graph_slots, alloc_size);
+		if(global_graph_slots == NULL){return 1;}
+		struct interface_graph_slot* const slot = calloc(1, sizeof(struct interface_graph_slot));
+		if(slot == NULL){return 1;}
+		if(pthread_mutex_init(&(slot->mutex), NULL) != 0){free(slot); return 1;}
+		global_graph_slots[num_graphs] = slot;
+		num_graph_slots++;
+	}
+	memset(&(global_graph_slots[num_graphs]->g), '\0', sizeof(struct graph));
+	memset(&(global_graph_slots[num_graphs]->mst), '\0', sizeof(struct minimum_spanning_tree));
+
+	alloc_size = (num_graphs + 1) * sizeof(uint8_t);
+	global_graphs_freed = realloc(global_graphs_freed, alloc_size);
+	if(global_graphs_freed == NULL){return 1;}
+	memset((void*) &(global_graphs_freed[num_graphs]), '\0', sizeof(uint8_t));
+
+	alloc_size = (num_graphs + 1) * sizeof(int32_t);
+	global_graphs_word2vec_bindings = realloc(global_graphs_word2vec_bindings, alloc_size);
+	if(global_graphs_word2vec_bindings == NULL){return 1;}
+	global_graphs_word2vec_bindings[num_graphs] = -1;
+
+	alloc_size = (num_graphs + 1) * sizeof(struct cfg);
+	configurations = realloc(configurations, alloc_size);
+	if(configurations == NULL){return 1;}
+	memset((void*) &(configurations[num_graphs]), '\0', sizeof(struct cfg));
+
+	alloc_size = (num_graphs + 1) * sizeof(struct interface_held_buffers);
+	global_graphs_held_buffers = realloc(global_graphs_held_buffers, alloc_size);
+	if(global_graphs_held_buffers == NULL){return 1;}
+	memset((void*) &(global_graphs_held_buffers[num_graphs]), '\0', sizeof(struct interface_held_buffers));
+
+	alloc_size = (num_graphs + 1) * sizeof(uint32_t);
+	global_graphs_exports = realloc(global_graphs_exports, alloc_size);
+	if(global_graphs_exports == NULL){return 1;}
+	global_graphs_exports[num_graphs] = 0;
+
+	return 0;
+}
+
+// the GIL is released while waiting for the mutex, since the thread holding it may itself be waiting for the GIL
+static struct interface_graph_slot* interface_lock_graph_slot(const int32_t index){
+	if(index < 0){PyErr_SetString(PyExc_Exception, "index must be >= 0"); return NULL;}
+	if(((uint32_t) index) >= num_graphs){PyErr_SetString(PyExc_Exception, "index too high"); return NULL;}
+
+	struct interface_graph_slot* const slot = global_graph_slots[index];
+	Py_BEGIN_ALLOW_THREADS
+	pthread_mutex_lock(&(slot->mutex));
+	Py_END_ALLOW_THREADS
+	return slot;
+}
+
+// same as interface_lock_graph_slot, but fails on a freed graph
+static struct interface_graph_slot* interface_lock_graph(const int32_t index){
+	struct interface_graph_slot* const slot = interface_lock_graph_slot(index);
+	if(slot == NULL){return NULL;}
+	if(global_graphs_freed[index]){
+		pthread_mutex_unlock(&(slot->mutex));
+		PyErr_SetString(PyExc_Exception, "graph already freed");
+		return NULL;
+	}
+	return slot;
+}
+
+static void interface_unlock_graph(struct interface_graph_slot* const slot){
+	pthread_mutex_unlock(&(slot->mutex));
+}
+
+// read-locks a word2vec for as long as a call uses it; same rule as interface_lock_graph_slot for the GIL
+static struct interface_word2vec_slot* interface_read_lock_w2v(const int32_t index){
+	if(index < 0){PyErr_SetString(PyExc_Exception, "index_w2v must be >= 0"); return NULL;}
+	if(((uint32_t) index) >= num_w2v){PyErr_SetString(PyExc_Exception, "index_w2v too high"); return NULL;}
+
+	struct interface_word2vec_slot* const slot = global_word2vec_slots[index];
+	Py_BEGIN_ALLOW_THREADS
+	pthread_rwlock_rdlock(&(slot->lock));
+	Py_END_ALLOW_THREADS
+	if(global_w2v_freed[index]){
+		pthread_rwlock_unlock(&(slot->lock));
+		PyErr_SetString(PyExc_Exception, "w2v already freed");
+		return NULL;
+	}
+	return slot;
+}
+
+static void interface_unlock_w2v(struct interface_word2vec_slot* const slot){
+	pthread_rwlock_unlock(&(slot->lock));
+}
+
 /* // DO NOT REMOVE
 static PyObject* interface_measurement_from_cfg(PyObject* self, PyObject* args){
 	char* config_path;
@@ -126,7 +488,6 @@ static PyObject* interface_create_empty_graph(PyObject* self, PyObject* args){
     (void) self;
 
 	PyObject* res;
-	size_t alloc_size;
 	int32_t num_nodes;
 	int32_t num_dimensions;
 
@@ -134,32 +495,9 @@ static PyObject* interface_create_empty_graph(PyObject* self, PyObject* args){
 		return NULL;
 	}
 
-	alloc_size = (num_graphs + 1) * sizeof(struct graph);
-	global_graphs = realloc(global_graphs, alloc_size);
-	if(global_graphs == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(global_graphs[num_graphs]), '\0', sizeof(struct graph));
-
-	alloc_size = (num_graphs + 1) * sizeof(struct minimum_spanning_tree);
-	msts = realloc(msts, alloc_size);
-	if(msts == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(msts[num_graphs]), '\0', sizeof(struct minimum_spanning_tree));
-
-	alloc_size = (num_graphs + 1) * sizeof(uint8_t);
-	global_graphs_freed = realloc(global_graphs_freed, alloc_size);
-	if(global_graphs_freed == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(global_graphs_freed[num_graphs]), '\0', sizeof(uint8_t));
+	if(interface_append_graph_slot() != 0){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
 
-	alloc_size = (num_graphs + 1) * sizeof(int32_t);
-	global_graphs_word2vec_bindings = realloc(global_graphs_word2vec_bindings, alloc_size);
-	if(global_graphs_word2vec_bindings == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	global_graphs_word2vec_bindings[num_graphs] = -1;
-
-	alloc_size = (num_graphs + 1) * sizeof(struct cfg);
-	configurations = realloc(configurations, alloc_size);
-	if(configurations == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(configurations[num_graphs]), '\0', sizeof(struct cfg));
-
-	if(create_graph(&(global_graphs[num_graphs]), num_nodes, (int16_t) num_dimensions, FP32) != 0){
+	if(create_graph(&(global_graph_slots[num_graphs]->g), num_nodes, (int16_t) num_dimensions, FP32) != 0){
 		PyErr_SetString(PyExc_Exception, "failed to call create_graph\n");
 		goto exit_failure;
 	}
@@ -179,7 +517,6 @@ static PyObject* interface_create_graph(PyObject* self, PyObject* args){
     (void) self;
 
 	PyObject* res;
-	size_t alloc_size;
 	int32_t num_nodes;
 	int32_t num_dimensions;
 	char* config_path;
@@ -188,32 +525,9 @@ static PyObject* interface_create_graph(PyObject* self, PyObject* args){
 		return NULL;
 	}
 
-	alloc_size = (num_graphs + 1) * sizeof(struct graph);
-	global_graphs = realloc(global_graphs, alloc_size);
-	if(global_graphs == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(global_graphs[num_graphs]), '\0', sizeof(struct graph));
-
-	alloc_size = (num_graphs + 1) * sizeof(struct minimum_spanning_tree);
-	msts = realloc(msts, alloc_size);
-	if(msts == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(msts[num_graphs]), '\0', sizeof(struct minimum_spanning_tree));
+	if(interface_append_graph_slot() != 0){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
 
-	alloc_size = (num_graphs + 1) * sizeof(uint8_t);
-	global_graphs_freed = realloc(global_graphs_freed, alloc_size);
-	if(global_graphs_freed == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(global_graphs_freed[num_graphs]), '\0', sizeof(uint8_t));
-
-	alloc_size = (num_graphs + 1) * sizeof(int32_t);
-	global_graphs_word2vec_bindings = realloc(global_graphs_word2vec_bindings, alloc_size);
-	if(global_graphs_word2vec_bindings == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	global_graphs_word2vec_bindings[num_graphs] = -1;
-
-	alloc_size = (num_graphs + 1) * sizeof(struct cfg);
-	configurations = realloc(configurations, alloc_size);
-	if(configurations == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(configurations[num_graphs]), '\0', sizeof(struct cfg));
-
-	if(create_graph(&(global_graphs[num_graphs]), num_nodes, (int16_t) num_dimensions, FP32) != 0){
+	if(create_graph(&(global_graph_slots[num_graphs]->g), num_nodes, (int16_t) num_dimensions, FP32) != 0){
 		PyErr_SetString(PyExc_Exception, "failed to call create_graph\n");
 		goto exit_failure;
 	}
@@ -243,22 +557,22 @@ static PyObject* interface_free_graph(PyObject* self, PyObject* args){
 		return NULL;
 	}
 
-	if(index < 0){
-		PyErr_SetString(PyExc_Exception, "index must be >= 0\n");
-		return NULL;
-	}
-	if(((uint32_t) index) >= num_graphs){
-		PyErr_SetString(PyExc_Exception, "index too high\n");
-		return NULL;
-	}
+	if(index >= 0 && ((uint32_t) index) < num_graphs && !interface_graph_not_exported(index)){return NULL;}
+
+	// the slot itself stays, so that calls waiting for its mutex find the graph freed
+	struct interface_graph_slot* const slot = interface_lock_graph_slot(index);
+	if(slot == NULL){return NULL;}
 
 	if(global_graphs_freed[index] == 0){
-		free_graph(&(global_graphs[index]));
+		interface_reset_mst(index);
+		interface_release_held_buffers(index);
+		free_graph(&(slot->g));
 		free_cfg(&(configurations[index]));
 		global_graphs_freed[index] = 1;
 	} else {
 		printf("graph already freed\n");
 	}
+	interface_unlock_graph(slot);
 
 	PyObject* res = Py_BuildValue("i", 0);
 
@@ -283,13 +597,20 @@ static PyObject* interface_free_w2v(PyObject* self, PyObject* args){
 		return NULL;
 	}
 
+	// waits for every call still reading the vectors
+	struct interface_word2vec_slot* const slot = global_word2vec_slots[index];
+	Py_BEGIN_ALLOW_THREADS
+	pthread_rwlock_wrlock(&(slot->lock));
+	Py_END_ALLOW_THREADS
+
 	if(global_w2v_freed[index] == 0){
 		printf("trying to free\n");
-		free_word2vec(&(global_word2vecs[index]));
+		free_word2vec(&(slot->w2v));
 		global_w2v_freed[index] = 1;
 	} else {
 		printf("w2v already freed\n");
 	}
+	pthread_rwlock_unlock(&(slot->lock));
 
 	PyObject* res = Py_BuildValue("i", 0);
 
@@ -302,26 +623,37 @@ static PyObject* interface_load_w2v(PyObject* self, PyObject* args){
 	char* w2v_path;
 	size_t alloc_size;
 	PyObject* res;
+	int32_t err;
 
 	if(!PyArg_ParseTuple(args, "s", &w2v_path)){
 		return NULL;
 	}
 
-	alloc_size = (num_w2v + 1) * sizeof(struct word2vec);
-	global_word2vecs = realloc(global_word2vecs, alloc_size);
-	if(global_word2vecs == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
-	memset((void*) &(global_word2vecs[num_w2v]), '\0', sizeof(struct word2vec));
+	struct interface_word2vec_slot* const slot = calloc(1, sizeof(struct interface_word2vec_slot));
+	if(slot == NULL){PyErr_SetString(PyExc_Exception, "failed to calloc\n"); goto exit_failure;}
+	if(pthread_rwlock_init(&(slot->lock), NULL) != 0){free(slot); PyErr_SetString(PyExc_Exception, "failed to call pthread_rwlock_init\n"); goto exit_failure;}
+
+	// the slot is published only once loaded, so that nothing else can see it in the meantime
+	Py_BEGIN_ALLOW_THREADS
+	err = load_word2vec_binary(&(slot->w2v), w2v_path);
+	Py_END_ALLOW_THREADS
+	if(err != 0){
+		pthread_rwlock_destroy(&(slot->lock));
+		free(slot);
+		PyErr_SetString(PyExc_Exception, "failed to call load_word2vec_binary\n");
+		return NULL;
+	}
+
+	alloc_size = (num_w2v + 1) * sizeof(struct interface_word2vec_slot*);
+	global_word2vec_slots = realloc(global_word2vec_slots, alloc_size);
+	if(global_word2vec_slots == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
+	global_word2vec_slots[num_w2v] = slot;
 
 	alloc_size = (num_w2v + 1) * sizeof(uint8_t);
 	global_w2v_freed = realloc(global_w2v_freed, alloc_size);
 	if(global_w2v_freed == NULL){PyErr_SetString(PyExc_Exception, "failed to realloc\n"); goto exit_failure;}
 	memset((void*) &(global_w2v_freed[num_w2v]), '\0', sizeof(uint8_t));
 
-	if(load_word2vec_binary(&(global_word2vecs[num_w2v]), w2v_path) != 0){
-		PyErr_SetString(PyExc_Exception, "failed to call load_word2vec_binary\n");
-		return NULL;
-	}
-
 	res = Py_BuildValue("i", num_w2v);
 
 	num_w2v++;
@@ -358,87 +690,355 @@ static PyObject* interface_add_node(PyObject* self, PyObject* args){
     (void) self;
 
 	int32_t index;
-	int32_t absolute_proportion;
+	long long absolute_proportion;
+	PyObject* key_or_vector;
 	char* key;
 	int32_t w2v_index;
 
 	struct word2vec_entry* word2vec_entry_pointer;
 	float* vector_pointer;
+	Py_buffer* vector_view;
+	struct interface_word2vec_slot* w2v_slot;
 
+	key_or_vector = NULL;
 	key = NULL;
 
-	if(!PyArg_ParseTuple(args, "ii|s", &index, &absolute_proportion, &key)){return NULL;}
-	if(index < 0){PyErr_SetString(PyExc_Exception, "index must be >= 0\n"); return NULL;}
-	if(((uint32_t) index) >= num_graphs){PyErr_SetString(PyExc_Exception, "index too high\n"); return NULL;}
+	if(!PyArg_ParseTuple(args, "iL|O", &index, &absolute_proportion, &key_or_vector)){return NULL;}
 	if(absolute_proportion < 0){PyErr_SetString(PyExc_Exception, "absolute proportion cannot be negative\n"); return NULL;}
 
 	word2vec_entry_pointer = NULL;
 	vector_pointer = NULL;
+	vector_view = NULL;
+	w2v_slot = NULL;
+
+	if(key_or_vector != NULL && key_or_vector != Py_None && PyUnicode_Check(key_or_vector)){
+		key = (char*) PyUnicode_AsUTF8(key_or_vector);
+		if(key == NULL){return NULL;}
+	} else if(key_or_vector != NULL && key_or_vector != Py_None){
+		// the node reads the vector where the caller keeps it; the buffer is held until the graph is freed
+		vector_view = malloc(sizeof(Py_buffer));
+		if(vector_view == NULL){PyErr_NoMemory(); return NULL;}
+		if(interface_get_buffer(key_or_vector, vector_view, 1, "vector") != 0){free(vector_view); return NULL;}
+	}
+
+	// buffers are acquired before the lock, since an exporter may run Python code
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){goto release_vector;}
+	if(!interface_graph_not_exported(index)){goto unlock;}
 
 	if(key != NULL){
-		if(global_graphs_word2vec_bindings[index] < 0){PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); return NULL;}
-		w2v_index = word2vec_key_to_index(&(global_word2vecs[global_graphs_word2vec_bindings[index]]), key);
+		if(global_graphs_word2vec_bindings[index] < 0){PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); goto unlock;}
+		w2v_slot = interface_read_lock_w2v(global_graphs_word2vec_bindings[index]);
+		if(w2v_slot == NULL){goto unlock;}
+		w2v_index = word2vec_key_to_index(&(w2v_slot->w2v), key);
 		if(w2v_index == -1){
             #ifndef NDEBUG
 			fprintf(stdout, "unknown key: %s\n", key);
             #endif
-			return NULL;
+			PyErr_Format(PyExc_KeyError, "unknown key: %s", key);
+			goto unlock;
 		}
-		word2vec_entry_pointer = &(global_word2vecs[global_graphs_word2vec_bindings[index]].keys[w2v_index]);
-		vector_pointer = global_word2vecs[global_graphs_word2vec_bindings[index]].keys[w2v_index].vector;
-	}
-
-	if(global_graphs[index].num_nodes == global_graphs[index].capacity){
-		if(request_more_capacity_graph(&(global_graphs[index])) != 0){
-			PyErr_SetString(PyExc_Exception, "failed to call request_more_capacity_graph\n");
-			return NULL;
+		word2vec_entry_pointer = &(w2v_slot->w2v.keys[w2v_index]);
+		vector_pointer = w2v_slot->w2v.keys[w2v_index].vector;
+	} else if(vector_view != NULL){
+		if(interface_buffer_fp_mode(vector_view) != FP32 || vector_view->shape[0] != slot->g.num_dimensions || slot->g.num_dimensions <= 0){
+			PyErr_Format(PyExc_BufferError, "vector must hold %i float32 values", slot->g.num_dimensions);
+			goto unlock;
 		}
+		vector_pointer = (float*) vector_view->buf;
 	}
 
-	if(create_graph_node(&(global_graphs[index].nodes[global_graphs[index].num_nodes]), global_graphs[index].num_dimensions, FP32) != 0){
+	struct graph_node local_node = {0};
+	uint64_t node_index;
+	if(create_graph_node(&local_node, slot->g.num_dimensions, FP32) != 0){
 		PyErr_SetString(PyExc_Exception, "failed to call create_graph_node\n");
-		return NULL;
+		goto unlock;
 	}
-	global_graphs[index].nodes[global_graphs[index].num_nodes].absolute_proportion = (uint32_t) absolute_proportion;
-	global_graphs[index].nodes[global_graphs[index].num_nodes].word2vec_entry_pointer = word2vec_entry_pointer;
-	global_graphs[index].nodes[global_graphs[index].num_nodes].vector.fp32 = vector_pointer;
-	global_graphs[index].nodes[global_graphs[index].num_nodes].num_dimensions = global_graphs[index].num_dimensions;
-
-	global_graphs[index].num_nodes++;
+	local_node.absolute_proportion = (uint64_t) absolute_proportion;
+	local_node.word2vec_entry_pointer = word2vec_entry_pointer;
+	local_node.vector.fp32 = vector_pointer;
+	local_node.num_dimensions = slot->g.num_dimensions;
+
+	if(vector_view != NULL && interface_hold_vector_buffer(index, vector_view) != 0){
+		PyErr_NoMemory();
+		goto unlock;
+	}
+	vector_view = NULL;
 
-	// reset minimum spanning tree
-	
-	if(msts[index].heap != NULL){
-		free_graph_distance_heap(msts[index].heap);
-		free(msts[index].heap);
+	if(graph_append_node(&(slot->g), &local_node, &node_index) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call graph_append_node\n");
+		goto unlock;
 	}
-	free_minimum_spanning_tree(&msts[index]);
+
+	// an owned distance matrix and the MST are extended to the new nodes by the next measure that reads them
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	interface_unlock_graph(slot);
 
 	PyObject* res = Py_BuildValue("i", 0);
 
 	return res;
+
+	unlock:
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	interface_unlock_graph(slot);
+	release_vector:
+	if(vector_view != NULL){
+		PyBuffer_Release(vector_view);
+		free(vector_view);
+	}
+	return NULL;
 }
 
-static PyObject* interface_compute_relative_proportions(PyObject* self, PyObject* args){
+static PyObject* interface_set_counts(PyObject* self, PyObject* args){
     (void) self;
 
 	int32_t index;
+	PyObject* counts;
+	Py_buffer view;
 
-	if(!PyArg_ParseTuple(args, "i", &index)){
-        PyErr_SetString(PyExc_Exception, "Failed to parse arguments");
-		return NULL;
+	if(!PyArg_ParseTuple(args, "iO", &index, &counts)){return NULL;}
+
+	if(interface_get_buffer(counts, &view, 1, "counts") != 0){return NULL;}
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){PyBuffer_Release(&view); return NULL;}
+
+	struct graph* const g = &(slot->g);
+
+	if((uint64_t) view.shape[0] != g->num_nodes){
+		PyErr_Format(PyExc_BufferError, "counts must hold one value per node (%lu), not %zd", (unsigned long) g->num_nodes, view.shape[0]);
+		goto failure;
 	}
 
-	if(index < 0){
-		PyErr_SetString(PyExc_Exception, "index must be >= 0");
+	// every value is checked before the first one is written, so that a bad buffer leaves the graph as it was
+	for(Py_ssize_t i = 0 ; i < view.shape[0] ; i++){
+		uint64_t count;
+		if(interface_buffer_count_at(&view, i, &count) != 0){goto failure;}
+	}
+	for(Py_ssize_t i = 0 ; i < view.shape[0] ; i++){
+		interface_buffer_count_at(&view, i, &(graph_node_at(g, (uint64_t) i)->absolute_proportion));
+	}
+	graph_snapshot_mark_stale(g);
+	interface_unlock_graph(slot);
+	PyBuffer_Release(&view);
+
+	return Py_BuildValue("i", 0);
+
+	failure:
+	interface_unlock_graph(slot);
+	PyBuffer_Release(&view);
+	return NULL;
+}
+
+static PyObject* interface_add_nodes(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+	PyObject* vectors = Py_None;
+	PyObject* counts = NULL;
+	PyObject* keys = Py_None;
+	PyObject* keys_fast = NULL;
+	Py_buffer* vectors_view = NULL;
+	Py_buffer counts_view;
+	struct graph_node* nodes = NULL;
+	uint64_t first_index;
+	struct interface_graph_slot* slot = NULL;
+	struct interface_word2vec_slot* w2v_slot = NULL;
+
+	if(!PyArg_ParseTuple(args, "iOO|O", &index, &vectors, &counts, &keys)){return NULL;}
+
+	// buffers and keys are acquired before the lock, since they may run Python code
+	if(interface_get_buffer(counts, &counts_view, 1, "counts") != 0){return NULL;}
+	const Py_ssize_t n = counts_view.shape[0];
+
+	if(vectors != Py_None){
+		vectors_view = malloc(sizeof(Py_buffer));
+		if(vectors_view == NULL){PyErr_NoMemory(); goto failure;}
+		if(interface_get_buffer(vectors, vectors_view, 2, "vectors") != 0){free(vectors_view); vectors_view = NULL; goto failure;}
+	}
+
+	if(keys != Py_None){
+		keys_fast = PySequence_Fast(keys, "keys must be a sequence of str");
+		if(keys_fast == NULL){goto failure;}
+		if(PySequence_Fast_GET_SIZE(keys_fast) != n){
+			PyErr_Format(PyExc_ValueError, "keys must hold one key per node (%zd), not %zd", n, PySequence_Fast_GET_SIZE(keys_fast));
+			goto failure;
+		}
+	}
+
+	slot = interface_lock_graph(index);
+	if(slot == NULL){goto failure;}
+	if(!interface_graph_not_exported(index)){goto failure;}
+
+	struct graph* const g = &(slot->g);
+
+	if(vectors_view != NULL && (interface_buffer_fp_mode(vectors_view) != FP32 || vectors_view->shape[0] != n || vectors_view->shape[1] != g->num_dimensions || g->num_dimensions <= 0)){
+		PyErr_Format(PyExc_BufferError, "vectors must be float32 of shape (%zd, %i)", n, g->num_dimensions);
+		goto failure;
+	}
+	if(keys_fast != NULL){
+		if(global_graphs_word2vec_bindings[index] < 0){PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); goto failure;}
+		w2v_slot = interface_read_lock_w2v(global_graphs_word2vec_bindings[index]);
+		if(w2v_slot == NULL){goto failure;}
+	}
+
+	nodes = malloc((n > 0 ? (size_t) n : 1) * sizeof(struct graph_node));
+	if(nodes == NULL){PyErr_NoMemory(); goto failure;}
+
+	// every node is built and checked before the first one is appended, so that a bad input leaves the graph as it was
+	for(Py_ssize_t i = 0 ; i < n ; i++){
+		struct graph_node* const node = &(nodes[i]);
+		uint64_t count;
+		memset(node, '\0', sizeof(struct graph_node));
+		if(interface_buffer_count_at(&counts_view, i, &count) != 0){goto failure;}
+		if(create_graph_node(node, g->num_dimensions, FP32) != 0){
+			PyErr_SetString(PyExc_Exception, "failed to call create_graph_node\n");
+			goto failure;
+		}
+		node->absolute_proportion = count;
+		node->num_dimensions = g->num_dimensions;
+		node->vector.fp32 = NULL;
+		if(keys_fast != NULL){
+			struct word2vec* const w2v = &(w2v_slot->w2v);
+			const char* const key = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(keys_fast, i));
+			if(key == NULL){goto failure;}
+			const int32_t w2v_index = word2vec_key_to_index(w2v, (char*) key);
+			if(w2v_index == -1){
+				PyErr_Format(PyExc_KeyError, "unknown key at index %zd: %s", i, key);
+				goto failure;
+			}
+			node->word2vec_entry_pointer = &(w2v->keys[w2v_index]);
+			node->vector.fp32 = w2v->keys[w2v_index].vector;
+		}
+		if(vectors_view != NULL){
+			node->vector.fp32 = ((float*) vectors_view->buf) + i * g->num_dimensions;
+		}
+	}
+
+	if(vectors_view != NULL && interface_hold_vector_buffer(index, vectors_view) != 0){PyErr_NoMemory(); goto failure;}
+	if(graph_append_nodes(g, nodes, (uint64_t) n, &first_index) != 0){
+		// the vectors stay held with the graph, which is harmless
+		vectors_view = NULL;
+		PyErr_SetString(PyExc_Exception, "failed to call graph_append_nodes\n");
+		goto failure;
+	}
+	vectors_view = NULL;
+
+	// an owned distance matrix and the MST are extended to the new nodes by the next measure that reads them
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	interface_unlock_graph(slot);
+	free(nodes);
+	Py_XDECREF(keys_fast);
+	PyBuffer_Release(&counts_view);
+
+	return Py_BuildValue("K", (unsigned long long) first_index);
+
+	failure:
+	if(w2v_slot != NULL){interface_unlock_w2v(w2v_slot);}
+	if(slot != NULL){interface_unlock_graph(slot);}
+	free(nodes);
+	Py_XDECREF(keys_fast);
+	if(vectors_view != NULL){
+		PyBuffer_Release(vectors_view);
+		free(vectors_view);
+	}
+	PyBuffer_Release(&counts_view);
+	return NULL;
+}
+
+static PyObject* interface_update_counts(PyObject* self, PyObject* args){
+    (void) self;
+
+	int32_t index;
+	PyObject* indices;
+	PyObject* deltas;
+	Py_buffer indices_view;
+	Py_buffer deltas_view;
+	Py_ssize_t num_applied = 0;
+	int32_t result = 1;
+
+	if(!PyArg_ParseTuple(args, "iOO", &index, &indices, &deltas)){return NULL;}
+
+	if(interface_get_buffer(indices, &indices_view, 1, "indices") != 0){return NULL;}
+	if(interface_get_buffer(deltas, &deltas_view, 1, "deltas") != 0){PyBuffer_Release(&indices_view); return NULL;}
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){
+		PyBuffer_Release(&indices_view);
+		PyBuffer_Release(&deltas_view);
 		return NULL;
 	}
-	if(((uint32_t) index) >= num_graphs){
-		PyErr_SetString(PyExc_Exception, "index too high");
+
+	struct graph* const g = &(slot->g);
+
+	if(indices_view.shape[0] != deltas_view.shape[0]){
+		PyErr_Format(PyExc_ValueError, "indices and deltas differ in length (%zd and %zd)", indices_view.shape[0], deltas_view.shape[0]);
+		goto release;
+	}
+
+	// indices may repeat, so the deltas are applied in order and undone if one of them would leave [0, INT64_MAX], the range of the counts given by Python
+	for(num_applied = 0 ; num_applied < indices_view.shape[0] ; num_applied++){
+		int64_t node_index;
+		int64_t delta;
+		if(interface_buffer_integer_at(&indices_view, num_applied, "indices", &node_index) != 0 || interface_buffer_integer_at(&deltas_view, num_applied, "deltas", &delta) != 0){goto rollback;}
+		if(node_index < 0 || (uint64_t) node_index >= g->num_nodes){
+			PyErr_Format(PyExc_IndexError, "node index %lld at position %zd is out of range", (long long) node_index, num_applied);
+			goto rollback;
+		}
+		struct graph_node* const node = graph_node_at(g, (uint64_t) node_index);
+		const int64_t count = (int64_t) node->absolute_proportion;
+		if(delta < -count || delta > INT64_MAX - count){
+			PyErr_Format(PyExc_ValueError, "delta at position %zd would take the count of node %lld outside [0, %lld]", num_applied, (long long) node_index, (long long) INT64_MAX);
+			goto rollback;
+		}
+		node->absolute_proportion = (uint64_t) (count + delta);
+	}
+	graph_snapshot_mark_stale(g);
+	result = 0;
+	goto release;
+
+	rollback:
+	// entries before num_applied were read and applied successfully already
+	for(Py_ssize_t i = num_applied - 1 ; i >= 0 ; i--){
+		int64_t node_index;
+		int64_t delta;
+		interface_buffer_integer_at(&indices_view, i, "indices", &node_index);
+		interface_buffer_integer_at(&deltas_view, i, "deltas", &delta);
+		struct graph_node* const node = graph_node_at(g, (uint64_t) node_index);
+		node->absolute_proportion = (uint64_t) (((int64_t) node->absolute_proportion) - delta);
+	}
+
+	release:
+	interface_unlock_graph(slot);
+	PyBuffer_Release(&indices_view);
+	PyBuffer_Release(&deltas_view);
+	if(result != 0){return NULL;}
+	return Py_BuildValue("i", 0);
+}
+
+static PyObject* interface_compute_relative_proportions(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "num_threads", NULL};
+	int32_t index;
+	int32_t num_threads = 1;
+	int32_t err;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "i|i", kwlist, &index, &num_threads)){
 		return NULL;
 	}
+	if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
 
-	compute_graph_relative_proportions(&(global_graphs[index]));
+	Py_BEGIN_ALLOW_THREADS
+	err = graph_snapshot_refresh(&(slot->g), 0, (int16_t) num_threads);
+	Py_END_ALLOW_THREADS
+	interface_unlock_graph(slot);
+
+	if(err != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call compute_graph_relative_proportions");
+		return NULL;
+	}
 
 	PyObject* res = Py_BuildValue("i", 0);
 
@@ -449,119 +1049,278 @@ static PyObject* interface__attach_distance_matrix(PyObject* self, PyObject* arg
     (void) self;
 
     int32_t index = -1;
-    void * bfr = NULL;
-    int32_t fp_mode = FP32;
-    size_t unit_size = 4;
-    size_t bfr_size;
+    PyObject* matrix = NULL;
+    Py_buffer* view = NULL;
+    int32_t fp_mode;
 
-    if(!PyArg_ParseTuple(args, "ik|i", &index, &bfr, &fp_mode)){
-        PyErr_SetString(PyExc_Exception, "Failed to parse arguments");
+    if(!PyArg_ParseTuple(args, "iO", &index, &matrix)){
         return NULL;
     }
 
-	if(index < 0){
-		PyErr_SetString(PyExc_Exception, "index must be >= 0");
-		return NULL;
-	}
-	if(((uint32_t) index) >= num_graphs){
-		PyErr_SetString(PyExc_Exception, "index too high");
-		return NULL;
-	}
-	
-    switch(fp_mode){
-        case FP32:
-            unit_size = 4;
-            break;
-        case FP64:
-            unit_size = 8;
-            break;
-        default:
-            PyErr_SetString(PyExc_Exception, "FP mode must be either FP32 or FP64");
-            return NULL;
-    }
+    view = malloc(sizeof(Py_buffer));
+    if(view == NULL){return PyErr_NoMemory();}
+    if(interface_get_buffer(matrix, view, 2, "distance matrix") != 0){free(view); return NULL;}
 
-    size_t num_nodes = (size_t) global_graphs[index].num_nodes;
-    bfr_size = num_nodes * num_nodes * unit_size;
+    struct interface_graph_slot* const slot = interface_lock_graph(index);
+    if(slot == NULL){PyBuffer_Release(view); free(view); return NULL;}
+    if(!interface_graph_not_exported(index)){goto release_view;}
 
-    #ifndef NDEBUG
-    printf("index: %i; bfr: %p; fp_mode: %i; unit_size: %li; bfr_size: %li\n", index, bfr, fp_mode, unit_size, bfr_size);
-    #endif
+    struct graph* const g = &(slot->g);
+    const size_t num_nodes = (size_t) g->num_nodes;
 
-    if(global_graphs[index].dist_mat_must_be_freed){
-        free_matrix(&(global_graphs[index].dist_mat));
+    fp_mode = interface_buffer_fp_mode(view);
+    if(fp_mode == -1){
+        PyErr_SetString(PyExc_BufferError, "distance matrix must hold float32 or float64 values");
+        goto release_view;
+    }
+    if((size_t) view->shape[0] != num_nodes || (size_t) view->shape[1] != num_nodes){
+        PyErr_Format(PyExc_BufferError, "distance matrix must be %lu x %lu, not %zd x %zd", (unsigned long) num_nodes, (unsigned long) num_nodes, view->shape[0], view->shape[1]);
+        goto release_view;
     }
 
-    if(create_matrix(&(global_graphs[index].dist_mat), (uint32_t) global_graphs[index].num_nodes, (uint32_t) global_graphs[index].num_nodes, fp_mode) != 0){
-        PyErr_SetString(PyExc_Exception, "Failed to create matrix");
-        return NULL;
+    // only the flags the MST walk sets are allocated; the distances are read in place
+    uint8_t* const active = calloc(num_nodes * num_nodes + 1, sizeof(uint8_t));
+    uint8_t* const active_final = calloc(num_nodes * num_nodes + 1, sizeof(uint8_t));
+    if(active == NULL || active_final == NULL){
+        free(active);
+        free(active_final);
+        PyErr_NoMemory();
+        goto release_view;
     }
 
-    global_graphs[index].dist_mat_must_be_freed = 1;
-    global_graphs[index].dist_mat.fp_mode = fp_mode;
+    #ifndef NDEBUG
+    printf("index: %i; bfr: %p; fp_mode: %i; bfr_size: %zd\n", index, view->buf, fp_mode, view->len);
+    #endif
+
+    interface_reset_mst(index);
+    interface_release_distance_matrix(index);
 
+    g->dist_mat = (struct matrix) {
+        .active = active,
+        .active_final = active_final,
+        .a = (uint32_t) num_nodes,
+        .b = (uint32_t) num_nodes,
+        .fp_mode = (uint8_t) fp_mode,
+    };
     switch(fp_mode){
         case FP32:
-            memcpy(global_graphs[index].dist_mat.bfr.fp32, bfr, bfr_size);
+            g->dist_mat.bfr.fp32 = (float*) view->buf;
             break;
         case FP64:
-            memcpy(global_graphs[index].dist_mat.bfr.fp64, bfr, bfr_size);
+            g->dist_mat.bfr.fp64 = (double*) view->buf;
             break;
     }
-
-    #ifndef NDEBUG
-    for(size_t i = 0 ; i < num_nodes ; i++){
-        for(size_t j = 0 ; j < num_nodes ; j++){
-            double value;
-            switch(fp_mode){
-                case FP32:
-                    value = (double) global_graphs[index].dist_mat.bfr.fp32[i * num_nodes + j];
-                    break;
-                case FP64:
-                    value = global_graphs[index].dist_mat.bfr.fp64[i * num_nodes + j];
-                    break;
-            }
-            printf("%.3f ", value);
-        }
-        printf("\n");
-    }
-    #endif
+    global_graphs_held_buffers[index].dist_mat = view;
+    interface_unlock_graph(slot);
 
     PyObject* res = Py_BuildValue("i", 0);
     return res;
+
+    release_view:
+    interface_unlock_graph(slot);
+    PyBuffer_Release(view);
+    free(view);
+    return NULL;
 }
 
-static PyObject* individual_measure(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t id_function, const double alpha, const double beta){
-	double res1 = NAN, res2 = NAN;
-	PyObject * res1_py = NULL;
-	PyObject * res2_py = NULL;
-	PyObject * res = NULL;
+static PyObject* interface__node_proportions(PyObject* self, PyObject* args){
+	int32_t index;
+
+	if(!PyArg_ParseTuple(args, "i", &index)){return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+	struct graph* const g = &(slot->g);
+	PyObject* res = NULL;
+
+	// the view shows the proportions of the snapshot, which must cover every node before it is exported
+	if(!graph_snapshot_is_current(g) && compute_graph_relative_proportions(g) != 0){
+		PyErr_SetString(PyExc_Exception, "failed to call compute_graph_relative_proportions");
+	} else {
+		const Py_ssize_t shape[1] = {(Py_ssize_t) g->num_nodes};
+		res = interface_new_array_view(self, index, g->snapshot.relative_proportions, 1, shape, 'd', sizeof(double));
+	}
+	interface_unlock_graph(slot);
+	return res;
+}
+
+// a graph without attached matrix gets one computed from the vectors of its nodes, owned by the graph;
+// once nodes were appended, only their rows and columns are added to it, from the panel rows the snapshot gathered for them
+static const char* interface_ensure_distance_matrix(struct graph* const g, const int16_t num_threads){
+	const uint64_t first_new_node = g->dist_mat.bfr.fp32 != NULL ? g->dist_mat.a : 0;
+	if(g->dist_mat.bfr.fp32 != NULL && (g->dist_mat.a != g->dist_mat.b || first_new_node > g->num_nodes || (first_new_node < g->num_nodes && !g->dist_mat_must_be_freed))){
+		return "the distance matrix does not match the number of nodes";
+	}
+	if(g->dist_mat.bfr.fp32 != NULL && first_new_node == g->num_nodes){return NULL;}
+	for(uint64_t i = first_new_node ; i < g->num_nodes ; i++){
+		if(graph_node_at(g, i)->vector.fp32 == NULL){return "no distance matrix attached to graph, and not every node has a vector to compute one";}
+	}
+	if(!graph_snapshot_is_current(g) && graph_snapshot_refresh(g, 1, num_threads) != 0){return "failed to call graph_snapshot_refresh";}
+	if(graph_snapshot_gather_vectors(g, num_threads) != 0){return "failed to call graph_snapshot_gather_vectors";}
+	if(g->dist_mat.bfr.fp32 == NULL){
+		if(create_matrix(&(g->dist_mat), (uint32_t) g->num_nodes, (uint32_t) g->num_nodes, FP32) != 0){return "failed to call create_matrix";}
+		g->dist_mat_must_be_freed = 1;
+		if(distance_matrix_from_graph_multithread(g, &(g->dist_mat), num_threads) != 0){return "failed to call distance_matrix_from_graph_multithread";}
+		return NULL;
+	}
+	if(grow_matrix(&(g->dist_mat), (uint32_t) g->num_nodes) != 0){return "failed to call grow_matrix";}
+	if(distance_matrix_extend_from_graph_multithread(g, &(g->dist_mat), first_new_node, num_threads) != 0){return "failed to call distance_matrix_extend_from_graph_multithread";}
+	return NULL;
+}
+
+static PyObject* interface__distance_matrix(PyObject* self, PyObject* args){
+	int32_t index;
+
+	if(!PyArg_ParseTuple(args, "i", &index)){return NULL;}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+	struct graph* const g = &(slot->g);
+	PyObject* res = NULL;
+
+	// an owned matrix behind the nodes is extended now, as it cannot move while the view exists
+	const char* const err = g->dist_mat_must_be_freed && g->dist_mat.a != g->num_nodes ? interface_ensure_distance_matrix(g, 1) : NULL;
+	const Py_ssize_t shape[2] = {(Py_ssize_t) g->dist_mat.a, (Py_ssize_t) g->dist_mat.b};
+	if(err != NULL){
+		PyErr_SetString(PyExc_Exception, err);
+	} else if(g->dist_mat.bfr.fp32 == NULL){
+		PyErr_SetString(PyExc_Exception, "no distance matrix attached to graph");
+	} else if(g->dist_mat.fp_mode == FP32){
+		res = interface_new_array_view(self, index, g->dist_mat.bfr.fp32, 2, shape, 'f', sizeof(float));
+	} else if(g->dist_mat.fp_mode == FP64){
+		res = interface_new_array_view(self, index, g->dist_mat.bfr.fp64, 2, shape, 'd', sizeof(double));
+	} else {
+		PyErr_SetString(PyExc_Exception, "unknown FP mode of distance matrix");
+	}
+	interface_unlock_graph(slot);
+	return res;
+}
+
+static uint8_t interface_is_disparity(const int32_t id_function){
+	switch(id_function){
+		case ID_DISPARITY_PAIRWISE:
+		case ID_DISPARITY_CHAO_ET_AL_FUNCTIONAL:
+		case ID_DISPARITY_LEINSTER_COBBOLD:
+		case ID_DISPARITY_SCHEINER:
+		case ID_DISPARITY_STIRLING:
+		case ID_DISPARITY_RICOTTA_SZEIDL:
+		case ID_DISPARITY_FUNCTIONAL_EVENNESS:
+		case ID_DISPARITY_AGG_MST:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+// primitives of the memo read by a function, so that dfunctions_memo_compute gathers them with num_threads threads
+static void interface_request_memo(struct graph* const g, const int32_t id_function, const double alpha, const double beta){
+	switch(id_function){
+		case ID_ENTROPY_SHANNON_WEAVER: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY); break;
+		case ID_ENTROPY_RENYI: dfunctions_memo_request_order(g, alpha); break;
+		case ID_INDEX_HILL_EVENNESS:
+			dfunctions_memo_request_order(g, alpha);
+			dfunctions_memo_request_order(g, beta);
+			break;
+		case ID_INDEX_SIMPSON_DOMINANCE: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX); break;
+		case ID_INDEX_SIMPSON: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SIMPSON_INDEX); break;
+		case ID_INDEX_SHANNON_EVENNESS: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SHANNON_EVENNESS); break;
+		case ID_INDEX_BERGER_PARKER: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_BERGER_PARKER_INDEX); break;
+		case ID_INDEX_JUNGE1994_PAGE22: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_JUNGE1994_PAGE22); break;
+		case ID_INDEX_MCINTOSH: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_MCINTOSH_INDEX); break;
+		case ID_INDEX_E_HEIP: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_HEIP); break;
+		case ID_INDEX_ONE_MINUS_D: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_ONE_MINUS_D); break;
+		case ID_INDEX_ONE_OVER_D_WILLIAMS1964: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_ONE_OVER_D_WILLIAMS1964); break;
+		case ID_INDEX_E_MINUS_LN_D_PIELOU1977: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_MINUS_LN_D_PIELOU1977); break;
+		case ID_INDEX_F_2_1_ALATALO1981: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_F_2_1_ALATALO1981); break;
+		case ID_INDEX_G_2_1_MOLINARI1989: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_G_2_1_MOLINARI1989); break;
+		case ID_INDEX_O_BULLA1994: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_O_BULLA1994); break;
+		case ID_INDEX_E_BULLA1994: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_BULLA1994); break;
+		case ID_INDEX_E_MCI_PIELOU1969: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_MCI_PIELOU1969); break;
+		case ID_INDEX_E_VAR_SMITH_AND_WILSON1996: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SW_E_VAR_SMITH_AND_WILSON1996_ORIGINAL); break;
+		case ID_INDEX_TYPE_TOKEN_RATIO: dfunctions_memo_request(g, DFUNCTIONS_NEEDS_TYPE_TOKEN_RATIO); break;
+		default: break;
+	}
+}
+
+// the tree of the nodes it spanned, extended to the nodes appended since, from its own edges and those of the new nodes only
+static const char* interface_extend_minimum_spanning_tree(struct graph* const g, struct minimum_spanning_tree* const mst){
+	const uint64_t num_tree_distances = mst->num_active_distances;
+	const uint64_t first_new_node = mst->num_nodes;
+	struct graph_distance_heap* const heap = mst->heap;
+
+	struct distance_two_nodes* const tree = malloc((num_tree_distances + 1) * sizeof(struct distance_two_nodes));
+	if(tree == NULL){return "failed to alloc";}
+	memcpy(tree, mst->distances, num_tree_distances * sizeof(struct distance_two_nodes));
+	free_minimum_spanning_tree(mst);
+
+	const int32_t err = create_graph_distance_heap_from_tree(heap, g, &(g->dist_mat), tree, num_tree_distances, first_new_node);
+	free(tree);
+	if(err != 0){
+		free_graph_distance_heap(heap);
+		free(heap);
+		return "failed to call create_graph_distance_heap_from_tree";
+	}
+	if(create_minimum_spanning_tree(mst, heap) != 0){return "failed to call create_minimum_spanning_tree";}
+	return NULL;
+}
+
+// what the functions of ids read, built once for all of them: snapshot, memo primitives, distance matrix and MST
+// none of the measure helpers touch the Python API, so that callers can release the GIL around them; they return NULL on success, or the message of the exception to raise
+static const char* interface_prepare_measures(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t * const ids, const uint64_t num_ids, const double alpha, const double beta, const int16_t num_threads){
+	uint8_t needs_matrix = 0, needs_mst = 0;
 
-	if(id_function == ID_DISPARITY_FUNCTIONAL_EVENNESS || id_function == ID_DISPARITY_AGG_MST){
+	// nodes added or counts changed since the last compute_relative_proportion would otherwise be missing from the snapshot
+	if(!graph_snapshot_is_current(g) && graph_snapshot_refresh(g, g->num_dimensions > 0, num_threads) != 0){
+		return "failed to call graph_snapshot_refresh";
+	}
+
+	for(uint64_t k = 0 ; k < num_ids ; k++){
+		interface_request_memo(g, ids[k], alpha, beta);
+		needs_matrix |= interface_is_disparity(ids[k]);
+		needs_mst |= ids[k] == ID_DISPARITY_FUNCTIONAL_EVENNESS || ids[k] == ID_DISPARITY_AGG_MST;
+	}
+	if(dfunctions_memo_compute(g, num_threads) != 0){return "failed to call dfunctions_memo_compute";}
+
+	if(needs_matrix){
+		const char* const err = interface_ensure_distance_matrix(g, num_threads);
+		if(err != NULL){return err;}
+	}
+
+	if(needs_mst){
+		if(mst->heap != NULL && mst->num_nodes > 1 && mst->num_nodes < g->num_nodes && mst->num_active_distances == mst->num_nodes - 1){
+			const char* const err = interface_extend_minimum_spanning_tree(g, mst);
+			if(err != NULL){return err;}
+		} else if(mst->heap != NULL && mst->num_nodes != g->num_nodes){
+			free_graph_distance_heap(mst->heap);
+			free(mst->heap);
+			free_minimum_spanning_tree(mst);
+		}
 		if(mst->heap == NULL){
 			struct graph_distance_heap * heap = malloc(sizeof(struct graph_distance_heap));
-			if(heap == NULL){
-				PyErr_SetString(PyExc_Exception, "failed to alloc\n");
-				return NULL;
-			}
+			if(heap == NULL){return "failed to alloc";}
 			memset(heap, '\0', sizeof(struct graph_distance_heap));
 			// this call also min-heapifies
-			if(create_graph_distance_heap(heap, g, &g->dist_mat) != 0){
-				PyErr_SetString(PyExc_Exception, "failed to call create_graph_distance_heap\n");
-				return NULL;
-			}
-			if(create_minimum_spanning_tree(mst, heap) != 0){
-				PyErr_SetString(PyExc_Exception, "failed to call create_minimum_spanning_tree\n");
-				return NULL;
-			}
+			if(create_graph_distance_heap(heap, g, &g->dist_mat) != 0){free(heap); return "failed to call create_graph_distance_heap";}
+			if(create_minimum_spanning_tree(mst, heap) != 0){return "failed to call create_minimum_spanning_tree";}
 		}
 		if(mst->num_active_distances != g->num_nodes - 1){
-			if(calculate_minimum_spanning_tree(mst, &mst->heap->g->dist_mat, mst->heap->g->dist_mat.fp_mode) != 0){
-				PyErr_SetString(PyExc_Exception, "failed to call calculate_minimum_spanning_tree\n");
-				return NULL;
-			}
+			// the tree is written into a matrix of its own, as in measurement.c, so that the distance matrix stays as it is
+			struct matrix m_mst = { .fp_mode = FP64, };
+			if(create_matrix(&m_mst, (uint32_t) g->num_nodes, (uint32_t) g->num_nodes, FP64) != 0){return "failed to call create_matrix for MST";}
+			memset(m_mst.active, '\0', g->num_nodes * g->num_nodes * sizeof(uint8_t));
+			const int32_t err = calculate_minimum_spanning_tree(mst, &m_mst, MST_PRIMS_ALGORITHM);
+			free_matrix(&m_mst);
+			if(err != 0){return "failed to call calculate_minimum_spanning_tree";}
 		}
 	}
 
+	return NULL;
+}
+
+// one function, on what interface_prepare_measures built
+static const char* interface_evaluate_measure(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t id_function, const double alpha, const double beta, const int16_t num_threads, double* const res1_out, double* const res2_out){
+	double res1 = NAN, res2 = NAN;
+
 	switch(id_function){
 		case ID_ENTROPY_SHANNON_WEAVER:
 			shannon_weaver_entropy_from_graph(g, &res1, &res2);
@@ -636,7 +1395,7 @@ static PyObject* individual_measure(struct graph * const g, struct minimum_spann
 			sw_e_mci_pielou1969_from_graph(g, &res1);
 			break;
 		case ID_INDEX_E_PRIME_CAMARGO1993:
-			sw_e_prime_camargo1993_from_graph(g, &res1);
+			if(sw_e_prime_camargo1993_from_graph_multithread(g, &res1, num_threads) != 0){return "failed to call sw_e_prime_camargo1993_from_graph_multithread";}
 			break;
 		case ID_INDEX_E_VAR_SMITH_AND_WILSON1996:
 			sw_e_var_smith_and_wilson1996_original_from_graph(g, &res1);
@@ -649,8 +1408,7 @@ static PyObject* individual_measure(struct graph * const g, struct minimum_spann
 			break;
 		case ID_DISPARITY_CHAO_ET_AL_FUNCTIONAL:
 			if(chao_et_al_functional_diversity_from_graph(g, &res1, &res2, alpha, g->dist_mat.fp_mode, &g->dist_mat) != 0){
-				PyErr_SetString(PyExc_Exception, "failed to call chao_et_al_functional_diversity_from_graph\n");
-				return NULL;
+				return "failed to call chao_et_al_functional_diversity_from_graph";
 			}
 			break;
 		case ID_DISPARITY_LEINSTER_COBBOLD:
@@ -658,8 +1416,7 @@ static PyObject* individual_measure(struct graph * const g, struct minimum_spann
 			break;
 		case ID_DISPARITY_SCHEINER:
 			if(scheiner_species_phylogenetic_functional_diversity_from_graph(g, &res1, &res2, alpha, g->dist_mat.fp_mode, &g->dist_mat) != 0){
-				PyErr_SetString(PyExc_Exception, "failed to call scheiner_species_phylogenetic_functional_diversity_from_graph\n");
-				return NULL;
+				return "failed to call scheiner_species_phylogenetic_functional_diversity_from_graph";
 			}
 			break;
 		case ID_DISPARITY_STIRLING:
@@ -675,50 +1432,136 @@ static PyObject* individual_measure(struct graph * const g, struct minimum_spann
 			agg_mst_from_minimum_spanning_tree(mst, &res1);
 			break;
 		default:
-			PyErr_SetString(PyExc_Exception, "unknown diversity function");
-			return NULL;
+			return "unknown diversity function";
 	}
 
-	const Py_ssize_t tuple_len = (!isnan(res1)) + (!isnan(res2));
-	res = PyTuple_New(tuple_len);
-	if(res == NULL){PyErr_SetString(PyExc_Exception, "failed to create tuple"); return NULL;}
-	if(!isnan(res1)){
-		res1_py = Py_BuildValue("d", res1);
-		Py_INCREF(res1_py);
-		if(PyTuple_SetItem(res, 0, res1_py) != 0){PyErr_SetString(PyExc_Exception, "failed to set item into tuple"); return NULL;}
-	}
-	if(!isnan(res2)){
-		res2_py = Py_BuildValue("d", res2);
-		Py_INCREF(res2_py);
-		if(PyTuple_SetItem(res, 1, res2_py) != 0){PyErr_SetString(PyExc_Exception, "failed to set item into tuple"); return NULL;}
-	}
 
-	Py_INCREF(res);
+	*res1_out = res1;
+	*res2_out = res2;
+	return NULL;
+}
 
-	return res;
+static const char* individual_measure(struct graph * const g, struct minimum_spanning_tree * const mst, const int32_t id_function, const double alpha, const double beta, const int16_t num_threads, double* const res1_out, double* const res2_out){
+	const char* const err = interface_prepare_measures(g, mst, &id_function, 1, alpha, beta, num_threads);
+	if(err != NULL){return err;}
+	return interface_evaluate_measure(g, mst, id_function, alpha, beta, num_threads, res1_out, res2_out);
 }
 
-static PyObject* interface_individual_measure(PyObject* self, PyObject* args){
+// one or two floats, depending on how many values the function has
+static PyObject* individual_measure_result(const double res1, const double res2){
+	if(isnan(res1) && isnan(res2)){return PyTuple_New(0);}
+	if(isnan(res2)){return Py_BuildValue("(d)", res1);}
+	if(isnan(res1)){return Py_BuildValue("(d)", res2);}
+	return Py_BuildValue("(dd)", res1, res2);
+}
+
+static PyObject* interface_individual_measure(PyObject* self, PyObject* args, PyObject* kwargs){
     (void) self;
 
+	static char* kwlist[] = {"graph_index", "function", "alpha", "beta", "num_threads", NULL};
 	int32_t index;
 	int32_t id_function;
 	double alpha = 1.0, beta = 1.0;
+	int32_t num_threads = 1;
+	double res1, res2;
+	const char* err;
 
-	if(!PyArg_ParseTuple(args, "ii|dd", &index, &id_function, &alpha, &beta)){
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "ii|ddi", kwlist, &index, &id_function, &alpha, &beta, &num_threads)){
 		return NULL;
 	}
+	if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
 
-	if(index < 0){
-		PyErr_SetString(PyExc_Exception, "index must be >= 0");
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){return NULL;}
+
+	Py_BEGIN_ALLOW_THREADS
+	err = individual_measure(&(slot->g), &(slot->mst), id_function, alpha, beta, (int16_t) num_threads, &res1, &res2);
+	Py_END_ALLOW_THREADS
+	interface_unlock_graph(slot);
+
+	if(err != NULL){
+		PyErr_SetString(PyExc_Exception, err);
 		return NULL;
 	}
-	if(((uint32_t) index) >= num_graphs){
-		PyErr_SetString(PyExc_Exception, "index too high");
+	return individual_measure_result(res1, res2);
+}
+
+static PyObject* interface__measure_many(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "functions", "values", "seconds", "alpha", "beta", "num_threads", NULL};
+	int32_t index;
+	PyObject* functions;
+	PyObject* values;
+	PyObject* seconds = Py_None;
+	double alpha = 1.0, beta = 1.0;
+	int32_t num_threads = 1;
+	Py_buffer functions_view, values_view, seconds_view = {0};
+	int32_t* ids = NULL;
+	const char* err = NULL;
+	int64_t shared_ns = 0;
+	PyObject* res = NULL;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "iOO|Oddi", kwlist, &index, &functions, &values, &seconds, &alpha, &beta, &num_threads)){
 		return NULL;
 	}
-	
-    return individual_measure(&(global_graphs[index]), &(msts[index]), id_function, alpha, beta);
+	if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+
+	if(interface_get_buffer(functions, &functions_view, 1, "functions") != 0){return NULL;}
+	const Py_ssize_t n = functions_view.shape[0];
+	if(PyObject_GetBuffer(values, &values_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0){PyBuffer_Release(&functions_view); return NULL;}
+	if(values_view.ndim != 2 || values_view.shape[0] != n || values_view.shape[1] != 2 || interface_buffer_fp_mode(&values_view) != FP64){
+		PyErr_Format(PyExc_BufferError, "values must be a writable float64 buffer of shape (%zd, 2)", n);
+		goto release;
+	}
+	if(seconds != Py_None){
+		if(PyObject_GetBuffer(seconds, &seconds_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0){goto release;}
+		if(seconds_view.ndim != 1 || seconds_view.shape[0] != n || interface_buffer_fp_mode(&seconds_view) != FP64){
+			PyErr_Format(PyExc_BufferError, "seconds must be a writable float64 buffer of shape (%zd,)", n);
+			goto release;
+		}
+	}
+
+	ids = malloc((n + 1) * sizeof(int32_t));
+	if(ids == NULL){PyErr_NoMemory(); goto release;}
+	for(Py_ssize_t k = 0 ; k < n ; k++){
+		int64_t id;
+		if(interface_buffer_integer_at(&functions_view, k, "functions", &id) != 0){goto release;}
+		if(id < INT32_MIN || id > INT32_MAX){PyErr_SetString(PyExc_ValueError, "unknown diversity function"); goto release;}
+		ids[k] = (int32_t) id;
+	}
+
+	struct interface_graph_slot* const slot = interface_lock_graph(index);
+	if(slot == NULL){goto release;}
+
+	double* const out = (double*) values_view.buf;
+	double* const out_seconds = seconds != Py_None ? (double*) seconds_view.buf : NULL;
+
+	Py_BEGIN_ALLOW_THREADS
+	int64_t start_ns = instrument_now_ns();
+	err = interface_prepare_measures(&(slot->g), &(slot->mst), ids, (uint64_t) n, alpha, beta, (int16_t) num_threads);
+	shared_ns = instrument_now_ns() - start_ns;
+	for(Py_ssize_t k = 0 ; k < n && err == NULL ; k++){
+		start_ns = instrument_now_ns();
+		err = interface_evaluate_measure(&(slot->g), &(slot->mst), ids[k], alpha, beta, (int16_t) num_threads, &(out[2 * k]), &(out[2 * k + 1]));
+		if(out_seconds != NULL){out_seconds[k] = ((double) (instrument_now_ns() - start_ns)) * 1e-9;}
+	}
+	Py_END_ALLOW_THREADS
+	interface_unlock_graph(slot);
+
+	if(err != NULL){
+		PyErr_SetString(PyExc_Exception, err);
+		goto release;
+	}
+	// the time spent on what the functions share (snapshot, memo, matrix, MST)
+	res = Py_BuildValue("d", ((double) shared_ns) * 1e-9);
+
+	release:
+	free(ids);
+	if(seconds_view.obj != NULL){PyBuffer_Release(&seconds_view);}
+	PyBuffer_Release(&values_view);
+	PyBuffer_Release(&functions_view);
+	return res;
 }
 
 /* // DO NOT REMOVE
@@ -751,73 +1594,78 @@ static PyObject* interface_cfg_get_value(PyObject* self, PyObject* args){
 }
 */
 
-static PyObject* interface_score_file(PyObject* self, PyObject* args){
-    (void) self;
-
-    PyObject * listFiles;
-    PyObject * listFilesTP;
-    PyObject * listFunctions;
-    PyObject * listResults;
-    int32_t target_column = -1;
-    int32_t w2v_index = -1;
-    int32_t cardinality_files = 0;
-    int32_t cardinality_files_tp = 0;
-    int32_t cardinality_functions = 0;
-
-    if(!PyArg_ParseTuple(args, "O!O!O!ii", &PyList_Type, &listFiles, &PyList_Type, &listFilesTP, &PyList_Type, &listFunctions, &w2v_index, &target_column)){
-        PyErr_SetString(PyExc_Exception, "Failed to parse arguments!");
-        return NULL;
-    }
-
-    if(PyList_Check(listFiles) != 1 || PyList_Check(listFilesTP) != 1 || PyList_Check(listFunctions) != 1){
-        PyErr_SetString(PyExc_Exception, "First three arguments must be lists.");
-        return NULL;
-    }
-
-    cardinality_files = PyList_Size(listFiles);
-    cardinality_files_tp = PyList_Size(listFilesTP);
-    cardinality_functions = PyList_Size(listFunctions);
+static void interface_free_paths(char** const paths, const int32_t num_paths){
+    if(paths == NULL){return;}
+    for(int32_t i = 0 ; i < num_paths ; i++){free(paths[i]);}
+    free(paths);
+}
 
-    if(!(cardinality_files_tp == 0 || cardinality_files_tp == cardinality_files)){
-        PyErr_Format(PyExc_Exception, "Second argument (gold paths) must be either of length 0 or of length equal to the first argument (prediction paths). First argument's length: %i; second argument's length: %i.", cardinality_files, cardinality_files_tp);
-        return NULL;
+// copies of the str of a list, so that they outlive the GIL
+static char** interface_copy_paths(PyObject* const list, const char* const name){
+    const Py_ssize_t n = PyList_Size(list);
+    char** const paths = calloc(n > 0 ? (size_t) n : 1, sizeof(char*));
+    if(paths == NULL){PyErr_NoMemory(); return NULL;}
+    for(Py_ssize_t i = 0 ; i < n ; i++){
+        const char* s = PyUnicode_Check(PyList_GetItem(list, i)) ? PyUnicode_AsUTF8(PyList_GetItem(list, i)) : NULL;
+        if(s == NULL){
+            PyErr_Clear();
+            PyErr_Format(PyExc_Exception, "Failed to get %s at index %zd.", name, i);
+            interface_free_paths(paths, (int32_t) n);
+            return NULL;
+        }
+        paths[i] = strdup(s);
+        if(paths[i] == NULL){PyErr_NoMemory(); interface_free_paths(paths, (int32_t) n); return NULL;}
     }
+    return paths;
+}
 
-    reset_word2vec_active_in_current_graph(&global_word2vecs[w2v_index]);
+struct interface_score_file_args {
+    char** paths;
+    char** paths_tp;
+    int32_t cardinality_files;
+    int32_t cardinality_files_tp;
+    const int32_t* id_functions;
+    int32_t cardinality_functions;
+    int32_t target_column;
+    int16_t num_threads;
+    struct word2vec* w2v;
+    double* res1;
+    double* res2;
+    char error[256];
+};
 
+// ingestion and measures of score_file, run without the GIL; returns 0 on success, or 1 with a->error set
+static int32_t interface_score_file_run(struct interface_score_file_args* const a){
+    int32_t result = 1;
     struct graph g = {0};
     struct minimum_spanning_tree mst = {0};
+    struct oov_counter oov_discarded_because_not_in_vector_database = {0};
 
     if(create_graph_empty(&g) != 0){
-        PyErr_SetString(PyExc_Exception, "Failed to call create_graph_empty.");
-        return NULL;
+        snprintf(a->error, sizeof(a->error), "Failed to call create_graph_empty.");
+        return 1;
     }
-
-    struct sorted_array sorted_array_discarded_because_not_in_vector_database = {0};
-    if(create_sorted_array(&sorted_array_discarded_because_not_in_vector_database, 0, sizeof(struct sorted_array_str_int_element), sorted_array_str_int_cmp, SORTED_ARRAY_METHOD) != 0){
-        PyErr_SetString(PyExc_Exception, "Failed to call create_sorted_array.");
-        return NULL;
+    if(graph_bind_word2vec(&g, a->w2v) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call graph_bind_word2vec.");
+        goto free_graph;
+    }
+    if(create_oov_counter(&oov_discarded_because_not_in_vector_database, OOV_MEMORY_CAP) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call create_oov_counter.");
+        goto free_graph;
     }
 
-    for(int32_t i = 0 ; i < cardinality_files ; i++){
-        char * s;
+    for(int32_t i = 0 ; i < a->cardinality_files ; i++){
+        char * s = a->paths[i];
         char * s_tp = NULL;
-        if(!PyArg_Parse(PyList_GetItem(listFiles, i), "s", &s)){
-            PyErr_Format(PyExc_Exception, "Failed to get file name at index %i.", i);
-            return NULL;
-        }
-        if(cardinality_files_tp > 0){
-            if(!PyArg_Parse(PyList_GetItem(listFilesTP, i), "s", &s_tp)){
-                PyErr_Format(PyExc_Exception, "Failed to get file name (TP) at index %i.", i);
-                return NULL;
-            } 
-            printf("Processing file %i/%i: %s (gold: %s)\n", i, cardinality_files, s, s_tp);
+        if(a->cardinality_files_tp > 0){
+            s_tp = a->paths_tp[i];
+            printf("Processing file %i/%i: %s (gold: %s)\n", i, a->cardinality_files, s, s_tp);
         } else {
-            printf("Processing file %i/%i: %s\n", i, cardinality_files, s);
+            printf("Processing file %i/%i: %s\n", i, a->cardinality_files, s);
         }
 
         struct measurement_configuration mcfg = {
-            .target_column = target_column,
+            .target_column = a->target_column,
             .enable_token_utf8_normalisation = 0,
             .jsonl_content_key = "text",
             .io = (struct measurement_io) {
@@ -830,93 +1678,662 @@ static PyObject* interface_score_file(PyObject* self, PyObject* args){
 
         struct measurement_structure_references sref = {
             .g = &g,
-            .sorted_array_discarded_because_not_in_vector_database = &sorted_array_discarded_because_not_in_vector_database,
-            .w2v = &(global_word2vecs[w2v_index]),
+            .oov_discarded_because_not_in_vector_database = &oov_discarded_because_not_in_vector_database,
+            .w2v = a->w2v,
         };
 
         struct measurement_mutables mmut = { .best_s = 0.0, .prev_best_s = 0.0, .prev_num_nodes = 0, .sentence = (struct measurement_mutable_counters) {0}, .document = (struct measurement_mutable_counters) {0}, .mst_initialised = 0, };
         if(pthread_mutex_init(&mmut.mutex, NULL) != 0){
-            PyErr_SetString(PyExc_Exception, "Failed to call pthread_mutex_init.");
-            free_graph(&g);
-            return NULL;
+            snprintf(a->error, sizeof(a->error), "Failed to call pthread_mutex_init.");
+            goto free_oov;
         }
 
         size_t len_s = strlen(s);
+        int32_t err = 0;
 
-        if(strcmp(s + len_s - 5, ".cupt") == 0 || strcmp(s + len_s - 7, ".conllu") == 0){
-            if(cupt_to_graph(i, s, s_tp, &mcfg, &sref, &mmut, NULL) != 0){
-                PyErr_Format(PyExc_Exception, "Failed to call cupt_to_graph for %s.", s);
-                pthread_mutex_destroy(&mmut.mutex);
-                free_graph(&g);
-                return NULL;
-            }
-        } else if(strcmp(s + len_s - 6, ".jsonl") == 0){
-            if(jsonl_to_graph(i, s, &mcfg, &sref, &mmut) != 0){
-                PyErr_Format(PyExc_Exception, "Failed to call jsonl_to_graph for %s.", s);
-                pthread_mutex_destroy(&mmut.mutex);
-                free_graph(&g);
-                return NULL;
-            }
+        if(len_s >= 5 && (strcmp(s + len_s - 5, ".cupt") == 0 || (len_s >= 7 && strcmp(s + len_s - 7, ".conllu") == 0))){
+            err = cupt_to_graph(i, s, s_tp, &mcfg, &sref, &mmut, NULL);
+        } else if(len_s >= 6 && strcmp(s + len_s - 6, ".jsonl") == 0){
+            err = jsonl_to_graph(i, s, &mcfg, &sref, &mmut);
         }
-
         pthread_mutex_destroy(&mmut.mutex);
+        if(err != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to read %s.", s);
+            goto free_oov;
+        }
     }
 
-    listResults = PyList_New(cardinality_functions);
-    if(listResults == NULL){
-        PyErr_SetString(PyExc_Exception, "Failed to create a new list.");
-        free_graph(&g);
+    if(graph_snapshot_refresh(&g, g.num_dimensions > 0, a->num_threads) != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to call graph_snapshot_refresh.");
+        goto free_oov;
+    }
+
+    for(int32_t j = 0 ; j < a->cardinality_functions ; j++){
+        const char* const err = individual_measure(&g, &mst, a->id_functions[j], 1.0, 1.0, a->num_threads, &(a->res1[j]), &(a->res2[j]));
+        if(err != NULL){
+            snprintf(a->error, sizeof(a->error), "%s (function %i)", err, a->id_functions[j]);
+            goto free_oov;
+        }
+    }
+    result = 0;
+
+    free_oov:
+    free_oov_counter(&oov_discarded_because_not_in_vector_database);
+    free_graph:
+    if(mst.heap != NULL){
+        free_graph_distance_heap(mst.heap);
+        free(mst.heap);
+    }
+    free_minimum_spanning_tree(&mst);
+    free_graph(&g);
+    return result;
+}
+
+static PyObject* interface_score_file(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+    static char* kwlist[] = {"paths", "gold_paths", "functions", "w2v_index", "target_column", "num_threads", NULL};
+    PyObject * listFiles;
+    PyObject * listFilesTP;
+    PyObject * listFunctions;
+    PyObject * listResults = NULL;
+    int32_t target_column = -1;
+    int32_t w2v_index = -1;
+    int32_t num_threads = 1;
+    int32_t err;
+    struct interface_score_file_args a = {0};
+    struct interface_word2vec_slot* w2v_slot = NULL;
+    int32_t* id_functions = NULL;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!ii|i", kwlist, &PyList_Type, &listFiles, &PyList_Type, &listFilesTP, &PyList_Type, &listFunctions, &w2v_index, &target_column, &num_threads)){
         return NULL;
     }
+    if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
 
-    compute_graph_relative_proportions(&g);
+    a.cardinality_files = (int32_t) PyList_Size(listFiles);
+    a.cardinality_files_tp = (int32_t) PyList_Size(listFilesTP);
+    a.cardinality_functions = (int32_t) PyList_Size(listFunctions);
+    a.target_column = target_column;
+    a.num_threads = (int16_t) num_threads;
 
-    for(int32_t j = 0 ; j < cardinality_functions ; j++){
-        PyObject * id_function_obj = PyList_GetItem(listFunctions, j);
-        int32_t id_function = -1;
-        if(!PyArg_Parse(id_function_obj, "i", &id_function)){
+    if(!(a.cardinality_files_tp == 0 || a.cardinality_files_tp == a.cardinality_files)){
+        PyErr_Format(PyExc_Exception, "Second argument (gold paths) must be either of length 0 or of length equal to the first argument (prediction paths). First argument's length: %i; second argument's length: %i.", a.cardinality_files, a.cardinality_files_tp);
+        return NULL;
+    }
+
+    id_functions = malloc((a.cardinality_functions + 1) * sizeof(int32_t));
+    a.res1 = malloc((a.cardinality_functions + 1) * sizeof(double));
+    a.res2 = malloc((a.cardinality_functions + 1) * sizeof(double));
+    if(id_functions == NULL || a.res1 == NULL || a.res2 == NULL){PyErr_NoMemory(); goto release;}
+    for(int32_t j = 0 ; j < a.cardinality_functions ; j++){
+        if(!PyArg_Parse(PyList_GetItem(listFunctions, j), "i", &(id_functions[j]))){
             PyErr_SetString(PyExc_Exception, "Failed to transform Python object to int32_t.");
-            return NULL;
-        }
-        PyObject * diversity_score = individual_measure(&g, &mst, id_function, 1.0, 1.0);
-        if(PyList_SetItem(listResults, j, diversity_score) != 0){
-            PyErr_Format(PyExc_Exception, "Failed to set diversity score at index %i.", j);
-            return NULL;
+            goto release;
         }
     }
+    a.id_functions = id_functions;
 
-    free_sorted_array(&sorted_array_discarded_because_not_in_vector_database);
-    free_graph(&g);
+    a.paths = interface_copy_paths(listFiles, "file name");
+    if(a.paths == NULL){goto release;}
+    a.paths_tp = interface_copy_paths(listFilesTP, "file name (TP)");
+    if(a.paths_tp == NULL){goto release;}
+
+    w2v_slot = interface_read_lock_w2v(w2v_index);
+    if(w2v_slot == NULL){goto release;}
+    a.w2v = &(w2v_slot->w2v);
 
+    Py_BEGIN_ALLOW_THREADS
+    err = interface_score_file_run(&a);
+    Py_END_ALLOW_THREADS
+    interface_unlock_w2v(w2v_slot);
+
+    if(err != 0){
+        PyErr_SetString(PyExc_Exception, a.error);
+        goto release;
+    }
+
+    listResults = PyList_New(a.cardinality_functions);
+    if(listResults == NULL){goto release;}
+    for(int32_t j = 0 ; j < a.cardinality_functions ; j++){
+        PyObject * diversity_score = individual_measure_result(a.res1[j], a.res2[j]);
+        if(diversity_score == NULL){Py_CLEAR(listResults); goto release;}
+        PyList_SET_ITEM(listResults, j, diversity_score);
+    }
+
+    release:
+    interface_free_paths(a.paths, a.cardinality_files);
+    interface_free_paths(a.paths_tp, a.cardinality_files_tp);
+    free(id_functions);
+    free(a.res1);
+    free(a.res2);
     return listResults;
 }
 
+// strings pulled from a Python iterator, copied back to back so that they can be read without the GIL
+struct interface_ingest_batch {
+	char* arena;
+	size_t arena_size;
+	size_t arena_capacity;
+	size_t* offsets; // start of string k; strings are NUL-terminated
+	size_t* sizes;
+	Py_ssize_t num_strings;
+	Py_ssize_t capacity;
+};
+
+// the next batch_size strings of the iterator; returns 1 with an exception set on failure, 0 otherwise (an empty batch once the iterator is exhausted)
+static int32_t interface_ingest_pull(PyObject* const iterator, struct interface_ingest_batch* const b, const Py_ssize_t batch_size){
+	b->arena_size = 0;
+	b->num_strings = 0;
+	while(b->num_strings < batch_size){
+		PyObject* const item = PyIter_Next(iterator);
+		if(item == NULL){return PyErr_Occurred() != NULL;}
+		Py_ssize_t size;
+		const char* const utf8 = PyUnicode_Check(item) ? PyUnicode_AsUTF8AndSize(item, &size) : NULL;
+		if(utf8 == NULL){
+			if(!PyErr_Occurred()){PyErr_Format(PyExc_TypeError, "expected str, not %s", Py_TYPE(item)->tp_name);}
+			Py_DECREF(item);
+			return 1;
+		}
+		if(b->num_strings == b->capacity){
+			const Py_ssize_t capacity = b->capacity > 0 ? 2 * b->capacity : 64;
+			size_t* const offsets = realloc(b->offsets, capacity * sizeof(size_t));
+			if(offsets != NULL){b->offsets = offsets;}
+			size_t* const sizes = offsets != NULL ? realloc(b->sizes, capacity * sizeof(size_t)) : NULL;
+			if(sizes != NULL){b->sizes = sizes;}
+			if(offsets == NULL || sizes == NULL){Py_DECREF(item); PyErr_NoMemory(); return 1;}
+			b->capacity = capacity;
+		}
+		if(b->arena_size + (size_t) size + 1 > b->arena_capacity){
+			size_t capacity = b->arena_capacity > 0 ? 2 * b->arena_capacity : 4096;
+			while(capacity < b->arena_size + (size_t) size + 1){capacity *= 2;}
+			char* const arena = realloc(b->arena, capacity);
+			if(arena == NULL){Py_DECREF(item); PyErr_NoMemory(); return 1;}
+			b->arena = arena;
+			b->arena_capacity = capacity;
+		}
+		memcpy(&(b->arena[b->arena_size]), utf8, (size_t) size);
+		b->arena[b->arena_size + (size_t) size] = '\0';
+		b->offsets[b->num_strings] = b->arena_size;
+		b->sizes[b->num_strings] = (size_t) size;
+		b->arena_size += (size_t) size + 1;
+		b->num_strings++;
+		Py_DECREF(item);
+	}
+	return 0;
+}
+
+// graph_add_word2vec_occurrence finds the nodes of the entries through g->word2vec_slots, which also have to know the nodes added by add_node and add_nodes
+static int32_t interface_bind_word2vec_slots(struct interface_graph_slot* const slot, const int32_t index_w2v, const struct word2vec* const w2v){
+	struct graph* const g = &(slot->g);
+	if(slot->word2vec_slots_bound && slot->word2vec_slots_w2v == index_w2v && g->num_word2vec_slots == w2v->num_vectors && slot->word2vec_slots_num_nodes == g->num_nodes){return 0;}
+	if(!(slot->word2vec_slots_bound && slot->word2vec_slots_w2v == index_w2v && g->num_word2vec_slots == w2v->num_vectors)){
+		if(graph_bind_word2vec(g, w2v) != 0){return 1;}
+		slot->word2vec_slots_num_nodes = 0;
+	}
+	for(uint64_t i = slot->word2vec_slots_num_nodes ; i < g->num_nodes ; i++){
+		struct graph_node* const node = graph_node_at(g, i);
+		const struct word2vec_entry* const entry = node->word2vec_entry_pointer;
+		if(entry == NULL || entry < w2v->keys || entry >= w2v->keys + w2v->num_vectors){continue;}
+		struct graph_word2vec_slot* const s = &(g->word2vec_slots[entry - w2v->keys]);
+		if(s->active){continue;}
+		s->active = 1;
+		s->node_index = i;
+		s->node = node;
+	}
+	slot->word2vec_slots_bound = 1;
+	slot->word2vec_slots_w2v = index_w2v;
+	return 0;
+}
+
+// runs without the GIL, with the graph and its word2vec locked
+static int32_t interface_ingest_batch(const struct interface_ingest_batch* const b, const uint8_t documents, struct document* const doc, const struct measurement_configuration* const mcfg, struct measurement_structure_references* const sref, uint64_t* const num_oov_tokens){
+	char token[JSONL_CURRENT_TOKEN_BUFFER_SIZE];
+	for(Py_ssize_t k = 0 ; k < b->num_strings ; k++){
+		const char* const s = &(b->arena[b->offsets[k]]);
+		if(documents){
+			// as in jsonl_to_graph, which skips documents without text
+			if(b->sizes[k] == 0){continue;}
+			if(document_set_text(doc, s, b->sizes[k]) != 0 || jsonl_document_to_graph(doc, mcfg, sref, num_oov_tokens) != 0){return 1;}
+		} else {
+			size_t len = b->sizes[k];
+			if(len > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){len = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;}
+			memcpy(token, s, len);
+			token[len] = '\0';
+			if(jsonl_token_to_graph(token, mcfg, sref, num_oov_tokens) != 0){return 1;}
+		}
+	}
+	return 0;
+}
+
+static PyObject* interface__ingest(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+	static char* kwlist[] = {"graph_index", "iterable", "documents", "batch_size", "normalise", NULL};
+	int32_t index;
+	PyObject* iterable;
+	int32_t documents = 0;
+	Py_ssize_t batch_size = 4096;
+	int32_t normalise = 0;
+	PyObject* iterator = NULL;
+	PyObject* res = NULL;
+	struct interface_ingest_batch b = {0};
+	struct document doc = {0};
+	struct oov_counter oov = {0};
+	uint8_t created_doc = 0, created_oov = 0;
+	uint64_t num_strings = 0, num_oov_tokens = 0;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwargs, "iO|pnp", kwlist, &index, &iterable, &documents, &batch_size, &normalise)){return NULL;}
+	if(batch_size < 1){PyErr_SetString(PyExc_ValueError, "batch_size must be >= 1"); return NULL;}
+
+	iterator = PyObject_GetIter(iterable);
+	if(iterator == NULL){return NULL;}
+	if(create_oov_counter(&oov, OOV_MEMORY_CAP) != 0){PyErr_SetString(PyExc_Exception, "failed to call create_oov_counter"); goto release;}
+	created_oov = 1;
+	if(documents){
+		if(create_document(&doc) != 0){PyErr_SetString(PyExc_Exception, "failed to call create_document"); goto release;}
+		created_doc = 1;
+	}
+
+	const struct measurement_configuration mcfg = {
+		.target_column = -1,
+		.enable_token_utf8_normalisation = (int8_t) normalise,
+	};
+
+	while(1){
+		if(interface_ingest_pull(iterator, &b, batch_size) != 0){goto release;}
+		if(b.num_strings == 0){break;}
+
+		// the graph is locked once per batch, so that other calls on it can run between two batches
+		struct interface_graph_slot* const slot = interface_lock_graph(index);
+		if(slot == NULL){goto release;}
+		if(!interface_graph_not_exported(index)){interface_unlock_graph(slot); goto release;}
+		const int32_t index_w2v = global_graphs_word2vec_bindings[index];
+		if(index_w2v < 0){interface_unlock_graph(slot); PyErr_SetString(PyExc_Exception, "No Word2Vec bound to graph\n"); goto release;}
+		struct interface_word2vec_slot* const w2v_slot = interface_read_lock_w2v(index_w2v);
+		if(w2v_slot == NULL){interface_unlock_graph(slot); goto release;}
+
+		struct measurement_structure_references sref = {
+			.g = &(slot->g),
+			.w2v = &(w2v_slot->w2v),
+			.oov_discarded_because_not_in_vector_database = &oov,
+		};
+		int32_t err;
+		Py_BEGIN_ALLOW_THREADS
+		err = interface_bind_word2vec_slots(slot, index_w2v, &(w2v_slot->w2v));
+		if(err == 0){err = interface_ingest_batch(&b, (uint8_t) documents, &doc, &mcfg, &sref, &num_oov_tokens);}
+		slot->word2vec_slots_num_nodes = slot->g.num_nodes;
+		// tokens of nodes already in the graph change counts without adding nodes, even in a batch that failed halfway
+		graph_snapshot_mark_stale(&(slot->g));
+		Py_END_ALLOW_THREADS
+		interface_unlock_w2v(w2v_slot);
+		interface_unlock_graph(slot);
+		if(err != 0){PyErr_SetString(PyExc_Exception, "failed to ingest batch"); goto release;}
+		num_strings += (uint64_t) b.num_strings;
+	}
+
+	res = Py_BuildValue("(KK)", (unsigned long long) num_strings, (unsigned long long) num_oov_tokens);
+
+	release:
+	Py_DECREF(iterator);
+	if(created_doc){free_document(&doc);}
+	if(created_oov){free_oov_counter(&oov);}
+	free(b.arena);
+	free(b.offsets);
+	free(b.sizes);
+	return res;
+}
+
+struct interface_score_files_args;
+
+// one graph of score_files, with what its readers update
+struct interface_score_files_corpus {
+    struct graph g;
+    struct minimum_spanning_tree mst;
+    struct oov_counter oov;
+    struct measurement_mutables mmut;
+    struct measurement_step_hook hook;
+    struct interface_score_files_args* args;
+    int32_t path_index; // -1 for the shared graph, whose steps belong to the file whose reader reached them
+    uint8_t created;
+};
+
+struct interface_score_files_args {
+    char** paths;
+    char** paths_tp;
+    int32_t cardinality_files;
+    int32_t cardinality_files_tp;
+    const int32_t* id_functions;
+    int32_t cardinality_functions;
+    int32_t target_column;
+    int16_t num_threads;
+    uint64_t step;
+    uint8_t shared;
+    struct word2vec* w2v;
+    PyObject* callback; // None unless steps are streamed
+    struct interface_score_files_corpus* corpora;
+    struct measurement_structure_references* srefs;
+    int32_t num_corpora;
+    double* values; // cardinality_functions pairs per corpus, once every file is read
+    PyObject* callback_error[3]; // the exception raised by the callback, restored once the GIL is back with the caller
+    char error[256];
+};
+
+// row handed to the callback and returned for each graph: (path index, num_nodes, num_sentences, num_documents, num_oov_types, (values...))
+static PyObject* interface_score_files_row(const int32_t path_index, const struct graph* const g, const struct measurement_mutables* const mmut, const int64_t num_oov_types, const double* const values, const int32_t num_values){
+    PyObject* const values_py = PyTuple_New(num_values);
+    if(values_py == NULL){return NULL;}
+    for(int32_t k = 0 ; k < num_values ; k++){
+        PyObject* const v = PyFloat_FromDouble(values[k]);
+        if(v == NULL){Py_DECREF(values_py); return NULL;}
+        PyTuple_SET_ITEM(values_py, k, v);
+    }
+    return Py_BuildValue("(iKKKLN)", path_index, (unsigned long long) g->num_nodes, (unsigned long long) mmut->sentence.num_all, (unsigned long long) mmut->document.num_all, (long long) num_oov_types, values_py);
+}
+
+// measurement_step_hook of score_files, called by a reader holding mmut->mutex and g->mutex_nodes, without the GIL
+static int32_t interface_score_files_step(void* const ctx, const uint64_t i, struct graph* const g, const struct measurement_mutables* const mmut){
+    struct interface_score_files_corpus* const corpus = (struct interface_score_files_corpus*) ctx;
+    struct interface_score_files_args* const a = corpus->args;
+    const int32_t num_values = 2 * a->cardinality_functions;
+    int32_t result = 0;
+
+    double* const values = malloc((num_values + 1) * sizeof(double));
+    if(values == NULL){return 1;}
+
+    const char* err = interface_prepare_measures(g, &(corpus->mst), a->id_functions, (uint64_t) a->cardinality_functions, 1.0, 1.0, a->num_threads);
+    for(int32_t k = 0 ; k < a->cardinality_functions && err == NULL ; k++){
+        err = interface_evaluate_measure(g, &(corpus->mst), a->id_functions[k], 1.0, 1.0, a->num_threads, &(values[2 * k]), &(values[2 * k + 1]));
+    }
+    if(err != NULL){
+        error_format(__FILE__, __func__, __LINE__, err);
+        free(values);
+        return 1;
+    }
+
+    const PyGILState_STATE gil = PyGILState_Ensure();
+    if(a->callback_error[0] != NULL){
+        result = 1;
+    } else {
+        PyObject* const row = interface_score_files_row(corpus->path_index >= 0 ? corpus->path_index : (int32_t) i, g, mmut, mmut->num_oov_types, values, num_values);
+        PyObject* const ret = row != NULL ? PyObject_CallOneArg(a->callback, row) : NULL;
+        Py_XDECREF(row);
+        if(ret == NULL){
+            PyErr_Fetch(&(a->callback_error[0]), &(a->callback_error[1]), &(a->callback_error[2]));
+            result = 1;
+        }
+        Py_XDECREF(ret);
+    }
+    PyGILState_Release(gil);
+
+    free(values);
+    return result;
+}
+
+// reads the files of score_files into their graphs, then measures each graph; run without the GIL, returns 0 on success, or 1 with a->error set
+static int32_t interface_score_files_run(struct interface_score_files_args* const a){
+    struct file_queue q;
+    int32_t result = 1;
+
+    const struct measurement_step step = {
+        .recompute_step = a->step,
+        .enable_count_recompute_step = a->step > 0 && a->callback != Py_None,
+    };
+    struct measurement_configuration mcfg = {
+        .target_column = a->target_column,
+        .enable_token_utf8_normalisation = 0,
+        .jsonl_content_key = "text",
+        .io = (struct measurement_io) {
+            .jsonl_content_key = "text",
+        },
+        .threading = (struct measurement_threading) { .num_file_reading_threads = a->num_threads, },
+        .steps = (struct measurement_step_parameters) { .sentence = step, .document = step, },
+    };
+
+    for(int32_t c = 0 ; c < a->num_corpora ; c++){
+        struct interface_score_files_corpus* const corpus = &(a->corpora[c]);
+        corpus->args = a;
+        corpus->path_index = a->shared ? -1 : c;
+        corpus->hook = (struct measurement_step_hook) { .step = interface_score_files_step, .ctx = corpus, };
+        corpus->mmut = (struct measurement_mutables) {
+            .best_s = -1.0,
+            .prev_best_s = -1.0,
+            .sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+            .document = (struct measurement_mutable_counters) { .count_target = 1, },
+        };
+        if(create_graph_empty(&(corpus->g)) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call create_graph_empty.");
+            return 1;
+        }
+        if(create_oov_counter(&(corpus->oov), OOV_MEMORY_CAP) != 0){
+            free_graph(&(corpus->g));
+            snprintf(a->error, sizeof(a->error), "Failed to call create_oov_counter.");
+            return 1;
+        }
+        if(pthread_mutex_init(&(corpus->mmut.mutex), NULL) != 0){
+            free_oov_counter(&(corpus->oov));
+            free_graph(&(corpus->g));
+            snprintf(a->error, sizeof(a->error), "Failed to call pthread_mutex_init.");
+            return 1;
+        }
+        corpus->created = 1;
+        if(graph_bind_word2vec(&(corpus->g), a->w2v) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call graph_bind_word2vec.");
+            return 1;
+        }
+
+        const struct measurement_structure_references sref = {
+            .g = &(corpus->g),
+            .w2v = a->w2v,
+            .oov_discarded_because_not_in_vector_database = &(corpus->oov),
+            .step_hook = a->callback != Py_None ? &(corpus->hook) : NULL,
+        };
+        memcpy(&(a->srefs[c]), &sref, sizeof(struct measurement_structure_references));
+    }
+
+    if(a->shared){
+        if(create_file_queue(&q, a->paths, a->cardinality_files_tp > 0 ? a->paths_tp : NULL, a->cardinality_files, 1) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call create_file_queue.");
+            return 1;
+        }
+        result = file_queue_read(&q, &mcfg, &(a->srefs[0]), &(a->corpora[0].mmut), a->num_threads);
+    } else {
+        struct file_queue_corpus* const queue_corpora = calloc(a->num_corpora > 0 ? a->num_corpora : 1, sizeof(struct file_queue_corpus));
+        if(queue_corpora == NULL){
+            snprintf(a->error, sizeof(a->error), "Failed to calloc.");
+            return 1;
+        }
+        for(int32_t c = 0 ; c < a->num_corpora ; c++){
+            queue_corpora[c] = (struct file_queue_corpus) {
+                .paths = &(a->paths[c]),
+                .paths_tp = a->cardinality_files_tp > 0 ? &(a->paths_tp[c]) : NULL,
+                .num_paths = 1,
+                .mcfg = &mcfg,
+                .sref = &(a->srefs[c]),
+                .mmut = &(a->corpora[c].mmut),
+            };
+        }
+        if(create_file_queue_corpora(&q, queue_corpora, a->num_corpora, 1) != 0){
+            free(queue_corpora);
+            snprintf(a->error, sizeof(a->error), "Failed to call create_file_queue_corpora.");
+            return 1;
+        }
+        result = file_queue_read(&q, NULL, NULL, NULL, a->num_threads);
+        free_file_queue(&q);
+        free(queue_corpora);
+    }
+    if(a->shared){free_file_queue(&q);}
+    if(result != 0){
+        snprintf(a->error, sizeof(a->error), "Failed to read the files.");
+        return 1;
+    }
+
+    for(int32_t c = 0 ; c < a->num_corpora ; c++){
+        struct interface_score_files_corpus* const corpus = &(a->corpora[c]);
+        corpus->mmut.num_oov_types = oov_counter_num_types(&(corpus->oov));
+        if(graph_snapshot_refresh(&(corpus->g), corpus->g.num_dimensions > 0, a->num_threads) != 0){
+            snprintf(a->error, sizeof(a->error), "Failed to call graph_snapshot_refresh.");
+            return 1;
+        }
+        double* const values = &(a->values[2 * a->cardinality_functions * c]);
+        const char* err = interface_prepare_measures(&(corpus->g), &(corpus->mst), a->id_functions, (uint64_t) a->cardinality_functions, 1.0, 1.0, a->num_threads);
+        for(int32_t k = 0 ; k < a->cardinality_functions && err == NULL ; k++){
+            err = interface_evaluate_measure(&(corpus->g), &(corpus->mst), a->id_functions[k], 1.0, 1.0, a->num_threads, &(values[2 * k]), &(values[2 * k + 1]));
+        }
+        if(err != NULL){
+            snprintf(a->error, sizeof(a->error), "%s (%s)", err, a->shared ? "shared graph" : a->paths[c]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void interface_score_files_free(struct interface_score_files_args* const a){
+    for(int32_t c = 0 ; c < a->num_corpora ; c++){
+        struct interface_score_files_corpus* const corpus = &(a->corpora[c]);
+        if(!corpus->created){continue;}
+        if(corpus->mst.heap != NULL){
+            free_graph_distance_heap(corpus->mst.heap);
+            free(corpus->mst.heap);
+        }
+        free_minimum_spanning_tree(&(corpus->mst));
+        pthread_mutex_destroy(&(corpus->mmut.mutex));
+        free_oov_counter(&(corpus->oov));
+        free_graph(&(corpus->g));
+    }
+    free(a->corpora);
+    free(a->srefs);
+    free(a->values);
+    interface_free_paths(a->paths, a->cardinality_files);
+    interface_free_paths(a->paths_tp, a->cardinality_files_tp);
+}
+
+static PyObject* interface__score_files(PyObject* self, PyObject* args, PyObject* kwargs){
+    (void) self;
+
+    static char* kwlist[] = {"paths", "gold_paths", "functions", "w2v_index", "target_column", "shared", "num_threads", "step", "callback", NULL};
+    PyObject * listFiles;
+    PyObject * listFilesTP;
+    PyObject * listFunctions;
+    PyObject * callback = Py_None;
+    PyObject * res = NULL;
+    int32_t target_column = -1;
+    int32_t w2v_index = -1;
+    int32_t shared = 0;
+    int32_t num_threads = 1;
+    unsigned long long step = 0;
+    int32_t err;
+    struct interface_score_files_args a = {0};
+    struct interface_word2vec_slot* w2v_slot = NULL;
+    int32_t* id_functions = NULL;
+
+    if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!ii|piKO", kwlist, &PyList_Type, &listFiles, &PyList_Type, &listFilesTP, &PyList_Type, &listFunctions, &w2v_index, &target_column, &shared, &num_threads, &step, &callback)){
+        return NULL;
+    }
+    if(num_threads < 1 || num_threads > INT16_MAX){PyErr_SetString(PyExc_ValueError, "num_threads must be in [1, 32767]"); return NULL;}
+    if(callback != Py_None && !PyCallable_Check(callback)){PyErr_SetString(PyExc_TypeError, "callback must be callable or None"); return NULL;}
+
+    a.cardinality_files = (int32_t) PyList_Size(listFiles);
+    a.cardinality_files_tp = (int32_t) PyList_Size(listFilesTP);
+    a.cardinality_functions = (int32_t) PyList_Size(listFunctions);
+    a.target_column = target_column;
+    a.num_threads = (int16_t) num_threads;
+    a.step = (uint64_t) step;
+    a.shared = (uint8_t) shared;
+    a.callback = callback;
+    a.num_corpora = shared ? 1 : a.cardinality_files;
+
+    if(!(a.cardinality_files_tp == 0 || a.cardinality_files_tp == a.cardinality_files)){
+        PyErr_Format(PyExc_Exception, "Second argument (gold paths) must be either of length 0 or of length equal to the first argument (prediction paths). First argument's length: %i; second argument's length: %i.", a.cardinality_files, a.cardinality_files_tp);
+        return NULL;
+    }
+
+    id_functions = malloc((a.cardinality_functions + 1) * sizeof(int32_t));
+    a.corpora = calloc(a.num_corpora + 1, sizeof(struct interface_score_files_corpus));
+    a.srefs = calloc(a.num_corpora + 1, sizeof(struct measurement_structure_references));
+    a.values = malloc((2 * a.cardinality_functions * a.num_corpora + 1) * sizeof(double));
+    if(id_functions == NULL || a.corpora == NULL || a.srefs == NULL || a.values == NULL){PyErr_NoMemory(); goto release;}
+    for(int32_t j = 0 ; j < a.cardinality_functions ; j++){
+        if(!PyArg_Parse(PyList_GetItem(listFunctions, j), "i", &(id_functions[j]))){
+            PyErr_SetString(PyExc_Exception, "Failed to transform Python object to int32_t.");
+            goto release;
+        }
+    }
+    a.id_functions = id_functions;
+
+    a.paths = interface_copy_paths(listFiles, "file name");
+    if(a.paths == NULL){goto release;}
+    a.paths_tp = interface_copy_paths(listFilesTP, "file name (TP)");
+    if(a.paths_tp == NULL){goto release;}
+
+    w2v_slot = interface_read_lock_w2v(w2v_index);
+    if(w2v_slot == NULL){goto release;}
+    a.w2v = &(w2v_slot->w2v);
+
+    // the callback takes the GIL back from the reader threads
+    Py_BEGIN_ALLOW_THREADS
+    err = interface_score_files_run(&a);
+    Py_END_ALLOW_THREADS
+    interface_unlock_w2v(w2v_slot);
+
+    if(a.callback_error[0] != NULL){
+        PyErr_Restore(a.callback_error[0], a.callback_error[1], a.callback_error[2]);
+        goto release;
+    }
+    if(err != 0){
+        PyErr_SetString(PyExc_Exception, a.error);
+        goto release;
+    }
+
+    res = PyList_New(a.num_corpora);
+    if(res == NULL){goto release;}
+    for(int32_t c = 0 ; c < a.num_corpora ; c++){
+        const struct interface_score_files_corpus* const corpus = &(a.corpora[c]);
+        PyObject* const row = interface_score_files_row(corpus->path_index, &(corpus->g), &(corpus->mmut), corpus->mmut.num_oov_types, &(a.values[2 * a.cardinality_functions * c]), 2 * a.cardinality_functions);
+        if(row == NULL){Py_CLEAR(res); goto release;}
+        PyList_SET_ITEM(res, c, row);
+    }
+
+    release:
+    interface_score_files_free(&a);
+    free(id_functions);
+    return res;
+}
+
 void interface_free_globals(void * args){
     (void) args;
-	if(global_graphs != NULL){
-        for(uint32_t i = 0 ; i < num_graphs ; i++){
-            if(!global_graphs_freed[i]){
-                free_graph(&global_graphs[i]);
+	if(global_graph_slots != NULL){
+        for(uint32_t i = 0 ; i < num_graph_slots ; i++){
+            struct interface_graph_slot* const slot = global_graph_slots[i];
+            if(i < num_graphs && !global_graphs_freed[i]){
+                interface_release_held_buffers((int32_t) i);
+                free_graph(&(slot->g));
             }
 
-	    if(msts[i].heap != NULL){
-		free_graph_distance_heap(msts[i].heap);
-		free(msts[i].heap);
-		msts[i].heap = NULL;
+	    if(slot->mst.heap != NULL){
+		free_graph_distance_heap(slot->mst.heap);
+		free(slot->mst.heap);
+		slot->mst.heap = NULL;
 	    }
-	    free_minimum_spanning_tree(&msts[i]);
+	    free_minimum_spanning_tree(&(slot->mst));
+	    pthread_mutex_destroy(&(slot->mutex));
+	    free(slot);
         }
-        free(global_graphs);
+        free(global_graph_slots);
     }
 	if(global_graphs_freed != NULL){free(global_graphs_freed);}
 	if(global_graphs_word2vec_bindings != NULL){free(global_graphs_word2vec_bindings);}
-	if(global_word2vecs != NULL){
+	if(global_graphs_held_buffers != NULL){free(global_graphs_held_buffers);}
+	if(global_graphs_exports != NULL){free(global_graphs_exports);}
+	if(global_word2vec_slots != NULL){
         for(uint32_t i = 0 ; i < num_w2v ; i++){
             if(!global_w2v_freed[i]){
-                free_word2vec(&global_word2vecs[i]);
+                free_word2vec(&(global_word2vec_slots[i]->w2v));
             }
+            pthread_rwlock_destroy(&(global_word2vec_slots[i]->lock));
+            free(global_word2vec_slots[i]);
         }
-        free(global_word2vecs);
+        free(global_word2vec_slots);
     }
 	if(global_w2v_freed != NULL){free(global_w2v_freed);}
 	if(configurations != NULL){free(configurations);}
@@ -931,14 +2348,22 @@ static PyMethodDef diversutilsmethods[] = {
 	{"free_graph", interface_free_graph, METH_VARARGS, "Free a graph. This requires the graph index."},
 	// {"cfg_get_value", interface_cfg_get_value, METH_VARARGS, "Provide a graph index, and a key to fetch."}, // DO NOT REMOVE
 	// {"measurement_from_cfg", interface_measurement_from_cfg, METH_VARARGS, "Call measurement function."}, // DO NOT REMOVE
-	{"add_node", interface_add_node, METH_VARARGS, "Add a node (args: graph index, number of dimensions, absolute proportion)."},
-	{"individual_measure", interface_individual_measure, METH_VARARGS, "Compute an individual measure. ARGS: graph index, measure index, order 1 (optional), order 2 (optional)."},
-	{"compute_relative_proportion", interface_compute_relative_proportions, METH_VARARGS, "Compute relative proportions. ARGS: graph index."},
+	{"add_node", interface_add_node, METH_VARARGS, "Add a node (args: graph index, absolute proportion, Word2Vec key or C-contiguous float32 vector buffer (optional)). A vector buffer is read in place and held until the graph is freed."},
+	{"individual_measure", (PyCFunction)(void(*)(void)) interface_individual_measure, METH_VARARGS | METH_KEYWORDS, "Compute an individual measure without holding the GIL. ARGS: graph_index, function, alpha (optional), beta (optional), num_threads (optional, default 1). A disparity without attached matrix computes one from the node vectors."},
+	{"compute_relative_proportion", (PyCFunction)(void(*)(void)) interface_compute_relative_proportions, METH_VARARGS | METH_KEYWORDS, "Compute relative proportions without holding the GIL. ARGS: graph_index, num_threads (optional, default 1)."},
 	{"bind_w2v", interface_bind_w2v, METH_VARARGS, "Bind a Word2Vec binary to a graph. ARGS: graph index, Word2Vec index."},
 	{"load_w2v", interface_load_w2v, METH_VARARGS, "Load a Word2Vec binary. ARGS: Word2Vec index."},
 	{"free_w2v", interface_free_w2v, METH_VARARGS, "Free a Word2Vec binary. ARGS: Word2Vec index."},
-    {"score_file", interface_score_file, METH_VARARGS, "Compute scores for one or more files. ARGS: List of paths, list of gold paths or empty list, list of measures, index of vector space, index of CUPT column."},
-    {"_attach_distance_matrix", interface__attach_distance_matrix, METH_VARARGS, "Attach a distance matrix to a graph. ARGS: graph index, raw matrix pointer buffer, FP mode (optional)."},
+    {"score_file", (PyCFunction)(void(*)(void)) interface_score_file, METH_VARARGS | METH_KEYWORDS, "Compute scores for one or more files without holding the GIL. ARGS: List of paths, list of gold paths or empty list, list of measures, index of vector space, index of CUPT column, num_threads (optional, default 1)."},
+    {"_ingest", (PyCFunction)(void(*)(void)) interface__ingest, METH_VARARGS | METH_KEYWORDS, "Add the tokens of strings pulled from an iterable to a graph bound to a Word2Vec, batch_size strings at a time, without the GIL while a batch is added. ARGS: graph index, iterable of str, documents (optional; tokenize each string as the text of a JSONL document instead of taking it as one token), batch_size (optional), normalise (optional; UTF-8 normalisation of the tokens). Returns (number of strings, number of out-of-vocabulary tokens)."},
+    {"_score_files", (PyCFunction)(void(*)(void)) interface__score_files, METH_VARARGS | METH_KEYWORDS, "Read files with num_threads native threads into one graph per file, or into one shared graph, and measure each graph; return one row per graph. ARGS: list of paths, list of gold paths or empty list, list of measures, index of vector space, index of CUPT column, shared (optional), num_threads (optional), step (optional; sentences of CUPT files or documents of JSONL files between two calls of the callback, 0 for none), callback (optional). Rows are (path index or -1, num_nodes, num_sentences, num_documents, num_oov_types, tuple of two values per measure)."},
+    {"_attach_distance_matrix", interface__attach_distance_matrix, METH_VARARGS, "Attach a distance matrix to a graph without copying it; the graph holds the buffer until it is freed or another matrix is attached. ARGS: graph index, C-contiguous float32 or float64 buffer of shape (num_nodes, num_nodes)."},
+    {"add_nodes", interface_add_nodes, METH_VARARGS, "Add several nodes in one call and return the index of the first one. ARGS: graph index, float32 buffer of shape (n, num_dimensions) or None, integer buffer of n counts, list of n Word2Vec keys (optional). Vectors are read in place and held until the graph is freed; they take precedence over the vectors of the keys."},
+    {"update_counts", interface_update_counts, METH_VARARGS, "Add deltas to the absolute proportions of some nodes; nothing changes if one count would leave [0, 2^32 - 1]. ARGS: graph index, integer buffer of node indices, integer buffer of deltas."},
+    {"set_counts", interface_set_counts, METH_VARARGS, "Set the absolute proportion of every node. ARGS: graph index, C-contiguous integer buffer of length num_nodes."},
+    {"_measure_many", (PyCFunction)(void(*)(void)) interface__measure_many, METH_VARARGS | METH_KEYWORDS, "Compute several measures in one call without holding the GIL, sharing the snapshot, memo, distance matrix and MST; return the seconds spent on those. ARGS: graph_index, integer buffer of functions, writable float64 buffer of shape (n, 2) for the values (NaN where a function has a single value), writable float64 buffer of n seconds or None (optional), alpha, beta, num_threads (optional)."},
+    {"_node_proportions", interface__node_proportions, METH_VARARGS, "Read-only memoryview of the relative proportions of the nodes. ARGS: graph index."},
+    {"_distance_matrix", interface__distance_matrix, METH_VARARGS, "Read-only memoryview of the distance matrix. ARGS: graph index."},
 	{NULL, NULL, 0, NULL}
 };
 
@@ -956,6 +2381,7 @@ static struct PyModuleDef diversutilsmodule = {
 };
 
 PyMODINIT_FUNC PyInit__diversutils(void){
+	if(PyType_Ready(&interface_array_view_type) != 0){return NULL;}
 	PyObject* mod = PyModule_Create(&diversutilsmodule);
 	PyModule_AddIntConstant(mod, "DF_ENTROPY_SHANNON_WEAVER", ID_ENTROPY_SHANNON_WEAVER);
 	PyModule_AddIntConstant(mod, "DF_ENTROPY_Q_LOGARITHMIC", ID_ENTROPY_Q_LOGARITHMIC);
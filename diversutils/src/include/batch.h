@@ -0,0 +1,72 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "file_queue.h"
+
+#define BATCH_MANIFEST_LINE_SIZE 4096
+
+// one line of the manifest: name, input list and output prefix, then optionally the true positive input list, separated by tabs
+struct batch_corpus {
+	char* name;
+	char* input_path;
+	char* output_prefix;
+	char* input_path_tp; // NULL without a fourth field
+};
+
+struct batch_manifest {
+	struct batch_corpus* corpora;
+	int32_t num_corpora;
+};
+
+// corpora measured side by side: each corpus has its own thread for everything but reading, and the files of all corpora are read by one pool of reader threads
+struct batch {
+	struct file_queue_corpus* corpora;
+	uint8_t* registered;
+	int32_t num_corpora;
+	int32_t num_registered;
+	int32_t num_threads;
+	uint8_t largest_first;
+	uint8_t read; // set once the files of every corpus were read
+	int32_t status; // of the read, shared by every corpus that did not withdraw
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+typedef int32_t (*batch_corpus_function)(struct batch* const, const int32_t, void* const);
+
+int32_t read_batch_manifest(struct batch_manifest* const m, const char* const path);
+void free_batch_manifest(struct batch_manifest* const m);
+int32_t batch_run(const int32_t num_corpora, const int32_t num_threads, const uint8_t largest_first, batch_corpus_function f, void* const * const args);
+int32_t batch_read(struct batch* const b, const int32_t k, const struct file_queue_corpus* const corpus, int32_t* const num_done);
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "measurement.h"
+
+#define CHECKPOINT_MAGIC "DVSCKP01"
+#define CHECKPOINT_MAGIC_SIZE 8
+#define CHECKPOINT_VERSION 2 // 2: 64-bit node counts
+#define CHECKPOINT_BYTE_ORDER_MARK 0x01020304u
+#define CHECKPOINT_NUM_OUTPUTS 3 // output, output_timing, output_memory
+
+enum {
+	CHECKPOINT_FILE_PENDING,
+	CHECKPOINT_FILE_STARTED,
+	CHECKPOINT_FILE_DONE
+};
+
+// how far an input file was read when the checkpoint was taken
+struct checkpoint_file {
+	int64_t offset; // bytes read up to the end of the last complete unit (document or sentence)
+	int64_t offset_tp;
+	uint8_t state;
+	int8_t found_at_least_one_mwe;
+};
+
+/*
+ * Periodic snapshot of the measurement state, so that a long batch job can be resumed after it was killed.
+ * A background thread asks the readers to stop at their next unit boundary, captures the graph counts, the OOV counter,
+ * the step counters, the file progress and the output sizes once every reader is parked, lets them go, and then writes
+ * the checkpoint to a temporary file which is renamed over the previous one.
+ */
+struct checkpoint {
+	char* path;
+	char* tmp_path;
+	int64_t interval_ns;
+	char* const * paths; // input list
+	struct checkpoint_file* files; // indexed like the input list
+	int32_t num_files;
+	int32_t num_active; // files being read
+	int32_t num_parked; // readers waiting for the capture to end
+	uint8_t requested;
+	uint8_t stop;
+	uint8_t started;
+	uint64_t generation; // incremented when a capture ends
+	uint64_t num_written;
+	int32_t status;
+	int64_t output_sizes[CHECKPOINT_NUM_OUTPUTS]; // -1 for an output that was not open
+	char* loaded; // payload read by checkpoint_open, until checkpoint_restore
+	size_t loaded_size;
+	size_t loaded_position;
+	struct measurement_configuration* mcfg;
+	const struct measurement_structure_references* sref;
+	struct measurement_mutables* mmut;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond_parked; // wakes up the checkpoint thread
+	pthread_cond_t cond_resume; // wakes up the readers
+};
+
+int32_t create_checkpoint(struct checkpoint* const cp, const char* const path, const double interval_seconds, char* const * const paths, const int32_t num_files);
+int32_t checkpoint_open(struct checkpoint* const cp, uint8_t* const found);
+int32_t checkpoint_restore(struct checkpoint* const cp, const struct measurement_structure_references* const sref, struct measurement_mutables* const mmut);
+int32_t checkpoint_start(struct checkpoint* const cp, struct measurement_configuration* const mcfg, const struct measurement_structure_references* const sref, struct measurement_mutables* const mmut);
+uint8_t checkpoint_file_is_done(struct checkpoint* const cp, const int32_t i);
+void checkpoint_file_begin(struct checkpoint* const cp, const int32_t i);
+void checkpoint_file_resume_point(struct checkpoint* const cp, const int32_t i, int64_t* const offset, int64_t* const offset_tp, int8_t* const found_at_least_one_mwe);
+void checkpoint_unit_done(struct checkpoint* const cp, const int32_t i, const int64_t offset, const int64_t offset_tp, const int8_t found_at_least_one_mwe);
+void checkpoint_file_end(struct checkpoint* const cp, const int32_t i, const int32_t status);
+uint64_t checkpoint_num_written(struct checkpoint* const cp);
+int32_t checkpoint_stop(struct checkpoint* const cp);
+int32_t checkpoint_remove(const struct checkpoint* const cp);
+void free_checkpoint(struct checkpoint* const cp);
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdint.h>
+
+#include "graph.h"
+#include "measurement.h"
+#include "batch.h"
+#include "serve.h"
+
+// what measurement_serve_job needs from the server: its configuration, and the word2vec loaded once for every job
+struct measurement_serve_context {
+	struct measurement_configuration * mcfg;
+	struct word2vec * w2v;
+};
+
+int32_t read_list_simulation_files(const char * const path_list_simulation_files, char *** const resulting_paths, int32_t * num_input_paths);
+int32_t measurement_corpus(struct measurement_configuration * const mcfg, struct word2vec * const w2v, struct batch * const batch, const int32_t batch_index);
+int32_t measurement_batch(struct measurement_configuration * const mcfg, struct word2vec * const w2v);
+int32_t measurement_serve_check(struct serve_job * const job, void * const arg);
+int32_t measurement_serve_job(struct serve_job * const job, void * const arg);
+int32_t measurement_serve_socket(struct measurement_configuration * const mcfg, struct word2vec * const w2v);
+
+#endif
@@ -32,7 +32,7 @@
 #include <stdint.h>
 
 #include "graph.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
 #include "measurement.h"
 
 int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char * const filename_tp, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, const char * const ec_cfg);
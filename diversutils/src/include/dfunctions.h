@@ -31,7 +31,38 @@
 #include "graph.h"
 #include "general_constants.h"
 
+// below this many nodes per thread, the memo is computed on the calling thread
+#define DFUNCTIONS_MEMO_MIN_NODES_PER_THREAD 4096
+
+#define DFUNCTIONS_NEEDS(primitive) (((uint32_t) 1) << (primitive))
+
+// primitives read by each function, to be requested before dfunctions_memo_compute; the Renyi family, Hill numbers and Hill evenness request their orders instead
+#define DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P)
+#define DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES)
+#define DFUNCTIONS_NEEDS_SIMPSON_INDEX DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX
+#define DFUNCTIONS_NEEDS_BERGER_PARKER_INDEX DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_MAX)
+#define DFUNCTIONS_NEEDS_SHANNON_EVENNESS DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY
+#define DFUNCTIONS_NEEDS_JUNGE1994_PAGE22 DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX
+#define DFUNCTIONS_NEEDS_MCINTOSH_INDEX DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX
+#define DFUNCTIONS_NEEDS_TYPE_TOKEN_RATIO DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_TOKENS)
+#define DFUNCTIONS_NEEDS_SW_ENTROPY_OVER_LOG_N_SPECIES_PIELOU1975 DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY
+#define DFUNCTIONS_NEEDS_SW_E_HEIP DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY
+#define DFUNCTIONS_NEEDS_SW_E_ONE_MINUS_D DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX
+#define DFUNCTIONS_NEEDS_SW_E_ONE_OVER_D_WILLIAMS1964 DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX
+#define DFUNCTIONS_NEEDS_SW_E_MINUS_LN_D_PIELOU1977 DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX
+#define DFUNCTIONS_NEEDS_SW_F_2_1_ALATALO1981 (DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX | DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY)
+#define DFUNCTIONS_NEEDS_SW_G_2_1_MOLINARI1989 DFUNCTIONS_NEEDS_SW_F_2_1_ALATALO1981
+#define DFUNCTIONS_NEEDS_SW_O_BULLA1994 DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN)
+#define DFUNCTIONS_NEEDS_SW_E_BULLA1994 DFUNCTIONS_NEEDS_SW_O_BULLA1994
+#define DFUNCTIONS_NEEDS_SW_E_MCI_PIELOU1969 (DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM) | DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX)
+#define DFUNCTIONS_NEEDS_SW_E_VAR_SMITH_AND_WILSON1996_ORIGINAL DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE)
+
+void dfunctions_memo_request(struct graph* const, const uint32_t);
+void dfunctions_memo_request_order(struct graph* const, const double);
+int32_t dfunctions_memo_compute(struct graph* const, const int16_t);
+
 double q_logarithm(const double, const double);
+// the *_from_graph functions below read the node count and proportions of g->snapshot, not the nodes: nodes appended since the last graph_snapshot_refresh (or compute_graph_relative_proportions) are left out
 void shannon_weaver_entropy_from_graph(const struct graph* const, double* const, double* const);
 void good_entropy_from_graph(const struct graph* const, double* const, double, double);
 void renyi_entropy_from_graph(const struct graph* const, double* const, double* const, double);
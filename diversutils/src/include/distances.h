@@ -45,6 +45,8 @@ float cosine_distance_fp32_avx256(const float* restrict const a, const float* re
 #if ENABLE_AVX512 == 1
 float cosine_distance_fp32_avx512(const float* restrict const a, const float* restrict const b, int32_t n);
 #endif
+float vector_norm_fp32(const float* restrict const a, const int32_t n);
+float cosine_distance_from_norms_fp32(const float* restrict const a, const float* restrict const b, const int32_t n, const float norm_a, const float norm_b);
 double cosine_distance(const double* restrict const a, const double* restrict const b, int n);
 double cosine_distance_norm(double* restrict a, double* restrict b, int32_t n);
 double chebyshev_distance(double* restrict a, double* restrict b, int n);
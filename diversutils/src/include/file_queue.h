@@ -0,0 +1,85 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FILE_QUEUE_H
+#define FILE_QUEUE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "measurement.h"
+
+#define FILE_QUEUE_ERROR_SIZE 256
+
+enum {
+	FILE_QUEUE_CUPT,
+	FILE_QUEUE_JSONL
+};
+
+struct file_queue_entry {
+	const char* filename;
+	const char* filename_tp;
+	int64_t size;
+	int32_t i; // index in the input list
+	int32_t corpus; // index in file_queue.corpora; 0 when the queue has none
+	int32_t format;
+};
+
+// the files of one corpus and what its readers update; the corpora of a queue only share its reader threads
+struct file_queue_corpus {
+	char* const * paths;
+	char* const * paths_tp; // NULL without true positive files
+	int32_t num_paths;
+	struct measurement_configuration* mcfg;
+	struct measurement_structure_references* sref;
+	struct measurement_mutables* mmut;
+	int32_t num_done; // updated by the queue
+};
+
+// input files handed out one at a time to whichever reader thread is free
+struct file_queue {
+	struct file_queue_entry* entries;
+	struct file_queue_corpus* corpora; // NULL when every file belongs to the corpus given to file_queue_read
+	int32_t num_entries;
+	int32_t next;
+	int32_t num_done;
+	int64_t total_size;
+	int64_t done_size;
+	int32_t status;
+	const struct measurement_progress* progress; // NULL unless someone follows the files as they are done
+	char error[FILE_QUEUE_ERROR_SIZE]; // the cause of the first failure, empty while there is none
+	pthread_mutex_t mutex;
+};
+
+int32_t create_file_queue(struct file_queue* const q, char* const * const paths, char* const * const paths_tp, const int32_t num_paths, const uint8_t largest_first);
+int32_t create_file_queue_corpora(struct file_queue* const q, struct file_queue_corpus* const corpora, const int32_t num_corpora, const uint8_t largest_first);
+int32_t file_queue_pop(struct file_queue* const q, const struct file_queue_entry** const entry);
+void file_queue_done(struct file_queue* const q, const struct file_queue_entry* const entry, const int32_t status);
+int32_t file_queue_read(struct file_queue* const q, struct measurement_configuration* const mcfg, struct measurement_structure_references* const sref, struct measurement_mutables* const mmut, const int32_t num_threads);
+void free_file_queue(struct file_queue* const q);
+
+#endif
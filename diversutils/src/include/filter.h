@@ -22,6 +22,15 @@ struct filter {
     PCRE2_SIZE rlength;
     const uint32_t options_compile;
     const uint32_t options_replace;
+    const char * const required_any; // a match needs at least one of these characters; NULL if no cheap requirement is known
+    const PCRE2_SIZE required_length; // a match needs a subject at least this long
+};
+
+// per-thread state for filter_substitute_all_workspace, reused across documents
+struct filter_workspace {
+    pcre2_match_data * match_data;
+    PCRE2_UCHAR * bfr;
+    PCRE2_SIZE capacity;
 };
 
 int32_t filter_compile(struct filter * const f, const uint8_t quiet);
@@ -29,6 +38,9 @@ void filter_free(struct filter * const f);
 int32_t filter_ready(const uint8_t quiet);
 void filter_release(void);
 int32_t filter_substitute_all(char ** const s, size_t * const s_len);
+int32_t create_filter_workspace(struct filter_workspace * const fw);
+void free_filter_workspace(struct filter_workspace * const fw);
+int32_t filter_substitute_all_workspace(struct filter_workspace * const fw, char ** const s, size_t * const s_len, size_t * const s_capacity_bytes);
 
 #endif
 
@@ -39,8 +39,9 @@
 #define MST_IMPLEMENTATION_VERSION 3
 #endif
 
-// #define GRAPH_CAPACITY_STEP 64
-#define GRAPH_CAPACITY_STEP 4096 / sizeof(struct graph_node)
+// nodes live in chunks that are never moved: chunk k holds (1 << (GRAPH_FIRST_CHUNK_SHIFT + k)) nodes, so that the chunk directory is fixed and lookups are O(1)
+#define GRAPH_FIRST_CHUNK_SHIFT 6
+#define GRAPH_NUM_CHUNKS 40
 
 #ifndef FP_MODES
 #define FP_MODES
@@ -63,10 +64,9 @@ struct graph_node {
 		float* fp32;
 		double* fp64;
 	} vector;
-	pthread_mutex_t mutex_local_node;
 	double relative_proportion;
-	uint32_t absolute_proportion;
-	uint32_t capacity_neighbours;
+	uint64_t absolute_proportion; // incremented with __atomic_fetch_add by concurrent readers; 64 bits, so that no corpus overflows it
+	uint32_t capacity_neighbours; // 0 until the first neighbour is added
 	uint32_t num_neighbours;
 	uint16_t num_dimensions;
 	uint8_t already_considered;
@@ -84,17 +84,82 @@ struct matrix {
 	uint8_t fp_mode;
 };
 
-struct graph {
-	struct graph_node* nodes;
+// quantities that several functions of dfunctions.h derive from the proportions, shared through the memo of the snapshot
+enum graph_snapshot_primitive {
+	GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P, // opposite of the Shannon-Weaver entropy
+	GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES, // Simpson dominance
+	GRAPH_SNAPSHOT_PRIMITIVE_SUM,
+	GRAPH_SNAPSHOT_PRIMITIVE_MAX,
+	GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN, // sum of min(p, 1/n)
+	GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN,
+	GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE, // depends on LOG_MEAN
+	GRAPH_SNAPSHOT_PRIMITIVE_TOKENS,
+	GRAPH_SNAPSHOT_NUM_PRIMITIVES
+};
+
+#define GRAPH_SNAPSHOT_MEMO_MAX_ORDERS 4
+
+// filled by dfunctions_memo_compute, and emptied by every refresh of the snapshot
+struct graph_snapshot_memo {
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double orders[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS]; // sum of p^order, for the Renyi family
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+	uint32_t num_orders;
+	uint32_t num_orders_computed;
+	uint32_t requested; // bit k for primitive k
+	uint32_t computed;
+};
+
+// structure-of-arrays copy of what the kernels read, rebuilt by graph_snapshot_refresh (see snapshot.h) at each recompute step
+struct graph_snapshot {
+	float* panel; // num_vectors rows of stride floats, 64-byte aligned and zero-padded past num_dimensions
+	float* norms;
+	double* relative_proportions;
+	uint64_t* absolute_proportions;
+	const char** keys; // NULL for nodes without a word2vec entry
 	uint64_t num_nodes;
+	uint64_t num_vectors;
+	uint64_t capacity;
+	uint64_t panel_capacity;
+	uint64_t sum_absolute_proportions;
+	uint16_t num_dimensions;
+	uint16_t stride;
+	uint8_t stale; // counts were written since the last refresh, see graph_snapshot_mark_stale
+	struct graph_snapshot_memo memo;
+};
+
+// what a graph knows of one word2vec entry; kept by the graph so that several graphs can share one word2vec
+struct graph_word2vec_slot {
+	struct graph_node* node; // published with release semantics once the node is in the graph
+	uint64_t node_index;
+	uint8_t active; // claimed with a compare-and-swap by the thread that creates the node, and released if it fails to
+};
+
+struct graph {
+	struct graph_node* chunks[GRAPH_NUM_CHUNKS];
+	uint32_t num_chunks;
+	uint64_t num_nodes; // published with release semantics by graph_append_node; read with graph_num_nodes when the graph may be growing
 	uint64_t capacity;
 	pthread_mutex_t mutex_nodes;
     pthread_mutex_t mutex_matrix;
 	struct matrix dist_mat;
+	struct graph_snapshot snapshot;
+	struct graph_word2vec_slot* word2vec_slots; // one per word2vec entry, in word2vec.keys order; see graph_bind_word2vec
+	uint64_t num_word2vec_slots;
 	int16_t num_dimensions;
 	uint8_t dist_mat_must_be_freed;
 };
 
+static inline struct graph_node* graph_node_at(const struct graph* const g, const uint64_t index){
+	const uint64_t biased = index + (((uint64_t) 1) << GRAPH_FIRST_CHUNK_SHIFT);
+	const uint32_t chunk = (uint32_t) (63 - __builtin_clzll(biased) - GRAPH_FIRST_CHUNK_SHIFT);
+	return &(g->chunks[chunk][biased - (((uint64_t) 1) << (chunk + GRAPH_FIRST_CHUNK_SHIFT))]);
+}
+
+static inline uint64_t graph_num_nodes(const struct graph* const g){
+	return __atomic_load_n(&(g->num_nodes), __ATOMIC_ACQUIRE);
+}
+
 // ---- <legacy> ----
 
 #define MAX_ABUNDANCE +1000
@@ -132,9 +197,11 @@ struct matrix_thread_arg {
 	struct graph* g;
 	uint8_t thread_rank;
 	uint8_t thread_total_count;
+	uint64_t first_new_node; // only read by matrix_extend_thread
 };
 
 void* matrix_thread(void*);
+void* matrix_extend_thread(void*);
 
 // ---- </threading> ----
 
@@ -147,6 +214,8 @@ void distance_row_from_graph(const struct graph* const restrict, const int32_t,
 int32_t distance_row_from_graph_multithread(const struct graph* const, const uint64_t, float* const, const int16_t);
 int32_t distance_row_batch_from_graph_multithread(const struct graph* const, const uint64_t, float* const, const int16_t, int16_t);
 int32_t distance_matrix_from_graph_multithread(struct graph* const, struct matrix* const, const int16_t);
+int32_t grow_matrix(struct matrix* const, const uint32_t);
+int32_t distance_matrix_extend_from_graph_multithread(struct graph* const, struct matrix* const, const uint64_t, const int16_t);
 void free_matrix(struct matrix*);
 int32_t stats_matrix(struct matrix*, double*, double*, double*, double*);
 
@@ -193,7 +262,9 @@ void free_graph_node(struct graph_node* restrict, const int8_t);
 int32_t create_graph(struct graph* restrict const, const int32_t, const int16_t, const int8_t);
 int32_t request_more_capacity_graph(struct graph* restrict const);
 int32_t create_graph_empty(struct graph* restrict const);
-void compute_graph_relative_proportions(struct graph* const);
+int32_t graph_append_node(struct graph* const, const struct graph_node* const, uint64_t* const);
+int32_t graph_append_nodes(struct graph* const, const struct graph_node* const, const uint64_t, uint64_t* const);
+int32_t compute_graph_relative_proportions(struct graph* const);
 int32_t compute_graph_dist_mat(struct graph* const, const int16_t);
 // ---- </graph> ----
 
@@ -201,29 +272,33 @@ int32_t compute_graph_dist_mat(struct graph* const, const int16_t);
 
 struct word2vec_entry {
 	float* vector;
-	struct graph_node* graph_node_pointer;
+	const char* key; // points into word2vec.key_blob; at most WORD2VEC_KEY_BUFFER_SIZE - 1 bytes
 	uint64_t num_occurrences;
-	uint64_t graph_node_index;
-    pthread_mutex_t mutex;
-	char key[WORD2VEC_KEY_BUFFER_SIZE];
-	uint8_t active_in_current_graph;
 };
 
 struct word2vec {
 	float* vectors;
 	struct word2vec_entry* keys;
+	char* key_blob; // all keys, NUL-terminated, back to back
+	size_t key_blob_size;
 	uint64_t num_vectors;
 	uint16_t num_dimensions;
 };
 
 int32_t word2vec_entry_cmp(const void* restrict, const void* restrict);
 int32_t load_word2vec_binary(struct word2vec* restrict, const char* restrict);
-void reset_word2vec_active_in_current_graph(struct word2vec* restrict const w2v);
+int32_t graph_bind_word2vec(struct graph* const, const struct word2vec* const);
+int32_t graph_add_word2vec_occurrence(struct graph* const, const struct word2vec* const, struct word2vec_entry* const);
 void free_word2vec(struct word2vec* restrict);
 int32_t word2vec_key_to_index(const struct word2vec* restrict, const char* restrict);
 struct word2vec_entry* word2vec_find_closest(const struct word2vec* restrict, const char* restrict);
 void free_graph(struct graph* restrict);
 
+// NULL until the entry occurred in the graph
+static inline struct graph_node* graph_word2vec_node(const struct graph* const g, const struct word2vec* const w2v, const struct word2vec_entry* const entry){
+	return __atomic_load_n(&(g->word2vec_slots[entry - w2v->keys].node), __ATOMIC_ACQUIRE);
+}
+
 int32_t word2vec_to_graph_fp32(struct graph*, struct word2vec*, char**, char**, int32_t, int32_t, const char * const);
 // ---- </word2vec> ----
 
@@ -247,6 +322,7 @@ int32_t siftdown(struct graph_distance_heap* const restrict, const int32_t, cons
 void heapify_min_heap(struct graph_distance_heap* const restrict);
 int32_t heapify(struct graph_distance_heap* restrict, const int32_t);
 int32_t create_graph_distance_heap(struct graph_distance_heap* restrict, struct graph* restrict, const struct matrix* const);
+int32_t create_graph_distance_heap_from_tree(struct graph_distance_heap* restrict, struct graph* restrict, const struct matrix* const, const struct distance_two_nodes* const, const uint64_t, const uint64_t);
 void pop_graph_distance_min_heap(struct graph_distance_heap* restrict, const uint64_t);
 void pop_graph_distance_min_heap_v2(struct graph_distance_heap* restrict, const uint64_t);
 void pop_graph_distance_min_heap_v3(struct graph_distance_heap* restrict, const uint64_t);
@@ -0,0 +1,85 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define INSTRUMENT_INITIAL_CAPACITY 256
+
+enum {
+	INSTRUMENT_COUNTER_CYCLES,
+	INSTRUMENT_COUNTER_LLC_MISSES,
+	INSTRUMENT_NUM_COUNTERS
+};
+
+struct instrument_span {
+	const char* name; // not copied, so that beginning a span never allocates
+	int64_t start_ns; // since instrument_init
+	int64_t duration_ns;
+	int64_t counters[INSTRUMENT_NUM_COUNTERS]; // -1 when the counter could not be opened
+	int64_t peak_rss_kb; // of the whole process, when the span ended
+	uint32_t depth; // number of spans of the same thread still open when it began
+	uint32_t thread_index; // order in which threads recorded their first span
+	int64_t os_tid;
+};
+
+// spans of one thread, only appended to by that thread
+struct instrument_thread {
+	struct instrument_span* spans;
+	uint64_t num_spans;
+	uint64_t capacity;
+	uint32_t depth;
+	uint32_t index;
+	int64_t os_tid;
+	uint32_t generation; // of the instrument_init the spans and counters belong to
+	int counter_fds[INSTRUMENT_NUM_COUNTERS]; // closed when the thread exits
+	uint8_t retired; // the thread exited, but its spans are kept until instrument_free
+	pthread_mutex_t mutex; // against instrument_collect only
+	struct instrument_thread* next;
+};
+
+struct instrument_scope {
+	const char* name;
+	struct instrument_thread* thread; // NULL when spans are not recorded
+	int64_t start_ns;
+	int64_t counters[INSTRUMENT_NUM_COUNTERS];
+};
+
+int32_t instrument_init(const uint8_t enable_counters);
+void instrument_free(void);
+uint8_t instrument_counters_available(void);
+int64_t instrument_now_ns(void);
+int32_t instrument_lap_ns(int64_t* const delta);
+void instrument_span_begin(struct instrument_scope* const scope, const char* const name);
+int64_t instrument_span_end(struct instrument_scope* const scope);
+int32_t instrument_collect(struct instrument_span** const spans, uint64_t* const num_spans);
+int32_t instrument_export_chrome_trace(const char* const path);
+
+#endif
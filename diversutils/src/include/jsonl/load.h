@@ -33,9 +33,12 @@
 #include <stdio.h>
 
 #include "graph.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
 #include "measurement.h"
+#include "jsonl/parser.h"
 
+int32_t jsonl_token_to_graph(char * const token, const struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, uint64_t * const num_oov_tokens);
+int32_t jsonl_document_to_graph(struct document * const doc, const struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, uint64_t * const num_oov_tokens);
 int32_t jsonl_to_graph(const uint64_t i, const char * const filename, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut);
 
 void * jsonl_to_graph_thread(void * args);
@@ -34,6 +34,10 @@
 #include "jsonl/constants.h"
 #if TOKENIZATION_METHOD == 0
 #include <regex.h>
+#elif TOKENIZATION_METHOD == 1
+#include "udpipe/coprocess.h"
+#elif TOKENIZATION_METHOD == 2
+#include "udpipe/interface/cinterface.h"
 #endif
 
 struct document {
@@ -45,11 +49,11 @@ struct document {
 	regex_t reg;
 	regoff_t latest_rm_eo;
 	#elif TOKENIZATION_METHOD == 1
-	FILE* tmp_udpipe_output_file;
+	struct udpipe_coprocess* coprocess; // borrowed from the pool while the document is being tokenized
 	#elif TOKENIZATION_METHOD == 2
-	FILE* tmp_udpipe_output_file;
-	// int32_t output_pipefd[2];
-	char* heap_char_output;
+	struct udpipe_tokens tokens; // buffers reused from one document to the next
+	size_t current_span;
+	int8_t tokenized;
 	#endif
 	char* identifier;
 	char* text;
@@ -73,7 +77,8 @@ struct jsonl_document_iterator {
     // int64_t offset_end; // excluded
 };
 
-void jsonl_init_tokenization(void);
+void jsonl_init_tokenization(const int32_t num_workers);
+void jsonl_free_tokenization(void);
 
 #if (TOKENIZATION_METHOD == 1 || TOKENIZATION_METHOD == 2)
 int32_t launch_udpipe(struct document* const doc);
@@ -81,6 +86,7 @@ int32_t launch_udpipe(struct document* const doc);
 
 int32_t create_document(struct document* doc);
 int32_t iterate_document_current_token(struct document* const doc);
+int32_t document_set_text(struct document* const doc, const char* const text, const size_t text_size);
 void free_document(struct document* doc);
 int32_t create_jsonl_document_iterator(struct jsonl_document_iterator* jdi, const char* file_name, const char* const content_key);
 void free_jsonl_document_iterator(struct jsonl_document_iterator* jdi);
@@ -29,7 +29,6 @@
 #define MACROCONFIG_H
 
 #define BFR_SIZE 256
-#define MAX_FILES 1024
 
 #ifndef ENABLE_STIRLING
 #define ENABLE_STIRLING 1
@@ -196,6 +195,12 @@
 #ifndef NUM_FILE_READING_THREADS
 #define NUM_FILE_READING_THREADS 4
 #endif
+#ifndef RECOMPUTE_QUEUE_SIZE
+#define RECOMPUTE_QUEUE_SIZE 4
+#endif
+#ifndef SCHEDULE_LARGEST_FIRST
+#define SCHEDULE_LARGEST_FIRST 1
+#endif
 
 #ifndef ENABLE_NON_DISPARITY_MULTITHREADING
 #define ENABLE_NON_DISPARITY_MULTITHREADING 1
@@ -231,9 +236,31 @@
 #define DOCUMENT_COUNT_RECOMPUTE_STEP_LOG10 0.1
 #endif
 
+#ifndef SENTENCE_RECOMPUTE_STEP_USE_ADAPTIVE
+#define SENTENCE_RECOMPUTE_STEP_USE_ADAPTIVE 0
+#endif
+#ifndef DOCUMENT_RECOMPUTE_STEP_USE_ADAPTIVE
+#define DOCUMENT_RECOMPUTE_STEP_USE_ADAPTIVE 0
+#endif
+#ifndef ADAPTIVE_RECOMPUTE_COMPUTE_FRACTION
+#define ADAPTIVE_RECOMPUTE_COMPUTE_FRACTION 0.1
+#endif
+#ifndef ADAPTIVE_RECOMPUTE_MIN_STEP
+#define ADAPTIVE_RECOMPUTE_MIN_STEP 1
+#endif
+#ifndef ADAPTIVE_RECOMPUTE_MAX_STEP
+#define ADAPTIVE_RECOMPUTE_MAX_STEP 0
+#endif
+#ifndef ADAPTIVE_RECOMPUTE_DETERMINISTIC
+#define ADAPTIVE_RECOMPUTE_DETERMINISTIC 0
+#endif
+
 #ifndef INPUT_PATH
 #define INPUT_PATH "measurement_files.txt"
 #endif
+#ifndef BATCH_PATH
+#define BATCH_PATH "" // empty: one corpus, from INPUT_PATH
+#endif
 #ifndef OUTPUT_PATH
 #define OUTPUT_PATH "measurement_output.tsv"
 #endif
@@ -243,6 +270,45 @@
 #ifndef OUTPUT_PATH_MEMORY
 #define OUTPUT_PATH_MEMORY "measurement_output_memory.tsv"
 #endif
+#ifndef OUTPUT_FORMAT
+#define OUTPUT_FORMAT 0 // 0: TSV, 1: columnar
+#endif
+#ifndef OUTPUT_COMPRESSION
+#define OUTPUT_COMPRESSION 1
+#endif
+#ifndef OUTPUT_ROW_GROUP_SIZE
+#define OUTPUT_ROW_GROUP_SIZE 1024
+#endif
+#ifndef TRACE_PATH
+#define TRACE_PATH "" // empty: no trace
+#endif
+#ifndef ENABLE_HARDWARE_COUNTERS
+#define ENABLE_HARDWARE_COUNTERS 0
+#endif
+#ifndef CHECKPOINT_PATH
+#define CHECKPOINT_PATH "" // empty: no checkpoint
+#endif
+#ifndef CHECKPOINT_INTERVAL
+#define CHECKPOINT_INTERVAL 600.0 // seconds
+#endif
+#ifndef RESUME
+#define RESUME 0
+#endif
+#ifndef SHARD_OUTPUT_PATH
+#define SHARD_OUTPUT_PATH "" // non-empty: ingest only, and write the counts there
+#endif
+#ifndef SHARD_INPUT_PATH
+#define SHARD_INPUT_PATH "" // non-empty: measure the counts of this shard instead of reading INPUT_PATH
+#endif
+#ifndef SERVE_PATH
+#define SERVE_PATH "" // non-empty: load the word2vec once, and measure the jobs sent to this Unix domain socket
+#endif
+#ifndef SERVE_NUM_JOBS
+#define SERVE_NUM_JOBS 1
+#endif
+#ifndef SERVE_QUEUE_SIZE
+#define SERVE_QUEUE_SIZE 16
+#endif
 
 #ifndef ENABLE_OUTPUT_TIMING
 #define ENABLE_OUTPUT_TIMING 1
@@ -36,7 +36,14 @@
 #include <stdio.h>
 
 #include "graph.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
+#include "output.h"
+#include "shard.h"
+
+struct recompute_worker;
+struct recompute_schedule;
+struct checkpoint;
+struct measurement_mutables;
 
 struct measurement_diversity_parameters {
 	const double stirling_alpha;
@@ -96,22 +103,35 @@ struct measurement_diversity_enabler {
 	const uint8_t sw_e_var_smith_and_wilson1996_original;
 };
 
+// told about each file once it was read, in the order the readers finish them
+struct measurement_progress {
+	void (*file_done)(void * const ctx, const char * const filename, const int32_t num_done, const int32_t num_files, const double fraction_of_bytes);
+	void * ctx;
+};
+
 struct measurement_io {
 	const char * const w2v_path;
 	const char * const jsonl_content_key;
 	const char * const input_path;
 	char * const input_path_tp;
+	const char * const batch_path; // manifest of corpora measured together; NULL or empty for the single corpus of input_path
 	const char * const output_path;
 	const char * const output_path_timing;
 	const char * const output_path_memory;
 	const char * const udpipe_model_path;
-    FILE * f_ptr;
-    FILE * f_timing_ptr;
-    FILE * f_memory_ptr;
+    struct output_stream * output;
+    struct output_stream * output_timing;
+    struct output_stream * output_memory;
+    const uint8_t output_format;
+    const uint8_t output_compression;
+    const uint32_t output_row_group_size; // rows per group of the columnar format
 	const uint8_t enable_timings;
 	const uint8_t enable_output_timing;
 	const uint8_t enable_output_memory;
 	const uint8_t force_timing_and_memory_to_output_path;
+	const struct measurement_progress * const progress; // NULL unless the caller follows the files as they are read
+	char * const error; // NULL unless the caller reports why the measurement failed; receives the first cause, in error_size bytes
+	const size_t error_size;
 };
 
 struct measurement_threading {
@@ -123,6 +143,8 @@ struct measurement_threading {
 	const uint8_t enable_multithreaded_row_generation;
 	const int8_t row_generation_batch_size;
     const uint8_t enable_sw_e_prime_camargo1993_multithreading;
+    const int32_t recompute_queue_size; // steps waiting for the recompute thread; 0 runs every step on the reader that reached it
+    const uint8_t schedule_largest_first; // 0 reads the files in input order
 };
 
 struct measurement_step {
@@ -130,11 +152,37 @@ struct measurement_step {
     const double recompute_step_log10; // const?
     const uint8_t enable_count_recompute_step;
     const uint8_t use_log10;
+    const uint8_t use_adaptive; // boundaries from the cost model; with use_log10, rounded up to the next 10^(k * recompute_step_log10)
+};
+
+struct measurement_adaptive_step {
+    const double compute_fraction; // share of wall time that recompute steps may take
+    const uint64_t min_step;
+    const uint64_t max_step; // 0 bounds every step by the number of units already read
+    const uint8_t deterministic; // declared complexities instead of timings, so that boundaries only depend on the data
 };
 
 struct measurement_step_parameters {
     struct measurement_step sentence;
     struct measurement_step document;
+    struct measurement_adaptive_step adaptive;
+};
+
+struct measurement_checkpoint {
+    const char * const path; // empty disables checkpoints
+    const double interval; // seconds between two checkpoints
+    const uint8_t resume; // start from the checkpoint at path, if there is one
+};
+
+struct measurement_shard {
+    const char * const output_path; // non-empty: the files are only ingested, and their counts written there instead of any step
+    const char * const input_path; // non-empty: no file is read, the final step is computed on the counts of this shard
+};
+
+struct measurement_serve {
+    const char * const path; // non-empty: no corpus is read, jobs are taken from this Unix domain socket instead
+    const int32_t num_jobs; // jobs measured at the same time
+    const int32_t queue_size; // jobs waiting for one of those, beyond which new ones are rejected
 };
 
 // !
@@ -147,6 +195,16 @@ struct measurement_configuration {
     struct measurement_io io;
     const struct measurement_threading threading;
     const struct measurement_step_parameters steps; // const?
+    const size_t oov_memory_cap; // bytes; 0 means exact OOV counting
+    const struct measurement_checkpoint checkpoint;
+    const struct measurement_shard shard;
+    const struct measurement_serve serve;
+};
+
+// replaces what measurement_recompute_step computes and writes, for callers that handle the steps themselves
+struct measurement_step_hook {
+    int32_t (*step)(void * const ctx, const uint64_t i, struct graph * const g, const struct measurement_mutables * const mmut);
+    void * ctx;
 };
 
 // !
@@ -155,7 +213,11 @@ struct measurement_structure_references {
     struct minimum_spanning_tree * const mst;
     struct graph_distance_heap * const heap;
     struct word2vec * const w2v;
-    struct sorted_array * const sorted_array_discarded_because_not_in_vector_database;
+    struct oov_counter * const oov_discarded_because_not_in_vector_database;
+    struct recompute_worker * const recompute; // NULL when steps are computed by the readers themselves
+    struct recompute_schedule * const schedule; // NULL unless some step use_adaptive
+    struct checkpoint * const checkpoint; // NULL unless checkpoints are written
+    const struct measurement_step_hook * const step_hook; // NULL unless the caller computes the steps
 };
 
 struct measurement_mutable_counters {
@@ -171,6 +233,7 @@ struct measurement_mutables {
     double best_s;
     double prev_best_s;
     int64_t prev_num_nodes;
+    int64_t num_oov_types; // captured along with the counters when a step is reached
     struct measurement_mutable_counters sentence;
     struct measurement_mutable_counters document;
     uint8_t mst_initialised;
@@ -193,17 +256,17 @@ int32_t time_ns_delta(int64_t* const delta);
 
 int32_t virtual_memory_consumption(int64_t* const res);
 
-void timing_and_memory(FILE* f_timing_ptr, FILE* f_memory_ptr, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
+void timing_and_memory(struct output_stream* const output_timing, struct output_stream* const output_memory, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
 
-int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
-int32_t wrap_diversity_1r_0a_no_matrix(struct graph* const g, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, const int8_t), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
-int32_t wrap_diversity_2r_1a(struct graph* const g, struct matrix* const m, const double alpha, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, double* const, double, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
-int32_t wrap_diversity_2r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
-int32_t wrap_diversity_2r_0a_long_double_alt(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, long double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
-/* int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double*, const int8_t, struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory); */
+int32_t wrap_diversity_1r_0a(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
+int32_t wrap_diversity_1r_0a_no_matrix(const char* const name, struct graph* const g, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, const int8_t), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
+int32_t wrap_diversity_2r_1a(const char* const name, struct graph* const g, struct matrix* const m, const double alpha, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, double* const, double, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
+int32_t wrap_diversity_2r_0a(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
+int32_t wrap_diversity_2r_0a_long_double_alt(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, long double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory);
+/* int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double*, const int8_t, struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory); */
 
 /*
-int32_t apply_diversity_functions_to_graph(struct graph* g, struct minimum_spanning_tree* mst, struct graph_distance_heap* heap, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int64_t* previous_g_num_nodes_p, int64_t* num_sentences_p, int64_t* num_all_sentences_p, int64_t* num_documents_p, double* best_s, int8_t* mst_initialised, uint64_t i, struct sorted_array* sorted_array_discarded_because_not_in_vector_database,
+int32_t apply_diversity_functions_to_graph(struct graph* g, struct minimum_spanning_tree* mst, struct graph_distance_heap* heap, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int64_t* previous_g_num_nodes_p, int64_t* num_sentences_p, int64_t* num_all_sentences_p, int64_t* num_documents_p, double* best_s, int8_t* mst_initialised, uint64_t i, struct sorted_array* sorted_array_discarded_because_not_in_vector_database,
 	char* w2v_path,
 	uint32_t num_row_threads,
 	uint32_t num_matrix_threads,
@@ -269,6 +332,9 @@ int32_t apply_diversity_functions_to_graph(struct graph* g, struct minimum_spann
 */
 // int32_t apply_diversity_functions_to_graph(struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut);
 int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut);
+int32_t measurement_recompute_step(const uint64_t i, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, const uint8_t force);
+int32_t measurement_capture_shard(struct shard * const s, const struct measurement_structure_references * const sref, const struct measurement_mutables * const mmut, const uint64_t num_files);
+int32_t measurement_restore_shard(const struct shard * const s, const struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, int64_t * const num_oov_types);
 
 // int32_t measurement(struct measurement_configuration * const mcfg);
 
@@ -0,0 +1,53 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OOV_CONSTANTS_H
+#define OOV_CONSTANTS_H
+
+#define OOV_COUNTER_KEY_SIZE 64
+
+#define OOV_COUNTER_NUM_SHARDS_LOG2 6
+#define OOV_COUNTER_NUM_SHARDS (1 << OOV_COUNTER_NUM_SHARDS_LOG2)
+#define OOV_COUNTER_SHARD_INITIAL_CAPACITY 64
+
+#define OOV_COUNTER_SKETCH_DEPTH 4
+#define OOV_COUNTER_SKETCH_MIN_WIDTH 1024
+#define OOV_COUNTER_SKETCH_MAX_WIDTH (1 << 24)
+
+#define OOV_COUNTER_TOP_K 64
+
+enum {
+    OOV_COUNTER_MODE_EXACT = 0,
+    OOV_COUNTER_MODE_APPROXIMATE = 1,
+};
+
+// 0 means that OOV types are always counted exactly, whatever the memory they take
+#ifndef OOV_MEMORY_CAP
+#define OOV_MEMORY_CAP 0
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OOV_COUNTER_H
+#define OOV_COUNTER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "oov/constants.h"
+
+struct oov_counter_entry {
+    uint64_t hash;
+    int64_t value;
+    char key[OOV_COUNTER_KEY_SIZE];
+};
+
+// open addressing (linear probing), capacity is a power of two
+struct oov_counter_shard {
+    struct oov_counter_entry * bfr;
+    int64_t num_elements;
+    int64_t capacity;
+    pthread_mutex_t mutex;
+};
+
+// Count-Min sketch, counters are updated atomically
+struct oov_counter_sketch {
+    uint32_t * table;
+    uint64_t width;
+    uint64_t mask;
+};
+
+// Space-Saving style list of the heaviest OOV types, fed with sketch estimates
+struct oov_counter_top_k {
+    struct oov_counter_entry entries[OOV_COUNTER_TOP_K];
+    int32_t num_entries;
+    int64_t min_value;
+    pthread_mutex_t mutex;
+};
+
+/*
+ * Vocabulary-miss accounting shared by the file reading threads.
+ * Exact mode: OOV_COUNTER_NUM_SHARDS hash tables, each behind its own mutex.
+ * If memory_cap != 0 and the tables outgrow it, the counter switches (once and for all) to a Count-Min sketch and a top-k list.
+ * num_types is then a lower bound (a type is only counted as new when the sketch has never seen it).
+ */
+struct oov_counter {
+    struct oov_counter_shard shards[OOV_COUNTER_NUM_SHARDS];
+    struct oov_counter_sketch sketch;
+    struct oov_counter_top_k top_k;
+    size_t memory_cap;
+    size_t memory_used;
+    int64_t num_types;
+    uint8_t mode;
+    pthread_mutex_t mutex_mode;
+};
+
+int32_t create_oov_counter(struct oov_counter * const counter, const size_t memory_cap);
+void free_oov_counter(struct oov_counter * const counter);
+int32_t oov_counter_increment(struct oov_counter * const counter, const char * const key);
+int64_t oov_counter_get(struct oov_counter * const counter, const char * const key);
+int64_t oov_counter_num_types(const struct oov_counter * const counter);
+uint8_t oov_counter_is_exact(const struct oov_counter * const counter);
+int32_t oov_counter_most_frequent(struct oov_counter * const counter, struct oov_counter_entry * const bfr, const int32_t n, int32_t * const num_written);
+int32_t oov_counter_entries(struct oov_counter * const counter, struct oov_counter_entry ** const entries, int64_t * const num_entries);
+int32_t oov_counter_save(const struct oov_counter * const counter, FILE * const f);
+int32_t oov_counter_load(struct oov_counter * const counter, FILE * const f);
+
+#endif
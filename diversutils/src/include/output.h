@@ -0,0 +1,130 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define OUTPUT_COLUMNAR_MAGIC "DVSCOL01"
+#define OUTPUT_COLUMNAR_MAGIC_SIZE 8
+// row groups handed to the writer thread and not written yet
+#define OUTPUT_QUEUE_CAPACITY 4
+
+enum {
+	OUTPUT_FORMAT_TSV,
+	OUTPUT_FORMAT_COLUMNAR,
+};
+
+enum {
+	OUTPUT_COMPRESSION_NONE,
+	OUTPUT_COMPRESSION_DELTA_XOR, // integers as zigzag varints of the delta to the previous row, doubles xor'ed with the previous row, strings repeated by reference
+};
+
+// each type prints as the TSV writer always did, so that converting a columnar file gives back the same bytes
+enum output_type {
+	OUTPUT_TYPE_UINT64 = 1, // %lu
+	OUTPUT_TYPE_INT64, // %li
+	OUTPUT_TYPE_DOUBLE, // %.10e
+	OUTPUT_TYPE_LONG_DOUBLE, // %.10Le
+	OUTPUT_TYPE_STRING, // %s
+};
+
+union output_cell {
+	uint64_t u;
+	int64_t i;
+	double d;
+	long double ld;
+	char* s;
+};
+
+// num_rows rows of num_columns cells, row after row
+struct output_row_group {
+	union output_cell* cells;
+	uint32_t num_rows;
+	struct output_row_group* next;
+};
+
+/*
+ * Rows are built value by value by a single producer at a time, then handed over in row groups to a writer thread,
+ * which formats them as TSV or encodes them in the columnar format:
+ *
+ *   magic, compression (u8), sizeof(long double) (u8), row group size (u32), header size (u64), header text,
+ *   number of columns (u32), type of each column (u8), then row groups: number of rows (u32) followed by every
+ *   column of the group, one after the other; a group of 0 rows ends the file.
+ *
+ * The header text is the TSV header line, i.e. the function names and their parameters; the columns and their types
+ * are those of the first row, which every other row must match. Integers are little-endian.
+ */
+struct output_stream {
+	FILE* f;
+	char* header;
+	size_t header_size;
+	size_t header_capacity;
+	uint8_t* types; // of the columns, set by the first row
+	uint32_t num_columns;
+	union output_cell* row; // row being built
+	uint8_t* row_types;
+	uint32_t row_length;
+	uint32_t row_capacity;
+	uint8_t row_failed; // a value of the row being built was lost, so that output_end_row rejects the row
+	struct output_row_group* current;
+	uint32_t row_group_size; // 1 for TSV, so that every row reaches the file as soon as it is complete
+	uint8_t format;
+	uint8_t compression;
+	uint8_t schema_set;
+	uint8_t preamble_written;
+	struct output_row_group* queue_head;
+	struct output_row_group* queue_tail;
+	uint32_t queue_length;
+	uint8_t closing;
+	uint8_t writing; // a group was taken off the queue and is being written
+	int32_t status; // non-zero once a row was rejected or a write failed
+	pthread_t writer;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond_not_empty;
+	pthread_cond_t cond_not_full;
+};
+
+int32_t create_output_stream(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size);
+int32_t create_output_stream_resumed(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size, const int64_t size);
+int32_t output_header(struct output_stream* const s, const char* const format, ...);
+int32_t output_uint(struct output_stream* const s, const uint64_t value);
+int32_t output_int(struct output_stream* const s, const int64_t value);
+int32_t output_double(struct output_stream* const s, const double value);
+int32_t output_long_double(struct output_stream* const s, const long double value);
+int32_t output_string(struct output_stream* const s, const char* const value);
+int32_t output_end_row(struct output_stream* const s);
+int32_t output_stream_sync(struct output_stream* const s, int64_t* const size);
+int32_t output_stream_finish(struct output_stream* const s);
+void free_output_stream(struct output_stream* const s);
+
+int32_t output_columnar_to_tsv(FILE* const f_in, FILE* const f_out);
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECOMPUTE_H
+#define RECOMPUTE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "measurement.h"
+
+// what a reader captures, under mutex_nodes, when it reaches a recompute step
+struct recompute_job {
+	struct graph_node* chunks[GRAPH_NUM_CHUNKS];
+	uint64_t* counts;
+	uint64_t num_nodes;
+	uint64_t i;
+	int64_t num_oov_types;
+	struct measurement_mutable_counters sentence;
+	struct measurement_mutable_counters document;
+	uint8_t force;
+};
+
+// computes recompute steps on a dedicated thread, in submission order, while the readers keep filling the graph
+struct recompute_worker {
+	struct graph view; // shares the nodes of the live graph, but only sees the nodes and counts of the step being computed
+	struct measurement_configuration* mcfg;
+	struct measurement_structure_references sref;
+	struct measurement_mutables mmut;
+	struct recompute_job* jobs;
+	uint32_t capacity;
+	uint32_t head;
+	uint32_t num_jobs;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond_not_empty;
+	pthread_cond_t cond_not_full;
+	pthread_t thread;
+	int32_t status;
+	uint8_t busy; // a step was taken off the queue and is being computed
+	uint8_t stop;
+};
+
+int32_t create_recompute_worker(struct recompute_worker* const w, struct measurement_configuration* const mcfg, const struct measurement_structure_references* const sref, const struct measurement_mutables* const mmut, const uint32_t capacity);
+int32_t recompute_worker_submit(struct recompute_worker* const w, const uint64_t i, const struct graph* const g, const struct measurement_mutables* const mmut, const int64_t num_oov_types, const uint8_t force);
+int32_t recompute_worker_drain(struct recompute_worker* const w);
+int32_t recompute_worker_finish(struct recompute_worker* const w);
+void free_recompute_worker(struct recompute_worker* const w);
+
+#endif
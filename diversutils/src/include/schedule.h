@@ -0,0 +1,87 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+// costs used in deterministic mode, where boundaries only depend on the data read
+#define RECOMPUTE_SCHEDULE_VIRTUAL_NS_PER_UNIT 1000000.0
+#define RECOMPUTE_SCHEDULE_VIRTUAL_NS_PER_NODE 100.0
+#define RECOMPUTE_SCHEDULE_MAX_EXPONENT 4.0
+#define RECOMPUTE_SCHEDULE_INGEST_SMOOTHING 0.5
+
+// the parts of a recompute step that are timed separately, each with its own complexity model
+enum {
+	RECOMPUTE_COST_FIT, // proportions and zipfian fit, O(n)
+	RECOMPUTE_COST_DISPARITY, // vectors, distance matrix and disparity functions, O(n^2)
+	RECOMPUTE_COST_NON_DISPARITY, // functions of the proportions only, O(n)
+	RECOMPUTE_COST_NUM_FUNCTIONS
+};
+
+// y = a * x^b, fitted by least squares on logarithms; the prior exponent stands in until two observations are available
+struct recompute_power_law {
+	double sum_x;
+	double sum_y;
+	double sum_xx;
+	double sum_xy;
+	uint32_t num_observations;
+	double prior_exponent;
+};
+
+// what the schedule knows about one kind of unit (sentences or documents)
+struct recompute_schedule_progress {
+	struct recompute_power_law growth; // number of nodes against number of units read
+	double ingest_ns_per_unit; // negative until a first interval was measured
+	uint64_t last_units;
+	int64_t last_ns;
+	int64_t last_compute_ns;
+};
+
+struct recompute_schedule {
+	struct recompute_power_law costs[RECOMPUTE_COST_NUM_FUNCTIONS]; // ns against number of nodes
+	struct recompute_schedule_progress sentence;
+	struct recompute_schedule_progress document;
+	uint32_t enabled_functions; // bit k set when RECOMPUTE_COST_* k runs at each step
+	double compute_fraction;
+	uint64_t min_step;
+	uint64_t max_step; // 0 bounds every step by the number of units already read
+	int64_t compute_ns; // total spent in recompute steps
+	uint8_t deterministic;
+	pthread_mutex_t mutex;
+};
+
+int32_t create_recompute_schedule(struct recompute_schedule* const s, const uint32_t enabled_functions, const double compute_fraction, const uint64_t min_step, const uint64_t max_step, const uint8_t deterministic);
+int64_t recompute_schedule_now(void);
+void recompute_schedule_observe_compute(struct recompute_schedule* const s, const int32_t function, const uint64_t num_nodes, const int64_t ns);
+double recompute_schedule_cost(struct recompute_schedule* const s, const double num_nodes);
+uint64_t recompute_schedule_next(struct recompute_schedule* const s, struct recompute_schedule_progress* const p, const uint64_t units, const uint64_t num_nodes, const int64_t now_ns, const uint8_t compute_on_reader, const double log10_spacing);
+void free_recompute_schedule(struct recompute_schedule* const s);
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SERVE_H
+#define SERVE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define SERVE_LINE_SIZE 65536 // longest request line
+#define SERVE_REPLY_SIZE 16384
+#define SERVE_ERROR_SIZE 256
+#define SERVE_POLL_INTERVAL_MS 100 // how often the accepting thread looks for a shutdown
+#define SERVE_SOCKET_MODE 0600 // read and write for the user the server runs as only
+
+struct serve;
+
+// one connection to the socket: requests are read by its own thread, and the replies of its jobs are written by the workers
+struct serve_connection {
+	int32_t fd;
+	int32_t num_references; // its reader, plus each of its jobs not answered yet; under serve.mutex
+	pthread_mutex_t mutex; // one reply at a time
+	struct serve* server;
+	struct serve_connection* next;
+};
+
+// one request line, a JSON object: {"id": ..., "input_path": ..., "output_path": ..., "functions": [...]}
+struct serve_job {
+	char* id; // as sent by the client; NULL without one
+	uint8_t id_is_number; // echoed without quotes
+	char* input_path; // list of the files to read, as --input_path
+	char* input_path_tp; // NULL without true positive files
+	char* output_path;
+	char* output_path_timing; // NULL without timing output
+	char* output_path_memory; // NULL without memory output
+	char** functions; // names of the --enable_* arguments enabled for this job; NULL keeps those of the server
+	int32_t num_functions;
+	char error[SERVE_ERROR_SIZE]; // set by the check or job function that rejects it
+	struct serve_connection* connection;
+};
+
+typedef int32_t (*serve_job_function)(struct serve_job* const, void* const);
+// called before a job is queued; returns 1, with job->error set, to reject it
+typedef int32_t (*serve_check_function)(struct serve_job* const, void* const);
+
+// a Unix domain socket whose jobs run on num_workers threads, with at most queue_size jobs waiting for one of them
+struct serve {
+	int32_t fd;
+	char* socket_path;
+	struct serve_job** queue; // circular
+	int32_t queue_size;
+	int32_t queue_head;
+	int32_t num_queued;
+	pthread_t* workers;
+	int32_t num_workers;
+	struct serve_connection* connections; // those still open
+	int32_t num_connections;
+	uint8_t stopping; // set by a shutdown request: the queued jobs still run, new ones are rejected
+	serve_job_function f;
+	serve_check_function check; // NULL queues every well-formed job
+	void* arg; // given to f and check
+	pthread_mutex_t mutex;
+	pthread_cond_t cond_queue;
+	pthread_cond_t cond_connections;
+};
+
+int32_t create_serve(struct serve* const s, const char* const socket_path, const int32_t num_workers, const int32_t queue_size, serve_job_function f, serve_check_function check, void* const arg);
+int32_t serve_run(struct serve* const s);
+void free_serve(struct serve* const s);
+void serve_job_file_done(void* const ctx, const char* const filename, const int32_t num_done, const int32_t num_files, const double fraction_of_bytes);
+int32_t serve_request(const char* const socket_path, const char* const request, FILE* const replies);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHARD_MAGIC "DVSSHD01"
+#define SHARD_MAGIC_SIZE 8
+#define SHARD_VERSION 1
+#define SHARD_BYTE_ORDER_MARK 0x01020304u
+#define SHARD_KEY_MAX_SIZE 0xffff
+
+// one vocabulary (or OOV) type and its number of occurrences
+struct shard_entry {
+	const char * key; // into the key_blob of the shard, NUL-terminated
+	uint64_t count;
+	uint64_t first_seen; // rank of the first occurrence among the types of the shard; 0 for OOV types
+};
+
+/*
+ * Abundances of a corpus, or of a part of one, without the vectors: the keys are those of the vector database,
+ * so that shards ingested separately (by other processes, on other machines) can be summed and measured together.
+ * Entries are sorted by key; first_seen keeps the order in which the graph would have created the nodes.
+ * With approximate OOV counting (oov_exact == 0), only the heaviest OOV types are kept and num_oov_types is a lower bound.
+ */
+struct shard {
+	struct shard_entry * entries;
+	uint64_t num_entries;
+	struct shard_entry * oov_entries;
+	uint64_t num_oov_entries;
+	char * key_blob;
+	size_t key_blob_size;
+	uint64_t num_files;
+	uint64_t num_documents;
+	uint64_t num_sentences;
+	uint64_t num_sentences_containing_mwe;
+	uint64_t num_sentences_containing_mwe_tp_only;
+	uint64_t num_tokens; // sum of the counts of entries
+	uint64_t num_oov_tokens; // sum of the counts of oov_entries
+	int64_t num_oov_types;
+	uint8_t oov_exact;
+};
+
+int32_t create_shard(struct shard * const s, const uint64_t num_entries, const uint64_t num_oov_entries, const size_t key_blob_size);
+int32_t shard_sort(struct shard * const s);
+int32_t shard_write(const struct shard * const s, const char * const path);
+int32_t shard_read(struct shard * const s, const char * const path);
+int32_t shard_merge(struct shard * const result, const struct shard * const inputs, const int32_t num_inputs, const int32_t num_threads);
+void free_shard(struct shard * const s);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "graph.h"
+#include "distances.h"
+
+#ifndef MST_SANITY_TESTING
+#define MST_SANITY_TESTING 0
+#endif
+
+// panel rows are padded to a multiple of this many bytes, so that every row is aligned for the widest vector loads
+#define GRAPH_SNAPSHOT_ALIGNMENT 64
+#define GRAPH_SNAPSHOT_STRIDE_STEP (GRAPH_SNAPSHOT_ALIGNMENT / sizeof(float))
+// below this many nodes per thread, the refresh stays on the calling thread
+#define GRAPH_SNAPSHOT_MIN_NODES_PER_THREAD 4096
+
+int32_t graph_snapshot_refresh(struct graph* const, const uint8_t, const int16_t);
+int32_t graph_snapshot_refresh_from_counts(struct graph* const, const uint64_t* const, const uint8_t, const int16_t);
+int32_t graph_snapshot_gather_vectors(struct graph* const, const int16_t);
+void free_graph_snapshot(struct graph_snapshot* const);
+
+static inline const float* graph_snapshot_row(const struct graph_snapshot* const s, const uint64_t i){
+	return &(s->panel[i * s->stride]);
+}
+
+static inline uint8_t graph_snapshot_has_vectors(const struct graph* const g){
+	return g->snapshot.num_vectors == g->num_nodes && (g->snapshot.panel != NULL || g->num_nodes == 0);
+}
+
+// to be called by whoever writes the counts of nodes already in the snapshot, which its node count alone does not reveal
+static inline void graph_snapshot_mark_stale(struct graph* const g){
+	g->snapshot.stale = 1;
+}
+
+// whether the proportions and memo of the snapshot are those of the current nodes and counts of g
+static inline uint8_t graph_snapshot_is_current(const struct graph* const g){
+	return !g->snapshot.stale && g->snapshot.num_nodes == g->num_nodes;
+}
+
+// same value as the distance of the matching build on the node vectors, but read from the panel
+static inline float graph_snapshot_distance(const struct graph_snapshot* const s, const uint64_t i, const uint64_t j){
+	#if MST_SANITY_TESTING == 1 && ENABLE_AVX256 != 1 && ENABLE_AVX512 != 1
+	return minkowski_distance_fp32((float*) graph_snapshot_row(s, i), (float*) graph_snapshot_row(s, j), s->num_dimensions, 2.0f);
+	#else
+	return cosine_distance_from_norms_fp32(graph_snapshot_row(s, i), graph_snapshot_row(s, j), s->stride, s->norms[i], s->norms[j]);
+	#endif
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef UDPIPE_COPROCESS_H
+#define UDPIPE_COPROCESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define UDPIPE_COPROCESS_SENTINEL "DIVERSUTILSENDOFDOCUMENT"
+#define UDPIPE_COPROCESS_MAX_RESTARTS 3
+#define UDPIPE_COPROCESS_TIMEOUT_MS 600000
+#define UDPIPE_COPROCESS_READ_SIZE 65536
+
+/*
+ * Long-running tokenizer child (e.g. "udpipe --tokenize --immediate --output=vertical model"), fed through pipes.
+ * Documents are written as paragraphs followed by a sentinel paragraph; the sentinel token in the output marks the end of the document.
+ * The child must emit each paragraph as soon as it has read it (--immediate for UDPipe) and may answer in vertical or CoNLL-U format.
+ * Output is drained while input is written, so that neither side can block the other.
+ * If the child dies or times out, it is restarted, the document is written again and the tokens already delivered are skipped.
+ */
+struct udpipe_coprocess {
+    char * const * argv;
+    pid_t pid;
+    int32_t fd_in;
+    int32_t fd_out;
+    char * bfr;
+    size_t bfr_start;
+    size_t bfr_size;
+    size_t bfr_capacity;
+    const char * text;
+    size_t text_size;
+    uint64_t num_tokens_delivered;
+    uint64_t num_tokens_to_skip;
+    int32_t num_restarts;
+    int8_t in_document;
+    int8_t busy;
+};
+
+int32_t create_udpipe_coprocess(struct udpipe_coprocess * const cp, char * const * const argv);
+void free_udpipe_coprocess(struct udpipe_coprocess * const cp);
+int32_t udpipe_coprocess_submit(struct udpipe_coprocess * const cp, const char * const text, const size_t text_size);
+// token is left untouched when the end of the document is reached
+int32_t udpipe_coprocess_next_token(struct udpipe_coprocess * const cp, char * const token, const size_t token_size, int8_t * const end_of_document);
+
+// one child per reader thread; argv must outlive the pool
+int32_t udpipe_coprocess_pool_create(char * const * const argv, const int32_t num_children);
+void udpipe_coprocess_pool_free(void);
+struct udpipe_coprocess * udpipe_coprocess_pool_acquire(void);
+void udpipe_coprocess_pool_release(struct udpipe_coprocess * const cp);
+
+#endif
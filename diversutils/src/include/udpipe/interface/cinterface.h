@@ -48,4 +48,30 @@ extern void udpipe_pipeline_print_global_info();
 
 extern int32_t udpipe_pipeline_process(const char*, FILE** const, void** const); // in
 
+// token i of the batch is arena + spans[i].offset (zero-terminated); document d owns spans document_offsets[d] to document_offsets[d + 1] - 1
+struct udpipe_token_span {
+    size_t offset;
+    size_t length;
+};
+
+struct udpipe_tokens {
+    char* arena;
+    size_t arena_size;
+    size_t arena_capacity;
+    struct udpipe_token_span* spans;
+    size_t num_spans;
+    size_t capacity_spans;
+    size_t* document_offsets;
+    size_t num_documents;
+    size_t capacity_documents;
+};
+
+extern int32_t udpipe_pool_create_global(const char*, const int32_t);
+
+extern void udpipe_pool_free_global(void);
+
+extern int32_t udpipe_pool_process_batch(const char* const * const, const size_t, struct udpipe_tokens* const); // buffers of the udpipe_tokens are reused across calls
+
+extern void udpipe_tokens_free(struct udpipe_tokens* const);
+
 #endif
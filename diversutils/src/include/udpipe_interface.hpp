@@ -31,10 +31,13 @@
 #include <iostream>
 #include <string>
 #include <sstream> // std::istringstream
+#include <vector>
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 extern "C" void custom_format(const char* const log_type, const int32_t log_num, const char* const filename, const char* const func, const int32_t line, const char* const msg);
 extern "C" void error_format(const char* const filename, const char* const func, const int32_t line, const char* const msg);
@@ -43,6 +46,9 @@ extern "C" void info_format(const char* const filename, const char* const func,
 
 #include "udpipe.h"
 #include "udpipe/interface/size.h"
+extern "C" {
+#include "udpipe/interface/cinterface.h"
+}
 
 #include "udpipe/sources/source.h"
 #include "udpipe/sources/udpipe1/all.h"
@@ -52,6 +58,7 @@ extern "C" void info_format(const char* const filename, const char* const func,
 #endif
 
 static ufal::udpipe::pipeline* global_pipeline;
+static ufal::udpipe::model* global_model; // shared by global_pipeline and the pool; model methods are thread-safe
 
 extern "C" void ensure_proper_udpipe_pipeline_size(){
 	if(UDPIPE_PIPELINE_SIZE != sizeof(ufal::udpipe::pipeline)){
@@ -102,14 +109,13 @@ extern "C" int32_t ensure_udpipe_model_is_available(const char * const isolang,
     return 1;
 }
 
-extern "C" void udpipe_pipeline_create_global(const char* model_name, const char* input, const char* tagger, const char* parser, const char* output){
+// loads the model once; model_name is either a path or a three-letter language code
+static ufal::udpipe::model* udpipe_model_load_global(const char* model_name){
+    if(global_model != NULL){return global_model;}
+
     const size_t bfr_size = 512;
     char bfr[bfr_size];
 
-    memset(bfr, '\0', bfr_size);
-    snprintf(bfr, bfr_size, "Creating pipeline with \"%s\"", model_name);
-    info_format(__FILE__, __func__, __LINE__, bfr);
-
     if(strlen(model_name) == 3){
         if(ensure_udpipe_model_is_available(model_name, bfr, bfr_size) != 0){
             fprintf(stderr, "Failed to call ensure_udpipe_model_is_available for \"%s\"\n", model_name);
@@ -120,10 +126,26 @@ extern "C" void udpipe_pipeline_create_global(const char* model_name, const char
         snprintf(bfr, bfr_size, "%s", model_name);
     }
 
+    info_format(__FILE__, __func__, __LINE__, bfr);
+
+    global_model = ufal::udpipe::model::load(bfr);
+    if(global_model == NULL){
+        fprintf(stderr, "Failed to load UDPipe model \"%s\"\n", bfr);
+        exit(1);
+    }
+    return global_model;
+}
+
+extern "C" void udpipe_pipeline_create_global(const char* model_name, const char* input, const char* tagger, const char* parser, const char* output){
+    const size_t bfr_size = 512;
+    char bfr[bfr_size];
+
+    memset(bfr, '\0', bfr_size);
+    snprintf(bfr, bfr_size, "Creating pipeline with \"%s\"", model_name);
     info_format(__FILE__, __func__, __LINE__, bfr);
 
 	static ufal::udpipe::pipeline local_pipeline = ufal::udpipe::pipeline(
-		ufal::udpipe::model::load(bfr),
+		udpipe_model_load_global(model_name),
 		std::string(input),
 		std::string(tagger),
 		std::string(parser),
@@ -132,7 +154,7 @@ extern "C" void udpipe_pipeline_create_global(const char* model_name, const char
 	global_pipeline = std::addressof(local_pipeline);
 }
 
-extern "C" void udpipe_pipeline_process(const char* raw_txt, FILE** const pointer_file, void** const pointer_heap_char){
+extern "C" int32_t udpipe_pipeline_process(const char* raw_txt, FILE** const pointer_file, void** const pointer_heap_char){
 	std::string raw_txt_to_string(raw_txt);
 	std::istringstream iss (raw_txt_to_string);
 	std::ostringstream oss("");
@@ -158,6 +180,143 @@ extern "C" void udpipe_pipeline_process(const char* raw_txt, FILE** const pointe
 	if(pointer_file != NULL){
 	  (*pointer_file) = fmemopen((void*) (*pointer_heap_char), str_from_oss_length, "r");
 	}
+	return 0;
+}
+
+/*
+ * Pool of tokenizers, one per worker, all sharing global_model.
+ * A tokenizer keeps state between sentences, so it cannot be shared between threads; the model can.
+ * Forms are read directly from the tokenized sentences, without formatting them as text and parsing them back.
+ */
+
+struct udpipe_pool_slot {
+    ufal::udpipe::input_format* tokenizer;
+    ufal::udpipe::sentence sentence;
+    std::string error;
+    int8_t busy;
+};
+
+static std::vector<udpipe_pool_slot*> global_pool_slots;
+static pthread_mutex_t global_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t global_pool_cond = PTHREAD_COND_INITIALIZER;
+
+extern "C" int32_t udpipe_pool_create_global(const char* model_name, const int32_t num_workers){
+    const size_t bfr_size = 512;
+    char bfr[bfr_size];
+
+    memset(bfr, '\0', bfr_size);
+    snprintf(bfr, bfr_size, "Creating pool of %i UDPipe tokenizers with \"%s\"", num_workers, model_name);
+    info_format(__FILE__, __func__, __LINE__, bfr);
+
+    ufal::udpipe::model* m = udpipe_model_load_global(model_name);
+
+    for(int32_t i = 0 ; i < num_workers ; i++){
+        udpipe_pool_slot* slot = new udpipe_pool_slot();
+        slot->tokenizer = m->new_tokenizer(ufal::udpipe::model::DEFAULT);
+        if(slot->tokenizer == NULL){
+            fprintf(stderr, "Failed to create UDPipe tokenizer (does the model contain one?)\n");
+            delete slot;
+            return 1;
+        }
+        slot->busy = 0;
+        global_pool_slots.push_back(slot);
+    }
+    return 0;
+}
+
+extern "C" void udpipe_pool_free_global(void){
+    for(size_t i = 0 ; i < global_pool_slots.size() ; i++){
+        delete global_pool_slots[i]->tokenizer;
+        delete global_pool_slots[i];
+    }
+    global_pool_slots.clear();
+}
+
+static udpipe_pool_slot* udpipe_pool_acquire(void){
+    pthread_mutex_lock(&global_pool_mutex);
+    while(1){
+        for(size_t i = 0 ; i < global_pool_slots.size() ; i++){
+            if(!global_pool_slots[i]->busy){
+                global_pool_slots[i]->busy = 1;
+                pthread_mutex_unlock(&global_pool_mutex);
+                return global_pool_slots[i];
+            }
+        }
+        pthread_cond_wait(&global_pool_cond, &global_pool_mutex);
+    }
+}
+
+static void udpipe_pool_release(udpipe_pool_slot* slot){
+    pthread_mutex_lock(&global_pool_mutex);
+    slot->busy = 0;
+    pthread_cond_signal(&global_pool_cond);
+    pthread_mutex_unlock(&global_pool_mutex);
+}
+
+static int32_t udpipe_tokens_reserve(void** const bfr, size_t* const capacity, const size_t required, const size_t element_size){
+    if(required <= (*capacity)){return 0;}
+    size_t new_capacity = (*capacity) == 0 ? 64 : (*capacity);
+    while(new_capacity < required){new_capacity <<= 1;}
+    void* realloc_ptr = realloc(*bfr, new_capacity * element_size);
+    if(realloc_ptr == NULL){
+        perror("realloc failed\n");
+        return 1;
+    }
+    (*bfr) = realloc_ptr;
+    (*capacity) = new_capacity;
+    return 0;
+}
+
+extern "C" int32_t udpipe_pool_process_batch(const char* const * const texts, const size_t num_texts, struct udpipe_tokens* const tokens){
+    tokens->arena_size = 0;
+    tokens->num_spans = 0;
+    tokens->num_documents = 0;
+    if(udpipe_tokens_reserve((void**) &(tokens->document_offsets), &(tokens->capacity_documents), num_texts + 1, sizeof(size_t)) != 0){return 1;}
+    tokens->document_offsets[0] = 0;
+
+    udpipe_pool_slot* slot = udpipe_pool_acquire();
+    int32_t result = 0;
+
+    for(size_t i = 0 ; i < num_texts ; i++){
+        slot->tokenizer->reset_document();
+        slot->tokenizer->set_text(ufal::udpipe::string_piece(texts[i], strlen(texts[i])), false);
+        while(slot->tokenizer->next_sentence(slot->sentence, slot->error)){
+            // words[0] is the technical root
+            for(size_t j = 1 ; j < slot->sentence.words.size() ; j++){
+                const std::string& form = slot->sentence.words[j].form;
+                if(udpipe_tokens_reserve((void**) &(tokens->arena), &(tokens->arena_capacity), tokens->arena_size + form.size() + 1, sizeof(char)) != 0
+                || udpipe_tokens_reserve((void**) &(tokens->spans), &(tokens->capacity_spans), tokens->num_spans + 1, sizeof(struct udpipe_token_span)) != 0){
+                    result = 1;
+                    goto release;
+                }
+                memcpy(tokens->arena + tokens->arena_size, form.c_str(), form.size());
+                tokens->arena[tokens->arena_size + form.size()] = '\0';
+                tokens->spans[tokens->num_spans].offset = tokens->arena_size;
+                tokens->spans[tokens->num_spans].length = form.size();
+                tokens->arena_size += form.size() + 1;
+                tokens->num_spans++;
+            }
+        }
+        if(!slot->error.empty()){
+            std::cerr << "error: " << slot->error << std::endl;
+            slot->error.clear();
+            result = 1;
+            goto release;
+        }
+        tokens->num_documents++;
+        tokens->document_offsets[tokens->num_documents] = tokens->num_spans;
+    }
+
+    release:
+    udpipe_pool_release(slot);
+    return result;
+}
+
+extern "C" void udpipe_tokens_free(struct udpipe_tokens* const tokens){
+    free(tokens->arena);
+    free(tokens->spans);
+    free(tokens->document_offsets);
+    memset(tokens, '\0', sizeof(struct udpipe_tokens));
 }
 
 #endif
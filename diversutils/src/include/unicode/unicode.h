@@ -6,6 +6,16 @@
 
 typedef int32_t unicode_t;
 
+enum {
+    UNICODE_LETTER      = 0,
+    UNICODE_NUMBER      = 1,
+    UNICODE_PUNCTUATION = 2,
+    UNICODE_CURRENCY    = 3,
+    UNICODE_EMOTICON    = 4,
+    UNICODE_PHONETIC    = 5,
+    UNICODE_OTHER       = 6,
+};
+
 #ifdef DEFINE_UNICODE_CONSTANTS
 const unicode_t UNICODE_BASIC_LATIN_BEG = 0x00;
 const unicode_t UNICODE_BASIC_LATIN_END = 0x7F;
@@ -45,16 +55,6 @@ const unicode_t UNICODE_CURRENCY_END = 0x20B9;
 // UNICODE_EMOTICON
 const unicode_t UNICODE_EMOTICON_BEG = 0x01F601;
 const unicode_t UNICODE_EMOTICON_END = 0x01F64F;
-
-enum {
-    UNICODE_LETTER      = 0,
-    UNICODE_NUMBER      = 1,
-    UNICODE_PUNCTUATION = 2,
-    UNICODE_CURRENCY    = 3,
-    UNICODE_EMOTICON    = 4,
-    UNICODE_PHONETIC    = 5,
-    UNICODE_OTHER       = 6,
-};
 #endif
 
 #endif
@@ -11,6 +11,10 @@ int32_t utf8_is_well_formed(const char * const s, int8_t * const len_p);
 
 unicode_t utf8_to_unicode(const char * const s, int8_t * const len_p);
 
+int32_t unicode_to_subset_ranges(const unicode_t code);
+
+int32_t unicode_to_subset(const unicode_t code);
+
 int32_t utf8_to_unicode_subset(const char * const s, int8_t * const len_p);
 
 char * utf8_normalise(char * const s);
@@ -0,0 +1,37 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "output.h"
+
+int32_t main(int32_t argc, char** argv){
+	FILE* f_in;
+	FILE* f_out;
+	int32_t result;
+
+	if(argc < 3){
+		perror("error: argc < 3\n");
+		fprintf(stderr, "usage: %s <columnar input> <tsv output>\n", argv[0]);
+		return 1;
+	}
+
+	f_in = fopen(argv[1], "rb");
+	if(f_in == NULL){
+		fprintf(stderr, "failed to open %s for read\n", argv[1]);
+		return 1;
+	}
+	f_out = fopen(argv[2], "w");
+	if(f_out == NULL){
+		fprintf(stderr, "failed to open %s for write\n", argv[2]);
+		fclose(f_in);
+		return 1;
+	}
+
+	result = output_columnar_to_tsv(f_in, f_out);
+	if(result != 0){perror("failed to call output_columnar_to_tsv\n");}
+
+	fclose(f_in);
+	if(fclose(f_out) != 0){result = 1;}
+
+	return result;
+}
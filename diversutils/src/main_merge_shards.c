@@ -0,0 +1,79 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shard.h"
+
+int32_t main(int32_t argc, char** argv){
+	int32_t num_threads = 1;
+	int32_t first = 1;
+	int32_t result = 0;
+
+	if(argc > 1 && strncmp(argv[1], "--num_threads=", 14) == 0){
+		num_threads = (int32_t) strtol(argv[1] + 14, NULL, 10);
+		first = 2;
+	}
+	if(argc - first < 2 || num_threads < 1){
+		perror("error: not enough arguments\n");
+		fprintf(stderr, "usage: %s [--num_threads=N] <output shard> <input shard> [<input shard> ...]\n", argv[0]);
+		return 1;
+	}
+
+	const int32_t num_inputs = argc - first - 1;
+	struct shard * const inputs = calloc(num_inputs, sizeof(struct shard));
+	if(inputs == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	int32_t num_read = 0;
+	for( ; num_read < num_inputs ; num_read++){
+		if(shard_read(&(inputs[num_read]), argv[first + 1 + num_read]) != 0){
+			result = 1;
+			break;
+		}
+	}
+
+	if(result == 0){
+		struct shard merged;
+		if(shard_merge(&merged, inputs, num_inputs, num_threads) != 0){
+			perror("failed to call shard_merge\n");
+			result = 1;
+		} else {
+			if(shard_write(&merged, argv[first]) != 0){result = 1;}
+			printf("%s: %lu types, %lu tokens, %lu OOV types%s, %lu documents, %lu sentences, %lu files\n", argv[first], merged.num_entries, merged.num_tokens, (uint64_t) merged.num_oov_types, merged.oov_exact ? "" : " (lower bound)", merged.num_documents, merged.num_sentences, merged.num_files);
+			free_shard(&merged);
+		}
+	}
+
+	for(int32_t k = 0 ; k < num_read ; k++){free_shard(&(inputs[k]));}
+	free(inputs);
+	return result;
+}
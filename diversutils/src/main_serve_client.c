@@ -0,0 +1,157 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "serve.h"
+
+struct serve_client_request {
+	char text[SERVE_LINE_SIZE];
+	size_t len;
+	uint8_t overflow;
+};
+
+static void serve_client_append(struct serve_client_request * const r, const char * const s, const size_t n){
+	if(r->len + n + 1 >= SERVE_LINE_SIZE){
+		r->overflow = 1;
+		return;
+	}
+	memcpy(r->text + r->len, s, n);
+	r->len += n;
+	r->text[r->len] = '\0';
+}
+
+static void serve_client_append_string(struct serve_client_request * const r, const char * const s, const size_t n){
+	char escaped[8];
+	serve_client_append(r, "\"", 1);
+	for(size_t k = 0 ; k < n ; k++){
+		if(s[k] == '"' || s[k] == '\\'){
+			escaped[0] = '\\';
+			escaped[1] = s[k];
+			serve_client_append(r, escaped, 2);
+		} else if((unsigned char) s[k] < 0x20){
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int) (unsigned char) s[k]);
+			serve_client_append(r, escaped, 6);
+		} else {
+			serve_client_append(r, &(s[k]), 1);
+		}
+	}
+	serve_client_append(r, "\"", 1);
+}
+
+static void serve_client_append_field(struct serve_client_request * const r, const char * const key, const char * const value){
+	if(value == NULL){return;}
+	serve_client_append(r, r->len > 1 ? ", " : "", r->len > 1 ? 2 : 0);
+	serve_client_append_string(r, key, strlen(key));
+	serve_client_append(r, ": ", 2);
+	serve_client_append_string(r, value, strlen(value));
+}
+
+// the functions are given separated by commas
+static void serve_client_append_functions(struct serve_client_request * const r, const char * const functions){
+	if(functions == NULL){return;}
+	serve_client_append(r, r->len > 1 ? ", " : "", r->len > 1 ? 2 : 0);
+	serve_client_append(r, "\"functions\": [", 14);
+	const char * start = functions;
+	while(*start != '\0'){
+		const char * end = strchr(start, ',');
+		const size_t n = end != NULL ? (size_t) (end - start) : strlen(start);
+		if(n > 0){
+			if(r->text[r->len - 1] != '['){serve_client_append(r, ", ", 2);}
+			serve_client_append_string(r, start, n);
+		}
+		if(end == NULL){break;}
+		start = end + 1;
+	}
+	serve_client_append(r, "]", 1);
+}
+
+int32_t main(int32_t argc, char** argv){
+	const char * socket_path = NULL;
+	const char * request = NULL;
+	const char * id = NULL;
+	const char * input_path = NULL;
+	const char * input_path_tp = NULL;
+	const char * output_path = NULL;
+	const char * output_path_timing = NULL;
+	const char * output_path_memory = NULL;
+	const char * functions = NULL;
+	uint8_t shutdown = 0;
+
+	for(int32_t i = 1 ; i < argc ; i++){
+		if(strncmp(argv[i], "--socket=", 9) == 0){socket_path = argv[i] + 9;}
+		else if(strncmp(argv[i], "--request=", 10) == 0){request = argv[i] + 10;}
+		else if(strncmp(argv[i], "--id=", 5) == 0){id = argv[i] + 5;}
+		else if(strncmp(argv[i], "--input_path=", 13) == 0){input_path = argv[i] + 13;}
+		else if(strncmp(argv[i], "--input_path_tp=", 16) == 0){input_path_tp = argv[i] + 16;}
+		else if(strncmp(argv[i], "--output_path=", 14) == 0){output_path = argv[i] + 14;}
+		else if(strncmp(argv[i], "--output_path_timing=", 21) == 0){output_path_timing = argv[i] + 21;}
+		else if(strncmp(argv[i], "--output_path_memory=", 21) == 0){output_path_memory = argv[i] + 21;}
+		else if(strncmp(argv[i], "--functions=", 12) == 0){functions = argv[i] + 12;}
+		else if(strncmp(argv[i], "--shutdown=", 11) == 0){shutdown = (argv[i][11] == '1');}
+		else {fprintf(stderr, "Unknown argument: %s\n", argv[i]); return 1;}
+	}
+	if(socket_path == NULL || (request == NULL && !shutdown && (input_path == NULL || output_path == NULL))){
+		perror("error: not enough arguments\n");
+		fprintf(stderr, "usage: %s --socket=<path> (--input_path=<list> --output_path=<path> [--functions=<name>,...] [--id=<id>] [--input_path_tp=<list>] [--output_path_timing=<path>] [--output_path_memory=<path>] | --shutdown=1 | --request=<json>)\n", argv[0]);
+		return 1;
+	}
+
+	// a request given as it is is sent as it is
+	if(request != NULL){return serve_request(socket_path, request, stdout);}
+
+	struct serve_client_request * const r = calloc(1, sizeof(struct serve_client_request));
+	if(r == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	serve_client_append(r, "{", 1);
+	if(shutdown){
+		serve_client_append(r, "\"shutdown\": true", 16);
+	} else {
+		serve_client_append_field(r, "id", id);
+		serve_client_append_field(r, "input_path", input_path);
+		serve_client_append_field(r, "input_path_tp", input_path_tp);
+		serve_client_append_field(r, "output_path", output_path);
+		serve_client_append_field(r, "output_path_timing", output_path_timing);
+		serve_client_append_field(r, "output_path_memory", output_path_memory);
+		serve_client_append_functions(r, functions);
+	}
+	serve_client_append(r, "}", 1);
+
+	int32_t result = 1;
+	if(r->overflow){
+		fprintf(stderr, "request longer than %i bytes\n", SERVE_LINE_SIZE - 1);
+	} else {
+		result = serve_request(socket_path, r->text, stdout);
+	}
+	free(r);
+	return result;
+}
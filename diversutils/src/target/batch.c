@@ -0,0 +1,279 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "file_queue.h"
+#include "logging.h"
+
+static char* batch_strndup(const char* const s, const size_t n){
+	char* const copy = (char*) malloc(n + 1);
+	if(copy == NULL){return NULL;}
+	memcpy(copy, s, n);
+	copy[n] = '\0';
+	return copy;
+}
+
+// splits the line at tabs into at most num_fields fields, each copied
+static int32_t batch_split_line(const char* const line, char** const fields, const int32_t num_fields){
+	const char* start = line;
+	int32_t k = 0;
+	while(k < num_fields){
+		const char* end = strchr(start, '\t');
+		const size_t n = end != NULL ? (size_t) (end - start) : strlen(start);
+		fields[k] = batch_strndup(start, n);
+		if(fields[k] == NULL){return -1;}
+		k++;
+		if(end == NULL){break;}
+		start = end + 1;
+	}
+	return k;
+}
+
+// blank lines and lines starting with '#' are skipped
+int32_t read_batch_manifest(struct batch_manifest* const m, const char* const path){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+	char line[BATCH_MANIFEST_LINE_SIZE];
+	int32_t capacity = 0;
+	int32_t line_number = 0;
+
+	memset(m, '\0', sizeof(struct batch_manifest));
+
+	FILE* const f = fopen(path, "r");
+	if(f == NULL){
+		fprintf(stderr, "cannot open %s\n", path);
+		return 1;
+	}
+
+	while(fgets(line, BATCH_MANIFEST_LINE_SIZE, f) != NULL){
+		line_number++;
+		size_t len = strlen(line);
+		while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')){line[--len] = '\0';}
+		if(len == 0 || line[0] == '#'){continue;}
+
+		if(m->num_corpora >= capacity){
+			capacity = capacity == 0 ? 8 : capacity * 2;
+			void* const malloc_pointer = realloc(m->corpora, capacity * sizeof(struct batch_corpus));
+			if(malloc_pointer == NULL){goto malloc_fail;}
+			m->corpora = (struct batch_corpus*) malloc_pointer;
+		}
+
+		char* fields[4] = {NULL, NULL, NULL, NULL};
+		const int32_t num_fields = batch_split_line(line, fields, 4);
+		struct batch_corpus* const c = &(m->corpora[m->num_corpora]);
+		c->name = fields[0];
+		c->input_path = fields[1];
+		c->output_prefix = fields[2];
+		c->input_path_tp = fields[3];
+		m->num_corpora++;
+		if(num_fields < 0){goto malloc_fail;}
+		if(num_fields < 3 || c->name[0] == '\0' || c->input_path[0] == '\0'){
+			snprintf(log_bfr, log_bfr_size, "%s:%i: expected name, input list and output prefix separated by tabs", path, line_number);
+			error_format(__FILE__, __func__, __LINE__, log_bfr);
+			goto failure;
+		}
+		for(int32_t k = 0 ; k < m->num_corpora - 1 ; k++){
+			if(strcmp(m->corpora[k].name, c->name) == 0 || strcmp(m->corpora[k].output_prefix, c->output_prefix) == 0){
+				snprintf(log_bfr, log_bfr_size, "%s:%i: corpus %s shares its name or its output prefix with corpus %s", path, line_number, c->name, m->corpora[k].name);
+				error_format(__FILE__, __func__, __LINE__, log_bfr);
+				goto failure;
+			}
+		}
+	}
+	fclose(f);
+
+	if(m->num_corpora == 0){
+		snprintf(log_bfr, log_bfr_size, "%s: no corpus", path);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		free_batch_manifest(m);
+		return 1;
+	}
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	failure:
+	fclose(f);
+	free_batch_manifest(m);
+	return 1;
+}
+
+void free_batch_manifest(struct batch_manifest* const m){
+	for(int32_t k = 0 ; k < m->num_corpora ; k++){
+		free(m->corpora[k].name);
+		free(m->corpora[k].input_path);
+		free(m->corpora[k].output_prefix);
+		free(m->corpora[k].input_path_tp);
+	}
+	free(m->corpora);
+	memset(m, '\0', sizeof(struct batch_manifest));
+}
+
+/*
+ * Called once by the thread of corpus k, with its files and structures, or with NULL if it cannot be measured.
+ * The last corpus to arrive reads the files of all corpora with the reader threads of the batch; every corpus thread
+ * returns once they are read, with the number of files of its corpus read to the end.
+ * A corpus that withdrew has no files in the queue and fails alone: the others are still read.
+ */
+int32_t batch_read(struct batch* const b, const int32_t k, const struct file_queue_corpus* const corpus, int32_t* const num_done){
+	int32_t result;
+
+	pthread_mutex_lock(&(b->mutex));
+	if(b->registered[k]){
+		pthread_mutex_unlock(&(b->mutex));
+		perror("corpus already registered\n");
+		return 1;
+	}
+	if(corpus != NULL){
+		b->corpora[k] = *corpus;
+	} else {
+		memset(&(b->corpora[k]), '\0', sizeof(struct file_queue_corpus));
+	}
+	b->registered[k] = 1;
+	b->num_registered++;
+
+	if(b->num_registered == b->num_corpora){
+		pthread_mutex_unlock(&(b->mutex));
+
+		struct file_queue q;
+		int32_t status = 0;
+		if(create_file_queue_corpora(&q, b->corpora, b->num_corpora, b->largest_first) != 0){
+			perror("failed to call create_file_queue_corpora\n");
+			status = 1;
+		} else {
+			if(file_queue_read(&q, NULL, NULL, NULL, b->num_threads) != 0){
+				perror("failed to call file_queue_read\n");
+				status = 1;
+			}
+			free_file_queue(&q);
+		}
+
+		pthread_mutex_lock(&(b->mutex));
+		if(status != 0){b->status = 1;}
+		b->read = 1;
+		pthread_cond_broadcast(&(b->cond));
+	} else {
+		while(!b->read){pthread_cond_wait(&(b->cond), &(b->mutex));}
+	}
+	if(num_done != NULL){*num_done = b->corpora[k].num_done;}
+	result = corpus != NULL ? b->status : 1;
+	pthread_mutex_unlock(&(b->mutex));
+
+	return result;
+}
+
+struct batch_thread_args {
+	struct batch* b;
+	batch_corpus_function f;
+	void* arg;
+	int32_t k;
+	int32_t result;
+};
+
+static void* batch_thread(void* args){
+	struct batch_thread_args* const a = (struct batch_thread_args*) args;
+
+	a->result = a->f(a->b, a->k, a->arg);
+
+	// a corpus that gave up before batch_read must not keep the others waiting
+	pthread_mutex_lock(&(a->b->mutex));
+	const uint8_t registered = a->b->registered[a->k];
+	pthread_mutex_unlock(&(a->b->mutex));
+	if(!registered){
+		batch_read(a->b, a->k, NULL, NULL);
+		a->result = 1;
+	}
+	return NULL;
+}
+
+// runs f(b, k, args[k]) for every corpus k, each in its own thread; f calls batch_read once its corpus is ready to be read
+int32_t batch_run(const int32_t num_corpora, const int32_t num_threads, const uint8_t largest_first, batch_corpus_function f, void* const * const args){
+	struct batch b = {
+		.num_corpora = num_corpora,
+		.num_threads = num_threads,
+		.largest_first = largest_first,
+	};
+	int32_t num_created = 0;
+	int32_t result = 0;
+
+	b.corpora = (struct file_queue_corpus*) calloc(num_corpora, sizeof(struct file_queue_corpus));
+	b.registered = (uint8_t*) calloc(num_corpora, sizeof(uint8_t));
+	struct batch_thread_args* const thread_args = (struct batch_thread_args*) calloc(num_corpora, sizeof(struct batch_thread_args));
+	pthread_t* const threads = (pthread_t*) calloc(num_corpora, sizeof(pthread_t));
+	if(b.corpora == NULL || b.registered == NULL || thread_args == NULL || threads == NULL){
+		perror("malloc failed\n");
+		result = 1;
+		goto free_memory;
+	}
+	if(pthread_mutex_init(&(b.mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		result = 1;
+		goto free_memory;
+	}
+	if(pthread_cond_init(&(b.cond), NULL) != 0){
+		perror("failed to call pthread_cond_init\n");
+		pthread_mutex_destroy(&(b.mutex));
+		result = 1;
+		goto free_memory;
+	}
+
+	for(int32_t k = 0 ; k < num_corpora ; k++){
+		thread_args[k] = (struct batch_thread_args) { .b = &b, .f = f, .arg = args[k], .k = k, };
+		if(pthread_create(&(threads[k]), NULL, batch_thread, &(thread_args[k])) != 0){
+			perror("failed to call pthread_create\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	// corpora without a thread withdraw, so that those that have one are read
+	for(int32_t k = num_created ; k < num_corpora ; k++){batch_read(&b, k, NULL, NULL);}
+	for(int32_t k = 0 ; k < num_created ; k++){
+		if(pthread_join(threads[k], NULL) != 0){
+			perror("failed to call pthread_join\n");
+			result = 1;
+		}
+		if(thread_args[k].result != 0){result = 1;}
+	}
+	if(b.status != 0){result = 1;}
+
+	pthread_cond_destroy(&(b.cond));
+	pthread_mutex_destroy(&(b.mutex));
+
+	free_memory:
+	free(b.corpora);
+	free(b.registered);
+	free(thread_args);
+	free(threads);
+	return result;
+}
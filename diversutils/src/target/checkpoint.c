@@ -0,0 +1,531 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for open_memstream, fmemopen, fsync and clock_gettime
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "graph.h"
+#include "measurement.h"
+#include "output.h"
+#include "recompute.h"
+#include "schedule.h"
+#include "logging.h"
+#include "oov/counter.h"
+
+static uint64_t checkpoint_checksum(const char* const bfr, const size_t size){
+	uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+	for(size_t k = 0 ; k < size ; k++){
+		h ^= (uint64_t) ((uint8_t) bfr[k]);
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static int32_t checkpoint_write(FILE* const f, const void* const p, const size_t size){
+	return fwrite(p, 1, size, f) != size;
+}
+
+static int32_t checkpoint_read(FILE* const f, void* const p, const size_t size){
+	return fread(p, 1, size, f) != size;
+}
+
+// paths are not copied, and must outlive the checkpoint
+int32_t create_checkpoint(struct checkpoint* const cp, const char* const path, const double interval_seconds, char* const * const paths, const int32_t num_files){
+	memset(cp, '\0', sizeof(struct checkpoint));
+	cp->interval_ns = (int64_t) (interval_seconds * 1e9);
+	if(cp->interval_ns < 1){cp->interval_ns = 1;}
+	cp->paths = paths;
+	cp->num_files = num_files;
+	for(int32_t k = 0 ; k < CHECKPOINT_NUM_OUTPUTS ; k++){cp->output_sizes[k] = -1;}
+
+	const size_t path_size = strlen(path) + 1;
+	cp->path = (char*) malloc(path_size);
+	cp->tmp_path = (char*) malloc(path_size + 4);
+	cp->files = (struct checkpoint_file*) calloc(num_files > 0 ? num_files : 1, sizeof(struct checkpoint_file));
+	if(cp->path == NULL || cp->tmp_path == NULL || cp->files == NULL){
+		perror("malloc failed\n");
+		goto failure;
+	}
+	memcpy(cp->path, path, path_size);
+	snprintf(cp->tmp_path, path_size + 4, "%s.tmp", path);
+
+	if(pthread_mutex_init(&(cp->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		goto failure;
+	}
+	if(pthread_cond_init(&(cp->cond_parked), NULL) != 0 || pthread_cond_init(&(cp->cond_resume), NULL) != 0){
+		perror("failed to call pthread_cond_init\n");
+		pthread_mutex_destroy(&(cp->mutex));
+		goto failure;
+	}
+	return 0;
+
+	failure:
+	free(cp->path);
+	free(cp->tmp_path);
+	free(cp->files);
+	memset(cp, '\0', sizeof(struct checkpoint));
+	return 1;
+}
+
+// ---- capture ----
+
+// the file progress and the output sizes come first, so that checkpoint_open can reopen the outputs before anything else is restored
+static int32_t checkpoint_serialize_progress(const struct checkpoint* const cp, FILE* const f){
+	const uint32_t num_files = (uint32_t) cp->num_files;
+	if(checkpoint_write(f, &num_files, sizeof(uint32_t)) != 0){return 1;}
+	for(int32_t k = 0 ; k < cp->num_files ; k++){
+		const uint32_t length = (uint32_t) strlen(cp->paths[k]);
+		if(checkpoint_write(f, &length, sizeof(uint32_t)) != 0 || checkpoint_write(f, cp->paths[k], length) != 0){return 1;}
+		if(checkpoint_write(f, &(cp->files[k].offset), sizeof(int64_t)) != 0 || checkpoint_write(f, &(cp->files[k].offset_tp), sizeof(int64_t)) != 0){return 1;}
+		if(checkpoint_write(f, &(cp->files[k].state), sizeof(uint8_t)) != 0 || checkpoint_write(f, &(cp->files[k].found_at_least_one_mwe), sizeof(int8_t)) != 0){return 1;}
+	}
+	return checkpoint_write(f, cp->output_sizes, CHECKPOINT_NUM_OUTPUTS * sizeof(int64_t));
+}
+
+static int32_t checkpoint_serialize_state(const struct checkpoint* const cp, FILE* const f){
+	const struct measurement_structure_references* const sref = cp->sref;
+	const struct measurement_mutables* const mmut = cp->mmut;
+
+	const uint64_t num_vectors = sref->w2v->num_vectors;
+	if(checkpoint_write(f, &num_vectors, sizeof(uint64_t)) != 0){return 1;}
+
+	// with a recompute thread, the zipfian fit of the last step lives in its own mutables
+	const struct measurement_mutables* const fit = sref->recompute != NULL ? &(sref->recompute->mmut) : mmut;
+	if(checkpoint_write(f, &(fit->best_s), sizeof(double)) != 0 || checkpoint_write(f, &(fit->prev_best_s), sizeof(double)) != 0 || checkpoint_write(f, &(fit->prev_num_nodes), sizeof(int64_t)) != 0){return 1;}
+	if(checkpoint_write(f, &(mmut->num_oov_types), sizeof(int64_t)) != 0){return 1;}
+	if(checkpoint_write(f, &(mmut->sentence), sizeof(struct measurement_mutable_counters)) != 0 || checkpoint_write(f, &(mmut->document), sizeof(struct measurement_mutable_counters)) != 0){return 1;}
+
+	const uint8_t has_schedule = sref->schedule != NULL;
+	if(checkpoint_write(f, &has_schedule, sizeof(uint8_t)) != 0){return 1;}
+	if(has_schedule){
+		struct recompute_schedule* const s = sref->schedule;
+		pthread_mutex_lock(&(s->mutex));
+		const int32_t failed = checkpoint_write(f, s->costs, sizeof(s->costs)) != 0 || checkpoint_write(f, &(s->sentence), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_write(f, &(s->document), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_write(f, &(s->compute_ns), sizeof(int64_t)) != 0;
+		pthread_mutex_unlock(&(s->mutex));
+		if(failed){return 1;}
+	}
+
+	// nodes in the order they were appended, each as the index of its vector and its count
+	const uint64_t num_nodes = graph_num_nodes(sref->g);
+	if(checkpoint_write(f, &num_nodes, sizeof(uint64_t)) != 0){return 1;}
+	for(uint64_t k = 0 ; k < num_nodes ; k++){
+		const struct graph_node* const node = graph_node_at(sref->g, k);
+		const uint64_t index = (uint64_t) (node->word2vec_entry_pointer - sref->w2v->keys);
+		const uint64_t count = __atomic_load_n(&(node->absolute_proportion), __ATOMIC_RELAXED);
+		if(checkpoint_write(f, &index, sizeof(uint64_t)) != 0 || checkpoint_write(f, &count, sizeof(uint64_t)) != 0){return 1;}
+	}
+
+	if(oov_counter_save(sref->oov_discarded_because_not_in_vector_database, f) != 0){
+		perror("failed to call oov_counter_save\n");
+		return 1;
+	}
+	return 0;
+}
+
+// called with cp->mutex locked and every reader parked at a unit boundary
+static int32_t checkpoint_capture(struct checkpoint* const cp, char** const bfr, size_t* const size){
+	const struct measurement_structure_references* const sref = cp->sref;
+	struct output_stream* const outputs[CHECKPOINT_NUM_OUTPUTS] = {cp->mcfg->io.output, cp->mcfg->io.output_timing, cp->mcfg->io.output_memory};
+
+	// the steps reached so far must be in the outputs, and nothing more
+	if(sref->recompute != NULL && recompute_worker_drain(sref->recompute) != 0){
+		perror("failed to call recompute_worker_drain\n");
+		return 1;
+	}
+	for(int32_t k = 0 ; k < CHECKPOINT_NUM_OUTPUTS ; k++){
+		cp->output_sizes[k] = -1;
+		if(outputs[k] != NULL && output_stream_sync(outputs[k], &(cp->output_sizes[k])) != 0){
+			perror("failed to call output_stream_sync\n");
+			return 1;
+		}
+	}
+
+	FILE* const f = open_memstream(bfr, size);
+	if(f == NULL){
+		perror("failed to call open_memstream\n");
+		return 1;
+	}
+	pthread_mutex_lock(&(cp->mmut->mutex));
+	pthread_mutex_lock(&(sref->g->mutex_nodes));
+	const int32_t failed = checkpoint_serialize_progress(cp, f) != 0 || checkpoint_serialize_state(cp, f) != 0;
+	pthread_mutex_unlock(&(sref->g->mutex_nodes));
+	pthread_mutex_unlock(&(cp->mmut->mutex));
+	if(fclose(f) != 0 || failed){
+		perror("failed to serialize checkpoint\n");
+		free(*bfr);
+		*bfr = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+// written next to the previous checkpoint and renamed over it, so that a kill at any time leaves a complete one behind
+static int32_t checkpoint_write_file(const struct checkpoint* const cp, const char* const payload, const size_t payload_size){
+	const uint32_t version = CHECKPOINT_VERSION;
+	const uint32_t byte_order_mark = CHECKPOINT_BYTE_ORDER_MARK;
+	const uint64_t size = (uint64_t) payload_size;
+	const uint64_t checksum = checkpoint_checksum(payload, payload_size);
+
+	FILE* const f = fopen(cp->tmp_path, "wb");
+	if(f == NULL){
+		fprintf(stderr, "Failed to open file: %s\n", cp->tmp_path);
+		return 1;
+	}
+	int32_t failed = checkpoint_write(f, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0 || checkpoint_write(f, &version, sizeof(uint32_t)) != 0 || checkpoint_write(f, &byte_order_mark, sizeof(uint32_t)) != 0 || checkpoint_write(f, &size, sizeof(uint64_t)) != 0;
+	failed = failed || checkpoint_write(f, payload, payload_size) != 0 || checkpoint_write(f, &checksum, sizeof(uint64_t)) != 0;
+	failed = failed || fflush(f) != 0 || fsync(fileno(f)) != 0;
+	if(fclose(f) != 0 || failed){
+		fprintf(stderr, "Failed to write file: %s\n", cp->tmp_path);
+		remove(cp->tmp_path);
+		return 1;
+	}
+	if(rename(cp->tmp_path, cp->path) != 0){
+		fprintf(stderr, "Failed to rename %s to %s\n", cp->tmp_path, cp->path);
+		remove(cp->tmp_path);
+		return 1;
+	}
+	return 0;
+}
+
+static void* checkpoint_thread(void* args){
+	struct checkpoint* const cp = (struct checkpoint*) args;
+	const int32_t log_bfr_size = 256;
+	char log_bfr[256];
+
+	pthread_mutex_lock(&(cp->mutex));
+	while(!(cp->stop)){
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		const int64_t deadline_ns = (int64_t) deadline.tv_nsec + cp->interval_ns;
+		deadline.tv_sec += (time_t) (deadline_ns / 1000000000);
+		deadline.tv_nsec = (long) (deadline_ns % 1000000000);
+		while(!(cp->stop) && pthread_cond_timedwait(&(cp->cond_parked), &(cp->mutex), &deadline) != ETIMEDOUT){}
+		if(cp->stop){break;}
+
+		cp->requested = 1;
+		while(!(cp->stop) && cp->num_parked < cp->num_active){
+			pthread_cond_wait(&(cp->cond_parked), &(cp->mutex));
+		}
+		char* bfr = NULL;
+		size_t size = 0;
+		const int32_t captured = !(cp->stop) && checkpoint_capture(cp, &bfr, &size) == 0;
+		const uint8_t stopped = cp->stop;
+		cp->requested = 0;
+		cp->generation++;
+		pthread_cond_broadcast(&(cp->cond_resume));
+		pthread_mutex_unlock(&(cp->mutex));
+
+		if(captured && checkpoint_write_file(cp, bfr, size) == 0){
+			__atomic_add_fetch(&(cp->num_written), 1, __ATOMIC_RELEASE);
+			snprintf(log_bfr, log_bfr_size, "checkpoint written: %s (%zu bytes)", cp->path, size);
+			info_format(__FILE__, __func__, __LINE__, log_bfr);
+		} else if(!stopped){
+			// the measurement goes on; the previous checkpoint, if any, is still there
+			warning_format(__FILE__, __func__, __LINE__, "failed to write checkpoint");
+			cp->status = 1;
+		}
+		free(bfr);
+		pthread_mutex_lock(&(cp->mutex));
+	}
+	pthread_mutex_unlock(&(cp->mutex));
+	return NULL;
+}
+
+// ---- resume ----
+
+// found is set to 0 when there is no checkpoint to resume from; a checkpoint that cannot be trusted, or that belongs to another input list, is an error
+int32_t checkpoint_open(struct checkpoint* const cp, uint8_t* const found){
+	char magic[CHECKPOINT_MAGIC_SIZE];
+	uint32_t version = 0;
+	uint32_t byte_order_mark = 0;
+	uint64_t size = 0;
+	uint64_t checksum = 0;
+	FILE* m = NULL;
+
+	*found = 0;
+	FILE* const f = fopen(cp->path, "rb");
+	if(f == NULL){
+		if(errno == ENOENT){return 0;}
+		fprintf(stderr, "Failed to open file: %s\n", cp->path);
+		return 1;
+	}
+	if(checkpoint_read(f, magic, CHECKPOINT_MAGIC_SIZE) != 0 || memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0){
+		fprintf(stderr, "Not a checkpoint: %s\n", cp->path);
+		goto failure_file;
+	}
+	if(checkpoint_read(f, &version, sizeof(uint32_t)) != 0 || version != CHECKPOINT_VERSION){
+		fprintf(stderr, "Unsupported checkpoint version %u (expected %u): %s\n", version, CHECKPOINT_VERSION, cp->path);
+		goto failure_file;
+	}
+	if(checkpoint_read(f, &byte_order_mark, sizeof(uint32_t)) != 0 || byte_order_mark != CHECKPOINT_BYTE_ORDER_MARK){
+		fprintf(stderr, "Checkpoint written on a machine with another byte order: %s\n", cp->path);
+		goto failure_file;
+	}
+	if(checkpoint_read(f, &size, sizeof(uint64_t)) != 0 || size == 0){goto failure_truncated;}
+	cp->loaded = (char*) malloc((size_t) size);
+	if(cp->loaded == NULL){
+		perror("malloc failed\n");
+		goto failure_file;
+	}
+	cp->loaded_size = (size_t) size;
+	if(checkpoint_read(f, cp->loaded, cp->loaded_size) != 0 || checkpoint_read(f, &checksum, sizeof(uint64_t)) != 0){goto failure_truncated;}
+	if(checksum != checkpoint_checksum(cp->loaded, cp->loaded_size)){
+		fprintf(stderr, "Checkpoint checksum mismatch: %s\n", cp->path);
+		goto failure_file;
+	}
+	fclose(f);
+
+	m = fmemopen(cp->loaded, cp->loaded_size, "rb");
+	if(m == NULL){
+		perror("failed to call fmemopen\n");
+		goto failure;
+	}
+	uint32_t num_files = 0;
+	if(checkpoint_read(m, &num_files, sizeof(uint32_t)) != 0 || num_files != (uint32_t) cp->num_files){
+		fprintf(stderr, "Checkpoint was taken on %u input files, not %i: %s\n", num_files, cp->num_files, cp->path);
+		goto failure;
+	}
+	for(int32_t k = 0 ; k < cp->num_files ; k++){
+		uint32_t length = 0;
+		if(checkpoint_read(m, &length, sizeof(uint32_t)) != 0 || length != (uint32_t) strlen(cp->paths[k])){goto failure_input;}
+		char* const path = (char*) malloc(length + 1);
+		if(path == NULL){
+			perror("malloc failed\n");
+			goto failure;
+		}
+		const int32_t same = checkpoint_read(m, path, length) == 0 && memcmp(path, cp->paths[k], length) == 0;
+		free(path);
+		if(!same){goto failure_input;}
+		struct checkpoint_file* const file = &(cp->files[k]);
+		if(checkpoint_read(m, &(file->offset), sizeof(int64_t)) != 0 || checkpoint_read(m, &(file->offset_tp), sizeof(int64_t)) != 0){goto failure;}
+		if(checkpoint_read(m, &(file->state), sizeof(uint8_t)) != 0 || checkpoint_read(m, &(file->found_at_least_one_mwe), sizeof(int8_t)) != 0 || file->state > CHECKPOINT_FILE_DONE){goto failure;}
+	}
+	if(checkpoint_read(m, cp->output_sizes, CHECKPOINT_NUM_OUTPUTS * sizeof(int64_t)) != 0){goto failure;}
+	cp->loaded_position = (size_t) ftell(m);
+	fclose(m);
+
+	*found = 1;
+	return 0;
+
+	failure_input:
+	fprintf(stderr, "Checkpoint was taken on other input files: %s\n", cp->path);
+	goto failure;
+	failure_truncated:
+	fprintf(stderr, "Truncated checkpoint: %s\n", cp->path);
+	failure_file:
+	fclose(f);
+	failure:
+	if(m != NULL){fclose(m);}
+	free(cp->loaded);
+	cp->loaded = NULL;
+	cp->loaded_size = 0;
+	memset(cp->files, '\0', cp->num_files * sizeof(struct checkpoint_file));
+	return 1;
+}
+
+// called once checkpoint_open found a checkpoint, on an empty graph and OOV counter, before any reader or recompute thread is started
+int32_t checkpoint_restore(struct checkpoint* const cp, const struct measurement_structure_references* const sref, struct measurement_mutables* const mmut){
+	if(cp->loaded == NULL){return 1;}
+	FILE* const m = fmemopen(cp->loaded + cp->loaded_position, cp->loaded_size - cp->loaded_position, "rb");
+	if(m == NULL){
+		perror("failed to call fmemopen\n");
+		return 1;
+	}
+
+	uint64_t num_vectors = 0;
+	if(checkpoint_read(m, &num_vectors, sizeof(uint64_t)) != 0 || num_vectors != sref->w2v->num_vectors){
+		fprintf(stderr, "Checkpoint was taken with another vector database (%lu vectors, not %lu): %s\n", num_vectors, sref->w2v->num_vectors, cp->path);
+		goto failure;
+	}
+
+	if(checkpoint_read(m, &(mmut->best_s), sizeof(double)) != 0 || checkpoint_read(m, &(mmut->prev_best_s), sizeof(double)) != 0 || checkpoint_read(m, &(mmut->prev_num_nodes), sizeof(int64_t)) != 0){goto failure_read;}
+	if(checkpoint_read(m, &(mmut->num_oov_types), sizeof(int64_t)) != 0){goto failure_read;}
+	if(checkpoint_read(m, &(mmut->sentence), sizeof(struct measurement_mutable_counters)) != 0 || checkpoint_read(m, &(mmut->document), sizeof(struct measurement_mutable_counters)) != 0){goto failure_read;}
+	mmut->mst_initialised = 0; // nothing was allocated yet in this process
+
+	uint8_t has_schedule = 0;
+	if(checkpoint_read(m, &has_schedule, sizeof(uint8_t)) != 0){goto failure_read;}
+	if(has_schedule != (sref->schedule != NULL)){
+		fprintf(stderr, "Checkpoint was taken with %s: %s\n", has_schedule ? "adaptive steps" : "no adaptive steps", cp->path);
+		goto failure;
+	}
+	if(has_schedule){
+		struct recompute_schedule* const s = sref->schedule;
+		if(checkpoint_read(m, s->costs, sizeof(s->costs)) != 0 || checkpoint_read(m, &(s->sentence), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_read(m, &(s->document), sizeof(struct recompute_schedule_progress)) != 0 || checkpoint_read(m, &(s->compute_ns), sizeof(int64_t)) != 0){goto failure_read;}
+		// the time spent between the capture and the resume is not ingestion time
+		const int64_t now_ns = recompute_schedule_now();
+		if(s->sentence.last_ns != 0){s->sentence.last_ns = now_ns;}
+		if(s->document.last_ns != 0){s->document.last_ns = now_ns;}
+	}
+
+	uint64_t num_nodes = 0;
+	if(checkpoint_read(m, &num_nodes, sizeof(uint64_t)) != 0){goto failure_read;}
+	for(uint64_t k = 0 ; k < num_nodes ; k++){
+		uint64_t index = 0;
+		uint64_t count = 0;
+		if(checkpoint_read(m, &index, sizeof(uint64_t)) != 0 || checkpoint_read(m, &count, sizeof(uint64_t)) != 0){goto failure_read;}
+		if(index >= num_vectors || count == 0 || graph_word2vec_node(sref->g, sref->w2v, &(sref->w2v->keys[index])) != NULL){goto failure_read;}
+		if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+			perror("failed to call graph_add_word2vec_occurrence\n");
+			goto failure;
+		}
+		graph_node_at(sref->g, k)->absolute_proportion = count;
+	}
+
+	if(oov_counter_load(sref->oov_discarded_because_not_in_vector_database, m) != 0){
+		perror("failed to call oov_counter_load\n");
+		goto failure;
+	}
+	fclose(m);
+
+	free(cp->loaded);
+	cp->loaded = NULL;
+	cp->loaded_size = 0;
+	return 0;
+
+	failure_read:
+	fprintf(stderr, "Corrupt checkpoint: %s\n", cp->path);
+	failure:
+	fclose(m);
+	return 1;
+}
+
+// ---- readers ----
+
+int32_t checkpoint_start(struct checkpoint* const cp, struct measurement_configuration* const mcfg, const struct measurement_structure_references* const sref, struct measurement_mutables* const mmut){
+	cp->mcfg = mcfg;
+	cp->sref = sref;
+	cp->mmut = mmut;
+	if(pthread_create(&(cp->thread), NULL, checkpoint_thread, cp) != 0){
+		perror("failed to call pthread_create\n");
+		return 1;
+	}
+	cp->started = 1;
+	return 0;
+}
+
+uint8_t checkpoint_file_is_done(struct checkpoint* const cp, const int32_t i){
+	pthread_mutex_lock(&(cp->mutex));
+	const uint8_t done = cp->files[i].state == CHECKPOINT_FILE_DONE;
+	pthread_mutex_unlock(&(cp->mutex));
+	return done;
+}
+
+// a file is not started while a capture is pending, since its reader would not be waited for
+void checkpoint_file_begin(struct checkpoint* const cp, const int32_t i){
+	pthread_mutex_lock(&(cp->mutex));
+	while(cp->requested){pthread_cond_wait(&(cp->cond_resume), &(cp->mutex));}
+	cp->num_active++;
+	cp->files[i].state = CHECKPOINT_FILE_STARTED;
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+void checkpoint_file_resume_point(struct checkpoint* const cp, const int32_t i, int64_t* const offset, int64_t* const offset_tp, int8_t* const found_at_least_one_mwe){
+	pthread_mutex_lock(&(cp->mutex));
+	*offset = cp->files[i].offset;
+	*offset_tp = cp->files[i].offset_tp;
+	if(found_at_least_one_mwe != NULL){*found_at_least_one_mwe = cp->files[i].found_at_least_one_mwe;}
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+// called by a reader between two units, holding no lock; parks it while a capture is pending
+void checkpoint_unit_done(struct checkpoint* const cp, const int32_t i, const int64_t offset, const int64_t offset_tp, const int8_t found_at_least_one_mwe){
+	pthread_mutex_lock(&(cp->mutex));
+	if(offset >= 0){cp->files[i].offset = offset;}
+	if(offset_tp >= 0){cp->files[i].offset_tp = offset_tp;}
+	cp->files[i].found_at_least_one_mwe = found_at_least_one_mwe;
+	if(cp->requested){
+		const uint64_t generation = cp->generation;
+		cp->num_parked++;
+		pthread_cond_signal(&(cp->cond_parked));
+		while(cp->generation == generation){pthread_cond_wait(&(cp->cond_resume), &(cp->mutex));}
+		cp->num_parked--;
+	}
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+// a file that failed stays started, so that a resume reads it again from its last unit
+void checkpoint_file_end(struct checkpoint* const cp, const int32_t i, const int32_t status){
+	pthread_mutex_lock(&(cp->mutex));
+	cp->num_active--;
+	if(status == 0){cp->files[i].state = CHECKPOINT_FILE_DONE;}
+	pthread_cond_signal(&(cp->cond_parked));
+	pthread_mutex_unlock(&(cp->mutex));
+}
+
+uint64_t checkpoint_num_written(struct checkpoint* const cp){
+	return __atomic_load_n(&(cp->num_written), __ATOMIC_ACQUIRE);
+}
+
+// stops the checkpoint thread without a last capture; returns 1 if some checkpoint could not be written
+int32_t checkpoint_stop(struct checkpoint* const cp){
+	if(!(cp->started)){return 0;}
+	pthread_mutex_lock(&(cp->mutex));
+	cp->stop = 1;
+	pthread_cond_broadcast(&(cp->cond_parked));
+	pthread_mutex_unlock(&(cp->mutex));
+	if(pthread_join(cp->thread, NULL) != 0){
+		perror("failed to call pthread_join\n");
+		return 1;
+	}
+	cp->started = 0;
+	return cp->status;
+}
+
+// once the measurement is complete, there is nothing left to resume
+int32_t checkpoint_remove(const struct checkpoint* const cp){
+	if(remove(cp->path) != 0 && errno != ENOENT){
+		fprintf(stderr, "Failed to remove file: %s\n", cp->path);
+		return 1;
+	}
+	return 0;
+}
+
+void free_checkpoint(struct checkpoint* const cp){
+	checkpoint_stop(cp);
+	pthread_mutex_destroy(&(cp->mutex));
+	pthread_cond_destroy(&(cp->cond_parked));
+	pthread_cond_destroy(&(cp->cond_resume));
+	free(cp->path);
+	free(cp->tmp_path);
+	free(cp->files);
+	free(cp->loaded);
+	memset(cp, '\0', sizeof(struct checkpoint));
+}
@@ -63,7 +63,7 @@ int32_t davies_bouldin_index(struct graph* const g, const int32_t* const cluster
 	for(i = 0 ; i < g->num_nodes ; i++){
 		if(cluster_index_per_node[i] < 0){continue;}
 		for(j = 0 ; j < (uint64_t) g->num_dimensions ; j++){
-			centroids[cluster_index_per_node[i] * g->num_dimensions + j] += g->nodes[i].vector.fp32[j];
+			centroids[cluster_index_per_node[i] * g->num_dimensions + j] += graph_node_at(g, i)->vector.fp32[j];
 		}
 		num_elements_per_cluster[cluster_index_per_node[i]] += 1;
 	}
@@ -80,10 +80,10 @@ int32_t davies_bouldin_index(struct graph* const g, const int32_t* const cluster
 		/*
 		for(j = 0 ; j < g->num_nodes ; j++){
 			if(cluster_index_per_node[i] != cluster_index_per_node[j]){continue;}
-			cluster_diameters[cluster_index_per_node[i]] += cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->num_dimensions);
+			cluster_diameters[cluster_index_per_node[i]] += cosine_distance_fp32(graph_node_at(g, i)->vector.fp32, graph_node_at(g, j)->vector.fp32, g->num_dimensions);
 		}
 		*/
-		cluster_diameters[cluster_index_per_node[i]] += cosine_distance_fp32(g->nodes[i].vector.fp32, &(centroids[cluster_index_per_node[i] * g->num_dimensions]), g->num_dimensions);
+		cluster_diameters[cluster_index_per_node[i]] += cosine_distance_fp32(graph_node_at(g, i)->vector.fp32, &(centroids[cluster_index_per_node[i] * g->num_dimensions]), g->num_dimensions);
 	}
 	for(i = 0 ; i < (uint64_t) num_clusters ; i++){
 		cluster_diameters[i] /= (float) num_elements_per_cluster[i];
@@ -0,0 +1,941 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "corpus.h"
+#include "graph.h"
+#include "oov/counter.h"
+#include "logging.h"
+#include "measurement.h"
+#include "recompute.h"
+#include "schedule.h"
+#include "file_queue.h"
+#include "batch.h"
+#include "serve.h"
+#include "checkpoint.h"
+#include "shard.h"
+#include "output.h"
+
+#include "macroconfig.h"
+
+int32_t read_list_simulation_files(const char * const path_list_simulation_files, char *** const resulting_paths, int32_t * num_input_paths){
+	FILE* f_paths_ptr = fopen(path_list_simulation_files, "r");
+	if(f_paths_ptr == NULL){
+		fprintf(stderr, "cannot open %s\n", path_list_simulation_files);
+		return 1;
+	}
+	// char* bfr[MAX_FILES];
+    char ** bfr;
+    const size_t bfr_step = 32;
+    size_t bfr_capacity = bfr_step;
+    size_t bfr_alloc_size = bfr_capacity * sizeof(char *);
+    bfr = malloc(bfr_alloc_size);
+    if(bfr == NULL){goto failure_alloc;}
+    memset(bfr, '\0', bfr_alloc_size);
+
+
+	char bfr_read[BFR_SIZE];
+	memset(bfr_read, '\0', BFR_SIZE);
+
+	int32_t num_files = 0;
+	while(fgets(bfr_read, BFR_SIZE - 1, f_paths_ptr)){
+		if(bfr_read[0] == '#'){continue;}
+
+		size_t bytes_to_cpy = strlen(bfr_read);
+		if(bfr_read[bytes_to_cpy - 1] == '\n'){bytes_to_cpy--;}
+		void* local_malloc_p = malloc(bytes_to_cpy + 1);
+		if(local_malloc_p == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+		memset(local_malloc_p, '\0', bytes_to_cpy + 1);
+		memcpy(local_malloc_p, bfr_read, bytes_to_cpy);
+		bfr[num_files] = (char*) local_malloc_p;
+
+		num_files++;
+
+        if(((size_t) num_files) >= bfr_capacity){
+            size_t new_capacity = bfr_capacity + bfr_step;
+            bfr_alloc_size = new_capacity * sizeof(char *);
+            bfr = realloc(bfr, bfr_alloc_size);
+            if(bfr == NULL){goto failure_alloc;}
+            memset(&bfr[bfr_capacity], '\0', bfr_step * sizeof(char *));
+            bfr_capacity = new_capacity;
+        }
+	}
+
+	fclose(f_paths_ptr);
+
+    *resulting_paths = bfr;
+    *num_input_paths = num_files;
+
+    return 0;
+
+    failure_alloc:
+    perror("alloc failed\n");
+    return 1;
+}
+
+// when resuming, the output is cut where the checkpoint left it and written after that
+static int32_t measurement_open_output(struct output_stream * const s, const char * const path, const struct measurement_configuration * const mcfg, const struct checkpoint * const resumed, const int32_t k){
+	if(resumed != NULL && resumed->output_sizes[k] >= 0){
+		return create_output_stream_resumed(s, path, mcfg->io.output_format, mcfg->io.output_compression, mcfg->io.output_row_group_size, resumed->output_sizes[k]);
+	}
+	return create_output_stream(s, path, mcfg->io.output_format, mcfg->io.output_compression, mcfg->io.output_row_group_size);
+}
+
+// opens the outputs of mcfg->io and writes their headers
+static int32_t measurement_open_outputs(struct measurement_configuration * const mcfg, const struct checkpoint * const resumed, const uint8_t enable_distance_computation, struct output_stream * const output, struct output_stream * const output_timing, struct output_stream * const output_memory){
+	if(measurement_open_output(output, mcfg->io.output_path, mcfg, resumed, 0) != 0){return 1;}
+	mcfg->io.output = output;
+	// fprintf(mcfg->io.f_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist"); // DO NOT REMOVE
+	output_header(mcfg->io.output, "num_active_files\tnum_sentences_containing_mwe\tnum_sentences_containing_mwe_tp_only\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist");
+
+	if(mcfg->enable.disparity_functions){
+		if(mcfg->enable.stirling){output_header(mcfg->io.output, "\tstirling_alpha%.10e_beta%.10e", mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta);}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.ricotta_szeidl){output_header(mcfg->io.output, "\tricotta_szeidl_alpha%.10e", mcfg->div_param.ricotta_szeidl_alpha);}
+		if(mcfg->enable.pairwise){output_header(mcfg->io.output, "\tpairwise");}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.chao_et_al_functional_diversity){output_header(mcfg->io.output, "\tchao_et_al_functional_diversity_alpha%.10e\tchao_et_al_functional_hill_number_alpha%.10e", mcfg->div_param.chao_et_al_functional_diversity_alpha, mcfg->div_param.chao_et_al_functional_diversity_alpha);}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.scheiner_species_phylogenetic_functional_diversity){output_header(mcfg->io.output, "\tscheiner_species_phylogenetic_functional_diversity_alpha%.10e\tscheiner_species_phylogenetic_functional_hill_number_alpha%.10e", mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha, mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha);}
+		if(mcfg->enable.leinster_cobbold_diversity){output_header(mcfg->io.output, "\tleinster_cobbold_diversity_alpha%.10e\tleinster_cobbold_hill_number_alpha%.10e", mcfg->div_param.leinster_cobbold_diversity_alpha, mcfg->div_param.leinster_cobbold_diversity_alpha);}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.lexicographic){output_header(mcfg->io.output, "\tlexicographic\tlexicographic_hybrid_scheiner");}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_evenness){output_header(mcfg->io.output, "\tfunctional_evenness");}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.mst){output_header(mcfg->io.output, "\tmst");}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_dispersion){output_header(mcfg->io.output, "\tfunctional_dispersion");}
+		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_divergence_modified){output_header(mcfg->io.output, "\tfunctional_divergence_modified");}
+	}
+	if(mcfg->enable.non_disparity_functions){
+		if(mcfg->enable.shannon_weaver_entropy){output_header(mcfg->io.output, "\tshannon_weaver_entropy\tshannon_weaver_hill_number");}
+		if(mcfg->enable.good_entropy){output_header(mcfg->io.output, "\tgood_entropy_alpha%.4e_beta%.4e", mcfg->div_param.good_alpha, mcfg->div_param.good_beta);}
+		if(mcfg->enable.renyi_entropy){output_header(mcfg->io.output, "\trenyi_entropy_alpha%.4e\trenyi_hill_number_alpha%.4e", mcfg->div_param.renyi_alpha, mcfg->div_param.renyi_alpha);}
+		if(mcfg->enable.patil_taillie_entropy){output_header(mcfg->io.output, "\tpatil_taillie_entropy_alpha%.4e\tpatil_taillie_hill_number_alpha%.4e", mcfg->div_param.patil_taillie_alpha, mcfg->div_param.patil_taillie_alpha);}
+		if(mcfg->enable.q_logarithmic_entropy){output_header(mcfg->io.output, "\tq_logarithmic_entropy_alpha%.4e\tq_logarithmic_hill_number_alpha%.4e", mcfg->div_param.q_logarithmic_q, mcfg->div_param.q_logarithmic_q);}
+		if(mcfg->enable.simpson_index){output_header(mcfg->io.output, "\tsimpson_index");}
+		if(mcfg->enable.simpson_dominance_index){output_header(mcfg->io.output, "\tsimpson_dominance_index");}
+		if(mcfg->enable.hill_number_standard){output_header(mcfg->io.output, "\thill_number_standard_alpha%.4e", mcfg->div_param.hill_number_standard_alpha);}
+		if(mcfg->enable.hill_evenness){output_header(mcfg->io.output, "\thill_evenness_alpha%.4e_beta%.4e", mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);}
+		if(mcfg->enable.berger_parker_index){output_header(mcfg->io.output, "\tberger_parker_index");}
+		if(mcfg->enable.junge1994_page22){output_header(mcfg->io.output, "\tjunge1994_page22");}
+		if(mcfg->enable.brillouin_diversity){output_header(mcfg->io.output, "\tbrillouin_diversity");}
+		if(mcfg->enable.mcintosh_index){output_header(mcfg->io.output, "\tmcintosh_index");}
+		if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){output_header(mcfg->io.output, "\tsw_entropy_over_log_n_species_pielou1975");}
+		if(mcfg->enable.sw_e_heip){output_header(mcfg->io.output, "\tsw_e_heip");}
+		if(mcfg->enable.sw_e_one_minus_d){output_header(mcfg->io.output, "\te_one_minus_D");}
+		if(mcfg->enable.sw_e_one_over_ln_d_williams1964){output_header(mcfg->io.output, "\te_one_over_ln_D_williams1964");}
+		if(mcfg->enable.sw_e_minus_ln_d_pielou1977){output_header(mcfg->io.output, "\te_minus_ln_D_pielou1977");}
+		if(mcfg->enable.sw_f_2_1_alatalo1981){output_header(mcfg->io.output, "\tsw_f_2_1_alatalo1981");}
+		if(mcfg->enable.sw_g_2_1_molinari1989){output_header(mcfg->io.output, "\tsw_g_2_1_molinari1989");}
+		if(mcfg->enable.sw_e_bulla1994){output_header(mcfg->io.output, "\tsw_e_bulla1994");}
+		if(mcfg->enable.sw_o_bulla1994){output_header(mcfg->io.output, "\tsw_o_bulla1994");}
+		if(mcfg->enable.sw_e_mci_pielou1969){output_header(mcfg->io.output, "\tsw_e_mci_pielou1969");}
+		if(mcfg->enable.sw_e_prime_camargo1993){output_header(mcfg->io.output, "\tsw_e_prime_camargo1993");}
+		if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){output_header(mcfg->io.output, "\tsw_e_var_smith_and_wilson1996_original");}
+	}
+	output_header(mcfg->io.output, "\n");
+
+	mcfg->io.output_timing = NULL;
+	if(mcfg->io.enable_output_timing){
+		if(measurement_open_output(output_timing, mcfg->io.output_path_timing, mcfg, resumed, 1) != 0){return 1;}
+		mcfg->io.output_timing = output_timing;
+		// fprintf(mcfg->io.f_timing_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist");
+		output_header(mcfg->io.output_timing, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn");
+
+		if(mcfg->enable.disparity_functions){
+			// ----
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){output_header(mcfg->io.output_timing, "\tm_mst_creation");}
+			if(enable_distance_computation){output_header(mcfg->io.output_timing, "\tdist_matrix_computation");}
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){output_header(mcfg->io.output_timing, "\tdist_heap_computation");}
+			if(enable_distance_computation){output_header(mcfg->io.output_timing, "\tdist_stat_computation");}
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){output_header(mcfg->io.output_timing, "\tmst_computation");}
+			// ----
+
+			if(mcfg->enable.stirling){output_header(mcfg->io.output_timing, "\tstirling_alpha%.10e_beta%.10e", mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.ricotta_szeidl){output_header(mcfg->io.output_timing, "\tricotta_szeidl_alpha%.10e", mcfg->div_param.ricotta_szeidl_alpha);}
+			if(mcfg->enable.pairwise){output_header(mcfg->io.output_timing, "\tpairwise");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.chao_et_al_functional_diversity){output_header(mcfg->io.output_timing, "\tchao_et_al_functional_diversity_alpha%.10e", mcfg->div_param.chao_et_al_functional_diversity_alpha);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.scheiner_species_phylogenetic_functional_diversity){output_header(mcfg->io.output_timing, "\tscheiner_species_phylogenetic_functional_diversity_alpha%.10e", mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.leinster_cobbold_diversity){output_header(mcfg->io.output_timing, "\tleinster_cobbold_diversity_alpha%.10e", mcfg->div_param.leinster_cobbold_diversity_alpha);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.lexicographic){output_header(mcfg->io.output_timing, "\tlexicographic");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_evenness){output_header(mcfg->io.output_timing, "\tfunctional_evenness");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.mst){output_header(mcfg->io.output_timing, "\tmst");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_dispersion){output_header(mcfg->io.output_timing, "\tfunctional_dispersion");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_divergence_modified){output_header(mcfg->io.output_timing, "\tfunctional_divergence_modified");}
+		}
+		if(mcfg->enable.non_disparity_functions){
+			if(mcfg->enable.shannon_weaver_entropy){output_header(mcfg->io.output_timing, "\tshannon_weaver_entropy");}
+			if(mcfg->enable.good_entropy){output_header(mcfg->io.output_timing, "\tgood_entropy_alpha%.4e_beta%.4e", mcfg->div_param.good_alpha, mcfg->div_param.good_beta);}
+			if(mcfg->enable.renyi_entropy){output_header(mcfg->io.output_timing, "\trenyi_entropy_alpha%.4e", mcfg->div_param.renyi_alpha);}
+			if(mcfg->enable.patil_taillie_entropy){output_header(mcfg->io.output_timing, "\tpatil_taillie_entropy_alpha%.4e", mcfg->div_param.patil_taillie_alpha);}
+			if(mcfg->enable.q_logarithmic_entropy){output_header(mcfg->io.output_timing, "\tq_logarithmic_entropy_alpha%.4e", mcfg->div_param.q_logarithmic_q);}
+			if(mcfg->enable.simpson_index){output_header(mcfg->io.output_timing, "\tsimpson_index");}
+			if(mcfg->enable.simpson_dominance_index){output_header(mcfg->io.output_timing, "\tsimpson_dominance_index");}
+			if(mcfg->enable.hill_number_standard){output_header(mcfg->io.output_timing, "\thill_number_standard_alpha%.4e", mcfg->div_param.hill_number_standard_alpha);}
+			if(mcfg->enable.hill_evenness){output_header(mcfg->io.output_timing, "\thill_evenness_alpha%.4e_beta%.4e", mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);}
+			if(mcfg->enable.berger_parker_index){output_header(mcfg->io.output_timing, "\tberger_parker_index");}
+			if(mcfg->enable.junge1994_page22){output_header(mcfg->io.output_timing, "\tjunge1994_page22");}
+			if(mcfg->enable.brillouin_diversity){output_header(mcfg->io.output_timing, "\tbrillouin_diversity");}
+			if(mcfg->enable.mcintosh_index){output_header(mcfg->io.output_timing, "\tmcintosh_index");}
+			if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){output_header(mcfg->io.output_timing, "\tsw_entropy_over_log_n_species_pielou1975");}
+			if(mcfg->enable.sw_e_heip){output_header(mcfg->io.output_timing, "\tsw_e_heip");}
+			if(mcfg->enable.sw_e_one_minus_d){output_header(mcfg->io.output_timing, "\te_one_minus_D");}
+			if(mcfg->enable.sw_e_one_over_ln_d_williams1964){output_header(mcfg->io.output_timing, "\te_one_over_ln_D_williams1964");}
+			if(mcfg->enable.sw_e_minus_ln_d_pielou1977){output_header(mcfg->io.output_timing, "\te_minus_ln_D_pielou1977");}
+			if(mcfg->enable.sw_f_2_1_alatalo1981){output_header(mcfg->io.output_timing, "\tsw_f_2_1_alatalo1981");}
+			if(mcfg->enable.sw_g_2_1_molinari1989){output_header(mcfg->io.output_timing, "\tsw_g_2_1_molinari1989");}
+			if(mcfg->enable.sw_e_bulla1994){output_header(mcfg->io.output_timing, "\tsw_e_bulla1994");}
+			if(mcfg->enable.sw_o_bulla1994){output_header(mcfg->io.output_timing, "\tsw_o_bulla1994");}
+			if(mcfg->enable.sw_e_mci_pielou1969){output_header(mcfg->io.output_timing, "\tsw_e_mci_pielou1969");}
+			if(mcfg->enable.sw_e_prime_camargo1993){output_header(mcfg->io.output_timing, "\tsw_e_prime_camargo1993");}
+			if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){output_header(mcfg->io.output_timing, "\tsw_e_var_smith_and_wilson1996_original");}
+		}
+		output_header(mcfg->io.output_timing, "\n");
+	}
+
+	mcfg->io.output_memory = NULL;
+	if(mcfg->io.enable_output_memory){
+		if(measurement_open_output(output_memory, mcfg->io.output_path_memory, mcfg, resumed, 2) != 0){return 1;}
+		mcfg->io.output_memory = output_memory;
+		// fprintf(mcfg->io.f_memory_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist");
+		output_header(mcfg->io.output_memory, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn");
+
+		if(mcfg->enable.disparity_functions){
+			// ----
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){output_header(mcfg->io.output_memory, "\tm_mst_creation");}
+			if(enable_distance_computation){output_header(mcfg->io.output_memory, "\tdist_matrix_computation");}
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){output_header(mcfg->io.output_memory, "\tdist_heap_computation");}
+			if(enable_distance_computation){output_header(mcfg->io.output_memory, "\tdist_stat_computation");}
+			if(mcfg->enable.functional_evenness || mcfg->enable.mst){output_header(mcfg->io.output_memory, "\tmst_computation");}
+			// ----
+	
+			if(mcfg->enable.stirling){output_header(mcfg->io.output_memory, "\tstirling_alpha%.10e_beta%.10e", mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.ricotta_szeidl){output_header(mcfg->io.output_memory, "\tricotta_szeidl_alpha%.10e", mcfg->div_param.ricotta_szeidl_alpha);}
+			if(mcfg->enable.pairwise){output_header(mcfg->io.output_memory, "\tpairwise");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.chao_et_al_functional_diversity){output_header(mcfg->io.output_memory, "\tchao_et_al_functional_diversity_alpha%.10e", mcfg->div_param.chao_et_al_functional_diversity_alpha);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.scheiner_species_phylogenetic_functional_diversity){output_header(mcfg->io.output_memory, "\tscheiner_species_phylogenetic_functional_diversity_alpha%.10e", mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.leinster_cobbold_diversity){output_header(mcfg->io.output_memory, "\tleinster_cobbold_diversity_alpha%.10e", mcfg->div_param.leinster_cobbold_diversity_alpha);}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.lexicographic){output_header(mcfg->io.output_memory, "\tlexicographic");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_evenness){output_header(mcfg->io.output_memory, "\tfunctional_evenness");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.mst){output_header(mcfg->io.output_memory, "\tmst");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_dispersion){output_header(mcfg->io.output_memory, "\tfunctional_dispersion");}
+			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_divergence_modified){output_header(mcfg->io.output_memory, "\tfunctional_divergence_modified");}
+		}
+		if(mcfg->enable.non_disparity_functions){
+			if(mcfg->enable.shannon_weaver_entropy){output_header(mcfg->io.output_memory, "\tshannon_weaver_entropy");}
+			if(mcfg->enable.good_entropy){output_header(mcfg->io.output_memory, "\tgood_entropy_alpha%.4e_beta%.4e", mcfg->div_param.good_alpha, mcfg->div_param.good_beta);}
+			if(mcfg->enable.renyi_entropy){output_header(mcfg->io.output_memory, "\trenyi_entropy_alpha%.4e", mcfg->div_param.renyi_alpha);}
+			if(mcfg->enable.patil_taillie_entropy){output_header(mcfg->io.output_memory, "\tpatil_taillie_entropy_alpha%.4e", mcfg->div_param.patil_taillie_alpha);}
+			if(mcfg->enable.q_logarithmic_entropy){output_header(mcfg->io.output_memory, "\tq_logarithmic_entropy_alpha%.4e", mcfg->div_param.q_logarithmic_q);}
+			if(mcfg->enable.simpson_index){output_header(mcfg->io.output_memory, "\tsimpson_index");}
+			if(mcfg->enable.simpson_dominance_index){output_header(mcfg->io.output_memory, "\tsimpson_dominance_index");}
+			if(mcfg->enable.hill_number_standard){output_header(mcfg->io.output_memory, "\thill_number_standard_alpha%.4e", mcfg->div_param.hill_number_standard_alpha);}
+			if(mcfg->enable.hill_evenness){output_header(mcfg->io.output_memory, "\thill_evenness_alpha%.4e_beta%.4e", mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);}
+			if(mcfg->enable.berger_parker_index){output_header(mcfg->io.output_memory, "\tberger_parker_index");}
+			if(mcfg->enable.junge1994_page22){output_header(mcfg->io.output_memory, "\tjunge1994_page22");}
+			if(mcfg->enable.brillouin_diversity){output_header(mcfg->io.output_memory, "\tbrillouin_diversity");}
+			if(mcfg->enable.mcintosh_index){output_header(mcfg->io.output_memory, "\tmcintosh_index");}
+			if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){output_header(mcfg->io.output_memory, "\tsw_entropy_over_log_n_species_pielou1975");}
+			if(mcfg->enable.sw_e_heip){output_header(mcfg->io.output_memory, "\tsw_e_heip");}
+			if(mcfg->enable.sw_e_one_minus_d){output_header(mcfg->io.output_memory, "\te_one_minus_D");}
+			if(mcfg->enable.sw_e_one_over_ln_d_williams1964){output_header(mcfg->io.output_memory, "\te_one_over_ln_D_williams1964");}
+			if(mcfg->enable.sw_e_minus_ln_d_pielou1977){output_header(mcfg->io.output_memory, "\te_minus_ln_D_pielou1977");}
+			if(mcfg->enable.sw_f_2_1_alatalo1981){output_header(mcfg->io.output_memory, "\tsw_f_2_1_alatalo1981");}
+			if(mcfg->enable.sw_g_2_1_molinari1989){output_header(mcfg->io.output_memory, "\tsw_g_2_1_molinari1989");}
+			if(mcfg->enable.sw_e_bulla1994){output_header(mcfg->io.output_memory, "\tsw_e_bulla1994");}
+			if(mcfg->enable.sw_o_bulla1994){output_header(mcfg->io.output_memory, "\tsw_o_bulla1994");}
+			if(mcfg->enable.sw_e_mci_pielou1969){output_header(mcfg->io.output_memory, "\tsw_e_mci_pielou1969");}
+			if(mcfg->enable.sw_e_prime_camargo1993){output_header(mcfg->io.output_memory, "\tsw_e_prime_camargo1993");}
+			if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){output_header(mcfg->io.output_memory, "\tsw_e_var_smith_and_wilson1996_original");}
+		}
+		output_header(mcfg->io.output_memory, "\n");
+	}
+
+	return 0;
+}
+
+// keeps the first cause of a failure of measurement_corpus for the caller, when it asked for one
+static void measurement_corpus_error(const struct measurement_configuration * const mcfg, const char * const cause){
+	if(mcfg->io.error != NULL && mcfg->io.error[0] == '\0'){snprintf(mcfg->io.error, mcfg->io.error_size, "%s", cause);}
+}
+
+// measures one corpus with the shared word2vec; in a batch, its files are read with those of the other corpora (see batch_read)
+// every failure goes through the cleanup at the end, so that a caller that keeps running (--serve) gets back what was allocated
+int32_t measurement_corpus(struct measurement_configuration * const mcfg, struct word2vec * const w2v, struct batch * const batch, const int32_t batch_index){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+
+	const uint8_t ingest_only = mcfg->shard.output_path != NULL && mcfg->shard.output_path[0] != '\0';
+	const uint8_t from_shard = mcfg->shard.input_path != NULL && mcfg->shard.input_path[0] != '\0';
+	const uint8_t enable_distance_computation = mcfg->enable.disparity_functions && (mcfg->enable.stirling || mcfg->enable.ricotta_szeidl || mcfg->enable.pairwise || mcfg->enable.chao_et_al_functional_diversity || mcfg->enable.scheiner_species_phylogenetic_functional_diversity || mcfg->enable.leinster_cobbold_diversity || mcfg->enable.lexicographic || mcfg->enable.functional_evenness || mcfg->enable.mst || mcfg->enable.functional_dispersion || mcfg->enable.functional_divergence_modified);
+	const uint8_t enable_checkpoint = mcfg->checkpoint.path[0] != '\0';
+
+	struct oov_counter oov_discarded_because_not_in_vector_database;
+	struct graph g = {0};
+	struct graph_distance_heap heap;
+	struct minimum_spanning_tree mst;
+	struct checkpoint checkpoint;
+	struct output_stream output, output_timing, output_memory;
+	struct recompute_worker recompute;
+	struct recompute_schedule schedule;
+
+	int32_t num_input_paths = 0;
+	int32_t num_input_paths_true_positive = 0;
+	char** input_paths = NULL;
+	char** input_paths_tp = NULL; // !
+
+	// what the cleanup has to undo
+	uint8_t oov_created = 0;
+	uint8_t graph_created = 0;
+	uint8_t checkpoint_created = 0;
+	uint8_t mutex_created = 0;
+	uint8_t schedule_created = 0;
+	uint8_t recompute_started = 0;
+
+	int32_t return_status = 0;
+	int32_t i = 0;
+	uint8_t resuming = 0;
+
+	memset(&heap, '\0', sizeof(struct graph_distance_heap));
+	memset(&mst, '\0', sizeof(struct minimum_spanning_tree));
+	mcfg->io.output = NULL;
+	mcfg->io.output_timing = NULL;
+	mcfg->io.output_memory = NULL;
+
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.mst = &mst,
+		.heap = &heap,
+		.w2v = w2v,
+		.oov_discarded_because_not_in_vector_database = &oov_discarded_because_not_in_vector_database,
+		.recompute = (mcfg->threading.recompute_queue_size > 0 && !ingest_only) ? &recompute : NULL,
+		.schedule = (mcfg->steps.sentence.use_adaptive || mcfg->steps.document.use_adaptive) ? &schedule : NULL,
+		.checkpoint = enable_checkpoint ? &checkpoint : NULL,
+	};
+
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.prev_num_nodes = 0,
+		.mst_initialised = 0,
+		.sentence = (struct measurement_mutable_counters) {
+			.num_containing_mwe = 0,
+			.num_containing_mwe_tp_only = 0,
+			.num_all = 0,
+			.count_target = 1,
+			.stacked_log = 0.0,
+		},
+		.document = (struct measurement_mutable_counters) {
+			.num_all = 0,
+			.count_target = 1,
+			.stacked_log = 0.0,
+		},
+	};
+
+	if(create_oov_counter(&oov_discarded_because_not_in_vector_database, mcfg->oov_memory_cap) != 0){
+		perror("failed to call create_oov_counter\n");
+		return_status = 1;
+		goto cleanup;
+	}
+	oov_created = 1;
+
+	// #if MST_SANITY_TESTING == 1
+//	if(create_graph(&g, 1 << 10, 2, FP32) != 0){
+//		perror("failed to call create_graph_empty\n");
+//		return 1;
+//	}
+	// #else
+	if(create_graph_empty(&g) != 0){
+		perror("failed to call create_graph_empty\n");
+		return_status = 1;
+		goto cleanup;
+	}
+	graph_created = 1;
+	// #endif
+	if(graph_bind_word2vec(&g, w2v) != 0){
+		perror("failed to call graph_bind_word2vec\n");
+		return_status = 1;
+		goto cleanup;
+	}
+
+    // <--
+    // #if MST_SANITY_TESTING == 0
+    if(!from_shard && (read_list_simulation_files(mcfg->io.input_path, &input_paths, &num_input_paths) != 0 || (mcfg->io.input_path_tp != NULL && read_list_simulation_files(mcfg->io.input_path_tp, &input_paths_tp, &num_input_paths_true_positive) != 0))){
+        perror("failed to call read_list_simulation_files\n");
+        memset(log_bfr, '\0', log_bfr_size);
+        snprintf(log_bfr, log_bfr_size, "cannot read the list of files %s", input_paths == NULL ? mcfg->io.input_path : mcfg->io.input_path_tp);
+        measurement_corpus_error(mcfg, log_bfr);
+        return_status = 1;
+        goto cleanup;
+    }
+    // #endif
+
+    if(enable_checkpoint){
+        if(create_checkpoint(&checkpoint, mcfg->checkpoint.path, mcfg->checkpoint.interval, input_paths, num_input_paths) != 0){
+            perror("Failed to call create_checkpoint\n");
+            return_status = 1;
+            goto cleanup;
+        }
+        checkpoint_created = 1;
+        if(mcfg->checkpoint.resume && checkpoint_open(&checkpoint, &resuming) != 0){
+            perror("Failed to call checkpoint_open\n");
+            memset(log_bfr, '\0', log_bfr_size);
+            snprintf(log_bfr, log_bfr_size, "cannot resume from checkpoint %s", mcfg->checkpoint.path);
+            measurement_corpus_error(mcfg, log_bfr);
+            return_status = 1;
+            goto cleanup;
+        }
+        memset(log_bfr, '\0', log_bfr_size);
+        if(resuming){
+            snprintf(log_bfr, log_bfr_size, "Resuming from checkpoint %s", mcfg->checkpoint.path);
+        } else {
+            snprintf(log_bfr, log_bfr_size, "Writing checkpoints to %s every %.3fs%s", mcfg->checkpoint.path, mcfg->checkpoint.interval, mcfg->checkpoint.resume ? " (nothing to resume from)" : "");
+        }
+        info_format(__FILE__, __func__, __LINE__, log_bfr);
+    }
+    const struct checkpoint * const resumed = resuming ? &checkpoint : NULL;
+
+	if(!ingest_only && measurement_open_outputs(mcfg, resumed, enable_distance_computation, &output, &output_timing, &output_memory) != 0){
+		memset(log_bfr, '\0', log_bfr_size);
+		snprintf(log_bfr, log_bfr_size, "cannot open the outputs of %s", mcfg->io.output_path);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		measurement_corpus_error(mcfg, log_bfr);
+		return_status = 1;
+		goto cleanup;
+	}
+
+    if(pthread_mutex_init(&(mmut.mutex), NULL) != 0){
+        perror("Failed to call pthread_mutex_init for mmut\n");
+        return_status = 1;
+        goto cleanup;
+    }
+    mutex_created = 1;
+
+    if(sref.schedule != NULL){
+        const uint32_t enabled_functions = (1u << RECOMPUTE_COST_FIT) | (mcfg->enable.disparity_functions ? (1u << RECOMPUTE_COST_DISPARITY) : 0) | (mcfg->enable.non_disparity_functions ? (1u << RECOMPUTE_COST_NON_DISPARITY) : 0);
+        if(create_recompute_schedule(&schedule, enabled_functions, mcfg->steps.adaptive.compute_fraction, mcfg->steps.adaptive.min_step, mcfg->steps.adaptive.max_step, mcfg->steps.adaptive.deterministic) != 0){
+            perror("Failed to call create_recompute_schedule\n");
+            return_status = 1;
+            goto cleanup;
+        }
+        schedule_created = 1;
+    }
+
+    // before the recompute thread, which starts from the zipfian fit found in mmut
+    if(resuming && checkpoint_restore(&checkpoint, &sref, &mmut) != 0){
+        perror("Failed to call checkpoint_restore\n");
+        memset(log_bfr, '\0', log_bfr_size);
+        snprintf(log_bfr, log_bfr_size, "cannot restore checkpoint %s", mcfg->checkpoint.path);
+        measurement_corpus_error(mcfg, log_bfr);
+        return_status = 1;
+        goto cleanup;
+    }
+
+    // the counts of the shard stand for the files that would have been read
+    int32_t num_files_shard = 0;
+    int64_t num_oov_types_shard = 0;
+    if(from_shard){
+        struct shard shard;
+        if(shard_read(&shard, mcfg->shard.input_path) != 0){
+            perror("Failed to call shard_read\n");
+            memset(log_bfr, '\0', log_bfr_size);
+            snprintf(log_bfr, log_bfr_size, "cannot read shard %s", mcfg->shard.input_path);
+            measurement_corpus_error(mcfg, log_bfr);
+            return_status = 1;
+            goto cleanup;
+        }
+        const int32_t restore_status = measurement_restore_shard(&shard, &sref, &mmut, &num_oov_types_shard);
+        num_files_shard = (int32_t) shard.num_files;
+        free_shard(&shard);
+        if(restore_status != 0){
+            perror("Failed to call measurement_restore_shard\n");
+            return_status = 1;
+            goto cleanup;
+        }
+    }
+
+    // from here on, the steps reached by the readers are computed by the recompute thread, which owns mst and heap
+    if(sref.recompute != NULL){
+        if(create_recompute_worker(&recompute, mcfg, &sref, &mmut, (uint32_t) mcfg->threading.recompute_queue_size) != 0){
+            perror("Failed to call create_recompute_worker\n");
+            return_status = 1;
+            goto cleanup;
+        }
+        recompute_started = 1;
+    }
+
+    if(from_shard){
+        i = num_files_shard;
+    } else if(batch != NULL){
+        const struct file_queue_corpus corpus = {
+            .paths = input_paths,
+            .paths_tp = mcfg->io.input_path_tp != NULL ? input_paths_tp : NULL,
+            .num_paths = num_input_paths,
+            .mcfg = mcfg,
+            .sref = &sref,
+            .mmut = &mmut,
+        };
+        if(batch_read(batch, batch_index, &corpus, &i) != 0){
+            perror("Failed to call batch_read\n");
+            return_status = 1;
+        }
+    } else {
+        struct file_queue file_queue;
+        if(create_file_queue(&file_queue, input_paths, mcfg->io.input_path_tp != NULL ? input_paths_tp : NULL, num_input_paths, mcfg->threading.schedule_largest_first) != 0){
+            perror("Failed to call create_file_queue\n");
+            measurement_corpus_error(mcfg, file_queue.error);
+            return_status = 1;
+            goto cleanup;
+        }
+        file_queue.progress = mcfg->io.progress;
+
+        if(enable_checkpoint && checkpoint_start(&checkpoint, mcfg, &sref, &mmut) != 0){
+            perror("Failed to call checkpoint_start\n");
+            free_file_queue(&file_queue);
+            return_status = 1;
+            goto cleanup;
+        }
+
+        if(file_queue_read(&file_queue, mcfg, &sref, &mmut, mcfg->threading.num_file_reading_threads) != 0){
+            perror("Failed to call file_queue_read\n");
+            measurement_corpus_error(mcfg, file_queue.error);
+            return_status = 1;
+        }
+        // the final step is not checkpointed: a run killed from here on resumes from the last checkpoint
+        if(enable_checkpoint && checkpoint_stop(&checkpoint) != 0){
+            warning_format(__FILE__, __func__, __LINE__, "some checkpoints could not be written");
+        }
+        i = file_queue.num_done;
+        free_file_queue(&file_queue);
+    }
+    // #else
+    // int32_t i = 0;
+    // #endif
+
+    memset(log_bfr, '\0', log_bfr_size);
+    snprintf(log_bfr, log_bfr_size, "%s with %li nodes: %s", ingest_only ? "Writing shard" : "Running final snapshot", g.num_nodes, ingest_only ? mcfg->shard.output_path : mcfg->io.output_path);
+    info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+    const int64_t num_oov_types = from_shard ? num_oov_types_shard : oov_counter_num_types(&oov_discarded_because_not_in_vector_database);
+    pthread_mutex_lock(&g.mutex_nodes);
+    if(ingest_only){
+        // the final step is left to whoever measures the shard, once merged with the others
+        struct shard captured;
+        if(return_status == 0 && measurement_capture_shard(&captured, &sref, &mmut, (uint64_t) i) != 0){
+            perror("Failed to call measurement_capture_shard\n");
+            return_status = 1;
+        } else if(return_status == 0){
+            if(shard_write(&captured, mcfg->shard.output_path) != 0){
+                perror("Failed to call shard_write\n");
+                memset(log_bfr, '\0', log_bfr_size);
+                snprintf(log_bfr, log_bfr_size, "cannot write shard %s", mcfg->shard.output_path);
+                measurement_corpus_error(mcfg, log_bfr);
+                return_status = 1;
+            }
+            free_shard(&captured);
+        }
+    } else if(sref.recompute != NULL){
+        // queued behind the steps still pending, so that the rows keep their order
+        if(return_status == 0 && recompute_worker_submit(&recompute, i, &g, &mmut, num_oov_types, 1) != 0){
+            perror("Failed to call recompute_worker_submit\n");
+            return_status = 1;
+        }
+        if(recompute_worker_finish(&recompute) != 0){
+            perror("Failed to call recompute_worker_finish\n");
+            return_status = 1;
+        }
+        free_recompute_worker(&recompute);
+        recompute_started = 0;
+    } else if(return_status == 0){
+        mmut.num_oov_types = num_oov_types;
+        if(compute_graph_relative_proportions(&g) != 0 || measurement_recompute_step(i, mcfg, &sref, &mmut, 1) != 0){
+            perror("Failed to call measurement_recompute_step\n");
+            return_status = 1;
+        }
+    }
+    pthread_mutex_unlock(&g.mutex_nodes);
+
+	cleanup:
+	// steps already queued are still computed, so that the rows written so far are complete
+	if(recompute_started){
+		if(recompute_worker_finish(&recompute) != 0){perror("Failed to call recompute_worker_finish\n");}
+		free_recompute_worker(&recompute);
+	}
+	if(schedule_created){free_recompute_schedule(&schedule);}
+
+	if(graph_created){free_graph(&g);}
+	free_graph_distance_heap(&heap);
+	free_minimum_spanning_tree(&mst);
+
+	if(oov_created){free_oov_counter(&oov_discarded_because_not_in_vector_database);}
+
+	// for(int32_t i = 0 ; i < num_files ; i++){
+	for(int32_t i = 0 ; i < num_input_paths ; i++){
+		// free(bfr[i]);
+		free(input_paths[i]);
+	}
+	for(int32_t i = 0 ; i < num_input_paths_true_positive ; i++){
+		free(input_paths_tp[i]);
+	}
+    free(input_paths);
+    free(input_paths_tp);
+    // #endif
+
+	struct output_stream* const outputs[] = {mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory};
+	for(size_t k = 0 ; k < sizeof(outputs) / sizeof(outputs[0]) ; k++){
+		if(outputs[k] == NULL){continue;}
+		if(output_stream_finish(outputs[k]) != 0){
+			perror("failed to write output file\n");
+			memset(log_bfr, '\0', log_bfr_size);
+			snprintf(log_bfr, log_bfr_size, "cannot write output file %s", k == 0 ? mcfg->io.output_path : (k == 1 ? mcfg->io.output_path_timing : mcfg->io.output_path_memory));
+			measurement_corpus_error(mcfg, log_bfr);
+			return_status = 1;
+		}
+		free_output_stream(outputs[k]);
+	}
+	mcfg->io.output = NULL;
+	mcfg->io.output_timing = NULL;
+	mcfg->io.output_memory = NULL;
+
+    if(checkpoint_created){
+        if(return_status == 0 && checkpoint_remove(&checkpoint) != 0){return_status = 1;}
+        free_checkpoint(&checkpoint);
+    }
+
+    if(mutex_created && pthread_mutex_destroy(&(mmut.mutex)) != 0){
+        perror("Failed to call pthread_mutex_destroy for mmut\n");
+        return_status = 1;
+    }
+
+	return return_status;
+}
+
+struct measurement_batch_corpus {
+	struct measurement_configuration * mcfg; // of the whole batch
+	struct word2vec * w2v;
+	const struct batch_corpus * corpus;
+	char * output_paths[3];
+};
+
+static char * measurement_batch_output_path(const char * const prefix, const char * const name){
+	const size_t len_prefix = strlen(prefix);
+	const size_t len_name = strlen(name);
+	char * const path = malloc(len_prefix + len_name + 1);
+	if(path == NULL){return NULL;}
+	memcpy(path, prefix, len_prefix);
+	memcpy(path + len_prefix, name, len_name + 1);
+	return path;
+}
+
+// the configuration of the batch, with the input lists and outputs of the corpus
+static int32_t measurement_batch_corpus(struct batch * const b, const int32_t k, void * const arg){
+	struct measurement_batch_corpus * const c = (struct measurement_batch_corpus *) arg;
+	const struct measurement_configuration * const mcfg = c->mcfg;
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+
+	struct measurement_configuration corpus_mcfg = {
+		.target_column = mcfg->target_column,
+		.enable_token_utf8_normalisation = mcfg->enable_token_utf8_normalisation,
+		.jsonl_content_key = mcfg->jsonl_content_key,
+		.div_param = mcfg->div_param,
+		.enable = mcfg->enable,
+		.io = (struct measurement_io) {
+			.w2v_path = mcfg->io.w2v_path,
+			.jsonl_content_key = mcfg->io.jsonl_content_key,
+			.input_path = c->corpus->input_path,
+			.input_path_tp = c->corpus->input_path_tp,
+			.output_path = c->output_paths[0],
+			.output_path_timing = c->output_paths[1],
+			.output_path_memory = c->output_paths[2],
+			.udpipe_model_path = mcfg->io.udpipe_model_path,
+			.output_format = mcfg->io.output_format,
+			.output_compression = mcfg->io.output_compression,
+			.output_row_group_size = mcfg->io.output_row_group_size,
+			.enable_timings = mcfg->io.enable_timings,
+			.enable_output_timing = mcfg->io.enable_output_timing,
+			.enable_output_memory = mcfg->io.enable_output_memory,
+		},
+		.threading = mcfg->threading,
+		.steps = mcfg->steps,
+		.oov_memory_cap = mcfg->oov_memory_cap,
+		.checkpoint = mcfg->checkpoint,
+	};
+
+	memset(log_bfr, '\0', log_bfr_size);
+	snprintf(log_bfr, log_bfr_size, "corpus %s: %s -> %s", c->corpus->name, c->corpus->input_path, c->output_paths[0]);
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+	return measurement_corpus(&corpus_mcfg, c->w2v, b, k);
+}
+
+// every corpus of the manifest, with one word2vec and one pool of reader threads
+int32_t measurement_batch(struct measurement_configuration * const mcfg, struct word2vec * const w2v){
+	const char * const output_names[3] = {OUTPUT_PATH, OUTPUT_PATH_TIMING, OUTPUT_PATH_MEMORY};
+	struct batch_manifest manifest;
+	int32_t result = 0;
+
+	if(mcfg->checkpoint.path[0] != '\0'){
+		error_format(__FILE__, __func__, __LINE__, "checkpoints are not supported in batch mode");
+		return 1;
+	}
+	if(read_batch_manifest(&manifest, mcfg->io.batch_path) != 0){
+		perror("failed to call read_batch_manifest\n");
+		return 1;
+	}
+
+	struct measurement_batch_corpus * const corpora = calloc(manifest.num_corpora, sizeof(struct measurement_batch_corpus));
+	void ** const args = calloc(manifest.num_corpora, sizeof(void *));
+	if(corpora == NULL || args == NULL){
+		perror("malloc failed\n");
+		result = 1;
+		goto free_memory;
+	}
+	for(int32_t k = 0 ; k < manifest.num_corpora ; k++){
+		corpora[k].mcfg = mcfg;
+		corpora[k].w2v = w2v;
+		corpora[k].corpus = &(manifest.corpora[k]);
+		for(int32_t j = 0 ; j < 3 ; j++){
+			corpora[k].output_paths[j] = measurement_batch_output_path(manifest.corpora[k].output_prefix, output_names[j]);
+			if(corpora[k].output_paths[j] == NULL){
+				perror("malloc failed\n");
+				result = 1;
+				goto free_memory;
+			}
+		}
+		args[k] = &(corpora[k]);
+	}
+
+	if(batch_run(manifest.num_corpora, mcfg->threading.num_file_reading_threads, mcfg->threading.schedule_largest_first, measurement_batch_corpus, args) != 0){
+		perror("failed to call batch_run\n");
+		result = 1;
+	}
+
+	free_memory:
+	if(corpora != NULL){
+		for(int32_t k = 0 ; k < manifest.num_corpora ; k++){
+			for(int32_t j = 0 ; j < 3 ; j++){free(corpora[k].output_paths[j]);}
+		}
+	}
+	free(corpora);
+	free(args);
+	free_batch_manifest(&manifest);
+	return result;
+}
+
+// the names of the --enable_* arguments a job may list, with the family each function belongs to
+struct measurement_serve_function {
+	const char * name;
+	const char * family; // NULL for the families themselves
+};
+
+static const struct measurement_serve_function measurement_serve_functions[] = {
+	{"disparity_functions", NULL},
+	{"non_disparity_functions", NULL},
+	{"stirling", "disparity_functions"},
+	{"ricotta_szeidl", "disparity_functions"},
+	{"pairwise", "disparity_functions"},
+	{"lexicographic", "disparity_functions"},
+	{"chao_et_al_functional_diversity", "disparity_functions"},
+	{"scheiner_species_phylogenetic_functional_diversity", "disparity_functions"},
+	{"leinster_cobbold_diversity", "disparity_functions"},
+	{"mst", "disparity_functions"},
+	{"functional_evenness", "disparity_functions"},
+	{"functional_dispersion", "disparity_functions"},
+	{"functional_divergence_modified", "disparity_functions"},
+	{"shannon_weaver_entropy", "non_disparity_functions"},
+	{"good_entropy", "non_disparity_functions"},
+	{"renyi_entropy", "non_disparity_functions"},
+	{"patil_taillie_entropy", "non_disparity_functions"},
+	{"q_logarithmic_entropy", "non_disparity_functions"},
+	{"simpson_index", "non_disparity_functions"},
+	{"simpson_dominance_index", "non_disparity_functions"},
+	{"hill_number_standard", "non_disparity_functions"},
+	{"hill_evenness", "non_disparity_functions"},
+	{"berger_parker_index", "non_disparity_functions"},
+	{"junge1994_page22", "non_disparity_functions"},
+	{"brillouin_diversity", "non_disparity_functions"},
+	{"mcintosh_index", "non_disparity_functions"},
+	{"sw_entropy_over_log_n_species_pielou1975", "non_disparity_functions"},
+	{"sw_e_heip", "non_disparity_functions"},
+	{"sw_e_one_minus_d", "non_disparity_functions"},
+	{"sw_e_one_over_ln_d_williams1964", "non_disparity_functions"},
+	{"sw_e_minus_ln_d_pielou1977", "non_disparity_functions"},
+	{"sw_f_2_1_alatalo1981", "non_disparity_functions"},
+	{"sw_g_2_1_molinari1989", "non_disparity_functions"},
+	{"sw_e_bulla1994", "non_disparity_functions"},
+	{"sw_o_bulla1994", "non_disparity_functions"},
+	{"sw_e_mci_pielou1969", "non_disparity_functions"},
+	{"sw_e_prime_camargo1993", "non_disparity_functions"},
+	{"sw_e_var_smith_and_wilson1996_original", "non_disparity_functions"},
+};
+
+static const struct measurement_serve_function * measurement_serve_find_function(const char * const name){
+	for(size_t k = 0 ; k < sizeof(measurement_serve_functions) / sizeof(measurement_serve_functions[0]) ; k++){
+		if(strcmp(measurement_serve_functions[k].name, name) == 0){return &(measurement_serve_functions[k]);}
+	}
+	return NULL;
+}
+
+// a job may only list the functions of measurement_serve_functions
+int32_t measurement_serve_check(struct serve_job * const job, void * const arg){
+	(void) arg;
+	for(int32_t k = 0 ; k < job->num_functions ; k++){
+		if(measurement_serve_find_function(job->functions[k]) == NULL){
+			snprintf(job->error, SERVE_ERROR_SIZE, "unknown function: %.200s", job->functions[k]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// without a list, the job keeps what the server enables; with one, a family is enabled along with any of its functions
+static uint8_t measurement_serve_enabled(const struct serve_job * const job, const char * const name, const uint8_t enabled_by_server){
+	if(job->functions == NULL){return enabled_by_server;}
+	for(int32_t k = 0 ; k < job->num_functions ; k++){
+		const struct measurement_serve_function * const f = measurement_serve_find_function(job->functions[k]);
+		if(strcmp(f->name, name) == 0 || (f->family != NULL && strcmp(f->family, name) == 0)){return 1;}
+	}
+	return 0;
+}
+
+#define MEASUREMENT_SERVE_ENABLE(name) .name = measurement_serve_enabled(job, #name, mcfg->enable.name)
+
+// one job: the configuration of the server, with the input list, outputs and functions of the job
+int32_t measurement_serve_job(struct serve_job * const job, void * const arg){
+	const struct measurement_serve_context * const context = (const struct measurement_serve_context *) arg;
+	const struct measurement_configuration * const mcfg = context->mcfg;
+
+	// again, for servers created without it: measurement_serve_enabled only knows the listed functions
+	if(measurement_serve_check(job, arg) != 0){return 1;}
+
+	const struct measurement_progress progress = {
+		.file_done = serve_job_file_done,
+		.ctx = job,
+	};
+	struct measurement_configuration job_mcfg = {
+		.target_column = mcfg->target_column,
+		.enable_token_utf8_normalisation = mcfg->enable_token_utf8_normalisation,
+		.jsonl_content_key = mcfg->jsonl_content_key,
+		.div_param = mcfg->div_param,
+		.enable = (struct measurement_diversity_enabler) {
+			MEASUREMENT_SERVE_ENABLE(stirling),
+			MEASUREMENT_SERVE_ENABLE(ricotta_szeidl),
+			MEASUREMENT_SERVE_ENABLE(pairwise),
+			MEASUREMENT_SERVE_ENABLE(lexicographic),
+			MEASUREMENT_SERVE_ENABLE(chao_et_al_functional_diversity),
+			MEASUREMENT_SERVE_ENABLE(scheiner_species_phylogenetic_functional_diversity),
+			MEASUREMENT_SERVE_ENABLE(leinster_cobbold_diversity),
+			MEASUREMENT_SERVE_ENABLE(functional_evenness),
+			MEASUREMENT_SERVE_ENABLE(mst),
+			MEASUREMENT_SERVE_ENABLE(functional_dispersion),
+			MEASUREMENT_SERVE_ENABLE(functional_divergence_modified),
+			MEASUREMENT_SERVE_ENABLE(non_disparity_functions),
+			MEASUREMENT_SERVE_ENABLE(disparity_functions),
+			MEASUREMENT_SERVE_ENABLE(shannon_weaver_entropy),
+			MEASUREMENT_SERVE_ENABLE(good_entropy),
+			MEASUREMENT_SERVE_ENABLE(renyi_entropy),
+			MEASUREMENT_SERVE_ENABLE(patil_taillie_entropy),
+			MEASUREMENT_SERVE_ENABLE(q_logarithmic_entropy),
+			MEASUREMENT_SERVE_ENABLE(simpson_index),
+			MEASUREMENT_SERVE_ENABLE(simpson_dominance_index),
+			MEASUREMENT_SERVE_ENABLE(hill_number_standard),
+			MEASUREMENT_SERVE_ENABLE(hill_evenness),
+			MEASUREMENT_SERVE_ENABLE(berger_parker_index),
+			MEASUREMENT_SERVE_ENABLE(junge1994_page22),
+			MEASUREMENT_SERVE_ENABLE(brillouin_diversity),
+			MEASUREMENT_SERVE_ENABLE(mcintosh_index),
+			MEASUREMENT_SERVE_ENABLE(sw_entropy_over_log_n_species_pielou1975),
+			MEASUREMENT_SERVE_ENABLE(sw_e_heip),
+			MEASUREMENT_SERVE_ENABLE(sw_e_one_minus_d),
+			MEASUREMENT_SERVE_ENABLE(sw_e_one_over_ln_d_williams1964),
+			MEASUREMENT_SERVE_ENABLE(sw_e_minus_ln_d_pielou1977),
+			MEASUREMENT_SERVE_ENABLE(sw_f_2_1_alatalo1981),
+			MEASUREMENT_SERVE_ENABLE(sw_g_2_1_molinari1989),
+			MEASUREMENT_SERVE_ENABLE(sw_e_bulla1994),
+			MEASUREMENT_SERVE_ENABLE(sw_o_bulla1994),
+			MEASUREMENT_SERVE_ENABLE(sw_e_mci_pielou1969),
+			MEASUREMENT_SERVE_ENABLE(sw_e_prime_camargo1993),
+			MEASUREMENT_SERVE_ENABLE(sw_e_var_smith_and_wilson1996_original),
+		},
+		.io = (struct measurement_io) {
+			.w2v_path = mcfg->io.w2v_path,
+			.jsonl_content_key = mcfg->io.jsonl_content_key,
+			.input_path = job->input_path,
+			.input_path_tp = job->input_path_tp,
+			.output_path = job->output_path,
+			.output_path_timing = job->output_path_timing,
+			.output_path_memory = job->output_path_memory,
+			.udpipe_model_path = mcfg->io.udpipe_model_path,
+			.output_format = mcfg->io.output_format,
+			.output_compression = mcfg->io.output_compression,
+			.output_row_group_size = mcfg->io.output_row_group_size,
+			.enable_timings = mcfg->io.enable_timings,
+			.enable_output_timing = mcfg->io.enable_output_timing && job->output_path_timing != NULL,
+			.enable_output_memory = mcfg->io.enable_output_memory && job->output_path_memory != NULL,
+			.progress = &progress,
+			.error = job->error,
+			.error_size = SERVE_ERROR_SIZE,
+		},
+		.threading = mcfg->threading,
+		.steps = mcfg->steps,
+		.oov_memory_cap = mcfg->oov_memory_cap,
+		.checkpoint = (struct measurement_checkpoint) {
+			.path = "",
+		},
+		.shard = (struct measurement_shard) {
+			.output_path = "",
+			.input_path = "",
+		},
+	};
+
+	job->error[0] = '\0';
+	if(measurement_corpus(&job_mcfg, context->w2v, NULL, 0) != 0){
+		if(job->error[0] == '\0'){snprintf(job->error, SERVE_ERROR_SIZE, "failed to measure %.200s", job->input_path);}
+		return 1;
+	}
+	return 0;
+}
+
+// the word2vec stays loaded between the jobs sent to the socket, until one of them asks for a shutdown
+int32_t measurement_serve_socket(struct measurement_configuration * const mcfg, struct word2vec * const w2v){
+	struct measurement_serve_context context = {
+		.mcfg = mcfg,
+		.w2v = w2v,
+	};
+	struct serve s;
+
+	if(create_serve(&s, mcfg->serve.path, mcfg->serve.num_jobs, mcfg->serve.queue_size, measurement_serve_job, measurement_serve_check, &context) != 0){
+		perror("failed to call create_serve\n");
+		return 1;
+	}
+	const int32_t result = serve_run(&s);
+	free_serve(&s);
+	return result;
+}
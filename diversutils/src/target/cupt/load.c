@@ -33,11 +33,14 @@
 #include <string.h>
 
 #include "graph.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
 #include "cupt/parser.h"
 #include "cupt/load.h"
 #include "distributions.h"
 #include "measurement.h"
+#include "checkpoint.h"
+#include "recompute.h"
+#include "schedule.h"
 #include "logging.h"
 #include "unicode/utf8.h"
 
@@ -52,10 +55,20 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
         if(create_cupt_sentence_iterator(&csi_tp, filename_tp, ec_cfg) != 0){goto failure_create_cupt_sentence_iterator;}
     }
 
+    int8_t found_at_least_one_mwe = 0;
+
+    // the sentences before the resume point were read by the run that wrote the checkpoint
+    if(sref->checkpoint != NULL){
+        int64_t offset = 0;
+        int64_t offset_tp = 0;
+        checkpoint_file_resume_point(sref->checkpoint, (int32_t) i, &offset, &offset_tp, &found_at_least_one_mwe);
+        if(offset > 0 && fseek(csi.file_ptr, (long) offset, SEEK_SET) != 0){goto failure_seek;}
+        if(filename_tp != NULL && offset_tp > 0 && fseek(csi_tp.file_ptr, (long) offset_tp, SEEK_SET) != 0){goto failure_seek;}
+    }
+
     if(iterate_cupt_sentence_iterator(&csi) != 0){goto failure_iterate_cupt_sentence_iterator;}
     if(filename_tp != NULL){if(iterate_cupt_sentence_iterator(&csi_tp) != 0){goto failure_iterate_cupt_sentence_iterator;}}
 
-    int8_t found_at_least_one_mwe = 0;
     while(!(csi.file_is_done)){
         const size_t max_mwe = 32;
 		const size_t max_tokens_per_mwe = 32;
@@ -129,7 +142,6 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
 
 
     		int32_t index;
-    		int32_t index_in_discarded = -1;
     		const size_t key_size = 256;
     		char key[key_size];
     		memset(key, '\0', key_size);
@@ -204,65 +216,16 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
 			index = word2vec_key_to_index(sref->w2v, key);
 	
 			if(index != -1){
-                pthread_mutex_lock(&(sref->w2v->keys[index].mutex));
-				if(sref->w2v->keys[index].active_in_current_graph == 0){
-					sref->w2v->keys[index].active_in_current_graph = 1;
-					// num_nodes++;
-	
-                            pthread_mutex_lock(&(sref->g->mutex_nodes));
-					if(sref->g->num_nodes == sref->g->capacity){
-						if(request_more_capacity_graph(sref->g) != 0){
-							perror("failed to call request_more_capacity_graph\n");
-							return 1;
-						}
-					}
-					struct graph_node local_node = {0};
-					if(create_graph_node(&local_node, sref->g->nodes[0].num_dimensions, FP32) != 0){
-						perror("failed to call create_graph_node\n");
-						return 1;
-					}
-					local_node.word2vec_entry_pointer = &(sref->w2v->keys[index]);
-					local_node.vector.fp32 = sref->w2v->keys[index].vector;
-	
-					local_node.num_dimensions = sref->w2v->num_dimensions;
-					local_node.already_considered = 0;
-					local_node.relative_proportion = 1.0;
-					local_node.absolute_proportion = 1;
-					sref->g->nodes[sref->g->num_nodes] = local_node;
-					sref->w2v->keys[index].graph_node_pointer = &(sref->g->nodes[sref->g->num_nodes]);
-					sref->w2v->keys[index].graph_node_index = sref->g->num_nodes;
-					sref->g->num_nodes++;
-                            pthread_mutex_unlock(&(sref->g->mutex_nodes));
-				} else {
-                            pthread_mutex_lock(&(sref->g->nodes[sref->w2v->keys[index].graph_node_index].mutex_local_node));
-					sref->g->nodes[sref->w2v->keys[index].graph_node_index].absolute_proportion++;
-                            pthread_mutex_unlock(&(sref->g->nodes[sref->w2v->keys[index].graph_node_index].mutex_local_node));
+				if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+					perror("failed to call graph_add_word2vec_occurrence\n");
+					return 1;
 				}
-				sref->w2v->keys[index].num_occurrences++; // ? mutex ?
-                        pthread_mutex_unlock(&(sref->w2v->keys[index].mutex));
+				__atomic_fetch_add(&(sref->w2v->keys[index].num_occurrences), 1, __ATOMIC_RELAXED);
 			} else {
-                pthread_mutex_lock(&(sref->sorted_array_discarded_because_not_in_vector_database->mutex));
-			    index_in_discarded = key_to_index_sorted_array(sref->sorted_array_discarded_because_not_in_vector_database, key); // before, was in upper level
-				if(index_in_discarded == -1){
-					struct sorted_array_str_int_element elem;
-                    if(create_sorted_array_str_int_element(&elem) != 0){
-                        perror("failed to call create_sorted_array_str_int_element\n");
-                        return 1;
-                    }
-					size_t bytes_to_cpy = strlen(key);
-					if(bytes_to_cpy > SORTED_ARRAY_DEFAULT_KEY_SIZE - 1){
-						bytes_to_cpy = SORTED_ARRAY_DEFAULT_KEY_SIZE - 1;
-					}
-					memcpy(&elem.key, key, bytes_to_cpy);
-					elem.value = 1;
-					if(insert_sorted_array(sref->sorted_array_discarded_because_not_in_vector_database, &elem, 0) != 0){
-						perror("failed to call insert_sorted_array\n");
-						return 1;
-					}
-				} else {
-					((struct sorted_array_str_int_element*) sref->sorted_array_discarded_because_not_in_vector_database->bfr)[index_in_discarded].value++;
-				}
-                pthread_mutex_unlock(&(sref->sorted_array_discarded_because_not_in_vector_database->mutex));
+                if(oov_counter_increment(sref->oov_discarded_because_not_in_vector_database, key) != 0){
+                    perror("failed to call oov_counter_increment\n");
+                    return 1;
+                }
 			}
         }
 
@@ -336,66 +299,16 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
 				if(index != -1){
 					found_at_least_one_mwe = 1;
                     
-                    pthread_mutex_lock(&sref->w2v->keys[index].mutex);
-                    pthread_mutex_lock(&sref->g->mutex_nodes);
-
-					if(sref->w2v->keys[index].active_in_current_graph == 0){
-						sref->w2v->keys[index].active_in_current_graph = 1;
-
-						if(sref->g->num_nodes == sref->g->capacity){
-							int32_t err = request_more_capacity_graph(sref->g);
-							if(err != 0){
-								perror("failed to call request_more_capacity_graph\n");
-								return 1;
-							}
-						}
-						struct graph_node local_graph_node = {0};
-    					if(create_graph_node(&local_graph_node, sref->g->nodes[0].num_dimensions, FP32) != 0){ // copied and modified from above
-    						perror("failed to call create_graph_node\n");
-    						return 1;
-    					}
-						local_graph_node.num_dimensions = (int16_t) sref->w2v->num_dimensions;
-						local_graph_node.already_considered = 0;
-						local_graph_node.relative_proportion = 1.0;
-						local_graph_node.absolute_proportion = 1;
-						local_graph_node.vector.fp32 = sref->w2v->keys[index].vector;
-						local_graph_node.word2vec_entry_pointer = &(sref->w2v->keys[index]);
-						sref->g->nodes[sref->g->num_nodes] = local_graph_node;
-						sref->w2v->keys[index].graph_node_pointer = &(sref->g->nodes[sref->g->num_nodes]);
-						sref->w2v->keys[index].graph_node_index = sref->g->num_nodes;
-						sref->g->num_nodes++;
-					} else {
-						sref->g->nodes[sref->w2v->keys[index].graph_node_index].absolute_proportion++;
+					if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+						perror("failed to call graph_add_word2vec_occurrence\n");
+						return 1;
 					}
-
-                    pthread_mutex_unlock(&sref->g->mutex_nodes);
-                    pthread_mutex_unlock(&sref->w2v->keys[index].mutex);
-
-					sref->w2v->keys[index].num_occurrences++;
+					__atomic_fetch_add(&(sref->w2v->keys[index].num_occurrences), 1, __ATOMIC_RELAXED);
 				} else {
-                    pthread_mutex_lock(&sref->sorted_array_discarded_because_not_in_vector_database->mutex);
-					int32_t index_in_discarded = key_to_index_sorted_array(sref->sorted_array_discarded_because_not_in_vector_database, bfr);
-
-					if(index_in_discarded == -1){
-						struct sorted_array_str_int_element elem;
-                        if(create_sorted_array_str_int_element(&elem) != 0){
-                            perror("failed to call create_sorted_array_str_int_element\n");
-                            return 1;
-                        }
-						size_t bytes_to_cpy = strlen(bfr);
-						if(bytes_to_cpy > SORTED_ARRAY_DEFAULT_KEY_SIZE - 1){
-							bytes_to_cpy = SORTED_ARRAY_DEFAULT_KEY_SIZE - 1;
-						}
-						memcpy(&elem.key, bfr, bytes_to_cpy);
-						elem.value = 1;
-						if(insert_sorted_array(sref->sorted_array_discarded_because_not_in_vector_database, &elem, 0) != 0){
-							perror("failed to call insert_sorted_array\n");
-							return 1;
-						}
-					} else {
-						((struct sorted_array_str_int_element*) sref->sorted_array_discarded_because_not_in_vector_database->bfr)[index_in_discarded].value++;
-					}
-                    pthread_mutex_unlock(&sref->sorted_array_discarded_because_not_in_vector_database->mutex);
+                    if(oov_counter_increment(sref->oov_discarded_because_not_in_vector_database, bfr) != 0){
+                        perror("failed to call oov_counter_increment\n");
+                        return 1;
+                    }
 				}
                 // pthread_mutex_unlock(&sref->w2v->mutex);
 			}
@@ -432,37 +345,31 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
         pthread_mutex_lock(&sref->g->mutex_nodes);
 		// sentence level recomputation
 		// if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.sentence.enable_count_recompute_step && (((!mcfg->steps.sentence.use_log10) && mmut->sentence.num % mcfg->steps.sentence.recompute_step == 0) || (mcfg->steps.sentence.use_log10 && mmut->sentence.num >= mmut->sentence.count_target))) && sref->g->num_nodes > 1){ // DO NOT REMOVE
-		if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.sentence.enable_count_recompute_step && (((!mcfg->steps.sentence.use_log10) && mmut->sentence.num_all % mcfg->steps.sentence.recompute_step == 0) || (mcfg->steps.sentence.use_log10 && mmut->sentence.num_all >= mmut->sentence.count_target))) && sref->g->num_nodes > 1){
+		if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.sentence.enable_count_recompute_step && (((!mcfg->steps.sentence.use_log10) && (!mcfg->steps.sentence.use_adaptive) && mmut->sentence.num_all % mcfg->steps.sentence.recompute_step == 0) || ((mcfg->steps.sentence.use_log10 || mcfg->steps.sentence.use_adaptive) && mmut->sentence.num_all >= mmut->sentence.count_target))) && sref->g->num_nodes > 1){
 			// printf("found_at_least_one_mwe: %i; g->num_nodes: %lu\n", found_at_least_one_mwe, sref->g->num_nodes);
                     memset(log_bfr, '\0', log_bfr_size);
 			snprintf(log_bfr, log_bfr_size, "found_at_least_one_mwe: %i; g->num_nodes: %lu", found_at_least_one_mwe, sref->g->num_nodes);
                     info_format(__FILE__, __func__, __LINE__, log_bfr);
 
-                    compute_graph_relative_proportions(sref->g);
-		
-			int32_t err = zipfian_fit_from_graph(sref->g, &mmut->best_s);
-			if(err != 0){
-				perror("failed to call zipfian_fit_from_graph\n");
-				goto panic_exit;
-			}
-		
-			if(mmut->best_s != mmut->prev_best_s || sref->g->num_nodes != ((uint64_t) mmut->prev_num_nodes)){
-				memset(log_bfr, '\0', log_bfr_size);
-				// snprintf(log_bfr, log_bfr_size, "best_s: %f; num_nodes: %lu; num_sentences: %li; num_documents: %li", mmut->best_s, sref->g->num_nodes, mmut->sentence.num, mmut->document.num); // DO NOT REMOVE
-				snprintf(log_bfr, log_bfr_size, "best_s: %f; num_nodes: %lu; num_sentences: %lu; num_documents: %lu", mmut->best_s, sref->g->num_nodes, mmut->sentence.num_all, mmut->document.num_all);
-				info_format(__FILE__, __func__, __LINE__, log_bfr);
-
-                        err = apply_diversity_functions_to_graph(i, mcfg, sref, mmut);
-				if(err != 0){
-					perror("failed to call apply_diversity_functions_to_graph\n");
-					return 1;
-				}
-				mmut->prev_best_s = mmut->best_s;
-			} else { // end of comparison best_s?
-				printf("ignoring because best_s (%.12f) == previous_best_s (%.12f) && g->num_nodes (%lu) == previous_g_num_nodes (%li)\n", mmut->best_s, mmut->prev_best_s, sref->g->num_nodes, mmut->prev_num_nodes);
-			}
+                    if(sref->recompute != NULL){
+                        if(recompute_worker_submit(sref->recompute, i, sref->g, mmut, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), 0) != 0){
+                            perror("failed to call recompute_worker_submit\n");
+                            goto panic_exit;
+                        }
+                    } else {
+                        mmut->num_oov_types = oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database);
+                        if(compute_graph_relative_proportions(sref->g) != 0 || measurement_recompute_step(i, mcfg, sref, mmut, 0) != 0){
+                            perror("failed to call measurement_recompute_step\n");
+                            goto panic_exit;
+                        }
+                    }
 
-			if(mcfg->steps.sentence.use_log10){
+			if(mcfg->steps.sentence.use_adaptive){
+				mmut->sentence.count_target = recompute_schedule_next(sref->schedule, &(sref->schedule->sentence), mmut->sentence.num_all, sref->g->num_nodes, recompute_schedule_now(), sref->recompute == NULL, mcfg->steps.sentence.use_log10 ? mcfg->steps.sentence.recompute_step_log10 : 0.0);
+                        memset(log_bfr, '\0', log_bfr_size);
+				snprintf(log_bfr, log_bfr_size, "New sentence count target: %lu (adaptive)", mmut->sentence.count_target);
+                        info_format(__FILE__, __func__, __LINE__, log_bfr);
+			} else if(mcfg->steps.sentence.use_log10){
 				mmut->sentence.stacked_log += mcfg->steps.sentence.recompute_step_log10;
 				mmut->sentence.count_target = (uint64_t) floor(pow(10.0, mmut->sentence.stacked_log));
                         memset(log_bfr, '\0', log_bfr_size);
@@ -476,6 +383,8 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
 
         pthread_mutex_unlock(&mmut->mutex);
 
+        if(sref->checkpoint != NULL){checkpoint_unit_done(sref->checkpoint, (int32_t) i, (int64_t) ftell(csi.file_ptr), filename_tp != NULL ? (int64_t) ftell(csi_tp.file_ptr) : -1, found_at_least_one_mwe);}
+
 
         if(iterate_cupt_sentence_iterator(&csi) != 0){goto failure_iterate_cupt_sentence_iterator;}
         if(filename_tp != NULL){if(iterate_cupt_sentence_iterator(&csi_tp) != 0){goto failure_iterate_cupt_sentence_iterator;}}
@@ -490,6 +399,10 @@ int32_t cupt_to_graph(const uint64_t i, const char * const filename, const char
     perror("failed to call iterate_cupt_sentence_iterator\n");
     goto panic_exit;
 
+    failure_seek:
+    fprintf(stderr, "failed to seek to the resume point of %s\n", filename);
+    goto panic_exit;
+
     failure_create_cupt_sentence_iterator:
     perror("failed to call create_cupt_sentence_iterator\n");
 
@@ -26,6 +26,7 @@
  */
 
 #include <math.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,12 +50,215 @@ double q_logarithm(const double x, const double q){
 	}
 }
 
-void shannon_weaver_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number){
-	double loc_res = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		if(g->nodes[i].relative_proportion <= 0.0){continue;}
-		loc_res += g->nodes[i].relative_proportion * (log(g->nodes[i].relative_proportion) / log(LOGARITHMIC_BASE));
+/* ======== MEMO ======== */
+
+struct dfunctions_memo_thread_args {
+	const struct graph* g;
+	uint64_t start;
+	uint64_t end;
+	uint32_t primitives;
+	uint32_t first_order;
+	uint32_t num_orders;
+	double log_mean; // for LOG_VARIANCE
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+};
+
+// one pass over [start, end) for every requested primitive; the terms are those of the original loops, so that a single chunk gives the same sums
+static void* dfunctions_memo_thread(void* args){
+	struct dfunctions_memo_thread_args* const a = (struct dfunctions_memo_thread_args*) args;
+	const struct graph_snapshot* const s = &(a->g->snapshot);
+	const uint32_t primitives = a->primitives;
+	const double n = (double) a->g->snapshot.num_nodes;
+	const double division = 1.0 / n;
+	double sum_p_log_p = 0.0;
+	double sum_squares = 0.0;
+	double sum = 0.0;
+	double max = -INFINITY;
+	double sum_min_even = 0.0;
+	double log_mean = 0.0;
+	double log_variance = 0.0;
+	double tokens = 0.0;
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS] = {0.0};
+
+	for(uint64_t i = a->start ; i < a->end ; i++){
+		const double p = s->relative_proportions[i];
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P)){
+			if(p > 0.0){sum_p_log_p += p * (log(p) / NORMALISATION_BASE);}
+		}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES)){sum_squares += pow(p, 2.0);}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM)){sum += p;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_MAX)){
+			if(p > max){max = p;}
+		}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN)){sum_min_even += p < division ? p : division;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN)){log_mean += (log(p) / NORMALISATION_BASE) / n;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE)){log_variance += pow((log(p) / NORMALISATION_BASE) - a->log_mean, 2.0) / n;}
+		if(primitives & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_TOKENS)){tokens += (double) s->absolute_proportions[i];}
+		for(uint32_t k = 0 ; k < a->num_orders ; k++){
+			power_sums[k] += pow(p, s->memo.orders[a->first_order + k]);
+		}
+	}
+
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P] = sum_p_log_p;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES] = sum_squares;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM] = sum;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_MAX] = max;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN] = sum_min_even;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN] = log_mean;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE] = log_variance;
+	a->values[GRAPH_SNAPSHOT_PRIMITIVE_TOKENS] = tokens;
+	for(uint32_t k = 0 ; k < a->num_orders ; k++){a->power_sums[k] = power_sums[k];}
+
+	return NULL;
+}
+
+// computes the primitives and the orders [first_order, num_orders) of the memo into values and power_sums, merging the chunks in order so that the result does not depend on scheduling
+static int32_t dfunctions_memo_run(const struct graph* const g, const uint32_t primitives, const uint32_t first_order, const double log_mean, const int16_t num_threads, double* const values, double* const power_sums){
+	const uint64_t num_nodes = g->snapshot.num_nodes;
+	int16_t num_threads_used = num_threads < 1 ? 1 : num_threads;
+	if(((uint64_t) num_threads_used) * DFUNCTIONS_MEMO_MIN_NODES_PER_THREAD > num_nodes){
+		num_threads_used = (int16_t) (num_nodes / DFUNCTIONS_MEMO_MIN_NODES_PER_THREAD);
+		if(num_threads_used < 1){num_threads_used = 1;}
+	}
+
+	struct dfunctions_memo_thread_args args[num_threads_used];
+	pthread_t threads[num_threads_used];
+	int16_t num_created = 0;
+	int32_t result = 0;
+	uint64_t start = 0;
+	for(int16_t k = 0 ; k < num_threads_used ; k++){
+		uint64_t end = start + num_nodes / ((uint64_t) num_threads_used);
+		if(((uint64_t) k) < num_nodes % ((uint64_t) num_threads_used)){end++;}
+		args[k] = (struct dfunctions_memo_thread_args) {
+			.g = g,
+			.start = start,
+			.end = end,
+			.primitives = primitives,
+			.first_order = first_order,
+			.num_orders = g->snapshot.memo.num_orders - first_order,
+			.log_mean = log_mean,
+		};
+		start = end;
+	}
+
+	if(num_threads_used == 1){
+		dfunctions_memo_thread(&(args[0]));
+	} else {
+		for(int16_t k = 0 ; k < num_threads_used ; k++){
+			if(pthread_create(&(threads[k]), NULL, dfunctions_memo_thread, &(args[k])) != 0){
+				perror("failed to create memo thread\n");
+				result = 1;
+				break;
+			}
+			num_created++;
+		}
+		for(int16_t k = 0 ; k < num_created ; k++){
+			if(pthread_join(threads[k], NULL) != 0){
+				perror("failed to join memo thread\n");
+				result = 1;
+			}
+		}
+		if(result != 0){return 1;}
+	}
+
+	for(uint32_t primitive = 0 ; primitive < GRAPH_SNAPSHOT_NUM_PRIMITIVES ; primitive++){
+		values[primitive] = primitive == GRAPH_SNAPSHOT_PRIMITIVE_MAX ? -INFINITY : 0.0;
+	}
+	for(uint32_t k = 0 ; k < args[0].num_orders ; k++){power_sums[k] = 0.0;}
+	for(int16_t t = 0 ; t < num_threads_used ; t++){
+		for(uint32_t primitive = 0 ; primitive < GRAPH_SNAPSHOT_NUM_PRIMITIVES ; primitive++){
+			if(primitive == GRAPH_SNAPSHOT_PRIMITIVE_MAX){
+				if(args[t].values[primitive] > values[primitive]){values[primitive] = args[t].values[primitive];}
+			} else {
+				values[primitive] += args[t].values[primitive];
+			}
+		}
+		for(uint32_t k = 0 ; k < args[t].num_orders ; k++){power_sums[k] += args[t].power_sums[k];}
+	}
+
+	return 0;
+}
+
+void dfunctions_memo_request(struct graph* const g, const uint32_t needs){
+	g->snapshot.memo.requested |= needs;
+}
+
+// alpha == 1.0 stands for the Shannon-Weaver entropy, whose primitive is requested instead
+void dfunctions_memo_request_order(struct graph* const g, const double alpha){
+	struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	if(alpha == 1.0){
+		memo->requested |= DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P);
+		return;
+	}
+	for(uint32_t k = 0 ; k < memo->num_orders ; k++){
+		if(memo->orders[k] == alpha){return;}
+	}
+	// further orders are simply recomputed by their functions
+	if(memo->num_orders < GRAPH_SNAPSHOT_MEMO_MAX_ORDERS){
+		memo->orders[memo->num_orders] = alpha;
+		memo->num_orders++;
 	}
+}
+
+// computes whatever was requested since the last refresh and is not known yet: every primitive that does not depend on another is gathered in one parallel pass, then LOG_VARIANCE in a second one
+int32_t dfunctions_memo_compute(struct graph* const g, const int16_t num_threads){
+	struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+
+	if(memo->requested & DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE)){memo->requested |= DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN);}
+
+	const uint32_t first_pass = memo->requested & ~(memo->computed) & ~DFUNCTIONS_NEEDS(GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE);
+	if(first_pass != 0 || memo->num_orders_computed < memo->num_orders){
+		if(dfunctions_memo_run(g, first_pass, memo->num_orders_computed, 0.0, num_threads, values, power_sums) != 0){return 1;}
+		for(uint32_t primitive = 0 ; primitive < GRAPH_SNAPSHOT_NUM_PRIMITIVES ; primitive++){
+			if(first_pass & DFUNCTIONS_NEEDS(primitive)){memo->values[primitive] = values[primitive];}
+		}
+		for(uint32_t k = memo->num_orders_computed ; k < memo->num_orders ; k++){memo->power_sums[k] = power_sums[k - memo->num_orders_computed];}
+		memo->computed |= first_pass;
+		memo->num_orders_computed = memo->num_orders;
+	}
+
+	const uint32_t second_pass = memo->requested & ~(memo->computed);
+	if(second_pass != 0){
+		if(dfunctions_memo_run(g, second_pass, memo->num_orders, memo->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN], num_threads, values, power_sums) != 0){return 1;}
+		memo->values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE] = values[GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE];
+		memo->computed |= second_pass;
+	}
+
+	return 0;
+}
+
+// the memoised value when there is one, otherwise a sequential pass over the snapshot, which gives the same value bit for bit
+static double dfunctions_primitive(const struct graph* const g, const enum graph_snapshot_primitive primitive){
+	const struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	double values[GRAPH_SNAPSHOT_NUM_PRIMITIVES];
+	double power_sums[GRAPH_SNAPSHOT_MEMO_MAX_ORDERS];
+	double log_mean = 0.0;
+
+	if(memo->computed & DFUNCTIONS_NEEDS(primitive)){return memo->values[primitive];}
+	if(primitive == GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE){log_mean = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_LOG_MEAN);}
+	dfunctions_memo_run(g, DFUNCTIONS_NEEDS(primitive), memo->num_orders, log_mean, 1, values, power_sums);
+	return values[primitive];
+}
+
+static double dfunctions_power_sum(const struct graph* const g, const double alpha){
+	const struct graph_snapshot_memo* const memo = &(g->snapshot.memo);
+	for(uint32_t k = 0 ; k < memo->num_orders_computed ; k++){
+		if(memo->orders[k] == alpha){return memo->power_sums[k];}
+	}
+	double sum = 0.0;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		sum += pow(g->snapshot.relative_proportions[i], alpha);
+	}
+	return sum;
+}
+
+/* ======== FUNCTIONS ======== */
+
+void shannon_weaver_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number){
+	double loc_res = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_P_LOG_P);
 	loc_res *= -1.0;
 	(*res_entropy) = loc_res;
 	(*res_hill_number) = pow(LOGARITHMIC_BASE, loc_res);
@@ -62,8 +266,8 @@ void shannon_weaver_entropy_from_graph(const struct graph* const g, double* cons
 
 void good_entropy_from_graph(const struct graph* const g, double* const res, double alpha, double beta){
 	double loc_res = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		loc_res += pow(g->nodes[i].relative_proportion, alpha) * pow(-log(g->nodes[i].relative_proportion) / log(LOGARITHMIC_BASE), beta);
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		loc_res += pow(g->snapshot.relative_proportions[i], alpha) * pow(-log(g->snapshot.relative_proportions[i]) / log(LOGARITHMIC_BASE), beta);
 	}
 	(*res) = loc_res;
 }
@@ -72,10 +276,7 @@ void renyi_entropy_from_graph(const struct graph* const g, double* const res_ent
 	if(alpha == 1.0){
 		shannon_weaver_entropy_from_graph(g, res_entropy, res_hill_number);
 	} else {
-		double loc_res = 1.0e-300;
-		for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-			loc_res += pow(g->nodes[i].relative_proportion, alpha);
-		}
+		double loc_res = 1.0e-300 + dfunctions_power_sum(g, alpha);
 		loc_res = (1.0 / (1.0 - alpha)) * (log(loc_res) / log(LOGARITHMIC_BASE));
 		(*res_entropy) = loc_res;
 		(*res_hill_number) = pow(LOGARITHMIC_BASE, loc_res);
@@ -87,8 +288,8 @@ void patil_taillie_entropy_from_graph(const struct graph* const g, double* const
 		shannon_weaver_entropy_from_graph(g, res_entropy, res_hill_number);
 	} else {
 		double loc_res = 1.0;
-		for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-			loc_res -= pow(g->nodes[i].relative_proportion, alpha + 1.0);
+		for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+			loc_res -= pow(g->snapshot.relative_proportions[i], alpha + 1.0);
 		}
 		loc_res /= alpha;
 		(*res_entropy) = loc_res;
@@ -98,8 +299,8 @@ void patil_taillie_entropy_from_graph(const struct graph* const g, double* const
 
 void q_logarithmic_entropy_from_graph(const struct graph* const g, double* const res_entropy, double* const res_hill_number, double q){
 	double loc_res = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		loc_res += g->nodes[i].relative_proportion * q_logarithm(1.0 / g->nodes[i].relative_proportion, q);
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		loc_res += g->snapshot.relative_proportions[i] * q_logarithm(1.0 / g->snapshot.relative_proportions[i], q);
 	}
 	(*res_entropy) = loc_res;
 	if(q == 1.0){
@@ -110,11 +311,7 @@ void q_logarithmic_entropy_from_graph(const struct graph* const g, double* const
 }
 
 void simpson_dominance_index_from_graph(const struct graph* const g, double* const res){
-	double loc_res = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		loc_res += pow(g->nodes[i].relative_proportion, 2.0);
-	}
-	(*res) = loc_res;
+	(*res) = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
 }
 
 void simpson_index_from_graph(const struct graph* const g, double* const res){
@@ -124,11 +321,11 @@ void simpson_index_from_graph(const struct graph* const g, double* const res){
 }
 
 void richness_from_graph(const struct graph* const g, double* const res){
-	(*res) = (double) g->num_nodes;
+	(*res) = (double) g->snapshot.num_nodes;
 }
 
 void species_count_from_graph(const struct graph* const g, double* const res){
-	(*res) = ((double) g->num_nodes) - 1.0;
+	(*res) = ((double) g->snapshot.num_nodes) - 1.0;
 }
 
 void hill_number_standard_from_graph(const struct graph* const g, double* const res, double alpha){
@@ -147,29 +344,20 @@ void hill_evenness_from_graph(const struct graph* const g, double* const res, do
 }
 
 void berger_parker_index_from_graph(const struct graph* const g, double* const res){
-	double loc_res = g->nodes[0].relative_proportion;
-	for(uint64_t i = 1 ; i < g->num_nodes ; i++){
-		if(g->nodes[i].relative_proportion > loc_res){
-			loc_res = g->nodes[i].relative_proportion;
-		}
-	}
-	(*res) = loc_res;
+	(*res) = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_MAX);
 }
 
 void shannon_evenness_from_graph(const struct graph* const g, double* const res){
 	double sw_entropy;
 	double hill_number;
 	shannon_weaver_entropy_from_graph(g, &sw_entropy, &hill_number);
-	double max_entropy = log((double) g->num_nodes) / log(LOGARITHMIC_BASE);
+	double max_entropy = log((double) g->snapshot.num_nodes) / log(LOGARITHMIC_BASE);
 	(*res) = sw_entropy / max_entropy;
 }
 
 
 void junge1994_page22_from_graph(const struct graph* const g, double *res){
-	double sum = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		sum += pow(g->nodes[i].relative_proportion, 2.0);
-	}
+	const double sum = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
 	(*res) = 1.0 - pow(sum, 0.5);
 }
 
@@ -180,10 +368,10 @@ void brillouin_diversity_from_graph(const struct graph* const g, double* const r
 	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
 		sum_left += log((double) (i+1)) / log(LOGARITHMIC_BASE);
 		int64_t fact = 1;
-		for(uint64_t j = 1 ; j <= g->nodes[i].absolute_proportion ; j++){
+		for(uint64_t j = 1 ; j <= graph_node_at(g, i)->absolute_proportion ; j++){
 			fact *= (int64_t) j;
 		}
-		printf("fact(%i): %li\n", g->nodes[i].absolute_proportion, fact);
+		printf("fact(%i): %li\n", graph_node_at(g, i)->absolute_proportion, fact);
 		sum_right += log((double) fact) / log(LOGARITHMIC_BASE);
 	}
 	(*res) = sum_left - sum_right;
@@ -191,9 +379,9 @@ void brillouin_diversity_from_graph(const struct graph* const g, double* const r
 
 	double sum_left = 0.0;
 	double sum_right = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
 		sum_left += log((double) (i+1)) / log(LOGARITHMIC_BASE);
-		for(uint64_t j = 0 ; j < (uint64_t) g->nodes[i].absolute_proportion ; j++){
+		for(uint64_t j = 0 ; j < (uint64_t) g->snapshot.absolute_proportions[i] ; j++){
 			sum_right += log((double) (j+1)) / log(LOGARITHMIC_BASE);
 		}
 	}
@@ -201,20 +389,14 @@ void brillouin_diversity_from_graph(const struct graph* const g, double* const r
 }
 
 void mcintosh_index_from_graph(const struct graph* const g, double* const res){	
-	double sum = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		sum += pow(g->nodes[i].relative_proportion, 2.0);
-	}
+	const double sum = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
 	(*res) = 1.0 - pow(sum, 0.5);
 }
 
 void type_token_ratio_from_graph(const struct graph * const g, double * const res){
-	uint64_t type_count = (uint64_t) g->num_nodes;
-	uint64_t token_count = 0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		token_count += (uint64_t) g->nodes[i].absolute_proportion;
-	}
-	*res = ((double) type_count) / ((double) token_count);
+	uint64_t type_count = (uint64_t) g->snapshot.num_nodes;
+	const double token_count = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_TOKENS);
+	*res = ((double) type_count) / token_count;
 }
 
 void sw_entropy_over_log_n_species_pielou1975_from_graph(const struct graph* const g, double* const res){
@@ -226,25 +408,25 @@ void sw_e_heip_from_graph(const struct graph* const g, double* const res){
 	double sw_entropy;
 	double hill_number;
 	shannon_weaver_entropy_from_graph(g, &sw_entropy, &hill_number);
-	(*res) = (pow(E, sw_entropy) - 1.0) / ((double) (g->num_nodes - 1));
+	(*res) = (pow(E, sw_entropy) - 1.0) / ((double) (g->snapshot.num_nodes - 1));
 }
 
 void sw_e_one_minus_D_from_graph(const struct graph* const g, double* const res){
 	double dom_index;
 	simpson_dominance_index_from_graph(g, &dom_index);
-	(*res) = (1.0 - dom_index) / (1.0 - (1.0 / ((double) g->num_nodes)));
+	(*res) = (1.0 - dom_index) / (1.0 - (1.0 / ((double) g->snapshot.num_nodes)));
 }
 
 void sw_e_one_over_D_williams1964_from_graph(const struct graph* const g, double* const res){
 	double dom_index;
 	simpson_dominance_index_from_graph(g, &dom_index);
-	(*res) = (1.0 / dom_index) / ((double) g->num_nodes);
+	(*res) = (1.0 / dom_index) / ((double) g->snapshot.num_nodes);
 }
 
 void sw_e_minus_ln_D_pielou1977_from_graph(const struct graph* const g, double* const res){
 	double dom_index;
 	simpson_dominance_index_from_graph(g, &dom_index);
-	(*res) = (- (log(dom_index) / log(LOGARITHMIC_BASE))) / (log((double) g->num_nodes) / log(LOGARITHMIC_BASE));
+	(*res) = (- (log(dom_index) / log(LOGARITHMIC_BASE))) / (log((double) g->snapshot.num_nodes) / log(LOGARITHMIC_BASE));
 }
 
 void sw_f_2_1_alatalo1981_from_graph(const struct graph* const g, double* const res){
@@ -267,46 +449,33 @@ void sw_g_2_1_molinari1989_from_graph(const struct graph* const g, double* const
 }
 
 void sw_o_bulla1994_from_graph(const struct graph* const g, double* const res){
-	double sum = 0.0;
-	double division = 1.0 / ((double) g->num_nodes);
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		if(g->nodes[i].relative_proportion < division){
-			sum += g->nodes[i].relative_proportion;
-		} else {
-			sum += division;
-		}
-	}
-	(*res) = sum;
+	(*res) = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_MIN_EVEN);
 }
 
 void sw_e_bulla1994_from_graph(const struct graph* const g, double* const res){
 	double o_bulla;
 	sw_o_bulla1994_from_graph(g, &o_bulla);
-	(*res) = (o_bulla - (1.0 / ((double) g->num_nodes))) / (1.0 - (1.0 / ((double) g->num_nodes)));
+	(*res) = (o_bulla - (1.0 / ((double) g->snapshot.num_nodes))) / (1.0 - (1.0 / ((double) g->snapshot.num_nodes)));
 }
 
 void sw_e_mci_pielou1969_from_graph(const struct graph* const g, double* const res){
-	double sum_x = 0.0;
-	double sum_x_square = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		sum_x += g->nodes[i].relative_proportion;
-		sum_x_square += pow(g->nodes[i].relative_proportion, 2.0);
-	}
-	(*res) = (sum_x - pow(sum_x_square, 0.5)) / (sum_x - (sum_x / pow((double) g->num_nodes, 0.5)));
+	const double sum_x = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM);
+	const double sum_x_square = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_SUM_SQUARES);
+	(*res) = (sum_x - pow(sum_x_square, 0.5)) / (sum_x - (sum_x / pow((double) g->snapshot.num_nodes, 0.5)));
 }
 
 void sw_e_prime_camargo1993_from_graph(const struct graph* const g, double* const res){
 	double sum = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
-			double val = g->nodes[i].relative_proportion - g->nodes[j].relative_proportion;
+	for(uint64_t i = 0 ; i < g->snapshot.num_nodes ; i++){
+		for(uint64_t j = i + 1 ; j < g->snapshot.num_nodes ; j++){
+			double val = g->snapshot.relative_proportions[i] - g->snapshot.relative_proportions[j];
 			if(val < 0.0){
 				val *= -1.0;
 			}
 			sum += val;
 		}
 	}
-    sum /= ((double) g->num_nodes);
+    sum /= ((double) g->snapshot.num_nodes);
 	(*res) = 1.0 - sum;
 }
 
@@ -316,14 +485,14 @@ void* sw_e_prime_camargo1993_thread(void* const args){
     const struct graph* const g = ((struct sw_e_prime_camargo1993_thread_args*) args)->g;
 
     double sum_local = 0.0;
-    for(uint64_t i = (uint64_t) thread_number ; i < g->num_nodes ; i += (uint64_t) num_threads){
-        for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
-            double delta = g->nodes[i].relative_proportion - g->nodes[j].relative_proportion;
+    for(uint64_t i = (uint64_t) thread_number ; i < g->snapshot.num_nodes ; i += (uint64_t) num_threads){
+        for(uint64_t j = i + 1 ; j < g->snapshot.num_nodes ; j++){
+            double delta = g->snapshot.relative_proportions[i] - g->snapshot.relative_proportions[j];
             if(delta < 0.0){delta = -delta;}
             sum_local += delta;
         }
     }
-    sum_local /= ((double) g->num_nodes);
+    sum_local /= ((double) g->snapshot.num_nodes);
 
     ((struct sw_e_prime_camargo1993_thread_args*) args)->sum_local = sum_local;
 
@@ -382,14 +551,8 @@ int32_t sw_e_prime_camargo1993_from_graph_multithread(const struct graph* g, dou
 }
 
 void sw_e_var_smith_and_wilson1996_original_from_graph(const struct graph* const g, double* const res){
-	double inner_sum = 0.0;
-	double outer_sum = 0.0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		inner_sum += (log(g->nodes[i].relative_proportion) / log(LOGARITHMIC_BASE)) / ((double) g->num_nodes);
-	}
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		outer_sum += pow((log(g->nodes[i].relative_proportion) / log(LOGARITHMIC_BASE)) - inner_sum, 2.0) / ((double) g->num_nodes);
-	}
+	// the variance of log p, around the mean of log p
+	const double outer_sum = dfunctions_primitive(g, GRAPH_SNAPSHOT_PRIMITIVE_LOG_VARIANCE);
 	(*res) = 1.0 - ((2.0 / PI) * atan(outer_sum));
 }
 
@@ -408,7 +571,7 @@ void * non_disparity_thread(void * args){
     double order1 = ((struct non_disparity_multithread_args *) args)->order1;
 
     for(int32_t i = start_index ; i < end_index ; i++){
-        double local_transformation = function_transform_proportion(g->nodes[i].relative_proportion, order0, order1);
+        double local_transformation = function_transform_proportion(g->snapshot.relative_proportions[i], order0, order1);
         if(isnan(local_transformation)){continue;}
         local_result = function_agregate_local(local_result, local_transformation);
     }
@@ -434,10 +597,10 @@ int32_t non_disparity_multithread(
     struct non_disparity_multithread_args args[num_threads];
 
     int32_t start_index = 0;
-    int32_t base_step = (int32_t) floor(((double) g->num_nodes) / ((double) num_threads));
+    int32_t base_step = (int32_t) floor(((double) g->snapshot.num_nodes) / ((double) num_threads));
     for(int32_t i = 0 ; i < num_threads ; i++){
         // int32_t num_elements_for_current_thread = base_step + ((g->num_nodes % num_threads) < num_threads);
-        int32_t num_elements_for_current_thread = base_step + (i < (int32_t) (g->num_nodes % num_threads));
+        int32_t num_elements_for_current_thread = base_step + (i < (int32_t) (g->snapshot.num_nodes % num_threads));
         int32_t end_index = start_index + num_elements_for_current_thread;
         // printf("%i to %i\n", start_index, end_index);
         args[i] = (struct non_disparity_multithread_args) {
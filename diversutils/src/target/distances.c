@@ -200,6 +200,63 @@ float cosine_distance_fp32_avx512(const float* restrict const a, const float* re
 }
 #endif
 
+// the two functions below split cosine_distance_fp32(_avx256/_avx512) in two, summing in the same order so that results are bit-identical;
+// n must be a multiple of 16 and a, b 64-byte aligned (rows of a graph snapshot panel, zero-padded)
+float vector_norm_fp32(const float* restrict const a, const int32_t n){
+	float lower_sum = 0.0f;
+	#if ENABLE_AVX512 == 1
+	__m512 avx512_lower_sum = _mm512_setzero_ps();
+	float vec_lower_sum[16];
+	for(int32_t i = 0 ; i < n ; i += 16){
+		__m512 avx512_a = _mm512_load_ps(&(a[i]));
+		avx512_lower_sum = _mm512_add_ps(avx512_lower_sum, _mm512_mul_ps(avx512_a, avx512_a));
+	}
+	_mm512_storeu_ps(vec_lower_sum, avx512_lower_sum);
+	for(int32_t j = 0 ; j < 16 ; j++){lower_sum += vec_lower_sum[j];}
+	#elif ENABLE_AVX256 == 1
+	__m256 avx256_lower_sum = _mm256_setzero_ps();
+	float vec_lower_sum[8];
+	for(int32_t i = 0 ; i < n ; i += 8){
+		__m256 avx256_a = _mm256_load_ps(&(a[i]));
+		avx256_lower_sum = _mm256_add_ps(avx256_lower_sum, _mm256_mul_ps(avx256_a, avx256_a));
+	}
+	_mm256_storeu_ps(vec_lower_sum, avx256_lower_sum);
+	for(int32_t j = 0 ; j < 8 ; j++){lower_sum += vec_lower_sum[j];}
+	#else
+	for(int32_t i = 0 ; i < n ; i++){
+		lower_sum += powf(a[i], 2.0f);
+	}
+	#endif
+	return sqrtf(lower_sum);
+}
+
+float cosine_distance_from_norms_fp32(const float* restrict const a, const float* restrict const b, const int32_t n, const float norm_a, const float norm_b){
+	float upper_sum = 0.0f;
+	#if ENABLE_AVX512 == 1
+	__m512 avx512_upper_sum = _mm512_setzero_ps();
+	float vec_upper_sum[16];
+	for(int32_t i = 0 ; i < n ; i += 16){
+		avx512_upper_sum = _mm512_add_ps(avx512_upper_sum, _mm512_mul_ps(_mm512_load_ps(&(a[i])), _mm512_load_ps(&(b[i]))));
+	}
+	_mm512_storeu_ps(vec_upper_sum, avx512_upper_sum);
+	for(int32_t j = 0 ; j < 16 ; j++){upper_sum += vec_upper_sum[j];}
+	#elif ENABLE_AVX256 == 1
+	__m256 avx256_upper_sum = _mm256_setzero_ps();
+	float vec_upper_sum[8];
+	for(int32_t i = 0 ; i < n ; i += 8){
+		avx256_upper_sum = _mm256_add_ps(avx256_upper_sum, _mm256_mul_ps(_mm256_load_ps(&(a[i])), _mm256_load_ps(&(b[i]))));
+	}
+	_mm256_storeu_ps(vec_upper_sum, avx256_upper_sum);
+	for(int32_t j = 0 ; j < 8 ; j++){upper_sum += vec_upper_sum[j];}
+	#else
+	for(int32_t i = 0 ; i < n ; i++){
+		upper_sum += a[i] * b[i];
+	}
+	#endif
+	float cosine_similarity = (upper_sum / (norm_a * norm_b));
+	return (1.0f - cosine_similarity);
+}
+
 double cosine_distance(const double* restrict const a, const double* restrict const b, int n){
 	#if MST_SANITY_TESTING == 1
 	if(n > 2){n = 2;}
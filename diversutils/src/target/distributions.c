@@ -193,8 +193,10 @@ int32_t zipfian_fit(double* v, uint32_t n, double* result){
 	return 0;
 }
 
+// fits the proportions of the snapshot, which may hold fewer nodes than g
 int32_t zipfian_fit_from_graph(struct graph* g, double* result){
-	size_t malloc_size = g->num_nodes * sizeof(double);
+	const uint64_t num_nodes = g->snapshot.num_nodes;
+	size_t malloc_size = num_nodes * sizeof(double);
 	void* malloc_pointer = malloc(malloc_size);
 	if(malloc_pointer == NULL){
 		perror("failed to malloc\n");
@@ -203,11 +205,11 @@ int32_t zipfian_fit_from_graph(struct graph* g, double* result){
 	memset(malloc_pointer, '\0', malloc_size);
 	double* series = (double*) malloc_pointer;
 
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		series[i] = g->nodes[i].relative_proportion;
+	for(uint64_t i = 0 ; i < num_nodes ; i++){
+		series[i] = g->snapshot.relative_proportions[i];
 	}
 
-	int32_t err = zipfian_fit(series, g->num_nodes, result);
+	int32_t err = zipfian_fit(series, num_nodes, result);
 	if(err != 0){
 		perror("failed to call zipfian_fit\n");
 		free(series);
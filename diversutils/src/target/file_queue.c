@@ -0,0 +1,295 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for stat
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "file_queue.h"
+#include "checkpoint.h"
+#include "instrument.h"
+#include "measurement.h"
+#include "logging.h"
+#include "jsonl/load.h"
+#include "cupt/load.h"
+
+static int32_t file_queue_has_suffix(const char* const filename, const char* const suffix){
+	const size_t len = strlen(filename);
+	const size_t suffix_len = strlen(suffix);
+	return len >= suffix_len && strcmp(&(filename[len - suffix_len]), suffix) == 0;
+}
+
+// largest files first, ties in input order
+static int file_queue_compare_entries(const void* a, const void* b){
+	const struct file_queue_entry* const x = (const struct file_queue_entry*) a;
+	const struct file_queue_entry* const y = (const struct file_queue_entry*) b;
+	if(x->size != y->size){return x->size < y->size ? 1 : -1;}
+	if(x->i != y->i){return (x->i > y->i) - (x->i < y->i);}
+	return (x->corpus > y->corpus) - (x->corpus < y->corpus);
+}
+
+static int32_t file_queue_init_entry(struct file_queue* const q, struct file_queue_entry* const entry, const char* const path, const char* const path_tp, const int32_t i, const int32_t corpus){
+	struct stat st;
+
+	entry->filename = path;
+	entry->filename_tp = path_tp;
+	entry->i = i;
+	entry->corpus = corpus;
+	if(file_queue_has_suffix(path, ".cupt") || file_queue_has_suffix(path, ".conllu")){
+		entry->format = FILE_QUEUE_CUPT;
+	} else if(file_queue_has_suffix(path, ".jsonl")){
+		entry->format = FILE_QUEUE_JSONL;
+	} else {
+		snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "unknown file type: %s", path);
+		fprintf(stderr, "%s\n", q->error);
+		return 1;
+	}
+	if(stat(path, &st) != 0){
+		snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "cannot stat %s: %s", path, strerror(errno));
+		fprintf(stderr, "%s\n", q->error);
+		return 1;
+	}
+	entry->size = (int64_t) st.st_size;
+	q->total_size += entry->size;
+	return 0;
+}
+
+static int32_t file_queue_finish_creation(struct file_queue* const q, const uint8_t largest_first){
+	if(largest_first && q->num_entries > 1){qsort(q->entries, q->num_entries, sizeof(struct file_queue_entry), file_queue_compare_entries);}
+
+	if(pthread_mutex_init(&(q->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		free(q->entries);
+		q->entries = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+int32_t create_file_queue(struct file_queue* const q, char* const * const paths, char* const * const paths_tp, const int32_t num_paths, const uint8_t largest_first){
+	memset(q, '\0', sizeof(struct file_queue));
+
+	if(num_paths > 0){
+		q->entries = (struct file_queue_entry*) malloc(num_paths * sizeof(struct file_queue_entry));
+		if(q->entries == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+	}
+
+	for(int32_t i = 0 ; i < num_paths ; i++){
+		if(file_queue_init_entry(q, &(q->entries[i]), paths[i], paths_tp != NULL ? paths_tp[i] : NULL, i, 0) != 0){goto failure;}
+	}
+	q->num_entries = num_paths;
+
+	return file_queue_finish_creation(q, largest_first);
+
+	failure:
+	free(q->entries);
+	q->entries = NULL;
+	return 1;
+}
+
+// one queue for the files of several corpora; in input order, the corpora take turns so that all of them progress from the start
+int32_t create_file_queue_corpora(struct file_queue* const q, struct file_queue_corpus* const corpora, const int32_t num_corpora, const uint8_t largest_first){
+	int32_t num_paths = 0;
+	int32_t max_num_paths = 0;
+
+	memset(q, '\0', sizeof(struct file_queue));
+	for(int32_t c = 0 ; c < num_corpora ; c++){
+		corpora[c].num_done = 0;
+		num_paths += corpora[c].num_paths;
+		if(corpora[c].num_paths > max_num_paths){max_num_paths = corpora[c].num_paths;}
+	}
+
+	if(num_paths > 0){
+		q->entries = (struct file_queue_entry*) malloc(num_paths * sizeof(struct file_queue_entry));
+		if(q->entries == NULL){
+			perror("malloc failed\n");
+			return 1;
+		}
+	}
+
+	for(int32_t i = 0 ; i < max_num_paths ; i++){
+		for(int32_t c = 0 ; c < num_corpora ; c++){
+			if(i >= corpora[c].num_paths){continue;}
+			if(file_queue_init_entry(q, &(q->entries[q->num_entries]), corpora[c].paths[i], corpora[c].paths_tp != NULL ? corpora[c].paths_tp[i] : NULL, i, c) != 0){goto failure;}
+			q->num_entries++;
+		}
+	}
+	q->corpora = corpora;
+
+	return file_queue_finish_creation(q, largest_first);
+
+	failure:
+	free(q->entries);
+	q->entries = NULL;
+	return 1;
+}
+
+// returns 1 once the queue is drained, or as soon as a reader failed; progress is logged under the queue mutex
+int32_t file_queue_pop(struct file_queue* const q, const struct file_queue_entry** const entry){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+	int32_t result = 1;
+
+	pthread_mutex_lock(&(q->mutex));
+	if(q->status == 0 && q->next < q->num_entries){
+		*entry = &(q->entries[q->next]);
+		q->next++;
+		result = 0;
+		snprintf(log_bfr, log_bfr_size, "%s: %s", (*entry)->format == FILE_QUEUE_CUPT ? "CUPT" : "JSONL", (*entry)->filename);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	}
+	pthread_mutex_unlock(&(q->mutex));
+
+	return result;
+}
+
+void file_queue_done(struct file_queue* const q, const struct file_queue_entry* const entry, const int32_t status){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+
+	pthread_mutex_lock(&(q->mutex));
+	if(status != 0){
+		q->status = status;
+		if(q->error[0] == '\0'){
+			if(entry != NULL){
+				snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "failed to read %s", entry->filename);
+			} else {
+				snprintf(q->error, FILE_QUEUE_ERROR_SIZE, "failed to start the reader threads");
+			}
+		}
+	} else {
+		q->num_done++;
+		q->done_size += entry->size;
+		if(q->corpora != NULL){q->corpora[entry->corpus].num_done++;}
+		snprintf(log_bfr, log_bfr_size, "done %i/%i files (%.1f%% of bytes): %s", q->num_done, q->num_entries, q->total_size > 0 ? (100.0 * q->done_size) / q->total_size : 100.0, entry->filename);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+		if(q->progress != NULL){q->progress->file_done(q->progress->ctx, entry->filename, q->num_done, q->num_entries, q->total_size > 0 ? ((double) q->done_size) / q->total_size : 1.0);}
+	}
+	pthread_mutex_unlock(&(q->mutex));
+}
+
+struct file_queue_thread_args {
+	struct file_queue* q;
+	struct measurement_configuration* mcfg;
+	struct measurement_structure_references* sref;
+	struct measurement_mutables* mmut;
+};
+
+static void* file_queue_thread(void* args){
+	const struct file_queue_thread_args* const a = (const struct file_queue_thread_args*) args;
+	const struct file_queue_entry* entry;
+
+	while(file_queue_pop(a->q, &entry) == 0){
+		const struct file_queue_corpus* const corpus = a->q->corpora != NULL ? &(a->q->corpora[entry->corpus]) : NULL;
+		struct measurement_configuration* const mcfg = corpus != NULL ? corpus->mcfg : a->mcfg;
+		struct measurement_structure_references* const sref = corpus != NULL ? corpus->sref : a->sref;
+		struct measurement_mutables* const mmut = corpus != NULL ? corpus->mmut : a->mmut;
+		struct checkpoint* const cp = sref->checkpoint;
+		struct instrument_scope span;
+		int32_t status;
+
+		// read to the end by the run that wrote the checkpoint
+		if(cp != NULL && checkpoint_file_is_done(cp, entry->i)){
+			file_queue_done(a->q, entry, 0);
+			continue;
+		}
+
+		if(cp != NULL){checkpoint_file_begin(cp, entry->i);}
+		instrument_span_begin(&span, "read_file");
+		if(entry->format == FILE_QUEUE_CUPT){
+			status = cupt_to_graph(entry->i, entry->filename, entry->filename_tp, mcfg, sref, mmut, NULL);
+		} else {
+			status = jsonl_to_graph(entry->i, entry->filename, mcfg, sref, mmut);
+		}
+		instrument_span_end(&span);
+		if(cp != NULL){checkpoint_file_end(cp, entry->i, status);}
+		if(status != 0){
+			fprintf(stderr, "failed to read %s\n", entry->filename);
+		}
+		file_queue_done(a->q, entry, status);
+	}
+
+	return NULL;
+}
+
+// reads every file of the queue with num_threads reader threads, each taking the next file as soon as it is done with the previous one;
+// mcfg, sref and mmut are ignored (and may be NULL) for a queue created with create_file_queue_corpora
+int32_t file_queue_read(struct file_queue* const q, struct measurement_configuration* const mcfg, struct measurement_structure_references* const sref, struct measurement_mutables* const mmut, const int32_t num_threads){
+	const int32_t num_threads_used = num_threads < 1 ? 1 : (num_threads > q->num_entries && q->num_entries > 0 ? q->num_entries : num_threads);
+	struct file_queue_thread_args args = {
+		.q = q,
+		.mcfg = mcfg,
+		.sref = sref,
+		.mmut = mmut,
+	};
+	int32_t num_created = 0;
+	int32_t result = 0;
+
+	pthread_t* const threads = (pthread_t*) malloc(num_threads_used * sizeof(pthread_t));
+	if(threads == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+
+	for(int32_t k = 0 ; k < num_threads_used ; k++){
+		if(pthread_create(&(threads[k]), NULL, file_queue_thread, &args) != 0){
+			perror("failed to call pthread_create\n");
+			file_queue_done(q, NULL, 1);
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int32_t k = 0 ; k < num_created ; k++){
+		if(pthread_join(threads[k], NULL) != 0){
+			perror("failed to call pthread_join\n");
+			result = 1;
+		}
+	}
+	free(threads);
+
+	if(q->status != 0){result = 1;}
+	return result;
+}
+
+void free_file_queue(struct file_queue* const q){
+	pthread_mutex_destroy(&(q->mutex));
+	free(q->entries);
+	memset(q, '\0', sizeof(struct file_queue));
+}
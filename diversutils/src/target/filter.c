@@ -69,6 +69,19 @@ int32_t filter_compile(struct filter * const f, const uint8_t quiet){
         fprintf(stderr, "error: %s\n", bfr);
         return 1;
     }
+
+    // pcre2_match and pcre2_substitute use the JIT code automatically; without JIT support, the interpreter is used
+    errorcode = pcre2_jit_compile(f->regex, PCRE2_JIT_COMPLETE);
+    if(errorcode != 0 && !quiet){
+        const int32_t bfr_size = 256;
+        unsigned char bfr[bfr_size];
+        memset(bfr, '\0', bfr_size);
+        pcre2_get_error_message(errorcode, bfr, bfr_size);
+        memset(log_bfr, '\0', log_bfr_size);
+        snprintf(log_bfr, log_bfr_size, "JIT compilation unavailable, falling back to the interpreter: %s", bfr);
+        warning_format(__FILE__, __func__, __LINE__, log_bfr);
+    }
+
     return 0;
 }
 
@@ -78,13 +91,13 @@ void filter_free(struct filter * const f){
 
 struct filter filters[] = {
     #if ENABLE_FILTER_XML == 1
-    { .regex = NULL, .pattern_match = (unsigned char*) "</?[a-z0-9]{1,32}+(\\s+[a-z0-9]{1,32}+=\"[^\"]{0,128}+\"){0,16}+\\s?/?>", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[XML]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+    { .regex = NULL, .pattern_match = (unsigned char*) "</?[a-z0-9]{1,32}+(\\s+[a-z0-9]{1,32}+=\"[^\"]{0,128}+\"){0,16}+\\s?/?>", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[XML]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = "<", .required_length = 0, },
     #endif
     #if ENABLE_FILTER_PATH == 1
-    { .regex = NULL, .pattern_match = (unsigned char*) "(?<!/)(/[a-z0-9\\-\\._]{1,64}+){1,32}+/?", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[PATH]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+    { .regex = NULL, .pattern_match = (unsigned char*) "(?<!/)(/[a-z0-9\\-\\._]{1,64}+){1,32}+/?", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[PATH]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = "/", .required_length = 0, },
     #endif
     #if ENABLE_FILTER_EMAIL == 1
-    { .regex = NULL, .pattern_match = (unsigned char*) "[a-z0-9\\-_\\.]{1,32}+@([a-z0-9\\-_]{1,32}+\\.){1,4}+[a-z0-9]{1,6}+", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[EMAIL]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+    { .regex = NULL, .pattern_match = (unsigned char*) "[a-z0-9\\-_\\.]{1,32}+@([a-z0-9\\-_]{1,32}+\\.){1,4}+[a-z0-9]{1,6}+", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[EMAIL]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = "@", .required_length = 0, },
     #endif
     #if ENABLE_FILTER_URL == 1
     { .regex = NULL, .pattern_match = (unsigned char*) "\n\
@@ -99,7 +112,7 @@ struct filter filters[] = {
         (\\[PATH\\]|(/[^/\\&;\\s]{1,64}+){1,16}+)?\n\
         (\\?([^=]{1,32}+=[^\\&;]{1,32}+[\\&;]?){,32}+)?\n\
         (\\#\\S{,64}+)?\n\
-        ", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS | PCRE2_EXTENDED, .replacement = (unsigned char*) "[URL]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+        ", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS | PCRE2_EXTENDED, .replacement = (unsigned char*) "[URL]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = ".[", .required_length = 0, },
     /*
     { .regex = NULL, .pattern_match = (unsigned char*) "\n\
     # scheme (see https://www.iana.org/assignments/uri-schemes/uri-schemes.xhtml) \n\
@@ -153,13 +166,13 @@ struct filter filters[] = {
     #if ENABLE_FILTER_ALPHANUM == 1
     // { .regex = NULL, .pattern_match = (unsigned char*) "[a-z0-9\\+\\-\\.]{,32}[0-9][a-z0-9\\+\\-\\.]{,32}", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[ALPHANUM]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
     // { .regex = NULL, .pattern_match = (unsigned char*) "\\w{,32}[0-9]\\w{,32}", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[ALPHANUM]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
-    { .regex = NULL, .pattern_match = (unsigned char*) "\\w*?[0-9]\\w*+", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[ALPHANUM]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+    { .regex = NULL, .pattern_match = (unsigned char*) "\\w*?[0-9]\\w*+", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[ALPHANUM]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = "0123456789", .required_length = 0, },
     #endif
     #if ENABLE_FILTER_LONG == 1
-    { .regex = NULL, .pattern_match = (unsigned char*) "\\S{30,}+", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL, .replacement = (unsigned char*) "[LONG]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+    { .regex = NULL, .pattern_match = (unsigned char*) "\\S{30,}+", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL, .replacement = (unsigned char*) "[LONG]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = NULL, .required_length = 30, },
     #endif
     #if ENABLE_FILTER_NON_FRENCH == 1
-    { .regex = NULL, .pattern_match = (unsigned char*) "\\w{0,8}[^0-9a-zàâäéèêëìîïòôöùûüç\\s&~\"#'\\{\\(\\[\\|\\|\\`_\\\\\\^@\\)\\]°\\+=\\}\\$£%µ\\*§!:/;\\.,\\?<>]\\w++", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[NON_FRENCH]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, },
+    { .regex = NULL, .pattern_match = (unsigned char*) "\\w{0,8}[^0-9a-zàâäéèêëìîïòôöùûüç\\s&~\"#'\\{\\(\\[\\|\\|\\`_\\\\\\^@\\)\\]°\\+=\\}\\$£%µ\\*§!:/;\\.,\\?<>]\\w++", .options_compile = PCRE2_UCP | PCRE2_UTF | PCRE2_DOTALL | PCRE2_CASELESS, .replacement = (unsigned char*) "[NON_FRENCH]", .options_replace = PCRE2_SUBSTITUTE_LITERAL | PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, .required_any = NULL, .required_length = 0, },
     #endif
 };
 
@@ -296,3 +309,157 @@ int32_t filter_substitute_all(char ** const s, size_t * const s_len){
 
     return 0;
 }
+
+int32_t create_filter_workspace(struct filter_workspace * const fw){
+    uint32_t max_capture_count = 0;
+    size_t i;
+    for(i = 0 ; i < filter_cardinality ; i++){
+        uint32_t capture_count = 0;
+        if(pcre2_pattern_info(filters[i].regex, PCRE2_INFO_CAPTURECOUNT, &capture_count) != 0){
+            fprintf(stderr, "failed to call pcre2_pattern_info for %s\n", filters[i].pattern_match);
+            return 1;
+        }
+        if(capture_count > max_capture_count){max_capture_count = capture_count;}
+    }
+
+    fw->match_data = pcre2_match_data_create(max_capture_count + 1, NULL);
+    if(fw->match_data == NULL){
+        perror("failed to call pcre2_match_data_create\n");
+        return 1;
+    }
+    fw->capacity = 4096;
+    fw->bfr = malloc(fw->capacity * sizeof(PCRE2_UCHAR));
+    if(fw->bfr == NULL){
+        perror("malloc failed\n");
+        pcre2_match_data_free(fw->match_data);
+        fw->match_data = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+void free_filter_workspace(struct filter_workspace * const fw){
+    if(fw->match_data != NULL){pcre2_match_data_free(fw->match_data);}
+    if(fw->bfr != NULL){free(fw->bfr);}
+    fw->match_data = NULL;
+    fw->bfr = NULL;
+    fw->capacity = 0;
+}
+
+static void filter_mark_present(uint8_t * const present, PCRE2_SPTR s, PCRE2_SIZE * const length){
+    PCRE2_SIZE i;
+    for(i = 0 ; s[i] != 0 ; i++){
+        #if PCRE2_CODE_UNIT_WIDTH == 0 || PCRE2_CODE_UNIT_WIDTH == 8
+        present[s[i]] = 1;
+        #else
+        if(s[i] < 256){present[s[i]] = 1;}
+        #endif
+    }
+    if(length != NULL){(*length) = i;}
+}
+
+static uint8_t filter_may_match(const struct filter * const f, const uint8_t * const present, const PCRE2_SIZE length){
+    if(length < f->required_length){return 0;}
+    if(f->required_any == NULL){return 1;}
+    for(const char * c = f->required_any ; *c != '\0' ; c++){
+        if(present[(uint8_t) *c]){return 1;}
+    }
+    return 0;
+}
+
+/*
+ * Same output as filter_substitute_all, but:
+ * - filters whose required characters are absent from the current text are skipped without running the regex;
+ * - the output buffer and the match data come from the workspace, and the output is swapped with *s instead of copied, so that no allocation happens once the buffer has grown to the document size.
+ * *s must have been allocated with malloc; it may be replaced by another malloc'd buffer.
+ */
+int32_t filter_substitute_all_workspace(struct filter_workspace * const fw, char ** const s, size_t * const s_len, size_t * const s_capacity_bytes){
+    uint8_t present[256];
+    memset(present, '\0', 256 * sizeof(uint8_t));
+    PCRE2_SIZE length = 0;
+    filter_mark_present(present, (PCRE2_SPTR) (*s), &length);
+    // capacity of the buffer currently held by *s, in code units; it follows the buffer when swapped with fw->bfr
+    #if PCRE2_CODE_UNIT_WIDTH == 0 || PCRE2_CODE_UNIT_WIDTH == 8
+    PCRE2_SIZE s_capacity = (*s_capacity_bytes);
+    #else
+    PCRE2_SIZE s_capacity = (*s_capacity_bytes) / (PCRE2_CODE_UNIT_WIDTH >> 3);
+    #endif
+
+    size_t i;
+    for(i = 0 ; i < filter_cardinality ; i++){
+        if(!filter_may_match(&(filters[i]), present, length)){continue;}
+
+        PCRE2_SIZE outputlength = fw->capacity;
+        int num_sub = pcre2_substitute(
+            filters[i].regex,
+            (PCRE2_SPTR) (*s),
+            length,
+            0,
+            filters[i].options_replace,
+            fw->match_data,
+            NULL,
+            filters[i].replacement,
+            filters[i].rlength,
+            fw->bfr,
+            &outputlength
+        );
+        if(num_sub == PCRE2_ERROR_NOMEMORY){
+            // with PCRE2_SUBSTITUTE_OVERFLOW_LENGTH, outputlength now holds the required size, terminating zero included
+            PCRE2_SIZE new_capacity = fw->capacity;
+            while(new_capacity < outputlength){new_capacity <<= 1;}
+            void * realloc_ptr = realloc(fw->bfr, new_capacity * sizeof(PCRE2_UCHAR));
+            if(realloc_ptr == NULL){
+                perror("realloc failed\n");
+                return 1;
+            }
+            fw->bfr = realloc_ptr;
+            fw->capacity = new_capacity;
+            outputlength = fw->capacity;
+            num_sub = pcre2_substitute(
+                filters[i].regex,
+                (PCRE2_SPTR) (*s),
+                length,
+                0,
+                filters[i].options_replace,
+                fw->match_data,
+                NULL,
+                filters[i].replacement,
+                filters[i].rlength,
+                fw->bfr,
+                &outputlength
+            );
+        }
+        if(num_sub < 0){
+            fprintf(stderr, "failed to call pcre2_substitute for %s; return: %i\n", filters[i].pattern_match, num_sub);
+            #ifndef NDEBUG
+            const size_t n = 1024;
+            PCRE2_UCHAR z[n];
+            memset(z, '\0', n * sizeof(PCRE2_UCHAR));
+            pcre2_get_error_message(num_sub, z, n);
+            fprintf(stderr, "error message: %s\n", z);
+            #endif
+            return 1;
+        }
+        if(num_sub != 0){
+            PCRE2_UCHAR * const swap_ptr = (PCRE2_UCHAR*) (*s);
+            (*s) = (char*) fw->bfr;
+            fw->bfr = swap_ptr;
+            const PCRE2_SIZE swap_capacity = s_capacity;
+            s_capacity = fw->capacity;
+            fw->capacity = swap_capacity;
+            length = outputlength;
+            // the substitution only removes characters and adds those of the replacement
+            filter_mark_present(present, filters[i].replacement, NULL);
+        }
+    }
+
+    #if PCRE2_CODE_UNIT_WIDTH == 0 || PCRE2_CODE_UNIT_WIDTH == 8
+    (*s_len) = length;
+    (*s_capacity_bytes) = s_capacity;
+    #else
+    (*s_len) = length * (PCRE2_CODE_UNIT_WIDTH >> 3);
+    (*s_capacity_bytes) = s_capacity * (PCRE2_CODE_UNIT_WIDTH >> 3);
+    #endif
+
+    return 0;
+}
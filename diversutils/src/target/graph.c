@@ -32,12 +32,14 @@
 #include <errno.h>
 #include <math.h>
 #include <pthread.h>
+#include <sched.h>
 #include <immintrin.h>
 #include <assert.h>
 
 #include "graph.h"
 #include "general_constants.h"
 #include "distances.h"
+#include "snapshot.h"
 #include "cupt/parser.h"
 #include "stats.h"
 #include "logging.h"
@@ -131,6 +133,10 @@ int32_t distance_matrix_from_graph(const struct graph* const restrict g, struct
 		perror("g->num_nodes != m->a\n");
 		return 1;
 	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
 
 	for(uint64_t i = 0 ; i < m->a ; i++){
 		switch(m->fp_mode){
@@ -144,19 +150,11 @@ int32_t distance_matrix_from_graph(const struct graph* const restrict g, struct
 		for(uint64_t j = i + 1 ; j < m->b ; j++){
 			switch(m->fp_mode){
 				case FP32:
-					#if ENABLE_AVX512 == 1
-					m->bfr.fp32[i * m->b + j] = (float) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif ENABLE_AVX256 == 1
-					m->bfr.fp32[i * m->b + j] = (float) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif MST_SANITY_TESTING == 1
-					m->bfr.fp32[i * m->b + j] = (float) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-					#else
-					m->bfr.fp32[i * m->b + j] = (float) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#endif
+					m->bfr.fp32[i * m->b + j] = (float) graph_snapshot_distance(&(g->snapshot), i, j);
 					m->bfr.fp32[j * m->b + i] = m->bfr.fp32[i * m->b + j];
 					break;
 				case FP64:
-					m->bfr.fp64[i * m->b + j] = (double) cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+					m->bfr.fp64[i * m->b + j] = (double) cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 					m->bfr.fp64[j * m->b + i] = m->bfr.fp64[i * m->b + j];
 					break;
 			}
@@ -174,34 +172,22 @@ void* row_thread(void* args){
 	uint64_t end_j = ((struct row_thread_arg*) args)->end_j;
 
 	for(uint64_t j = start_j ; j < end_j ; j++){
-		#if ENABLE_AVX512 == 1
-		vector[j] = cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#elif ENABLE_AVX256 == 1
-		vector[j] = cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#elif MST_SANITY_TESTING == 1
-		vector[j] = minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-		#else
-		vector[j] = cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#endif
+		vector[j] = graph_snapshot_distance(&(g->snapshot), i, j);
 	}
 	return NULL;
 }
 
 void distance_row_from_graph(const struct graph* const restrict g, const int32_t i, float* const restrict vector){
 	for(uint64_t j = 0 ; j < g->num_nodes ; j++){
-		#if ENABLE_AVX512 == 1
-		vector[j] = cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#elif ENABLE_AVX256 == 1
-		vector[j] = cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#elif MST_SANITY_TESTING == 1
-		vector[j] = minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-		#else
-		vector[j] = cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#endif
+		vector[j] = graph_snapshot_distance(&(g->snapshot), i, j);
 	}
 }
 
 int32_t distance_row_from_graph_multithread(const struct graph* const g, const uint64_t i, float* const vector, const int16_t num_row_threads){
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
 	pthread_t threads[num_row_threads];
 	struct row_thread_arg args[num_row_threads];
 	uint64_t start_j = 0;
@@ -241,15 +227,7 @@ void* batch_row_thread(void* args){
 	uint64_t end_j = ((struct row_thread_arg*) args)->end_j;
 
 	for(uint64_t j = start_j ; j < end_j ; j++){
-		#if ENABLE_AVX512 == 1
-		vector[j] = cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#elif ENABLE_AVX256 == 1
-		vector[j] = cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#elif MST_SANITY_TESTING == 1
-		vector[j] = minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-		#else
-		vector[j] = cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-		#endif
+		vector[j] = graph_snapshot_distance(&(g->snapshot), i, j);
 	}
 	return NULL;
 }
@@ -262,6 +240,10 @@ int32_t distance_row_batch_from_graph_multithread(const struct graph* const g, c
 		perror("In distance_row_batch_from_graph_multithread, batch_size must be lower or equal to the number of threads\n");
 		return 1;
 	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
 
 	if(i + batch_size >= g->num_nodes){
 		batch_size = g->num_nodes - i;
@@ -326,19 +308,11 @@ void* matrix_thread(void* args){
 		for(uint64_t j = i + 1 ; j < m->b ; j++){
 			switch(m->fp_mode){
 				case FP32:
-					#if ENABLE_AVX512 == 1
-					m->bfr.fp32[i * m->b + j] = (float) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif ENABLE_AVX256 == 1
-					m->bfr.fp32[i * m->b + j] = (float) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif MST_SANITY_TESTING == 1
-					m->bfr.fp32[i * m->b + j] = (float) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-					#else
-					m->bfr.fp32[i * m->b + j] = (float) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#endif
+					m->bfr.fp32[i * m->b + j] = (float) graph_snapshot_distance(&(g->snapshot), i, j);
 					m->bfr.fp32[j * m->b + i] = m->bfr.fp32[i * m->b + j];
 					break;
 				case FP64:
-					m->bfr.fp64[i * m->b + j] = (double) cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+					m->bfr.fp64[i * m->b + j] = (double) cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 					m->bfr.fp64[j * m->b + i] = m->bfr.fp64[i * m->b + j];
 					break;
 			}
@@ -358,6 +332,10 @@ int32_t distance_matrix_from_graph_multithread(struct graph* const g, struct mat
 		printf("m->a: %u\n", m->a);
 		return 1;
 	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
 	
 	pthread_t threads[num_matrix_threads];
 	struct matrix_thread_arg args[num_matrix_threads];
@@ -382,6 +360,95 @@ int32_t distance_matrix_from_graph_multithread(struct graph* const g, struct mat
 	return 0;
 }
 
+// rows and columns of the nodes from first_new_node on; rows are dealt round-robin, as in matrix_thread
+void* matrix_extend_thread(void* args){
+	const struct matrix_thread_arg* const a = (struct matrix_thread_arg*) args;
+	struct matrix* const m = a->m;
+	const struct graph* const g = a->g;
+	for(uint64_t i = a->first_new_node + a->thread_rank ; i < m->a ; i += a->thread_total_count){
+		switch(m->fp_mode){
+			case FP32:
+				m->bfr.fp32[i * m->b + i] = 0.0f;
+				for(uint64_t j = 0 ; j < i ; j++){
+					m->bfr.fp32[i * m->b + j] = (float) graph_snapshot_distance(&(g->snapshot), i, j);
+					m->bfr.fp32[j * m->b + i] = m->bfr.fp32[i * m->b + j];
+				}
+				break;
+			case FP64:
+				m->bfr.fp64[i * m->b + i] = 0.0;
+				for(uint64_t j = 0 ; j < i ; j++){
+					m->bfr.fp64[i * m->b + j] = (double) graph_snapshot_distance(&(g->snapshot), i, j);
+					m->bfr.fp64[j * m->b + i] = m->bfr.fp64[i * m->b + j];
+				}
+				break;
+		}
+	}
+	return NULL;
+}
+
+// fills what a matrix grown by grow_matrix lacks: the (num_nodes - first_new_node) * num_nodes distances of the new nodes, read from the snapshot
+int32_t distance_matrix_extend_from_graph_multithread(struct graph* const g, struct matrix* const m, const uint64_t first_new_node, const int16_t num_matrix_threads){
+	if(m->a != m->b || ((uint32_t) g->num_nodes) != m->a){
+		perror("matrix does not match the number of nodes\n");
+		return 1;
+	}
+	if(!graph_snapshot_has_vectors(g)){
+		perror("graph snapshot does not hold every vector; call graph_snapshot_refresh first\n");
+		return 1;
+	}
+
+	const int16_t num_threads = num_matrix_threads < 1 ? 1 : (num_matrix_threads > UINT8_MAX ? UINT8_MAX : num_matrix_threads);
+	pthread_t threads[num_threads];
+	struct matrix_thread_arg args[num_threads];
+	int16_t num_created = 0;
+	int32_t result = 0;
+	for(int16_t i = 0 ; i < num_threads ; i++){
+		args[i] = (struct matrix_thread_arg) {
+			.m = m,
+			.g = g,
+			.thread_rank = (uint8_t) i,
+			.thread_total_count = (uint8_t) num_threads,
+			.first_new_node = first_new_node,
+		};
+	}
+	if(num_threads == 1){
+		matrix_extend_thread(&(args[0]));
+		return 0;
+	}
+	for(int16_t i = 0 ; i < num_threads ; i++){
+		if(pthread_create(&(threads[i]), NULL, matrix_extend_thread, &(args[i])) != 0){
+			perror("failed to create matrix thread\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int16_t i = 0 ; i < num_created ; i++){
+		if(pthread_join(threads[i], NULL) != 0){
+			perror("failed to join matrix thread\n");
+			result = 1;
+		}
+	}
+	return result;
+}
+
+// n x n matrix whose first a rows and columns are those of m; the new cells and every flag are zero
+int32_t grow_matrix(struct matrix* const m, const uint32_t n){
+	struct matrix grown = { .fp_mode = m->fp_mode, };
+	if(n < m->a || m->a != m->b){
+		perror("grow_matrix only grows square matrices\n");
+		return 1;
+	}
+	if(create_matrix(&grown, n, n, m->fp_mode) != 0){return 1;}
+	const size_t cell_size = m->fp_mode == FP64 ? sizeof(double) : sizeof(float);
+	for(uint64_t i = 0 ; i < m->a ; i++){
+		memcpy(((char*) grown.bfr.fp32) + i * n * cell_size, ((char*) m->bfr.fp32) + i * m->b * cell_size, m->b * cell_size);
+	}
+	free_matrix(m);
+	*m = grown;
+	return 0;
+}
+
 void free_matrix(struct matrix* m){
 	// if(m->to_free == 0){return;}
 	/*
@@ -483,26 +550,18 @@ int32_t void_strcmp(const void* a, const void* b){
 int32_t create_graph_node(struct graph_node* restrict node, const uint16_t num_dimensions, const uint8_t fp_mode){
 	static int32_t num_graph_node_created = 0;
 
+#if INITIALIZE_GRAPH_WITH_RANDOM_VECTOR == 1
 	uint64_t malloc_size;
-
-	if(pthread_mutex_init(&node->mutex_local_node, NULL) != 0){
-        perror("failed to call pthread_mutex_init\n");
-        return 1;
-    }
+#endif
 
 	node->already_considered = 0;
 
 	node->num_dimensions = num_dimensions;
 
+	// allocated by request_more_neighbour_capacity_graph_node on first use
 	node->num_neighbours = 0;
-	node->capacity_neighbours = GRAPH_NODE_NEIGHBOUR_STEP;
-	malloc_size = node->capacity_neighbours * sizeof(struct graph_neighbour);
-	node->neighbours = (struct graph_neighbour*) malloc(malloc_size);
-	if(node->neighbours == NULL){
-		fprintf(stderr, "failed to initialise node->neighbours with %lu bytes\n", malloc_size);
-		return 1;
-	}
-	memset(node->neighbours, '\0', malloc_size);
+	node->capacity_neighbours = 0;
+	node->neighbours = NULL;
 
 #if INITIALIZE_GRAPH_WITH_RANDOM_VECTOR == 1
 		malloc_size = 0;
@@ -531,7 +590,7 @@ int32_t create_graph_node(struct graph_node* restrict node, const uint16_t num_d
 			current_rand /= RANDOM_MODULO;
 			current_rand *= (RANDOM_MAX_VALUE - RANDOM_MIN_VALUE);
 			current_rand += RANDOM_MIN_VALUE;
-			if(ENABLE_EXTREMES && num_graph_node_created % EXTREME_STEP == 0){
+			if(ENABLE_EXTREMES && __atomic_load_n(&num_graph_node_created, __ATOMIC_RELAXED) % EXTREME_STEP == 0){
 				current_rand *= EXTREME_RATIO;
 			}
 			switch(fp_mode){
@@ -557,7 +616,7 @@ int32_t create_graph_node(struct graph_node* restrict node, const uint16_t num_d
 	node->relative_proportion = 0.0;
 	node->absolute_proportion = 0;
 
-	num_graph_node_created++;
+	__atomic_fetch_add(&num_graph_node_created, 1, __ATOMIC_RELAXED);
 
 	return 0;
 
@@ -591,45 +650,32 @@ void free_graph_node(struct graph_node* restrict node, const int8_t fp_mode){
 			break;
 	}
 	free(node->neighbours);
-    pthread_mutex_destroy(&(node->mutex_local_node));
 }
 
 
 int32_t create_graph(struct graph* restrict const g, const int32_t num_nodes, const int16_t num_dimensions, const int8_t fp_mode){
-	size_t malloc_size = num_nodes * sizeof(struct graph_node);
-	void* malloc_pointer = malloc(malloc_size);
-	if(malloc_pointer == NULL){goto malloc_fail;}
-	memset(malloc_pointer, 0, malloc_size);
-	g->nodes = (struct graph_node*) malloc_pointer;
+	if(create_graph_empty(g) != 0){goto malloc_fail;}
+	while(g->capacity < (uint64_t) num_nodes){
+		if(request_more_capacity_graph(g) != 0){goto malloc_fail;}
+	}
 	g->num_nodes = num_nodes;
-	g->capacity = num_nodes;
 	g->num_dimensions = num_dimensions;
 	// g->dist_mat.to_free = 0;
 	g->dist_mat = (struct matrix) { .fp_mode = fp_mode, };
-	g->dist_mat_must_be_freed = 0;
-	pthread_mutex_init(&(g->mutex_nodes), NULL);
-	pthread_mutex_init(&(g->mutex_matrix), NULL);
-
-	double relative_proportion_sum = 0.0;
 
 	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
 		int32_t res;
 		double proportion;
-		res = create_graph_node(&(g->nodes[i]), num_dimensions, fp_mode);
+		res = create_graph_node(graph_node_at(g, i), num_dimensions, fp_mode);
 		if(res != 0){goto create_graph_node_failed;}
 		if(CONSTANT_RELATIVE_PROPORTION){
 			proportion = 1.0;
 		} else {
 			proportion = (double) (rand() % MAX_ABUNDANCE);
 		}
-		g->nodes[i].relative_proportion = proportion;
-		g->nodes[i].absolute_proportion = (int32_t) proportion;
-
-		relative_proportion_sum += proportion;
-	}
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		g->nodes[i].relative_proportion /= relative_proportion_sum;
+		graph_node_at(g, i)->absolute_proportion = (uint64_t) proportion;
 	}
+	if(compute_graph_relative_proportions(g) != 0){goto malloc_fail;}
 
 	return 0;
 
@@ -640,41 +686,46 @@ int32_t create_graph(struct graph* restrict const g, const int32_t num_nodes, co
 
 	create_graph_node_failed:
 	perror("create_graph_node failed\n");
-	free(g->nodes);
 	goto return_failure;
 
 	return_failure:
+	g->num_nodes = 0;
+	free_graph(g);
 	return 1;
 }
 
+// adds the next chunk; chunks already handed out are never moved, so pointers to nodes stay valid while the graph grows
 int32_t request_more_capacity_graph(struct graph* restrict const g){
-	void* malloc_pointer = realloc(g->nodes, (g->capacity + GRAPH_CAPACITY_STEP) * sizeof(struct graph_node));
+	if(g->num_chunks >= GRAPH_NUM_CHUNKS){
+		perror("graph chunk directory is full\n");
+		return 1;
+	}
+	const uint64_t chunk_size = ((uint64_t) 1) << (GRAPH_FIRST_CHUNK_SHIFT + g->num_chunks);
+	void* malloc_pointer = calloc(chunk_size, sizeof(struct graph_node));
 	if(malloc_pointer == NULL){
-		perror("failed to realloc\n");
+		perror("failed to calloc\n");
 		return 1;
 	}
-	g->nodes = (struct graph_node*) malloc_pointer;
-	memset(&(g->nodes[g->capacity]), '\0', GRAPH_CAPACITY_STEP * sizeof(struct graph_node));
-	g->capacity += GRAPH_CAPACITY_STEP;
-
-    /*
-    for(int32_t i = g->num_nodes ; i < g->capacity ; i++){
-        if(pthread_mutex_init(&(g->nodes[i].mutex_local_node), NULL) != 0){
-            perror("failed to call pthread_mutex_init\n");
-            return 1;
-        }
-    }
-    */
+	g->chunks[g->num_chunks] = (struct graph_node*) malloc_pointer;
+	g->num_chunks++;
+	g->capacity += chunk_size;
 
 	return 0;
 }
 
 int32_t create_graph_empty(struct graph* restrict const g){
-	g->nodes = NULL;
+	memset(g->chunks, '\0', GRAPH_NUM_CHUNKS * sizeof(struct graph_node*));
+	g->num_chunks = 0;
 	g->num_nodes = 0;
 	g->capacity = 0;
+	g->num_dimensions = 0;
 	g->dist_mat = (struct matrix) { .fp_mode = FP32, };
 	g->dist_mat_must_be_freed = 0;
+	memset(&(g->snapshot), '\0', sizeof(struct graph_snapshot));
+	g->word2vec_slots = NULL;
+	g->num_word2vec_slots = 0;
+	pthread_mutex_init(&(g->mutex_nodes), NULL);
+	pthread_mutex_init(&(g->mutex_matrix), NULL);
 
 	if(request_more_capacity_graph(g) != 0){
 		return 1;
@@ -683,19 +734,55 @@ int32_t create_graph_empty(struct graph* restrict const g){
 	return 0;
 }
 
-void compute_graph_relative_proportions(struct graph* const g){
-	uint64_t sum = 0;
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		sum += g->nodes[i].absolute_proportion;
+// copies the node into the next slot and publishes it; readers that do not hold mutex_nodes see it once graph_num_nodes covers its index
+int32_t graph_append_node(struct graph* const g, const struct graph_node* const node, uint64_t* const index){
+	int32_t result = 0;
+
+	pthread_mutex_lock(&(g->mutex_nodes));
+	if(g->num_nodes >= g->capacity && request_more_capacity_graph(g) != 0){
+		perror("failed to call request_more_capacity_graph\n");
+		result = 1;
+		goto unlock;
 	}
-	/*
-	if(sum == 0){
-		perror("sum == 0; division by zero\n");
+	*graph_node_at(g, g->num_nodes) = *node;
+	*index = g->num_nodes;
+	__atomic_store_n(&(g->num_nodes), g->num_nodes + 1, __ATOMIC_RELEASE);
+
+	unlock:
+	pthread_mutex_unlock(&(g->mutex_nodes));
+	return result;
+}
+
+// same as graph_append_node for num_nodes consecutive nodes, with one lock and the capacity reserved up front; *first_index receives the index of nodes[0]
+int32_t graph_append_nodes(struct graph* const g, const struct graph_node* const nodes, const uint64_t num_nodes, uint64_t* const first_index){
+	int32_t result = 0;
+
+	pthread_mutex_lock(&(g->mutex_nodes));
+	while(g->num_nodes + num_nodes > g->capacity){
+		if(request_more_capacity_graph(g) != 0){
+			perror("failed to call request_more_capacity_graph\n");
+			result = 1;
+			goto unlock;
+		}
 	}
-	*/
-	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		g->nodes[i].relative_proportion = ((double) g->nodes[i].absolute_proportion) / ((double) sum);
+	for(uint64_t i = 0 ; i < num_nodes ; i++){
+		*graph_node_at(g, g->num_nodes + i) = nodes[i];
+	}
+	*first_index = g->num_nodes;
+	__atomic_store_n(&(g->num_nodes), g->num_nodes + num_nodes, __ATOMIC_RELEASE);
+
+	unlock:
+	pthread_mutex_unlock(&(g->mutex_nodes));
+	return result;
+}
+
+// proportions are computed once, for both the nodes and the snapshot; vectors already in the snapshot are kept but no new row is gathered
+int32_t compute_graph_relative_proportions(struct graph* const g){
+	if(graph_snapshot_refresh(g, 0, 1) != 0){
+		perror("failed to call graph_snapshot_refresh\n");
+		return 1;
 	}
+	return 0;
 }
 
 int32_t compute_graph_dist_mat(struct graph* const g, const int16_t num_matrix_threads){
@@ -728,6 +815,16 @@ int32_t word2vec_entry_cmp(const void* restrict a, const void* restrict b){
 	return strcmp(((struct word2vec_entry*) a)->key, ((struct word2vec_entry*) b)->key);
 }
 
+// makes room for one more key of at most WORD2VEC_KEY_BUFFER_SIZE bytes, NUL included
+static int32_t reserve_word2vec_key(struct word2vec* restrict const w2v, size_t* const capacity){
+	if(w2v->key_blob_size + WORD2VEC_KEY_BUFFER_SIZE <= *capacity){return 0;}
+	void* malloc_pointer = realloc(w2v->key_blob, (*capacity) * 2);
+	if(malloc_pointer == NULL){return 1;}
+	w2v->key_blob = (char*) malloc_pointer;
+	*capacity *= 2;
+	return 0;
+}
+
 int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict path){
 	const int32_t log_bfr_size = 256;
 	char log_bfr[log_bfr_size];
@@ -736,6 +833,11 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 	snprintf(log_bfr, log_bfr_size, "Creating graph from word2vec binary: %s", path);
 	info_format(__FILE__, __func__, __LINE__, log_bfr);
 
+	size_t* key_offsets = NULL;
+	w2v->vectors = NULL;
+	w2v->keys = NULL;
+	w2v->key_blob = NULL;
+
 	FILE* file_p;
 	file_p = fopen(path, "r");
 	if(file_p == NULL){
@@ -790,9 +892,13 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 	memset(malloc_pointer, '\0', malloc_size);
 	w2v->keys = (struct word2vec_entry*) malloc_pointer;
 
-    for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
-        pthread_mutex_init(&(w2v->keys[i].mutex), NULL);
-    }
+	// keys are appended to a single blob; entries point into it once it has stopped moving
+	size_t key_blob_capacity = w2v->num_vectors * 8 + WORD2VEC_KEY_BUFFER_SIZE;
+	w2v->key_blob = (char*) malloc(key_blob_capacity);
+	if(w2v->key_blob == NULL){goto malloc_fail;}
+	w2v->key_blob_size = 0;
+	key_offsets = (size_t*) malloc(w2v->num_vectors * sizeof(size_t));
+	if(key_offsets == NULL){goto malloc_fail;}
 
 	uint64_t parsing_key = 1;
 	uint64_t h = 0;
@@ -812,7 +918,11 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 					break;
 				}
 				if(h < WORD2VEC_KEY_BUFFER_SIZE - 1){
-					w2v->keys[i].key[h] = vector_buffer_read[j];
+					if(h == 0){
+						if(reserve_word2vec_key(w2v, &key_blob_capacity) != 0){goto malloc_fail;}
+						key_offsets[i] = w2v->key_blob_size;
+					}
+					w2v->key_blob[w2v->key_blob_size++] = vector_buffer_read[j];
 					h++;
 				}
 				j++;
@@ -836,6 +946,11 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 				j += sizeof(float);
 			}
 			if(k == w2v->num_dimensions){
+				if(h == 0){ // empty key
+					if(reserve_word2vec_key(w2v, &key_blob_capacity) != 0){goto malloc_fail;}
+					key_offsets[i] = w2v->key_blob_size;
+				}
+				w2v->key_blob[w2v->key_blob_size++] = '\0';
 				k = 0;
 				h = 0;
 				parsing_key = 1;
@@ -856,8 +971,10 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 	fclose(file_p);
 
 	for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
-		w2v->keys[i].active_in_current_graph = 0;
+		w2v->keys[i].key = w2v->key_blob + key_offsets[i];
+		w2v->keys[i].num_occurrences = 0;
 	}
+	free(key_offsets);
 
 	qsort((void*) w2v->keys, w2v->num_vectors, sizeof(struct word2vec_entry), word2vec_entry_cmp);
 
@@ -872,6 +989,8 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 	printf("errno: %i\n", errno);
 	if(w2v->vectors != NULL){free(w2v->vectors);}
 	if(w2v->keys != NULL){free(w2v->keys);}
+	free(w2v->key_blob);
+	free(key_offsets);
 	fclose(file_p);
 	goto return_failure;
 
@@ -879,23 +998,71 @@ int32_t load_word2vec_binary(struct word2vec* restrict w2v, const char* restrict
 	return 1;
 }
 
-void reset_word2vec_active_in_current_graph(struct word2vec* restrict const w2v){
-    for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
-        w2v->keys[i].active_in_current_graph = 0;
-    }
+// gives the graph an empty slot per entry of w2v; a graph is bound before its first graph_add_word2vec_occurrence
+int32_t graph_bind_word2vec(struct graph* const g, const struct word2vec* const w2v){
+	free(g->word2vec_slots);
+	g->num_word2vec_slots = 0;
+	g->word2vec_slots = (struct graph_word2vec_slot*) calloc(w2v->num_vectors > 0 ? w2v->num_vectors : 1, sizeof(struct graph_word2vec_slot));
+	if(g->word2vec_slots == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	g->num_word2vec_slots = w2v->num_vectors;
+	return 0;
+}
+
+// adds one occurrence of the entry to the graph; the first thread to see the entry creates its node, the others only increment its count
+int32_t graph_add_word2vec_occurrence(struct graph* const g, const struct word2vec* const w2v, struct word2vec_entry* const entry){
+	if(g->word2vec_slots == NULL || g->num_word2vec_slots != w2v->num_vectors){
+		perror("graph is not bound to this word2vec\n");
+		return 1;
+	}
+	struct graph_word2vec_slot* const slot = &(g->word2vec_slots[entry - w2v->keys]);
+	struct graph_node* node;
+	// the claiming thread may still be appending the node; if it fails, it releases the slot and the next thread claims it
+	while((node = __atomic_load_n(&(slot->node), __ATOMIC_ACQUIRE)) == NULL){
+		uint8_t expected = 0;
+		if(!__atomic_compare_exchange_n(&(slot->active), &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+			sched_yield();
+			continue;
+		}
+		struct graph_node local_node = {0};
+		uint64_t node_index;
+		if(create_graph_node(&local_node, w2v->num_dimensions, FP32) != 0){
+			perror("failed to call create_graph_node\n");
+			goto release_slot;
+		}
+		local_node.word2vec_entry_pointer = entry;
+		local_node.vector.fp32 = entry->vector;
+		local_node.num_dimensions = w2v->num_dimensions;
+		local_node.already_considered = 0;
+		local_node.relative_proportion = 1.0;
+		local_node.absolute_proportion = 1;
+		if(graph_append_node(g, &local_node, &node_index) != 0){
+			perror("failed to call graph_append_node\n");
+			goto release_slot;
+		}
+		slot->node_index = node_index;
+		__atomic_store_n(&(slot->node), graph_node_at(g, node_index), __ATOMIC_RELEASE);
+		return 0;
+
+		release_slot:
+		__atomic_store_n(&(slot->active), 0, __ATOMIC_RELEASE);
+		return 1;
+	}
+	__atomic_fetch_add(&(node->absolute_proportion), 1, __ATOMIC_RELAXED);
+	return 0;
 }
 
 void free_word2vec(struct word2vec* restrict w2v){
-    for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
-        pthread_mutex_destroy(&(w2v->keys[i].mutex));
-    }
 	free(w2v->vectors);
 	free(w2v->keys);
+	free(w2v->key_blob);
 }
 
 int32_t word2vec_key_to_index(const struct word2vec* restrict w2v, const char* restrict key){
 	int32_t lower_bound = 0;
-	int32_t higher_bound = w2v->num_vectors;
+	int32_t higher_bound = ((int32_t) w2v->num_vectors) - 1;
 	while(lower_bound <= higher_bound){
 		int32_t middle_index = lower_bound + floor((higher_bound - lower_bound) / 2.0);
 		int32_t cmp_res = strcmp(w2v->keys[middle_index].key, key);
@@ -970,16 +1137,25 @@ struct word2vec_entry* word2vec_find_closest(const struct word2vec* restrict w2v
 
 void free_graph(struct graph* restrict g){
 	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		// free_graph_node(&(g->nodes[i]), FP32); // not needed as pointers to w2v entries
-		free(g->nodes[i].neighbours);
+		// free_graph_node(graph_node_at(g, i), FP32); // not needed as pointers to w2v entries
+		free(graph_node_at(g, i)->neighbours);
 	}
-	free(g->nodes);
+	for(uint32_t i = 0 ; i < g->num_chunks ; i++){
+		free(g->chunks[i]);
+		g->chunks[i] = NULL;
+	}
+	g->num_chunks = 0;
+	g->capacity = 0;
     pthread_mutex_destroy(&(g->mutex_nodes));
 	// if(g->dist_mat != NULL){free(g->dist_mat);}
 	if(g->dist_mat_must_be_freed){
 		free_matrix(&(g->dist_mat));
 		g->dist_mat_must_be_freed = 0;
 	}
+	free_graph_snapshot(&(g->snapshot));
+	free(g->word2vec_slots);
+	g->word2vec_slots = NULL;
+	g->num_word2vec_slots = 0;
     pthread_mutex_destroy(&(g->mutex_matrix));
 }
 
@@ -1130,7 +1306,7 @@ void create_distance_two_nodes(struct distance_two_nodes* restrict distance, uin
 
 int32_t heap_is_min_heapified(struct graph_distance_heap* const heap){
 	struct distance_two_nodes * const restrict distances = heap->distances;
-	struct graph_node * const restrict nodes = heap->g->nodes;
+	const struct graph * const restrict nodes_graph = heap->g;
 
 	// for(uint64_t i = 0 ; i < heap->num_distances ; i++){
 	for(uint64_t i = 0 ; i * 2 < heap->num_distances ; i++){
@@ -1150,9 +1326,9 @@ int32_t heap_is_min_heapified(struct graph_distance_heap* const heap){
 	#endif
 
 		
-		uint64_t considered_count_i = (nodes[distances[i].a].already_considered >= 1) + (nodes[distances[i].b].already_considered >= 1);
-		uint64_t considered_count_a = (nodes[distances[child_a_index].a].already_considered >= 1) + (nodes[distances[child_a_index].b].already_considered >= 1);
-		uint64_t considered_count_b = (nodes[distances[child_b_index].a].already_considered >= 1) + (nodes[distances[child_b_index].b].already_considered >= 1);
+		uint64_t considered_count_i = (graph_node_at(nodes_graph, distances[i].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[i].b)->already_considered >= 1);
+		uint64_t considered_count_a = (graph_node_at(nodes_graph, distances[child_a_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_a_index].b)->already_considered >= 1);
+		uint64_t considered_count_b = (graph_node_at(nodes_graph, distances[child_b_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_b_index].b)->already_considered >= 1);
 
 		float dist_i = distances[i].distance;
 		float dist_a = distances[child_a_index].distance;
@@ -1191,7 +1367,7 @@ void siftdown_min_heap_v2(struct graph_distance_heap* const restrict heap, uint6
 #endif
 
 	struct distance_two_nodes * const restrict distances = heap->distances;
-	// struct graph_node * const restrict nodes = heap->g->nodes;
+	// const struct graph * const restrict nodes_graph = heap->g;
 
 	/*
 	if(current_index >= heap->num_distances){ // to handle case when doing popping when sifting?
@@ -1201,9 +1377,9 @@ void siftdown_min_heap_v2(struct graph_distance_heap* const restrict heap, uint6
 
 	/* // COMMENTING OUT FOR TESTING
 	// if(distances[current_index].a->already_considered && distances[current_index].b->already_considered){
-	if(nodes[distances[current_index].a].already_considered && nodes[distances[current_index].b].already_considered){ // ok but stack overflow?
-	// if(current_index < 100000 && nodes[distances[current_index].a].already_considered && nodes[distances[current_index].b].already_considered){
-	// if(current_index < 1000 && nodes[distances[current_index].a].already_considered && nodes[distances[current_index].b].already_considered){
+	if(graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){ // ok but stack overflow?
+	// if(current_index < 100000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
+	// if(current_index < 1000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
 		pop_graph_distance_min_heap_v2(heap, current_index); // pop_graph_distance_min_heap_v2 will call back siftdown_heap_v2 for current_index, so we can just return
 		return;
 	}
@@ -1302,7 +1478,7 @@ void siftdown_min_heap_v3(struct graph_distance_heap* const restrict heap, uint6
 #endif
 
 	struct distance_two_nodes * const restrict distances = heap->distances;
-	struct graph_node * const restrict nodes = heap->g->nodes;
+	const struct graph * const restrict nodes_graph = heap->g;
 
 	/*
 	if(current_index >= heap->num_distances){ // to handle case when doing popping when sifting?
@@ -1312,9 +1488,9 @@ void siftdown_min_heap_v3(struct graph_distance_heap* const restrict heap, uint6
 
 	/* // COMMENTING OUT FOR TESTING
 	// if(distances[current_index].a->already_considered && distances[current_index].b->already_considered){
-	if(nodes[distances[current_index].a].already_considered && nodes[distances[current_index].b].already_considered){ // ok but stack overflow?
-	// if(current_index < 100000 && nodes[distances[current_index].a].already_considered && nodes[distances[current_index].b].already_considered){
-	// if(current_index < 1000 && nodes[distances[current_index].a].already_considered && nodes[distances[current_index].b].already_considered){
+	if(graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){ // ok but stack overflow?
+	// if(current_index < 100000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
+	// if(current_index < 1000 && graph_node_at(nodes_graph, distances[current_index].a)->already_considered && graph_node_at(nodes_graph, distances[current_index].b)->already_considered){
 		pop_graph_distance_min_heap_v2(heap, current_index); // pop_graph_distance_min_heap_v2 will call back siftdown_heap_v2 for current_index, so we can just return
 		return;
 	}
@@ -1328,8 +1504,8 @@ void siftdown_min_heap_v3(struct graph_distance_heap* const restrict heap, uint6
 	uint64_t considered_count_curr;
 	/*
 	do{
-		// considered_count_curr = nodes[distances[current_index].a].already_considered + nodes[distances[current_index].b].already_considered;
-		considered_count_curr = (nodes[distances[current_index].a].already_considered >= 1) + (nodes[distances[current_index].b].already_considered >= 1);
+		// considered_count_curr = graph_node_at(nodes_graph, distances[current_index].a)->already_considered + graph_node_at(nodes_graph, distances[current_index].b)->already_considered;
+		considered_count_curr = (graph_node_at(nodes_graph, distances[current_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[current_index].b)->already_considered >= 1);
 		// REMOVING THIS FIXED AN ISSUE
 		if(considered_count_curr == 2){
 			printf("popping %lu %lu\n", current_index, heap->num_distances);
@@ -1342,13 +1518,13 @@ void siftdown_min_heap_v3(struct graph_distance_heap* const restrict heap, uint6
 		//break;
 	} while(1);
 	*/
-	considered_count_curr = (nodes[distances[current_index].a].already_considered >= 1) + (nodes[distances[current_index].b].already_considered >= 1);
+	considered_count_curr = (graph_node_at(nodes_graph, distances[current_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[current_index].b)->already_considered >= 1);
 	// REMOVING THIS FIXED AN ISSUE
 	/*
 		if(considered_count_curr == 2){
 			printf("popping %lu %lu\n", current_index, heap->num_distances);
 			pop_graph_distance_min_heap_v3(heap, current_index);
-			considered_count_curr = (nodes[distances[current_index].a].already_considered >= 1) + (nodes[distances[current_index].b].already_considered >= 1);
+			considered_count_curr = (graph_node_at(nodes_graph, distances[current_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[current_index].b)->already_considered >= 1);
 			if(current_index >= heap->num_distances){return;}
 		}
 	*/
@@ -1377,11 +1553,11 @@ void siftdown_min_heap_v3(struct graph_distance_heap* const restrict heap, uint6
 		float dist_b = 1.0e100;
 		if(reachable_a){
 			dist_a = distances[child_a_index].distance;
-			// considered_count_a = nodes[distances[child_a_index].a].already_considered + nodes[distances[child_a_index].b].already_considered;
-			considered_count_a = (nodes[distances[child_a_index].a].already_considered >= 1) + (nodes[distances[child_a_index].b].already_considered >= 1);
+			// considered_count_a = graph_node_at(nodes_graph, distances[child_a_index].a)->already_considered + graph_node_at(nodes_graph, distances[child_a_index].b)->already_considered;
+			considered_count_a = (graph_node_at(nodes_graph, distances[child_a_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_a_index].b)->already_considered >= 1);
 			if(reachable_b){
 				dist_b = distances[child_b_index].distance;
-				considered_count_b = (nodes[distances[child_b_index].a].already_considered >= 1) + (nodes[distances[child_b_index].b].already_considered >= 1);
+				considered_count_b = (graph_node_at(nodes_graph, distances[child_b_index].a)->already_considered >= 1) + (graph_node_at(nodes_graph, distances[child_b_index].b)->already_considered >= 1);
 			}
 		}
 
@@ -1495,7 +1671,7 @@ void heapify_min_heap(struct graph_distance_heap* const restrict heap){
 	#if MST_IMPLEMENTATION_VERSION == 3
 	while(heap->num_distances > 0){
 		uint64_t n = heap->num_distances - 1;
-		uint64_t considered_count = (heap->g->nodes[heap->distances[n].a].already_considered >= 1) + (heap->g->nodes[heap->distances[n].b].already_considered >= 1);
+		uint64_t considered_count = (graph_node_at(heap->g, heap->distances[n].a)->already_considered >= 1) + (graph_node_at(heap->g, heap->distances[n].b)->already_considered >= 1);
 		if(considered_count == 2){
 			heap->num_distances--;
 			// printf("reduced to %lu distances\n", heap->num_distances);
@@ -1515,7 +1691,7 @@ void heapify_min_heap(struct graph_distance_heap* const restrict heap){
 #elif MST_IMPLEMENTATION_VERSION == 2
 		siftdown_min_heap_v2(heap, i);
 #elif MST_IMPLEMENTATION_VERSION == 3
-		uint64_t considered_count = (heap->g->nodes[heap->distances[i].a].already_considered >= 1) + (heap->g->nodes[heap->distances[i].b].already_considered >= 1);
+		uint64_t considered_count = (graph_node_at(heap->g, heap->distances[i].a)->already_considered >= 1) + (graph_node_at(heap->g, heap->distances[i].b)->already_considered >= 1);
 		if(considered_count == 2){
 			if(i == heap->num_distances - 1){
 				heap->num_distances--;
@@ -1527,7 +1703,7 @@ void heapify_min_heap(struct graph_distance_heap* const restrict heap){
 			}
 			/*
 			uint64_t n = heap->num_distances - 1;
-			uint64_t considered_count_n = (heap->g->nodes[heap->distances[n].a].already_considered >= 1) + (heap->g->nodes[heap->distances[n].b].already_considered >= 1);
+			uint64_t considered_count_n = (graph_node_at(heap->g, heap->distances[n].a)->already_considered >= 1) + (graph_node_at(heap->g, heap->distances[n].b)->already_considered >= 1);
 			if(considered_count_n == 2){
 				heap->num_distances--;
 				// printf("reduced to %lu distances\n", heap->num_distances);
@@ -1604,9 +1780,9 @@ int32_t create_graph_distance_heap(struct graph_distance_heap* restrict heap, st
 		for(uint64_t j = i + 1 ; j < g->num_nodes ; j++){
 			/*
 			if(m_ == NULL){
-				create_distance_two_nodes(&(heap->distances[distance_index]), &(g->nodes[i]), &(g->nodes[j]), fp_mode, NULL);
+				create_distance_two_nodes(&(heap->distances[distance_index]), graph_node_at(g, i), graph_node_at(g, j), fp_mode, NULL);
 			} else {
-				create_distance_two_nodes(&(heap->distances[distance_index]), &(g->nodes[i]), &(g->nodes[j]), fp_mode, &(m_->bfr.fp32[i * m_->b + j]));	
+				create_distance_two_nodes(&(heap->distances[distance_index]), graph_node_at(g, i), graph_node_at(g, j), fp_mode, &(m_->bfr.fp32[i * m_->b + j]));	
 			}
 			*/
 			create_distance_two_nodes(heap->distances + distance_index, i, j, m_->bfr.fp32[i * m_->b + j]);
@@ -1643,6 +1819,41 @@ int32_t create_graph_distance_heap(struct graph_distance_heap* restrict heap, st
 	return 1;
 }
 
+// heap of the edges that can be in the minimum spanning tree of g once nodes were appended from first_new_node on:
+// by the cycle property, the tree of the previous nodes (num_tree_distances edges) and the distances of the new nodes
+int32_t create_graph_distance_heap_from_tree(struct graph_distance_heap* restrict heap, struct graph* restrict g, const struct matrix* const m, const struct distance_two_nodes* const tree, const uint64_t num_tree_distances, const uint64_t first_new_node){
+	const uint64_t n = g->num_nodes;
+	const uint64_t num_distances = num_tree_distances + (n > 0 ? (n * (n - 1)) / 2 : 0) - (first_new_node > 0 ? (first_new_node * (first_new_node - 1)) / 2 : 0);
+
+	void* const alloc_pointer = realloc(heap->distances, (num_distances + 1) * sizeof(struct distance_two_nodes));
+	if(alloc_pointer == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	heap->g = g;
+	heap->distances = (struct distance_two_nodes*) alloc_pointer;
+
+	memcpy(heap->distances, tree, num_tree_distances * sizeof(struct distance_two_nodes));
+	uint64_t distance_index = num_tree_distances;
+	for(uint64_t j = first_new_node ; j < n ; j++){
+		for(uint64_t i = 0 ; i < j ; i++){
+			const float distance = m->fp_mode == FP64 ? (float) m->bfr.fp64[i * m->b + j] : m->bfr.fp32[i * m->b + j];
+			create_distance_two_nodes(heap->distances + distance_index, i, j, distance);
+			distance_index++;
+		}
+	}
+	if(distance_index != num_distances){
+		perror("distance_index != num_distances\n");
+		return 1;
+	}
+	heap->num_distances = num_distances;
+	heap->num_distances_memory = num_distances;
+
+	heapify(heap, MIN_HEAP);
+
+	return 0;
+}
+
 void pop_graph_distance_min_heap(struct graph_distance_heap* restrict heap, const uint64_t current_index){
 	uint64_t child_a_index;
 	uint64_t child_b_index;
@@ -1796,8 +2007,8 @@ int32_t find_minimum_acceptable_arc(struct minimum_spanning_tree* mst, uint64_t
 
 	// int32_t a_already_present = mst->heap->distances[current_index].a->already_considered;
 	// int32_t b_already_present = mst->heap->distances[current_index].b->already_considered;
-	const int32_t a_already_present = mst->heap->g->nodes[mst->heap->distances[current_index].a].already_considered;
-	const int32_t b_already_present = mst->heap->g->nodes[mst->heap->distances[current_index].b].already_considered;
+	const int32_t a_already_present = graph_node_at(mst->heap->g, mst->heap->distances[current_index].a)->already_considered;
+	const int32_t b_already_present = graph_node_at(mst->heap->g, mst->heap->distances[current_index].b)->already_considered;
 
 	// trying to add a pop (new here)
 	if(a_already_present && b_already_present){
@@ -1864,7 +2075,7 @@ int32_t find_minimum_acceptable_arc(struct minimum_spanning_tree* mst, uint64_t
 int32_t calculate_minimum_spanning_tree(struct minimum_spanning_tree* mst, struct matrix* m_in, int32_t method){
 	const uint64_t n = mst->heap->g->num_nodes;
 	for(uint64_t i = 0 ; i < n ; i++){
-		mst->heap->g->nodes[i].already_considered = 0;
+		graph_node_at(mst->heap->g, i)->already_considered = 0;
 	}
 	mst->heap->num_distances = mst->heap->num_distances_memory;
 	mst->num_active_nodes = 0;
@@ -1882,16 +2093,16 @@ int32_t calculate_minimum_spanning_tree(struct minimum_spanning_tree* mst, struc
 			mst->distances[mst->num_active_distances] = mst->heap->distances[0];
 			mst->num_active_distances++;
 			// mst->nodes[mst->num_active_nodes] = mst->heap->distances[0].a;
-			mst->nodes[mst->num_active_nodes] = &(mst->heap->g->nodes[mst->heap->distances[0].a]);
+			mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[0].a);
 			mst->num_active_nodes++;
 			// mst->nodes[mst->num_active_nodes] = mst->heap->distances[0].b;
-			mst->nodes[mst->num_active_nodes] = &(mst->heap->g->nodes[mst->heap->distances[0].b]);
+			mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[0].b);
 			mst->num_active_nodes++;
 
 			// mst->heap->distances[0].a->already_considered = 1;
 			// mst->heap->distances[0].b->already_considered = 1;
-			mst->heap->g->nodes[mst->heap->distances[0].a].already_considered = 1;
-			mst->heap->g->nodes[mst->heap->distances[0].b].already_considered = 1;
+			graph_node_at(mst->heap->g, mst->heap->distances[0].a)->already_considered = 1;
+			graph_node_at(mst->heap->g, mst->heap->distances[0].b)->already_considered = 1;
 
 			pop_graph_distance_heap(mst->heap, MIN_HEAP, 0);
 		}
@@ -1917,8 +2128,8 @@ int32_t calculate_minimum_spanning_tree(struct minimum_spanning_tree* mst, struc
 			/*
 			int64_t index_of_arc_to_add = -1;
 			for(int32_t k = 0 ; k < mst->heap->num_distances ; k++){
-				int64_t a_present = mst->heap->g->nodes[mst->heap->distances[k].a].already_considered;
-				int64_t b_present = mst->heap->g->nodes[mst->heap->distances[k].b].already_considered;
+				int64_t a_present = graph_node_at(mst->heap->g, mst->heap->distances[k].a)->already_considered;
+				int64_t b_present = graph_node_at(mst->heap->g, mst->heap->distances[k].b)->already_considered;
 				if(a_present ^ b_present && (index_of_arc_to_add == -1 || mst->heap->distances[k].distance < mst->heap->distances[index_of_arc_to_add].distance)){
 					index_of_arc_to_add = k;
 				}
@@ -1940,8 +2151,8 @@ int32_t calculate_minimum_spanning_tree(struct minimum_spanning_tree* mst, struc
 
 			// a_already_present = mst->heap->distances[index_of_arc_to_add].a->already_considered;
 			// b_already_present = mst->heap->distances[index_of_arc_to_add].b->already_considered;
-			a_already_present = mst->heap->g->nodes[mst->heap->distances[index_of_arc_to_add].a].already_considered;
-			b_already_present = mst->heap->g->nodes[mst->heap->distances[index_of_arc_to_add].b].already_considered;
+			a_already_present = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].a)->already_considered;
+			b_already_present = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].b)->already_considered;
 
 			if(!(a_already_present ^ b_already_present)){
 				printf("a_already_present: %i, b_already_present: %i\n", a_already_present, b_already_present);
@@ -1950,19 +2161,19 @@ int32_t calculate_minimum_spanning_tree(struct minimum_spanning_tree* mst, struc
 			mst->num_active_distances++;
 			if(!a_already_present){
 				// mst->nodes[mst->num_active_nodes] = mst->heap->distances[index_of_arc_to_add].a;
-				mst->nodes[mst->num_active_nodes] = &(mst->heap->g->nodes[mst->heap->distances[index_of_arc_to_add].a]);
+				mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].a);
 				mst->num_active_nodes++;
 
 				// mst->heap->distances[index_of_arc_to_add].a->already_considered = 1;
-				mst->heap->g->nodes[mst->heap->distances[index_of_arc_to_add].a].already_considered = 1;
+				graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].a)->already_considered = 1;
 			}
 			if(!b_already_present){
 				// mst->nodes[mst->num_active_nodes] = mst->heap->distances[index_of_arc_to_add].b;
-				mst->nodes[mst->num_active_nodes] = &(mst->heap->g->nodes[mst->heap->distances[index_of_arc_to_add].b]);
+				mst->nodes[mst->num_active_nodes] = graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].b);
 				mst->num_active_nodes++;
 
 				// mst->heap->distances[index_of_arc_to_add].b->already_considered = 1;
-				mst->heap->g->nodes[mst->heap->distances[index_of_arc_to_add].b].already_considered = 1;
+				graph_node_at(mst->heap->g, mst->heap->distances[index_of_arc_to_add].b)->already_considered = 1;
 			}
 			// #if MST_IMPLEMENTATION_VERSION == 1 || MST_IMPLEMENTATION_VERSION == 2
 			pop_graph_distance_heap(mst->heap, MIN_HEAP, index_of_arc_to_add);
@@ -2031,8 +2242,8 @@ int32_t functional_evenness_from_minimum_spanning_tree(struct minimum_spanning_t
 	for(uint64_t i = 0 ; i < mst->num_active_distances ; i++){
 		// double weight_a = (*(mst->distances[i].a)).relative_proportion;
 		// double weight_b = (*(mst->distances[i].b)).relative_proportion;
-		const double weight_a = mst->heap->g->nodes[mst->distances[i].a].relative_proportion;
-		const double weight_b = mst->heap->g->nodes[mst->distances[i].b].relative_proportion;
+		const double weight_a = mst->heap->g->snapshot.relative_proportions[mst->distances[i].a];
+		const double weight_b = mst->heap->g->snapshot.relative_proportions[mst->distances[i].b];
 		all_ew[i] = mst->distances[i].distance / (weight_a + weight_b);
 		ew_sum += all_ew[i];
 	}
@@ -2064,20 +2275,20 @@ int32_t functional_evenness_from_minimum_spanning_tree(struct minimum_spanning_t
 int32_t functional_dispersion_from_graph(struct graph* const g, double* const result_buffer, const int8_t fp_mode){
 	// see Laliberté & Legendre (2010)
 	
-	struct graph_node centroid;
+	struct graph_node centroid = {0};
 	int32_t res;
 	double result;
 	double sum_relative_proportion;
 
-	res = create_graph_node(&centroid, (*g).nodes[0].num_dimensions, fp_mode);
+	res = create_graph_node(&centroid, graph_node_at(g, 0)->num_dimensions, fp_mode);
 	if(res != 0){goto create_graph_node_failed;}
 
-	centroid.num_dimensions = g->nodes[0].num_dimensions;
+	centroid.num_dimensions = graph_node_at(g, 0)->num_dimensions;
 	size_t malloc_size;
 	switch(fp_mode){
 		case FP32:
 			if(centroid.vector.fp32 == NULL){
-				malloc_size = g->nodes[0].num_dimensions * sizeof(float);
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(float);
 				void * p = malloc(malloc_size);
 				if(p == NULL){
 					perror("malloc failed\n");
@@ -2089,7 +2300,7 @@ int32_t functional_dispersion_from_graph(struct graph* const g, double* const re
 			break;
 		case FP64:
 			if(centroid.vector.fp64 == NULL){
-				malloc_size = g->nodes[0].num_dimensions * sizeof(double);
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(double);
 				void * p = malloc(malloc_size);
 				if(p == NULL){
 					perror("malloc failed\n");
@@ -2102,13 +2313,13 @@ int32_t functional_dispersion_from_graph(struct graph* const g, double* const re
 	}
 
 	for(uint64_t i = 0 ; i < (*g).num_nodes ; i++){
-		for(uint64_t j = 0 ; j < (*g).nodes[i].num_dimensions ; j++){
+		for(uint64_t j = 0 ; j < g->snapshot.num_dimensions ; j++){
 			switch(fp_mode){
 				case GRAPH_NODE_FP32:
-					centroid.vector.fp32[j] += (*g).nodes[i].vector.fp32[j] * (*g).nodes[i].relative_proportion;
+					centroid.vector.fp32[j] += graph_snapshot_row(&(g->snapshot), i)[j] * g->snapshot.relative_proportions[i];
 					break;
 				case GRAPH_NODE_FP64:
-					centroid.vector.fp64[j] += (*g).nodes[i].vector.fp64[j] * (*g).nodes[i].relative_proportion;
+					centroid.vector.fp64[j] += graph_node_at(g, i)->vector.fp64[j] * g->snapshot.relative_proportions[i];
 					break;
 			}
 		}
@@ -2120,20 +2331,20 @@ int32_t functional_dispersion_from_graph(struct graph* const g, double* const re
 		switch(fp_mode){
 			case GRAPH_NODE_FP32:
 				#if ENABLE_AVX512 == 1
-				result += cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				result += cosine_distance_fp32_avx512(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
 				#elif ENABLE_AVX256 == 1
-				result += cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				result += cosine_distance_fp32_avx256(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
 				#elif MST_SANITY_TESTING == 1
-				result += minkowski_distance_fp32(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions, 2.0f) * g->nodes[i].relative_proportion;
+				result += minkowski_distance_fp32((float*) graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions, 2.0f) * g->snapshot.relative_proportions[i];
 				#else
-				result += cosine_distance_fp32(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				result += cosine_distance_fp32(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
 				#endif
 				break;
 			case GRAPH_NODE_FP64:
-				result += cosine_distance(g->nodes[i].vector.fp64, centroid.vector.fp64, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				result += cosine_distance(graph_node_at(g, i)->vector.fp64, centroid.vector.fp64, graph_node_at(g, i)->num_dimensions) * g->snapshot.relative_proportions[i];
 				break;
 		}
-		sum_relative_proportion += (*g).nodes[i].relative_proportion;
+		sum_relative_proportion += g->snapshot.relative_proportions[i];
 	}
 	result /= sum_relative_proportion;
 	(*result_buffer) = result;
@@ -2151,21 +2362,21 @@ int32_t functional_divergence_modified_from_graph(struct graph* const g, double*
 	// see Villéger et al. (2008)
 	// modifications: compute centroids based on all points instead of convex hull; cosine distance instead of euclidean
 	
-	struct graph_node centroid;
+	struct graph_node centroid = {0};
 	int32_t res;
 
-	res = create_graph_node(&centroid, g->nodes[0].num_dimensions, fp_mode);
+	res = create_graph_node(&centroid, graph_node_at(g, 0)->num_dimensions, fp_mode);
 	if(res != 0){
 		perror("created_graph_node_failed\n");
 		return 1;
 	}
 
-	centroid.num_dimensions = g->nodes[0].num_dimensions;
+	centroid.num_dimensions = graph_node_at(g, 0)->num_dimensions;
 	size_t malloc_size;
 	switch(fp_mode){
 		case FP32:
 			if(centroid.vector.fp32 == NULL){
-				malloc_size = g->nodes[0].num_dimensions * sizeof(float);
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(float);
 				void * p = malloc(malloc_size);
 				if(p == NULL){
 					perror("malloc failed\n");
@@ -2177,7 +2388,7 @@ int32_t functional_divergence_modified_from_graph(struct graph* const g, double*
 			break;
 		case FP64:
 			if(centroid.vector.fp64 == NULL){
-				malloc_size = g->nodes[0].num_dimensions * sizeof(double);
+				malloc_size = graph_node_at(g, 0)->num_dimensions * sizeof(double);
 				void * p = malloc(malloc_size);
 				if(p == NULL){
 					perror("malloc failed\n");
@@ -2190,13 +2401,13 @@ int32_t functional_divergence_modified_from_graph(struct graph* const g, double*
 	}
 
 	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
-		for(uint64_t j = 0 ; j < g->nodes[i].num_dimensions ; j++){
+		for(uint64_t j = 0 ; j < g->snapshot.num_dimensions ; j++){
 			switch(fp_mode){
 				case GRAPH_NODE_FP32:
-					centroid.vector.fp32[j] += g->nodes[i].vector.fp32[j] * g->nodes[i].relative_proportion;
+					centroid.vector.fp32[j] += graph_snapshot_row(&(g->snapshot), i)[j] * g->snapshot.relative_proportions[i];
 					break;
 				case GRAPH_NODE_FP64:
-					centroid.vector.fp64[j] += g->nodes[i].vector.fp64[j] * g->nodes[i].relative_proportion;
+					centroid.vector.fp64[j] += graph_node_at(g, i)->vector.fp64[j] * g->snapshot.relative_proportions[i];
 					break;
 			}
 		}
@@ -2207,17 +2418,17 @@ int32_t functional_divergence_modified_from_graph(struct graph* const g, double*
 		switch(fp_mode){
 			case GRAPH_NODE_FP32:
 				#if ENABLE_AVX512 == 1
-				distances_to_centroid[i] = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				distances_to_centroid[i] = (double) cosine_distance_fp32_avx512(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
 				#elif ENABLE_AVX256 == 1
-				distances_to_centroid[i] = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				distances_to_centroid[i] = (double) cosine_distance_fp32_avx256(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
 				#elif MST_SANITY_TESTING == 1
-				distances_to_centroid[i] = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions, 2.0f) * g->nodes[i].relative_proportion;
+				distances_to_centroid[i] = (double) minkowski_distance_fp32((float*) graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions, 2.0f) * g->snapshot.relative_proportions[i];
 				#else
-				distances_to_centroid[i] = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, centroid.vector.fp32, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				distances_to_centroid[i] = (double) cosine_distance_fp32(graph_snapshot_row(&(g->snapshot), i), centroid.vector.fp32, g->snapshot.num_dimensions) * g->snapshot.relative_proportions[i];
 				#endif
 				break;
 			case GRAPH_NODE_FP64:
-				distances_to_centroid[i] = cosine_distance(g->nodes[i].vector.fp64, centroid.vector.fp64, g->nodes[i].num_dimensions) * g->nodes[i].relative_proportion;
+				distances_to_centroid[i] = cosine_distance(graph_node_at(g, i)->vector.fp64, centroid.vector.fp64, graph_node_at(g, i)->num_dimensions) * g->snapshot.relative_proportions[i];
 				break;
 		}
 	}
@@ -2234,8 +2445,8 @@ int32_t functional_divergence_modified_from_graph(struct graph* const g, double*
 		if(local_deviance_abs < 0.0){
 			local_deviance_abs *= -1.0;
 		}
-		weighted_deviance += g->nodes[i].relative_proportion * local_deviance;
-		weighted_deviance_abs += g->nodes[i].relative_proportion * local_deviance_abs;
+		weighted_deviance += g->snapshot.relative_proportions[i] * local_deviance;
+		weighted_deviance_abs += g->snapshot.relative_proportions[i] * local_deviance_abs;
 	}
 
 	double functional_divergence = (weighted_deviance + avg_distances_to_centroid) / (weighted_deviance_abs + avg_distances_to_centroid);
@@ -2340,7 +2551,7 @@ int32_t create_iterative_state_stirling_from_graph(struct iterative_state_stirli
 
 void iterate_iterative_state_stirling_from_graph(struct iterative_state_stirling_from_graph* const restrict iter_state, const float* const vector){
 	for(uint64_t j = 0 ; j < iter_state->g->num_nodes ; j++){
-		iter_state->result += pow((double) vector[j], iter_state->alpha) * pow(iter_state->g->nodes[iter_state->i].relative_proportion * iter_state->g->nodes[j].relative_proportion, iter_state->beta);
+		iter_state->result += pow((double) vector[j], iter_state->alpha) * pow(iter_state->g->snapshot.relative_proportions[iter_state->i] * iter_state->g->snapshot.relative_proportions[j], iter_state->beta);
 	}
 	iter_state->i++;
 }
@@ -2354,7 +2565,7 @@ void* iterate_iterative_state_stirling_from_graph_thread(void* args){
 
 	const uint64_t n = (uint64_t) iter_state->g->num_nodes;
 	while(j < n){
-		sum += pow((double) vector[j], iter_state->alpha) * pow(iter_state->g->nodes[iter_state->i].relative_proportion * iter_state->g->nodes[j].relative_proportion, iter_state->beta);
+		sum += pow((double) vector[j], iter_state->alpha) * pow(iter_state->g->snapshot.relative_proportions[iter_state->i] * iter_state->g->snapshot.relative_proportions[j], iter_state->beta);
 		j++;
 	}
 
@@ -2393,12 +2604,12 @@ void iterate_iterative_state_leinster_cobbold_from_graph(struct iterative_state_
 	for(uint64_t j = 0 ; j < iter_state->g->num_nodes ; j++){
 		double distance = (double) vector[j];
 		double similarity = 1.0 - distance;
-		local_agg += iter_state->g->nodes[j].relative_proportion * pow(E, -u * similarity);
+		local_agg += iter_state->g->snapshot.relative_proportions[j] * pow(E, -u * similarity);
 	}
 	if(iter_state->alpha != 1.0){
 		iter_state->hill_number += pow(local_agg, iter_state->alpha - 1.0);
 	} else {
-		iter_state->hill_number *= pow(local_agg, iter_state->g->nodes[iter_state->i].relative_proportion);
+		iter_state->hill_number *= pow(local_agg, iter_state->g->snapshot.relative_proportions[iter_state->i]);
 	}
 	iter_state->i++;
 }
@@ -2417,7 +2628,7 @@ void* iterate_iterative_state_leinster_cobbold_from_graph_thread(void* args){
 	while(j < n){
 		double distance = (double) vector[j];
 		double similarity = 1.0 - distance;
-		local_agg += iter_state->g->nodes[j].relative_proportion * pow(E, -u * similarity);
+		local_agg += iter_state->g->snapshot.relative_proportions[j] * pow(E, -u * similarity);
 		j++;
 	}
 
@@ -2425,7 +2636,7 @@ void* iterate_iterative_state_leinster_cobbold_from_graph_thread(void* args){
 	if(iter_state->alpha != 1.0){
 		iter_state->hill_number += pow(local_agg, iter_state->alpha - 1.0);
 	} else {
-		iter_state->hill_number *= pow(local_agg, iter_state->g->nodes[iter_state->i].relative_proportion);
+		iter_state->hill_number *= pow(local_agg, iter_state->g->snapshot.relative_proportions[iter_state->i]);
 	}
 	pthread_mutex_unlock(&(iter_state->mutex));
 
@@ -2471,18 +2682,10 @@ int32_t pairwise_from_graph(struct graph* const g, double* const result_buffer,
 			}
 			switch(fp_mode){
 				case GRAPH_NODE_FP32:
-					#if ENABLE_AVX512 == 1
-					result += cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif ENABLE_AVX256 == 1
-					result += cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif MST_SANITY_TESTING == 1
-					result += minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-					#else
-					result += cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#endif
+					result += graph_snapshot_distance(&(g->snapshot), i, j);
 					break;
 				case GRAPH_NODE_FP64:
-					result += cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+					result += cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 					break;
 			}
 		}
@@ -2497,7 +2700,6 @@ int32_t pairwise_from_graph(struct graph* const g, double* const result_buffer,
 
 int32_t word2vec_to_graph_fp32(struct graph* g, struct word2vec* w2v, char** cupt_paths, char** cupt_paths_true_positives, int32_t num_cupt_paths, int32_t ud_column, const char * const ec_cfg){
 	for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
-		w2v->keys[i].active_in_current_graph = 0;
 		w2v->keys[i].num_occurrences = 0;
 	}
 	int32_t num_nodes = 0;
@@ -2596,8 +2798,7 @@ int32_t word2vec_to_graph_fp32(struct graph* g, struct word2vec* w2v, char** cup
 						return 1;
 				}
 				if(index != -1){
-					if(w2v->keys[index].active_in_current_graph == 0){
-						w2v->keys[index].active_in_current_graph = 1;
+					if(w2v->keys[index].num_occurrences == 0){
 						num_nodes++;
 					}
 					w2v->keys[index].num_occurrences++;
@@ -2643,8 +2844,7 @@ int32_t word2vec_to_graph_fp32(struct graph* g, struct word2vec* w2v, char** cup
 
 				int32_t index = word2vec_key_to_index(w2v, bfr);
 				if(index != -1){
-					if(w2v->keys[index].active_in_current_graph == 0){
-						w2v->keys[index].active_in_current_graph = 1;
+					if(w2v->keys[index].num_occurrences == 0){
 						num_nodes++;
 					}
 					w2v->keys[index].num_occurrences++;
@@ -2676,32 +2876,25 @@ int32_t word2vec_to_graph_fp32(struct graph* g, struct word2vec* w2v, char** cup
 		}
 	}
 
-	size_t malloc_size = num_nodes * sizeof(struct graph_node);
-	void* malloc_pointer = malloc(malloc_size);
-	if(malloc_pointer == NULL){goto malloc_fail;}
-	memset(malloc_pointer, '\0', malloc_size);
-	g->nodes = (struct graph_node*) malloc_pointer;
+	if(create_graph_empty(g) != 0){goto malloc_fail;}
+	while(g->capacity < (uint64_t) num_nodes){
+		if(request_more_capacity_graph(g) != 0){goto malloc_fail;}
+	}
 	g->num_nodes = num_nodes;
 
-	double relative_proportion_sum = 0.0;
-
 	uint64_t i = 0; // changes for iterative update -> disabled
 	uint64_t j = 0;
 	while(i < g->num_nodes && j < w2v->num_vectors){
-		if(w2v->keys[j].active_in_current_graph == 1){
-			g->nodes[i].num_dimensions = w2v->num_dimensions;
-			g->nodes[i].vector.fp32 = w2v->keys[j].vector;
-			g->nodes[i].relative_proportion = (double) w2v->keys[j].num_occurrences;
-			g->nodes[i].absolute_proportion = (int32_t) w2v->keys[j].num_occurrences;
-			relative_proportion_sum += (double) w2v->keys[j].num_occurrences;
+		if(w2v->keys[j].num_occurrences > 0){
+			graph_node_at(g, i)->num_dimensions = w2v->num_dimensions;
+			graph_node_at(g, i)->vector.fp32 = w2v->keys[j].vector;
+			graph_node_at(g, i)->absolute_proportion = w2v->keys[j].num_occurrences;
 			i++;
 		}
 		j++;
 	}
 
-	for(uint64_t k = 0 ; k < g->num_nodes ; k++){
-		g->nodes[k].relative_proportion /= relative_proportion_sum;
-	}
+	if(compute_graph_relative_proportions(g) != 0){goto malloc_fail;}
 
 	return 0;
 
@@ -2833,19 +3026,11 @@ int32_t weitzman_from_graph(struct graph* const g, double* const res, const int8
 			double distance = 0.0;
 			switch(fp_mode){
 				case FP32:
-					#if ENABLE_AVX512 == 1
-					distance = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif ENABLE_AVX256 == 1
-					distance = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#elif MST_SANITY_TESTING == 1
-					distance = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-					#else
-					distance = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-					#endif
+					distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
 					m.bfr.fp32[index_in_buffer] = (float) distance;
 					break;
 				case FP64:
-					distance = cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+					distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 					m.bfr.fp64[index_in_buffer] = distance;
 					break;
 			}
@@ -3046,19 +3231,11 @@ int32_t lexicographic_from_graph(struct graph* const g, double* const res, long
 				double distance = 0.0;
 				switch(fp_mode){
 					case FP32:
-						#if ENABLE_AVX512 == 1
-						distance = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif ENABLE_AVX256 == 1
-						distance = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif MST_SANITY_TESTING == 1
-						distance = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-						#else
-						distance = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#endif
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
 						m.bfr.fp32[index_in_buffer] = (float) distance;
 						break;
 					case FP64:
-						distance = cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 						m.bfr.fp64[index_in_buffer] = distance;
 						break;
 				}
@@ -3104,22 +3281,14 @@ int32_t stirling_from_graph(struct graph* g, double* restrict const result, cons
 			} else {
 				switch(fp_mode){
 					case FP32:
-						#if ENABLE_AVX512 == 1
-						distance = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif ENABLE_AVX256 == 1
-						distance = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif MST_SANITY_TESTING == 1
-						distance = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-						#else
-						distance = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#endif
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
 						break;
 					case FP64:
-						distance = cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 						break;
 				}
 			}
-			double proportion_product = g->nodes[i].relative_proportion * g->nodes[j].relative_proportion;
+			double proportion_product = g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j];
 			local_result += pow(distance, alpha_arg) * pow(proportion_product, beta_arg);
 			assert((!isnan(local_result)) && isfinite(local_result));
 		}
@@ -3157,18 +3326,10 @@ int32_t ricotta_szeidl_from_graph(struct graph* const g, double* const result, c
 			} else {
 				switch(fp_mode){
 					case FP32:
-						#if ENABLE_AVX512 == 1
-						distance = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif ENABLE_AVX256 == 1
-						distance = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif MST_SANITY_TESTING == 1
-						distance = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-						#else
-						distance = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#endif
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
 						break;
 					case FP64:
-						distance = cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 						break;
 				}
 			}
@@ -3177,22 +3338,22 @@ int32_t ricotta_szeidl_from_graph(struct graph* const g, double* const result, c
 			}
 
             if(alpha_arg != 1.0){
-			    local_sum -= distance * g->nodes[j].relative_proportion;
+			    local_sum -= distance * g->snapshot.relative_proportions[j];
             } else {
-                local_sum += (1.0 - distance) * g->nodes[j].relative_proportion;
+                local_sum += (1.0 - distance) * g->snapshot.relative_proportions[j];
             }
 		}
 
         if(alpha_arg != 1.0){
-    		double product = g->nodes[i].relative_proportion * pow(local_sum, alpha_arg - 1.0);
+    		double product = g->snapshot.relative_proportions[i] * pow(local_sum, alpha_arg - 1.0);
     		if(isnan(product)){
-    			printf("product is nan; relative_proportion: %f, pow: %f, local_sum: %f, alpha[k] - 1.0: %f\r", g->nodes[i].relative_proportion, pow(local_sum, alpha_arg - 1.0), local_sum, alpha_arg - 1.0);
+    			printf("product is nan; relative_proportion: %f, pow: %f, local_sum: %f, alpha[k] - 1.0: %f\r", g->snapshot.relative_proportions[i], pow(local_sum, alpha_arg - 1.0), local_sum, alpha_arg - 1.0);
     			continue;
     		}
     		local_result += product;
         } else {
 	    assert(local_sum >= 0.0);
-            if(local_sum != 0.0){local_result += g->nodes[i].relative_proportion * log(local_sum);}
+            if(local_sum != 0.0){local_result += g->snapshot.relative_proportions[i] * log(local_sum);}
         }
 	}
 
@@ -3242,18 +3403,10 @@ int32_t chao_et_al_functional_diversity_from_graph(struct graph* const g, double
 			} else {
 				switch(fp_mode){
 					case FP32:
-						#if ENABLE_AVX512 == 1
-						distance = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif ENABLE_AVX256 == 1
-						distance = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif MST_SANITY_TESTING == 1
-						distance = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-						#else
-						distance = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#endif
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
 						break;
 					case FP64:
-						distance = cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 						break;
 					default:
 						perror("unknown FP mode\n");
@@ -3263,7 +3416,7 @@ int32_t chao_et_al_functional_diversity_from_graph(struct graph* const g, double
 			if(m_ == NULL){
 				matrix[(i * g->num_nodes) + j] = distance;
 			}
-			rao_q += distance * g->nodes[i].relative_proportion * g->nodes[j].relative_proportion;
+			rao_q += distance * g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j];
 		}
 	}
 
@@ -3287,9 +3440,9 @@ int32_t chao_et_al_functional_diversity_from_graph(struct graph* const g, double
 				}
 			}
 			if(alpha != 1.0){
-				diversity += distance * pow((g->nodes[i].relative_proportion * g->nodes[j].relative_proportion) / rao_q, alpha);
+				diversity += distance * pow((g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j]) / rao_q, alpha);
 			} else {
-				double product_ratio = (g->nodes[i].relative_proportion * g->nodes[j].relative_proportion) / rao_q;
+				double product_ratio = (g->snapshot.relative_proportions[i] * g->snapshot.relative_proportions[j]) / rao_q;
 				diversity += distance * product_ratio * (log(product_ratio) / log(LOGARITHMIC_BASE));
 			}
 		}
@@ -3341,30 +3494,22 @@ int32_t leinster_cobbold_diversity_from_graph(struct graph* const g, double* con
 			} else {
 				switch(fp_mode){
 					case FP32:
-						#if ENABLE_AVX512 == 1
-						distance = (double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif ENABLE_AVX256 == 1
-						distance = (double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif MST_SANITY_TESTING == 1
-						distance = (double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-						#else
-						distance = (double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#endif
+						distance = (double) graph_snapshot_distance(&(g->snapshot), i, j);
 						break;
 					case FP64:
-						distance = cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
+						distance = cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
 						break;
 				}
 			}
 
 			double similarity = 1.0 - distance;
 
-			local_agg += g->nodes[j].relative_proportion * pow(E, -u * similarity);
+			local_agg += g->snapshot.relative_proportions[j] * pow(E, -u * similarity);
 		}
 		if(alpha != 1.0){
 			hill_number += pow(local_agg, alpha - 1.0);
 		} else {
-			hill_number *= pow(local_agg, g->nodes[i].relative_proportion);
+			hill_number *= pow(local_agg, g->snapshot.relative_proportions[i]);
 		}
 	}
 	if(alpha != 1.0){
@@ -3399,7 +3544,7 @@ int32_t scheiner_species_phylogenetic_functional_diversity_from_graph(struct gra
 	long double* vector = (long double*) malloc_pointer;
 	long double norm_sum = 0.0;
 
-	long double m = (long double) g->nodes[0].num_dimensions;
+	long double m = (long double) graph_node_at(g, 0)->num_dimensions;
 	// long double c_m = (long double) (pow(M_PI, (m / 2.0)) / lgamma((m / 2.0) + 1.0));
 	long double c_m = (long double) (pow(PI, (m / 2.0)) / lgamma((m / 2.0) + 1.0));
 	// long double c_m_ln = log(c_m);
@@ -3425,21 +3570,13 @@ int32_t scheiner_species_phylogenetic_functional_diversity_from_graph(struct gra
 				// the paper makes use of euclidean distance
 				switch(fp_mode){
 					case FP32:
-						#if ENABLE_AVX512 == 1
-						distance = (long double) cosine_distance_fp32_avx512(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif ENABLE_AVX256 == 1
-						distance = (long double) cosine_distance_fp32_avx256(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#elif MST_SANITY_TESTING == 1
-						distance = (long double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions, 2.0f);
-						#else
-						distance = (long double) cosine_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, g->nodes[i].num_dimensions);
-						#endif
+						distance = (long double) graph_snapshot_distance(&(g->snapshot), i, j);
 	
-						// distance = (long double) minkowski_distance_fp32(g->nodes[i].vector.fp32, g->nodes[j].vector.fp32, 2.0,  g->nodes[i].num_dimensions);
+						// distance = (long double) minkowski_distance_fp32(graph_node_at(g, i)->vector.fp32, graph_node_at(g, j)->vector.fp32, 2.0,  graph_node_at(g, i)->num_dimensions);
 						break;
 					case FP64:
-						distance = (long double) cosine_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, g->nodes[i].num_dimensions);
-						// distance = minkowski_distance(g->nodes[i].vector.fp64, g->nodes[j].vector.fp64, 2.0, g->nodes[i].num_dimensions);
+						distance = (long double) cosine_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, graph_node_at(g, i)->num_dimensions);
+						// distance = minkowski_distance(graph_node_at(g, i)->vector.fp64, graph_node_at(g, j)->vector.fp64, 2.0, graph_node_at(g, i)->num_dimensions);
 						break;
 				}
 			}
@@ -3458,7 +3595,7 @@ int32_t scheiner_species_phylogenetic_functional_diversity_from_graph(struct gra
 		// long double v_i = pow(M_E, v_i_ln);
 		long double v_i = (long double) (c_m * d_pow);
 
-		long double abundance = (long double) g->nodes[i].absolute_proportion;
+		long double abundance = (long double) g->snapshot.absolute_proportions[i];
 		// long double abundance_ln = log(abundance);
 
 		long double phylogenetic_distance = 1.0; // !
@@ -3519,7 +3656,7 @@ int32_t nhc_e_q_from_graph(struct graph* const g, double* const res_nhc, double*
 		return 1;
 	}
 	for(uint32_t i = 0 ; i < g->num_nodes ; i++){
-		proportions[i] = (double) g->nodes[i].absolute_proportion; // abundances, not relative
+		proportions[i] = (double) g->snapshot.absolute_proportions[i]; // abundances, not relative
 	}
 
 	qsort(proportions, g->num_nodes, sizeof(double), double_cmp);
@@ -0,0 +1,378 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GNU_SOURCE
+// for syscall in unistd.h, as well as clock_gettime and getrusage
+#define _GNU_SOURCE
+#endif
+
+#include <time.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+#include "instrument.h"
+
+static pthread_once_t instrument_once = PTHREAD_ONCE_INIT;
+static pthread_key_t instrument_key;
+static pthread_mutex_t instrument_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct instrument_thread* instrument_threads = NULL;
+static uint32_t instrument_num_threads = 0;
+static int32_t instrument_key_status = 0;
+
+// read without the mutex by every thread
+static uint8_t instrument_enabled = 0;
+static uint8_t instrument_counters_enabled = 0;
+static uint32_t instrument_generation = 0;
+static int64_t instrument_origin_ns = 0;
+static uint8_t instrument_counters_opened = 0; // set once a thread could open every counter
+
+// not part of struct instrument_thread, so that laps never register the thread
+static __thread int64_t instrument_last_lap_ns = 0;
+
+int64_t instrument_now_ns(void){
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0){return 0;}
+	return ((int64_t) ts.tv_sec) * 1000000000 + (int64_t) ts.tv_nsec;
+}
+
+static void instrument_close_counters(struct instrument_thread* const t){
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		if(t->counter_fds[c] >= 0){close(t->counter_fds[c]);}
+		t->counter_fds[c] = -1;
+	}
+}
+
+static void instrument_unlink_thread(struct instrument_thread* const t){
+	for(struct instrument_thread** p = &instrument_threads ; (*p) != NULL ; p = &((*p)->next)){
+		if((*p) == t){
+			(*p) = t->next;
+			break;
+		}
+	}
+	pthread_mutex_destroy(&(t->mutex));
+	free(t->spans);
+	free(t);
+}
+
+// key destructor, run when a registered thread exits: its counters are closed, and the structure is freed unless it holds spans of the current session, in which case instrument_free frees it
+static void instrument_thread_exit(void* arg){
+	struct instrument_thread* const t = (struct instrument_thread*) arg;
+
+	pthread_mutex_lock(&instrument_mutex);
+	instrument_close_counters(t);
+	pthread_mutex_lock(&(t->mutex));
+	const uint8_t has_spans = t->num_spans > 0 && t->generation == __atomic_load_n(&instrument_generation, __ATOMIC_ACQUIRE);
+	t->retired = 1;
+	pthread_mutex_unlock(&(t->mutex));
+	if(!has_spans){instrument_unlink_thread(t);}
+	pthread_mutex_unlock(&instrument_mutex);
+}
+
+static void instrument_create_key(void){
+	instrument_key_status = pthread_key_create(&instrument_key, instrument_thread_exit);
+}
+
+// counters of the calling thread only, user space only so that the default perf_event_paranoid allows them
+static void instrument_open_counters(struct instrument_thread* const t){
+	#ifdef __linux__
+	const uint64_t configs[INSTRUMENT_NUM_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES};
+	int32_t num_opened = 0;
+
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		struct perf_event_attr attr;
+		memset(&attr, '\0', sizeof(struct perf_event_attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(struct perf_event_attr);
+		attr.config = configs[c];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		t->counter_fds[c] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if(t->counter_fds[c] < 0){t->counter_fds[c] = -1;} else {num_opened++;}
+	}
+	if(num_opened == INSTRUMENT_NUM_COUNTERS){__atomic_store_n(&instrument_counters_opened, 1, __ATOMIC_RELAXED);}
+	#else
+	(void) t;
+	#endif
+}
+
+static void instrument_read_counters(const struct instrument_thread* const t, int64_t* const values){
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		uint64_t value;
+		values[c] = -1;
+		if(t == NULL || t->counter_fds[c] < 0){continue;}
+		if(read(t->counter_fds[c], &value, sizeof(uint64_t)) == (ssize_t) sizeof(uint64_t)){values[c] = (int64_t) value;}
+	}
+}
+
+// the structure of the calling thread, registered by its first recorded span; it is retired by instrument_thread_exit
+static struct instrument_thread* instrument_thread_get(void){
+	if(pthread_once(&instrument_once, instrument_create_key) != 0 || instrument_key_status != 0){return NULL;}
+
+	struct instrument_thread* t = (struct instrument_thread*) pthread_getspecific(instrument_key);
+	if(t == NULL){
+		t = (struct instrument_thread*) calloc(1, sizeof(struct instrument_thread));
+		if(t == NULL){return NULL;}
+		for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){t->counter_fds[c] = -1;}
+		t->os_tid = (int64_t) syscall(SYS_gettid);
+		if(pthread_mutex_init(&(t->mutex), NULL) != 0){free(t); return NULL;}
+		if(pthread_setspecific(instrument_key, t) != 0){pthread_mutex_destroy(&(t->mutex)); free(t); return NULL;}
+		pthread_mutex_lock(&instrument_mutex);
+		t->index = instrument_num_threads++;
+		t->next = instrument_threads;
+		instrument_threads = t;
+		pthread_mutex_unlock(&instrument_mutex);
+	}
+
+	// spans and counters of a previous instrument_init are dropped by the thread itself
+	const uint32_t generation = __atomic_load_n(&instrument_generation, __ATOMIC_ACQUIRE);
+	if(t->generation != generation){
+		pthread_mutex_lock(&(t->mutex));
+		t->num_spans = 0;
+		pthread_mutex_unlock(&(t->mutex));
+		t->depth = 0;
+		instrument_close_counters(t);
+		if(__atomic_load_n(&instrument_counters_enabled, __ATOMIC_RELAXED)){instrument_open_counters(t);}
+		t->generation = generation;
+	}
+	return t;
+}
+
+int32_t instrument_init(const uint8_t enable_counters){
+	if(pthread_once(&instrument_once, instrument_create_key) != 0 || instrument_key_status != 0){
+		perror("failed to create instrument key\n");
+		return 1;
+	}
+	pthread_mutex_lock(&instrument_mutex);
+	__atomic_store_n(&instrument_origin_ns, instrument_now_ns(), __ATOMIC_RELAXED);
+	__atomic_store_n(&instrument_counters_opened, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&instrument_counters_enabled, enable_counters ? 1 : 0, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&instrument_generation, 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&instrument_enabled, 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&instrument_mutex);
+	return 0;
+}
+
+// stops recording and releases the spans of every thread, as well as the threads that exited; spans still open are dropped when they end
+void instrument_free(void){
+	pthread_mutex_lock(&instrument_mutex);
+	__atomic_store_n(&instrument_enabled, 0, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&instrument_generation, 1, __ATOMIC_RELEASE);
+	struct instrument_thread* next;
+	for(struct instrument_thread* t = instrument_threads ; t != NULL ; t = next){
+		next = t->next;
+		if(t->retired){
+			instrument_unlink_thread(t);
+			continue;
+		}
+		pthread_mutex_lock(&(t->mutex));
+		free(t->spans);
+		t->spans = NULL;
+		t->num_spans = 0;
+		t->capacity = 0;
+		pthread_mutex_unlock(&(t->mutex));
+	}
+	pthread_mutex_unlock(&instrument_mutex);
+}
+
+uint8_t instrument_counters_available(void){
+	return __atomic_load_n(&instrument_counters_opened, __ATOMIC_RELAXED);
+}
+
+// time since the previous call on the same thread, whether or not spans are recorded
+int32_t instrument_lap_ns(int64_t* const delta){
+	const int64_t now = instrument_now_ns();
+	if(delta != NULL){(*delta) = now - instrument_last_lap_ns;}
+	instrument_last_lap_ns = now;
+	return 0;
+}
+
+void instrument_span_begin(struct instrument_scope* const scope, const char* const name){
+	scope->name = name;
+	scope->thread = NULL;
+	if(__atomic_load_n(&instrument_enabled, __ATOMIC_ACQUIRE)){
+		scope->thread = instrument_thread_get();
+		if(scope->thread != NULL){
+			scope->thread->depth++;
+			instrument_read_counters(scope->thread, scope->counters);
+		}
+	}
+	scope->start_ns = instrument_now_ns();
+}
+
+// returns the duration of the span, which is measured whether or not spans are recorded
+int64_t instrument_span_end(struct instrument_scope* const scope){
+	const int64_t end_ns = instrument_now_ns();
+	const int64_t duration_ns = end_ns - scope->start_ns;
+	struct instrument_thread* const t = scope->thread;
+
+	if(t == NULL){return duration_ns;}
+	scope->thread = NULL;
+	if(t->depth > 0){t->depth--;}
+	if(!__atomic_load_n(&instrument_enabled, __ATOMIC_ACQUIRE) || t->generation != __atomic_load_n(&instrument_generation, __ATOMIC_ACQUIRE)){return duration_ns;}
+
+	struct instrument_span span = {
+		.name = scope->name,
+		.start_ns = scope->start_ns - __atomic_load_n(&instrument_origin_ns, __ATOMIC_RELAXED),
+		.duration_ns = duration_ns,
+		.peak_rss_kb = -1,
+		.depth = t->depth,
+		.thread_index = t->index,
+		.os_tid = t->os_tid,
+	};
+	instrument_read_counters(t, span.counters);
+	for(int32_t c = 0 ; c < INSTRUMENT_NUM_COUNTERS ; c++){
+		if(span.counters[c] >= 0 && scope->counters[c] >= 0){span.counters[c] -= scope->counters[c];} else {span.counters[c] = -1;}
+	}
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) == 0){span.peak_rss_kb = (int64_t) usage.ru_maxrss;}
+
+	pthread_mutex_lock(&(t->mutex));
+	if(t->num_spans == t->capacity){
+		const uint64_t capacity = t->capacity == 0 ? INSTRUMENT_INITIAL_CAPACITY : 2 * t->capacity;
+		void* const malloc_pointer = realloc(t->spans, capacity * sizeof(struct instrument_span));
+		if(malloc_pointer == NULL){
+			pthread_mutex_unlock(&(t->mutex));
+			return duration_ns; // the span is lost, not the measurement
+		}
+		t->spans = (struct instrument_span*) malloc_pointer;
+		t->capacity = capacity;
+	}
+	t->spans[t->num_spans++] = span;
+	pthread_mutex_unlock(&(t->mutex));
+
+	return duration_ns;
+}
+
+static int instrument_compare_spans(const void* a, const void* b){
+	const struct instrument_span* const x = (const struct instrument_span*) a;
+	const struct instrument_span* const y = (const struct instrument_span*) b;
+	if(x->thread_index != y->thread_index){return x->thread_index < y->thread_index ? -1 : 1;}
+	if(x->start_ns != y->start_ns){return x->start_ns < y->start_ns ? -1 : 1;}
+	if(x->depth != y->depth){return x->depth < y->depth ? -1 : 1;}
+	return 0;
+}
+
+// copies the spans of every thread, by thread then by start; the caller frees *spans
+int32_t instrument_collect(struct instrument_span** const spans, uint64_t* const num_spans){
+	uint64_t n = 0;
+
+	pthread_mutex_lock(&instrument_mutex);
+	for(struct instrument_thread* t = instrument_threads ; t != NULL ; t = t->next){
+		pthread_mutex_lock(&(t->mutex));
+		n += t->num_spans;
+		pthread_mutex_unlock(&(t->mutex));
+	}
+	(*spans) = (struct instrument_span*) malloc((n + 1) * sizeof(struct instrument_span));
+	if((*spans) == NULL){
+		pthread_mutex_unlock(&instrument_mutex);
+		perror("malloc failed\n");
+		return 1;
+	}
+	uint64_t k = 0;
+	for(struct instrument_thread* t = instrument_threads ; t != NULL ; t = t->next){
+		pthread_mutex_lock(&(t->mutex));
+		const uint64_t num_copied = t->num_spans < n - k ? t->num_spans : n - k; // spans ended since they were counted are left out
+		if(num_copied > 0){memcpy(&((*spans)[k]), t->spans, num_copied * sizeof(struct instrument_span));}
+		k += num_copied;
+		pthread_mutex_unlock(&(t->mutex));
+	}
+	pthread_mutex_unlock(&instrument_mutex);
+
+	qsort(*spans, k, sizeof(struct instrument_span), instrument_compare_spans);
+	(*num_spans) = k;
+	return 0;
+}
+
+static void instrument_print_json_string(FILE* const f, const char* const s){
+	fputc('"', f);
+	for(const char* c = s ; c != NULL && *c != '\0' ; c++){
+		if(*c == '"' || *c == '\\'){
+			fputc('\\', f);
+			fputc(*c, f);
+		} else if((unsigned char) *c < 0x20){
+			fprintf(f, "\\u%04x", (unsigned int) (unsigned char) *c);
+		} else {
+			fputc(*c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+// complete events ("ph": "X") in the Chrome trace event format, which chrome://tracing and Perfetto open
+int32_t instrument_export_chrome_trace(const char* const path){
+	struct instrument_span* spans;
+	uint64_t num_spans;
+	const long pid = (long) getpid();
+
+	if(instrument_collect(&spans, &num_spans) != 0){return 1;}
+
+	FILE* const f = fopen(path, "w");
+	if(f == NULL){
+		fprintf(stderr, "Failed to open file: %s\n", path);
+		free(spans);
+		return 1;
+	}
+
+	fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+	int64_t previous_tid = -1;
+	uint8_t first = 1;
+	for(uint64_t k = 0 ; k < num_spans ; k++){
+		const struct instrument_span* const s = &(spans[k]);
+		if(s->os_tid != previous_tid){
+			fprintf(f, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %li, \"tid\": %li, \"args\": {\"name\": \"thread %u\"}}", first ? "" : ",", pid, (long) s->os_tid, s->thread_index);
+			previous_tid = s->os_tid;
+			first = 0;
+		}
+		fprintf(f, ",\n{\"name\": ");
+		instrument_print_json_string(f, s->name);
+		fprintf(f, ", \"cat\": \"diversutils\", \"ph\": \"X\", \"ts\": %li.%03li, \"dur\": %li.%03li, \"pid\": %li, \"tid\": %li, \"args\": {\"depth\": %u, \"peak_rss_kb\": %li", (long) (s->start_ns / 1000), (long) (s->start_ns % 1000), (long) (s->duration_ns / 1000), (long) (s->duration_ns % 1000), pid, (long) s->os_tid, s->depth, (long) s->peak_rss_kb);
+		if(s->counters[INSTRUMENT_COUNTER_CYCLES] >= 0){fprintf(f, ", \"cycles\": %li", (long) s->counters[INSTRUMENT_COUNTER_CYCLES]);}
+		if(s->counters[INSTRUMENT_COUNTER_LLC_MISSES] >= 0){fprintf(f, ", \"llc_misses\": %li", (long) s->counters[INSTRUMENT_COUNTER_LLC_MISSES]);}
+		fprintf(f, "}}");
+	}
+	fprintf(f, "\n]}\n");
+
+	free(spans);
+	const int32_t write_failed = ferror(f) ? 1 : 0;
+	if(fclose(f) != 0 || write_failed){
+		fprintf(stderr, "Failed to write file: %s\n", path);
+		return 1;
+	}
+	return 0;
+}
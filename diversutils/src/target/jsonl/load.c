@@ -33,16 +33,65 @@
 #include <string.h>
 
 #include "graph.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
 #include "jsonl/parser.h"
 #include "jsonl/load.h"
 #include "distributions.h"
 #include "logging.h"
 #include "measurement.h"
+#include "checkpoint.h"
+#include "recompute.h"
+#include "schedule.h"
 #include "unicode/utf8.h"
 #include "filter.h"
 #include "cupt/constants.h"
 
+// one occurrence of token, added to the graph if the vector space has it and to the OOV counter otherwise; token may be normalised in place
+int32_t jsonl_token_to_graph(char * const token, const struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, uint64_t * const num_oov_tokens){
+    // UTF-8 normalisation
+
+    if(mcfg->enable_token_utf8_normalisation){
+        char * utf8_normalised_key = utf8_normalise(token);
+        if(utf8_normalised_key != token){
+            size_t bytes_to_cpy = strlen(utf8_normalised_key);
+            if(bytes_to_cpy > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){bytes_to_cpy = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;}
+            memcpy(token, utf8_normalised_key, bytes_to_cpy);
+            token[bytes_to_cpy] = '\0';
+        }
+    }
+
+    // add to graph
+    int32_t index = word2vec_key_to_index(sref->w2v, token);
+    if(index != -1){
+        if(graph_add_word2vec_occurrence(sref->g, sref->w2v, &(sref->w2v->keys[index])) != 0){
+            perror("failed to call graph_add_word2vec_occurrence\n");
+            return 1;
+        }
+    } else { // added from cupt
+        if(oov_counter_increment(sref->oov_discarded_because_not_in_vector_database, token) != 0){
+            perror("failed to call oov_counter_increment\n");
+            return 1;
+        }
+        if(num_oov_tokens != NULL){(*num_oov_tokens)++;}
+    }
+    return 0;
+}
+
+// every token of a document whose text is set, as the JSONL loader reads them
+int32_t jsonl_document_to_graph(struct document * const doc, const struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, uint64_t * const num_oov_tokens){
+    while(!(doc->reached_last_token)){
+        if(iterate_document_current_token(doc) != 0){
+            perror("failed to call iterate_document_current_token\n");
+            return 1;
+        }
+        if(jsonl_token_to_graph(doc->current_token, mcfg, sref, num_oov_tokens) != 0){
+            perror("failed to call jsonl_token_to_graph\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int32_t jsonl_to_graph(const uint64_t i, const char * const filename, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut){
     struct jsonl_document_iterator jdi = {0};
     if(create_jsonl_document_iterator(&jdi, filename, mcfg->jsonl_content_key) != 0){
@@ -50,6 +99,27 @@ int32_t jsonl_to_graph(const uint64_t i, const char * const filename, struct mea
         return 1;
     }
 
+    // the documents before the resume point were read by the run that wrote the checkpoint
+    if(sref->checkpoint != NULL){
+        int64_t offset = 0;
+        int64_t offset_tp = 0;
+        checkpoint_file_resume_point(sref->checkpoint, (int32_t) i, &offset, &offset_tp, NULL);
+        if(offset > 0 && fseek(jdi.file_ptr, (long) offset, SEEK_SET) != 0){
+            fprintf(stderr, "failed to seek to offset %li in %s\n", offset, filename);
+            free_jsonl_document_iterator(&jdi);
+            return 1;
+        }
+    }
+
+    #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+    struct filter_workspace fw = {0};
+    if(create_filter_workspace(&fw) != 0){
+        perror("failed to call create_filter_workspace\n");
+        free_jsonl_document_iterator(&jdi);
+        return 1;
+    }
+    #endif
+
     const int32_t log_bfr_size = 256;
     char log_bfr[log_bfr_size];
 
@@ -61,130 +131,47 @@ int32_t jsonl_to_graph(const uint64_t i, const char * const filename, struct mea
 		jdi.current_document.text_size = 0;
 		if(iterate_jsonl_document_iterator(&jdi) != 0){
 			perror("failed to call iterate_jsonl_document_iterator\n");
-			return 1;
+			goto panic_exit;
 		}
 		if(jdi.current_document.text_size == 0 || jdi.current_document.identifier_size == 0){
 			continue;
 		}
 
         #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
-        if(filter_substitute_all(&jdi.current_document.text, &jdi.current_document.text_size)){
-            perror("failed to call filter_substitute_all\n");
-            return 1;
-        };
-        jdi.current_document.text_size = strlen(jdi.current_document.text);
+        if(filter_substitute_all_workspace(&fw, &jdi.current_document.text, &jdi.current_document.text_size, &jdi.current_document.text_capacity)){
+            perror("failed to call filter_substitute_all_workspace\n");
+            goto panic_exit;
+        }
         #endif
 
-		while(!(jdi.current_document.reached_last_token)){
-			if(iterate_document_current_token(&(jdi.current_document)) != 0){
-				perror("failed to call iterate_document_current_token\n");
-				return 1;
-			}
-
-            // UTF-8 normalisation
-
-            if(mcfg->enable_token_utf8_normalisation){
-                char * utf8_normalised_key = utf8_normalise(jdi.current_document.current_token);
-                if(utf8_normalised_key != jdi.current_document.current_token){
-                    // printf("Normalising \"%s\" to \"%s\"\n", jdi.current_document.current_token, utf8_normalised_key);
-                    size_t bytes_to_cpy = strlen(utf8_normalised_key);
-                    if(bytes_to_cpy > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){bytes_to_cpy = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;}
-                    memcpy(jdi.current_document.current_token, utf8_normalised_key, bytes_to_cpy);
-                    jdi.current_document.current_token[bytes_to_cpy] = '\0';
-                }
-            }
-
-			// add to graph
-			int32_t index = word2vec_key_to_index(sref->w2v, jdi.current_document.current_token);
-			if(index != -1){
-                pthread_mutex_lock(&(sref->w2v->keys[index].mutex));
-				if(sref->w2v->keys[index].active_in_current_graph == 0){
-					sref->w2v->keys[index].active_in_current_graph = 1;
-
-                    pthread_mutex_lock(&(sref->g->mutex_nodes));
-					if(sref->g->num_nodes == sref->g->capacity){
-						if(request_more_capacity_graph(sref->g) != 0){
-							perror("failed to call request_more_capacity_graph\n");
-							return 1;
-						}
-					}
-					struct graph_node local_node;
-					if(create_graph_node(&local_node, sref->g->nodes[0].num_dimensions, FP32) != 0){
-						perror("failed to call create_graph_node\n");
-						return 1;
-					}
-					local_node.word2vec_entry_pointer = &(sref->w2v->keys[index]);
-					local_node.vector.fp32 = sref->w2v->keys[index].vector;
-					local_node.num_dimensions = sref->w2v->num_dimensions;
-					local_node.already_considered = 0;
-					local_node.relative_proportion = 1.0;
-					local_node.absolute_proportion = 1;
-					sref->g->nodes[sref->g->num_nodes] = local_node;
-					sref->w2v->keys[index].graph_node_pointer = &(sref->g->nodes[sref->g->num_nodes]);
-					sref->w2v->keys[index].graph_node_index = sref->g->num_nodes;
-					sref->g->num_nodes++;
-                    pthread_mutex_unlock(&(sref->g->mutex_nodes));
-				} else {
-                    pthread_mutex_lock(&(sref->g->nodes[sref->w2v->keys[index].graph_node_index].mutex_local_node));
-					sref->g->nodes[sref->w2v->keys[index].graph_node_index].absolute_proportion++;
-                    pthread_mutex_unlock(&(sref->g->nodes[sref->w2v->keys[index].graph_node_index].mutex_local_node));
-				}
-                pthread_mutex_unlock(&(sref->w2v->keys[index].mutex));
-			} else { // added from cupt
-                pthread_mutex_lock(&(sref->sorted_array_discarded_because_not_in_vector_database->mutex));
-			    int32_t index_in_discarded = key_to_index_sorted_array(sref->sorted_array_discarded_because_not_in_vector_database, jdi.current_document.current_token); // before, was in upper level
-				if(index_in_discarded == -1){
-					struct sorted_array_str_int_element elem;
-                    if(create_sorted_array_str_int_element(&elem) != 0){
-                        perror("failed to call create_sorted_array_str_int_element\n");
-                        return 1;
-                    }
-					size_t bytes_to_cpy = strlen(jdi.current_document.current_token);
-					if(bytes_to_cpy > SORTED_ARRAY_DEFAULT_KEY_SIZE - 1){
-						bytes_to_cpy = SORTED_ARRAY_DEFAULT_KEY_SIZE - 1;
-					}
-					memcpy(&elem.key, jdi.current_document.current_token, bytes_to_cpy);
-					elem.value = 1;
-					if(insert_sorted_array(sref->sorted_array_discarded_because_not_in_vector_database, &elem, 0) != 0){
-						perror("failed to call insert_sorted_array\n");
-						return 1;
-					}
-				} else {
-					((struct sorted_array_str_int_element*) sref->sorted_array_discarded_because_not_in_vector_database->bfr)[index_in_discarded].value++;
-				}
-                pthread_mutex_unlock(&(sref->sorted_array_discarded_because_not_in_vector_database->mutex));
-			}
+		if(jsonl_document_to_graph(&(jdi.current_document), mcfg, sref, NULL) != 0){
+			perror("failed to call jsonl_document_to_graph\n");
+			goto panic_exit;
 		}
 
         pthread_mutex_lock(&mmut->mutex);
         pthread_mutex_lock(&sref->g->mutex_nodes);
 		// if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.document.enable_count_recompute_step && (((!mcfg->steps.document.use_log10) && mmut->document.num % mcfg->steps.document.recompute_step == 0) || (mcfg->steps.document.use_log10 && mmut->document.num >= mmut->document.count_target)) && sref->g->num_nodes > 1)){ // DO NOT REMOVE
-		if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.document.enable_count_recompute_step && (((!mcfg->steps.document.use_log10) && mmut->document.num_all % mcfg->steps.document.recompute_step == 0) || (mcfg->steps.document.use_log10 && mmut->document.num_all >= mmut->document.count_target)) && sref->g->num_nodes > 1)){
-            compute_graph_relative_proportions(sref->g);
-		
-			int32_t err = zipfian_fit_from_graph(sref->g, &mmut->best_s);
-			if(err != 0){
-				perror("failed to call zipfian_fit_from_graph\n");
-                goto panic_exit;
-			}
-		
-			if(mmut->best_s != mmut->prev_best_s || sref->g->num_nodes != ((uint64_t) mmut->prev_num_nodes)){
+		if((mcfg->target_column != UD_MWE || found_at_least_one_mwe) && (mcfg->steps.document.enable_count_recompute_step && (((!mcfg->steps.document.use_log10) && (!mcfg->steps.document.use_adaptive) && mmut->document.num_all % mcfg->steps.document.recompute_step == 0) || ((mcfg->steps.document.use_log10 || mcfg->steps.document.use_adaptive) && mmut->document.num_all >= mmut->document.count_target)) && sref->g->num_nodes > 1)){
+            if(sref->recompute != NULL){
+                if(recompute_worker_submit(sref->recompute, i, sref->g, mmut, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), 0) != 0){
+                    perror("failed to call recompute_worker_submit\n");
+                    goto panic_exit;
+                }
+            } else {
+                mmut->num_oov_types = oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database);
+                if(compute_graph_relative_proportions(sref->g) != 0 || measurement_recompute_step(i, mcfg, sref, mmut, 0) != 0){
+                    perror("failed to call measurement_recompute_step\n");
+                    goto panic_exit;
+                }
+            }
+
+			if(mcfg->steps.document.use_adaptive){
+				mmut->document.count_target = recompute_schedule_next(sref->schedule, &(sref->schedule->document), mmut->document.num_all, sref->g->num_nodes, recompute_schedule_now(), sref->recompute == NULL, mcfg->steps.document.use_log10 ? mcfg->steps.document.recompute_step_log10 : 0.0);
 				memset(log_bfr, '\0', log_bfr_size);
-				// snprintf(log_bfr, log_bfr_size, "best_s: %f; num_nodes: %lu; num_sentences: %li; num_documents: %li", mmut->best_s, sref->g->num_nodes, mmut->sentence.num, mmut->document.num); // DO NOT REMOVE
-				snprintf(log_bfr, log_bfr_size, "best_s: %f; num_nodes: %lu; num_sentences: %lu; num_documents: %lu", mmut->best_s, sref->g->num_nodes, mmut->sentence.num_all, mmut->document.num_all);
+				snprintf(log_bfr, log_bfr_size, "New document count target: %lu (adaptive)", mmut->document.count_target);
 				info_format(__FILE__, __func__, __LINE__, log_bfr);
-
-                err = apply_diversity_functions_to_graph(i, mcfg, sref, mmut);
-				if(err != 0){
-					perror("failed to call apply_diversity_functions_to_graph\n");
-					return 1;
-				}
-				mmut->prev_best_s = mmut->best_s;
-			} else { // end of comparison best_s?
-				printf("ignoring because best_s (%.12f) == previous_best_s (%.12f) && g->num_nodes (%lu) == previous_g_num_nodes (%li)\n", mmut->best_s, mmut->prev_best_s, sref->g->num_nodes, mmut->prev_num_nodes);
-			}
-
-			if(mcfg->steps.document.use_log10){
+			} else if(mcfg->steps.document.use_log10){
 				mmut->document.stacked_log += mcfg->steps.document.recompute_step_log10;
 				mmut->document.count_target = (uint64_t) floor(pow(10.0, mmut->document.stacked_log));
 				memset(log_bfr, '\0', log_bfr_size);
@@ -197,15 +184,23 @@ int32_t jsonl_to_graph(const uint64_t i, const char * const filename, struct mea
 		// mmut->document.num++; // DO NOT REMOVE
 		mmut->document.num_all++;
         pthread_mutex_unlock(&mmut->mutex);
+
+        if(sref->checkpoint != NULL){checkpoint_unit_done(sref->checkpoint, (int32_t) i, (int64_t) ftell(jdi.file_ptr), -1, found_at_least_one_mwe);}
 	}
 
     free_jsonl_document_iterator(&jdi);
+    #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+    free_filter_workspace(&fw);
+    #endif
 
     return 0;
 
     panic_exit:
 
     free_jsonl_document_iterator(&jdi);
+    #if (ENABLE_FILTER == 1 && ENABLE_FILTER_ON_JSONL_DOCUMENTS == 1)
+    free_filter_workspace(&fw);
+    #endif
 
     return 1;
 }
@@ -64,13 +64,21 @@ const int32_t REGEX_FLAGS = REG_EXTENDED | REG_ICASE;
 #elif TOKENIZATION_METHOD == 1
 const char* udpipe_repo_directory = "./udpipe";
 const char* udpipe_model_directory = "./udpipe/sandbox_models";
+const char* udpipe_model_name = "english-ewt-ud-2.5-191206.udpipe";
+// const char* udpipe_model_name = "french-sequoia-ud-2.5-191206.udpipe";
+#define UDPIPE_PATH_BUFFER_SIZE 1024
+static char udpipe_binary_path[UDPIPE_PATH_BUFFER_SIZE];
+static char udpipe_model_path[UDPIPE_PATH_BUFFER_SIZE];
+static char* udpipe_coprocess_argv[] = {udpipe_binary_path, "--tokenize", "--immediate", "--output=vertical", udpipe_model_path, NULL};
 #elif TOKENIZATION_METHOD == 2
 #else
 	#error "Unknown TOKENIZATION_METHOD"
 #endif
 
-void jsonl_init_tokenization(void){
-	#if TOKENIZATION_METHOD == 1
+void jsonl_init_tokenization(const int32_t num_workers){
+	#if TOKENIZATION_METHOD != 1
+	(void) num_workers;
+	#else
 	const int32_t bfr_size = 256;
 	char bfr[bfr_size];
 	memset(bfr, '\0', bfr_size);
@@ -89,6 +97,13 @@ void jsonl_init_tokenization(void){
 		}
 	}
 
+	snprintf(udpipe_binary_path, UDPIPE_PATH_BUFFER_SIZE, "%s/src/udpipe", udpipe_repo_directory);
+	snprintf(udpipe_model_path, UDPIPE_PATH_BUFFER_SIZE, "%s/%s", udpipe_model_directory, udpipe_model_name);
+	if(udpipe_coprocess_pool_create(udpipe_coprocess_argv, num_workers) != 0){
+		fprintf(stderr, "Failed to start UDPipe processes: %s\n", udpipe_binary_path);
+		exit(1);
+	}
+
 	return;
 
 	system_failure:
@@ -97,43 +112,32 @@ void jsonl_init_tokenization(void){
 	#endif
 }
 
+void jsonl_free_tokenization(void){
+	#if TOKENIZATION_METHOD == 1
+	udpipe_coprocess_pool_free();
+	#endif
+}
+
 #if (TOKENIZATION_METHOD == 1 || TOKENIZATION_METHOD == 2)
 int32_t launch_udpipe(struct document* const doc){
 	#if TOKENIZATION_METHOD == 1
-	const char* model_name = "english-ewt-ud-2.5-191206.udpipe";
-	// const char* model_name = "french-sequoia-ud-2.5-191206.udpipe";
-
-	const int32_t path_model_bfr_size = 1024;
-	char path_model_bfr[path_model_bfr_size];
-	memset(path_model_bfr, '\0', path_model_bfr_size);
-	snprintf(path_model_bfr, path_model_bfr_size, "%s/%s", udpipe_model_directory, model_name);
-
-	char* sanitized_text;
-	if(sanitize_for_shell(doc->text, doc->text_size, &sanitized_text) != 0){
-		perror("failed to sanitize text\n");
-		return 1;
+	if(doc->coprocess == NULL){
+		doc->coprocess = udpipe_coprocess_pool_acquire();
 	}
-	const int32_t udpipe_call_bfr_size = 1024 + strlen(sanitized_text);
-	size_t alloc_size = udpipe_call_bfr_size * sizeof(char);
-	char* udpipe_call_bfr = malloc(alloc_size);
-	if(udpipe_call_bfr == NULL){perror("malloc failed\n"); return 1;}
-	memset(udpipe_call_bfr, '\0', udpipe_call_bfr_size);
-	// snprintf(udpipe_call_bfr, udpipe_call_bfr_size, "echo \"%s\" | %s/src/udpipe --tokenize %s --output=vertical --input=horizontal\n", sanitized_text, udpipe_repo_directory, path_model_bfr); // works
-	snprintf(udpipe_call_bfr, udpipe_call_bfr_size, "echo \"%s\" | %s/src/udpipe --tokenize %s --output=vertical --input=horizontal --immediate\n", sanitized_text, udpipe_repo_directory, path_model_bfr); // works
-	doc->tmp_udpipe_output_file = popen(udpipe_call_bfr, "r");
-	if(doc->tmp_udpipe_output_file == NULL){
-		fprintf(stderr, "Failed to call UDPipe: %s\n", udpipe_call_bfr);
-		free(udpipe_call_bfr);
+	if(udpipe_coprocess_submit(doc->coprocess, doc->text, doc->text_size) != 0){
+		fprintf(stderr, "Failed to submit document to UDPipe: %s\n", udpipe_binary_path);
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
 		return 1;
 	}
-	free(sanitized_text); // malloc by sanitize_for_shell
-	free(udpipe_call_bfr);
 	#elif TOKENIZATION_METHOD == 2
-	// if(transform_to_pipes(local_pipeline, doc->text, &(doc->tmp_udpipe_output_file), &(doc->heap_char_output), &(doc->output_pipefd)) != 0){
-	if(transform_to_pipes(doc->text, &(doc->tmp_udpipe_output_file), &(doc->heap_char_output)) != 0){
-		perror("Failed to call transform_to_pipes\n");
+	const char* const texts[1] = {doc->text};
+	if(udpipe_pool_process_batch(texts, 1, &(doc->tokens)) != 0){
+		perror("Failed to call udpipe_pool_process_batch\n");
 		return 1;
 	}
+	doc->current_span = 0;
+	doc->tokenized = 1;
 	#endif
 	return 0;
 }
@@ -208,28 +212,49 @@ int32_t iterate_document_current_token(struct document* const doc){
 	doc->current_token[len] = '\0';
 	doc->latest_rm_eo = objective_eo;
 	return 0;
-	#elif (TOKENIZATION_METHOD == 1 || TOKENIZATION_METHOD == 2)
-	if(doc->tmp_udpipe_output_file != NULL && feof(doc->tmp_udpipe_output_file)){
+	#elif TOKENIZATION_METHOD == 2
+	if(!doc->tokenized){
+		if(launch_udpipe(doc) != 0){
+			perror("failed to call launch_udpipe\n");
+			return 1;
+		}
+		doc->reached_last_token = 0;
+		doc->usable = 0;
+	}
+	if(doc->current_span == doc->tokens.num_spans){
 		doc->reached_last_token = 1;
 		doc->usable = 0;
-		pclose(doc->tmp_udpipe_output_file);
-		doc->tmp_udpipe_output_file = NULL;
+		doc->tokenized = 0;
 		return 0;
 	}
-	if(doc->tmp_udpipe_output_file == NULL){
-		launch_udpipe(doc);
+	const struct udpipe_token_span span = doc->tokens.spans[doc->current_span];
+	size_t len = span.length;
+	if(len > JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1){
+		len = JSONL_CURRENT_TOKEN_BUFFER_SIZE - 1;
+	}
+	memcpy(doc->current_token, doc->tokens.arena + span.offset, len);
+	doc->current_token[len] = '\0';
+	doc->current_span++;
+	return 0;
+	#elif TOKENIZATION_METHOD == 1
+	if(doc->coprocess == NULL){
+		if(launch_udpipe(doc) != 0){
+			perror("failed to call launch_udpipe\n");
+			return 1;
+		}
 		doc->reached_last_token = 0;
 		doc->usable = 0;
 	}
-
-	while(fgets(doc->current_token, JSONL_CURRENT_TOKEN_BUFFER_SIZE, doc->tmp_udpipe_output_file) && doc->current_token[0] == '\n'){}
-	for(int32_t i = 0 ; i < JSONL_CURRENT_TOKEN_BUFFER_SIZE ; i++){
-		if(doc->current_token[i] == '\n'){
-			doc->current_token[i] = '\0';
-			break;
-		} else if(doc->current_token[i] == '\0'){
-			break;
-		}
+	int8_t end_of_document = 0;
+	if(udpipe_coprocess_next_token(doc->coprocess, doc->current_token, JSONL_CURRENT_TOKEN_BUFFER_SIZE, &end_of_document) != 0){
+		perror("failed to call udpipe_coprocess_next_token\n");
+		return 1;
+	}
+	if(end_of_document){
+		doc->reached_last_token = 1;
+		doc->usable = 0;
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
 	}
 	// printf("newly found token: %s\n", doc->current_token);
 	return 0;
@@ -237,17 +262,48 @@ int32_t iterate_document_current_token(struct document* const doc){
 }
 
 
+// text of a document that does not come from a JSONL file, tokenized from its start on the next call of iterate_document_current_token
+int32_t document_set_text(struct document* const doc, const char* const text, const size_t text_size){
+	if(text_size + 1 > doc->text_capacity){
+		char* const realloc_pointer = realloc(doc->text, text_size + 1);
+		if(realloc_pointer == NULL){
+			perror("[err] failed to realloc\n");
+			return 1;
+		}
+		doc->text = realloc_pointer;
+		doc->text_capacity = text_size + 1;
+	}
+	memcpy(doc->text, text, text_size);
+	doc->text[text_size] = '\0';
+	doc->text_size = text_size;
+
+	#if TOKENIZATION_METHOD == 0
+	doc->latest_rm_eo = 0;
+	#elif TOKENIZATION_METHOD == 1
+	if(doc->coprocess != NULL){ // previous document not read until the end
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
+	}
+	#elif TOKENIZATION_METHOD == 2
+	doc->tokenized = 0;
+	#endif
+	doc->reached_last_token = 0;
+	doc->usable = 1;
+	return 0;
+}
+
 void free_document(struct document* doc){
 	free(doc->identifier);
 	free(doc->text);
 	#if TOKENIZATION_METHOD == 0
 	regfree(&(doc->reg));
 	#elif TOKENIZATION_METHOD == 1
-	pclose(doc->tmp_udpipe_output_file);
+	if(doc->coprocess != NULL){
+		udpipe_coprocess_pool_release(doc->coprocess);
+		doc->coprocess = NULL;
+	}
 	#elif TOKENIZATION_METHOD == 2
-	if(doc->tmp_udpipe_output_file != NULL){fclose(doc->tmp_udpipe_output_file);}
-	if(doc->heap_char_output != NULL){free(doc->heap_char_output);}
-
+	udpipe_tokens_free(&(doc->tokens));
 	#endif
 }
 
@@ -341,6 +397,13 @@ int32_t iterate_jsonl_document_iterator(struct jsonl_document_iterator* restrict
 
 	#if TOKENIZATION_METHOD == 0
 	jdi->current_document.latest_rm_eo = 0;
+	#elif TOKENIZATION_METHOD == 1
+	if(jdi->current_document.coprocess != NULL){ // previous document not read until the end
+		udpipe_coprocess_pool_release(jdi->current_document.coprocess);
+		jdi->current_document.coprocess = NULL;
+	}
+	#elif TOKENIZATION_METHOD == 2
+	jdi->current_document.tokenized = 0;
 	#endif
 	jdi->current_document.reached_last_token = 0;
 	jdi->current_document.usable = 1;
@@ -603,13 +666,6 @@ int32_t iterate_jsonl_document_iterator(struct jsonl_document_iterator* restrict
 		jdi->file_is_done = 1;
 	}
 
-	#if TOKENIZATION_METHOD == 1
-	if(launch_udpipe(&(jdi->current_document)) != 0){
-		perror("Failed to call launch_udpipe\n");
-		return 1;
-	}
-	#endif
-
 	return 0;
 
 	realloc_fail:
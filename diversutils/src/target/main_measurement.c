@@ -41,9 +41,18 @@
 #include "distributions.h"
 #include "stats.h"
 #include "dfunctions.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
 #include "logging.h"
 #include "measurement.h"
+#include "recompute.h"
+#include "schedule.h"
+#include "file_queue.h"
+#include "batch.h"
+#include "serve.h"
+#include "corpus.h"
+#include "checkpoint.h"
+#include "shard.h"
+#include "instrument.h"
 
 #include "jsonl/parser.h"
 #include "jsonl/load.h"
@@ -73,491 +82,43 @@ int64_t stacked_sentence_count_target;
 double stacked_document_count_log10 = DOCUMENT_COUNT_RECOMPUTE_STEP_LOG10;
 int64_t stacked_document_count_target;
 
-int32_t read_list_simulation_files(const char * const path_list_simulation_files, char *** const resulting_paths, int32_t * num_input_paths){
-	FILE* f_paths_ptr = fopen(path_list_simulation_files, "r");
-	if(f_paths_ptr == NULL){
-		fprintf(stderr, "cannot open %s\n", path_list_simulation_files);
-		return 1;
-	}
-	// char* bfr[MAX_FILES];
-    char ** bfr;
-    const size_t bfr_step = 32;
-    size_t bfr_capacity = bfr_step;
-    size_t bfr_alloc_size = bfr_capacity * sizeof(char *);
-    bfr = malloc(bfr_alloc_size);
-    if(bfr == NULL){goto failure_alloc;}
-    memset(bfr, '\0', bfr_alloc_size);
-
-
-	char bfr_read[BFR_SIZE];
-	memset(bfr_read, '\0', BFR_SIZE);
-
-	int32_t num_files = 0;
-	while(fgets(bfr_read, BFR_SIZE - 1, f_paths_ptr)){
-		if(bfr_read[0] == '#'){continue;}
-
-		size_t bytes_to_cpy = strlen(bfr_read);
-		if(bfr_read[bytes_to_cpy - 1] == '\n'){bytes_to_cpy--;}
-		void* local_malloc_p = malloc(bytes_to_cpy + 1);
-		if(local_malloc_p == NULL){
-			perror("malloc failed\n");
-			return 1;
-		}
-		memset(local_malloc_p, '\0', bytes_to_cpy + 1);
-		memcpy(local_malloc_p, bfr_read, bytes_to_cpy);
-		bfr[num_files] = (char*) local_malloc_p;
-
-		num_files++;
-
-        if(((size_t) num_files) >= bfr_capacity){
-            size_t new_capacity = bfr_capacity + bfr_step;
-            bfr_alloc_size = new_capacity * sizeof(char *);
-            bfr = realloc(bfr, bfr_alloc_size);
-            if(bfr == NULL){goto failure_alloc;}
-            memset(&bfr[bfr_capacity], '\0', bfr_step * sizeof(char *));
-            bfr_capacity = new_capacity;
-        }
-	}
-
-	fclose(f_paths_ptr);
-
-    *resulting_paths = bfr;
-    *num_input_paths = num_files;
-
-    return 0;
-
-    failure_alloc:
-    perror("alloc failed\n");
-    return 1;
-}
-
 int32_t measurement(struct measurement_configuration * const mcfg){
-	const int32_t log_bfr_size = 512;
-	char log_bfr[512];
-
-	const uint8_t enable_distance_computation = mcfg->enable.disparity_functions && (mcfg->enable.stirling || mcfg->enable.ricotta_szeidl || mcfg->enable.pairwise || mcfg->enable.chao_et_al_functional_diversity || mcfg->enable.scheiner_species_phylogenetic_functional_diversity || mcfg->enable.leinster_cobbold_diversity || mcfg->enable.lexicographic || mcfg->enable.functional_evenness || mcfg->enable.mst || mcfg->enable.functional_dispersion || mcfg->enable.functional_divergence_modified);
-
 	stacked_sentence_count_target = log(stacked_sentence_count_log10) / log(10.0);
 	stacked_document_count_target = log(stacked_document_count_log10) / log(10.0);
 
-	struct sorted_array sorted_array_discarded_because_not_in_vector_database;
-	if(create_sorted_array(&sorted_array_discarded_because_not_in_vector_database, 0, sizeof(struct sorted_array_str_int_element), sorted_array_str_int_cmp, SORTED_ARRAY_METHOD) != 0){
-		perror("fai.led to call create_sorted_array\n");
-		return 1;
-	}
-
-	struct graph g = {0};
-	// #if MST_SANITY_TESTING == 1
-//	if(create_graph(&g, 1 << 10, 2, FP32) != 0){
-//		perror("failed to call create_graph_empty\n");
-//		return 1;
-//	}
-	// #else
-	if(create_graph_empty(&g) != 0){
-		perror("failed to call create_graph_empty\n");
-		return 1;
-	}
-	// #endif
-	struct graph_distance_heap heap;
-	struct minimum_spanning_tree mst;
-
-	memset(&heap, '\0', sizeof(struct graph_distance_heap));
-	memset(&mst, '\0', sizeof(struct minimum_spanning_tree));
-
-    int32_t err;
-
+	// shared by every corpus of a batch; each graph keeps its own view of the entries
 	struct word2vec w2v;
-    	// #if MST_SANITY_TESTING == 0
-	err = load_word2vec_binary(&w2v, mcfg->io.w2v_path);
-	if(err != 0){
+	if(load_word2vec_binary(&w2v, mcfg->io.w2v_path) != 0){
 		fprintf(stderr, "failed to call load_word2vec binary: %s\n", mcfg->io.w2v_path);
 		return 1;
 	}
 
-	for(uint64_t i = 0 ; i < w2v.num_vectors ; i++){
-		w2v.keys[i].active_in_current_graph = 0;
-		w2v.keys[i].num_occurrences = 0;
-		w2v.keys[i].graph_node_pointer = NULL; // !
-	}
-        // #endif
-
-	int32_t num_input_paths = 0;
-    int32_t num_input_paths_true_positive = 0;
-	char** input_paths = NULL;
-	char** input_paths_tp = NULL; // !
-
-    // <--
-    // #if MST_SANITY_TESTING == 0
-    if(read_list_simulation_files(mcfg->io.input_path, &input_paths, &num_input_paths) != 0){goto failure_read_list_simulation_files;}
-    if(mcfg->io.input_path_tp != NULL){if(read_list_simulation_files(mcfg->io.input_path_tp, &input_paths_tp, &num_input_paths_true_positive) != 0){goto failure_read_list_simulation_files;}}
-    // #endif
-
-	mcfg->io.f_ptr = fopen(mcfg->io.output_path, "w");
-	if(mcfg->io.f_ptr == NULL){fprintf(stderr, "Failed to open file: %s\n", mcfg->io.output_path); return EXIT_FAILURE;}
-	// fprintf(mcfg->io.f_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist"); // DO NOT REMOVE
-	fprintf(mcfg->io.f_ptr, "num_active_files\tnum_sentences_containing_mwe\tnum_sentences_containing_mwe_tp_only\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist");
-
-	if(mcfg->enable.disparity_functions){
-		if(mcfg->enable.stirling){fprintf(mcfg->io.f_ptr, "\tstirling_alpha%.10e_beta%.10e", mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta);}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.ricotta_szeidl){fprintf(mcfg->io.f_ptr, "\tricotta_szeidl_alpha%.10e", mcfg->div_param.ricotta_szeidl_alpha);}
-		if(mcfg->enable.pairwise){fprintf(mcfg->io.f_ptr, "\tpairwise");}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.chao_et_al_functional_diversity){fprintf(mcfg->io.f_ptr, "\tchao_et_al_functional_diversity_alpha%.10e\tchao_et_al_functional_hill_number_alpha%.10e", mcfg->div_param.chao_et_al_functional_diversity_alpha, mcfg->div_param.chao_et_al_functional_diversity_alpha);}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.scheiner_species_phylogenetic_functional_diversity){fprintf(mcfg->io.f_ptr, "\tscheiner_species_phylogenetic_functional_diversity_alpha%.10e\tscheiner_species_phylogenetic_functional_hill_number_alpha%.10e", mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha, mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha);}
-		if(mcfg->enable.leinster_cobbold_diversity){fprintf(mcfg->io.f_ptr, "\tleinster_cobbold_diversity_alpha%.10e\tleinster_cobbold_hill_number_alpha%.10e", mcfg->div_param.leinster_cobbold_diversity_alpha, mcfg->div_param.leinster_cobbold_diversity_alpha);}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.lexicographic){fprintf(mcfg->io.f_ptr, "\tlexicographic\tlexicographic_hybrid_scheiner");}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_evenness){fprintf(mcfg->io.f_ptr, "\tfunctional_evenness");}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.mst){fprintf(mcfg->io.f_ptr, "\tmst");}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_dispersion){fprintf(mcfg->io.f_ptr, "\tfunctional_dispersion");}
-		if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_divergence_modified){fprintf(mcfg->io.f_ptr, "\tfunctional_divergence_modified");}
-	}
-	if(mcfg->enable.non_disparity_functions){
-		if(mcfg->enable.shannon_weaver_entropy){fprintf(mcfg->io.f_ptr, "\tshannon_weaver_entropy\tshannon_weaver_hill_number");}
-		if(mcfg->enable.good_entropy){fprintf(mcfg->io.f_ptr, "\tgood_entropy_alpha%.4e_beta%.4e", mcfg->div_param.good_alpha, mcfg->div_param.good_beta);}
-		if(mcfg->enable.renyi_entropy){fprintf(mcfg->io.f_ptr, "\trenyi_entropy_alpha%.4e\trenyi_hill_number_alpha%.4e", mcfg->div_param.renyi_alpha, mcfg->div_param.renyi_alpha);}
-		if(mcfg->enable.patil_taillie_entropy){fprintf(mcfg->io.f_ptr, "\tpatil_taillie_entropy_alpha%.4e\tpatil_taillie_hill_number_alpha%.4e", mcfg->div_param.patil_taillie_alpha, mcfg->div_param.patil_taillie_alpha);}
-		if(mcfg->enable.q_logarithmic_entropy){fprintf(mcfg->io.f_ptr, "\tq_logarithmic_entropy_alpha%.4e\tq_logarithmic_hill_number_alpha%.4e", mcfg->div_param.q_logarithmic_q, mcfg->div_param.q_logarithmic_q);}
-		if(mcfg->enable.simpson_index){fprintf(mcfg->io.f_ptr, "\tsimpson_index");}
-		if(mcfg->enable.simpson_dominance_index){fprintf(mcfg->io.f_ptr, "\tsimpson_dominance_index");}
-		if(mcfg->enable.hill_number_standard){fprintf(mcfg->io.f_ptr, "\thill_number_standard_alpha%.4e", mcfg->div_param.hill_number_standard_alpha);}
-		if(mcfg->enable.hill_evenness){fprintf(mcfg->io.f_ptr, "\thill_evenness_alpha%.4e_beta%.4e", mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);}
-		if(mcfg->enable.berger_parker_index){fprintf(mcfg->io.f_ptr, "\tberger_parker_index");}
-		if(mcfg->enable.junge1994_page22){fprintf(mcfg->io.f_ptr, "\tjunge1994_page22");}
-		if(mcfg->enable.brillouin_diversity){fprintf(mcfg->io.f_ptr, "\tbrillouin_diversity");}
-		if(mcfg->enable.mcintosh_index){fprintf(mcfg->io.f_ptr, "\tmcintosh_index");}
-		if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){fprintf(mcfg->io.f_ptr, "\tsw_entropy_over_log_n_species_pielou1975");}
-		if(mcfg->enable.sw_e_heip){fprintf(mcfg->io.f_ptr, "\tsw_e_heip");}
-		if(mcfg->enable.sw_e_one_minus_d){fprintf(mcfg->io.f_ptr, "\te_one_minus_D");}
-		if(mcfg->enable.sw_e_one_over_ln_d_williams1964){fprintf(mcfg->io.f_ptr, "\te_one_over_ln_D_williams1964");}
-		if(mcfg->enable.sw_e_minus_ln_d_pielou1977){fprintf(mcfg->io.f_ptr, "\te_minus_ln_D_pielou1977");}
-		if(mcfg->enable.sw_f_2_1_alatalo1981){fprintf(mcfg->io.f_ptr, "\tsw_f_2_1_alatalo1981");}
-		if(mcfg->enable.sw_g_2_1_molinari1989){fprintf(mcfg->io.f_ptr, "\tsw_g_2_1_molinari1989");}
-		if(mcfg->enable.sw_e_bulla1994){fprintf(mcfg->io.f_ptr, "\tsw_e_bulla1994");}
-		if(mcfg->enable.sw_o_bulla1994){fprintf(mcfg->io.f_ptr, "\tsw_o_bulla1994");}
-		if(mcfg->enable.sw_e_mci_pielou1969){fprintf(mcfg->io.f_ptr, "\tsw_e_mci_pielou1969");}
-		if(mcfg->enable.sw_e_prime_camargo1993){fprintf(mcfg->io.f_ptr, "\tsw_e_prime_camargo1993");}
-		if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){fprintf(mcfg->io.f_ptr, "\tsw_e_var_smith_and_wilson1996_original");}
-	}
-	fprintf(mcfg->io.f_ptr, "\n");
-
-	mcfg->io.f_timing_ptr = NULL;
-	if(mcfg->io.enable_output_timing){
-		mcfg->io.f_timing_ptr = fopen(mcfg->io.output_path_timing, "w");
-		if(mcfg->io.f_timing_ptr == NULL){fprintf(stderr, "Failed to open file: %s\n", mcfg->io.output_path_timing); return EXIT_FAILURE;}
-		// fprintf(mcfg->io.f_timing_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist");
-		fprintf(mcfg->io.f_timing_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn");
-
-		if(mcfg->enable.disparity_functions){
-			// ----
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){fprintf(mcfg->io.f_timing_ptr, "\tm_mst_creation");}
-			if(enable_distance_computation){fprintf(mcfg->io.f_timing_ptr, "\tdist_matrix_computation");}
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){fprintf(mcfg->io.f_timing_ptr, "\tdist_heap_computation");}
-			if(enable_distance_computation){fprintf(mcfg->io.f_timing_ptr, "\tdist_stat_computation");}
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){fprintf(mcfg->io.f_timing_ptr, "\tmst_computation");}
-			// ----
-
-			if(mcfg->enable.stirling){fprintf(mcfg->io.f_timing_ptr, "\tstirling_alpha%.10e_beta%.10e", mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.ricotta_szeidl){fprintf(mcfg->io.f_timing_ptr, "\tricotta_szeidl_alpha%.10e", mcfg->div_param.ricotta_szeidl_alpha);}
-			if(mcfg->enable.pairwise){fprintf(mcfg->io.f_timing_ptr, "\tpairwise");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.chao_et_al_functional_diversity){fprintf(mcfg->io.f_timing_ptr, "\tchao_et_al_functional_diversity_alpha%.10e", mcfg->div_param.chao_et_al_functional_diversity_alpha);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.scheiner_species_phylogenetic_functional_diversity){fprintf(mcfg->io.f_timing_ptr, "\tscheiner_species_phylogenetic_functional_diversity_alpha%.10e", mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.leinster_cobbold_diversity){fprintf(mcfg->io.f_timing_ptr, "\tleinster_cobbold_diversity_alpha%.10e", mcfg->div_param.leinster_cobbold_diversity_alpha);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.lexicographic){fprintf(mcfg->io.f_timing_ptr, "\tlexicographic");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_evenness){fprintf(mcfg->io.f_timing_ptr, "\tfunctional_evenness");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.mst){fprintf(mcfg->io.f_timing_ptr, "\tmst");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_dispersion){fprintf(mcfg->io.f_timing_ptr, "\tfunctional_dispersion");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_divergence_modified){fprintf(mcfg->io.f_timing_ptr, "\tfunctional_divergence_modified");}
-		}
-		if(mcfg->enable.non_disparity_functions){
-			if(mcfg->enable.shannon_weaver_entropy){fprintf(mcfg->io.f_timing_ptr, "\tshannon_weaver_entropy");}
-			if(mcfg->enable.good_entropy){fprintf(mcfg->io.f_timing_ptr, "\tgood_entropy_alpha%.4e_beta%.4e", mcfg->div_param.good_alpha, mcfg->div_param.good_beta);}
-			if(mcfg->enable.renyi_entropy){fprintf(mcfg->io.f_timing_ptr, "\trenyi_entropy_alpha%.4e", mcfg->div_param.renyi_alpha);}
-			if(mcfg->enable.patil_taillie_entropy){fprintf(mcfg->io.f_timing_ptr, "\tpatil_taillie_entropy_alpha%.4e", mcfg->div_param.patil_taillie_alpha);}
-			if(mcfg->enable.q_logarithmic_entropy){fprintf(mcfg->io.f_timing_ptr, "\tq_logarithmic_entropy_alpha%.4e", mcfg->div_param.q_logarithmic_q);}
-			if(mcfg->enable.simpson_index){fprintf(mcfg->io.f_timing_ptr, "\tsimpson_index");}
-			if(mcfg->enable.simpson_dominance_index){fprintf(mcfg->io.f_timing_ptr, "\tsimpson_dominance_index");}
-			if(mcfg->enable.hill_number_standard){fprintf(mcfg->io.f_timing_ptr, "\thill_number_standard_alpha%.4e", mcfg->div_param.hill_number_standard_alpha);}
-			if(mcfg->enable.hill_evenness){fprintf(mcfg->io.f_timing_ptr, "\thill_evenness_alpha%.4e_beta%.4e", mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);}
-			if(mcfg->enable.berger_parker_index){fprintf(mcfg->io.f_timing_ptr, "\tberger_parker_index");}
-			if(mcfg->enable.junge1994_page22){fprintf(mcfg->io.f_timing_ptr, "\tjunge1994_page22");}
-			if(mcfg->enable.brillouin_diversity){fprintf(mcfg->io.f_timing_ptr, "\tbrillouin_diversity");}
-			if(mcfg->enable.mcintosh_index){fprintf(mcfg->io.f_timing_ptr, "\tmcintosh_index");}
-			if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){fprintf(mcfg->io.f_timing_ptr, "\tsw_entropy_over_log_n_species_pielou1975");}
-			if(mcfg->enable.sw_e_heip){fprintf(mcfg->io.f_timing_ptr, "\tsw_e_heip");}
-			if(mcfg->enable.sw_e_one_minus_d){fprintf(mcfg->io.f_timing_ptr, "\te_one_minus_D");}
-			if(mcfg->enable.sw_e_one_over_ln_d_williams1964){fprintf(mcfg->io.f_timing_ptr, "\te_one_over_ln_D_williams1964");}
-			if(mcfg->enable.sw_e_minus_ln_d_pielou1977){fprintf(mcfg->io.f_timing_ptr, "\te_minus_ln_D_pielou1977");}
-			if(mcfg->enable.sw_f_2_1_alatalo1981){fprintf(mcfg->io.f_timing_ptr, "\tsw_f_2_1_alatalo1981");}
-			if(mcfg->enable.sw_g_2_1_molinari1989){fprintf(mcfg->io.f_timing_ptr, "\tsw_g_2_1_molinari1989");}
-			if(mcfg->enable.sw_e_bulla1994){fprintf(mcfg->io.f_timing_ptr, "\tsw_e_bulla1994");}
-			if(mcfg->enable.sw_o_bulla1994){fprintf(mcfg->io.f_timing_ptr, "\tsw_o_bulla1994");}
-			if(mcfg->enable.sw_e_mci_pielou1969){fprintf(mcfg->io.f_timing_ptr, "\tsw_e_mci_pielou1969");}
-			if(mcfg->enable.sw_e_prime_camargo1993){fprintf(mcfg->io.f_timing_ptr, "\tsw_e_prime_camargo1993");}
-			if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){fprintf(mcfg->io.f_timing_ptr, "\tsw_e_var_smith_and_wilson1996_original");}
-		}
-		fprintf(mcfg->io.f_timing_ptr, "\n");
+	const uint8_t enable_batch = mcfg->io.batch_path != NULL && mcfg->io.batch_path[0] != '\0';
+	const uint8_t enable_shard_output = mcfg->shard.output_path[0] != '\0';
+	const uint8_t enable_shard_input = mcfg->shard.input_path[0] != '\0';
+	const uint8_t enable_serve = mcfg->serve.path != NULL && mcfg->serve.path[0] != '\0';
+	if((enable_shard_output && enable_shard_input) || ((enable_shard_output || enable_shard_input) && enable_batch) || (enable_shard_input && mcfg->checkpoint.path[0] != '\0')){
+		error_format(__FILE__, __func__, __LINE__, "a shard is either written or measured, by a single corpus without checkpoints");
+		free_word2vec(&w2v);
+		return 1;
 	}
-
-	mcfg->io.f_memory_ptr = NULL;
-	if(mcfg->io.enable_output_memory){
-		mcfg->io.f_memory_ptr = fopen(mcfg->io.output_path_memory, "w");
-		if(mcfg->io.f_memory_ptr == NULL){fprintf(stderr, "Failed to open file: %s\n", mcfg->io.output_path_memory); return EXIT_FAILURE;}
-		// fprintf(mcfg->io.f_memory_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist");
-		fprintf(mcfg->io.f_memory_ptr, "num_active_files\tnum_active_sentences\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn");
-
-		if(mcfg->enable.disparity_functions){
-			// ----
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){fprintf(mcfg->io.f_memory_ptr, "\tm_mst_creation");}
-			if(enable_distance_computation){fprintf(mcfg->io.f_memory_ptr, "\tdist_matrix_computation");}
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){fprintf(mcfg->io.f_memory_ptr, "\tdist_heap_computation");}
-			if(enable_distance_computation){fprintf(mcfg->io.f_memory_ptr, "\tdist_stat_computation");}
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){fprintf(mcfg->io.f_memory_ptr, "\tmst_computation");}
-			// ----
-	
-			if(mcfg->enable.stirling){fprintf(mcfg->io.f_memory_ptr, "\tstirling_alpha%.10e_beta%.10e", mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.ricotta_szeidl){fprintf(mcfg->io.f_memory_ptr, "\tricotta_szeidl_alpha%.10e", mcfg->div_param.ricotta_szeidl_alpha);}
-			if(mcfg->enable.pairwise){fprintf(mcfg->io.f_memory_ptr, "\tpairwise");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.chao_et_al_functional_diversity){fprintf(mcfg->io.f_memory_ptr, "\tchao_et_al_functional_diversity_alpha%.10e", mcfg->div_param.chao_et_al_functional_diversity_alpha);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.scheiner_species_phylogenetic_functional_diversity){fprintf(mcfg->io.f_memory_ptr, "\tscheiner_species_phylogenetic_functional_diversity_alpha%.10e", mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.leinster_cobbold_diversity){fprintf(mcfg->io.f_memory_ptr, "\tleinster_cobbold_diversity_alpha%.10e", mcfg->div_param.leinster_cobbold_diversity_alpha);}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.lexicographic){fprintf(mcfg->io.f_memory_ptr, "\tlexicographic");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_evenness){fprintf(mcfg->io.f_memory_ptr, "\tfunctional_evenness");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.mst){fprintf(mcfg->io.f_memory_ptr, "\tmst");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_dispersion){fprintf(mcfg->io.f_memory_ptr, "\tfunctional_dispersion");}
-			if(!mcfg->threading.enable_iterative_distance_computation && mcfg->enable.functional_divergence_modified){fprintf(mcfg->io.f_memory_ptr, "\tfunctional_divergence_modified");}
-		}
-		if(mcfg->enable.non_disparity_functions){
-			if(mcfg->enable.shannon_weaver_entropy){fprintf(mcfg->io.f_memory_ptr, "\tshannon_weaver_entropy");}
-			if(mcfg->enable.good_entropy){fprintf(mcfg->io.f_memory_ptr, "\tgood_entropy_alpha%.4e_beta%.4e", mcfg->div_param.good_alpha, mcfg->div_param.good_beta);}
-			if(mcfg->enable.renyi_entropy){fprintf(mcfg->io.f_memory_ptr, "\trenyi_entropy_alpha%.4e", mcfg->div_param.renyi_alpha);}
-			if(mcfg->enable.patil_taillie_entropy){fprintf(mcfg->io.f_memory_ptr, "\tpatil_taillie_entropy_alpha%.4e", mcfg->div_param.patil_taillie_alpha);}
-			if(mcfg->enable.q_logarithmic_entropy){fprintf(mcfg->io.f_memory_ptr, "\tq_logarithmic_entropy_alpha%.4e", mcfg->div_param.q_logarithmic_q);}
-			if(mcfg->enable.simpson_index){fprintf(mcfg->io.f_memory_ptr, "\tsimpson_index");}
-			if(mcfg->enable.simpson_dominance_index){fprintf(mcfg->io.f_memory_ptr, "\tsimpson_dominance_index");}
-			if(mcfg->enable.hill_number_standard){fprintf(mcfg->io.f_memory_ptr, "\thill_number_standard_alpha%.4e", mcfg->div_param.hill_number_standard_alpha);}
-			if(mcfg->enable.hill_evenness){fprintf(mcfg->io.f_memory_ptr, "\thill_evenness_alpha%.4e_beta%.4e", mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);}
-			if(mcfg->enable.berger_parker_index){fprintf(mcfg->io.f_memory_ptr, "\tberger_parker_index");}
-			if(mcfg->enable.junge1994_page22){fprintf(mcfg->io.f_memory_ptr, "\tjunge1994_page22");}
-			if(mcfg->enable.brillouin_diversity){fprintf(mcfg->io.f_memory_ptr, "\tbrillouin_diversity");}
-			if(mcfg->enable.mcintosh_index){fprintf(mcfg->io.f_memory_ptr, "\tmcintosh_index");}
-			if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){fprintf(mcfg->io.f_memory_ptr, "\tsw_entropy_over_log_n_species_pielou1975");}
-			if(mcfg->enable.sw_e_heip){fprintf(mcfg->io.f_memory_ptr, "\tsw_e_heip");}
-			if(mcfg->enable.sw_e_one_minus_d){fprintf(mcfg->io.f_memory_ptr, "\te_one_minus_D");}
-			if(mcfg->enable.sw_e_one_over_ln_d_williams1964){fprintf(mcfg->io.f_memory_ptr, "\te_one_over_ln_D_williams1964");}
-			if(mcfg->enable.sw_e_minus_ln_d_pielou1977){fprintf(mcfg->io.f_memory_ptr, "\te_minus_ln_D_pielou1977");}
-			if(mcfg->enable.sw_f_2_1_alatalo1981){fprintf(mcfg->io.f_memory_ptr, "\tsw_f_2_1_alatalo1981");}
-			if(mcfg->enable.sw_g_2_1_molinari1989){fprintf(mcfg->io.f_memory_ptr, "\tsw_g_2_1_molinari1989");}
-			if(mcfg->enable.sw_e_bulla1994){fprintf(mcfg->io.f_memory_ptr, "\tsw_e_bulla1994");}
-			if(mcfg->enable.sw_o_bulla1994){fprintf(mcfg->io.f_memory_ptr, "\tsw_o_bulla1994");}
-			if(mcfg->enable.sw_e_mci_pielou1969){fprintf(mcfg->io.f_memory_ptr, "\tsw_e_mci_pielou1969");}
-			if(mcfg->enable.sw_e_prime_camargo1993){fprintf(mcfg->io.f_memory_ptr, "\tsw_e_prime_camargo1993");}
-			if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){fprintf(mcfg->io.f_memory_ptr, "\tsw_e_var_smith_and_wilson1996_original");}
-		}
-		fprintf(mcfg->io.f_memory_ptr, "\n");
+	if(enable_serve && (enable_batch || enable_shard_output || enable_shard_input || mcfg->checkpoint.path[0] != '\0')){
+		error_format(__FILE__, __func__, __LINE__, "the jobs of a server are single corpora, without shards nor checkpoints");
+		free_word2vec(&w2v);
+		return 1;
 	}
 
-    struct measurement_structure_references sref = {
-        .g = &g,
-        .mst = &mst,
-        .heap = &heap,
-        .w2v = &w2v,
-        .sorted_array_discarded_because_not_in_vector_database = &sorted_array_discarded_because_not_in_vector_database,
-    };
-
-    struct measurement_mutables mmut = {
-        .best_s = -1.0,
-        .prev_best_s = -1.0,
-        .prev_num_nodes = 0,
-        .mst_initialised = 0,
-        .sentence = (struct measurement_mutable_counters) {
-            .num_containing_mwe = 0,
-            .num_containing_mwe_tp_only = 0,
-            .num_all = 0,
-            .count_target = 1,
-            .stacked_log = 0.0,
-        },
-        .document = (struct measurement_mutable_counters) {
-            .num_all = 0,
-            .count_target = 1,
-            .stacked_log = 0.0,
-        },
-    };
-    if(pthread_mutex_init(&(mmut.mutex), NULL) != 0){
-        perror("Failed to call pthread_mutex_init for mmut\n");
-        return 1;
-    }
-
-
-    // #if MST_SANITY_TESTING == 0
-	int64_t num_sentences = 0;
-	int64_t max_num_sentences = 10000;
-	const int8_t use_max_num_sentences = 0;
-
-	int64_t num_documents = 0;
-	int64_t max_num_documents = 10000;
-	const uint8_t use_max_num_documents = 0;
-
-	int64_t num_all_sentences = 0; // even ignored sentences
-	int64_t max_num_all_sentences = 50000;
-	const int8_t use_max_num_all_sentences = 0;
-
-	enum {
-		CUPT,
-		JSONL
-	};
-
-    // pthread_mutex_t misc_var_mutex;
-    if(pthread_mutex_init(&mmut.mutex, NULL) != 0){
-        perror("Failed to call pthread_mutex_init for misc_var_mutex\n");
-        return 1;
-    }
-
-    size_t alloc_size_file_thread = sizeof(pthread_t) * mcfg->threading.num_file_reading_threads;
-    pthread_t * const threads_file_reading = malloc(alloc_size_file_thread);
-    if(threads_file_reading == NULL){
-        perror("malloc failed\n");
-        return 1;
-    }
-    memset(threads_file_reading, '\0', alloc_size_file_thread);
-
-    size_t alloc_size_file_thread_args = sizeof(struct measurement_file_thread) * mcfg->threading.num_file_reading_threads;
-    struct measurement_file_thread * const thread_args_file_reading = malloc(alloc_size_file_thread_args);
-    if(thread_args_file_reading == NULL){
-        perror("malloc failed\n");
-        return 1;
-    }
-    memset(thread_args_file_reading, '\0', alloc_size_file_thread_args);
-
-    int32_t i;
-
-	for(i = 0 ; i < num_input_paths && ((!use_max_num_all_sentences) || num_all_sentences < max_num_all_sentences) && ((!use_max_num_sentences) || num_sentences < max_num_sentences) && ((!use_max_num_documents) || num_documents < max_num_documents); i++){
-        int32_t thread_index = i % mcfg->threading.num_file_reading_threads;
-        if(i >= mcfg->threading.num_file_reading_threads){
-            if(pthread_join(threads_file_reading[thread_index], NULL) != 0){
-                fprintf(stderr, "Failed to pthread_join for file of index %i; thread_index: %i\n", i, thread_index);
-                return 1;
-            }
-            memset(&(threads_file_reading[thread_index]), '\0', sizeof(pthread_t));
-        }
-
-		num_documents++;
-		/* // DO NOT REMOVE
-		if(input_paths_tp == NULL){
-			printf("processing %s\n", input_paths[i]);
-		} else {
-			printf("processing %s (true positives: %s)\n", input_paths[i], input_paths_tp[i]);
-		}
-		*/
-		size_t input_path_len = strlen(input_paths[i]);
-		int32_t current_file_format = 0;
-		if(strcmp(&(input_paths[i][input_path_len - 5]), ".cupt") == 0 || strcmp(&(input_paths[i][input_path_len - 7]), ".conllu") == 0){
-			current_file_format = CUPT;
-			memset(log_bfr, '\0', log_bfr_size * sizeof(char));
-			snprintf(log_bfr, log_bfr_size, "CUPT: %s", input_paths[i]);
-			info_format(__FILE__, __func__, __LINE__, log_bfr);
-		} else if(strcmp(&(input_paths[i][input_path_len - 6]), ".jsonl") == 0){
-			current_file_format = JSONL;
-			memset(log_bfr, '\0', log_bfr_size * sizeof(char));
-			snprintf(log_bfr, log_bfr_size, "JSONL: %s", input_paths[i]);
-			info_format(__FILE__, __func__, __LINE__, log_bfr);
-		} else {
-			printf("unknown file type: %s\n", input_paths[i]);
-			return 1;
-		}
-
-        struct measurement_file_thread mft = {
-            .i = i,
-            .filename = input_paths[i],
-            .mcfg = mcfg,
-            .sref = &sref,
-            .mmut = &mmut,
-        };
-        if(mcfg->io.input_path_tp != NULL){
-            mft.filename_tp = input_paths_tp[i];
-        } else {
-            mft.filename_tp = NULL;
-        }
-        memcpy(&(thread_args_file_reading[thread_index]), &mft, sizeof(struct measurement_file_thread));
-		if(current_file_format == CUPT){
-            if(pthread_create(&(threads_file_reading[thread_index]), NULL, cupt_to_graph_thread, &(thread_args_file_reading[thread_index])) != 0){
-                perror("failed to call pthread_create\n");
-                return 1;
-            }
-		} else if(current_file_format == JSONL){
-            if(pthread_create(&(threads_file_reading[thread_index]), NULL, jsonl_to_graph_thread, &(thread_args_file_reading[thread_index])) != 0){
-                perror("failed to call pthread_create\n");
-                return 1;
-            }
-		}
+	int32_t result;
+	if(enable_serve){
+		result = measurement_serve_socket(mcfg, &w2v);
+	} else if(enable_batch){
+		result = measurement_batch(mcfg, &w2v);
+	} else {
+		result = measurement_corpus(mcfg, &w2v, NULL, 0);
 	}
 
-    for(int32_t j = 0 ; j < i && j < mcfg->threading.num_file_reading_threads ; j++){
-        if(pthread_join(threads_file_reading[j], NULL) != 0){
-            fprintf(stderr, "Failed to pthread_join for file of index %i; thread_index: %i\n", i, j);
-            return 1;
-        }
-    }
-    // #else
-    // int32_t i = 0;
-    // #endif
-
-    memset(log_bfr, '\0', log_bfr_size);
-    snprintf(log_bfr, log_bfr_size, "Running final snapshot with %li nodes", g.num_nodes);
-    info_format(__FILE__, __func__, __LINE__, log_bfr);
-
-    int32_t return_status = 0;
-
-    pthread_mutex_lock(&g.mutex_nodes);
-    compute_graph_relative_proportions(&g);
-    if(zipfian_fit_from_graph(&g, &mmut.best_s) != 0){
-        perror("Failed to call zipfian_fit_from_graph\n");
-        return_status = 1;
-    } else {
-        if(apply_diversity_functions_to_graph(i, mcfg, &sref, &mmut) != 0){
-            perror("Failed to call apply_diversity_functions_to_graph\n");
-            return_status = 1;
-        }
-    }
-    
-    pthread_mutex_unlock(&g.mutex_nodes);
-
-    pthread_mutex_destroy(&mmut.mutex);
-
-	free_graph(&g);
-	free_graph_distance_heap(&heap);
-	free_minimum_spanning_tree(&mst);
-
-	free_sorted_array(&sorted_array_discarded_because_not_in_vector_database);
-
-    // #if MST_SANITY_TESTING == 0
 	free_word2vec(&w2v);
-
-    free(threads_file_reading);
-    free(thread_args_file_reading);
-
-	// for(int32_t i = 0 ; i < num_files ; i++){
-	for(int32_t i = 0 ; i < num_input_paths ; i++){
-		// free(bfr[i]);
-		free(input_paths[i]);
-        if(mcfg->io.input_path_tp != NULL){free(input_paths_tp[i]);}
-	}
-    free(input_paths);
-    if(mcfg->io.input_path_tp != NULL){free(input_paths_tp);}
-    // #endif
-
-	fclose(mcfg->io.f_ptr);
-	if(mcfg->io.f_timing_ptr != NULL){fclose(mcfg->io.f_timing_ptr);}
-	if(mcfg->io.f_memory_ptr != NULL){fclose(mcfg->io.f_memory_ptr);}
-
-    if(pthread_mutex_destroy(&(mmut.mutex)) != 0){
-        perror("Failed to call pthread_mutex_destroy for mmut\n");
-        return_status = 1;
-    }
-
-	return return_status;
-
-    failure_read_list_simulation_files:
-    perror("failed to call read_list_simulation_files\n");
-    return 1;
+	return result;
 }
 
 int32_t main(int32_t argc, char** argv){
@@ -565,15 +126,31 @@ int32_t main(int32_t argc, char** argv){
 	char* argv_jsonl_content_key = NULL;
 	char* argv_input_path = NULL;
 	char* argv_input_path_tp = NULL;
+	char* argv_batch_path = BATCH_PATH;
 	char* argv_output_path = NULL;
 	char* argv_output_path_timing = NULL;
 	char* argv_output_path_memory = NULL;
+	uint8_t argv_output_format = OUTPUT_FORMAT;
+	uint8_t argv_output_compression = OUTPUT_COMPRESSION;
+	uint32_t argv_output_row_group_size = OUTPUT_ROW_GROUP_SIZE;
+	char* argv_trace_path = TRACE_PATH;
+	uint8_t argv_enable_hardware_counters = ENABLE_HARDWARE_COUNTERS;
+	char* argv_checkpoint_path = CHECKPOINT_PATH;
+	double argv_checkpoint_interval = CHECKPOINT_INTERVAL;
+	uint8_t argv_resume = RESUME;
+	char* argv_shard_output_path = SHARD_OUTPUT_PATH;
+	char* argv_shard_input_path = SHARD_INPUT_PATH;
+	char* argv_serve_path = SERVE_PATH;
+	int32_t argv_serve_num_jobs = SERVE_NUM_JOBS;
+	int32_t argv_serve_queue_size = SERVE_QUEUE_SIZE;
 	char* argv_udpipe_model_path = NULL;
 	// uint32_t argv_tokenization_method = TOKENIZATION_METHOD;
 	uint32_t argv_target_column = TARGET_COLUMN;
 	int32_t argv_num_row_threads = NUM_ROW_THREADS;
 	int32_t argv_num_matrix_threads = NUM_MATRIX_THREADS;
     int32_t argv_num_file_reading_threads = NUM_FILE_READING_THREADS;
+    int32_t argv_recompute_queue_size = RECOMPUTE_QUEUE_SIZE;
+    uint8_t argv_schedule_largest_first = SCHEDULE_LARGEST_FIRST;
 	uint8_t argv_enable_token_utf8_normalisation = ENABLE_TOKEN_UTF8_NORMALISATION;
 	uint8_t argv_enable_stirling = ENABLE_STIRLING;
 	uint8_t argv_enable_ricotta_szeidl = ENABLE_RICOTTA_SZEIDL;
@@ -597,6 +174,12 @@ int32_t main(int32_t argc, char** argv){
 	double argv_sentence_count_recompute_step_log10 = SENTENCE_COUNT_RECOMPUTE_STEP_LOG10;
 	uint64_t argv_document_count_recompute_step = DOCUMENT_COUNT_RECOMPUTE_STEP;
 	double argv_document_count_recompute_step_log10 = DOCUMENT_COUNT_RECOMPUTE_STEP_LOG10;
+	uint8_t argv_sentence_recompute_step_use_adaptive = SENTENCE_RECOMPUTE_STEP_USE_ADAPTIVE;
+	uint8_t argv_document_recompute_step_use_adaptive = DOCUMENT_RECOMPUTE_STEP_USE_ADAPTIVE;
+	double argv_adaptive_recompute_compute_fraction = ADAPTIVE_RECOMPUTE_COMPUTE_FRACTION;
+	uint64_t argv_adaptive_recompute_min_step = ADAPTIVE_RECOMPUTE_MIN_STEP;
+	uint64_t argv_adaptive_recompute_max_step = ADAPTIVE_RECOMPUTE_MAX_STEP;
+	uint8_t argv_adaptive_recompute_deterministic = ADAPTIVE_RECOMPUTE_DETERMINISTIC;
 	uint8_t argv_enable_functional_evenness = ENABLE_FUNCTIONAL_EVENNESS;
 	uint8_t argv_enable_mst = ENABLE_MST;
 	uint8_t argv_enable_functional_dispersion = ENABLE_FUNCTIONAL_DISPERSION;
@@ -645,6 +228,7 @@ int32_t main(int32_t argc, char** argv){
 	double argv_hill_evenness_beta = HILL_EVENNESS_BETA;
 
 	uint8_t argv_force_timing_and_memory_to_output_path = 0;
+	size_t argv_oov_memory_cap = OOV_MEMORY_CAP;
 
 	for(int32_t i = 1 ; i < argc ; i++){
 		if(strncmp(argv[i], "--w2v_path=", 11) == 0){argv_w2v_path = argv[i] + 11;}
@@ -658,12 +242,32 @@ int32_t main(int32_t argc, char** argv){
 		else if(strncmp(argv[i], "--num_row_threads=", 18) == 0){argv_num_row_threads = (int32_t) strtol(argv[i] + 18, NULL, 10);}
 		else if(strncmp(argv[i], "--num_matrix_threads=", 21) == 0){argv_num_matrix_threads = (int32_t) strtol(argv[i] + 21, NULL, 10);}
 		else if(strncmp(argv[i], "--num_file_reading_threads=", 27) == 0){argv_num_file_reading_threads = (int32_t) strtol(argv[i] + 27, NULL, 10);}
+		else if(strncmp(argv[i], "--recompute_queue_size=", 23) == 0){argv_recompute_queue_size = (int32_t) strtol(argv[i] + 23, NULL, 10);}
+		else if(strncmp(argv[i], "--schedule_largest_first=", 25) == 0){argv_schedule_largest_first = (uint8_t) strtol(argv[i] + 25, NULL, 10);}
 		else if(strncmp(argv[i], "--jsonl_content_key=", 20) == 0){argv_jsonl_content_key = argv[i] + 20;}
 		else if(strncmp(argv[i], "--input_path=", 13) == 0){argv_input_path = argv[i] + 13;}
 		else if(strncmp(argv[i], "--input_path_tp=", 16) == 0){argv_input_path_tp = argv[i] + 16;}
+		else if(strncmp(argv[i], "--batch_path=", 13) == 0){argv_batch_path = argv[i] + 13;}
 		else if(strncmp(argv[i], "--output_path=", 14) == 0){argv_output_path = argv[i] + 14;}
 		else if(strncmp(argv[i], "--output_path_timing=", 21) == 0){argv_output_path_timing = argv[i] + 21;}
 		else if(strncmp(argv[i], "--output_path_memory=", 21) == 0){argv_output_path_memory = argv[i] + 21;}
+		else if(strncmp(argv[i], "--output_format=", 16) == 0){
+			if(strcmp(argv[i] + 16, "tsv") == 0){argv_output_format = OUTPUT_FORMAT_TSV;}
+			else if(strcmp(argv[i] + 16, "columnar") == 0){argv_output_format = OUTPUT_FORMAT_COLUMNAR;}
+			else {fprintf(stderr, "Unknown output_format: %s\n", argv[i] + 16); return 1;}
+		}
+		else if(strncmp(argv[i], "--output_compression=", 21) == 0){argv_output_compression = (argv[i][21] == '1');}
+		else if(strncmp(argv[i], "--output_row_group_size=", 24) == 0){argv_output_row_group_size = (uint32_t) strtoul(argv[i] + 24, NULL, 10);}
+		else if(strncmp(argv[i], "--trace_path=", 13) == 0){argv_trace_path = argv[i] + 13;}
+		else if(strncmp(argv[i], "--enable_hardware_counters=", 27) == 0){argv_enable_hardware_counters = (argv[i][27] == '1');}
+		else if(strncmp(argv[i], "--checkpoint_path=", 18) == 0){argv_checkpoint_path = argv[i] + 18;}
+		else if(strncmp(argv[i], "--checkpoint_interval=", 22) == 0){argv_checkpoint_interval = strtod(argv[i] + 22, NULL);}
+		else if(strncmp(argv[i], "--resume=", 9) == 0){argv_resume = (argv[i][9] == '1');}
+		else if(strncmp(argv[i], "--shard_output_path=", 20) == 0){argv_shard_output_path = argv[i] + 20;}
+		else if(strncmp(argv[i], "--shard_input_path=", 19) == 0){argv_shard_input_path = argv[i] + 19;}
+		else if(strncmp(argv[i], "--serve=", 8) == 0){argv_serve_path = argv[i] + 8;}
+		else if(strncmp(argv[i], "--serve_num_jobs=", 17) == 0){argv_serve_num_jobs = (int32_t) strtol(argv[i] + 17, NULL, 10);}
+		else if(strncmp(argv[i], "--serve_queue_size=", 19) == 0){argv_serve_queue_size = (int32_t) strtol(argv[i] + 19, NULL, 10);}
 		else if(strncmp(argv[i], "--udpipe_model_path=", 20) == 0){argv_udpipe_model_path = argv[i] + 20;}
 		else if(strncmp(argv[i], "--enable_multithreaded_matrix_generation=", 41) == 0){argv_enable_multithreaded_matrix_generation = (argv[i][41] == '1');}
 		else if(strncmp(argv[i], "--enable_timings=", 17) == 0){argv_enable_timings = (argv[i][17] == '1');}
@@ -672,6 +276,12 @@ int32_t main(int32_t argc, char** argv){
 		else if(strncmp(argv[i], "--enable_document_count_recompute_step=", 39) == 0){argv_enable_document_count_recompute_step = (argv[i][39] == '1');}
 		else if(strncmp(argv[i], "--sentence_recompute_step_use_log10=", 36) == 0){argv_sentence_recompute_step_use_log10 = (argv[i][36] == '1');}
 		else if(strncmp(argv[i], "--document_recompute_step_use_log10=", 36) == 0){argv_document_recompute_step_use_log10 = (argv[i][36] == '1');}
+		else if(strncmp(argv[i], "--sentence_recompute_step_use_adaptive=", 39) == 0){argv_sentence_recompute_step_use_adaptive = (argv[i][39] == '1');}
+		else if(strncmp(argv[i], "--document_recompute_step_use_adaptive=", 39) == 0){argv_document_recompute_step_use_adaptive = (argv[i][39] == '1');}
+		else if(strncmp(argv[i], "--adaptive_recompute_compute_fraction=", 38) == 0){argv_adaptive_recompute_compute_fraction = strtod(argv[i] + 38, NULL);}
+		else if(strncmp(argv[i], "--adaptive_recompute_min_step=", 30) == 0){argv_adaptive_recompute_min_step = strtoul(argv[i] + 30, NULL, 10);}
+		else if(strncmp(argv[i], "--adaptive_recompute_max_step=", 30) == 0){argv_adaptive_recompute_max_step = strtoul(argv[i] + 30, NULL, 10);}
+		else if(strncmp(argv[i], "--adaptive_recompute_deterministic=", 35) == 0){argv_adaptive_recompute_deterministic = (argv[i][35] == '1');}
 		else if(strncmp(argv[i], "--enable_output_timing=", 23) == 0){argv_enable_output_timing = (argv[i][23] == '1');}
 		else if(strncmp(argv[i], "--enable_output_memory=", 23) == 0){argv_enable_output_memory = (argv[i][23] == '1');}
 		else if(strncmp(argv[i], "--enable_token_utf8_normalisation=", 34) == 0){argv_enable_token_utf8_normalisation = (argv[i][34] == '1');}
@@ -732,6 +342,7 @@ int32_t main(int32_t argc, char** argv){
 		else if(strncmp(argv[i], "--document_count_recompute_step=", 32) == 0){argv_document_count_recompute_step = strtol(argv[i] + 32, NULL, 10);}
 		else if(strncmp(argv[i], "--document_count_recompute_step_log10=", 38) == 0){argv_document_count_recompute_step_log10 = strtod(argv[i] + 38, NULL);}
 		else if(strncmp(argv[i], "--force_timing_and_memory_to_output_path=", 41) == 0){argv_force_timing_and_memory_to_output_path = (argv[i][41] == '1');}
+		else if(strncmp(argv[i], "--oov_memory_cap=", 17) == 0){argv_oov_memory_cap = (size_t) strtoull(argv[i] + 17, NULL, 10);}
 		// else if(strncmp(argv[i], "--tokenization_method=", 22) == 0){argv_tokenization_method = strtol(argv[i] + 22, NULL, 10);}
 		else {fprintf(stderr, "Unknown argument: %s\n", argv[i]); return 1;}
 	}
@@ -810,10 +421,24 @@ int32_t main(int32_t argc, char** argv){
 	printf("jsonl_content_key: %s\n", argv_jsonl_content_key);
 	printf("input_path: %s\n", argv_input_path);
 	if(argv_input_path_tp != NULL){printf("input_path_tp: %s\n", argv_input_path_tp);}
+	printf("batch_path: %s\n", argv_batch_path);
 	printf("output_path: %s\n", argv_output_path);
 	printf("force_timing_and_memory_to_output_path: %u\n", argv_force_timing_and_memory_to_output_path);
 	printf("output_path_timing: %s\n", argv_output_path_timing);
 	printf("output_path_memory: %s\n", argv_output_path_memory);
+	printf("output_format: %s\n", argv_output_format == OUTPUT_FORMAT_COLUMNAR ? "columnar" : "tsv");
+	printf("output_compression: %u\n", argv_output_compression);
+	printf("output_row_group_size: %u\n", argv_output_row_group_size);
+	printf("trace_path: %s\n", argv_trace_path);
+	printf("enable_hardware_counters: %u\n", argv_enable_hardware_counters);
+	printf("checkpoint_path: %s\n", argv_checkpoint_path);
+	printf("checkpoint_interval: %f\n", argv_checkpoint_interval);
+	printf("resume: %u\n", argv_resume);
+	printf("shard_output_path: %s\n", argv_shard_output_path);
+	printf("shard_input_path: %s\n", argv_shard_input_path);
+	printf("serve: %s\n", argv_serve_path);
+	printf("serve_num_jobs: %i\n", argv_serve_num_jobs);
+	printf("serve_queue_size: %i\n", argv_serve_queue_size);
 	#if TOKENIZATION_METHOD == 2
 	printf("udpipe_model_path: %s\n", argv_udpipe_model_path);
 	#endif
@@ -823,6 +448,8 @@ int32_t main(int32_t argc, char** argv){
 	printf("num_row_threads: %i\n", argv_num_row_threads);
 	printf("num_matrix_threads: %i\n", argv_num_matrix_threads);
 	printf("num_file_reading_threads: %i\n", argv_num_file_reading_threads);
+	printf("recompute_queue_size: %i\n", argv_recompute_queue_size);
+	printf("schedule_largest_first: %u\n", argv_schedule_largest_first);
 
 	printf("enable_multithreaded_matrix_generation: %u\n", argv_enable_multithreaded_matrix_generation);
 	printf("enable_timings: %u\n", argv_enable_timings);
@@ -838,8 +465,15 @@ int32_t main(int32_t argc, char** argv){
 	printf("enable_document_count_recompute_step: %u\n", argv_enable_document_count_recompute_step);
 	printf("document_recompute_step_use_log10: %u\n", argv_document_recompute_step_use_log10);
 	printf("document_count_recompute_step_log10: %f\n", argv_document_count_recompute_step_log10);
+	printf("sentence_recompute_step_use_adaptive: %u\n", argv_sentence_recompute_step_use_adaptive);
+	printf("document_recompute_step_use_adaptive: %u\n", argv_document_recompute_step_use_adaptive);
+	printf("adaptive_recompute_compute_fraction: %f\n", argv_adaptive_recompute_compute_fraction);
+	printf("adaptive_recompute_min_step: %lu\n", argv_adaptive_recompute_min_step);
+	printf("adaptive_recompute_max_step: %lu\n", argv_adaptive_recompute_max_step);
+	printf("adaptive_recompute_deterministic: %u\n", argv_adaptive_recompute_deterministic);
 	printf("enable_output_timing: %u\n", argv_enable_output_timing);
 	printf("enable_output_memory: %u\n", argv_enable_output_memory);
+	printf("oov_memory_cap: %zu\n", argv_oov_memory_cap);
 
 	printf("enable_stirling: %u\n", argv_enable_stirling);
 	printf("enable_ricotta_szeidl: %u\n", argv_enable_ricotta_szeidl);
@@ -899,7 +533,7 @@ int32_t main(int32_t argc, char** argv){
 	#if TOKENIZATION_METHOD == 2
 	ensure_proper_udpipe_pipeline_size();
 	#elif TOKENIZATION_METHOD == 1
-	jsonl_init_tokenization();
+	jsonl_init_tokenization(argv_num_file_reading_threads);
 	#endif
 
     #if ENABLE_FILTER == 1
@@ -919,6 +553,10 @@ int32_t main(int32_t argc, char** argv){
 	udpipe_pipeline_create_global(argv_udpipe_model_path, "tokenizer", "none", "none", "vertical"); // unsure about "none" for parser
 	#endif
 	// udpipe_pipeline_print_global_info();
+	if(udpipe_pool_create_global(argv_udpipe_model_path, argv_num_file_reading_threads) != 0){
+		perror("failed to call udpipe_pool_create_global\n");
+		return 1;
+	}
 	#endif
 
     struct measurement_configuration mcfg = {
@@ -986,13 +624,17 @@ int32_t main(int32_t argc, char** argv){
         	.jsonl_content_key = argv_jsonl_content_key,
         	.input_path = argv_input_path,
         	.input_path_tp = argv_input_path_tp,
+        	.batch_path = argv_batch_path,
         	.output_path = argv_output_path,
         	.output_path_timing = argv_output_path_timing,
         	.output_path_memory = argv_output_path_memory,
         	.udpipe_model_path = argv_udpipe_model_path,
-            .f_ptr = NULL,
-            .f_timing_ptr = NULL,
-            .f_memory_ptr = NULL,
+            .output = NULL,
+            .output_timing = NULL,
+            .output_memory = NULL,
+            .output_format = argv_output_format,
+            .output_compression = argv_output_compression,
+            .output_row_group_size = argv_output_row_group_size,
         	.enable_timings = argv_enable_timings,
         	.enable_output_timing = argv_enable_output_timing,
         	.enable_output_memory = argv_enable_output_memory,
@@ -1007,24 +649,67 @@ int32_t main(int32_t argc, char** argv){
         	.enable_multithreaded_row_generation = argv_enable_multithreaded_row_generation,
         	.row_generation_batch_size = argv_row_generation_batch_size,
             .enable_sw_e_prime_camargo1993_multithreading = argv_enable_sw_e_prime_camargo1993_multithreading,
+            .recompute_queue_size = argv_recompute_queue_size,
+            .schedule_largest_first = argv_schedule_largest_first,
         },
         .steps = (struct measurement_step_parameters) {
             .sentence = (struct measurement_step) {
-                .enable_count_recompute_step = argv_enable_sentence_count_recompute_step,
+                .enable_count_recompute_step = argv_enable_sentence_count_recompute_step && argv_shard_output_path[0] == '\0', // an ingest-only run has no step
                 .use_log10 = argv_sentence_recompute_step_use_log10,
+                .use_adaptive = argv_sentence_recompute_step_use_adaptive,
                 .recompute_step = argv_sentence_count_recompute_step,
                 .recompute_step_log10 = argv_sentence_count_recompute_step_log10,
             },
             .document = (struct measurement_step) {
-                .enable_count_recompute_step = argv_enable_document_count_recompute_step,
+                .enable_count_recompute_step = argv_enable_document_count_recompute_step && argv_shard_output_path[0] == '\0',
                 .use_log10 = argv_document_recompute_step_use_log10,
+                .use_adaptive = argv_document_recompute_step_use_adaptive,
                 .recompute_step = argv_document_count_recompute_step,
                 .recompute_step_log10 = argv_document_count_recompute_step_log10,
             },
+            .adaptive = (struct measurement_adaptive_step) {
+                .compute_fraction = argv_adaptive_recompute_compute_fraction,
+                .min_step = argv_adaptive_recompute_min_step,
+                .max_step = argv_adaptive_recompute_max_step,
+                .deterministic = argv_adaptive_recompute_deterministic,
+            },
+        },
+        .oov_memory_cap = argv_oov_memory_cap,
+        .checkpoint = (struct measurement_checkpoint) {
+            .path = argv_checkpoint_path,
+            .interval = argv_checkpoint_interval,
+            .resume = argv_resume,
+        },
+        .shard = (struct measurement_shard) {
+            .output_path = argv_shard_output_path,
+            .input_path = argv_shard_input_path,
+        },
+        .serve = (struct measurement_serve) {
+            .path = argv_serve_path,
+            .num_jobs = argv_serve_num_jobs,
+            .queue_size = argv_serve_queue_size,
         },
     };
 
+    // spans are only recorded when a trace is requested
+    if(argv_trace_path[0] != '\0' && instrument_init(argv_enable_hardware_counters) != 0){
+        perror("failed to call instrument_init\n");
+        return 1;
+    }
+
     err = measurement(&mcfg);
+
+    if(argv_trace_path[0] != '\0'){
+        if(argv_enable_hardware_counters && !instrument_counters_available()){
+            info_format(__FILE__, __func__, __LINE__, "hardware counters unavailable; the trace has no cycles nor llc_misses");
+        }
+        if(instrument_export_chrome_trace(argv_trace_path) != 0){
+            perror("failed to call instrument_export_chrome_trace\n");
+            err = 1;
+        }
+        instrument_free();
+    }
+
 	if(err != 0){
 		perror("failed to call measurement\n");
 		if(argv_force_timing_and_memory_to_output_path){
@@ -1043,6 +728,12 @@ int32_t main(int32_t argc, char** argv){
     filter_release();
     #endif
 
+	#if TOKENIZATION_METHOD == 2
+	udpipe_pool_free_global();
+	#elif TOKENIZATION_METHOD == 1
+	jsonl_free_tokenization();
+	#endif
+
 	return 0;
 
 	malloc_fail:
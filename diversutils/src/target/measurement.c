@@ -44,28 +44,18 @@
 #include "dfunctions.h"
 #include "distributions.h"
 #include "graph.h"
+#include "instrument.h"
 #include "measurement.h"
-#include "sorted_array/array.h"
+#include "oov/counter.h"
 #include "logging.h"
+#include "schedule.h"
+#include "shard.h"
+#include "snapshot.h"
 #include "stats.h"
 
+// time since the previous call on the same thread, so that worker threads do not skew each other's timings
 int32_t time_ns_delta(int64_t* const delta){
-	static struct timespec static_ts = {0};
-
-	struct timespec new_ts;
-
-	if(clock_gettime(CLOCK_MONOTONIC, &new_ts) != 0){
-		perror("Failed to call clock_gettime\n");
-		return 1;
-	}
-
-	if(delta != NULL){
-		(*delta) = (new_ts.tv_sec - static_ts.tv_sec) * 1000000000 + (new_ts.tv_nsec - static_ts.tv_nsec);
-	}
-
-	static_ts = new_ts;
-
-	return 0;
+	return instrument_lap_ns(delta);
 }
 
 int32_t virtual_memory_consumption(int64_t* const res){
@@ -105,100 +95,100 @@ int32_t virtual_memory_consumption(int64_t* const res){
 	return 0;
 }
 
-void timing_and_memory(FILE* f_timing_ptr, FILE* f_memory_ptr, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+void timing_and_memory(struct output_stream* const output_timing, struct output_stream* const output_memory, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	int64_t ns_delta, virtual_mem;
-	if(enable_output_timing){if(time_ns_delta(&ns_delta) != 0){perror("Failed to call time_ns_delta\n"); exit(1);} else {fprintf(f_timing_ptr, "\t%li", ns_delta);}}
-	if(enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){perror("Failed to call virtual_memory_consumption\n"); exit(1);} else {fprintf(f_memory_ptr, "\t%li", virtual_mem);}}
+	if(enable_output_timing){if(time_ns_delta(&ns_delta) != 0){perror("Failed to call time_ns_delta\n"); exit(1);} else {output_int(output_timing, ns_delta);}}
+	if(enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){perror("Failed to call virtual_memory_consumption\n"); exit(1);} else {output_int(output_memory, virtual_mem);}}
 }
 
-int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+int32_t wrap_diversity_1r_0a(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	double res1;
-	time_t t, delta_t;
-	const int32_t bfr_size = 64;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
 	char bfr[bfr_size];
-	t = time(NULL);
+	instrument_span_begin(&span, name);
 	if(df(g, &res1, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_1r_0a\n"); return EXIT_FAILURE;}
-	delta_t = time(NULL) - t;
+	const int64_t delta_ns = instrument_span_end(&span);
 	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
 	memset(bfr, '\0', bfr_size * sizeof(char));
-	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
 	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
-	fprintf(f_ptr, "\t%.10e", res1);
-	timing_and_memory(f_timing_ptr, f_memory_ptr, enable_output_timing, enable_output_memory);
+	output_double(output, res1);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
 	return 0;
 }
 
-int32_t wrap_diversity_1r_0a_no_matrix(struct graph* const g, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, const int8_t), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+int32_t wrap_diversity_1r_0a_no_matrix(const char* const name, struct graph* const g, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, const int8_t), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	double res1;
-	time_t t, delta_t;
-	const int32_t bfr_size = 64;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
 	char bfr[bfr_size];
-	t = time(NULL);
+	instrument_span_begin(&span, name);
 	if(df(g, &res1, fp_mode) != 0){perror("Failed to call diversity function in wrap_diversity_1r_0a\n"); return EXIT_FAILURE;}
-	delta_t = time(NULL) - t;
+	const int64_t delta_ns = instrument_span_end(&span);
 	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
 	memset(bfr, '\0', bfr_size * sizeof(char));
-	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
 	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
-	fprintf(f_ptr, "\t%.10e", res1);
-	timing_and_memory(f_timing_ptr, f_memory_ptr, enable_output_timing, enable_output_memory);
+	output_double(output, res1);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
 	return 0;
 }
 
-int32_t wrap_diversity_2r_1a(struct graph* const g, struct matrix* const m, const double alpha, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, double* const, double, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+int32_t wrap_diversity_2r_1a(const char* const name, struct graph* const g, struct matrix* const m, const double alpha, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, double* const, double, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	double res1, res2;
-	time_t t, delta_t;
-	const int32_t bfr_size = 64;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
 	char bfr[bfr_size];
-	t = time(NULL);
+	instrument_span_begin(&span, name);
 	if(df(g, &res1, &res2, alpha, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_2r_1a\n"); return EXIT_FAILURE;}
-	delta_t = time(NULL) - t;
+	const int64_t delta_ns = instrument_span_end(&span);
 	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
 	memset(bfr, '\0', bfr_size * sizeof(char));
-	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
 	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
-	fprintf(f_ptr, "\t%.10e\t%.10e", res1, res2);
-	timing_and_memory(f_timing_ptr, f_memory_ptr, enable_output_timing, enable_output_memory);
+	output_double(output, res1); output_double(output, res2);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
 	return 0;
 }
 
-int32_t wrap_diversity_2r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+int32_t wrap_diversity_2r_0a(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	double res1, res2;
-	time_t t, delta_t;
-	const int32_t bfr_size = 64;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
 	char bfr[bfr_size];
-	t = time(NULL);
+	instrument_span_begin(&span, name);
 	if(df(g, &res1, &res2, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_2r_0a\n"); return EXIT_FAILURE;}
-	delta_t = time(NULL) - t;
+	const int64_t delta_ns = instrument_span_end(&span);
 	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
 	memset(bfr, '\0', bfr_size * sizeof(char));
-	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
 	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
-	fprintf(f_ptr, "\t%.10e\t%.10e", res1, res2);
-	timing_and_memory(f_timing_ptr, f_memory_ptr, enable_output_timing, enable_output_memory);
+	output_double(output, res1); output_double(output, res2);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
 	return 0;
 }
 
-int32_t wrap_diversity_2r_0a_long_double_alt(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double* const, long double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+int32_t wrap_diversity_2r_0a_long_double_alt(const char* const name, struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double* const, long double* const, const int8_t, const struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	double res1;
 	long double res2;
-	time_t t, delta_t;
-	const int32_t bfr_size = 64;
+	struct instrument_scope span;
+	const int32_t bfr_size = 128;
 	char bfr[bfr_size];
-	t = time(NULL);
+	instrument_span_begin(&span, name);
 	if(df(g, &res1, &res2, fp_mode, m) != 0){perror("Failed to call diversity function in wrap_diversity_2r_0a\n"); return EXIT_FAILURE;}
-	delta_t = time(NULL) - t;
+	const int64_t delta_ns = instrument_span_end(&span);
 	// if(enable_timings){printf("[log] [time] Computed df in %lis\n", delta_t);}
 	memset(bfr, '\0', bfr_size * sizeof(char));
-	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
+	snprintf(bfr, bfr_size, "Computed %s in %.9fs", name, ((double) delta_ns) * 1e-9);
 	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
-	fprintf(f_ptr, "\t%.10e\t%.10Le", res1, res2);
-	timing_and_memory(f_timing_ptr, f_memory_ptr, enable_output_timing, enable_output_memory);
+	output_double(output, res1); output_long_double(output, res2);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
 	return 0;
 }
 
 /*
-int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, FILE* f_ptr, FILE* f_timing_ptr, FILE* f_memory_ptr, int32_t (*df)(struct graph* const, double*, const int8_t, struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
+int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, const int8_t fp_mode, struct output_stream* const output, struct output_stream* const output_timing, struct output_stream* const output_memory, int32_t (*df)(struct graph* const, double*, const int8_t, struct matrix* const), const uint8_t enable_timings, const uint8_t enable_output_timing, const uint8_t enable_output_memory){
 	double res1;
 	time_t t, delta_t;
 	const int32_t bfr_size = 64;
@@ -210,16 +200,76 @@ int32_t wrap_diversity_1r_0a(struct graph* const g, struct matrix* const m, cons
 	memset(bfr, '\0', bfr_size * sizeof(char));
 	snprintf(bfr, bfr_size, "Computed df in %lis", delta_t);
 	if(enable_timings){info_format(__FILE__, __func__, __LINE__, bfr);}
-	fprintf(f_ptr, "\t%.10e", res1);
-	timing_and_memory(f_timing_ptr, f_memory_ptr, enable_output_timing, enable_output_memory);
+	output_double(output, res1);
+	timing_and_memory(output_timing, output_memory, enable_output_timing, enable_output_memory);
 	return 0;
 }
 */
 
+// requests the primitives of every enabled non-disparity function, so that those shared by several of them are computed once per step
+static void measurement_request_dfunctions_memo(const struct measurement_configuration * const mcfg, struct graph * const g){
+	const struct {uint8_t enabled; uint32_t needs;} table[] = {
+		#if ENABLE_NON_DISPARITY_MULTITHREADING != 1
+		{mcfg->enable.shannon_weaver_entropy, DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY},
+		#endif
+		{mcfg->enable.simpson_index, DFUNCTIONS_NEEDS_SIMPSON_INDEX},
+		{mcfg->enable.simpson_dominance_index, DFUNCTIONS_NEEDS_SIMPSON_DOMINANCE_INDEX},
+		{mcfg->enable.berger_parker_index, DFUNCTIONS_NEEDS_BERGER_PARKER_INDEX},
+		{mcfg->enable.junge1994_page22, DFUNCTIONS_NEEDS_JUNGE1994_PAGE22},
+		{mcfg->enable.mcintosh_index, DFUNCTIONS_NEEDS_MCINTOSH_INDEX},
+		{mcfg->enable.sw_entropy_over_log_n_species_pielou1975, DFUNCTIONS_NEEDS_SW_ENTROPY_OVER_LOG_N_SPECIES_PIELOU1975},
+		{mcfg->enable.sw_e_heip, DFUNCTIONS_NEEDS_SW_E_HEIP},
+		{mcfg->enable.sw_e_one_minus_d, DFUNCTIONS_NEEDS_SW_E_ONE_MINUS_D},
+		{mcfg->enable.sw_e_one_over_ln_d_williams1964, DFUNCTIONS_NEEDS_SW_E_ONE_OVER_D_WILLIAMS1964},
+		{mcfg->enable.sw_e_minus_ln_d_pielou1977, DFUNCTIONS_NEEDS_SW_E_MINUS_LN_D_PIELOU1977},
+		{mcfg->enable.sw_f_2_1_alatalo1981, DFUNCTIONS_NEEDS_SW_F_2_1_ALATALO1981},
+		{mcfg->enable.sw_g_2_1_molinari1989, DFUNCTIONS_NEEDS_SW_G_2_1_MOLINARI1989},
+		{mcfg->enable.sw_e_bulla1994, DFUNCTIONS_NEEDS_SW_E_BULLA1994},
+		{mcfg->enable.sw_o_bulla1994, DFUNCTIONS_NEEDS_SW_O_BULLA1994},
+		{mcfg->enable.sw_e_mci_pielou1969, DFUNCTIONS_NEEDS_SW_E_MCI_PIELOU1969},
+		{mcfg->enable.sw_e_var_smith_and_wilson1996_original, DFUNCTIONS_NEEDS_SW_E_VAR_SMITH_AND_WILSON1996_ORIGINAL},
+	};
+	for(size_t k = 0 ; k < sizeof(table) / sizeof(table[0]) ; k++){
+		if(table[k].enabled){dfunctions_memo_request(g, table[k].needs);}
+	}
+	#if ENABLE_NON_DISPARITY_MULTITHREADING != 1
+	if(mcfg->enable.renyi_entropy){dfunctions_memo_request_order(g, mcfg->div_param.renyi_alpha);}
+	#endif
+	if(mcfg->enable.hill_number_standard){dfunctions_memo_request_order(g, mcfg->div_param.hill_number_standard_alpha);}
+	if(mcfg->enable.hill_evenness){
+		dfunctions_memo_request_order(g, mcfg->div_param.hill_evenness_alpha);
+		dfunctions_memo_request_order(g, mcfg->div_param.hill_evenness_beta);
+	}
+}
+
+// columns shared by the measurement, timing and memory files, in front of the functions
+static void measurement_output_step_columns(struct output_stream* const output, const uint64_t i, const struct measurement_configuration * const mcfg, const struct measurement_structure_references * const sref, const struct measurement_mutables * const mmut){
+	output_uint(output, i + 1);
+	output_uint(output, mmut->sentence.num_containing_mwe);
+	output_uint(output, mmut->sentence.num_containing_mwe_tp_only);
+	output_uint(output, mmut->sentence.num_all);
+	output_uint(output, mmut->document.num_all);
+	output_string(output, mcfg->io.w2v_path);
+	output_int(output, mmut->num_oov_types);
+	output_double(output, mmut->best_s);
+	output_uint(output, sref->g->num_nodes);
+}
+
 int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut){
 	const uint8_t enable_distance_computation = mcfg->enable.disparity_functions && (mcfg->enable.stirling || mcfg->enable.ricotta_szeidl || mcfg->enable.pairwise || mcfg->enable.chao_et_al_functional_diversity || mcfg->enable.scheiner_species_phylogenetic_functional_diversity || mcfg->enable.leinster_cobbold_diversity || mcfg->enable.lexicographic || mcfg->enable.functional_evenness || mcfg->enable.mst || mcfg->enable.functional_dispersion || mcfg->enable.functional_divergence_modified);
 
 	int32_t err;
+
+	// split between the disparity and non-disparity parts of the step, for the adaptive schedule
+	const int64_t schedule_start_ns = sref->schedule != NULL ? recompute_schedule_now() : 0;
+	int64_t schedule_middle_ns = 0;
+
+	// every kernel below reads the snapshot, whose proportions were refreshed by the caller for the zipfian fit; vectors are only gathered when some distance is needed
+	if(enable_distance_computation && graph_snapshot_gather_vectors(sref->g, mcfg->threading.num_matrix_threads) != 0){
+		perror("failed to call graph_snapshot_gather_vectors\n");
+		return 1;
+	}
+
 	// if(enable_iterative_distance_computation){
 	if(mcfg->threading.enable_iterative_distance_computation){
 		size_t local_malloc_size = sref->g->num_nodes * sizeof(float) * mcfg->threading.row_generation_batch_size;
@@ -382,8 +432,10 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 
 		double mu_dist = sum / ((double) (sref->g->num_nodes * (sref->g->num_nodes - 1) / 2));
 
-		// fprintf(mcfg->io.f_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu\t%.10e\t%c", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes, mu_dist, '?'); // recomputing sigma dist would be expensive // DO NOT REMOVE
-		fprintf(mcfg->io.f_ptr, "%lu\t%lu\t%lu\t%lu\t%lu\t%s\t%li\t%.10e\t%lu\t%.10e\t%c", i+1, mmut->sentence.num_containing_mwe, mmut->sentence.num_containing_mwe_tp_only, mmut->sentence.num_all, mmut->document.num_all, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes, mu_dist, '?'); // recomputing sigma dist would be expensive
+		// fprintf(mcfg->io.f_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu\t%.10e\t%c", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes, mu_dist, '?'); // recomputing sigma dist would be expensive // DO NOT REMOVE
+		measurement_output_step_columns(mcfg->io.output, i, mcfg, sref, mmut);
+		output_double(mcfg->io.output, mu_dist);
+		output_string(mcfg->io.output, "?"); // recomputing sigma dist would be expensive
 
 		/*
 		if(mcfg->enable.pairwise){printf("[log] [end iter] pairwise: %f\n", iter_state_pairwise.result); fprintf(mcfg->io.f_ptr, "\t%.10e", iter_state_pairwise.result);}
@@ -394,22 +446,22 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 		const int32_t log_bfr_size = 128;
 		char log_bfr[log_bfr_size];
 
-		if(mcfg->enable.pairwise){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] pairwise: %f", iter_state_pairwise.result); info_format(__FILE__, __func__, __LINE__, log_bfr); fprintf(mcfg->io.f_ptr, "\t%.10e", iter_state_pairwise.result);}
-		if(mcfg->enable.stirling){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] stirling: %f", iter_state_stirling.result); info_format(__FILE__, __func__, __LINE__, log_bfr); fprintf(mcfg->io.f_ptr, "\t%.10e", iter_state_stirling.result);}
-		if(mcfg->enable.leinster_cobbold_diversity){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] leinster_cobbold: %f, %f", iter_state_leinster_cobbold.entropy, iter_state_leinster_cobbold.hill_number); info_format(__FILE__, __func__, __LINE__, log_bfr); fprintf(mcfg->io.f_ptr, "\t%.10e\t%.10e", iter_state_leinster_cobbold.entropy, iter_state_leinster_cobbold.hill_number);}
+		if(mcfg->enable.pairwise){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] pairwise: %f", iter_state_pairwise.result); info_format(__FILE__, __func__, __LINE__, log_bfr); output_double(mcfg->io.output, iter_state_pairwise.result);}
+		if(mcfg->enable.stirling){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] stirling: %f", iter_state_stirling.result); info_format(__FILE__, __func__, __LINE__, log_bfr); output_double(mcfg->io.output, iter_state_stirling.result);}
+		if(mcfg->enable.leinster_cobbold_diversity){memset(log_bfr, '\0', log_bfr_size); snprintf(log_bfr, log_bfr_size, "[end iter] leinster_cobbold: %f, %f", iter_state_leinster_cobbold.entropy, iter_state_leinster_cobbold.hill_number); info_format(__FILE__, __func__, __LINE__, log_bfr); output_double(mcfg->io.output, iter_state_leinster_cobbold.entropy); output_double(mcfg->io.output, iter_state_leinster_cobbold.hill_number);}
 
-		fprintf(mcfg->io.f_ptr, "\n");
+		if(output_end_row(mcfg->io.output) != 0){goto output_end_row_failure;}
 	} else {
 		int64_t ns_delta, virtual_mem;
 
 		if(mcfg->io.enable_output_timing){
-			// fprintf(mcfg->io.f_timing_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes); // DO NOT REMOVE
-			fprintf(mcfg->io.f_timing_ptr, "%lu\t%lu\t%lu\t%lu\t%lu\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num_containing_mwe, mmut->sentence.num_containing_mwe_tp_only, mmut->sentence.num_all, mmut->document.num_all, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes);
+			// fprintf(mcfg->io.f_timing_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes); // DO NOT REMOVE
+			measurement_output_step_columns(mcfg->io.output_timing, i, mcfg, sref, mmut);
 			if(time_ns_delta(NULL) != 0){goto time_ns_delta_failure;}
 		}
 		if(mcfg->io.enable_output_memory){
-			// fprintf(mcfg->io.f_memory_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes); // DO NOT REMOVE
-			fprintf(mcfg->io.f_memory_ptr, "%lu\t%lu\t%lu\t%lu\t%lu\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num_containing_mwe, mmut->sentence.num_containing_mwe_tp_only, mmut->sentence.num_all, mmut->document.num_all, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes);
+			// fprintf(mcfg->io.f_memory_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes); // DO NOT REMOVE
+			measurement_output_step_columns(mcfg->io.output_memory, i, mcfg, sref, mmut);
 		}
 
 		struct matrix m_mst = { .fp_mode = FP64, };
@@ -420,11 +472,10 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 			}
 			memset(m_mst.active, '\0', sref->g->num_nodes * sref->g->num_nodes * sizeof(uint8_t));
 			memset(m_mst.active_final, '\0', sref->g->num_nodes * sref->g->num_nodes * sizeof(uint8_t));
-			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 		}
 
-		time_t t, delta_t;
 
 		struct matrix m = { .fp_mode = FP32, };
 		if(enable_distance_computation){
@@ -432,7 +483,8 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 				perror("failed to call create_matrix\n");
 				return 1;
 			}
-			t = time(NULL);
+			struct instrument_scope span;
+			instrument_span_begin(&span, "dist_matrix_computation");
 			if(mcfg->threading.enable_multithreaded_matrix_generation){
 				if(distance_matrix_from_graph_multithread(sref->g, &m, mcfg->threading.num_matrix_threads) != 0){
 					perror("failed to call distance_matrix_from_graph_multithread\n");
@@ -445,11 +497,11 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 					return 1;
 				}
 			}
-			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
-			delta_t = time(NULL) - t;
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
+			const int64_t delta_ns = instrument_span_end(&span);
 			if(mcfg->io.enable_timings){
-				printf("[log] [time] Computed matrix in %lis\n", delta_t);
+				printf("[log] [time] Computed matrix in %.9fs\n", ((double) delta_ns) * 1e-9);
 			}
 		}
 
@@ -477,8 +529,8 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 	
 			(*sref->heap) = local_heap;
 
-			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 
 			#if MST_SANITYT_TESTING == 1
 			printf("create_graph_distance_heap: %lis\n", ns_delta / 1000000000);
@@ -499,18 +551,21 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 					perror("unknown FP mode\n");
 					return 1;
 			}
-			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+			if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+			if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 		}
 
-		// fprintf(mcfg->io.f_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu\t%.10e\t%.10e", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes, mu_dist, sigma_dist); // DO NOT REMOVE
-		fprintf(mcfg->io.f_ptr, "%lu\t%lu\t%lu\t%lu\t%lu\t%s\t%li\t%.10e\t%lu\t%.10e\t%.10e", i+1, mmut->sentence.num_containing_mwe, mmut->sentence.num_containing_mwe_tp_only, mmut->sentence.num_all, mmut->document.num_all, mcfg->io.w2v_path, sref->sorted_array_discarded_because_not_in_vector_database->num_elements, mmut->best_s, sref->g->num_nodes, mu_dist, sigma_dist);
+		// fprintf(mcfg->io.f_ptr, "%lu\t%li\t%li\t%li\t%s\t%li\t%.10e\t%lu\t%.10e\t%.10e", i+1, mmut->sentence.num, mmut->sentence.num_all, mmut->document.num, mcfg->io.w2v_path, oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database), mmut->best_s, sref->g->num_nodes, mu_dist, sigma_dist); // DO NOT REMOVE
+		measurement_output_step_columns(mcfg->io.output, i, mcfg, sref, mmut);
+		output_double(mcfg->io.output, mu_dist);
+		output_double(mcfg->io.output, sigma_dist);
 
 		if(mcfg->enable.disparity_functions){
 			if(mcfg->io.enable_output_timing){if(time_ns_delta(NULL) != 0){goto time_ns_delta_failure;}}
 	
 			if(mcfg->enable.functional_evenness || mcfg->enable.mst){
-				t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "mst_computation");
 				struct minimum_spanning_tree local_mst;
 	
 				if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
@@ -532,12 +587,12 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 				(*sref->mst) = local_mst;
 				mmut->mst_initialised = 1;
 	
-				delta_t = time(NULL) - t;
+				const int64_t delta_ns = instrument_span_end(&span);
 				if(mcfg->io.enable_timings){
-					printf("[log] [time] Computed MST in %lis\n", delta_t);
+					printf("[log] [time] Computed MST in %.9fs\n", ((double) delta_ns) * 1e-9);
 				}
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 				#if MST_SANITY_TESTING == 1
 				printf("mst: %lis\n", ns_delta / 1000000000);
 				#endif
@@ -549,7 +604,7 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 				FILE * const f_mst = fopen("mst_output.tsv", "w");
 				if(f_mst == NULL){perror("Failed to open file for MST output\n"); return 1;}
 				fputs("a_key\tb_key\tdistance", f_mst);
-				int32_t n = sref->g->nodes[0].num_dimensions;
+				int32_t n = graph_node_at(sref->g, 0)->num_dimensions;
 				#if MST_SANITY_TESTING == 1
 				if(n > 2){n = 2;}
 				#endif
@@ -561,9 +616,9 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 					for(uint64_t b = a + 1 ; b < sref->g->num_nodes ; b++){
 						const uint8_t local_active = m_mst.active[a * m_mst.b + b];
 						if(local_active){
-							fprintf(f_mst, "%s\t%s\t%f", sref->g->nodes[a].word2vec_entry_pointer->key, sref->g->nodes[b].word2vec_entry_pointer->key, m.bfr.fp32[a * m.b + b]);
-							for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\t%f", sref->g->nodes[a].word2vec_entry_pointer->vector[d]);}
-							for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\t%f", sref->g->nodes[b].word2vec_entry_pointer->vector[d]);}
+							fprintf(f_mst, "%s\t%s\t%f", graph_node_at(sref->g, a)->word2vec_entry_pointer->key, graph_node_at(sref->g, b)->word2vec_entry_pointer->key, m.bfr.fp32[a * m.b + b]);
+							for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\t%f", graph_node_at(sref->g, a)->word2vec_entry_pointer->vector[d]);}
+							for(int32_t d = 0 ; d < n ; d++){fprintf(f_mst, "\t%f", graph_node_at(sref->g, b)->word2vec_entry_pointer->vector[d]);}
 							fputc('\n', f_mst);
 						}
 					}
@@ -579,59 +634,61 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 	
 			if(mcfg->enable.stirling){
 				double stirling;
-				t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "stirling");
 				if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
 				err = stirling_from_graph(sref->g, &stirling, mcfg->div_param.stirling_alpha, mcfg->div_param.stirling_beta, GRAPH_NODE_FP32, &m);
 				if(err != 0){
 					perror("failed to call stirling_from_graph\n");
 					return EXIT_FAILURE;
 				}
-				delta_t = time(NULL) - t;
+				const int64_t delta_ns = instrument_span_end(&span);
 				if(mcfg->io.enable_timings){
-					printf("[log] [time] Computed Stirling in %lis\n", delta_t);
+					printf("[log] [time] Computed Stirling in %.9fs\n", ((double) delta_ns) * 1e-9);
 				}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", stirling);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				output_double(mcfg->io.output, stirling);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 	
 			if(mcfg->enable.ricotta_szeidl){
 				double ricotta_szeidl;
-				t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "ricotta_szeidl");
 				if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
 				err = ricotta_szeidl_from_graph(sref->g, &ricotta_szeidl, mcfg->div_param.ricotta_szeidl_alpha, GRAPH_NODE_FP32, &m);
 				if(err != 0){
 					perror("failed to call ricotta_szeidl_from_graph\n");
 					return EXIT_FAILURE;
 				}
-				delta_t = time(NULL) - t;
+				const int64_t delta_ns = instrument_span_end(&span);
 				if(mcfg->io.enable_timings){
-					printf("[log] [time] Computed Ricotta-Szeidl in %lis\n", delta_t);
+					printf("[log] [time] Computed Ricotta-Szeidl in %.9fs\n", ((double) delta_ns) * 1e-9);
 				}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", ricotta_szeidl);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				output_double(mcfg->io.output, ricotta_szeidl);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 	
 			if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;}
 			if(mcfg->enable.pairwise){
-				if(wrap_diversity_1r_0a(sref->g, &m, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, pairwise_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_1r_0a("pairwise", sref->g, &m, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, pairwise_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 	
 			if(mcfg->enable.chao_et_al_functional_diversity){
-				if(wrap_diversity_2r_1a(sref->g, &m, mcfg->div_param.chao_et_al_functional_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, chao_et_al_functional_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_2r_1a("chao_et_al_functional_diversity", sref->g, &m, mcfg->div_param.chao_et_al_functional_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, chao_et_al_functional_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 	
 			if(mcfg->enable.scheiner_species_phylogenetic_functional_diversity){
-				if(wrap_diversity_2r_1a(sref->g, &m, mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, scheiner_species_phylogenetic_functional_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_2r_1a("scheiner_species_phylogenetic_functional_diversity", sref->g, &m, mcfg->div_param.scheiner_species_phylogenetic_functional_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, scheiner_species_phylogenetic_functional_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 	
 			if(mcfg->enable.leinster_cobbold_diversity){
-				if(wrap_diversity_2r_1a(sref->g, &m, mcfg->div_param.leinster_cobbold_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, leinster_cobbold_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_2r_1a("leinster_cobbold_diversity", sref->g, &m, mcfg->div_param.leinster_cobbold_diversity_alpha, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, leinster_cobbold_diversity_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 	
 			if(mcfg->enable.lexicographic){
-				if(wrap_diversity_2r_0a_long_double_alt(sref->g, &m, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, lexicographic_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_2r_0a_long_double_alt("lexicographic", sref->g, &m, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, lexicographic_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 	
 			if(mcfg->enable.functional_evenness){
@@ -640,18 +697,19 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 					return 1;
 				}
 				double functional_evenness;
-				t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "functional_evenness");
 				err = functional_evenness_from_minimum_spanning_tree(sref->mst, &functional_evenness);
 				if(err != 0){
 					perror("failed to call functional_evenness_from_minimum_spanning_tree\n");
 					return EXIT_FAILURE;
 				}
-				delta_t = time(NULL) - t;
+				const int64_t delta_ns = instrument_span_end(&span);
 				if(mcfg->io.enable_timings){
-					printf("[log] [time] Computed FEve in %lis\n", delta_t);
+					printf("[log] [time] Computed FEve in %.9fs\n", ((double) delta_ns) * 1e-9);
 				}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", functional_evenness);
-				timing_and_memory(mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory);
+				output_double(mcfg->io.output, functional_evenness);
+				timing_and_memory(mcfg->io.output_timing, mcfg->io.output_memory, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory);
 			}
 	
 			if(mcfg->enable.mst){
@@ -660,39 +718,52 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 					return 1;
 				}
 				double mst_agg;
-				t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "mst");
 				err = agg_mst_from_minimum_spanning_tree(sref->mst, &mst_agg);
 				if(err != 0){
 					perror("failed to call agg_mst_from_minimum_spanning_tree\n");
 					return EXIT_FAILURE;
 				}
-				delta_t = time(NULL) - t;
+				const int64_t delta_ns = instrument_span_end(&span);
 				if(mcfg->io.enable_timings){
-					printf("[log] [time] Computed MST (agg) in %lis\n", delta_t);
+					printf("[log] [time] Computed MST (agg) in %.9fs\n", ((double) delta_ns) * 1e-9);
 				}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", mst_agg);
-				timing_and_memory(mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory);
+				output_double(mcfg->io.output, mst_agg);
+				timing_and_memory(mcfg->io.output_timing, mcfg->io.output_memory, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory);
 			}
 	
 			if(mcfg->enable.functional_dispersion){
-				if(wrap_diversity_1r_0a_no_matrix(sref->g, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, functional_dispersion_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_1r_0a_no_matrix("functional_dispersion", sref->g, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, functional_dispersion_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 	
 			if(mcfg->enable.functional_divergence_modified){
-				if(wrap_diversity_1r_0a_no_matrix(sref->g, GRAPH_NODE_FP32, mcfg->io.f_ptr, mcfg->io.f_timing_ptr, mcfg->io.f_memory_ptr, functional_divergence_modified_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
+				if(wrap_diversity_1r_0a_no_matrix("functional_divergence_modified", sref->g, GRAPH_NODE_FP32, mcfg->io.output, mcfg->io.output_timing, mcfg->io.output_memory, functional_divergence_modified_from_graph, mcfg->io.enable_timings, mcfg->io.enable_output_timing, mcfg->io.enable_output_memory) != 0){return 1;}
 			}
 		}
 
+		if(sref->schedule != NULL){schedule_middle_ns = recompute_schedule_now();}
+
 		if(mcfg->enable.non_disparity_functions){
             struct cpu_info local_cpu_info = {0};
             if(get_cpu_info(&local_cpu_info) != 0){
                 perror("Failed to call get_cpu_info\n");
                 return 1;
             }
+			measurement_request_dfunctions_memo(mcfg, sref->g);
+			struct instrument_scope memo_span;
+			instrument_span_begin(&memo_span, "dfunctions_memo");
+			const int32_t memo_status = dfunctions_memo_compute(sref->g, (int16_t) local_cpu_info.cardinality_virtual_cores);
+			instrument_span_end(&memo_span);
+			if(memo_status != 0){
+				perror("Failed to call dfunctions_memo_compute\n");
+				return 1;
+			}
 			if(mcfg->enable.shannon_weaver_entropy){
 				double res_entropy;
 				double res_hill_number;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "shannon_weaver_entropy");
 
                 #if ENABLE_NON_DISPARITY_MULTITHREADING == 1
                 if(non_disparity_multithread(
@@ -715,15 +786,16 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 				shannon_weaver_entropy_from_graph(sref->g, &res_entropy, &res_hill_number);
                 #endif
 
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed SW entropy in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e\t%.10e", res_entropy, res_hill_number);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed SW entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.good_entropy){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "good_entropy");
 
                 #if ENABLE_NON_DISPARITY_MULTITHREADING == 1
                 if(non_disparity_multithread(
@@ -745,16 +817,17 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 				good_entropy_from_graph(sref->g, &res, mcfg->div_param.good_alpha, mcfg->div_param.good_beta);
                 #endif
 
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Good entropy in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Good entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.renyi_entropy){
 				double res_entropy;
 				double res_hill_number;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "renyi_entropy");
 
                 #if ENABLE_NON_DISPARITY_MULTITHREADING == 1
                 if(non_disparity_multithread(
@@ -777,251 +850,279 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 				renyi_entropy_from_graph(sref->g, &res_entropy, &res_hill_number, mcfg->div_param.renyi_alpha);
                 #endif
 
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Renyi entropy in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e\t%.10e", res_entropy, res_hill_number);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Renyi entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.patil_taillie_entropy){
 				double res_entropy;
 				double res_hill_number;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "patil_taillie_entropy");
 				patil_taillie_entropy_from_graph(sref->g, &res_entropy, &res_hill_number, mcfg->div_param.patil_taillie_alpha);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Patil-Taillie entropy in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e\t%.10e", res_entropy, res_hill_number);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Patil-Taillie entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.q_logarithmic_entropy){
 				double res_entropy;
 				double res_hill_number;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "q_logarithmic_entropy");
 				q_logarithmic_entropy_from_graph(sref->g, &res_entropy, &res_hill_number, mcfg->div_param.q_logarithmic_q);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed q-logarithmic entropy in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e\t%.10e", res_entropy, res_hill_number);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed q-logarithmic entropy in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res_entropy); output_double(mcfg->io.output, res_hill_number);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.simpson_index){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "simpson_index");
 				simpson_index_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Simpson index in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Simpson index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.simpson_dominance_index){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "simpson_dominance_index");
 				simpson_dominance_index_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Simpson dominance index in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Simpson dominance index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.hill_number_standard){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "hill_number_standard");
 				hill_number_standard_from_graph(sref->g, &res, mcfg->div_param.hill_number_standard_alpha);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Hill number (standard) in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Hill number (standard) in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.hill_evenness){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "hill_evenness");
 				hill_evenness_from_graph(sref->g, &res, mcfg->div_param.hill_evenness_alpha, mcfg->div_param.hill_evenness_beta);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Hill evenness in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Hill evenness in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.berger_parker_index){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "berger_parker_index");
 				berger_parker_index_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Berger Parker index in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Berger Parker index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.junge1994_page22){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "junge1994_page22");
 				junge1994_page22_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Junge 1994 p22 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Junge 1994 p22 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.brillouin_diversity){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "brillouin_diversity");
 				brillouin_diversity_from_graph(sref->g, &res);
 				// printf("res: %f\n", res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed Brillouin diversity in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed Brillouin diversity in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.mcintosh_index){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "mcintosh_index");
 				mcintosh_index_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed McIntosh index in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed McIntosh index in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_entropy_over_log_n_species_pielou1975){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_entropy_over_log_n_species_pielou1975");
 				sw_entropy_over_log_n_species_pielou1975_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) entropy over log n species Pielou 1975 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) entropy over log n species Pielou 1975 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_heip){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_heip");
 				sw_e_heip_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E Heip in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E Heip in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_one_minus_d){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_one_minus_d");
 				sw_e_one_minus_D_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E one minus D in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E one minus D in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_one_over_ln_d_williams1964){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_one_over_ln_d_williams1964");
 				sw_e_one_over_D_williams1964_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E one over ln D Williams 1964 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E one over ln D Williams 1964 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_minus_ln_d_pielou1977){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_minus_ln_d_pielou1977");
 				sw_e_minus_ln_D_pielou1977_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E minus ln D Pielou 1977 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E minus ln D Pielou 1977 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_f_2_1_alatalo1981){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_f_2_1_alatalo1981");
 				sw_f_2_1_alatalo1981_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) F_2_1 Alatalo 1981 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) F_2_1 Alatalo 1981 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_g_2_1_molinari1989){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_g_2_1_molinari1989");
 				sw_g_2_1_molinari1989_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) G_2_1 Molinari 1989 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) G_2_1 Molinari 1989 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_bulla1994){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_bulla1994");
 				sw_e_bulla1994_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E Bulla 1994 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E Bulla 1994 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_o_bulla1994){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_o_bulla1994");
 				sw_o_bulla1994_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) O bulla 1994 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) O bulla 1994 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_mci_pielou1969){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_mci_pielou1969");
 				sw_e_mci_pielou1969_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E MCI Pielou 1969 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E MCI Pielou 1969 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_prime_camargo1993){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_prime_camargo1993");
                 if(mcfg->threading.enable_sw_e_prime_camargo1993_multithreading){
 				    sw_e_prime_camargo1993_from_graph_multithread(sref->g, &res, mcfg->threading.num_matrix_threads);
                 } else {
 				    sw_e_prime_camargo1993_from_graph(sref->g, &res);
                 }
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E prime Camargo 1993 in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E prime Camargo 1993 in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 			if(mcfg->enable.sw_e_var_smith_and_wilson1996_original){
 				double res;
-				time_t t = time(NULL);
+				struct instrument_scope span;
+				instrument_span_begin(&span, "sw_e_var_smith_and_wilson1996_original");
 				sw_e_var_smith_and_wilson1996_original_from_graph(sref->g, &res);
-				time_t delta_t = time(NULL) - t;
-				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E var Smith and Wilson 1996 original in %lis\n", delta_t);}
-				fprintf(mcfg->io.f_ptr, "\t%.10e", res);
-				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {fprintf(mcfg->io.f_timing_ptr, "\t%li", ns_delta);}}
-				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {fprintf(mcfg->io.f_memory_ptr, "\t%li", virtual_mem);}}
+				const int64_t delta_ns = instrument_span_end(&span);
+				if(mcfg->io.enable_timings){printf("[log] [time] Computed (SW) E var Smith and Wilson 1996 original in %.9fs\n", ((double) delta_ns) * 1e-9);}
+				output_double(mcfg->io.output, res);
+				if(mcfg->io.enable_output_timing){if(time_ns_delta(&ns_delta) != 0){goto time_ns_delta_failure;} else {output_int(mcfg->io.output_timing, ns_delta);}}
+				if(mcfg->io.enable_output_memory){if(virtual_memory_consumption(&virtual_mem) != 0){goto virtual_memory_consumption_failure;} else {output_int(mcfg->io.output_memory, virtual_mem);}}
 			}
 		}
 
-		fprintf(mcfg->io.f_ptr, "\n");
-		if(mcfg->io.enable_output_timing){fprintf(mcfg->io.f_timing_ptr, "\n");}
-		if(mcfg->io.enable_output_memory){fprintf(mcfg->io.f_memory_ptr, "\n");}
+		// every row is ended, so that the three files stay aligned as far as they can
+		int32_t output_status = output_end_row(mcfg->io.output);
+		if(mcfg->io.enable_output_timing && output_end_row(mcfg->io.output_timing) != 0){output_status = 1;}
+		if(mcfg->io.enable_output_memory && output_end_row(mcfg->io.output_memory) != 0){output_status = 1;}
 
-		if(enable_distance_computation){
-			free_matrix(&m);
-			if(mcfg->enable.functional_evenness || mcfg->enable.mst){
-				free_matrix(&m_mst);
-			}
-		}
+		if(enable_distance_computation){free_matrix(&m);}
+		// created above whether or not the disparity functions are enabled
+		if(mcfg->enable.functional_evenness || mcfg->enable.mst){free_matrix(&m_mst);}
+		if(output_status != 0){goto output_end_row_failure;}
+	}
+
+	if(sref->schedule != NULL){
+		const int64_t schedule_end_ns = recompute_schedule_now();
+		if(schedule_middle_ns == 0){schedule_middle_ns = schedule_end_ns;}
+		if(mcfg->enable.disparity_functions){recompute_schedule_observe_compute(sref->schedule, RECOMPUTE_COST_DISPARITY, sref->g->num_nodes, schedule_middle_ns - schedule_start_ns);}
+		if(mcfg->enable.non_disparity_functions){recompute_schedule_observe_compute(sref->schedule, RECOMPUTE_COST_NON_DISPARITY, sref->g->num_nodes, schedule_end_ns - schedule_middle_ns);}
 	}
 
 	return 0;
@@ -1034,7 +1135,147 @@ int32_t apply_diversity_functions_to_graph(const uint64_t i, struct measurement_
 	perror("Failed to call virtual_memory_consumption\n");
 	return 1;
 
+	output_end_row_failure:
+	perror("Failed to call output_end_row\n");
+	return 1;
+
 	malloc_fail:
 	perror("malloc failed\n");
 	return 1;
 }
+
+// one recompute step on sref->g, whose snapshot proportions must already match the counts of the step;
+// unless forced, the functions are skipped when neither the zipfian fit nor the number of nodes changed since the previous step
+int32_t measurement_recompute_step(const uint64_t i, struct measurement_configuration * const mcfg, struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, const uint8_t force){
+	const int32_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	if(sref->step_hook != NULL){return sref->step_hook->step(sref->step_hook->ctx, i, sref->g, mmut);}
+
+	const int64_t schedule_start_ns = sref->schedule != NULL ? recompute_schedule_now() : 0;
+
+	if(zipfian_fit_from_graph(sref->g, &mmut->best_s) != 0){
+		perror("failed to call zipfian_fit_from_graph\n");
+		return 1;
+	}
+	if(sref->schedule != NULL){recompute_schedule_observe_compute(sref->schedule, RECOMPUTE_COST_FIT, sref->g->num_nodes, recompute_schedule_now() - schedule_start_ns);}
+
+	if(force || mmut->best_s != mmut->prev_best_s || sref->g->num_nodes != ((uint64_t) mmut->prev_num_nodes)){
+		memset(log_bfr, '\0', log_bfr_size);
+		snprintf(log_bfr, log_bfr_size, "best_s: %f; num_nodes: %lu; num_sentences: %lu; num_documents: %lu", mmut->best_s, sref->g->num_nodes, mmut->sentence.num_all, mmut->document.num_all);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+		struct instrument_scope span;
+		instrument_span_begin(&span, "recompute_step");
+		const int32_t apply_status = apply_diversity_functions_to_graph(i, mcfg, sref, mmut);
+		instrument_span_end(&span);
+		if(apply_status != 0){
+			perror("failed to call apply_diversity_functions_to_graph\n");
+			return 1;
+		}
+		mmut->prev_best_s = mmut->best_s;
+	} else {
+		printf("ignoring because best_s (%.12f) == previous_best_s (%.12f) && g->num_nodes (%lu) == previous_g_num_nodes (%li)\n", mmut->best_s, mmut->prev_best_s, sref->g->num_nodes, mmut->prev_num_nodes);
+	}
+
+	return 0;
+}
+
+// the counts of sref->g and of the OOV counter, once every reader is done
+int32_t measurement_capture_shard(struct shard * const s, const struct measurement_structure_references * const sref, const struct measurement_mutables * const mmut, const uint64_t num_files){
+	struct oov_counter_entry * oov_entries = NULL;
+	int64_t num_oov_entries = 0;
+	if(oov_counter_entries(sref->oov_discarded_because_not_in_vector_database, &oov_entries, &num_oov_entries) != 0){
+		perror("failed to call oov_counter_entries\n");
+		return 1;
+	}
+
+	const uint64_t num_nodes = graph_num_nodes(sref->g);
+	size_t key_blob_size = 0;
+	for(uint64_t k = 0 ; k < num_nodes ; k++){key_blob_size += strlen(graph_node_at(sref->g, k)->word2vec_entry_pointer->key) + 1;}
+	for(int64_t k = 0 ; k < num_oov_entries ; k++){key_blob_size += strlen(oov_entries[k].key) + 1;}
+	if(create_shard(s, num_nodes, (uint64_t) num_oov_entries, key_blob_size) != 0){
+		perror("failed to call create_shard\n");
+		free(oov_entries);
+		return 1;
+	}
+
+	// first_seen is the index of the node, so that the nodes are created in the same order when the shard is measured
+	size_t blob_position = 0;
+	for(uint64_t k = 0 ; k < num_nodes ; k++){
+		const struct graph_node * const node = graph_node_at(sref->g, k);
+		const size_t length = strlen(node->word2vec_entry_pointer->key) + 1;
+		memcpy(s->key_blob + blob_position, node->word2vec_entry_pointer->key, length);
+		s->entries[k].key = s->key_blob + blob_position;
+		s->entries[k].count = __atomic_load_n(&(node->absolute_proportion), __ATOMIC_RELAXED);
+		s->entries[k].first_seen = k;
+		s->num_tokens += s->entries[k].count;
+		blob_position += length;
+	}
+	for(int64_t k = 0 ; k < num_oov_entries ; k++){
+		const size_t length = strlen(oov_entries[k].key) + 1;
+		memcpy(s->key_blob + blob_position, oov_entries[k].key, length);
+		s->oov_entries[k].key = s->key_blob + blob_position;
+		s->oov_entries[k].count = (uint64_t) oov_entries[k].value;
+		s->num_oov_tokens += s->oov_entries[k].count;
+		blob_position += length;
+	}
+	free(oov_entries);
+
+	s->oov_exact = oov_counter_is_exact(sref->oov_discarded_because_not_in_vector_database);
+	s->num_oov_types = oov_counter_num_types(sref->oov_discarded_because_not_in_vector_database);
+	s->num_files = num_files;
+	s->num_documents = mmut->document.num_all;
+	s->num_sentences = mmut->sentence.num_all;
+	s->num_sentences_containing_mwe = mmut->sentence.num_containing_mwe;
+	s->num_sentences_containing_mwe_tp_only = mmut->sentence.num_containing_mwe_tp_only;
+
+	if(shard_sort(s) != 0){
+		perror("failed to call shard_sort\n");
+		free_shard(s);
+		return 1;
+	}
+	return 0;
+}
+
+static int32_t measurement_shard_entry_cmp_first_seen(const void * const a, const void * const b){
+	const uint64_t x = (*((const struct shard_entry * const *) a))->first_seen;
+	const uint64_t y = (*((const struct shard_entry * const *) b))->first_seen;
+	return (x > y) - (x < y);
+}
+
+// fills the empty graph sref->g (bound to sref->w2v) and the counters of mmut; the OOV counter stays empty, its number of types is given back instead
+int32_t measurement_restore_shard(const struct shard * const s, const struct measurement_structure_references * const sref, struct measurement_mutables * const mmut, int64_t * const num_oov_types){
+	const struct shard_entry ** const order = (const struct shard_entry **) malloc((s->num_entries > 0 ? s->num_entries : 1) * sizeof(struct shard_entry *));
+	if(order == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	for(uint64_t k = 0 ; k < s->num_entries ; k++){order[k] = &(s->entries[k]);}
+	qsort(order, s->num_entries, sizeof(struct shard_entry *), measurement_shard_entry_cmp_first_seen);
+
+	for(uint64_t k = 0 ; k < s->num_entries ; k++){
+		const int32_t index = word2vec_key_to_index(sref->w2v, order[k]->key);
+		if(index < 0){
+			fprintf(stderr, "shard key not in the vector database: %s\n", order[k]->key);
+			goto failure;
+		}
+		struct word2vec_entry * const entry = &(sref->w2v->keys[index]);
+		if(graph_add_word2vec_occurrence(sref->g, sref->w2v, entry) != 0){
+			perror("failed to call graph_add_word2vec_occurrence\n");
+			goto failure;
+		}
+		graph_word2vec_node(sref->g, sref->w2v, entry)->absolute_proportion = order[k]->count;
+	}
+	free(order);
+
+	mmut->document.num_all = s->num_documents;
+	mmut->sentence.num_all = s->num_sentences;
+	mmut->sentence.num_containing_mwe = s->num_sentences_containing_mwe;
+	mmut->sentence.num_containing_mwe_tp_only = s->num_sentences_containing_mwe_tp_only;
+	*num_oov_types = s->num_oov_types;
+	return 0;
+
+	failure:
+	free(order);
+	return 1;
+}
@@ -0,0 +1,553 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oov/counter.h"
+#include "oov/constants.h"
+#include "logging.h"
+
+static uint64_t oov_counter_mix(uint64_t h){
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// copies at most OOV_COUNTER_KEY_SIZE - 1 bytes of key into truncated_key (zero-padded), as the sorted_array used to
+static uint64_t oov_counter_hash(const char * const key, char * const truncated_key){
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    size_t i = 0;
+    memset(truncated_key, '\0', OOV_COUNTER_KEY_SIZE);
+    while(i < OOV_COUNTER_KEY_SIZE - 1 && key[i] != '\0'){
+        truncated_key[i] = key[i];
+        h ^= (uint64_t) ((uint8_t) key[i]);
+        h *= 0x100000001b3ULL;
+        i++;
+    }
+    return oov_counter_mix(h);
+}
+
+static struct oov_counter_shard * oov_counter_shard_of(struct oov_counter * const counter, const uint64_t hash){
+    return &(counter->shards[hash >> (64 - OOV_COUNTER_NUM_SHARDS_LOG2)]);
+}
+
+static struct oov_counter_entry * oov_counter_shard_find(const struct oov_counter_shard * const shard, const uint64_t hash, const char * const key){
+    const uint64_t mask = (uint64_t) (shard->capacity - 1);
+    uint64_t j = hash & mask;
+    while(shard->bfr[j].value != 0){
+        if(shard->bfr[j].hash == hash && strcmp(shard->bfr[j].key, key) == 0){return &(shard->bfr[j]);}
+        j = (j + 1) & mask;
+    }
+    return &(shard->bfr[j]); // empty slot
+}
+
+static int32_t oov_counter_shard_grow(struct oov_counter_shard * const shard){
+    const int64_t new_capacity = shard->capacity << 1;
+    const uint64_t mask = (uint64_t) (new_capacity - 1);
+    size_t alloc_size = new_capacity * sizeof(struct oov_counter_entry);
+    struct oov_counter_entry * new_bfr = malloc(alloc_size);
+    if(new_bfr == NULL){
+        perror("malloc failed\n");
+        return 1;
+    }
+    memset(new_bfr, '\0', alloc_size);
+
+    for(int64_t i = 0 ; i < shard->capacity ; i++){
+        if(shard->bfr[i].value == 0){continue;}
+        uint64_t j = shard->bfr[i].hash & mask;
+        while(new_bfr[j].value != 0){j = (j + 1) & mask;}
+        memcpy(&(new_bfr[j]), &(shard->bfr[i]), sizeof(struct oov_counter_entry));
+    }
+
+    free(shard->bfr);
+    shard->bfr = new_bfr;
+    shard->capacity = new_capacity;
+    return 0;
+}
+
+static uint64_t oov_counter_sketch_index(const struct oov_counter_sketch * const sketch, const uint64_t hash, const uint64_t row){
+    return (row * sketch->width) + (oov_counter_mix(hash + (row + 1) * 0x9e3779b97f4a7c15ULL) & sketch->mask);
+}
+
+static uint32_t oov_counter_sketch_add(struct oov_counter_sketch * const sketch, const uint64_t hash, const uint32_t weight){
+    uint32_t estimate = UINT32_MAX;
+    for(uint64_t row = 0 ; row < OOV_COUNTER_SKETCH_DEPTH ; row++){
+        uint32_t local_value = __atomic_add_fetch(&(sketch->table[oov_counter_sketch_index(sketch, hash, row)]), weight, __ATOMIC_RELAXED);
+        if(local_value < estimate){estimate = local_value;}
+    }
+    return estimate;
+}
+
+static uint32_t oov_counter_sketch_estimate(const struct oov_counter_sketch * const sketch, const uint64_t hash){
+    uint32_t estimate = UINT32_MAX;
+    for(uint64_t row = 0 ; row < OOV_COUNTER_SKETCH_DEPTH ; row++){
+        uint32_t local_value = __atomic_load_n(&(sketch->table[oov_counter_sketch_index(sketch, hash, row)]), __ATOMIC_RELAXED);
+        if(local_value < estimate){estimate = local_value;}
+    }
+    return estimate;
+}
+
+static void oov_counter_top_k_update_min(struct oov_counter_top_k * const top_k){
+    int64_t min_value = INT64_MAX;
+    if(top_k->num_entries < OOV_COUNTER_TOP_K){
+        min_value = 0;
+    } else {
+        for(int32_t i = 0 ; i < top_k->num_entries ; i++){
+            if(top_k->entries[i].value < min_value){min_value = top_k->entries[i].value;}
+        }
+    }
+    __atomic_store_n(&(top_k->min_value), min_value, __ATOMIC_RELAXED);
+}
+
+// must be called with top_k->mutex locked
+static void oov_counter_top_k_offer(struct oov_counter_top_k * const top_k, const uint64_t hash, const char * const key, const int64_t estimate){
+    int32_t i;
+    int32_t index_min = 0;
+    for(i = 0 ; i < top_k->num_entries ; i++){
+        if(top_k->entries[i].hash == hash && strcmp(top_k->entries[i].key, key) == 0){
+            if(estimate > top_k->entries[i].value){top_k->entries[i].value = estimate;}
+            oov_counter_top_k_update_min(top_k);
+            return;
+        }
+        if(top_k->entries[i].value < top_k->entries[index_min].value){index_min = i;}
+    }
+    if(top_k->num_entries < OOV_COUNTER_TOP_K){
+        index_min = top_k->num_entries;
+        top_k->num_entries++;
+    } else if(estimate <= top_k->entries[index_min].value){
+        return;
+    }
+    top_k->entries[index_min].hash = hash;
+    top_k->entries[index_min].value = estimate;
+    memcpy(top_k->entries[index_min].key, key, OOV_COUNTER_KEY_SIZE);
+    oov_counter_top_k_update_min(top_k);
+}
+
+static void oov_counter_add_approximate(struct oov_counter * const counter, const uint64_t hash, const char * const key, const uint32_t weight){
+    const uint32_t estimate = oov_counter_sketch_add(&(counter->sketch), hash, weight);
+    if(estimate == weight){ // every row was empty beforehand: the type has never been seen
+        __atomic_add_fetch(&(counter->num_types), 1, __ATOMIC_RELAXED);
+    }
+    if(((int64_t) estimate) > __atomic_load_n(&(counter->top_k.min_value), __ATOMIC_RELAXED)){
+        pthread_mutex_lock(&(counter->top_k.mutex));
+        oov_counter_top_k_offer(&(counter->top_k), hash, key, (int64_t) estimate);
+        pthread_mutex_unlock(&(counter->top_k.mutex));
+    }
+}
+
+static int32_t oov_counter_switch_to_approximate(struct oov_counter * const counter){
+    const int32_t log_bfr_size = 256;
+    char log_bfr[log_bfr_size];
+
+    pthread_mutex_lock(&(counter->mutex_mode));
+    if(counter->mode == OOV_COUNTER_MODE_APPROXIMATE){
+        pthread_mutex_unlock(&(counter->mutex_mode));
+        return 0;
+    }
+
+    uint64_t width = OOV_COUNTER_SKETCH_MIN_WIDTH;
+    while(width < OOV_COUNTER_SKETCH_MAX_WIDTH && (width << 1) * OOV_COUNTER_SKETCH_DEPTH * sizeof(uint32_t) <= counter->memory_cap){
+        width <<= 1;
+    }
+    size_t alloc_size = width * OOV_COUNTER_SKETCH_DEPTH * sizeof(uint32_t);
+    counter->sketch.table = malloc(alloc_size);
+    if(counter->sketch.table == NULL){
+        perror("malloc failed\n");
+        pthread_mutex_unlock(&(counter->mutex_mode));
+        return 1;
+    }
+    memset(counter->sketch.table, '\0', alloc_size);
+    counter->sketch.width = width;
+    counter->sketch.mask = width - 1;
+
+    int32_t i;
+    for(i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        pthread_mutex_lock(&(counter->shards[i].mutex));
+    }
+
+    pthread_mutex_lock(&(counter->top_k.mutex));
+    for(i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        struct oov_counter_shard * const shard = &(counter->shards[i]);
+        for(int64_t j = 0 ; j < shard->capacity ; j++){
+            if(shard->bfr[j].value == 0){continue;}
+            const uint32_t weight = shard->bfr[j].value > UINT32_MAX ? UINT32_MAX : (uint32_t) shard->bfr[j].value;
+            const uint32_t estimate = oov_counter_sketch_add(&(counter->sketch), shard->bfr[j].hash, weight);
+            oov_counter_top_k_offer(&(counter->top_k), shard->bfr[j].hash, shard->bfr[j].key, (int64_t) estimate);
+        }
+        free(shard->bfr);
+        shard->bfr = NULL;
+        shard->capacity = 0;
+        shard->num_elements = 0;
+    }
+    pthread_mutex_unlock(&(counter->top_k.mutex));
+
+    // num_types is kept: the exact count so far, to which sketch misses are added
+    counter->memory_used = alloc_size + sizeof(struct oov_counter_top_k);
+    __atomic_store_n(&(counter->mode), OOV_COUNTER_MODE_APPROXIMATE, __ATOMIC_RELEASE);
+
+    for(i = OOV_COUNTER_NUM_SHARDS - 1 ; i >= 0 ; i--){
+        pthread_mutex_unlock(&(counter->shards[i].mutex));
+    }
+
+    memset(log_bfr, '\0', log_bfr_size);
+    snprintf(log_bfr, log_bfr_size, "OOV counter exceeded its memory cap (%zu bytes); switching to approximate counting (Count-Min sketch: %i x %lu, top-%i)", counter->memory_cap, OOV_COUNTER_SKETCH_DEPTH, width, OOV_COUNTER_TOP_K);
+    warning_format(__FILE__, __func__, __LINE__, log_bfr);
+
+    pthread_mutex_unlock(&(counter->mutex_mode));
+    return 0;
+}
+
+int32_t create_oov_counter(struct oov_counter * const counter, const size_t memory_cap){
+    memset(counter, '\0', sizeof(struct oov_counter));
+    size_t alloc_size = OOV_COUNTER_SHARD_INITIAL_CAPACITY * sizeof(struct oov_counter_entry);
+    int32_t i;
+
+    for(i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        counter->shards[i].bfr = malloc(alloc_size);
+        if(counter->shards[i].bfr == NULL){goto malloc_fail;}
+        memset(counter->shards[i].bfr, '\0', alloc_size);
+        counter->shards[i].capacity = OOV_COUNTER_SHARD_INITIAL_CAPACITY;
+        counter->shards[i].num_elements = 0;
+        if(pthread_mutex_init(&(counter->shards[i].mutex), NULL) != 0){
+            perror("Failed to call pthread_mutex_init in create_oov_counter\n");
+            free(counter->shards[i].bfr);
+            goto failure;
+        }
+    }
+
+    if(pthread_mutex_init(&(counter->top_k.mutex), NULL) != 0){
+        perror("Failed to call pthread_mutex_init in create_oov_counter\n");
+        goto failure;
+    }
+    if(pthread_mutex_init(&(counter->mutex_mode), NULL) != 0){
+        perror("Failed to call pthread_mutex_init in create_oov_counter\n");
+        pthread_mutex_destroy(&(counter->top_k.mutex));
+        goto failure;
+    }
+
+    counter->memory_cap = memory_cap;
+    counter->memory_used = OOV_COUNTER_NUM_SHARDS * alloc_size;
+    counter->num_types = 0;
+    counter->mode = OOV_COUNTER_MODE_EXACT;
+
+    if(counter->memory_cap != 0 && counter->memory_used > counter->memory_cap){
+        if(oov_counter_switch_to_approximate(counter) != 0){
+            perror("failed to call oov_counter_switch_to_approximate\n");
+            free_oov_counter(counter);
+            return 1;
+        }
+    }
+
+    return 0;
+
+    malloc_fail:
+    perror("malloc failed\n");
+    failure:
+    for(int32_t j = 0 ; j < i ; j++){
+        free(counter->shards[j].bfr);
+        pthread_mutex_destroy(&(counter->shards[j].mutex));
+    }
+    memset(counter, '\0', sizeof(struct oov_counter));
+    return 1;
+}
+
+void free_oov_counter(struct oov_counter * const counter){
+    for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        if(counter->shards[i].bfr != NULL){free(counter->shards[i].bfr);}
+        pthread_mutex_destroy(&(counter->shards[i].mutex));
+    }
+    if(counter->sketch.table != NULL){free(counter->sketch.table);}
+    pthread_mutex_destroy(&(counter->top_k.mutex));
+    pthread_mutex_destroy(&(counter->mutex_mode));
+    memset(counter, '\0', sizeof(struct oov_counter));
+}
+
+int32_t oov_counter_increment(struct oov_counter * const counter, const char * const key){
+    char local_key[OOV_COUNTER_KEY_SIZE];
+    const uint64_t hash = oov_counter_hash(key, local_key);
+
+    if(__atomic_load_n(&(counter->mode), __ATOMIC_ACQUIRE) == OOV_COUNTER_MODE_EXACT){
+        struct oov_counter_shard * const shard = oov_counter_shard_of(counter, hash);
+        int8_t grown = 0;
+
+        pthread_mutex_lock(&(shard->mutex));
+        // mode only changes while every shard is locked
+        if(counter->mode == OOV_COUNTER_MODE_EXACT){
+            struct oov_counter_entry * const entry = oov_counter_shard_find(shard, hash, local_key);
+            if(entry->value != 0){
+                entry->value++;
+            } else {
+                entry->hash = hash;
+                entry->value = 1;
+                memcpy(entry->key, local_key, OOV_COUNTER_KEY_SIZE);
+                shard->num_elements++;
+                __atomic_add_fetch(&(counter->num_types), 1, __ATOMIC_RELAXED);
+                if(shard->num_elements * 4 >= shard->capacity * 3){
+                    const size_t delta = shard->capacity * sizeof(struct oov_counter_entry);
+                    if(oov_counter_shard_grow(shard) != 0){
+                        perror("failed to call oov_counter_shard_grow\n");
+                        pthread_mutex_unlock(&(shard->mutex));
+                        return 1;
+                    }
+                    __atomic_add_fetch(&(counter->memory_used), delta, __ATOMIC_RELAXED);
+                    grown = 1;
+                }
+            }
+            pthread_mutex_unlock(&(shard->mutex));
+
+            if(grown && counter->memory_cap != 0 && __atomic_load_n(&(counter->memory_used), __ATOMIC_RELAXED) > counter->memory_cap){
+                if(oov_counter_switch_to_approximate(counter) != 0){
+                    perror("failed to call oov_counter_switch_to_approximate\n");
+                    return 1;
+                }
+            }
+            return 0;
+        }
+        pthread_mutex_unlock(&(shard->mutex));
+    }
+
+    oov_counter_add_approximate(counter, hash, local_key, 1);
+    return 0;
+}
+
+int64_t oov_counter_get(struct oov_counter * const counter, const char * const key){
+    char local_key[OOV_COUNTER_KEY_SIZE];
+    const uint64_t hash = oov_counter_hash(key, local_key);
+    int64_t value = -1;
+
+    if(__atomic_load_n(&(counter->mode), __ATOMIC_ACQUIRE) == OOV_COUNTER_MODE_EXACT){
+        struct oov_counter_shard * const shard = oov_counter_shard_of(counter, hash);
+        pthread_mutex_lock(&(shard->mutex));
+        if(counter->mode == OOV_COUNTER_MODE_EXACT){
+            value = oov_counter_shard_find(shard, hash, local_key)->value;
+        }
+        pthread_mutex_unlock(&(shard->mutex));
+        if(value != -1){return value;}
+    }
+
+    return (int64_t) oov_counter_sketch_estimate(&(counter->sketch), hash);
+}
+
+int64_t oov_counter_num_types(const struct oov_counter * const counter){
+    return __atomic_load_n(&(counter->num_types), __ATOMIC_RELAXED);
+}
+
+uint8_t oov_counter_is_exact(const struct oov_counter * const counter){
+    return __atomic_load_n(&(counter->mode), __ATOMIC_ACQUIRE) == OOV_COUNTER_MODE_EXACT;
+}
+
+static int oov_counter_entry_cmp_desc(const void * a, const void * b){
+    const struct oov_counter_entry * const x = (const struct oov_counter_entry *) a;
+    const struct oov_counter_entry * const y = (const struct oov_counter_entry *) b;
+    if(x->value != y->value){return x->value < y->value ? 1 : -1;}
+    return strcmp(x->key, y->key);
+}
+
+// keeps the n heaviest entries of the exact tables in bfr, sorted in descending order
+static void oov_counter_keep_heaviest(struct oov_counter_entry * const bfr, const int32_t n, int32_t * const num_written, const struct oov_counter_entry * const entry){
+    int32_t j = *num_written;
+    if(j == n){
+        if(oov_counter_entry_cmp_desc(entry, &(bfr[n - 1])) >= 0){return;}
+        j--;
+    } else {
+        (*num_written)++;
+    }
+    while(j > 0 && oov_counter_entry_cmp_desc(entry, &(bfr[j - 1])) < 0){
+        memcpy(&(bfr[j]), &(bfr[j - 1]), sizeof(struct oov_counter_entry));
+        j--;
+    }
+    memcpy(&(bfr[j]), entry, sizeof(struct oov_counter_entry));
+}
+
+int32_t oov_counter_most_frequent(struct oov_counter * const counter, struct oov_counter_entry * const bfr, const int32_t n, int32_t * const num_written){
+    *num_written = 0;
+    if(n <= 0){return 0;}
+
+    pthread_mutex_lock(&(counter->mutex_mode)); // no switch in the meantime
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            struct oov_counter_shard * const shard = &(counter->shards[i]);
+            pthread_mutex_lock(&(shard->mutex));
+            for(int64_t j = 0 ; j < shard->capacity ; j++){
+                if(shard->bfr[j].value != 0){oov_counter_keep_heaviest(bfr, n, num_written, &(shard->bfr[j]));}
+            }
+            pthread_mutex_unlock(&(shard->mutex));
+        }
+    } else {
+        pthread_mutex_lock(&(counter->top_k.mutex));
+        int32_t num_entries = counter->top_k.num_entries < n ? counter->top_k.num_entries : n;
+        struct oov_counter_entry local_entries[OOV_COUNTER_TOP_K];
+        memcpy(local_entries, counter->top_k.entries, counter->top_k.num_entries * sizeof(struct oov_counter_entry));
+        qsort(local_entries, counter->top_k.num_entries, sizeof(struct oov_counter_entry), oov_counter_entry_cmp_desc);
+        memcpy(bfr, local_entries, num_entries * sizeof(struct oov_counter_entry));
+        *num_written = num_entries;
+        pthread_mutex_unlock(&(counter->top_k.mutex));
+    }
+    pthread_mutex_unlock(&(counter->mutex_mode));
+
+    return 0;
+}
+
+// every entry of the exact tables, or the top-k list in approximate mode, in no particular order; *entries is to be freed
+int32_t oov_counter_entries(struct oov_counter * const counter, struct oov_counter_entry ** const entries, int64_t * const num_entries){
+    *entries = NULL;
+    *num_entries = 0;
+
+    pthread_mutex_lock(&(counter->mutex_mode)); // no switch in the meantime
+    int64_t capacity = 0;
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){capacity += counter->shards[i].num_elements;}
+    } else {
+        capacity = OOV_COUNTER_TOP_K;
+    }
+    *entries = (struct oov_counter_entry *) malloc((capacity > 0 ? capacity : 1) * sizeof(struct oov_counter_entry));
+    if(*entries == NULL){
+        pthread_mutex_unlock(&(counter->mutex_mode));
+        perror("malloc failed\n");
+        return 1;
+    }
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            struct oov_counter_shard * const shard = &(counter->shards[i]);
+            pthread_mutex_lock(&(shard->mutex));
+            for(int64_t j = 0 ; j < shard->capacity && *num_entries < capacity ; j++){
+                if(shard->bfr[j].value != 0){memcpy(&((*entries)[(*num_entries)++]), &(shard->bfr[j]), sizeof(struct oov_counter_entry));}
+            }
+            pthread_mutex_unlock(&(shard->mutex));
+        }
+    } else {
+        pthread_mutex_lock(&(counter->top_k.mutex));
+        memcpy(*entries, counter->top_k.entries, counter->top_k.num_entries * sizeof(struct oov_counter_entry));
+        *num_entries = counter->top_k.num_entries;
+        pthread_mutex_unlock(&(counter->top_k.mutex));
+    }
+    pthread_mutex_unlock(&(counter->mutex_mode));
+
+    return 0;
+}
+
+// writes the whole state, in native byte order; no increment may run meanwhile
+int32_t oov_counter_save(const struct oov_counter * const counter, FILE * const f){
+    const uint64_t header[3] = {(uint64_t) counter->mode, (uint64_t) counter->num_types, (uint64_t) counter->memory_used};
+    if(fwrite(header, sizeof(uint64_t), 3, f) != 3){goto write_fail;}
+
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            const struct oov_counter_shard * const shard = &(counter->shards[i]);
+            const int64_t sizes[2] = {shard->capacity, shard->num_elements};
+            if(fwrite(sizes, sizeof(int64_t), 2, f) != 2){goto write_fail;}
+            for(int64_t j = 0 ; j < shard->capacity ; j++){
+                if(shard->bfr[j].value != 0 && fwrite(&(shard->bfr[j]), sizeof(struct oov_counter_entry), 1, f) != 1){goto write_fail;}
+            }
+        }
+    } else {
+        const int64_t sizes[3] = {(int64_t) counter->sketch.width, (int64_t) counter->top_k.num_entries, counter->top_k.min_value};
+        if(fwrite(sizes, sizeof(int64_t), 3, f) != 3){goto write_fail;}
+        const size_t table_size = counter->sketch.width * OOV_COUNTER_SKETCH_DEPTH;
+        if(fwrite(counter->sketch.table, sizeof(uint32_t), table_size, f) != table_size){goto write_fail;}
+        if(fwrite(counter->top_k.entries, sizeof(struct oov_counter_entry), counter->top_k.num_entries, f) != (size_t) counter->top_k.num_entries){goto write_fail;}
+    }
+    return 0;
+
+    write_fail:
+    perror("failed to write OOV counter\n");
+    return 1;
+}
+
+// replaces the state of a counter made by create_oov_counter with the one written by oov_counter_save; memory_cap is kept
+int32_t oov_counter_load(struct oov_counter * const counter, FILE * const f){
+    uint64_t header[3];
+    if(fread(header, sizeof(uint64_t), 3, f) != 3 || header[0] > OOV_COUNTER_MODE_APPROXIMATE){goto read_fail;}
+
+    for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+        free(counter->shards[i].bfr);
+        counter->shards[i].bfr = NULL;
+        counter->shards[i].capacity = 0;
+        counter->shards[i].num_elements = 0;
+    }
+    free(counter->sketch.table);
+    counter->sketch.table = NULL;
+    counter->sketch.width = 0;
+    counter->sketch.mask = 0;
+    counter->top_k.num_entries = 0;
+    counter->top_k.min_value = 0;
+
+    counter->mode = (uint8_t) header[0];
+    counter->num_types = (int64_t) header[1];
+    counter->memory_used = (size_t) header[2];
+
+    if(counter->mode == OOV_COUNTER_MODE_EXACT){
+        for(int32_t i = 0 ; i < OOV_COUNTER_NUM_SHARDS ; i++){
+            struct oov_counter_shard * const shard = &(counter->shards[i]);
+            int64_t sizes[2];
+            if(fread(sizes, sizeof(int64_t), 2, f) != 2 || sizes[0] <= 0 || (sizes[0] & (sizes[0] - 1)) != 0 || sizes[1] < 0 || sizes[1] >= sizes[0]){goto read_fail;}
+            shard->bfr = malloc(sizes[0] * sizeof(struct oov_counter_entry));
+            if(shard->bfr == NULL){
+                perror("malloc failed\n");
+                return 1;
+            }
+            memset(shard->bfr, '\0', sizes[0] * sizeof(struct oov_counter_entry));
+            shard->capacity = sizes[0];
+            // same capacity, so probing from the hash finds every entry where it was
+            const uint64_t mask = (uint64_t) (shard->capacity - 1);
+            for(int64_t k = 0 ; k < sizes[1] ; k++){
+                struct oov_counter_entry entry;
+                if(fread(&entry, sizeof(struct oov_counter_entry), 1, f) != 1 || entry.value == 0){goto read_fail;}
+                uint64_t j = entry.hash & mask;
+                while(shard->bfr[j].value != 0){j = (j + 1) & mask;}
+                memcpy(&(shard->bfr[j]), &entry, sizeof(struct oov_counter_entry));
+                shard->num_elements++;
+            }
+        }
+    } else {
+        int64_t sizes[3];
+        if(fread(sizes, sizeof(int64_t), 3, f) != 3 || sizes[0] <= 0 || (sizes[0] & (sizes[0] - 1)) != 0 || sizes[1] < 0 || sizes[1] > OOV_COUNTER_TOP_K){goto read_fail;}
+        const size_t table_size = (size_t) sizes[0] * OOV_COUNTER_SKETCH_DEPTH;
+        counter->sketch.table = malloc(table_size * sizeof(uint32_t));
+        if(counter->sketch.table == NULL){
+            perror("malloc failed\n");
+            return 1;
+        }
+        counter->sketch.width = (uint64_t) sizes[0];
+        counter->sketch.mask = counter->sketch.width - 1;
+        if(fread(counter->sketch.table, sizeof(uint32_t), table_size, f) != table_size){goto read_fail;}
+        if(fread(counter->top_k.entries, sizeof(struct oov_counter_entry), (size_t) sizes[1], f) != (size_t) sizes[1]){goto read_fail;}
+        counter->top_k.num_entries = (int32_t) sizes[1];
+        counter->top_k.min_value = sizes[2];
+    }
+    return 0;
+
+    read_fail:
+    perror("failed to read OOV counter\n");
+    return 1;
+}
@@ -0,0 +1,687 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for fileno and ftruncate
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "output.h"
+
+struct output_buffer {
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+};
+
+static int32_t output_buffer_reserve(struct output_buffer* const b, const size_t size){
+	if(b->size + size <= b->capacity){return 0;}
+	size_t capacity = b->capacity == 0 ? 4096 : b->capacity * 2;
+	while(capacity < b->size + size){capacity *= 2;}
+	void* const malloc_pointer = realloc(b->data, capacity);
+	if(malloc_pointer == NULL){return 1;}
+	b->data = (uint8_t*) malloc_pointer;
+	b->capacity = capacity;
+	return 0;
+}
+
+static int32_t output_buffer_bytes(struct output_buffer* const b, const void* const bytes, const size_t size){
+	if(output_buffer_reserve(b, size) != 0){return 1;}
+	memcpy(&(b->data[b->size]), bytes, size);
+	b->size += size;
+	return 0;
+}
+
+static int32_t output_buffer_le(struct output_buffer* const b, const uint64_t value, const uint32_t num_bytes){
+	if(output_buffer_reserve(b, num_bytes) != 0){return 1;}
+	for(uint32_t k = 0 ; k < num_bytes ; k++){b->data[b->size++] = (uint8_t) (value >> (8 * k));}
+	return 0;
+}
+
+static int32_t output_buffer_varint(struct output_buffer* const b, uint64_t value){
+	if(output_buffer_reserve(b, 10) != 0){return 1;}
+	while(value >= 0x80){
+		b->data[b->size++] = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	b->data[b->size++] = (uint8_t) value;
+	return 0;
+}
+
+static char* output_copy_string(const char* const value){
+	const char* const source = value != NULL ? value : "(null)"; // as printf would have written it
+	const size_t size = strlen(source) + 1;
+	char* const copy = malloc(size);
+	if(copy != NULL){memcpy(copy, source, size);}
+	return copy;
+}
+
+static void output_free_cells(const uint8_t* const types, const uint32_t num_columns, union output_cell* const cells, const uint32_t num_rows){
+	if(types == NULL){return;}
+	for(uint32_t c = 0 ; c < num_columns ; c++){
+		if(types[c] != OUTPUT_TYPE_STRING){continue;}
+		for(uint32_t r = 0 ; r < num_rows ; r++){free(cells[r * num_columns + c].s);}
+	}
+}
+
+static void output_free_row_group(const struct output_stream* const s, struct output_row_group* const group){
+	output_free_cells(s->types, s->num_columns, group->cells, group->num_rows);
+	free(group->cells);
+	free(group);
+}
+
+static int32_t output_write_tsv(FILE* const f, const uint8_t* const types, const uint32_t num_columns, const union output_cell* const cells, const uint32_t num_rows){
+	for(uint32_t r = 0 ; r < num_rows ; r++){
+		for(uint32_t c = 0 ; c < num_columns ; c++){
+			const union output_cell* const cell = &(cells[r * num_columns + c]);
+			if(c > 0){fputc('\t', f);}
+			switch(types[c]){
+				case OUTPUT_TYPE_UINT64: fprintf(f, "%lu", cell->u); break;
+				case OUTPUT_TYPE_INT64: fprintf(f, "%li", cell->i); break;
+				case OUTPUT_TYPE_DOUBLE: fprintf(f, "%.10e", cell->d); break;
+				case OUTPUT_TYPE_LONG_DOUBLE: fprintf(f, "%.10Le", cell->ld); break;
+				case OUTPUT_TYPE_STRING: fputs(cell->s, f); break;
+				default: return 1;
+			}
+		}
+		fputc('\n', f);
+	}
+	return ferror(f) ? 1 : 0;
+}
+
+static uint64_t output_zigzag(const int64_t value){
+	return (((uint64_t) value) << 1) ^ (uint64_t) (value >> 63);
+}
+
+static int64_t output_unzigzag(const uint64_t value){
+	return (int64_t) (value >> 1) ^ -((int64_t) (value & 1));
+}
+
+static uint64_t output_double_bits(const double value){
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(uint64_t));
+	return bits;
+}
+
+static int32_t output_encode_row_group(const struct output_stream* const s, const struct output_row_group* const group, struct output_buffer* const b){
+	const uint32_t n = s->num_columns;
+
+	if(output_buffer_le(b, group->num_rows, 4) != 0){return 1;}
+	for(uint32_t c = 0 ; c < n ; c++){
+		// every group starts from zero, so that it can be decoded on its own
+		uint64_t previous = 0;
+		const char* previous_string = NULL;
+		for(uint32_t r = 0 ; r < group->num_rows ; r++){
+			const union output_cell* const cell = &(group->cells[r * n + c]);
+			int32_t err = 0;
+			switch(s->types[c]){
+				case OUTPUT_TYPE_UINT64:
+				case OUTPUT_TYPE_INT64:
+					if(s->compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						err = output_buffer_varint(b, output_zigzag((int64_t) (cell->u - previous)));
+						previous = cell->u;
+					} else {
+						err = output_buffer_le(b, cell->u, 8);
+					}
+					break;
+				case OUTPUT_TYPE_DOUBLE:
+					if(s->compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						// neighbouring rows mostly share their sign, exponent and leading mantissa bits
+						const uint64_t bits = output_double_bits(cell->d);
+						const uint64_t x = bits ^ previous;
+						const uint32_t num_bytes = x == 0 ? 0 : 8 - ((uint32_t) __builtin_clzll(x)) / 8;
+						err = output_buffer_le(b, num_bytes, 1);
+						if(err == 0){err = output_buffer_le(b, x, num_bytes);}
+						previous = bits;
+					} else {
+						err = output_buffer_le(b, output_double_bits(cell->d), 8);
+					}
+					break;
+				case OUTPUT_TYPE_LONG_DOUBLE:
+					err = output_buffer_bytes(b, &(cell->ld), sizeof(long double));
+					break;
+				case OUTPUT_TYPE_STRING: {
+					const size_t length = strlen(cell->s);
+					if(s->compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						if(previous_string != NULL && strcmp(previous_string, cell->s) == 0){
+							err = output_buffer_varint(b, 0);
+						} else {
+							err = output_buffer_varint(b, ((uint64_t) length) + 1);
+							if(err == 0){err = output_buffer_bytes(b, cell->s, length);}
+						}
+						previous_string = cell->s;
+					} else {
+						err = output_buffer_varint(b, (uint64_t) length);
+						if(err == 0){err = output_buffer_bytes(b, cell->s, length);}
+					}
+					break;
+				}
+				default:
+					err = 1;
+			}
+			if(err != 0){return 1;}
+		}
+	}
+	return 0;
+}
+
+// header, then the schema for the columnar format; called by whichever thread writes first, once no more row can be added to the schema
+static int32_t output_write_preamble(struct output_stream* const s){
+	s->preamble_written = 1;
+	if(s->format == OUTPUT_FORMAT_TSV){
+		if(s->header_size > 0 && fwrite(s->header, 1, s->header_size, s->f) != s->header_size){return 1;}
+		return 0;
+	}
+
+	struct output_buffer b = {0};
+	int32_t err = output_buffer_bytes(&b, OUTPUT_COLUMNAR_MAGIC, OUTPUT_COLUMNAR_MAGIC_SIZE);
+	if(err == 0){err = output_buffer_le(&b, s->compression, 1);}
+	if(err == 0){err = output_buffer_le(&b, sizeof(long double), 1);}
+	if(err == 0){err = output_buffer_le(&b, s->row_group_size, 4);}
+	if(err == 0){err = output_buffer_le(&b, s->header_size, 8);}
+	if(err == 0 && s->header_size > 0){err = output_buffer_bytes(&b, s->header, s->header_size);}
+	if(err == 0){err = output_buffer_le(&b, s->num_columns, 4);}
+	if(err == 0 && s->num_columns > 0){err = output_buffer_bytes(&b, s->types, s->num_columns);}
+	if(err == 0 && fwrite(b.data, 1, b.size, s->f) != b.size){err = 1;}
+	free(b.data);
+	return err;
+}
+
+static int32_t output_write_row_group(struct output_stream* const s, const struct output_row_group* const group, struct output_buffer* const b){
+	if(!(s->preamble_written) && output_write_preamble(s) != 0){return 1;}
+	if(s->format == OUTPUT_FORMAT_TSV){
+		return output_write_tsv(s->f, s->types, s->num_columns, group->cells, group->num_rows);
+	}
+	b->size = 0;
+	if(output_encode_row_group(s, group, b) != 0){return 1;}
+	return fwrite(b->data, 1, b->size, s->f) != b->size ? 1 : 0;
+}
+
+static void* output_writer_thread(void* args){
+	struct output_stream* const s = (struct output_stream*) args;
+	struct output_buffer b = {0};
+
+	while(1){
+		pthread_mutex_lock(&(s->mutex));
+		while(s->queue_head == NULL && !(s->closing)){pthread_cond_wait(&(s->cond_not_empty), &(s->mutex));}
+		struct output_row_group* const group = s->queue_head;
+		if(group == NULL){
+			pthread_mutex_unlock(&(s->mutex));
+			break;
+		}
+		s->queue_head = group->next;
+		if(s->queue_head == NULL){s->queue_tail = NULL;}
+		s->queue_length--;
+		s->writing = 1;
+		const int32_t failed = s->status;
+		pthread_cond_signal(&(s->cond_not_full));
+		pthread_mutex_unlock(&(s->mutex));
+
+		// after a failure, groups are only drained so that the producer never blocks
+		const int32_t write_failed = !failed && output_write_row_group(s, group, &b) != 0;
+		if(write_failed){perror("failed to write output row group\n");}
+		output_free_row_group(s, group);
+
+		pthread_mutex_lock(&(s->mutex));
+		if(write_failed){s->status = 1;}
+		s->writing = 0;
+		pthread_cond_broadcast(&(s->cond_not_full)); // output_stream_sync waits for the writer to be idle
+		pthread_mutex_unlock(&(s->mutex));
+	}
+
+	free(b.data);
+	return NULL;
+}
+
+// resume_size < 0 creates the file, otherwise the file is cut at resume_size and written after it
+static int32_t output_stream_open(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size, const int64_t resume_size){
+	memset(s, '\0', sizeof(struct output_stream));
+	if(format != OUTPUT_FORMAT_TSV && format != OUTPUT_FORMAT_COLUMNAR){
+		perror("unknown output format\n");
+		return 1;
+	}
+	s->format = format;
+	s->compression = compression ? OUTPUT_COMPRESSION_DELTA_XOR : OUTPUT_COMPRESSION_NONE;
+	s->row_group_size = format == OUTPUT_FORMAT_TSV || row_group_size == 0 ? 1 : row_group_size;
+
+	if(resume_size < 0){
+		s->f = fopen(path, format == OUTPUT_FORMAT_TSV ? "w" : "wb");
+	} else {
+		s->f = fopen(path, "r+b");
+	}
+	if(s->f == NULL){
+		fprintf(stderr, "Failed to open file: %s\n", path);
+		return 1;
+	}
+	if(resume_size >= 0){
+		if(ftruncate(fileno(s->f), (off_t) resume_size) != 0 || fseek(s->f, 0, SEEK_END) != 0){
+			fprintf(stderr, "Failed to cut file: %s\n", path);
+			goto failure_mutex;
+		}
+		s->preamble_written = resume_size > 0; // the header and the schema are already in the file
+	}
+	if(pthread_mutex_init(&(s->mutex), NULL) != 0){goto failure_mutex;}
+	if(pthread_cond_init(&(s->cond_not_empty), NULL) != 0){goto failure_cond_not_empty;}
+	if(pthread_cond_init(&(s->cond_not_full), NULL) != 0){goto failure_cond_not_full;}
+	if(pthread_create(&(s->writer), NULL, output_writer_thread, s) != 0){
+		perror("failed to create output writer thread\n");
+		goto failure_thread;
+	}
+	return 0;
+
+	failure_thread:
+	pthread_cond_destroy(&(s->cond_not_full));
+	failure_cond_not_full:
+	pthread_cond_destroy(&(s->cond_not_empty));
+	failure_cond_not_empty:
+	pthread_mutex_destroy(&(s->mutex));
+	failure_mutex:
+	fclose(s->f);
+	s->f = NULL;
+	return 1;
+}
+
+int32_t create_output_stream(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size){
+	return output_stream_open(s, path, format, compression, row_group_size, -1);
+}
+
+// the header must be declared again, as for a new stream, but is not written twice
+int32_t create_output_stream_resumed(struct output_stream* const s, const char* const path, const uint8_t format, const uint8_t compression, const uint32_t row_group_size, const int64_t size){
+	return output_stream_open(s, path, format, compression, row_group_size, size < 0 ? 0 : size);
+}
+
+int32_t output_header(struct output_stream* const s, const char* const format, ...){
+	va_list args;
+
+	va_start(args, format);
+	const int32_t size = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+	if(size < 0){return 1;}
+
+	if(s->header_size + ((size_t) size) + 1 > s->header_capacity){
+		size_t capacity = s->header_capacity == 0 ? 1024 : s->header_capacity * 2;
+		while(capacity < s->header_size + ((size_t) size) + 1){capacity *= 2;}
+		void* const malloc_pointer = realloc(s->header, capacity);
+		if(malloc_pointer == NULL){perror("malloc failed\n"); return 1;}
+		s->header = (char*) malloc_pointer;
+		s->header_capacity = capacity;
+	}
+
+	va_start(args, format);
+	vsnprintf(&(s->header[s->header_size]), ((size_t) size) + 1, format, args);
+	va_end(args);
+	s->header_size += (size_t) size;
+	return 0;
+}
+
+// the writer thread reads the status as well
+static void output_set_failed(struct output_stream* const s){
+	pthread_mutex_lock(&(s->mutex));
+	s->status = 1;
+	pthread_mutex_unlock(&(s->mutex));
+}
+
+static int32_t output_push(struct output_stream* const s, const enum output_type type, const union output_cell* const cell){
+	if(s->row_length == s->row_capacity){
+		const uint32_t capacity = s->row_capacity == 0 ? 64 : s->row_capacity * 2;
+		void* malloc_pointer = realloc(s->row, capacity * sizeof(union output_cell));
+		if(malloc_pointer == NULL){goto malloc_fail;}
+		s->row = (union output_cell*) malloc_pointer;
+		malloc_pointer = realloc(s->row_types, capacity * sizeof(uint8_t));
+		if(malloc_pointer == NULL){goto malloc_fail;}
+		s->row_types = (uint8_t*) malloc_pointer;
+		s->row_capacity = capacity;
+	}
+	s->row[s->row_length] = *cell;
+	s->row_types[s->row_length] = (uint8_t) type;
+	s->row_length++;
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	if(type == OUTPUT_TYPE_STRING){free(cell->s);}
+	s->row_failed = 1;
+	output_set_failed(s);
+	return 1;
+}
+
+int32_t output_uint(struct output_stream* const s, const uint64_t value){
+	return output_push(s, OUTPUT_TYPE_UINT64, &(union output_cell) {.u = value});
+}
+
+int32_t output_int(struct output_stream* const s, const int64_t value){
+	return output_push(s, OUTPUT_TYPE_INT64, &(union output_cell) {.i = value});
+}
+
+int32_t output_double(struct output_stream* const s, const double value){
+	return output_push(s, OUTPUT_TYPE_DOUBLE, &(union output_cell) {.d = value});
+}
+
+int32_t output_long_double(struct output_stream* const s, const long double value){
+	// the columnar format writes sizeof(long double) bytes, padding included, which must not depend on the stack
+	union output_cell cell;
+	memset(&cell, '\0', sizeof(union output_cell));
+	cell.ld = value;
+	return output_push(s, OUTPUT_TYPE_LONG_DOUBLE, &cell);
+}
+
+int32_t output_string(struct output_stream* const s, const char* const value){
+	char* const copy = output_copy_string(value);
+	if(copy == NULL){
+		perror("malloc failed\n");
+		s->row_failed = 1;
+		output_set_failed(s);
+		return 1;
+	}
+	return output_push(s, OUTPUT_TYPE_STRING, &(union output_cell) {.s = copy});
+}
+
+static void output_discard_row(struct output_stream* const s){
+	output_free_cells(s->row_types, s->row_length, s->row, 1);
+	s->row_length = 0;
+	s->row_failed = 0;
+}
+
+static int32_t output_enqueue(struct output_stream* const s, struct output_row_group* const group){
+	pthread_mutex_lock(&(s->mutex));
+	while(s->queue_length >= OUTPUT_QUEUE_CAPACITY){pthread_cond_wait(&(s->cond_not_full), &(s->mutex));}
+	group->next = NULL;
+	if(s->queue_tail != NULL){
+		s->queue_tail->next = group;
+	} else {
+		s->queue_head = group;
+	}
+	s->queue_tail = group;
+	s->queue_length++;
+	pthread_cond_signal(&(s->cond_not_empty));
+	pthread_mutex_unlock(&(s->mutex));
+	return 0;
+}
+
+// also reports the values of the row that output_uint and the like failed to add
+int32_t output_end_row(struct output_stream* const s){
+	if(s->row_failed){
+		output_discard_row(s);
+		return 1;
+	}
+	if(!(s->schema_set)){
+		if(s->row_length > 0){
+			s->types = malloc(s->row_length * sizeof(uint8_t));
+			if(s->types == NULL){perror("malloc failed\n"); output_discard_row(s); output_set_failed(s); return 1;}
+			memcpy(s->types, s->row_types, s->row_length * sizeof(uint8_t));
+		}
+		s->num_columns = s->row_length;
+		s->schema_set = 1;
+	} else if(s->row_length != s->num_columns || (s->num_columns > 0 && memcmp(s->row_types, s->types, s->num_columns) != 0)){
+		perror("row does not match the columns of the output stream\n");
+		output_discard_row(s);
+		output_set_failed(s);
+		return 1;
+	}
+
+	if(s->current == NULL){
+		s->current = malloc(sizeof(struct output_row_group));
+		if(s->current == NULL){goto malloc_fail;}
+		s->current->num_rows = 0;
+		s->current->next = NULL;
+		s->current->cells = malloc(((size_t) s->row_group_size) * ((size_t) s->num_columns) * sizeof(union output_cell) + 1);
+		if(s->current->cells == NULL){free(s->current); s->current = NULL; goto malloc_fail;}
+	}
+	memcpy(&(s->current->cells[((size_t) s->current->num_rows) * s->num_columns]), s->row, s->num_columns * sizeof(union output_cell));
+	s->current->num_rows++;
+	s->row_length = 0;
+
+	if(s->current->num_rows == s->row_group_size){
+		struct output_row_group* const group = s->current;
+		s->current = NULL;
+		return output_enqueue(s, group);
+	}
+	return 0;
+
+	malloc_fail:
+	perror("malloc failed\n");
+	output_discard_row(s);
+	output_set_failed(s);
+	return 1;
+}
+
+// hands over the complete rows, even if their group is not full, and waits until they are in the file; *size is where a resumed stream starts over
+int32_t output_stream_sync(struct output_stream* const s, int64_t* const size){
+	if(s->f == NULL){return 1;}
+	if(s->current != NULL){
+		struct output_row_group* const group = s->current;
+		s->current = NULL;
+		output_enqueue(s, group);
+	}
+
+	pthread_mutex_lock(&(s->mutex));
+	while((s->queue_head != NULL || s->writing) && s->status == 0){pthread_cond_wait(&(s->cond_not_full), &(s->mutex));}
+	const int32_t status = s->status;
+	pthread_mutex_unlock(&(s->mutex));
+	if(status != 0){return 1;}
+
+	// the writer thread stays idle until the next group
+	if(fflush(s->f) != 0){return 1;}
+	const long position = ftell(s->f);
+	if(position < 0){return 1;}
+	*size = s->preamble_written ? (int64_t) position : 0;
+	return 0;
+}
+
+// hands over the last rows, waits for the writer thread and closes the file; a row left unfinished is dropped
+int32_t output_stream_finish(struct output_stream* const s){
+	int32_t result = 0;
+
+	if(s->f == NULL){return 1;}
+	if(s->row_length > 0){output_discard_row(s);}
+	if(s->current != NULL){
+		struct output_row_group* const group = s->current;
+		s->current = NULL;
+		output_enqueue(s, group);
+	}
+
+	pthread_mutex_lock(&(s->mutex));
+	s->closing = 1;
+	pthread_cond_signal(&(s->cond_not_empty));
+	pthread_mutex_unlock(&(s->mutex));
+	if(pthread_join(s->writer, NULL) != 0){
+		perror("failed to join output writer thread\n");
+		result = 1;
+	}
+
+	if(s->status != 0){result = 1;}
+	if(result == 0 && !(s->preamble_written) && output_write_preamble(s) != 0){result = 1;}
+	if(result == 0 && s->format == OUTPUT_FORMAT_COLUMNAR){
+		const uint8_t end[4] = {0};
+		if(fwrite(end, 1, 4, s->f) != 4){result = 1;}
+	}
+	if(fclose(s->f) != 0){result = 1;}
+	s->f = NULL;
+
+	return result;
+}
+
+void free_output_stream(struct output_stream* const s){
+	if(s->f != NULL){output_stream_finish(s);}
+	output_discard_row(s);
+	free(s->row);
+	free(s->row_types);
+	free(s->header);
+	free(s->types);
+	pthread_cond_destroy(&(s->cond_not_full));
+	pthread_cond_destroy(&(s->cond_not_empty));
+	pthread_mutex_destroy(&(s->mutex));
+	memset(s, '\0', sizeof(struct output_stream));
+}
+
+/* ======== CONVERSION ======== */
+
+static int32_t output_read_le(FILE* const f, uint64_t* const value, const uint32_t num_bytes){
+	uint8_t bytes[8];
+	if(fread(bytes, 1, num_bytes, f) != num_bytes){return 1;}
+	*value = 0;
+	for(uint32_t k = 0 ; k < num_bytes ; k++){*value |= ((uint64_t) bytes[k]) << (8 * k);}
+	return 0;
+}
+
+static int32_t output_read_varint(FILE* const f, uint64_t* const value){
+	*value = 0;
+	for(uint32_t shift = 0 ; shift < 64 ; shift += 7){
+		const int c = fgetc(f);
+		if(c == EOF){return 1;}
+		*value |= ((uint64_t) (c & 0x7f)) << shift;
+		if(!(c & 0x80)){return 0;}
+	}
+	return 1;
+}
+
+static int32_t output_read_string(FILE* const f, const uint64_t length, char** const value){
+	*value = malloc(length + 1);
+	if(*value == NULL){return 1;}
+	if(length > 0 && fread(*value, 1, length, f) != length){free(*value); *value = NULL; return 1;}
+	(*value)[length] = '\0';
+	return 0;
+}
+
+static int32_t output_decode_row_group(FILE* const f, const uint8_t* const types, const uint32_t num_columns, const uint8_t compression, union output_cell* const cells, const uint32_t num_rows){
+	for(uint32_t c = 0 ; c < num_columns ; c++){
+		uint64_t previous = 0;
+		for(uint32_t r = 0 ; r < num_rows ; r++){
+			union output_cell* const cell = &(cells[r * num_columns + c]);
+			uint64_t value;
+			switch(types[c]){
+				case OUTPUT_TYPE_UINT64:
+				case OUTPUT_TYPE_INT64:
+					if(compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						if(output_read_varint(f, &value) != 0){return 1;}
+						previous += (uint64_t) output_unzigzag(value);
+						cell->u = previous;
+					} else {
+						if(output_read_le(f, &(cell->u), 8) != 0){return 1;}
+					}
+					break;
+				case OUTPUT_TYPE_DOUBLE:
+					if(compression == OUTPUT_COMPRESSION_DELTA_XOR){
+						uint64_t num_bytes;
+						if(output_read_le(f, &num_bytes, 1) != 0 || num_bytes > 8){return 1;}
+						if(output_read_le(f, &value, (uint32_t) num_bytes) != 0){return 1;}
+						previous ^= value;
+					} else {
+						if(output_read_le(f, &previous, 8) != 0){return 1;}
+					}
+					memcpy(&(cell->d), &previous, sizeof(double));
+					break;
+				case OUTPUT_TYPE_LONG_DOUBLE:
+					if(fread(&(cell->ld), 1, sizeof(long double), f) != sizeof(long double)){return 1;}
+					break;
+				case OUTPUT_TYPE_STRING:
+					cell->s = NULL;
+					if(output_read_varint(f, &value) != 0){return 1;}
+					if(compression == OUTPUT_COMPRESSION_DELTA_XOR && value == 0){
+						if(r == 0){return 1;}
+						cell->s = output_copy_string(cells[(r - 1) * num_columns + c].s);
+						if(cell->s == NULL){return 1;}
+					} else {
+						if(compression == OUTPUT_COMPRESSION_DELTA_XOR){value--;}
+						if(output_read_string(f, value, &(cell->s)) != 0){return 1;}
+					}
+					break;
+				default:
+					return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+// writes back the TSV file that the same rows would have produced with OUTPUT_FORMAT_TSV
+int32_t output_columnar_to_tsv(FILE* const f_in, FILE* const f_out){
+	char magic[OUTPUT_COLUMNAR_MAGIC_SIZE];
+	uint64_t compression, long_double_size, row_group_size, header_size, num_columns;
+	char* header = NULL;
+	uint8_t* types = NULL;
+	union output_cell* cells = NULL;
+	int32_t result = 1;
+
+	if(fread(magic, 1, OUTPUT_COLUMNAR_MAGIC_SIZE, f_in) != OUTPUT_COLUMNAR_MAGIC_SIZE || memcmp(magic, OUTPUT_COLUMNAR_MAGIC, OUTPUT_COLUMNAR_MAGIC_SIZE) != 0){
+		perror("not a columnar output file\n");
+		return 1;
+	}
+	if(output_read_le(f_in, &compression, 1) != 0 || output_read_le(f_in, &long_double_size, 1) != 0 || output_read_le(f_in, &row_group_size, 4) != 0 || output_read_le(f_in, &header_size, 8) != 0){goto truncated;}
+	if(long_double_size != sizeof(long double)){
+		perror("columnar output file written with another long double layout\n");
+		return 1;
+	}
+	if(output_read_string(f_in, header_size, &header) != 0){goto truncated;}
+	if(header_size > 0 && fwrite(header, 1, header_size, f_out) != header_size){goto write_failure;}
+	if(output_read_le(f_in, &num_columns, 4) != 0){goto truncated;}
+	if(num_columns > 0){
+		types = malloc(num_columns);
+		if(types == NULL || fread(types, 1, num_columns, f_in) != num_columns){goto truncated;}
+	}
+	if(row_group_size == 0){row_group_size = 1;}
+	cells = malloc(row_group_size * num_columns * sizeof(union output_cell) + 1);
+	if(cells == NULL){goto truncated;}
+
+	while(1){
+		uint64_t num_rows;
+		if(output_read_le(f_in, &num_rows, 4) != 0){goto truncated;}
+		if(num_rows == 0){break;}
+		if(num_rows > row_group_size){goto truncated;}
+		memset(cells, '\0', num_rows * num_columns * sizeof(union output_cell));
+		const int32_t err = output_decode_row_group(f_in, types, (uint32_t) num_columns, (uint8_t) compression, cells, (uint32_t) num_rows);
+		if(err == 0 && output_write_tsv(f_out, types, (uint32_t) num_columns, cells, (uint32_t) num_rows) != 0){
+			output_free_cells(types, (uint32_t) num_columns, cells, (uint32_t) num_rows);
+			goto write_failure;
+		}
+		output_free_cells(types, (uint32_t) num_columns, cells, (uint32_t) num_rows);
+		if(err != 0){goto truncated;}
+	}
+	result = 0;
+	goto cleanup;
+
+	truncated:
+	perror("truncated or corrupted columnar output file\n");
+	goto cleanup;
+
+	write_failure:
+	perror("failed to write TSV file\n");
+
+	cleanup:
+	free(cells);
+	free(types);
+	free(header);
+	return result;
+}
@@ -0,0 +1,219 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "measurement.h"
+#include "recompute.h"
+#include "snapshot.h"
+
+static int32_t recompute_worker_run(struct recompute_worker* const w, const struct recompute_job* const job){
+	// nodes below job->num_nodes are never moved nor given another vector, so only the counts had to be captured
+	memcpy(w->view.chunks, job->chunks, GRAPH_NUM_CHUNKS * sizeof(struct graph_node*));
+	w->view.num_nodes = job->num_nodes;
+	if(graph_snapshot_refresh_from_counts(&(w->view), job->counts, 0, w->mcfg->threading.num_matrix_threads) != 0){
+		perror("failed to call graph_snapshot_refresh_from_counts\n");
+		return 1;
+	}
+
+	w->mmut.num_oov_types = job->num_oov_types;
+	w->mmut.sentence = job->sentence;
+	w->mmut.document = job->document;
+	if(measurement_recompute_step(job->i, w->mcfg, &(w->sref), &(w->mmut), job->force) != 0){
+		perror("failed to call measurement_recompute_step\n");
+		return 1;
+	}
+	return 0;
+}
+
+static void* recompute_worker_thread(void* args){
+	struct recompute_worker* const w = (struct recompute_worker*) args;
+
+	while(1){
+		pthread_mutex_lock(&(w->mutex));
+		while(w->num_jobs == 0 && !(w->stop)){
+			pthread_cond_wait(&(w->cond_not_empty), &(w->mutex));
+		}
+		if(w->num_jobs == 0){
+			pthread_mutex_unlock(&(w->mutex));
+			break;
+		}
+		const struct recompute_job job = w->jobs[w->head];
+		w->head = (w->head + 1) % w->capacity;
+		w->num_jobs--;
+		w->busy = 1;
+		const int32_t status = w->status;
+		pthread_cond_signal(&(w->cond_not_full));
+		pthread_mutex_unlock(&(w->mutex));
+
+		// after a failure, the remaining steps are dropped so that the readers are never left waiting
+		const int32_t failed = status == 0 && recompute_worker_run(w, &job) != 0;
+		free(job.counts);
+
+		pthread_mutex_lock(&(w->mutex));
+		if(failed){w->status = 1;}
+		w->busy = 0;
+		pthread_cond_broadcast(&(w->cond_not_full)); // recompute_worker_drain waits for the worker to be idle
+		pthread_mutex_unlock(&(w->mutex));
+	}
+
+	return NULL;
+}
+
+// the worker takes over sref->mst and sref->heap, and starts from the zipfian fit and node count found in mmut
+int32_t create_recompute_worker(struct recompute_worker* const w, struct measurement_configuration* const mcfg, const struct measurement_structure_references* const sref, const struct measurement_mutables* const mmut, const uint32_t capacity){
+	memset(w, '\0', sizeof(struct recompute_worker));
+	w->mcfg = mcfg;
+	w->capacity = capacity < 1 ? 1 : capacity;
+	w->view.dist_mat = (struct matrix) { .fp_mode = FP32, };
+
+	const struct measurement_structure_references local_sref = {
+		.g = &(w->view),
+		.mst = sref->mst,
+		.heap = sref->heap,
+		.w2v = sref->w2v,
+		.oov_discarded_because_not_in_vector_database = NULL,
+		.recompute = NULL,
+		.schedule = sref->schedule,
+		.checkpoint = NULL,
+		.step_hook = sref->step_hook,
+	};
+	memcpy(&(w->sref), &local_sref, sizeof(struct measurement_structure_references));
+
+	w->mmut.best_s = mmut->best_s;
+	w->mmut.prev_best_s = mmut->prev_best_s;
+	w->mmut.prev_num_nodes = mmut->prev_num_nodes;
+	w->mmut.mst_initialised = mmut->mst_initialised;
+
+	w->jobs = (struct recompute_job*) malloc(w->capacity * sizeof(struct recompute_job));
+	if(w->jobs == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	if(pthread_mutex_init(&(w->view.mutex_nodes), NULL) != 0 || pthread_mutex_init(&(w->view.mutex_matrix), NULL) != 0 || pthread_mutex_init(&(w->mmut.mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		free(w->jobs);
+		return 1;
+	}
+	if(pthread_mutex_init(&(w->mutex), NULL) != 0 || pthread_cond_init(&(w->cond_not_empty), NULL) != 0 || pthread_cond_init(&(w->cond_not_full), NULL) != 0){
+		perror("failed to initialise the recompute queue\n");
+		free(w->jobs);
+		return 1;
+	}
+	if(pthread_create(&(w->thread), NULL, recompute_worker_thread, w) != 0){
+		perror("failed to call pthread_create\n");
+		free(w->jobs);
+		return 1;
+	}
+
+	return 0;
+}
+
+// called by a reader holding g->mutex_nodes, so that neither nodes nor counts change while they are copied; blocks while the queue is full
+int32_t recompute_worker_submit(struct recompute_worker* const w, const uint64_t i, const struct graph* const g, const struct measurement_mutables* const mmut, const int64_t num_oov_types, const uint8_t force){
+	struct recompute_job job = {
+		.num_nodes = g->num_nodes,
+		.i = i,
+		.num_oov_types = num_oov_types,
+		.sentence = mmut->sentence,
+		.document = mmut->document,
+		.force = force,
+	};
+	memcpy(job.chunks, g->chunks, GRAPH_NUM_CHUNKS * sizeof(struct graph_node*));
+	job.counts = (uint64_t*) malloc((job.num_nodes > 0 ? job.num_nodes : 1) * sizeof(uint64_t));
+	if(job.counts == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	for(uint64_t k = 0 ; k < job.num_nodes ; k++){
+		job.counts[k] = __atomic_load_n(&(graph_node_at(g, k)->absolute_proportion), __ATOMIC_RELAXED);
+	}
+
+	pthread_mutex_lock(&(w->mutex));
+	while(w->num_jobs == w->capacity && w->status == 0){
+		pthread_cond_wait(&(w->cond_not_full), &(w->mutex));
+	}
+	if(w->status != 0){
+		pthread_mutex_unlock(&(w->mutex));
+		free(job.counts);
+		perror("a previous recompute step failed\n");
+		return 1;
+	}
+	w->jobs[(w->head + w->num_jobs) % w->capacity] = job;
+	w->num_jobs++;
+	pthread_cond_signal(&(w->cond_not_empty));
+	pthread_mutex_unlock(&(w->mutex));
+
+	return 0;
+}
+
+// waits until every submitted step is computed, leaving the thread running; returns 1 if any step failed
+int32_t recompute_worker_drain(struct recompute_worker* const w){
+	pthread_mutex_lock(&(w->mutex));
+	while((w->num_jobs > 0 || w->busy) && w->status == 0){
+		pthread_cond_wait(&(w->cond_not_full), &(w->mutex));
+	}
+	const int32_t status = w->status;
+	pthread_mutex_unlock(&(w->mutex));
+	return status;
+}
+
+// waits for every submitted step, then stops the thread; returns 1 if any step failed
+int32_t recompute_worker_finish(struct recompute_worker* const w){
+	pthread_mutex_lock(&(w->mutex));
+	w->stop = 1;
+	pthread_cond_signal(&(w->cond_not_empty));
+	pthread_mutex_unlock(&(w->mutex));
+
+	if(pthread_join(w->thread, NULL) != 0){
+		perror("failed to call pthread_join\n");
+		return 1;
+	}
+	return w->status;
+}
+
+// the nodes belong to the live graph and are left alone
+void free_recompute_worker(struct recompute_worker* const w){
+	free(w->jobs);
+	w->jobs = NULL;
+	free_graph_snapshot(&(w->view.snapshot));
+	if(w->view.dist_mat_must_be_freed){
+		free_matrix(&(w->view.dist_mat));
+		w->view.dist_mat_must_be_freed = 0;
+	}
+	pthread_mutex_destroy(&(w->view.mutex_nodes));
+	pthread_mutex_destroy(&(w->view.mutex_matrix));
+	pthread_mutex_destroy(&(w->mmut.mutex));
+	pthread_mutex_destroy(&(w->mutex));
+	pthread_cond_destroy(&(w->cond_not_empty));
+	pthread_cond_destroy(&(w->cond_not_full));
+}
@@ -0,0 +1,220 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for clock_gettime
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <time.h>
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "schedule.h"
+
+static const double recompute_schedule_prior_exponents[RECOMPUTE_COST_NUM_FUNCTIONS] = {
+	[RECOMPUTE_COST_FIT] = 1.0,
+	[RECOMPUTE_COST_DISPARITY] = 2.0,
+	[RECOMPUTE_COST_NON_DISPARITY] = 1.0,
+};
+
+static void power_law_observe(struct recompute_power_law* const p, const double x, const double y){
+	if(x <= 0.0 || y <= 0.0){return;}
+	const double lx = log(x);
+	const double ly = log(y);
+	p->sum_x += lx;
+	p->sum_y += ly;
+	p->sum_xx += lx * lx;
+	p->sum_xy += lx * ly;
+	p->num_observations++;
+}
+
+static double power_law_exponent(const struct recompute_power_law* const p){
+	if(p->num_observations < 2){return p->prior_exponent;}
+	const double n = (double) p->num_observations;
+	const double denominator = n * p->sum_xx - p->sum_x * p->sum_x;
+	// every observation at the same x
+	if(denominator <= 1e-9 * n * p->sum_xx){return p->prior_exponent;}
+	double exponent = (n * p->sum_xy - p->sum_x * p->sum_y) / denominator;
+	if(exponent < 0.0){exponent = 0.0;}
+	if(exponent > RECOMPUTE_SCHEDULE_MAX_EXPONENT){exponent = RECOMPUTE_SCHEDULE_MAX_EXPONENT;}
+	return exponent;
+}
+
+static double power_law_evaluate(const struct recompute_power_law* const p, const double x){
+	if(p->num_observations == 0 || x <= 0.0){return 0.0;}
+	const double exponent = power_law_exponent(p);
+	const double log_coefficient = (p->sum_y - exponent * p->sum_x) / ((double) p->num_observations);
+	return exp(log_coefficient + exponent * log(x));
+}
+
+static void create_recompute_schedule_progress(struct recompute_schedule_progress* const p){
+	memset(p, '\0', sizeof(struct recompute_schedule_progress));
+	// every unit bringing new types, until the vocabulary growth is measured
+	p->growth.prior_exponent = 1.0;
+	p->ingest_ns_per_unit = -1.0;
+}
+
+int32_t create_recompute_schedule(struct recompute_schedule* const s, const uint32_t enabled_functions, const double compute_fraction, const uint64_t min_step, const uint64_t max_step, const uint8_t deterministic){
+	memset(s, '\0', sizeof(struct recompute_schedule));
+	for(int32_t k = 0 ; k < RECOMPUTE_COST_NUM_FUNCTIONS ; k++){
+		s->costs[k].prior_exponent = recompute_schedule_prior_exponents[k];
+	}
+	create_recompute_schedule_progress(&(s->sentence));
+	create_recompute_schedule_progress(&(s->document));
+	s->enabled_functions = enabled_functions;
+	s->compute_fraction = compute_fraction;
+	s->min_step = min_step < 1 ? 1 : min_step;
+	s->max_step = max_step;
+	s->deterministic = deterministic;
+
+	if(pthread_mutex_init(&(s->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		return 1;
+	}
+	return 0;
+}
+
+int64_t recompute_schedule_now(void){
+	struct timespec ts;
+	if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0){return 0;}
+	return ((int64_t) ts.tv_sec) * 1000000000 + (int64_t) ts.tv_nsec;
+}
+
+// called by whichever thread computed the step; ignored in deterministic mode, where costs are the declared complexities
+void recompute_schedule_observe_compute(struct recompute_schedule* const s, const int32_t function, const uint64_t num_nodes, const int64_t ns){
+	if(s->deterministic){return;}
+	pthread_mutex_lock(&(s->mutex));
+	power_law_observe(&(s->costs[function]), (double) num_nodes, (double) ns);
+	s->compute_ns += ns;
+	pthread_mutex_unlock(&(s->mutex));
+}
+
+static double recompute_schedule_cost_locked(const struct recompute_schedule* const s, const double num_nodes){
+	double cost = 0.0;
+	for(int32_t k = 0 ; k < RECOMPUTE_COST_NUM_FUNCTIONS ; k++){
+		if(!(s->enabled_functions & (1u << k))){continue;}
+		if(s->deterministic){
+			cost += RECOMPUTE_SCHEDULE_VIRTUAL_NS_PER_NODE * pow(num_nodes, s->costs[k].prior_exponent);
+		} else {
+			cost += power_law_evaluate(&(s->costs[k]), num_nodes);
+		}
+	}
+	return cost;
+}
+
+// predicted ns for a step on num_nodes nodes
+double recompute_schedule_cost(struct recompute_schedule* const s, const double num_nodes){
+	pthread_mutex_lock(&(s->mutex));
+	const double cost = recompute_schedule_cost_locked(s, num_nodes);
+	pthread_mutex_unlock(&(s->mutex));
+	return cost;
+}
+
+// whether a step after delta more units costs at most the share of wall time allowed by compute_fraction
+static int32_t recompute_schedule_fits(const struct recompute_schedule* const s, const struct recompute_schedule_progress* const p, const uint64_t units, const uint64_t delta){
+	const double num_nodes = power_law_evaluate(&(p->growth), (double) (units + delta));
+	const double ratio = s->compute_fraction / (1.0 - s->compute_fraction);
+	return recompute_schedule_cost_locked(s, num_nodes) <= ratio * p->ingest_ns_per_unit * ((double) delta);
+}
+
+// called when a step is taken at units; returns the number of units at which the next step should be taken,
+// rounded up to the next 10^(k * log10_spacing) when log10_spacing > 0
+uint64_t recompute_schedule_next(struct recompute_schedule* const s, struct recompute_schedule_progress* const p, const uint64_t units, const uint64_t num_nodes, const int64_t now_ns, const uint8_t compute_on_reader, const double log10_spacing){
+	uint64_t delta;
+
+	pthread_mutex_lock(&(s->mutex));
+
+	power_law_observe(&(p->growth), (double) units, (double) num_nodes);
+
+	if(s->deterministic){
+		p->ingest_ns_per_unit = RECOMPUTE_SCHEDULE_VIRTUAL_NS_PER_UNIT;
+	} else if(p->last_ns != 0 && units > p->last_units){
+		// steps computed by the reader are not ingestion time
+		int64_t elapsed = now_ns - p->last_ns;
+		if(compute_on_reader){elapsed -= s->compute_ns - p->last_compute_ns;}
+		if(elapsed < 1){elapsed = 1;}
+		const double rate = ((double) elapsed) / ((double) (units - p->last_units));
+		p->ingest_ns_per_unit = p->ingest_ns_per_unit < 0.0 ? rate : RECOMPUTE_SCHEDULE_INGEST_SMOOTHING * rate + (1.0 - RECOMPUTE_SCHEDULE_INGEST_SMOOTHING) * p->ingest_ns_per_unit;
+	}
+	p->last_units = units;
+	p->last_ns = now_ns;
+	p->last_compute_ns = s->compute_ns;
+
+	const uint64_t min_step = s->min_step;
+	const uint64_t max_step = s->max_step > 0 ? (s->max_step > min_step ? s->max_step : min_step) : (units > min_step ? units : min_step);
+	uint8_t has_costs = s->deterministic;
+	for(int32_t k = 0 ; k < RECOMPUTE_COST_NUM_FUNCTIONS ; k++){
+		if((s->enabled_functions & (1u << k)) && s->costs[k].num_observations > 0){has_costs = 1;}
+	}
+
+	if(!has_costs || p->ingest_ns_per_unit <= 0.0 || s->compute_fraction >= 1.0 || recompute_schedule_fits(s, p, units, min_step)){
+		// nothing to go by yet, or already cheap enough
+		delta = min_step;
+	} else if(s->compute_fraction <= 0.0){
+		delta = max_step;
+	} else {
+		// doubling up to a step that fits, then bisection down to the smallest one
+		uint64_t low = min_step;
+		uint64_t high = min_step;
+		uint8_t found = 0;
+		while(high < max_step){
+			high = high * 2 < max_step ? high * 2 : max_step;
+			if(recompute_schedule_fits(s, p, units, high)){found = 1; break;}
+			low = high;
+		}
+		if(found){
+			while(high - low > 1){
+				const uint64_t middle = low + (high - low) / 2;
+				if(recompute_schedule_fits(s, p, units, middle)){high = middle;} else {low = middle;}
+			}
+		}
+		delta = high;
+	}
+
+	pthread_mutex_unlock(&(s->mutex));
+
+	uint64_t target = units + delta;
+	if(log10_spacing > 0.0){
+		double k = ceil(log10((double) target) / log10_spacing);
+		uint64_t snapped = (uint64_t) floor(pow(10.0, k * log10_spacing));
+		while(snapped < target){
+			k += 1.0;
+			snapped = (uint64_t) floor(pow(10.0, k * log10_spacing));
+		}
+		target = snapped;
+	}
+	return target;
+}
+
+void free_recompute_schedule(struct recompute_schedule* const s){
+	pthread_mutex_destroy(&(s->mutex));
+}
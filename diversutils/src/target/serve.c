@@ -0,0 +1,913 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GNU_SOURCE
+// for struct ucred and SO_PEERCRED in sys/socket.h
+#define _GNU_SOURCE
+#endif
+
+#ifndef _POSIX_C_SOURCE
+// for clock_gettime, lstat and the sockets
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logging.h"
+#include "serve.h"
+
+static char* serve_strdup(const char* const s, const size_t n){
+	char* const copy = (char*) malloc(n + 1);
+	if(copy == NULL){return NULL;}
+	memcpy(copy, s, n);
+	copy[n] = '\0';
+	return copy;
+}
+
+static void free_serve_job(struct serve_job* const job){
+	free(job->id);
+	free(job->input_path);
+	free(job->input_path_tp);
+	free(job->output_path);
+	free(job->output_path_timing);
+	free(job->output_path_memory);
+	for(int32_t k = 0 ; k < job->num_functions ; k++){free(job->functions[k]);}
+	free(job->functions);
+	free(job);
+}
+
+// ----------------
+// request parsing
+// ----------------
+
+struct serve_parser {
+	const char* start;
+	const char* p;
+	char* error; // SERVE_ERROR_SIZE bytes
+};
+
+static void serve_parser_space(struct serve_parser* const r){
+	while(*(r->p) == ' ' || *(r->p) == '\t' || *(r->p) == '\r' || *(r->p) == '\n'){r->p++;}
+}
+
+static int32_t serve_parser_expect(struct serve_parser* const r, const char c){
+	serve_parser_space(r);
+	if(*(r->p) != c){
+		snprintf(r->error, SERVE_ERROR_SIZE, "expected '%c' at offset %li", c, (long) (r->p - r->start));
+		return 1;
+	}
+	r->p++;
+	return 0;
+}
+
+static int32_t serve_parse_hex4(const char* const p, uint32_t* const c){
+	*c = 0;
+	for(int32_t k = 0 ; k < 4 ; k++){
+		const char h = p[k];
+		*c <<= 4;
+		if(h >= '0' && h <= '9'){*c |= (uint32_t) (h - '0');}
+		else if(h >= 'a' && h <= 'f'){*c |= (uint32_t) (h - 'a' + 10);}
+		else if(h >= 'A' && h <= 'F'){*c |= (uint32_t) (h - 'A' + 10);}
+		else {return 1;}
+	}
+	return 0;
+}
+
+static size_t serve_encode_utf8(char* const out, const uint32_t c){
+	if(c < 0x80){out[0] = (char) c; return 1;}
+	if(c < 0x800){out[0] = (char) (0xC0 | (c >> 6)); out[1] = (char) (0x80 | (c & 0x3F)); return 2;}
+	if(c < 0x10000){out[0] = (char) (0xE0 | (c >> 12)); out[1] = (char) (0x80 | ((c >> 6) & 0x3F)); out[2] = (char) (0x80 | (c & 0x3F)); return 3;}
+	out[0] = (char) (0xF0 | (c >> 18)); out[1] = (char) (0x80 | ((c >> 12) & 0x3F)); out[2] = (char) (0x80 | ((c >> 6) & 0x3F)); out[3] = (char) (0x80 | (c & 0x3F));
+	return 4;
+}
+
+// a JSON string, unescaped; no escape makes it longer than it is in the request
+static char* serve_parse_string(struct serve_parser* const r){
+	serve_parser_space(r);
+	if(*(r->p) != '"'){
+		snprintf(r->error, SERVE_ERROR_SIZE, "expected a string");
+		return NULL;
+	}
+	r->p++;
+	const char* end = r->p;
+	while(*end != '\0' && *end != '"'){
+		if(*end == '\\' && end[1] != '\0'){end++;}
+		end++;
+	}
+	if(*end != '"'){
+		snprintf(r->error, SERVE_ERROR_SIZE, "unterminated string");
+		return NULL;
+	}
+	char* const s = (char*) malloc((size_t) (end - r->p) + 1);
+	if(s == NULL){
+		snprintf(r->error, SERVE_ERROR_SIZE, "malloc failed");
+		return NULL;
+	}
+	size_t n = 0;
+	while(*(r->p) != '"'){
+		const char c = *(r->p);
+		if((unsigned char) c < 0x20){
+			snprintf(r->error, SERVE_ERROR_SIZE, "control character in a string");
+			goto failure;
+		}
+		if(c != '\\'){
+			s[n++] = c;
+			r->p++;
+			continue;
+		}
+		r->p++;
+		switch(*(r->p)){
+			case '"': s[n++] = '"'; break;
+			case '\\': s[n++] = '\\'; break;
+			case '/': s[n++] = '/'; break;
+			case 'b': s[n++] = '\b'; break;
+			case 'f': s[n++] = '\f'; break;
+			case 'n': s[n++] = '\n'; break;
+			case 'r': s[n++] = '\r'; break;
+			case 't': s[n++] = '\t'; break;
+			case 'u': {
+				uint32_t code_point;
+				if(serve_parse_hex4(r->p + 1, &code_point) != 0){goto failure_escape;}
+				r->p += 4;
+				if(code_point >= 0xD800 && code_point < 0xDC00){
+					uint32_t low;
+					if(r->p[1] != '\\' || r->p[2] != 'u' || serve_parse_hex4(r->p + 3, &low) != 0 || low < 0xDC00 || low >= 0xE000){goto failure_escape;}
+					r->p += 6;
+					code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+				} else if(code_point >= 0xDC00 && code_point < 0xE000){goto failure_escape;}
+				n += serve_encode_utf8(s + n, code_point);
+				break;
+			}
+			default: goto failure_escape;
+		}
+		r->p++;
+	}
+	r->p++;
+	s[n] = '\0';
+	return s;
+
+	failure_escape:
+	snprintf(r->error, SERVE_ERROR_SIZE, "invalid escape in a string");
+	failure:
+	free(s);
+	return NULL;
+}
+
+static int32_t serve_parse_string_array(struct serve_parser* const r, char*** const values, int32_t* const num_values){
+	int32_t capacity = 0;
+
+	if(serve_parser_expect(r, '[') != 0){return 1;}
+	serve_parser_space(r);
+	if(*(r->p) == ']'){
+		r->p++;
+		return 0;
+	}
+	while(1){
+		if(*num_values == capacity){
+			capacity = capacity == 0 ? 8 : 2 * capacity;
+			char** const grown = (char**) realloc(*values, capacity * sizeof(char*));
+			if(grown == NULL){
+				snprintf(r->error, SERVE_ERROR_SIZE, "malloc failed");
+				return 1;
+			}
+			*values = grown;
+		}
+		char* const value = serve_parse_string(r);
+		if(value == NULL){return 1;}
+		(*values)[(*num_values)++] = value;
+		serve_parser_space(r);
+		if(*(r->p) == ','){r->p++; continue;}
+		if(*(r->p) == ']'){r->p++; return 0;}
+		snprintf(r->error, SERVE_ERROR_SIZE, "expected ',' or ']' in an array");
+		return 1;
+	}
+}
+
+// the id is echoed in every reply: a string, or a number kept as written
+static int32_t serve_parse_id(struct serve_parser* const r, char** const id, uint8_t* const id_is_number){
+	serve_parser_space(r);
+	if(*(r->p) == '"'){
+		*id = serve_parse_string(r);
+		return *id == NULL;
+	}
+	const char* const start = r->p;
+	while((*(r->p) >= '0' && *(r->p) <= '9') || *(r->p) == '-' || *(r->p) == '+' || *(r->p) == '.' || *(r->p) == 'e' || *(r->p) == 'E'){r->p++;}
+	if(r->p == start || (*start != '-' && (*start < '0' || *start > '9'))){
+		snprintf(r->error, SERVE_ERROR_SIZE, "id must be a string or a number");
+		return 1;
+	}
+	*id = serve_strdup(start, (size_t) (r->p - start));
+	if(*id == NULL){
+		snprintf(r->error, SERVE_ERROR_SIZE, "malloc failed");
+		return 1;
+	}
+	*id_is_number = 1;
+	return 0;
+}
+
+static int32_t serve_parse_boolean(struct serve_parser* const r, uint8_t* const value){
+	serve_parser_space(r);
+	if(strncmp(r->p, "true", 4) == 0){*value = 1; r->p += 4; return 0;}
+	if(strncmp(r->p, "false", 5) == 0){*value = 0; r->p += 5; return 0;}
+	snprintf(r->error, SERVE_ERROR_SIZE, "expected true or false");
+	return 1;
+}
+
+// one object per line; {"shutdown": true} stops the server once the queued jobs are done
+static int32_t serve_parse_request(const char* const line, struct serve_job* const job, uint8_t* const shutdown, char* const error){
+	struct serve_parser r = {.start = line, .p = line, .error = error};
+
+	*shutdown = 0;
+	if(serve_parser_expect(&r, '{') != 0){return 1;}
+	serve_parser_space(&r);
+	if(*(r.p) == '}'){
+		r.p++;
+	} else {
+		while(1){
+			char* const key = serve_parse_string(&r);
+			if(key == NULL){return 1;}
+			if(serve_parser_expect(&r, ':') != 0){
+				free(key);
+				return 1;
+			}
+			char** field = NULL;
+			int32_t status = 0;
+			if(strcmp(key, "id") == 0){field = &(job->id);}
+			else if(strcmp(key, "input_path") == 0){field = &(job->input_path);}
+			else if(strcmp(key, "input_path_tp") == 0){field = &(job->input_path_tp);}
+			else if(strcmp(key, "output_path") == 0){field = &(job->output_path);}
+			else if(strcmp(key, "output_path_timing") == 0){field = &(job->output_path_timing);}
+			else if(strcmp(key, "output_path_memory") == 0){field = &(job->output_path_memory);}
+			else if(strcmp(key, "functions") == 0){
+				if(job->functions != NULL){
+					snprintf(error, SERVE_ERROR_SIZE, "duplicate key: functions");
+					status = 1;
+				} else {
+					status = serve_parse_string_array(&r, &(job->functions), &(job->num_functions));
+					// an empty list enables nothing, which is not the same as no list
+					if(status == 0 && job->functions == NULL){job->functions = (char**) malloc(sizeof(char*));}
+				}
+			}
+			else if(strcmp(key, "shutdown") == 0){status = serve_parse_boolean(&r, shutdown);}
+			else {
+				snprintf(error, SERVE_ERROR_SIZE, "unknown key: %.200s", key);
+				status = 1;
+			}
+			if(field != NULL){
+				if(*field != NULL){
+					snprintf(error, SERVE_ERROR_SIZE, "duplicate key: %.200s", key);
+					status = 1;
+				} else if(field == &(job->id)){
+					status = serve_parse_id(&r, field, &(job->id_is_number));
+				} else {
+					*field = serve_parse_string(&r);
+					status = *field == NULL;
+				}
+			}
+			free(key);
+			if(status != 0){return 1;}
+			serve_parser_space(&r);
+			if(*(r.p) == ','){r.p++; continue;}
+			if(*(r.p) == '}'){r.p++; break;}
+			snprintf(error, SERVE_ERROR_SIZE, "expected ',' or '}' in the request");
+			return 1;
+		}
+	}
+	serve_parser_space(&r);
+	if(*(r.p) != '\0'){
+		snprintf(error, SERVE_ERROR_SIZE, "trailing characters after the request");
+		return 1;
+	}
+	return 0;
+}
+
+// --------
+// replies
+// --------
+
+struct serve_reply {
+	char text[SERVE_REPLY_SIZE];
+	size_t len;
+};
+
+// the last two bytes are kept for the closing brace and the newline
+static void serve_reply_format(struct serve_reply* const r, const char* const format, ...){
+	const size_t available = SERVE_REPLY_SIZE - 2 - r->len;
+	va_list args;
+	va_start(args, format);
+	const int written = vsnprintf(r->text + r->len, available, format, args);
+	va_end(args);
+	if(written < 0){return;}
+	r->len += (size_t) written < available ? (size_t) written : available - 1;
+}
+
+static void serve_reply_string(struct serve_reply* const r, const char* const s){
+	if(s == NULL){
+		serve_reply_format(r, "null");
+		return;
+	}
+	serve_reply_format(r, "\"");
+	for(const char* p = s ; *p != '\0' && r->len + 10 < SERVE_REPLY_SIZE ; p++){
+		if(*p == '"' || *p == '\\'){serve_reply_format(r, "\\%c", *p);}
+		else if((unsigned char) *p < 0x20){serve_reply_format(r, "\\u%04x", (unsigned int) (unsigned char) *p);}
+		else {r->text[r->len++] = *p;}
+	}
+	serve_reply_format(r, "\"");
+}
+
+// job is NULL for what cannot be told apart from a request
+static void serve_reply_begin(struct serve_reply* const r, const struct serve_job* const job, const char* const status){
+	r->len = 0;
+	serve_reply_format(r, "{\"id\":");
+	if(job != NULL && job->id_is_number){serve_reply_format(r, "%s", job->id);}
+	else {serve_reply_string(r, job != NULL ? job->id : NULL);}
+	serve_reply_format(r, ",\"status\":\"%s\"", status);
+}
+
+static int32_t serve_write_all(const int32_t fd, const char* const data, const size_t size){
+	size_t done = 0;
+	while(done < size){
+		const ssize_t n = send(fd, data + done, size - done, MSG_NOSIGNAL);
+		if(n < 0 && errno == EINTR){continue;}
+		if(n <= 0){return 1;}
+		done += (size_t) n;
+	}
+	return 0;
+}
+
+// a client gone away loses its replies, but not its jobs; the caller holds c->mutex
+static void serve_reply_write(struct serve_connection* const c, struct serve_reply* const r){
+	r->text[r->len++] = '}';
+	r->text[r->len++] = '\n';
+	serve_write_all(c->fd, r->text, r->len);
+}
+
+static void serve_reply_send(struct serve_connection* const c, struct serve_reply* const r){
+	pthread_mutex_lock(&(c->mutex));
+	serve_reply_write(c, r);
+	pthread_mutex_unlock(&(c->mutex));
+}
+
+void serve_job_file_done(void* const ctx, const char* const filename, const int32_t num_done, const int32_t num_files, const double fraction_of_bytes){
+	struct serve_job* const job = (struct serve_job*) ctx;
+	struct serve_reply reply;
+
+	serve_reply_begin(&reply, job, "progress");
+	serve_reply_format(&reply, ",\"file\":");
+	serve_reply_string(&reply, filename);
+	serve_reply_format(&reply, ",\"num_done\":%i,\"num_files\":%i,\"fraction_of_bytes\":%.6f", num_done, num_files, fraction_of_bytes);
+	serve_reply_send(job->connection, &reply);
+}
+
+// ------------
+// connections
+// ------------
+
+static void serve_connection_release(struct serve_connection* const c){
+	struct serve* const s = c->server;
+
+	pthread_mutex_lock(&(s->mutex));
+	c->num_references--;
+	const uint8_t last = c->num_references == 0;
+	if(last){
+		struct serve_connection** p = &(s->connections);
+		while(*p != c){p = &((*p)->next);}
+		*p = c->next;
+		s->num_connections--;
+		pthread_cond_broadcast(&(s->cond_connections));
+	}
+	pthread_mutex_unlock(&(s->mutex));
+
+	if(last){
+		close(c->fd);
+		pthread_mutex_destroy(&(c->mutex));
+		free(c);
+	}
+}
+
+// the "queued" reply is written before a worker can write "running", since both need c->mutex
+static void serve_submit(struct serve_connection* const c, struct serve_job* const job){
+	struct serve* const s = c->server;
+	struct serve_reply reply;
+	uint8_t accepted = 0;
+
+	job->connection = c;
+	pthread_mutex_lock(&(c->mutex));
+	pthread_mutex_lock(&(s->mutex));
+	if(s->stopping){
+		serve_reply_begin(&reply, job, "rejected");
+		serve_reply_format(&reply, ",\"error\":\"the server is shutting down\"");
+	} else if(s->num_queued >= s->queue_size){
+		serve_reply_begin(&reply, job, "rejected");
+		serve_reply_format(&reply, ",\"error\":\"the queue is full\",\"queue_size\":%i", s->queue_size);
+	} else {
+		s->queue[(s->queue_head + s->num_queued) % s->queue_size] = job;
+		s->num_queued++;
+		c->num_references++;
+		accepted = 1;
+		serve_reply_begin(&reply, job, "queued");
+		serve_reply_format(&reply, ",\"position\":%i", s->num_queued);
+		pthread_cond_signal(&(s->cond_queue));
+	}
+	pthread_mutex_unlock(&(s->mutex));
+	serve_reply_write(c, &reply);
+	pthread_mutex_unlock(&(c->mutex));
+
+	if(!accepted){free_serve_job(job);}
+}
+
+static void serve_handle_line(struct serve_connection* const c, const char* const line){
+	struct serve* const s = c->server;
+	struct serve_reply reply;
+	uint8_t shutdown = 0;
+
+	const char* p = line;
+	while(*p == ' ' || *p == '\t' || *p == '\r'){p++;}
+	if(*p == '\0'){return;}
+
+	struct serve_job* const job = (struct serve_job*) calloc(1, sizeof(struct serve_job));
+	if(job == NULL){
+		perror("malloc failed\n");
+		serve_reply_begin(&reply, NULL, "error");
+		serve_reply_format(&reply, ",\"error\":\"malloc failed\"");
+		serve_reply_send(c, &reply);
+		return;
+	}
+	if(serve_parse_request(line, job, &shutdown, job->error) != 0){
+		serve_reply_begin(&reply, job, "error");
+		serve_reply_format(&reply, ",\"error\":");
+		serve_reply_string(&reply, job->error);
+		serve_reply_send(c, &reply);
+		free_serve_job(job);
+		return;
+	}
+	if(shutdown){
+		pthread_mutex_lock(&(s->mutex));
+		s->stopping = 1;
+		const int32_t num_queued = s->num_queued;
+		pthread_cond_broadcast(&(s->cond_queue));
+		pthread_mutex_unlock(&(s->mutex));
+		info_format(__FILE__, __func__, __LINE__, "shutdown requested; the queued jobs still run");
+		serve_reply_begin(&reply, job, "shutting_down");
+		serve_reply_format(&reply, ",\"num_queued\":%i", num_queued);
+		serve_reply_send(c, &reply);
+		free_serve_job(job);
+		return;
+	}
+	if(job->input_path == NULL || job->output_path == NULL){
+		serve_reply_begin(&reply, job, "error");
+		serve_reply_format(&reply, ",\"error\":\"a job needs an input_path and an output_path\"");
+		serve_reply_send(c, &reply);
+		free_serve_job(job);
+		return;
+	}
+	// a job the server cannot run is answered now, before it takes a place in the queue
+	if(s->check != NULL && s->check(job, s->arg) != 0){
+		serve_reply_begin(&reply, job, "error");
+		serve_reply_format(&reply, ",\"error\":");
+		serve_reply_string(&reply, job->error);
+		serve_reply_send(c, &reply);
+		free_serve_job(job);
+		return;
+	}
+	serve_submit(c, job);
+}
+
+// one request per line; a line too long for the buffer is answered with an error and skipped
+static void* serve_connection_thread(void* arg){
+	struct serve_connection* const c = (struct serve_connection*) arg;
+	char bfr[4096];
+	size_t len = 0;
+	uint8_t overflow = 0;
+
+	char* const line = (char*) malloc(SERVE_LINE_SIZE);
+	if(line == NULL){
+		perror("malloc failed\n");
+		serve_connection_release(c);
+		return NULL;
+	}
+	while(1){
+		const ssize_t n = recv(c->fd, bfr, sizeof(bfr), 0);
+		if(n < 0 && errno == EINTR){continue;}
+		if(n <= 0){break;}
+		for(ssize_t k = 0 ; k < n ; k++){
+			if(bfr[k] != '\n'){
+				if(len + 1 < SERVE_LINE_SIZE){line[len++] = bfr[k];}
+				else {overflow = 1;}
+				continue;
+			}
+			if(overflow){
+				struct serve_reply reply;
+				serve_reply_begin(&reply, NULL, "error");
+				serve_reply_format(&reply, ",\"error\":\"request longer than %i bytes\"", SERVE_LINE_SIZE - 1);
+				serve_reply_send(c, &reply);
+			} else {
+				line[len] = '\0';
+				serve_handle_line(c, line);
+			}
+			len = 0;
+			overflow = 0;
+		}
+	}
+	if(len > 0 && !overflow){
+		line[len] = '\0';
+		serve_handle_line(c, line);
+	}
+	free(line);
+	serve_connection_release(c);
+	return NULL;
+}
+
+// only the user the server runs as may submit jobs, which read and write files with its rights
+static int32_t serve_check_peer(const int32_t fd){
+	#ifdef SO_PEERCRED
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+	struct ucred credentials;
+	socklen_t length = sizeof(struct ucred);
+
+	if(getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0){
+		perror("failed to call getsockopt\n");
+		return 1;
+	}
+	if(credentials.uid != geteuid()){
+		memset(log_bfr, '\0', log_bfr_size);
+		snprintf(log_bfr, log_bfr_size, "rejected a connection from uid %u (process %i)", (unsigned int) credentials.uid, (int) credentials.pid);
+		warning_format(__FILE__, __func__, __LINE__, log_bfr);
+		return 1;
+	}
+	#else
+	(void) fd;
+	#endif
+	return 0;
+}
+
+static int32_t serve_open_connection(struct serve* const s, const int32_t fd){
+	pthread_t thread;
+
+	if(serve_check_peer(fd) != 0){return 1;}
+
+	struct serve_connection* const c = (struct serve_connection*) calloc(1, sizeof(struct serve_connection));
+	if(c == NULL){
+		perror("malloc failed\n");
+		return 1;
+	}
+	if(pthread_mutex_init(&(c->mutex), NULL) != 0){
+		perror("failed to call pthread_mutex_init\n");
+		free(c);
+		return 1;
+	}
+	c->fd = fd;
+	c->num_references = 1;
+	c->server = s;
+
+	pthread_mutex_lock(&(s->mutex));
+	c->next = s->connections;
+	s->connections = c;
+	s->num_connections++;
+	pthread_mutex_unlock(&(s->mutex));
+
+	if(pthread_create(&thread, NULL, serve_connection_thread, c) != 0){
+		perror("failed to call pthread_create\n");
+		c->fd = -1; // closed by the caller
+		serve_connection_release(c);
+		return 1;
+	}
+	pthread_detach(thread);
+	return 0;
+}
+
+// --------
+// workers
+// --------
+
+static void* serve_worker(void* arg){
+	struct serve* const s = (struct serve*) arg;
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+
+	while(1){
+		pthread_mutex_lock(&(s->mutex));
+		while(s->num_queued == 0 && !s->stopping){pthread_cond_wait(&(s->cond_queue), &(s->mutex));}
+		if(s->num_queued == 0){
+			pthread_mutex_unlock(&(s->mutex));
+			break;
+		}
+		struct serve_job* const job = s->queue[s->queue_head];
+		s->queue_head = (s->queue_head + 1) % s->queue_size;
+		s->num_queued--;
+		pthread_mutex_unlock(&(s->mutex));
+
+		struct serve_connection* const c = job->connection;
+		struct serve_reply reply;
+		struct timespec start, end;
+
+		serve_reply_begin(&reply, job, "running");
+		serve_reply_send(c, &reply);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		const int32_t status = s->f(job, s->arg);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		const double seconds = (end.tv_sec - start.tv_sec) + 1e-9 * (end.tv_nsec - start.tv_nsec);
+
+		if(status == 0){
+			serve_reply_begin(&reply, job, "done");
+			serve_reply_format(&reply, ",\"output_path\":");
+			serve_reply_string(&reply, job->output_path);
+		} else {
+			serve_reply_begin(&reply, job, "error");
+			serve_reply_format(&reply, ",\"error\":");
+			serve_reply_string(&reply, job->error[0] != '\0' ? job->error : "the job failed");
+		}
+		serve_reply_format(&reply, ",\"seconds\":%.6f", seconds);
+		serve_reply_send(c, &reply);
+
+		memset(log_bfr, '\0', log_bfr_size);
+		snprintf(log_bfr, log_bfr_size, "job %s %s in %.3fs: %s", job->id != NULL ? job->id : "(no id)", status == 0 ? "done" : "failed", seconds, job->input_path);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+		free_serve_job(job);
+		serve_connection_release(c);
+	}
+	return NULL;
+}
+
+// ------
+// server
+// ------
+
+static int32_t serve_address(struct sockaddr_un* const address, const char* const socket_path){
+	memset(address, '\0', sizeof(struct sockaddr_un));
+	address->sun_family = AF_UNIX;
+	if(strlen(socket_path) >= sizeof(address->sun_path)){
+		error_format(__FILE__, __func__, __LINE__, "socket path too long");
+		return 1;
+	}
+	memcpy(address->sun_path, socket_path, strlen(socket_path));
+	return 0;
+}
+
+// a socket left behind by a server that is gone is replaced; anything else at the path is kept
+static int32_t serve_remove_stale_socket(const char* const socket_path, const struct sockaddr_un* const address){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+	struct stat st;
+
+	if(lstat(socket_path, &st) != 0){
+		if(errno == ENOENT){return 0;}
+		perror("failed to call lstat\n");
+		return 1;
+	}
+	memset(log_bfr, '\0', log_bfr_size);
+	if(!S_ISSOCK(st.st_mode)){
+		snprintf(log_bfr, log_bfr_size, "%s exists and is not a socket", socket_path);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		return 1;
+	}
+	const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0){
+		perror("failed to call socket\n");
+		return 1;
+	}
+	const int32_t in_use = connect(fd, (const struct sockaddr*) address, sizeof(struct sockaddr_un)) == 0;
+	close(fd);
+	if(in_use){
+		snprintf(log_bfr, log_bfr_size, "another server listens on %s", socket_path);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		return 1;
+	}
+	if(unlink(socket_path) != 0){
+		perror("failed to call unlink\n");
+		return 1;
+	}
+	return 0;
+}
+
+int32_t create_serve(struct serve* const s, const char* const socket_path, const int32_t num_workers, const int32_t queue_size, serve_job_function f, serve_check_function check, void* const arg){
+	const int32_t log_bfr_size = 512;
+	char log_bfr[512];
+	struct sockaddr_un address;
+
+	memset(s, '\0', sizeof(struct serve));
+	s->fd = -1;
+	if(num_workers < 1 || queue_size < 1){
+		error_format(__FILE__, __func__, __LINE__, "a server needs at least one worker and a queue of at least one job");
+		return 1;
+	}
+	if(serve_address(&address, socket_path) != 0 || serve_remove_stale_socket(socket_path, &address) != 0){return 1;}
+
+	s->queue = (struct serve_job**) calloc(queue_size, sizeof(struct serve_job*));
+	s->workers = (pthread_t*) calloc(num_workers, sizeof(pthread_t));
+	if(s->queue == NULL || s->workers == NULL){
+		perror("malloc failed\n");
+		free(s->queue);
+		free(s->workers);
+		return 1;
+	}
+	s->queue_size = queue_size;
+	s->f = f;
+	s->check = check;
+	s->arg = arg;
+	if(pthread_mutex_init(&(s->mutex), NULL) != 0 || pthread_cond_init(&(s->cond_queue), NULL) != 0 || pthread_cond_init(&(s->cond_connections), NULL) != 0){
+		perror("failed to initialise the synchronisation of the server\n");
+		free(s->queue);
+		free(s->workers);
+		return 1;
+	}
+
+	s->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(s->fd < 0){
+		perror("failed to call socket\n");
+		goto failure;
+	}
+	// the socket is created with mode SERVE_SOCKET_MODE rather than whatever the umask leaves, so that other users cannot connect
+	const mode_t previous_umask = umask(0777 & ~SERVE_SOCKET_MODE);
+	const int32_t bind_status = bind(s->fd, (const struct sockaddr*) &address, sizeof(struct sockaddr_un));
+	umask(previous_umask);
+	if(bind_status != 0){
+		perror("failed to call bind\n");
+		goto failure;
+	}
+	s->socket_path = serve_strdup(socket_path, strlen(socket_path));
+	if(s->socket_path == NULL){
+		perror("malloc failed\n");
+		unlink(socket_path);
+		goto failure;
+	}
+	if(chmod(socket_path, SERVE_SOCKET_MODE) != 0){
+		perror("failed to call chmod\n");
+		goto failure;
+	}
+	if(listen(s->fd, SOMAXCONN) != 0){
+		perror("failed to call listen\n");
+		goto failure;
+	}
+	for( ; s->num_workers < num_workers ; s->num_workers++){
+		if(pthread_create(&(s->workers[s->num_workers]), NULL, serve_worker, s) != 0){
+			perror("failed to call pthread_create\n");
+			goto failure;
+		}
+	}
+
+	memset(log_bfr, '\0', log_bfr_size);
+	snprintf(log_bfr, log_bfr_size, "listening on %s, %i jobs at a time, up to %i more queued", socket_path, num_workers, queue_size);
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+	return 0;
+
+	failure:
+	free_serve(s);
+	return 1;
+}
+
+// accepts connections until a shutdown request; free_serve then waits for the jobs still queued
+int32_t serve_run(struct serve* const s){
+	struct pollfd pfd = {.fd = s->fd, .events = POLLIN, .revents = 0};
+	int32_t result = 0;
+
+	while(1){
+		pthread_mutex_lock(&(s->mutex));
+		const uint8_t stopping = s->stopping;
+		pthread_mutex_unlock(&(s->mutex));
+		if(stopping){break;}
+
+		const int ready = poll(&pfd, 1, SERVE_POLL_INTERVAL_MS);
+		if(ready < 0 && errno == EINTR){continue;}
+		if(ready < 0){
+			perror("failed to call poll\n");
+			result = 1;
+			break;
+		}
+		if(ready == 0){continue;}
+
+		const int32_t fd = accept(s->fd, NULL, NULL);
+		if(fd < 0){
+			if(errno == EINTR || errno == ECONNABORTED){continue;}
+			perror("failed to call accept\n");
+			result = 1;
+			break;
+		}
+		if(serve_open_connection(s, fd) != 0){close(fd);}
+	}
+	return result;
+}
+
+void free_serve(struct serve* const s){
+	pthread_mutex_lock(&(s->mutex));
+	s->stopping = 1;
+	pthread_cond_broadcast(&(s->cond_queue));
+	pthread_mutex_unlock(&(s->mutex));
+	for(int32_t k = 0 ; k < s->num_workers ; k++){pthread_join(s->workers[k], NULL);}
+
+	// no job is left, so only the readers keep connections open
+	pthread_mutex_lock(&(s->mutex));
+	for(struct serve_connection* c = s->connections ; c != NULL ; c = c->next){shutdown(c->fd, SHUT_RDWR);}
+	while(s->num_connections > 0){pthread_cond_wait(&(s->cond_connections), &(s->mutex));}
+	pthread_mutex_unlock(&(s->mutex));
+
+	if(s->fd >= 0){close(s->fd);}
+	if(s->socket_path != NULL){
+		unlink(s->socket_path);
+		free(s->socket_path);
+	}
+	pthread_cond_destroy(&(s->cond_connections));
+	pthread_cond_destroy(&(s->cond_queue));
+	pthread_mutex_destroy(&(s->mutex));
+	free(s->queue);
+	free(s->workers);
+	memset(s, '\0', sizeof(struct serve));
+	s->fd = -1;
+}
+
+// -------
+// client
+// -------
+
+// sends one request and copies every reply to replies, until the one that ends the request; 0 if it is done
+int32_t serve_request(const char* const socket_path, const char* const request, FILE* const replies){
+	struct sockaddr_un address;
+	char bfr[4096];
+	char line[SERVE_REPLY_SIZE];
+	size_t len = 0;
+	int32_t result = 1;
+
+	if(serve_address(&address, socket_path) != 0){return 1;}
+	const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0){
+		perror("failed to call socket\n");
+		return 1;
+	}
+	if(connect(fd, (const struct sockaddr*) &address, sizeof(struct sockaddr_un)) != 0){
+		fprintf(stderr, "cannot connect to %s\n", socket_path);
+		close(fd);
+		return 1;
+	}
+	const size_t request_size = strlen(request);
+	if(serve_write_all(fd, request, request_size) != 0 || ((request_size == 0 || request[request_size - 1] != '\n') && serve_write_all(fd, "\n", 1) != 0)){
+		perror("failed to send the request\n");
+		close(fd);
+		return 1;
+	}
+
+	while(1){
+		const ssize_t n = recv(fd, bfr, sizeof(bfr), 0);
+		if(n < 0 && errno == EINTR){continue;}
+		if(n <= 0){
+			fprintf(stderr, "the server closed the connection before the end of the request\n");
+			break;
+		}
+		uint8_t finished = 0;
+		for(ssize_t k = 0 ; k < n && !finished ; k++){
+			if(bfr[k] != '\n'){
+				if(len + 1 < SERVE_REPLY_SIZE){line[len++] = bfr[k];}
+				continue;
+			}
+			line[len] = '\0';
+			len = 0;
+			fprintf(replies, "%s\n", line);
+			fflush(replies);
+			// ids are escaped, so that these can only be the status
+			if(strstr(line, "\"status\":\"done\"") != NULL || strstr(line, "\"status\":\"shutting_down\"") != NULL){result = 0; finished = 1;}
+			else if(strstr(line, "\"status\":\"error\"") != NULL || strstr(line, "\"status\":\"rejected\"") != NULL){finished = 1;}
+		}
+		if(finished){break;}
+	}
+	close(fd);
+	return result;
+}
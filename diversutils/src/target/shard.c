@@ -0,0 +1,483 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shard.h"
+
+// ---- file format ----
+
+// every byte goes through the running checksum, which is written after the last entry
+struct shard_stream {
+	FILE * f;
+	uint64_t checksum;
+};
+
+static void shard_checksum(struct shard_stream * const s, const void * const p, const size_t size){
+	for(size_t k = 0 ; k < size ; k++){
+		s->checksum ^= (uint64_t) ((const uint8_t *) p)[k]; // FNV-1a
+		s->checksum *= 0x100000001b3ULL;
+	}
+}
+
+static int32_t shard_put(struct shard_stream * const s, const void * const p, const size_t size){
+	shard_checksum(s, p, size);
+	return fwrite(p, 1, size, s->f) != size;
+}
+
+static int32_t shard_get(struct shard_stream * const s, void * const p, const size_t size){
+	if(fread(p, 1, size, s->f) != size){return 1;}
+	shard_checksum(s, p, size);
+	return 0;
+}
+
+static int32_t shard_entry_cmp(const void * const a, const void * const b){
+	return strcmp(((const struct shard_entry *) a)->key, ((const struct shard_entry *) b)->key);
+}
+
+int32_t create_shard(struct shard * const s, const uint64_t num_entries, const uint64_t num_oov_entries, const size_t key_blob_size){
+	memset(s, '\0', sizeof(struct shard));
+	s->entries = calloc(num_entries > 0 ? num_entries : 1, sizeof(struct shard_entry));
+	s->oov_entries = calloc(num_oov_entries > 0 ? num_oov_entries : 1, sizeof(struct shard_entry));
+	s->key_blob = malloc(key_blob_size > 0 ? key_blob_size : 1);
+	if(s->entries == NULL || s->oov_entries == NULL || s->key_blob == NULL){
+		perror("malloc failed\n");
+		free_shard(s);
+		return 1;
+	}
+	s->num_entries = num_entries;
+	s->num_oov_entries = num_oov_entries;
+	s->key_blob_size = key_blob_size;
+	s->oov_exact = 1;
+	return 0;
+}
+
+// entries are filled in any order; shard_write and shard_merge expect them sorted, with no key twice
+int32_t shard_sort(struct shard * const s){
+	qsort(s->entries, s->num_entries, sizeof(struct shard_entry), shard_entry_cmp);
+	qsort(s->oov_entries, s->num_oov_entries, sizeof(struct shard_entry), shard_entry_cmp);
+	for(uint64_t k = 1 ; k < s->num_entries ; k++){
+		if(strcmp(s->entries[k - 1].key, s->entries[k].key) == 0){goto duplicate_key;}
+	}
+	for(uint64_t k = 1 ; k < s->num_oov_entries ; k++){
+		if(strcmp(s->oov_entries[k - 1].key, s->oov_entries[k].key) == 0){goto duplicate_key;}
+	}
+	return 0;
+
+	duplicate_key:
+	perror("shard has a key twice\n");
+	return 1;
+}
+
+static int32_t shard_write_entries(struct shard_stream * const w, const struct shard_entry * const entries, const uint64_t num_entries, const uint8_t with_rank){
+	for(uint64_t k = 0 ; k < num_entries ; k++){
+		const size_t length = strlen(entries[k].key);
+		if(length > SHARD_KEY_MAX_SIZE){
+			fprintf(stderr, "shard key too long (%zu bytes)\n", length);
+			return 1;
+		}
+		const uint16_t length_u16 = (uint16_t) length;
+		if(shard_put(w, &length_u16, sizeof(uint16_t)) != 0 || shard_put(w, entries[k].key, length) != 0 || shard_put(w, &(entries[k].count), sizeof(uint64_t)) != 0){return 1;}
+		if(with_rank && shard_put(w, &(entries[k].first_seen), sizeof(uint64_t)) != 0){return 1;}
+	}
+	return 0;
+}
+
+int32_t shard_write(const struct shard * const s, const char * const path){
+	const uint32_t version = SHARD_VERSION;
+	const uint32_t byte_order_mark = SHARD_BYTE_ORDER_MARK;
+	const uint64_t key_blob_size = (uint64_t) s->key_blob_size;
+	const uint64_t totals[7] = {s->num_files, s->num_documents, s->num_sentences, s->num_sentences_containing_mwe, s->num_sentences_containing_mwe_tp_only, s->num_tokens, s->num_oov_tokens};
+	const uint64_t sizes[3] = {s->num_entries, s->num_oov_entries, key_blob_size};
+
+	struct shard_stream w = {.f = fopen(path, "wb"), .checksum = 0xcbf29ce484222325ULL};
+	if(w.f == NULL){
+		fprintf(stderr, "failed to open %s for write\n", path);
+		return 1;
+	}
+	int32_t failed = shard_put(&w, SHARD_MAGIC, SHARD_MAGIC_SIZE) != 0 || shard_put(&w, &version, sizeof(uint32_t)) != 0 || shard_put(&w, &byte_order_mark, sizeof(uint32_t)) != 0;
+	failed = failed || shard_put(&w, &(s->oov_exact), sizeof(uint8_t)) != 0 || shard_put(&w, totals, sizeof(totals)) != 0 || shard_put(&w, &(s->num_oov_types), sizeof(int64_t)) != 0 || shard_put(&w, sizes, sizeof(sizes)) != 0;
+	failed = failed || shard_write_entries(&w, s->entries, s->num_entries, 1) != 0 || shard_write_entries(&w, s->oov_entries, s->num_oov_entries, 0) != 0;
+	const uint64_t checksum = w.checksum;
+	failed = failed || fwrite(&checksum, sizeof(uint64_t), 1, w.f) != 1;
+	if(fclose(w.f) != 0){failed = 1;}
+	if(failed){
+		fprintf(stderr, "failed to write shard: %s\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+// keys are appended to the blob at *blob_position; entries must come in strictly increasing key order
+static int32_t shard_read_entries(struct shard_stream * const r, struct shard * const s, struct shard_entry * const entries, const uint64_t num_entries, const uint8_t with_rank, size_t * const blob_position, uint64_t * const total){
+	*total = 0;
+	for(uint64_t k = 0 ; k < num_entries ; k++){
+		uint16_t length = 0;
+		if(shard_get(r, &length, sizeof(uint16_t)) != 0 || *blob_position + length + 1 > s->key_blob_size){return 1;}
+		char * const key = s->key_blob + *blob_position;
+		if(shard_get(r, key, length) != 0 || memchr(key, '\0', length) != NULL){return 1;}
+		key[length] = '\0';
+		*blob_position += length + 1;
+		entries[k].key = key;
+		if(shard_get(r, &(entries[k].count), sizeof(uint64_t)) != 0 || entries[k].count == 0){return 1;}
+		if(with_rank && shard_get(r, &(entries[k].first_seen), sizeof(uint64_t)) != 0){return 1;}
+		if(k > 0 && strcmp(entries[k - 1].key, key) >= 0){return 1;}
+		*total += entries[k].count;
+	}
+	return 0;
+}
+
+int32_t shard_read(struct shard * const s, const char * const path){
+	char magic[SHARD_MAGIC_SIZE];
+	uint32_t version = 0;
+	uint32_t byte_order_mark = 0;
+	uint8_t oov_exact = 0;
+	uint64_t totals[7];
+	int64_t num_oov_types = 0;
+	uint64_t sizes[3];
+	uint64_t checksum = 0;
+	uint64_t num_tokens = 0;
+	uint64_t num_oov_tokens = 0;
+	size_t blob_position = 0;
+
+	memset(s, '\0', sizeof(struct shard));
+	struct shard_stream r = {.f = fopen(path, "rb"), .checksum = 0xcbf29ce484222325ULL};
+	if(r.f == NULL){
+		fprintf(stderr, "failed to open %s for read\n", path);
+		return 1;
+	}
+	if(shard_get(&r, magic, SHARD_MAGIC_SIZE) != 0 || memcmp(magic, SHARD_MAGIC, SHARD_MAGIC_SIZE) != 0){
+		fprintf(stderr, "Not a shard: %s\n", path);
+		goto failure;
+	}
+	if(shard_get(&r, &version, sizeof(uint32_t)) != 0 || version != SHARD_VERSION){
+		fprintf(stderr, "Unsupported shard version %u (expected %u): %s\n", version, SHARD_VERSION, path);
+		goto failure;
+	}
+	if(shard_get(&r, &byte_order_mark, sizeof(uint32_t)) != 0 || byte_order_mark != SHARD_BYTE_ORDER_MARK){
+		fprintf(stderr, "Shard was written with another byte order: %s\n", path);
+		goto failure;
+	}
+	if(shard_get(&r, &oov_exact, sizeof(uint8_t)) != 0 || shard_get(&r, totals, sizeof(totals)) != 0 || shard_get(&r, &num_oov_types, sizeof(int64_t)) != 0 || shard_get(&r, sizes, sizeof(sizes)) != 0){goto failure_corrupt;}
+
+	if(create_shard(s, sizes[0], sizes[1], (size_t) sizes[2]) != 0){
+		perror("failed to call create_shard\n");
+		goto failure;
+	}
+	s->oov_exact = oov_exact;
+	s->num_files = totals[0];
+	s->num_documents = totals[1];
+	s->num_sentences = totals[2];
+	s->num_sentences_containing_mwe = totals[3];
+	s->num_sentences_containing_mwe_tp_only = totals[4];
+	s->num_tokens = totals[5];
+	s->num_oov_tokens = totals[6];
+	s->num_oov_types = num_oov_types;
+
+	if(shard_read_entries(&r, s, s->entries, s->num_entries, 1, &blob_position, &num_tokens) != 0 || shard_read_entries(&r, s, s->oov_entries, s->num_oov_entries, 0, &blob_position, &num_oov_tokens) != 0){goto failure_corrupt;}
+	const uint64_t expected_checksum = r.checksum;
+	if(fread(&checksum, sizeof(uint64_t), 1, r.f) != 1 || checksum != expected_checksum || fgetc(r.f) != EOF){goto failure_corrupt;}
+	if(num_tokens != s->num_tokens || num_oov_tokens != s->num_oov_tokens || blob_position != s->key_blob_size){goto failure_corrupt;}
+
+	fclose(r.f);
+	return 0;
+
+	failure_corrupt:
+	fprintf(stderr, "Corrupt shard: %s\n", path);
+	failure:
+	fclose(r.f);
+	free_shard(s);
+	return 1;
+}
+
+// ---- merge ----
+
+/*
+ * The keys are split into as many ranges as there are threads, at keys sampled from the largest input;
+ * each thread merges its range of every input with a min-heap of cursors, and the ranges are concatenated.
+ */
+struct shard_merge_range {
+	const struct shard * inputs;
+	int32_t num_inputs;
+	uint8_t oov; // merges oov_entries instead of entries
+	const uint64_t * begin; // per input
+	const uint64_t * end;
+	const uint64_t * rank_offsets; // per input, added to first_seen so that earlier inputs come first
+	struct shard_entry * out; // keys still point into the inputs
+	uint64_t num_out;
+	size_t key_bytes;
+	int32_t status;
+};
+
+static const struct shard_entry * shard_merge_list(const struct shard * const s, const uint8_t oov){
+	return oov ? s->oov_entries : s->entries;
+}
+
+static uint64_t shard_merge_list_size(const struct shard * const s, const uint8_t oov){
+	return oov ? s->num_oov_entries : s->num_entries;
+}
+
+// first entry whose key is not less than key
+static uint64_t shard_merge_lower_bound(const struct shard_entry * const entries, const uint64_t num_entries, const char * const key){
+	uint64_t lo = 0;
+	uint64_t hi = num_entries;
+	while(lo < hi){
+		const uint64_t mid = lo + (hi - lo) / 2;
+		if(strcmp(entries[mid].key, key) < 0){lo = mid + 1;} else {hi = mid;}
+	}
+	return lo;
+}
+
+static void shard_merge_sift_down(int32_t * const heap, const int32_t size, const struct shard_entry * const * const cursors, int32_t k){
+	while(1){
+		const int32_t left = 2 * k + 1;
+		const int32_t right = left + 1;
+		int32_t smallest = k;
+		if(left < size && strcmp(cursors[heap[left]]->key, cursors[heap[smallest]]->key) < 0){smallest = left;}
+		if(right < size && strcmp(cursors[heap[right]]->key, cursors[heap[smallest]]->key) < 0){smallest = right;}
+		if(smallest == k){return;}
+		const int32_t tmp = heap[k];
+		heap[k] = heap[smallest];
+		heap[smallest] = tmp;
+		k = smallest;
+	}
+}
+
+static void* shard_merge_thread(void* args){
+	struct shard_merge_range * const range = (struct shard_merge_range *) args;
+	const int32_t n = range->num_inputs;
+	uint64_t capacity = 0;
+	for(int32_t k = 0 ; k < n ; k++){capacity += range->end[k] - range->begin[k];}
+
+	const struct shard_entry ** const cursors = malloc(n * sizeof(struct shard_entry *));
+	const struct shard_entry ** const ends = malloc(n * sizeof(struct shard_entry *));
+	int32_t * const heap = malloc(n * sizeof(int32_t));
+	range->out = malloc((capacity > 0 ? capacity : 1) * sizeof(struct shard_entry));
+	if(cursors == NULL || ends == NULL || heap == NULL || range->out == NULL){
+		perror("malloc failed\n");
+		range->status = 1;
+		goto free_memory;
+	}
+
+	int32_t heap_size = 0;
+	for(int32_t k = 0 ; k < n ; k++){
+		const struct shard_entry * const list = shard_merge_list(&(range->inputs[k]), range->oov);
+		cursors[k] = list + range->begin[k];
+		ends[k] = list + range->end[k];
+		if(cursors[k] != ends[k]){heap[heap_size++] = k;}
+	}
+	for(int32_t k = heap_size / 2 - 1 ; k >= 0 ; k--){shard_merge_sift_down(heap, heap_size, cursors, k);}
+
+	while(heap_size > 0){
+		const int32_t first = heap[0];
+		struct shard_entry * const out = &(range->out[range->num_out]);
+		out->key = cursors[first]->key;
+		out->count = 0;
+		out->first_seen = UINT64_MAX;
+		// every input positioned on the same key is at the top of the heap in turn
+		while(heap_size > 0 && strcmp(cursors[heap[0]]->key, out->key) == 0){
+			const int32_t k = heap[0];
+			out->count += cursors[k]->count;
+			const uint64_t rank = range->oov ? 0 : range->rank_offsets[k] + cursors[k]->first_seen;
+			if(rank < out->first_seen){out->first_seen = rank;}
+			cursors[k]++;
+			if(cursors[k] == ends[k]){heap[0] = heap[--heap_size];}
+			shard_merge_sift_down(heap, heap_size, cursors, 0);
+		}
+		range->key_bytes += strlen(out->key) + 1;
+		range->num_out++;
+	}
+
+	free_memory:
+	free(cursors);
+	free(ends);
+	free(heap);
+	return NULL;
+}
+
+// merges entries (or oov_entries) of the inputs into ranges[0 .. *num_ranges - 1]
+static int32_t shard_merge_lists(const struct shard * const inputs, const int32_t num_inputs, const uint8_t oov, const uint64_t * const rank_offsets, const int32_t num_threads, struct shard_merge_range * const ranges, int32_t * const num_ranges){
+	int32_t largest = 0;
+	for(int32_t k = 1 ; k < num_inputs ; k++){
+		if(shard_merge_list_size(&(inputs[k]), oov) > shard_merge_list_size(&(inputs[largest]), oov)){largest = k;}
+	}
+	const struct shard_entry * const samples = shard_merge_list(&(inputs[largest]), oov);
+	const uint64_t num_samples = shard_merge_list_size(&(inputs[largest]), oov);
+	const int32_t num_splits = num_samples < (uint64_t) num_threads ? (num_samples > 0 ? (int32_t) num_samples : 1) : num_threads;
+
+	// bounds[t * num_inputs + k] is where range t starts in input k
+	uint64_t * const bounds = malloc((num_splits + 1) * num_inputs * sizeof(uint64_t));
+	pthread_t * const threads = malloc(num_splits * sizeof(pthread_t));
+	if(bounds == NULL || threads == NULL){
+		perror("malloc failed\n");
+		free(bounds);
+		free(threads);
+		return 1;
+	}
+	for(int32_t k = 0 ; k < num_inputs ; k++){
+		const struct shard_entry * const list = shard_merge_list(&(inputs[k]), oov);
+		const uint64_t size = shard_merge_list_size(&(inputs[k]), oov);
+		bounds[k] = 0;
+		for(int32_t t = 1 ; t < num_splits ; t++){
+			bounds[t * num_inputs + k] = shard_merge_lower_bound(list, size, samples[(uint64_t) t * num_samples / num_splits].key);
+		}
+		bounds[num_splits * num_inputs + k] = size;
+	}
+
+	int32_t result = 0;
+	int32_t num_created = 0;
+	for(int32_t t = 0 ; t < num_splits ; t++){
+		ranges[t] = (struct shard_merge_range) {
+			.inputs = inputs,
+			.num_inputs = num_inputs,
+			.oov = oov,
+			.begin = &(bounds[t * num_inputs]),
+			.end = &(bounds[(t + 1) * num_inputs]),
+			.rank_offsets = rank_offsets,
+		};
+	}
+	for(int32_t t = 0 ; t < num_splits ; t++){
+		if(pthread_create(&(threads[t]), NULL, shard_merge_thread, &(ranges[t])) != 0){
+			perror("failed to call pthread_create\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int32_t t = 0 ; t < num_created ; t++){
+		pthread_join(threads[t], NULL);
+		if(ranges[t].status != 0){result = 1;}
+	}
+	*num_ranges = num_created;
+
+	free(bounds);
+	free(threads);
+	return result;
+}
+
+// copies the merged ranges into entries, with their keys in the blob of result
+static void shard_merge_collect(struct shard * const result, const struct shard_merge_range * const ranges, const int32_t num_ranges, struct shard_entry * const entries, size_t * const blob_position){
+	uint64_t j = 0;
+	for(int32_t t = 0 ; t < num_ranges ; t++){
+		for(uint64_t k = 0 ; k < ranges[t].num_out ; k++){
+			const size_t length = strlen(ranges[t].out[k].key) + 1;
+			char * const key = result->key_blob + *blob_position;
+			memcpy(key, ranges[t].out[k].key, length);
+			*blob_position += length;
+			entries[j] = ranges[t].out[k];
+			entries[j].key = key;
+			j++;
+		}
+	}
+}
+
+// result holds the sum of the inputs; the inputs must be sorted (as shard_read and shard_sort leave them)
+int32_t shard_merge(struct shard * const result, const struct shard * const inputs, const int32_t num_inputs, const int32_t num_threads){
+	memset(result, '\0', sizeof(struct shard));
+	if(num_inputs <= 0){
+		perror("no shard to merge\n");
+		return 1;
+	}
+	const int32_t num_ranges_max = num_threads > 0 ? num_threads : 1;
+	uint64_t * const rank_offsets = malloc(num_inputs * sizeof(uint64_t));
+	struct shard_merge_range * const ranges = calloc(num_ranges_max, sizeof(struct shard_merge_range));
+	struct shard_merge_range * const oov_ranges = calloc(num_ranges_max, sizeof(struct shard_merge_range));
+	int32_t num_ranges = 0;
+	int32_t num_oov_ranges = 0;
+	int32_t status = 0;
+	if(rank_offsets == NULL || ranges == NULL || oov_ranges == NULL){
+		perror("malloc failed\n");
+		status = 1;
+		goto free_memory;
+	}
+
+	// the types of an input rank after every type of the inputs before it, as if their files had been read first
+	uint64_t rank_offset = 0;
+	for(int32_t k = 0 ; k < num_inputs ; k++){
+		rank_offsets[k] = rank_offset;
+		uint64_t max_rank = 0;
+		for(uint64_t j = 0 ; j < inputs[k].num_entries ; j++){
+			if(inputs[k].entries[j].first_seen > max_rank){max_rank = inputs[k].entries[j].first_seen;}
+		}
+		if(inputs[k].num_entries > 0){rank_offset += max_rank + 1;}
+	}
+
+	if(shard_merge_lists(inputs, num_inputs, 0, rank_offsets, num_ranges_max, ranges, &num_ranges) != 0 || shard_merge_lists(inputs, num_inputs, 1, rank_offsets, num_ranges_max, oov_ranges, &num_oov_ranges) != 0){
+		perror("failed to call shard_merge_lists\n");
+		status = 1;
+		goto free_memory;
+	}
+
+	uint64_t num_entries = 0;
+	uint64_t num_oov_entries = 0;
+	size_t key_blob_size = 0;
+	for(int32_t t = 0 ; t < num_ranges ; t++){num_entries += ranges[t].num_out; key_blob_size += ranges[t].key_bytes;}
+	for(int32_t t = 0 ; t < num_oov_ranges ; t++){num_oov_entries += oov_ranges[t].num_out; key_blob_size += oov_ranges[t].key_bytes;}
+	if(create_shard(result, num_entries, num_oov_entries, key_blob_size) != 0){
+		perror("failed to call create_shard\n");
+		status = 1;
+		goto free_memory;
+	}
+	size_t blob_position = 0;
+	shard_merge_collect(result, ranges, num_ranges, result->entries, &blob_position);
+	shard_merge_collect(result, oov_ranges, num_oov_ranges, result->oov_entries, &blob_position);
+
+	// a type counted by several inputs is counted once; with approximate inputs, the largest lower bound is kept
+	result->num_oov_types = (int64_t) num_oov_entries;
+	for(int32_t k = 0 ; k < num_inputs ; k++){
+		result->num_files += inputs[k].num_files;
+		result->num_documents += inputs[k].num_documents;
+		result->num_sentences += inputs[k].num_sentences;
+		result->num_sentences_containing_mwe += inputs[k].num_sentences_containing_mwe;
+		result->num_sentences_containing_mwe_tp_only += inputs[k].num_sentences_containing_mwe_tp_only;
+		result->num_tokens += inputs[k].num_tokens;
+		result->num_oov_tokens += inputs[k].num_oov_tokens;
+		if(!inputs[k].oov_exact){
+			result->oov_exact = 0;
+			if(inputs[k].num_oov_types > result->num_oov_types){result->num_oov_types = inputs[k].num_oov_types;}
+		}
+	}
+
+	free_memory:
+	if(ranges != NULL){for(int32_t t = 0 ; t < num_ranges_max ; t++){free(ranges[t].out);}}
+	if(oov_ranges != NULL){for(int32_t t = 0 ; t < num_ranges_max ; t++){free(oov_ranges[t].out);}}
+	free(ranges);
+	free(oov_ranges);
+	free(rank_offsets);
+	return status;
+}
+
+void free_shard(struct shard * const s){
+	free(s->entries);
+	free(s->oov_entries);
+	free(s->key_blob);
+	memset(s, '\0', sizeof(struct shard));
+}
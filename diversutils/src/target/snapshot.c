@@ -0,0 +1,256 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for posix_memalign
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "graph.h"
+#include "distances.h"
+
+struct graph_snapshot_thread_args {
+	struct graph* g;
+	uint64_t start;
+	uint64_t end;
+	uint64_t first_new_node;
+	uint64_t first_new_vector;
+	uint64_t sum;
+	const uint64_t* counts; // NULL to read the counts of the nodes
+	uint8_t gather_counts;
+	uint8_t gather_vectors;
+};
+
+// counts of every node, plus keys and panel rows of the nodes that are new since the previous refresh (nodes never move nor change vector)
+static void* graph_snapshot_gather_thread(void* args){
+	struct graph_snapshot_thread_args* const a = (struct graph_snapshot_thread_args*) args;
+	struct graph_snapshot* const s = &(a->g->snapshot);
+	uint64_t sum = 0;
+
+	for(uint64_t i = a->start ; i < a->end ; i++){
+		const struct graph_node* const node = graph_node_at(a->g, i);
+		if(a->gather_counts){
+			const uint64_t count = a->counts != NULL ? a->counts[i] : __atomic_load_n(&(node->absolute_proportion), __ATOMIC_RELAXED);
+			s->absolute_proportions[i] = count;
+			sum += count;
+			if(i >= a->first_new_node){
+				s->keys[i] = node->word2vec_entry_pointer != NULL ? node->word2vec_entry_pointer->key : NULL;
+			}
+		}
+		if(a->gather_vectors && i >= a->first_new_vector){
+			float* const row = &(s->panel[i * s->stride]);
+			if(node->vector.fp32 != NULL){
+				memcpy(row, node->vector.fp32, s->num_dimensions * sizeof(float));
+				memset(&(row[s->num_dimensions]), '\0', (s->stride - s->num_dimensions) * sizeof(float));
+			} else {
+				memset(row, '\0', s->stride * sizeof(float));
+			}
+			s->norms[i] = vector_norm_fp32(row, s->stride);
+		}
+	}
+	a->sum = sum;
+	return NULL;
+}
+
+static void* graph_snapshot_proportion_thread(void* args){
+	struct graph_snapshot_thread_args* const a = (struct graph_snapshot_thread_args*) args;
+	struct graph_snapshot* const s = &(a->g->snapshot);
+
+	for(uint64_t i = a->start ; i < a->end ; i++){
+		const double relative_proportion = ((double) s->absolute_proportions[i]) / ((double) a->sum);
+		s->relative_proportions[i] = relative_proportion;
+		graph_node_at(a->g, i)->relative_proportion = relative_proportion;
+	}
+	return NULL;
+}
+
+static int32_t graph_snapshot_run(void* (*function)(void*), struct graph_snapshot_thread_args* const args, const int16_t num_threads){
+	pthread_t threads[num_threads];
+	int16_t num_created = 0;
+	int32_t result = 0;
+
+	if(num_threads == 1){
+		function(&(args[0]));
+		return 0;
+	}
+	for(int16_t k = 0 ; k < num_threads ; k++){
+		if(pthread_create(&(threads[k]), NULL, function, &(args[k])) != 0){
+			perror("failed to create snapshot thread\n");
+			result = 1;
+			break;
+		}
+		num_created++;
+	}
+	for(int16_t k = 0 ; k < num_created ; k++){
+		if(pthread_join(threads[k], NULL) != 0){
+			perror("failed to join snapshot thread\n");
+			result = 1;
+		}
+	}
+	return result;
+}
+
+static int32_t graph_snapshot_reserve(struct graph_snapshot* const s, const uint64_t num_nodes, const uint8_t gather_vectors){
+	void* malloc_pointer;
+
+	if(num_nodes > s->capacity){
+		uint64_t capacity = s->capacity * 2;
+		if(capacity < num_nodes){capacity = num_nodes;}
+		malloc_pointer = realloc(s->norms, capacity * sizeof(float));
+		if(malloc_pointer == NULL){return 1;}
+		s->norms = (float*) malloc_pointer;
+		malloc_pointer = realloc(s->relative_proportions, capacity * sizeof(double));
+		if(malloc_pointer == NULL){return 1;}
+		s->relative_proportions = (double*) malloc_pointer;
+		malloc_pointer = realloc(s->absolute_proportions, capacity * sizeof(uint64_t));
+		if(malloc_pointer == NULL){return 1;}
+		s->absolute_proportions = (uint64_t*) malloc_pointer;
+		malloc_pointer = realloc((void*) s->keys, capacity * sizeof(const char*));
+		if(malloc_pointer == NULL){return 1;}
+		s->keys = (const char**) malloc_pointer;
+		s->capacity = capacity;
+	}
+
+	// the panel cannot be realloc'd without losing its alignment
+	if(gather_vectors && num_nodes > s->panel_capacity){
+		uint64_t panel_capacity = s->panel_capacity * 2;
+		if(panel_capacity < num_nodes){panel_capacity = num_nodes;}
+		if(posix_memalign(&malloc_pointer, GRAPH_SNAPSHOT_ALIGNMENT, panel_capacity * s->stride * sizeof(float)) != 0){return 1;}
+		if(s->panel != NULL){
+			memcpy(malloc_pointer, s->panel, s->num_vectors * s->stride * sizeof(float));
+			free(s->panel);
+		}
+		s->panel = (float*) malloc_pointer;
+		s->panel_capacity = panel_capacity;
+	}
+
+	return 0;
+}
+
+// without gather_counts, the snapshot keeps its node count and proportions, and only the missing panel rows are filled
+static int32_t graph_snapshot_update(struct graph* const g, const uint64_t* const counts, const uint8_t gather_counts, const uint8_t gather_vectors, const int16_t num_threads){
+	struct graph_snapshot* const s = &(g->snapshot);
+	const uint64_t num_nodes = gather_counts ? g->num_nodes : s->num_nodes;
+	uint8_t actually_gather_vectors = gather_vectors;
+
+	if(num_nodes < s->num_vectors){
+		// the graph was emptied and refilled
+		s->num_vectors = 0;
+	}
+	if(actually_gather_vectors && s->num_vectors == 0){
+		const uint16_t num_dimensions = num_nodes > 0 ? graph_node_at(g, 0)->num_dimensions : 0;
+		const uint16_t stride = (uint16_t) (((num_dimensions + GRAPH_SNAPSHOT_STRIDE_STEP - 1) / GRAPH_SNAPSHOT_STRIDE_STEP) * GRAPH_SNAPSHOT_STRIDE_STEP);
+		if(stride != s->stride){
+			free(s->panel);
+			s->panel = NULL;
+			s->panel_capacity = 0;
+		}
+		s->num_dimensions = num_dimensions;
+		s->stride = stride;
+	}
+	if(actually_gather_vectors && s->stride == 0){actually_gather_vectors = 0;}
+
+	if(graph_snapshot_reserve(s, num_nodes, actually_gather_vectors) != 0){
+		perror("failed to allocate graph snapshot\n");
+		return 1;
+	}
+
+	int16_t num_threads_used = num_threads < 1 ? 1 : num_threads;
+	if(((uint64_t) num_threads_used) * GRAPH_SNAPSHOT_MIN_NODES_PER_THREAD > num_nodes){
+		num_threads_used = (int16_t) (num_nodes / GRAPH_SNAPSHOT_MIN_NODES_PER_THREAD);
+		if(num_threads_used < 1){num_threads_used = 1;}
+	}
+
+	struct graph_snapshot_thread_args args[num_threads_used];
+	uint64_t start = 0;
+	for(int16_t k = 0 ; k < num_threads_used ; k++){
+		uint64_t end = start + num_nodes / ((uint64_t) num_threads_used);
+		if(((uint64_t) k) < num_nodes % ((uint64_t) num_threads_used)){end++;}
+		args[k] = (struct graph_snapshot_thread_args) {
+			.g = g,
+			.start = start,
+			.end = end,
+			.first_new_node = s->num_nodes < num_nodes ? s->num_nodes : num_nodes,
+			.first_new_vector = s->num_vectors,
+			.sum = 0,
+			.counts = counts,
+			.gather_counts = gather_counts,
+			.gather_vectors = actually_gather_vectors,
+		};
+		start = end;
+	}
+
+	if(graph_snapshot_run(graph_snapshot_gather_thread, args, num_threads_used) != 0){return 1;}
+	if(!gather_counts){
+		if(actually_gather_vectors){s->num_vectors = num_nodes;}
+		return 0;
+	}
+	uint64_t sum = 0;
+	for(int16_t k = 0 ; k < num_threads_used ; k++){sum += args[k].sum;}
+	for(int16_t k = 0 ; k < num_threads_used ; k++){args[k].sum = sum;}
+	if(graph_snapshot_run(graph_snapshot_proportion_thread, args, num_threads_used) != 0){return 1;}
+
+	s->num_nodes = num_nodes;
+	s->sum_absolute_proportions = sum;
+	s->stale = 0;
+	memset(&(s->memo), '\0', sizeof(struct graph_snapshot_memo));
+	if(actually_gather_vectors){s->num_vectors = num_nodes;}
+
+	return 0;
+}
+
+// brings the snapshot up to date with g, which must not grow meanwhile (callers hold mutex_nodes or own g);
+// counts and proportions are always re-read, while keys and panel rows are only gathered for nodes added since the previous refresh
+int32_t graph_snapshot_refresh(struct graph* const g, const uint8_t gather_vectors, const int16_t num_threads){
+	return graph_snapshot_update(g, NULL, 1, gather_vectors, num_threads);
+}
+
+// same as graph_snapshot_refresh, but with counts[i] standing for the count of node i, as captured earlier by whoever owned g
+int32_t graph_snapshot_refresh_from_counts(struct graph* const g, const uint64_t* const counts, const uint8_t gather_vectors, const int16_t num_threads){
+	return graph_snapshot_update(g, counts, 1, gather_vectors, num_threads);
+}
+
+// only gathers the panel rows missing for the nodes of the last refresh, leaving counts and proportions as they are
+int32_t graph_snapshot_gather_vectors(struct graph* const g, const int16_t num_threads){
+	return graph_snapshot_update(g, NULL, 0, 1, num_threads);
+}
+
+void free_graph_snapshot(struct graph_snapshot* const s){
+	free(s->panel);
+	free(s->norms);
+	free(s->relative_proportions);
+	free(s->absolute_proportions);
+	free((void*) s->keys);
+	memset(s, '\0', sizeof(struct graph_snapshot));
+}
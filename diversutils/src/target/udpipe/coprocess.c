@@ -0,0 +1,358 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _POSIX_C_SOURCE
+// for kill, sigaction and fcntl
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "udpipe/coprocess.h"
+#include "logging.h"
+
+static const char udpipe_coprocess_framing[] = "\n\n" UDPIPE_COPROCESS_SENTINEL "\n\n";
+
+// serialises pipe creation and fork, so that a child never inherits the pipes of another one
+static pthread_mutex_t udpipe_coprocess_spawn_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int32_t udpipe_coprocess_spawn(struct udpipe_coprocess * const cp){
+    int pipe_in[2];
+    int pipe_out[2];
+
+    pthread_mutex_lock(&udpipe_coprocess_spawn_mutex);
+    if(pipe(pipe_in) != 0){
+        pthread_mutex_unlock(&udpipe_coprocess_spawn_mutex);
+        perror("failed to call pipe\n");
+        return 1;
+    }
+    if(pipe(pipe_out) != 0){
+        close(pipe_in[0]);
+        close(pipe_in[1]);
+        pthread_mutex_unlock(&udpipe_coprocess_spawn_mutex);
+        perror("failed to call pipe\n");
+        return 1;
+    }
+    // the copies made by dup2 in the child do not inherit FD_CLOEXEC
+    fcntl(pipe_in[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe_in[1], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe_out[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe_out[1], F_SETFD, FD_CLOEXEC);
+
+    pid_t pid = fork();
+    if(pid == -1){
+        close(pipe_in[0]);
+        close(pipe_in[1]);
+        close(pipe_out[0]);
+        close(pipe_out[1]);
+        pthread_mutex_unlock(&udpipe_coprocess_spawn_mutex);
+        perror("failed to call fork\n");
+        return 1;
+    }
+    if(pid == 0){
+        if(dup2(pipe_in[0], STDIN_FILENO) == -1 || dup2(pipe_out[1], STDOUT_FILENO) == -1){_exit(127);}
+        execvp(cp->argv[0], cp->argv);
+        _exit(127);
+    }
+    close(pipe_in[0]);
+    close(pipe_out[1]);
+    pthread_mutex_unlock(&udpipe_coprocess_spawn_mutex);
+
+    // writes must not block, output is drained in between
+    fcntl(pipe_in[1], F_SETFL, fcntl(pipe_in[1], F_GETFL) | O_NONBLOCK);
+
+    cp->pid = pid;
+    cp->fd_in = pipe_in[1];
+    cp->fd_out = pipe_out[0];
+    cp->bfr_start = 0;
+    cp->bfr_size = 0;
+    return 0;
+}
+
+static void udpipe_coprocess_stop(struct udpipe_coprocess * const cp, const int8_t force){
+    if(cp->pid <= 0){return;}
+    if(cp->fd_in != -1){close(cp->fd_in); cp->fd_in = -1;}
+    if(force){kill(cp->pid, SIGKILL);}
+    if(cp->fd_out != -1){close(cp->fd_out); cp->fd_out = -1;}
+    while(waitpid(cp->pid, NULL, 0) == -1 && errno == EINTR){}
+    cp->pid = -1;
+}
+
+// reads once from the child; returns 1 on end of file or error
+static int32_t udpipe_coprocess_fill(struct udpipe_coprocess * const cp){
+    if(cp->bfr_start > 0){
+        memmove(cp->bfr, cp->bfr + cp->bfr_start, cp->bfr_size - cp->bfr_start);
+        cp->bfr_size -= cp->bfr_start;
+        cp->bfr_start = 0;
+    }
+    if(cp->bfr_capacity - cp->bfr_size < UDPIPE_COPROCESS_READ_SIZE){
+        size_t new_capacity = cp->bfr_capacity + UDPIPE_COPROCESS_READ_SIZE;
+        void * realloc_ptr = realloc(cp->bfr, new_capacity * sizeof(char));
+        if(realloc_ptr == NULL){
+            perror("failed to realloc\n");
+            return 1;
+        }
+        cp->bfr = realloc_ptr;
+        cp->bfr_capacity = new_capacity;
+    }
+    ssize_t r = read(cp->fd_out, cp->bfr + cp->bfr_size, cp->bfr_capacity - cp->bfr_size);
+    if(r < 0 && errno == EINTR){return 0;}
+    if(r <= 0){return 1;}
+    cp->bfr_size += (size_t) r;
+    return 0;
+}
+
+static int32_t udpipe_coprocess_write_all(struct udpipe_coprocess * const cp, const char * const data, const size_t size){
+    size_t written = 0;
+    while(written < size){
+        struct pollfd fds[2] = {{.fd = cp->fd_in, .events = POLLOUT}, {.fd = cp->fd_out, .events = POLLIN}};
+        int n = poll(fds, 2, UDPIPE_COPROCESS_TIMEOUT_MS);
+        if(n < 0 && errno == EINTR){continue;}
+        if(n <= 0){return 1;}
+        if(fds[1].revents & (POLLIN | POLLHUP | POLLERR)){
+            if(udpipe_coprocess_fill(cp) != 0){return 1;}
+        }
+        if(fds[0].revents & (POLLHUP | POLLERR)){return 1;}
+        if(fds[0].revents & POLLOUT){
+            ssize_t w = write(cp->fd_in, data + written, size - written);
+            if(w < 0){
+                if(errno == EAGAIN || errno == EINTR){continue;}
+                return 1;
+            }
+            written += (size_t) w;
+        }
+    }
+    return 0;
+}
+
+static int32_t udpipe_coprocess_write_document(struct udpipe_coprocess * const cp){
+    if(udpipe_coprocess_write_all(cp, cp->text, cp->text_size) != 0){return 1;}
+    return udpipe_coprocess_write_all(cp, udpipe_coprocess_framing, sizeof(udpipe_coprocess_framing) - 1);
+}
+
+// on success, (*line) points into cp->bfr and stays valid until the next read
+static int32_t udpipe_coprocess_read_line(struct udpipe_coprocess * const cp, char ** const line, size_t * const line_size){
+    while(1){
+        char * newline = cp->bfr_size == cp->bfr_start ? NULL : memchr(cp->bfr + cp->bfr_start, '\n', cp->bfr_size - cp->bfr_start);
+        if(newline != NULL){
+            (*line) = cp->bfr + cp->bfr_start;
+            (*line_size) = (size_t) (newline - (*line));
+            cp->bfr_start += (*line_size) + 1;
+            return 0;
+        }
+        struct pollfd fds[1] = {{.fd = cp->fd_out, .events = POLLIN}};
+        int n = poll(fds, 1, UDPIPE_COPROCESS_TIMEOUT_MS);
+        if(n < 0 && errno == EINTR){continue;}
+        if(n <= 0){return 1;}
+        if(udpipe_coprocess_fill(cp) != 0){return 1;}
+    }
+}
+
+// kills the child, starts a new one and writes the current document again
+static int32_t udpipe_coprocess_restart(struct udpipe_coprocess * const cp){
+    const size_t log_bfr_size = 256;
+    char log_bfr[log_bfr_size];
+
+    while(cp->num_restarts < UDPIPE_COPROCESS_MAX_RESTARTS){
+        cp->num_restarts++;
+        memset(log_bfr, '\0', log_bfr_size);
+        snprintf(log_bfr, log_bfr_size, "restarting tokenizer process %i (attempt %i of %i)", (int32_t) cp->pid, cp->num_restarts, UDPIPE_COPROCESS_MAX_RESTARTS);
+        warning_format(__FILE__, __func__, __LINE__, log_bfr);
+
+        udpipe_coprocess_stop(cp, 1);
+        if(udpipe_coprocess_spawn(cp) != 0){continue;}
+        cp->num_tokens_to_skip = cp->num_tokens_delivered;
+        if(cp->in_document && udpipe_coprocess_write_document(cp) != 0){continue;}
+        return 0;
+    }
+    error_format(__FILE__, __func__, __LINE__, "tokenizer process keeps failing");
+    return 1;
+}
+
+int32_t create_udpipe_coprocess(struct udpipe_coprocess * const cp, char * const * const argv){
+    // a dead child must show up as a write error, not terminate the program
+    struct sigaction sa;
+    memset(&sa, '\0', sizeof(struct sigaction));
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
+
+    memset(cp, '\0', sizeof(struct udpipe_coprocess));
+    cp->argv = argv;
+    cp->pid = -1;
+    cp->fd_in = -1;
+    cp->fd_out = -1;
+    if(udpipe_coprocess_spawn(cp) != 0){
+        perror("failed to call udpipe_coprocess_spawn\n");
+        return 1;
+    }
+    return 0;
+}
+
+void free_udpipe_coprocess(struct udpipe_coprocess * const cp){
+    udpipe_coprocess_stop(cp, 0);
+    free(cp->bfr);
+    cp->bfr = NULL;
+    cp->bfr_capacity = 0;
+}
+
+int32_t udpipe_coprocess_submit(struct udpipe_coprocess * const cp, const char * const text, const size_t text_size){
+    // the previous document was not read until the end
+    if(cp->in_document){
+        int8_t end_of_document = 0;
+        char token[2];
+        while(!end_of_document){
+            if(udpipe_coprocess_next_token(cp, token, 2, &end_of_document) != 0){return 1;}
+        }
+    }
+
+    cp->text = text;
+    cp->text_size = text_size;
+    cp->num_tokens_delivered = 0;
+    cp->num_tokens_to_skip = 0;
+    cp->num_restarts = 0;
+    cp->in_document = 1;
+
+    if(udpipe_coprocess_write_document(cp) != 0 && udpipe_coprocess_restart(cp) != 0){
+        cp->in_document = 0;
+        return 1;
+    }
+    return 0;
+}
+
+int32_t udpipe_coprocess_next_token(struct udpipe_coprocess * const cp, char * const token, const size_t token_size, int8_t * const end_of_document){
+    char * line;
+    size_t line_size;
+
+    while(1){
+        if(udpipe_coprocess_read_line(cp, &line, &line_size) != 0){
+            if(udpipe_coprocess_restart(cp) != 0){return 1;}
+            continue;
+        }
+        if(line_size > 0 && line[line_size - 1] == '\r'){line_size--;}
+        if(line_size == 0 || line[0] == '#'){continue;}
+
+        // CoNLL-U: the form is the second column; multiword ranges (1-2) and empty nodes (1.1) are not words
+        char * form = line;
+        size_t form_size = line_size;
+        char * tab = memchr(line, '\t', line_size);
+        if(tab != NULL){
+            if(memchr(line, '-', (size_t) (tab - line)) != NULL || memchr(line, '.', (size_t) (tab - line)) != NULL){continue;}
+            form = tab + 1;
+            char * next_tab = memchr(form, '\t', line_size - (size_t) (form - line));
+            form_size = next_tab == NULL ? line_size - (size_t) (form - line) : (size_t) (next_tab - form);
+        }
+
+        if(form_size == sizeof(UDPIPE_COPROCESS_SENTINEL) - 1 && memcmp(form, UDPIPE_COPROCESS_SENTINEL, form_size) == 0){
+            cp->in_document = 0;
+            (*end_of_document) = 1;
+            return 0;
+        }
+        if(cp->num_tokens_to_skip > 0){
+            cp->num_tokens_to_skip--;
+            continue;
+        }
+
+        if(form_size > token_size - 1){form_size = token_size - 1;}
+        memcpy(token, form, form_size);
+        token[form_size] = '\0';
+        cp->num_tokens_delivered++;
+        (*end_of_document) = 0;
+        return 0;
+    }
+}
+
+static struct udpipe_coprocess * udpipe_coprocess_pool;
+static int32_t udpipe_coprocess_pool_size;
+static pthread_mutex_t udpipe_coprocess_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t udpipe_coprocess_pool_cond = PTHREAD_COND_INITIALIZER;
+
+int32_t udpipe_coprocess_pool_create(char * const * const argv, const int32_t num_children){
+    const size_t log_bfr_size = 256;
+    char log_bfr[log_bfr_size];
+    memset(log_bfr, '\0', log_bfr_size);
+    snprintf(log_bfr, log_bfr_size, "Starting %i tokenizer processes (%s)", num_children, argv[0]);
+    info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+    const size_t alloc_size = num_children * sizeof(struct udpipe_coprocess);
+    udpipe_coprocess_pool = malloc(alloc_size);
+    if(udpipe_coprocess_pool == NULL){
+        perror("malloc failed\n");
+        return 1;
+    }
+    memset(udpipe_coprocess_pool, '\0', alloc_size);
+    for(int32_t i = 0 ; i < num_children ; i++){
+        if(create_udpipe_coprocess(&(udpipe_coprocess_pool[i]), argv) != 0){
+            perror("failed to call create_udpipe_coprocess\n");
+            udpipe_coprocess_pool_size = i;
+            udpipe_coprocess_pool_free();
+            return 1;
+        }
+    }
+    udpipe_coprocess_pool_size = num_children;
+    return 0;
+}
+
+void udpipe_coprocess_pool_free(void){
+    for(int32_t i = 0 ; i < udpipe_coprocess_pool_size ; i++){
+        free_udpipe_coprocess(&(udpipe_coprocess_pool[i]));
+    }
+    free(udpipe_coprocess_pool);
+    udpipe_coprocess_pool = NULL;
+    udpipe_coprocess_pool_size = 0;
+}
+
+struct udpipe_coprocess * udpipe_coprocess_pool_acquire(void){
+    pthread_mutex_lock(&udpipe_coprocess_pool_mutex);
+    while(1){
+        for(int32_t i = 0 ; i < udpipe_coprocess_pool_size ; i++){
+            if(!udpipe_coprocess_pool[i].busy){
+                udpipe_coprocess_pool[i].busy = 1;
+                pthread_mutex_unlock(&udpipe_coprocess_pool_mutex);
+                return &(udpipe_coprocess_pool[i]);
+            }
+        }
+        pthread_cond_wait(&udpipe_coprocess_pool_cond, &udpipe_coprocess_pool_mutex);
+    }
+}
+
+void udpipe_coprocess_pool_release(struct udpipe_coprocess * const cp){
+    pthread_mutex_lock(&udpipe_coprocess_pool_mutex);
+    cp->busy = 0;
+    pthread_cond_signal(&udpipe_coprocess_pool_cond);
+    pthread_mutex_unlock(&udpipe_coprocess_pool_mutex);
+}
@@ -0,0 +1,112 @@
+/*
+ *      DiversUtils - Functions to measure diversity
+ *
+ * Copyright (c) 2024  LISN / Université Paris-Saclay / CNRS  Louis Estève (louis.esteve@universite-paris-saclay.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Writes the classification tables used by utf8.c to stdout, from the ranges of unicode_to_subset_ranges:
+ * - utf8_tables_ascii: subset of each ASCII byte;
+ * - utf8_tables_index and utf8_tables_blocks: two-level table, the code point's high bits selecting a block of 256 subsets; identical blocks are shared.
+ * Built and run by the makefile, which compiles it with utf8.c and -DUTF8_NO_TABLES.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unicode/unicode.h"
+#include "unicode/utf8.h"
+
+#define GENERATE_TABLES_BLOCK_SHIFT 8
+#define GENERATE_TABLES_BLOCK_SIZE (1 << GENERATE_TABLES_BLOCK_SHIFT)
+#define GENERATE_TABLES_NUM_CODE_POINTS 0x200000 // largest code point decoded from 4 bytes, plus one
+#define GENERATE_TABLES_NUM_BLOCKS (GENERATE_TABLES_NUM_CODE_POINTS >> GENERATE_TABLES_BLOCK_SHIFT)
+#define GENERATE_TABLES_MAX_DISTINCT_BLOCKS 256 // indices are stored on uint8_t
+
+int32_t main(void){
+    uint8_t (* const blocks)[GENERATE_TABLES_BLOCK_SIZE] = malloc(GENERATE_TABLES_MAX_DISTINCT_BLOCKS * GENERATE_TABLES_BLOCK_SIZE * sizeof(uint8_t));
+    uint8_t * const index = malloc(GENERATE_TABLES_NUM_BLOCKS * sizeof(uint8_t));
+    if(blocks == NULL || index == NULL){
+        perror("malloc failed\n");
+        return 1;
+    }
+    int32_t num_distinct_blocks = 0;
+    uint8_t current[GENERATE_TABLES_BLOCK_SIZE];
+
+    for(int32_t i = 0 ; i < GENERATE_TABLES_NUM_BLOCKS ; i++){
+        for(int32_t j = 0 ; j < GENERATE_TABLES_BLOCK_SIZE ; j++){
+            current[j] = (uint8_t) unicode_to_subset_ranges((unicode_t) ((i << GENERATE_TABLES_BLOCK_SHIFT) | j));
+        }
+        int32_t k;
+        for(k = 0 ; k < num_distinct_blocks ; k++){
+            if(memcmp(blocks[k], current, GENERATE_TABLES_BLOCK_SIZE) == 0){break;}
+        }
+        if(k == num_distinct_blocks){
+            if(num_distinct_blocks == GENERATE_TABLES_MAX_DISTINCT_BLOCKS){
+                fprintf(stderr, "too many distinct blocks (more than %i)\n", GENERATE_TABLES_MAX_DISTINCT_BLOCKS);
+                return 1;
+            }
+            memcpy(blocks[k], current, GENERATE_TABLES_BLOCK_SIZE);
+            num_distinct_blocks++;
+        }
+        index[i] = (uint8_t) k;
+    }
+
+    printf("// generated by src/target/unicode/generate_tables.c - do not edit\n\n");
+    printf("#ifndef UTF8_TABLES_H\n#define UTF8_TABLES_H\n\n#include <stdint.h>\n\n");
+    printf("#define UTF8_TABLES_BLOCK_SHIFT %i\n", GENERATE_TABLES_BLOCK_SHIFT);
+    printf("#define UTF8_TABLES_BLOCK_MASK 0x%x\n", GENERATE_TABLES_BLOCK_SIZE - 1);
+    printf("#define UTF8_TABLES_NUM_BLOCKS %i\n", GENERATE_TABLES_NUM_BLOCKS);
+    printf("#define UTF8_TABLES_NUM_DISTINCT_BLOCKS %i\n\n", num_distinct_blocks);
+
+    printf("static const uint8_t utf8_tables_ascii[128] = {");
+    for(int32_t i = 0 ; i < 128 ; i++){
+        printf("%s%i", i % 32 == 0 ? "\n    " : " ", unicode_to_subset_ranges((unicode_t) i));
+        if(i != 127){printf(",");}
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint8_t utf8_tables_index[UTF8_TABLES_NUM_BLOCKS] = {");
+    for(int32_t i = 0 ; i < GENERATE_TABLES_NUM_BLOCKS ; i++){
+        printf("%s%i", i % 32 == 0 ? "\n    " : " ", index[i]);
+        if(i != GENERATE_TABLES_NUM_BLOCKS - 1){printf(",");}
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint8_t utf8_tables_blocks[UTF8_TABLES_NUM_DISTINCT_BLOCKS][%i] = {\n", GENERATE_TABLES_BLOCK_SIZE);
+    for(int32_t k = 0 ; k < num_distinct_blocks ; k++){
+        printf("    {");
+        for(int32_t j = 0 ; j < GENERATE_TABLES_BLOCK_SIZE ; j++){
+            printf("%s%i", j % 32 == 0 ? "\n        " : " ", blocks[k][j]);
+            if(j != GENERATE_TABLES_BLOCK_SIZE - 1){printf(",");}
+        }
+        printf("\n    }%s\n", k != num_distinct_blocks - 1 ? "," : "");
+    }
+    printf("};\n\n#endif\n");
+
+    free(blocks);
+    free(index);
+    return 0;
+}
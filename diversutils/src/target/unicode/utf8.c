@@ -30,6 +30,9 @@
 #define DEFINE_UNICODE_CONSTANTS
 #include "unicode/utf8.h"
 #include "unicode/unicode.h"
+#ifndef UTF8_NO_TABLES
+#include "unicode/utf8_tables.h" // generated in the build directory by generate_tables.c
+#endif
 
 int8_t utf8_get_length(const char * const s){
     if((s[0] & 0xf8) == 0xf0){return 4;}      // if((s[0] & 0b11111000) == 0b11110000){return 4;} // starts with 11110
@@ -80,10 +83,8 @@ unicode_t utf8_to_unicode(const char * const s, int8_t * const len_p){
     return unicode;
 }
 
-int32_t utf8_to_unicode_subset(const char * const s, int8_t * const len_p){
-    unicode_t code = utf8_to_unicode(s, len_p);
-    if(code == -1){return -1;}
-
+// reference classification, from which the tables are generated
+int32_t unicode_to_subset_ranges(const unicode_t code){
    //  if(UNICODE_BASIC_LATIN_BEG <= code && code <= UNICODE_BASIC_LATIN_END){return UNICODE_BASIC_LATIN;}
     if(UNICODE_LATIN_UPPER_BEG <= code && code <= UNICODE_LATIN_UPPER_END){return UNICODE_LETTER;}
     if(UNICODE_LATIN_LOWER_BEG <= code && code <= UNICODE_LATIN_LOWER_END){return UNICODE_LETTER;}
@@ -100,6 +101,21 @@ int32_t utf8_to_unicode_subset(const char * const s, int8_t * const len_p){
     return UNICODE_OTHER;
 }
 
+int32_t unicode_to_subset(const unicode_t code){
+    #ifdef UTF8_NO_TABLES
+    return unicode_to_subset_ranges(code);
+    #else
+    if(code < 0 || code >= (((unicode_t) UTF8_TABLES_NUM_BLOCKS) << UTF8_TABLES_BLOCK_SHIFT)){return UNICODE_OTHER;}
+    return utf8_tables_blocks[utf8_tables_index[code >> UTF8_TABLES_BLOCK_SHIFT]][code & UTF8_TABLES_BLOCK_MASK];
+    #endif
+}
+
+int32_t utf8_to_unicode_subset(const char * const s, int8_t * const len_p){
+    unicode_t code = utf8_to_unicode(s, len_p);
+    if(code == -1){return -1;}
+    return unicode_to_subset(code);
+}
+
 char * utf8_normalise(char * const s){
     // int32_t count_letter = 0;
     int32_t count_number = 0;
@@ -116,8 +132,22 @@ char * utf8_normalise(char * const s){
 
     int32_t index = 0;
     while(index < 64 && s[index] != '\0'){
-        int32_t unicode_subset = utf8_to_unicode_subset(&s[index], &len);
+        int32_t unicode_subset;
+        #ifdef UTF8_NO_TABLES
+        unicode_subset = utf8_to_unicode_subset(&s[index], &len);
         if(len == -1){index++; continue;}
+        #else
+        // ASCII fast path: one table lookup, no decoding
+        const uint8_t c = (uint8_t) s[index];
+        if(c < 0x80){
+            unicode_subset = utf8_tables_ascii[c];
+            len = 1;
+        } else {
+            const unicode_t code = utf8_to_unicode(&s[index], &len);
+            if(len == -1){index++; continue;}
+            unicode_subset = unicode_to_subset(code);
+        }
+        #endif
 
         switch(unicode_subset){
 //            case UNICODE_LETTER:
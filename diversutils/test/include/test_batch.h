@@ -0,0 +1,372 @@
+#ifndef TEST_BATCH_H
+#define TEST_BATCH_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "measurement.h"
+#include "batch.h"
+#include "file_queue.h"
+#include "oov/counter.h"
+#include "cupt/constants.h"
+
+#define TEST_BATCH_W2V_PATH "/tmp/diversutils_test_batch.bin"
+#define TEST_BATCH_JSONL_FORMAT "/tmp/diversutils_test_batch_%u.jsonl"
+#define TEST_BATCH_STANDALONE_FORMAT "/tmp/diversutils_test_batch_standalone_%u.tsv"
+#define TEST_BATCH_BATCH_FORMAT "/tmp/diversutils_test_batch_batch_%u.tsv"
+#define TEST_BATCH_MANIFEST_PATH "/tmp/diversutils_test_batch_manifest.tsv"
+#define TEST_BATCH_UNWRITABLE_PATH "/nonexistent/diversutils_test_batch.tsv"
+#define TEST_BATCH_NUM_VECTORS 200
+#define TEST_BATCH_NUM_DIMENSIONS 8
+#define TEST_BATCH_NUM_CORPORA 3
+#define TEST_BATCH_NUM_DOCUMENTS 60
+#define TEST_BATCH_NUM_TOKENS 20
+#define TEST_BATCH_STEP 5
+
+struct test_batch_corpus {
+	struct word2vec * w2v;
+	char * path;
+	char output_path[64];
+	int32_t status;
+};
+
+static int32_t test_batch_write_inputs(char ** const paths){
+	FILE * f = fopen(TEST_BATCH_W2V_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); return 1;}
+	fprintf(f, "%u %u\n", TEST_BATCH_NUM_VECTORS, TEST_BATCH_NUM_DIMENSIONS);
+	for(uint32_t i = 0 ; i < TEST_BATCH_NUM_VECTORS ; i++){
+		float vector[TEST_BATCH_NUM_DIMENSIONS];
+		for(uint32_t d = 0 ; d < TEST_BATCH_NUM_DIMENSIONS ; d++){vector[d] = (float) ((int32_t) ((i * 13 + d * 29 + i * d) % 19) - 9);}
+		fprintf(f, "w%u ", i);
+		fwrite(vector, sizeof(float), TEST_BATCH_NUM_DIMENSIONS, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+
+	// the corpora overlap on part of their vocabulary, so that some entries are nodes of several graphs at once
+	for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+		paths[c] = malloc(64);
+		if(paths[c] == NULL){return 1;}
+		snprintf(paths[c], 64, TEST_BATCH_JSONL_FORMAT, c);
+		f = fopen(paths[c], "w");
+		if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic jsonl file"); return 1;}
+		for(uint32_t d = 0 ; d < TEST_BATCH_NUM_DOCUMENTS ; d++){
+			fprintf(f, "{\"id\": \"c%ud%u\", \"text\": \"", c, d);
+			for(uint32_t t = 0 ; t < TEST_BATCH_NUM_TOKENS ; t++){
+				const uint32_t r = (d * 7919 + t * 104729 + c * 31) % (3 + d + t);
+				const uint32_t index = (c * 50 + (r * r) % 120) % TEST_BATCH_NUM_VECTORS;
+				if(t % 9 == 8){
+					fprintf(f, "%soov%u_%u", t == 0 ? "" : " ", c, r);
+				} else {
+					fprintf(f, "%sw%u", t == 0 ? "" : " ", index);
+				}
+			}
+			fprintf(f, "\"}\n");
+		}
+		fclose(f);
+	}
+	return 0;
+}
+
+static void test_batch_remove_inputs(char ** const paths){
+	remove(TEST_BATCH_W2V_PATH);
+	for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+		if(paths[c] == NULL){continue;}
+		remove(paths[c]);
+		free(paths[c]);
+		paths[c] = NULL;
+	}
+}
+
+// measures one corpus as main_measurement does: read by its own queue without a batch, or with the other corpora of the batch
+static int32_t test_batch_corpus(struct batch * const b, const int32_t k, void * const arg){
+	struct test_batch_corpus * const c = (struct test_batch_corpus *) arg;
+	struct graph g;
+	struct minimum_spanning_tree mst = {0};
+	struct graph_distance_heap heap = {0};
+	struct oov_counter oov;
+	struct output_stream output;
+	int32_t result = 0;
+
+	c->status = 1;
+	if(create_graph_empty(&g) != 0){return 1;}
+	if(graph_bind_word2vec(&g, c->w2v) != 0){free_graph(&g); return 1;}
+	if(create_oov_counter(&oov, 0) != 0){free_graph(&g); return 1;}
+	if(create_output_stream(&output, c->output_path, OUTPUT_FORMAT_TSV, OUTPUT_COMPRESSION_NONE, 1) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to open output file");
+		free_oov_counter(&oov);
+		free_graph(&g);
+		return 1;
+	}
+
+	struct measurement_configuration mcfg = {
+		.target_column = UD_FORM,
+		.jsonl_content_key = "text",
+		.div_param = (struct measurement_diversity_parameters) {
+			.stirling_alpha = 1.0,
+			.stirling_beta = 1.0,
+			.leinster_cobbold_diversity_alpha = 2.0,
+			.renyi_alpha = 2.0,
+			.hill_number_standard_alpha = 2.0,
+		},
+		.enable = (struct measurement_diversity_enabler) {
+			.stirling = 1,
+			.pairwise = 1,
+			.leinster_cobbold_diversity = 1,
+			.non_disparity_functions = 1,
+			.disparity_functions = 1,
+			.shannon_weaver_entropy = 1,
+			.renyi_entropy = 1,
+			.simpson_index = 1,
+			.hill_number_standard = 1,
+			.berger_parker_index = 1,
+		},
+		.io = (struct measurement_io) {
+			.w2v_path = TEST_BATCH_W2V_PATH,
+			.jsonl_content_key = "text",
+			.output = &output,
+		},
+		.threading = (struct measurement_threading) {
+			.num_row_threads = 2,
+			.num_matrix_threads = 2,
+			.num_file_reading_threads = 1,
+			.enable_multithreaded_matrix_generation = 1,
+		},
+		.steps = (struct measurement_step_parameters) {
+			.document = (struct measurement_step) {
+				.recompute_step = TEST_BATCH_STEP,
+				.enable_count_recompute_step = 1,
+			},
+		},
+	};
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.mst = &mst,
+		.heap = &heap,
+		.w2v = c->w2v,
+		.oov_discarded_because_not_in_vector_database = &oov,
+	};
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+		.document = (struct measurement_mutable_counters) { .count_target = 1, },
+	};
+	pthread_mutex_init(&(mmut.mutex), NULL);
+
+	int32_t i = 0;
+	if(b != NULL){
+		const struct file_queue_corpus corpus = {
+			.paths = &(c->path),
+			.num_paths = 1,
+			.mcfg = &mcfg,
+			.sref = &sref,
+			.mmut = &mmut,
+		};
+		if(batch_read(b, k, &corpus, &i) != 0){result = 1;}
+	} else {
+		struct file_queue q;
+		if(create_file_queue(&q, &(c->path), NULL, 1, 0) != 0){
+			result = 1;
+		} else {
+			if(file_queue_read(&q, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+			i = q.num_done;
+			free_file_queue(&q);
+		}
+	}
+	if(i != 1){result = 1;}
+
+	pthread_mutex_lock(&(g.mutex_nodes));
+	if(result == 0){
+		mmut.num_oov_types = oov_counter_num_types(&oov);
+		if(compute_graph_relative_proportions(&g) != 0 || measurement_recompute_step(i, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+	}
+	pthread_mutex_unlock(&(g.mutex_nodes));
+
+	if(output_stream_finish(&output) != 0){result = 1;}
+	free_output_stream(&output);
+	pthread_mutex_destroy(&(mmut.mutex));
+	free_oov_counter(&oov);
+	free_graph(&g);
+	free_graph_distance_heap(&heap);
+	free_minimum_spanning_tree(&mst);
+	c->status = result;
+	return result;
+}
+
+static int32_t test_batch_read(const char * const path, char ** const content, size_t * const size){
+	FILE * const f = fopen(path, "r");
+	if(f == NULL){return 1;}
+	fseek(f, 0, SEEK_END);
+	*size = (size_t) ftell(f);
+	fseek(f, 0, SEEK_SET);
+	*content = malloc(*size + 1);
+	if(*content == NULL || fread(*content, 1, *size, f) != *size){fclose(f); free(*content); *content = NULL; return 1;}
+	(*content)[*size] = '\0';
+	fclose(f);
+	return 0;
+}
+
+// the output of corpus c read with the batch is that of corpus c measured alone
+static int32_t test_batch_compare(const uint32_t c){
+	char standalone_path[64];
+	char batch_path[64];
+	char * standalone = NULL;
+	char * batched = NULL;
+	size_t standalone_size = 0;
+	size_t batched_size = 0;
+	int32_t result = 0;
+	snprintf(standalone_path, 64, TEST_BATCH_STANDALONE_FORMAT, c);
+	snprintf(batch_path, 64, TEST_BATCH_BATCH_FORMAT, c);
+	if(test_batch_read(standalone_path, &standalone, &standalone_size) != 0 || test_batch_read(batch_path, &batched, &batched_size) != 0){
+		result = 1;
+	} else {
+		int32_t num_rows = 0;
+		for(size_t k = 0 ; k < standalone_size ; k++){num_rows += standalone[k] == '\n';}
+		if(num_rows != TEST_BATCH_NUM_DOCUMENTS / TEST_BATCH_STEP + 1){result = 1;}
+		if(standalone_size != batched_size || memcmp(standalone, batched, standalone_size) != 0){result = 1;}
+	}
+	free(standalone);
+	free(batched);
+	return result;
+}
+
+// in input order, the corpora of a queue take turns
+static int32_t test_batch_queue_order(char ** const paths){
+	struct file_queue_corpus corpora[2] = {
+		{ .paths = paths, .num_paths = 3, },
+		{ .paths = paths, .num_paths = 1, },
+	};
+	const int32_t expected_corpus[4] = {0, 1, 0, 0};
+	const int32_t expected_i[4] = {0, 0, 1, 2};
+	struct file_queue q;
+	const struct file_queue_entry * entry;
+	int32_t result = 0;
+
+	if(create_file_queue_corpora(&q, corpora, 2, 0) != 0){return 1;}
+	for(int32_t k = 0 ; k < 4 ; k++){
+		if(file_queue_pop(&q, &entry) != 0 || entry->corpus != expected_corpus[k] || entry->i != expected_i[k]){result = 1; break;}
+		file_queue_done(&q, entry, 0);
+	}
+	if(result == 0 && (file_queue_pop(&q, &entry) == 0 || corpora[0].num_done != 3 || corpora[1].num_done != 1)){result = 1;}
+	free_file_queue(&q);
+	return result;
+}
+
+static int32_t test_batch_manifest(void){
+	struct batch_manifest m;
+	int32_t result = 0;
+
+	FILE * const f = fopen(TEST_BATCH_MANIFEST_PATH, "w");
+	if(f == NULL){return 1;}
+	fprintf(f, "# name\tinput list\toutput prefix\n\nfr\tfr.txt\tout/fr_\nen\ten.txt\tout/en_\ten_tp.txt\n");
+	fclose(f);
+	if(read_batch_manifest(&m, TEST_BATCH_MANIFEST_PATH) != 0){
+		result = 1;
+	} else {
+		if(m.num_corpora != 2 || strcmp(m.corpora[0].name, "fr") != 0 || strcmp(m.corpora[0].input_path, "fr.txt") != 0 || strcmp(m.corpora[0].output_prefix, "out/fr_") != 0 || m.corpora[0].input_path_tp != NULL){result = 1;}
+		if(m.num_corpora == 2 && (m.corpora[1].input_path_tp == NULL || strcmp(m.corpora[1].input_path_tp, "en_tp.txt") != 0)){result = 1;}
+		free_batch_manifest(&m);
+	}
+
+	// a corpus without output prefix, and two corpora with the same name
+	const char * const invalid[2] = {"fr\tfr.txt\n", "fr\tfr.txt\tout/fr_\nfr\ten.txt\tout/en_\n"};
+	for(int32_t k = 0 ; k < 2 ; k++){
+		FILE * const g = fopen(TEST_BATCH_MANIFEST_PATH, "w");
+		if(g == NULL){return 1;}
+		fputs(invalid[k], g);
+		fclose(g);
+		if(read_batch_manifest(&m, TEST_BATCH_MANIFEST_PATH) == 0){
+			free_batch_manifest(&m);
+			result = 1;
+		}
+	}
+	remove(TEST_BATCH_MANIFEST_PATH);
+	return result;
+}
+
+int32_t test_batch_matches_standalone(void){
+	char * paths[TEST_BATCH_NUM_CORPORA] = {0};
+	struct test_batch_corpus corpora[TEST_BATCH_NUM_CORPORA];
+	void * args[TEST_BATCH_NUM_CORPORA];
+	struct word2vec w2v;
+	int32_t result = 0;
+
+	if(test_batch_write_inputs(paths) != 0 || load_word2vec_binary(&w2v, TEST_BATCH_W2V_PATH) != 0){
+		test_batch_remove_inputs(paths);
+		error_format(__FILE__, __func__, __LINE__, "test_batch_matches_standalone: FAIL");
+		return 1;
+	}
+
+	// each corpus alone, then all of them at once on as many reader threads, sharing the word2vec
+	for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+		corpora[c] = (struct test_batch_corpus) { .w2v = &w2v, .path = paths[c], };
+		snprintf(corpora[c].output_path, 64, TEST_BATCH_STANDALONE_FORMAT, c);
+		if(test_batch_corpus(NULL, (int32_t) c, &(corpora[c])) != 0){result = 1;}
+	}
+	for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+		snprintf(corpora[c].output_path, 64, TEST_BATCH_BATCH_FORMAT, c);
+		args[c] = &(corpora[c]);
+	}
+	if(result == 0 && batch_run(TEST_BATCH_NUM_CORPORA, TEST_BATCH_NUM_CORPORA, 0, test_batch_corpus, args) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call batch_run");
+		result = 1;
+	}
+
+	for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA && result == 0 ; c++){
+		if(test_batch_compare(c) != 0){result = 1;}
+	}
+
+	// a corpus that cannot open its output withdraws; the others are still read and written
+	if(result == 0){
+		for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+			char path[64];
+			snprintf(path, 64, TEST_BATCH_BATCH_FORMAT, c);
+			remove(path);
+		}
+		snprintf(corpora[0].output_path, 64, TEST_BATCH_UNWRITABLE_PATH);
+		if(batch_run(TEST_BATCH_NUM_CORPORA, TEST_BATCH_NUM_CORPORA, 0, test_batch_corpus, args) == 0 || corpora[0].status == 0){
+			error_format(__FILE__, __func__, __LINE__, "a corpus that withdrew did not fail the batch");
+			result = 1;
+		}
+		for(uint32_t c = 1 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+			if(corpora[c].status != 0 || test_batch_compare(c) != 0){
+				error_format(__FILE__, __func__, __LINE__, "a corpus that withdrew failed the others");
+				result = 1;
+			}
+		}
+	}
+
+	if(result == 0 && test_batch_queue_order(paths) != 0){
+		error_format(__FILE__, __func__, __LINE__, "corpora do not take turns in the queue");
+		result = 1;
+	}
+	if(result == 0 && test_batch_manifest() != 0){
+		error_format(__FILE__, __func__, __LINE__, "unexpected manifest parsing");
+		result = 1;
+	}
+
+	for(uint32_t c = 0 ; c < TEST_BATCH_NUM_CORPORA ; c++){
+		char path[64];
+		snprintf(path, 64, TEST_BATCH_STANDALONE_FORMAT, c);
+		remove(path);
+		snprintf(path, 64, TEST_BATCH_BATCH_FORMAT, c);
+		remove(path);
+	}
+	free_word2vec(&w2v);
+	test_batch_remove_inputs(paths);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_batch_matches_standalone: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_batch_matches_standalone: FAIL");
+	}
+	return result;
+}
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef TEST_CHECKPOINT_H
+#define TEST_CHECKPOINT_H
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "measurement.h"
+#include "recompute.h"
+#include "checkpoint.h"
+#include "file_queue.h"
+#include "oov/counter.h"
+#include "cupt/constants.h"
+
+#define TEST_CHECKPOINT_W2V_PATH "/tmp/diversutils_test_checkpoint.bin"
+#define TEST_CHECKPOINT_JSONL_FORMAT "/tmp/diversutils_test_checkpoint_%u.jsonl"
+#define TEST_CHECKPOINT_PATH "/tmp/diversutils_test_checkpoint.ckpt"
+#define TEST_CHECKPOINT_UNINTERRUPTED_PATH "/tmp/diversutils_test_checkpoint_uninterrupted.tsv"
+#define TEST_CHECKPOINT_RESUMED_PATH "/tmp/diversutils_test_checkpoint_resumed.tsv"
+#define TEST_CHECKPOINT_NUM_VECTORS 300
+#define TEST_CHECKPOINT_NUM_DIMENSIONS 12
+#define TEST_CHECKPOINT_NUM_FILES 3
+#define TEST_CHECKPOINT_NUM_DOCUMENTS 120
+#define TEST_CHECKPOINT_NUM_TOKENS 25
+#define TEST_CHECKPOINT_STEP 4
+#define TEST_CHECKPOINT_INTERVAL 0.002
+#define TEST_CHECKPOINT_KILL_AFTER 3
+
+static void test_checkpoint_remove_inputs(char ** const paths){
+	remove(TEST_CHECKPOINT_W2V_PATH);
+	for(uint32_t k = 0 ; k < TEST_CHECKPOINT_NUM_FILES ; k++){
+		if(paths[k] == NULL){continue;}
+		remove(paths[k]);
+		free(paths[k]);
+		paths[k] = NULL;
+	}
+}
+
+static int32_t test_checkpoint_write_inputs(char ** const paths){
+	FILE * f = fopen(TEST_CHECKPOINT_W2V_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); return 1;}
+	fprintf(f, "%u %u\n", TEST_CHECKPOINT_NUM_VECTORS, TEST_CHECKPOINT_NUM_DIMENSIONS);
+	for(uint32_t i = 0 ; i < TEST_CHECKPOINT_NUM_VECTORS ; i++){
+		float vector[TEST_CHECKPOINT_NUM_DIMENSIONS];
+		for(uint32_t d = 0 ; d < TEST_CHECKPOINT_NUM_DIMENSIONS ; d++){vector[d] = (float) ((int32_t) ((i * 31 + d * 17 + i * d) % 23) - 11);}
+		fprintf(f, "w%u ", i);
+		fwrite(vector, sizeof(float), TEST_CHECKPOINT_NUM_DIMENSIONS, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+
+	// a vocabulary that keeps growing across the files, with a few words missing from the vectors
+	for(uint32_t k = 0 ; k < TEST_CHECKPOINT_NUM_FILES ; k++){
+		paths[k] = malloc(64);
+		if(paths[k] == NULL){return 1;}
+		snprintf(paths[k], 64, TEST_CHECKPOINT_JSONL_FORMAT, k);
+		f = fopen(paths[k], "w");
+		if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic jsonl file"); return 1;}
+		for(uint32_t d = 0 ; d < TEST_CHECKPOINT_NUM_DOCUMENTS ; d++){
+			const uint32_t n = k * TEST_CHECKPOINT_NUM_DOCUMENTS + d;
+			fprintf(f, "{\"id\": \"f%ud%u\", \"text\": \"", k, d);
+			for(uint32_t t = 0 ; t < TEST_CHECKPOINT_NUM_TOKENS ; t++){
+				const uint32_t range = 2 + n + t % 7;
+				const uint32_t r = (n * 7919 + t * 104729) % range;
+				if(t % 11 == 10){
+					fprintf(f, "%soov%u", t == 0 ? "" : " ", r);
+				} else {
+					fprintf(f, "%sw%u", t == 0 ? "" : " ", ((r * r) / range) % TEST_CHECKPOINT_NUM_VECTORS);
+				}
+			}
+			fprintf(f, "\"}\n");
+		}
+		fclose(f);
+	}
+	return 0;
+}
+
+struct test_checkpoint_killer {
+	struct checkpoint * cp;
+	volatile uint8_t stop;
+};
+
+// SIGKILLs the whole process once a few checkpoints were written, wherever the readers are
+static void * test_checkpoint_killer_thread(void * args){
+	struct test_checkpoint_killer * const killer = (struct test_checkpoint_killer *) args;
+	while(!__atomic_load_n(&(killer->stop), __ATOMIC_ACQUIRE)){
+		if(checkpoint_num_written(killer->cp) >= TEST_CHECKPOINT_KILL_AFTER){kill(getpid(), SIGKILL);}
+		usleep(100);
+	}
+	return NULL;
+}
+
+/*
+ * Reads the synthetic files as main_measurement does, one reader thread, a row every TEST_CHECKPOINT_STEP documents.
+ * With use_checkpoint, checkpoints are written (and resumed from, if resume), steps are computed by a recompute thread,
+ * and with kill the process is killed once a few checkpoints were written.
+ */
+static int32_t test_checkpoint_run(struct word2vec * const w2v, char ** const paths, const char * const output_path, const uint8_t use_checkpoint, const uint8_t resume, const uint8_t kill_after_checkpoints, uint8_t * const resumed){
+	struct graph g;
+	struct minimum_spanning_tree mst = {0};
+	struct graph_distance_heap heap = {0};
+	struct oov_counter oov;
+	struct recompute_worker recompute;
+	struct checkpoint cp;
+	struct file_queue q;
+	struct output_stream output;
+	int32_t result = 0;
+
+	*resumed = 0;
+	if(create_graph_empty(&g) != 0){return 1;}
+	if(graph_bind_word2vec(&g, w2v) != 0){free_graph(&g); return 1;}
+	if(create_oov_counter(&oov, 0) != 0){free_graph(&g); return 1;}
+	if(use_checkpoint && create_checkpoint(&cp, TEST_CHECKPOINT_PATH, TEST_CHECKPOINT_INTERVAL, paths, TEST_CHECKPOINT_NUM_FILES) != 0){free_oov_counter(&oov); free_graph(&g); return 1;}
+	if(use_checkpoint && resume && checkpoint_open(&cp, resumed) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call checkpoint_open");
+		free_checkpoint(&cp);
+		free_oov_counter(&oov);
+		free_graph(&g);
+		return 1;
+	}
+	const int32_t output_status = *resumed ? create_output_stream_resumed(&output, output_path, OUTPUT_FORMAT_TSV, OUTPUT_COMPRESSION_NONE, 1, cp.output_sizes[0]) : create_output_stream(&output, output_path, OUTPUT_FORMAT_TSV, OUTPUT_COMPRESSION_NONE, 1);
+	if(output_status != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to open output file");
+		if(use_checkpoint){free_checkpoint(&cp);}
+		free_oov_counter(&oov);
+		free_graph(&g);
+		return 1;
+	}
+	output_header(&output, "num_active_files\tnum_sentences_containing_mwe\tnum_sentences_containing_mwe_tp_only\tnum_all_sentences\tnum_documents\tw2v\tnum_discarded_types\ts\tn\tmu_dist\tsigma_dist\n");
+
+	struct measurement_configuration mcfg = {
+		.target_column = UD_FORM,
+		.jsonl_content_key = "text",
+		.div_param = (struct measurement_diversity_parameters) {
+			.stirling_alpha = 1.0,
+			.stirling_beta = 1.0,
+			.leinster_cobbold_diversity_alpha = 2.0,
+			.renyi_alpha = 2.0,
+			.hill_number_standard_alpha = 2.0,
+		},
+		.enable = (struct measurement_diversity_enabler) {
+			.stirling = 1,
+			.pairwise = 1,
+			.leinster_cobbold_diversity = 1,
+			.non_disparity_functions = 1,
+			.disparity_functions = 1,
+			.shannon_weaver_entropy = 1,
+			.renyi_entropy = 1,
+			.simpson_index = 1,
+			.hill_number_standard = 1,
+			.berger_parker_index = 1,
+		},
+		.io = (struct measurement_io) {
+			.w2v_path = TEST_CHECKPOINT_W2V_PATH,
+			.jsonl_content_key = "text",
+			.output = &output,
+		},
+		.threading = (struct measurement_threading) {
+			.num_row_threads = 2,
+			.num_matrix_threads = 2,
+			.num_file_reading_threads = 1,
+			.enable_multithreaded_matrix_generation = 1,
+			.recompute_queue_size = use_checkpoint ? 2 : 0,
+		},
+		.steps = (struct measurement_step_parameters) {
+			.document = (struct measurement_step) {
+				.recompute_step = TEST_CHECKPOINT_STEP,
+				.enable_count_recompute_step = 1,
+			},
+		},
+	};
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.mst = &mst,
+		.heap = &heap,
+		.w2v = w2v,
+		.oov_discarded_because_not_in_vector_database = &oov,
+		.recompute = use_checkpoint ? &recompute : NULL,
+		.checkpoint = use_checkpoint ? &cp : NULL,
+	};
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+		.document = (struct measurement_mutable_counters) { .count_target = 1, },
+	};
+	pthread_mutex_init(&(mmut.mutex), NULL);
+
+	if(*resumed && checkpoint_restore(&cp, &sref, &mmut) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call checkpoint_restore");
+		result = 1;
+	}
+	const uint8_t worker_created = result == 0 && sref.recompute != NULL && create_recompute_worker(&recompute, &mcfg, &sref, &mmut, 2) == 0;
+	if(result == 0 && sref.recompute != NULL && !worker_created){result = 1;}
+	if(result == 0 && use_checkpoint && checkpoint_start(&cp, &mcfg, &sref, &mmut) != 0){result = 1;}
+
+	struct test_checkpoint_killer killer = { .cp = &cp, .stop = 0, };
+	pthread_t killer_thread;
+	const uint8_t killer_created = result == 0 && kill_after_checkpoints && pthread_create(&killer_thread, NULL, test_checkpoint_killer_thread, &killer) == 0;
+
+	int32_t i = 0;
+	if(result == 0 && create_file_queue(&q, paths, NULL, TEST_CHECKPOINT_NUM_FILES, 0) == 0){
+		if(file_queue_read(&q, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+		i = q.num_done;
+		free_file_queue(&q);
+	} else {
+		result = 1;
+	}
+	if(use_checkpoint && checkpoint_stop(&cp) != 0){result = 1;}
+	if(killer_created){
+		__atomic_store_n(&(killer.stop), 1, __ATOMIC_RELEASE);
+		pthread_join(killer_thread, NULL);
+	}
+
+	// final step, as in main_measurement
+	pthread_mutex_lock(&(g.mutex_nodes));
+	if(worker_created){
+		if(result == 0 && recompute_worker_submit(&recompute, i, &g, &mmut, oov_counter_num_types(&oov), 1) != 0){result = 1;}
+		if(recompute_worker_finish(&recompute) != 0){result = 1;}
+		free_recompute_worker(&recompute);
+	} else if(result == 0){
+		mmut.num_oov_types = oov_counter_num_types(&oov);
+		if(compute_graph_relative_proportions(&g) != 0 || measurement_recompute_step(i, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+	}
+	pthread_mutex_unlock(&(g.mutex_nodes));
+
+	if(output_stream_finish(&output) != 0){result = 1;}
+	free_output_stream(&output);
+	if(use_checkpoint){
+		if(result == 0 && checkpoint_remove(&cp) != 0){result = 1;}
+		free_checkpoint(&cp);
+	}
+	pthread_mutex_destroy(&(mmut.mutex));
+	free_oov_counter(&oov);
+	free_graph(&g);
+	free_graph_distance_heap(&heap);
+	free_minimum_spanning_tree(&mst);
+	return result;
+}
+
+static int32_t test_checkpoint_read(const char * const path, char ** const content, size_t * const size){
+	FILE * const f = fopen(path, "r");
+	if(f == NULL){return 1;}
+	fseek(f, 0, SEEK_END);
+	*size = (size_t) ftell(f);
+	fseek(f, 0, SEEK_SET);
+	*content = malloc(*size + 1);
+	if(*content == NULL || fread(*content, 1, *size, f) != *size){fclose(f); free(*content); *content = NULL; return 1;}
+	(*content)[*size] = '\0';
+	fclose(f);
+	return 0;
+}
+
+int32_t test_checkpoint_resume(void){
+	char * paths[TEST_CHECKPOINT_NUM_FILES] = {0};
+	struct word2vec w2v;
+	char * uninterrupted = NULL;
+	char * resumed_content = NULL;
+	size_t uninterrupted_size = 0;
+	size_t resumed_size = 0;
+	uint8_t resumed = 0;
+	int32_t result = 0;
+
+	remove(TEST_CHECKPOINT_PATH);
+	if(test_checkpoint_write_inputs(paths) != 0 || load_word2vec_binary(&w2v, TEST_CHECKPOINT_W2V_PATH) != 0){
+		test_checkpoint_remove_inputs(paths);
+		error_format(__FILE__, __func__, __LINE__, "test_checkpoint_resume: FAIL");
+		return 1;
+	}
+
+	if(test_checkpoint_run(&w2v, paths, TEST_CHECKPOINT_UNINTERRUPTED_PATH, 0, 0, 0, &resumed) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to measure the synthetic corpus");
+		result = 1;
+	}
+
+	// killed in the middle of the corpus, with checkpoints every few milliseconds
+	if(result == 0){
+		fflush(stdout);
+		fflush(stderr);
+		const pid_t pid = fork();
+		if(pid == 0){
+			uint8_t ignored;
+			test_checkpoint_run(&w2v, paths, TEST_CHECKPOINT_RESUMED_PATH, 1, 0, 1, &ignored);
+			_exit(0); // only reached when the corpus was read before the kill
+		}
+		int status = 0;
+		if(pid < 0 || waitpid(pid, &status, 0) != pid){
+			error_format(__FILE__, __func__, __LINE__, "failed to run the interrupted measurement");
+			result = 1;
+		} else if(!WIFSIGNALED(status) || WTERMSIG(status) != SIGKILL || access(TEST_CHECKPOINT_PATH, F_OK) != 0){
+			error_format(__FILE__, __func__, __LINE__, "the interrupted measurement was not killed after a checkpoint");
+			result = 1;
+		}
+	}
+
+	if(result == 0 && test_checkpoint_run(&w2v, paths, TEST_CHECKPOINT_RESUMED_PATH, 1, 1, 0, &resumed) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to resume the measurement");
+		result = 1;
+	}
+	if(result == 0 && (!resumed || access(TEST_CHECKPOINT_PATH, F_OK) == 0)){
+		error_format(__FILE__, __func__, __LINE__, "no checkpoint was resumed from, or it was left behind");
+		result = 1;
+	}
+
+	// the resumed run emits the rows that the uninterrupted one did, and nothing else
+	if(result == 0){
+		if(test_checkpoint_read(TEST_CHECKPOINT_UNINTERRUPTED_PATH, &uninterrupted, &uninterrupted_size) != 0 || test_checkpoint_read(TEST_CHECKPOINT_RESUMED_PATH, &resumed_content, &resumed_size) != 0){
+			result = 1;
+		} else {
+			int32_t num_rows = 0;
+			for(size_t k = 0 ; k < uninterrupted_size ; k++){num_rows += uninterrupted[k] == '\n';}
+			if(num_rows != 1 + (TEST_CHECKPOINT_NUM_FILES * TEST_CHECKPOINT_NUM_DOCUMENTS) / TEST_CHECKPOINT_STEP + 1){result = 1;}
+			if(uninterrupted_size != resumed_size || memcmp(uninterrupted, resumed_content, uninterrupted_size) != 0){result = 1;}
+		}
+	}
+
+	free(uninterrupted);
+	free(resumed_content);
+	free_word2vec(&w2v);
+	test_checkpoint_remove_inputs(paths);
+	remove(TEST_CHECKPOINT_PATH);
+	remove(TEST_CHECKPOINT_PATH ".tmp");
+	remove(TEST_CHECKPOINT_UNINTERRUPTED_PATH);
+	remove(TEST_CHECKPOINT_RESUMED_PATH);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_checkpoint_resume: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_checkpoint_resume: FAIL");
+	}
+	return result;
+}
+
+#endif
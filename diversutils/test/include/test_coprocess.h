@@ -0,0 +1,195 @@
+#ifndef TEST_COPROCESS_H
+#define TEST_COPROCESS_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "udpipe/coprocess.h"
+
+// set by the makefile to the absolute path of the mock; the fallback only works from the diversutils directory
+#ifndef TEST_COPROCESS_MOCK_PATH
+#define TEST_COPROCESS_MOCK_PATH "test/mock_tokenizer"
+#endif
+#define TEST_COPROCESS_NUM_DOCUMENTS 200
+#define TEST_COPROCESS_NUM_THREADS 4
+#define TEST_COPROCESS_NUM_CHILDREN 2
+#define TEST_COPROCESS_TEXT_SIZE 1024
+#define TEST_COPROCESS_TOKEN_SIZE 32
+#define TEST_COPROCESS_LARGE_NUM_LINES 20000
+
+static char * test_coprocess_argv[] = {TEST_COPROCESS_MOCK_PATH, NULL};
+static char * test_coprocess_argv_crash[] = {TEST_COPROCESS_MOCK_PATH, "--crash-after=100", NULL};
+
+static const char * const test_coprocess_words[] = {"le", "chat", "du", "voisin", "dort", "sur", "un", "tapis", "rouge", "ce", "matin"};
+
+static void test_coprocess_document(const uint32_t d, char * const text){
+	const size_t num_words = sizeof(test_coprocess_words) / sizeof(test_coprocess_words[0]);
+	const uint32_t len = 1 + (d * 7) % 23; // at most 23 chunks of at most 4 words, well below the crash point of the mock
+	size_t size = 0;
+	text[0] = '\0';
+	for(uint32_t w = 0 ; w < len ; w++){
+		size += (size_t) snprintf(text + size, TEST_COPROCESS_TEXT_SIZE - size, "%s%s%s", w == 0 ? "" : ((d + w) % 5 == 0 ? "\n" : " "), test_coprocess_words[(d * 3 + w * 5) % num_words], (d + w) % 4 == 0 ? "." : ((d + w) % 9 == 0 ? "?!" : ""));
+	}
+}
+
+// what the mock tokenizer is expected to answer: whitespace-separated chunks, trailing punctuation split off, "du" expanded
+static int32_t test_coprocess_expected(const char * const text, char expected[][TEST_COPROCESS_TOKEN_SIZE], const int32_t capacity){
+	int32_t n = 0;
+	size_t start = 0;
+	const size_t text_size = strlen(text);
+	for(size_t i = 0 ; i <= text_size ; i++){
+		if(i < text_size && text[i] != ' ' && text[i] != '\n'){continue;}
+		if(i > start){
+			size_t stem_size = i - start;
+			while(stem_size > 1 && strchr(".,!?;:", text[start + stem_size - 1]) != NULL){stem_size--;}
+			if(stem_size == 2 && memcmp(text + start, "du", 2) == 0){
+				if(n + 2 > capacity){return -1;}
+				strcpy(expected[n++], "de");
+				strcpy(expected[n++], "le");
+			} else {
+				if(n + 1 > capacity){return -1;}
+				memcpy(expected[n], text + start, stem_size);
+				expected[n++][stem_size] = '\0';
+			}
+			for(size_t j = start + stem_size ; j < i ; j++){
+				if(n + 1 > capacity){return -1;}
+				expected[n][0] = text[j];
+				expected[n++][1] = '\0';
+			}
+		}
+		start = i + 1;
+	}
+	return n;
+}
+
+static int32_t test_coprocess_check_document(struct udpipe_coprocess * const cp, const uint32_t d){
+	char text[TEST_COPROCESS_TEXT_SIZE];
+	char expected[128][TEST_COPROCESS_TOKEN_SIZE];
+	char token[TEST_COPROCESS_TOKEN_SIZE];
+	int8_t end_of_document = 0;
+	int32_t n = 0;
+
+	test_coprocess_document(d, text);
+	const int32_t num_expected = test_coprocess_expected(text, expected, 128);
+	if(num_expected < 0){return 1;}
+	if(udpipe_coprocess_submit(cp, text, strlen(text)) != 0){return 1;}
+	while(1){
+		if(udpipe_coprocess_next_token(cp, token, TEST_COPROCESS_TOKEN_SIZE, &end_of_document) != 0){return 1;}
+		if(end_of_document){break;}
+		if(n >= num_expected || strcmp(token, expected[n]) != 0){return 1;}
+		n++;
+	}
+	return n != num_expected;
+}
+
+static void * test_coprocess_thread(void * args){
+	const uint32_t offset = *((const uint32_t *) args);
+	for(uint32_t d = 0 ; d < TEST_COPROCESS_NUM_DOCUMENTS ; d++){
+		struct udpipe_coprocess * const cp = udpipe_coprocess_pool_acquire();
+		const int32_t result = test_coprocess_check_document(cp, offset + d);
+		udpipe_coprocess_pool_release(cp);
+		if(result != 0){return (void*) 1;}
+	}
+	return NULL;
+}
+
+int32_t test_coprocess_pool(void){
+	int32_t result = 0;
+	uint32_t offsets[TEST_COPROCESS_NUM_THREADS];
+	pthread_t threads[TEST_COPROCESS_NUM_THREADS];
+
+	if(udpipe_coprocess_pool_create(test_coprocess_argv, TEST_COPROCESS_NUM_CHILDREN) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call udpipe_coprocess_pool_create");
+		return 1;
+	}
+	for(int32_t i = 0 ; i < TEST_COPROCESS_NUM_THREADS ; i++){
+		offsets[i] = (uint32_t) i * TEST_COPROCESS_NUM_DOCUMENTS;
+		if(pthread_create(&(threads[i]), NULL, test_coprocess_thread, &(offsets[i])) != 0){
+			error_format(__FILE__, __func__, __LINE__, "failed to call pthread_create");
+			udpipe_coprocess_pool_free();
+			return 1;
+		}
+	}
+	for(int32_t i = 0 ; i < TEST_COPROCESS_NUM_THREADS ; i++){
+		void * thread_result = NULL;
+		pthread_join(threads[i], &thread_result);
+		if(thread_result != NULL){result = 1;}
+	}
+	udpipe_coprocess_pool_free();
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_coprocess_pool: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_coprocess_pool: FAIL");
+	}
+	return result;
+}
+
+// the mock dies in the middle of its 100th word, so every few documents one straddles a restart
+int32_t test_coprocess_restart(void){
+	struct udpipe_coprocess cp;
+	int32_t result = 0;
+
+	if(create_udpipe_coprocess(&cp, test_coprocess_argv_crash) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_udpipe_coprocess");
+		return 1;
+	}
+	for(uint32_t d = 0 ; d < TEST_COPROCESS_NUM_DOCUMENTS && result == 0 ; d++){
+		result = test_coprocess_check_document(&cp, d);
+	}
+	free_udpipe_coprocess(&cp);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_coprocess_restart: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_coprocess_restart: FAIL");
+	}
+	return result;
+}
+
+// a document much larger than the pipe buffers, answered while it is being written
+int32_t test_coprocess_large_document(void){
+	struct udpipe_coprocess cp;
+	char token[TEST_COPROCESS_TOKEN_SIZE];
+	int8_t end_of_document = 0;
+	int32_t result = 0;
+	int64_t n = 0;
+
+	const char * const line = "chat chat chat chat chat chat chat chat chat chat\n";
+	const size_t line_size = strlen(line);
+	char * const text = malloc(TEST_COPROCESS_LARGE_NUM_LINES * line_size + 1);
+	if(text == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); return 1;}
+	for(int32_t i = 0 ; i < TEST_COPROCESS_LARGE_NUM_LINES ; i++){memcpy(text + i * line_size, line, line_size);}
+	text[TEST_COPROCESS_LARGE_NUM_LINES * line_size] = '\0';
+
+	if(create_udpipe_coprocess(&cp, test_coprocess_argv) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_udpipe_coprocess");
+		free(text);
+		return 1;
+	}
+	if(udpipe_coprocess_submit(&cp, text, TEST_COPROCESS_LARGE_NUM_LINES * line_size) != 0){
+		result = 1;
+	}
+	while(result == 0){
+		if(udpipe_coprocess_next_token(&cp, token, TEST_COPROCESS_TOKEN_SIZE, &end_of_document) != 0){result = 1; break;}
+		if(end_of_document){break;}
+		if(strcmp(token, "chat") != 0){result = 1; break;}
+		n++;
+	}
+	if(n != ((int64_t) TEST_COPROCESS_LARGE_NUM_LINES) * 10){result = 1;}
+	free_udpipe_coprocess(&cp);
+	free(text);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_coprocess_large_document: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_coprocess_large_document: FAIL");
+	}
+	return result;
+}
+
+#endif
@@ -21,7 +21,7 @@ int32_t test_shannon_weaver_entropy(void){
 		if(request_more_capacity_graph(&g) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call request_more_capacity_graph"); free_graph(&g); return 1;}
 
 		for(uint64_t i = 0 ; i < n ; i++){
-			g.nodes[i] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
+			(*graph_node_at(&g, i)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
 		}
 
 		double res_entropy;
@@ -46,7 +46,7 @@ int32_t test_shannon_weaver_entropy(void){
 		}
 	
 		if(n > 1){
-			g.nodes[0].absolute_proportion = 2;
+			graph_node_at(&g, 0)->absolute_proportion = 2;
 			compute_graph_relative_proportions(&g);
 			shannon_weaver_entropy_from_graph(&g, &res_entropy, &res_hill_number);
 			res_entropy = round(res_entropy * 1000000.0) / 1000000.0;
@@ -76,7 +76,7 @@ int32_t test_renyi_entropy(void){
 			if(request_more_capacity_graph(&g) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call request_more_capacity_graph"); free_graph(&g); return 1;}
 	
 			for(uint64_t i = 0 ; i < n ; i++){
-				g.nodes[i] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
+				(*graph_node_at(&g, i)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
 			}
 	
 			double res_entropy;
@@ -101,7 +101,7 @@ int32_t test_renyi_entropy(void){
 			}
 		
 			if(n > 1 && alpha > 0.0){
-				g.nodes[0].absolute_proportion = 2;
+				graph_node_at(&g, 0)->absolute_proportion = 2;
 				compute_graph_relative_proportions(&g);
 				renyi_entropy_from_graph(&g, &res_entropy, &res_hill_number, alpha);
 				res_entropy = round(res_entropy * 1000000.0) / 1000000.0;
@@ -132,7 +132,7 @@ int32_t test_patil_taillie_entropy(void){
 			if(request_more_capacity_graph(&g) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call request_more_capacity_graph"); free_graph(&g); return 1;}
 	
 			for(uint64_t i = 0 ; i < n ; i++){
-				g.nodes[i] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
+				(*graph_node_at(&g, i)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
 			}
 	
 			double res_entropy;
@@ -161,7 +161,7 @@ int32_t test_patil_taillie_entropy(void){
 			}
 		
 			if(n > 1 && alpha > 0.0){
-				g.nodes[0].absolute_proportion = 10;
+				graph_node_at(&g, 0)->absolute_proportion = 10;
 				compute_graph_relative_proportions(&g);
 				patil_taillie_entropy_from_graph(&g, &res_entropy, &res_hill_number, alpha);
 				res_entropy = round(res_entropy * 1000000.0) / 1000000.0;
@@ -192,7 +192,7 @@ int32_t test_q_logarithmic_entropy(void){
 			if(request_more_capacity_graph(&g) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call request_more_capacity_graph"); free_graph(&g); return 1;}
 	
 			for(uint64_t i = 0 ; i < n ; i++){
-				g.nodes[i] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
+				(*graph_node_at(&g, i)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
 			}
 	
 			double res_entropy;
@@ -217,7 +217,7 @@ int32_t test_q_logarithmic_entropy(void){
 			}
 		
 			if(n > 1 && q > 0.0){
-				g.nodes[0].absolute_proportion = 10;
+				graph_node_at(&g, 0)->absolute_proportion = 10;
 				compute_graph_relative_proportions(&g);
 				q_logarithmic_entropy_from_graph(&g, &res_entropy, &res_hill_number, q);
 				res_entropy = round(res_entropy * 1000000.0) / 1000000.0;
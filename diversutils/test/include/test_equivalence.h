@@ -21,7 +21,7 @@ int32_t test_equivalence_entropy(void){
 			if(request_more_capacity_graph(&g) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call request_more_capacity_graph"); free_graph(&g); return 1;}
 	
 			for(uint64_t i = 0 ; i < n ; i++){
-				g.nodes[i] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
+				(*graph_node_at(&g, i)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
 			}
 	
 			double res_shannon_weaver_entropy, res_shannon_weaver_hill_number;
@@ -73,7 +73,7 @@ int32_t test_equivalence_entropy(void){
 		
 			// uneven
 			if(n > 1 && alpha > 0.0){
-				g.nodes[0].absolute_proportion = 2;
+				graph_node_at(&g, 0)->absolute_proportion = 2;
 				shannon_weaver_entropy_from_graph(&g, &res_shannon_weaver_entropy, &res_shannon_weaver_hill_number);
 				renyi_entropy_from_graph(&g, &res_renyi_entropy, &res_renyi_hill_number, alpha);
 				patil_taillie_entropy_from_graph(&g, &res_patil_taillie_entropy, &res_patil_taillie_hill_number, alpha - 1.0);
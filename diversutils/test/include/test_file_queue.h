@@ -0,0 +1,210 @@
+#ifndef TEST_FILE_QUEUE_H
+#define TEST_FILE_QUEUE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "measurement.h"
+#include "file_queue.h"
+#include "oov/counter.h"
+#include "cupt/constants.h"
+
+#define TEST_FILE_QUEUE_W2V_PATH "/tmp/diversutils_test_file_queue.bin"
+#define TEST_FILE_QUEUE_JSONL_FORMAT "/tmp/diversutils_test_file_queue_%u.jsonl"
+#define TEST_FILE_QUEUE_NUM_VECTORS 200
+#define TEST_FILE_QUEUE_NUM_DIMENSIONS 8
+#define TEST_FILE_QUEUE_NUM_FILES 300
+#define TEST_FILE_QUEUE_NUM_TOKENS 12
+#define TEST_FILE_QUEUE_NUM_THREADS 4
+
+// a few large files among many small ones, in no particular order of size
+static uint32_t test_file_queue_num_documents(const uint32_t f){
+	return f % 37 == 5 ? 200 + f : 1 + (f * 7) % 5;
+}
+
+static void test_file_queue_remove_inputs(char ** const paths){
+	remove(TEST_FILE_QUEUE_W2V_PATH);
+	for(uint32_t f = 0 ; f < TEST_FILE_QUEUE_NUM_FILES ; f++){
+		if(paths[f] == NULL){continue;}
+		remove(paths[f]);
+		free(paths[f]);
+		paths[f] = NULL;
+	}
+}
+
+static int32_t test_file_queue_write_inputs(char ** const paths){
+	FILE * f = fopen(TEST_FILE_QUEUE_W2V_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); return 1;}
+	fprintf(f, "%u %u\n", TEST_FILE_QUEUE_NUM_VECTORS, TEST_FILE_QUEUE_NUM_DIMENSIONS);
+	for(uint32_t i = 0 ; i < TEST_FILE_QUEUE_NUM_VECTORS ; i++){
+		float vector[TEST_FILE_QUEUE_NUM_DIMENSIONS];
+		for(uint32_t d = 0 ; d < TEST_FILE_QUEUE_NUM_DIMENSIONS ; d++){vector[d] = (float) ((int32_t) ((i * 13 + d * 29) % 19) - 9);}
+		fprintf(f, "w%u ", i);
+		fwrite(vector, sizeof(float), TEST_FILE_QUEUE_NUM_DIMENSIONS, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+
+	for(uint32_t k = 0 ; k < TEST_FILE_QUEUE_NUM_FILES ; k++){
+		paths[k] = malloc(64);
+		if(paths[k] == NULL){return 1;}
+		snprintf(paths[k], 64, TEST_FILE_QUEUE_JSONL_FORMAT, k);
+		f = fopen(paths[k], "w");
+		if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic jsonl file"); return 1;}
+		const uint32_t num_documents = test_file_queue_num_documents(k);
+		for(uint32_t d = 0 ; d < num_documents ; d++){
+			fprintf(f, "{\"id\": \"f%ud%u\", \"text\": \"", k, d);
+			for(uint32_t t = 0 ; t < TEST_FILE_QUEUE_NUM_TOKENS ; t++){
+				const uint32_t r = (k * 7919 + d * 104729 + t * 1299709) % (TEST_FILE_QUEUE_NUM_VECTORS + 20);
+				if(r >= TEST_FILE_QUEUE_NUM_VECTORS){
+					fprintf(f, "%soov%u", t == 0 ? "" : " ", r);
+				} else {
+					fprintf(f, "%sw%u", t == 0 ? "" : " ", (r * r) % TEST_FILE_QUEUE_NUM_VECTORS);
+				}
+			}
+			fprintf(f, "\"}\n");
+		}
+		fclose(f);
+	}
+	return 0;
+}
+
+// reads every file into a fresh graph, without any recompute step, and keeps the count of every vector
+static int32_t test_file_queue_run(struct word2vec * const w2v, char ** const paths, const uint8_t largest_first, const int32_t num_threads, uint32_t * const counts, int64_t * const num_oov_types){
+	struct graph g;
+	struct oov_counter oov;
+	struct file_queue q;
+	int32_t result = 0;
+
+	if(create_graph_empty(&g) != 0){return 1;}
+	if(graph_bind_word2vec(&g, w2v) != 0){free_graph(&g); return 1;}
+	if(create_oov_counter(&oov, 0) != 0){free_graph(&g); return 1;}
+
+	struct measurement_configuration mcfg = {
+		.target_column = UD_FORM,
+		.jsonl_content_key = "text",
+		.io = (struct measurement_io) {
+			.w2v_path = TEST_FILE_QUEUE_W2V_PATH,
+			.jsonl_content_key = "text",
+		},
+		.threading = (struct measurement_threading) {
+			.num_row_threads = 1,
+			.num_matrix_threads = 1,
+			.num_file_reading_threads = num_threads,
+			.schedule_largest_first = largest_first,
+		},
+	};
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.w2v = w2v,
+		.oov_discarded_because_not_in_vector_database = &oov,
+	};
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+		.document = (struct measurement_mutable_counters) { .count_target = 1, },
+	};
+	pthread_mutex_init(&(mmut.mutex), NULL);
+
+	if(create_file_queue(&q, paths, NULL, TEST_FILE_QUEUE_NUM_FILES, largest_first) != 0){
+		result = 1;
+	} else {
+		if(file_queue_read(&q, &mcfg, &sref, &mmut, num_threads) != 0){result = 1;}
+		if(q.num_done != TEST_FILE_QUEUE_NUM_FILES || q.done_size != q.total_size){result = 1;}
+		free_file_queue(&q);
+	}
+
+	for(uint64_t i = 0 ; i < w2v->num_vectors ; i++){
+		const struct graph_node * const node = graph_word2vec_node(&g, w2v, &(w2v->keys[i]));
+		counts[i] = node != NULL ? node->absolute_proportion : 0;
+	}
+	*num_oov_types = oov_counter_num_types(&oov);
+
+	pthread_mutex_destroy(&(mmut.mutex));
+	free_oov_counter(&oov);
+	free_graph(&g);
+	return result;
+}
+
+int32_t test_file_queue_largest_first(void){
+	char * paths[TEST_FILE_QUEUE_NUM_FILES] = {0};
+	struct file_queue q;
+	const struct file_queue_entry * entry;
+	uint8_t seen[TEST_FILE_QUEUE_NUM_FILES] = {0};
+	int64_t prev_size = -1;
+	int32_t num_popped = 0;
+	int32_t result = 0;
+
+	if(test_file_queue_write_inputs(paths) != 0 || create_file_queue(&q, paths, NULL, TEST_FILE_QUEUE_NUM_FILES, 1) != 0){
+		test_file_queue_remove_inputs(paths);
+		error_format(__FILE__, __func__, __LINE__, "test_file_queue_largest_first: FAIL");
+		return 1;
+	}
+
+	while(file_queue_pop(&q, &entry) == 0){
+		if(prev_size != -1 && entry->size > prev_size){result = 1;}
+		if(seen[entry->i] || strcmp(entry->filename, paths[entry->i]) != 0){result = 1;}
+		seen[entry->i] = 1;
+		prev_size = entry->size;
+		num_popped++;
+	}
+	if(num_popped != TEST_FILE_QUEUE_NUM_FILES){result = 1;}
+
+	free_file_queue(&q);
+	test_file_queue_remove_inputs(paths);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_file_queue_largest_first: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_file_queue_largest_first: FAIL");
+	}
+	return result;
+}
+
+int32_t test_file_queue_matches_list_order(void){
+	char * paths[TEST_FILE_QUEUE_NUM_FILES] = {0};
+	struct word2vec w2v;
+	uint32_t * counts_list = NULL;
+	uint32_t * counts_queue = NULL;
+	int64_t num_oov_types_list = 0;
+	int64_t num_oov_types_queue = 0;
+	int32_t result = 0;
+
+	if(test_file_queue_write_inputs(paths) != 0 || load_word2vec_binary(&w2v, TEST_FILE_QUEUE_W2V_PATH) != 0){
+		test_file_queue_remove_inputs(paths);
+		error_format(__FILE__, __func__, __LINE__, "test_file_queue_matches_list_order: FAIL");
+		return 1;
+	}
+
+	counts_list = malloc(w2v.num_vectors * sizeof(uint32_t));
+	counts_queue = malloc(w2v.num_vectors * sizeof(uint32_t));
+	if(counts_list == NULL || counts_queue == NULL){
+		result = 1;
+	} else if(test_file_queue_run(&w2v, paths, 0, 1, counts_list, &num_oov_types_list) != 0 || test_file_queue_run(&w2v, paths, 1, TEST_FILE_QUEUE_NUM_THREADS, counts_queue, &num_oov_types_queue) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to read the synthetic files");
+		result = 1;
+	} else {
+		// whatever the schedule, the graph the final step is computed on is the same
+		if(memcmp(counts_list, counts_queue, w2v.num_vectors * sizeof(uint32_t)) != 0 || num_oov_types_list != num_oov_types_queue){result = 1;}
+	}
+
+	free(counts_list);
+	free(counts_queue);
+	free_word2vec(&w2v);
+	test_file_queue_remove_inputs(paths);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_file_queue_matches_list_order: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_file_queue_matches_list_order: FAIL");
+	}
+	return result;
+}
+
+#endif
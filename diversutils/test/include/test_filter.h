@@ -0,0 +1,174 @@
+#ifndef TEST_FILTER_H
+#define TEST_FILTER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_general.h"
+#include "filter.h"
+
+#if ENABLE_FILTER == 1
+
+static const char * const test_filter_fragments[] = {
+	"Le chat dort sur le canapé.",
+	"<div class=\"main\">contenu</div>",
+	"<br/>",
+	"voir /usr/local/share/doc/index.html pour plus",
+	"écrire à jean.dupont@exemple.fr avant lundi",
+	"https://www.exemple.org/chemin/vers/page?cle=valeur&autre=2#ancre",
+	"http://exemple.com:8080/a/b",
+	"site exemple.com, fin.",
+	"fin de phrase.Début",
+	"le modèle A320neo et la RTX4090",
+	"2024",
+	"unmotextrêmementlongquinecontientaucunchiffreetquidépasselalimite",
+	"a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p/q/r/s",
+	"straße Ωmega naïve",
+	"déjà vu, où ça ?",
+	"[EMAIL] [PATH] [URL]",
+	"    ",
+	"x",
+};
+
+static char * test_filter_strdup(const char * const s){
+	char * const res = malloc(strlen(s) + 1);
+	if(res != NULL){memcpy(res, s, strlen(s) + 1);}
+	return res;
+}
+
+// concatenates fragments picked by a small LCG so that filters interact within the same document
+static char * test_filter_generate_document(uint32_t * const state, const int32_t num_fragments){
+	const uint32_t cardinality = sizeof(test_filter_fragments) / sizeof(char*);
+	size_t size = 1;
+	char * res = malloc(size);
+	if(res == NULL){return NULL;}
+	res[0] = '\0';
+	for(int32_t i = 0 ; i < num_fragments ; i++){
+		(*state) = (*state) * 1103515245u + 12345u;
+		const char * const fragment = test_filter_fragments[((*state) >> 16) % cardinality];
+		const char * const separator = (((*state) >> 8) & 3) == 0 ? "" : " ";
+		size += strlen(fragment) + strlen(separator);
+		char * const realloc_ptr = realloc(res, size);
+		if(realloc_ptr == NULL){free(res); return NULL;}
+		res = realloc_ptr;
+		strcat(res, separator);
+		strcat(res, fragment);
+	}
+	return res;
+}
+
+int32_t test_filter_equivalence(void){
+	const size_t log_bfr_size = 512;
+	char log_bfr[log_bfr_size];
+	int32_t result = 0;
+	const int32_t num_documents = 2000;
+
+	if(filter_ready(1) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call filter_ready"); return 1;}
+	struct filter_workspace fw = {0};
+	if(create_filter_workspace(&fw) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call create_filter_workspace"); filter_release(); return 1;}
+
+	uint32_t state = 42;
+	int32_t num_mismatches = 0;
+	int32_t num_modified = 0;
+	for(int32_t i = 0 ; i < num_documents ; i++){
+		char * const document = test_filter_generate_document(&state, 1 + (i % 12));
+		if(document == NULL){error_format(__FILE__, __func__, __LINE__, "failed to generate document"); result = 1; break;}
+		char * reference = test_filter_strdup(document);
+		char * candidate = test_filter_strdup(document);
+		size_t reference_len = strlen(document);
+		size_t candidate_len = strlen(document);
+		size_t candidate_capacity = strlen(document) + 1;
+		if(reference == NULL || candidate == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); free(document); free(reference); free(candidate); result = 1; break;}
+
+		if(filter_substitute_all(&reference, &reference_len) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call filter_substitute_all"); result = 1;}
+		if(filter_substitute_all_workspace(&fw, &candidate, &candidate_len, &candidate_capacity) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call filter_substitute_all_workspace"); result = 1;}
+		if(candidate_capacity < candidate_len + 1){error_format(__FILE__, __func__, __LINE__, "capacity reported by filter_substitute_all_workspace is smaller than the text it holds"); result = 1;}
+
+		num_modified += (strcmp(reference, document) != 0);
+		if(strcmp(reference, candidate) != 0 || strlen(reference) != candidate_len){
+			if(num_mismatches == 0){
+				memset(log_bfr, '\0', log_bfr_size);
+				snprintf(log_bfr, log_bfr_size, "first mismatch on \"%s\": \"%s\" != \"%s\"", document, reference, candidate);
+				error_format(__FILE__, __func__, __LINE__, log_bfr);
+			}
+			num_mismatches++;
+		}
+		free(document);
+		free(reference);
+		free(candidate);
+	}
+
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_mismatches == 0 && num_modified > 0 && result == 0){
+		snprintf(log_bfr, log_bfr_size, "filter equivalence test (sequential vs workspace / %i documents, %i modified): OK", num_documents, num_modified);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "filter equivalence test (sequential vs workspace / %i documents, %i modified): FAIL (%i mismatches)", num_documents, num_modified, num_mismatches);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	free_filter_workspace(&fw);
+	filter_release();
+	return result;
+}
+
+// benchmark rather than test: reports documents per second for both implementations
+int32_t test_filter_throughput(void){
+	const size_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	const int32_t num_documents = 5000;
+
+	if(filter_ready(1) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call filter_ready"); return 1;}
+	struct filter_workspace fw = {0};
+	if(create_filter_workspace(&fw) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call create_filter_workspace"); filter_release(); return 1;}
+
+	char ** const documents = malloc(num_documents * sizeof(char*));
+	if(documents == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); free_filter_workspace(&fw); filter_release(); return 1;}
+	uint32_t state = 7;
+	for(int32_t i = 0 ; i < num_documents ; i++){
+		documents[i] = test_filter_generate_document(&state, 4 + (i % 16));
+		if(documents[i] == NULL){
+			for(int32_t j = 0 ; j < i ; j++){free(documents[j]);}
+			free(documents);
+			free_filter_workspace(&fw);
+			filter_release();
+			return 1;
+		}
+	}
+
+	double elapsed[2] = {0.0, 0.0};
+	for(int32_t method = 0 ; method < 2 ; method++){
+		for(int32_t i = 0 ; i < num_documents ; i++){
+			char * s = test_filter_strdup(documents[i]);
+			size_t s_len = strlen(documents[i]);
+			size_t s_capacity = s_len + 1;
+			if(s == NULL){continue;}
+			const clock_t start = clock();
+			if(method == 0){
+				filter_substitute_all(&s, &s_len);
+			} else {
+				filter_substitute_all_workspace(&fw, &s, &s_len, &s_capacity);
+			}
+			elapsed[method] += ((double) (clock() - start)) / CLOCKS_PER_SEC;
+			free(s);
+		}
+	}
+
+	memset(log_bfr, '\0', log_bfr_size);
+	snprintf(log_bfr, log_bfr_size, "filter throughput (%i documents): sequential %.0f documents/s; workspace %.0f documents/s", num_documents, elapsed[0] > 0.0 ? num_documents / elapsed[0] : 0.0, elapsed[1] > 0.0 ? num_documents / elapsed[1] : 0.0);
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+	for(int32_t i = 0 ; i < num_documents ; i++){free(documents[i]);}
+	free(documents);
+	free_filter_workspace(&fw);
+	filter_release();
+	return 0;
+}
+
+#endif
+
+#endif
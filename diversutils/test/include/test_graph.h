@@ -1,12 +1,15 @@
 #ifndef TEST_GRAPH_H
 #define TEST_GRAPH_H
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "test_general.h"
 #include "graph.h"
+#include "snapshot.h"
 #include "dfunctions.h"
 #include "distances.h"
 
@@ -15,24 +18,24 @@ int32_t test_compute_graph_relative_proportions(void){
 	if(create_graph(&g, 4, 100, 0) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call create_graph"); return 1;}
 	if(request_more_capacity_graph(&g) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call request_more_capacity_graph"); free_graph(&g); return 1;}
 
-	g.nodes[0] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
-	g.nodes[1] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
-	g.nodes[2] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
-	g.nodes[3] = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .mutex_local_node = PTHREAD_MUTEX_INITIALIZER, .vector = NULL };
+	(*graph_node_at(&g, 0)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
+	(*graph_node_at(&g, 1)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
+	(*graph_node_at(&g, 2)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
+	(*graph_node_at(&g, 3)) = (struct graph_node) { .num_dimensions = 0, .already_considered = 0, .relative_proportion = 0.0, .absolute_proportion = 1, .word2vec_entry_pointer = NULL, .neighbours = NULL, .capacity_neighbours = 0, .num_neighbours = 0, .vector = NULL };
 
 	int32_t result = 0;
 
 	compute_graph_relative_proportions(&g);
-	if(g.nodes[0].relative_proportion != 0.25 || g.nodes[1].relative_proportion != 0.25 || g.nodes[2].relative_proportion != 0.25 || g.nodes[3].relative_proportion != 0.25){
+	if(graph_node_at(&g, 0)->relative_proportion != 0.25 || graph_node_at(&g, 1)->relative_proportion != 0.25 || graph_node_at(&g, 2)->relative_proportion != 0.25 || graph_node_at(&g, 3)->relative_proportion != 0.25){
 		error_format(__FILE__, __func__, __LINE__, "Compute graph relative proportions (even distribution): FAIL");
 		result = 1;
 	} else {
 		info_format(__FILE__, __func__, __LINE__, "Compute graph relative proportions (even distribution): OK");
 	}
 
-	g.nodes[0].absolute_proportion = 2;
+	graph_node_at(&g, 0)->absolute_proportion = 2;
 	compute_graph_relative_proportions(&g);
-	if(g.nodes[0].relative_proportion != 0.4 || g.nodes[1].relative_proportion != 0.2 || g.nodes[2].relative_proportion != 0.2 || g.nodes[3].relative_proportion != 0.2){
+	if(graph_node_at(&g, 0)->relative_proportion != 0.4 || graph_node_at(&g, 1)->relative_proportion != 0.2 || graph_node_at(&g, 2)->relative_proportion != 0.2 || graph_node_at(&g, 3)->relative_proportion != 0.2){
 		error_format(__FILE__, __func__, __LINE__, "Compute graph relative proportions (uneven distribution): FAIL");
 		result = 1;
 	} else {
@@ -43,4 +46,283 @@ int32_t test_compute_graph_relative_proportions(void){
 	return result;
 }
 
+#define TEST_GRAPH_APPEND_NUM_WRITERS 4
+#define TEST_GRAPH_APPEND_NUM_READERS 2
+#define TEST_GRAPH_APPEND_NODES_PER_WRITER 50000
+
+struct test_graph_append_writer {
+	struct graph* g;
+	uint32_t writer;
+	struct graph_node** pointers;
+	uint64_t* indices;
+};
+
+struct test_graph_append_reader {
+	struct graph* g;
+	volatile int8_t* done;
+	uint64_t num_checks;
+};
+
+// every node carries (writer, rank) in absolute_proportion, so that any torn or misplaced copy is detected
+static void * test_graph_append_writer_thread(void * args){
+	struct test_graph_append_writer * const w = (struct test_graph_append_writer *) args;
+	for(uint32_t k = 0 ; k < TEST_GRAPH_APPEND_NODES_PER_WRITER ; k++){
+		struct graph_node node = {0};
+		node.absolute_proportion = w->writer * TEST_GRAPH_APPEND_NODES_PER_WRITER + k + 1;
+		node.relative_proportion = (double) node.absolute_proportion;
+		if(graph_append_node(w->g, &node, &(w->indices[k])) != 0){return (void*) 1;}
+		w->pointers[k] = graph_node_at(w->g, w->indices[k]);
+		// a pointer taken before later growth must still point at our node
+		if(k > 0 && w->pointers[k / 2]->absolute_proportion != w->writer * TEST_GRAPH_APPEND_NODES_PER_WRITER + k / 2 + 1){return (void*) 1;}
+	}
+	return NULL;
+}
+
+// readers never take mutex_nodes: whatever graph_num_nodes covers must already be fully written
+static void * test_graph_append_reader_thread(void * args){
+	struct test_graph_append_reader * const r = (struct test_graph_append_reader *) args;
+	while(!__atomic_load_n(r->done, __ATOMIC_ACQUIRE)){
+		const uint64_t n = graph_num_nodes(r->g);
+		for(uint64_t i = (n > 1024 ? n - 1024 : 0) ; i < n ; i++){
+			const struct graph_node * const node = graph_node_at(r->g, i);
+			if(node->absolute_proportion == 0 || node->relative_proportion != (double) node->absolute_proportion){return (void*) 1;}
+			r->num_checks++;
+		}
+	}
+	return NULL;
+}
+
+int32_t test_graph_concurrent_append(void){
+	const uint64_t total = ((uint64_t) TEST_GRAPH_APPEND_NUM_WRITERS) * TEST_GRAPH_APPEND_NODES_PER_WRITER;
+	struct graph g;
+	struct test_graph_append_writer writers[TEST_GRAPH_APPEND_NUM_WRITERS];
+	struct test_graph_append_reader readers[TEST_GRAPH_APPEND_NUM_READERS];
+	pthread_t writer_threads[TEST_GRAPH_APPEND_NUM_WRITERS];
+	pthread_t reader_threads[TEST_GRAPH_APPEND_NUM_READERS];
+	volatile int8_t done = 0;
+	int32_t result = 0;
+
+	struct graph_node** const pointers = malloc(total * sizeof(struct graph_node*));
+	uint64_t* const indices = malloc(total * sizeof(uint64_t));
+	uint8_t* const seen = calloc(total, sizeof(uint8_t));
+	if(pointers == NULL || indices == NULL || seen == NULL){
+		error_format(__FILE__, __func__, __LINE__, "malloc failed");
+		free(pointers); free(indices); free(seen);
+		return 1;
+	}
+	if(create_graph_empty(&g) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_graph_empty");
+		free(pointers); free(indices); free(seen);
+		return 1;
+	}
+
+	for(uint32_t i = 0 ; i < TEST_GRAPH_APPEND_NUM_READERS ; i++){
+		readers[i] = (struct test_graph_append_reader) { .g = &g, .done = &done, .num_checks = 0, };
+		pthread_create(&(reader_threads[i]), NULL, test_graph_append_reader_thread, &(readers[i]));
+	}
+	for(uint32_t i = 0 ; i < TEST_GRAPH_APPEND_NUM_WRITERS ; i++){
+		writers[i] = (struct test_graph_append_writer) { .g = &g, .writer = i, .pointers = &(pointers[i * TEST_GRAPH_APPEND_NODES_PER_WRITER]), .indices = &(indices[i * TEST_GRAPH_APPEND_NODES_PER_WRITER]), };
+		pthread_create(&(writer_threads[i]), NULL, test_graph_append_writer_thread, &(writers[i]));
+	}
+	for(uint32_t i = 0 ; i < TEST_GRAPH_APPEND_NUM_WRITERS ; i++){
+		void * thread_result = NULL;
+		pthread_join(writer_threads[i], &thread_result);
+		if(thread_result != NULL){error_format(__FILE__, __func__, __LINE__, "writer saw a moved node"); result = 1;}
+	}
+	__atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+	for(uint32_t i = 0 ; i < TEST_GRAPH_APPEND_NUM_READERS ; i++){
+		void * thread_result = NULL;
+		pthread_join(reader_threads[i], &thread_result);
+		if(thread_result != NULL){error_format(__FILE__, __func__, __LINE__, "reader saw a partially published node"); result = 1;}
+	}
+
+	if(graph_num_nodes(&g) != total){result = 1;}
+	for(uint64_t i = 0 ; i < total && result == 0 ; i++){
+		const uint32_t expected = (uint32_t) (i + 1);
+		if(indices[i] >= total || seen[indices[i]] || pointers[i] != graph_node_at(&g, indices[i]) || pointers[i]->absolute_proportion != expected){
+			result = 1;
+			break;
+		}
+		seen[indices[i]] = 1;
+	}
+
+	free_graph(&g);
+	free(pointers);
+	free(indices);
+	free(seen);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_graph_concurrent_append: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_graph_concurrent_append: FAIL");
+	}
+	return result;
+}
+
+
+#define TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS 13
+#define TEST_GRAPH_SNAPSHOT_FIRST_NODES 10000
+#define TEST_GRAPH_SNAPSHOT_LATER_NODES 5000
+#define TEST_GRAPH_SNAPSHOT_NUM_THREADS 4
+
+static int32_t test_graph_snapshot_append(struct graph * const g, float * const vectors, const uint64_t start, const uint64_t end){
+	for(uint64_t i = start ; i < end ; i++){
+		struct graph_node node = {0};
+		uint64_t index;
+		for(uint32_t d = 0 ; d < TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS ; d++){
+			vectors[i * TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS + d] = ((float) ((int32_t) ((i * 31 + d * 7) % 97) - 48)) / 8.0f;
+		}
+		node.vector.fp32 = &(vectors[i * TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS]);
+		node.num_dimensions = TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS;
+		node.absolute_proportion = (uint32_t) (1 + i % 11);
+		if(graph_append_node(g, &node, &index) != 0 || index != i){return 1;}
+	}
+	return 0;
+}
+
+// panel rows, norms and distances must match what the kernels used to compute from the node vectors, bit for bit
+static int32_t test_graph_snapshot_check(const struct graph * const g, float * const row){
+	const struct graph_snapshot * const s = &(g->snapshot);
+	uint64_t sum = 0;
+
+	if(s->num_nodes != g->num_nodes || s->num_vectors != g->num_nodes || s->stride != 16 || ((uintptr_t) s->panel) % GRAPH_SNAPSHOT_ALIGNMENT != 0){return 1;}
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		const struct graph_node * const node = graph_node_at(g, i);
+		if(s->absolute_proportions[i] != node->absolute_proportion || s->relative_proportions[i] != node->relative_proportion || s->keys[i] != NULL){return 1;}
+		if(memcmp(graph_snapshot_row(s, i), node->vector.fp32, TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS * sizeof(float)) != 0){return 1;}
+		for(uint32_t d = TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS ; d < s->stride ; d++){
+			if(graph_snapshot_row(s, i)[d] != 0.0f){return 1;}
+		}
+		const uint64_t j = (i * 7919) % g->num_nodes;
+		if(graph_snapshot_distance(s, i, j) != cosine_distance_fp32(node->vector.fp32, graph_node_at(g, j)->vector.fp32, TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS)){return 1;}
+		sum += node->absolute_proportion;
+	}
+	for(uint64_t i = 0 ; i < g->num_nodes ; i++){
+		if(s->relative_proportions[i] != ((double) s->absolute_proportions[i]) / ((double) sum)){return 1;}
+	}
+	if(s->sum_absolute_proportions != sum){return 1;}
+
+	if(distance_row_from_graph_multithread(g, 1, row, TEST_GRAPH_SNAPSHOT_NUM_THREADS) != 0){return 1;}
+	for(uint64_t j = 0 ; j < g->num_nodes ; j++){
+		if(row[j] != cosine_distance_fp32(graph_node_at(g, 1)->vector.fp32, graph_node_at(g, j)->vector.fp32, TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS)){return 1;}
+	}
+	return 0;
+}
+
+int32_t test_graph_snapshot(void){
+	const uint64_t total = TEST_GRAPH_SNAPSHOT_FIRST_NODES + TEST_GRAPH_SNAPSHOT_LATER_NODES;
+	struct graph g;
+	int32_t result = 0;
+
+	float * const vectors = malloc(total * TEST_GRAPH_SNAPSHOT_NUM_DIMENSIONS * sizeof(float));
+	float * const row = malloc(total * sizeof(float));
+	if(vectors == NULL || row == NULL){
+		error_format(__FILE__, __func__, __LINE__, "malloc failed");
+		free(vectors); free(row);
+		return 1;
+	}
+	if(create_graph_empty(&g) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_graph_empty");
+		free(vectors); free(row);
+		return 1;
+	}
+
+	if(test_graph_snapshot_append(&g, vectors, 0, TEST_GRAPH_SNAPSHOT_FIRST_NODES) != 0 || graph_snapshot_refresh(&g, 1, TEST_GRAPH_SNAPSHOT_NUM_THREADS) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to fill or snapshot graph");
+		result = 1;
+	}
+	if(result == 0 && test_graph_snapshot_check(&g, row) != 0){
+		error_format(__FILE__, __func__, __LINE__, "first snapshot differs from graph");
+		result = 1;
+	}
+
+	// only counts changed: rows already in the panel must not be gathered again
+	if(result == 0){
+		const float * const panel = g.snapshot.panel;
+		const float first_value = vectors[0];
+		vectors[0] = 1000.0f;
+		for(uint64_t i = 0 ; i < g.num_nodes ; i += 3){graph_node_at(&g, i)->absolute_proportion += 5;}
+		if(graph_snapshot_refresh(&g, 1, TEST_GRAPH_SNAPSHOT_NUM_THREADS) != 0 || g.snapshot.panel != panel || graph_snapshot_row(&(g.snapshot), 0)[0] != first_value){
+			error_format(__FILE__, __func__, __LINE__, "counts-only refresh gathered rows again");
+			result = 1;
+		}
+		vectors[0] = first_value;
+		if(result == 0 && test_graph_snapshot_check(&g, row) != 0){
+			error_format(__FILE__, __func__, __LINE__, "counts-only refresh differs from graph");
+			result = 1;
+		}
+	}
+
+	// new nodes: their rows are appended, and the kernels refuse to run until they are
+	if(result == 0){
+		if(test_graph_snapshot_append(&g, vectors, TEST_GRAPH_SNAPSHOT_FIRST_NODES, total) != 0 || distance_row_from_graph_multithread(&g, 1, row, TEST_GRAPH_SNAPSHOT_NUM_THREADS) == 0){
+			error_format(__FILE__, __func__, __LINE__, "kernel ran on a stale snapshot");
+			result = 1;
+		} else if(graph_snapshot_refresh(&g, 1, TEST_GRAPH_SNAPSHOT_NUM_THREADS) != 0 || test_graph_snapshot_check(&g, row) != 0){
+			error_format(__FILE__, __func__, __LINE__, "incremental snapshot differs from graph");
+			result = 1;
+		}
+	}
+
+	free_graph(&g);
+	free(vectors);
+	free(row);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_graph_snapshot: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_graph_snapshot: FAIL");
+	}
+	return result;
+}
+
+#define TEST_GRAPH_APPEND_NODES_BATCH 3000
+
+// one bulk append across several chunks lands at the same indices as the same nodes appended one by one
+int32_t test_graph_append_nodes(void){
+	struct graph bulk;
+	struct graph single;
+	int32_t result = 0;
+
+	struct graph_node* const nodes = calloc(TEST_GRAPH_APPEND_NODES_BATCH, sizeof(struct graph_node));
+	if(nodes == NULL){
+		error_format(__FILE__, __func__, __LINE__, "malloc failed");
+		return 1;
+	}
+	for(uint64_t i = 0 ; i < TEST_GRAPH_APPEND_NODES_BATCH ; i++){
+		nodes[i].absolute_proportion = (uint32_t) (i + 1);
+	}
+	if(create_graph_empty(&bulk) != 0 || create_graph_empty(&single) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_graph_empty");
+		free(nodes);
+		return 1;
+	}
+
+	// a first node, so that the batch does not start on a chunk boundary
+	uint64_t index;
+	uint64_t first_index = 0;
+	if(graph_append_node(&bulk, &(nodes[0]), &index) != 0 || graph_append_node(&single, &(nodes[0]), &index) != 0){result = 1;}
+	if(result == 0 && graph_append_nodes(&bulk, nodes, TEST_GRAPH_APPEND_NODES_BATCH, &first_index) != 0){result = 1;}
+	for(uint64_t i = 0 ; i < TEST_GRAPH_APPEND_NODES_BATCH && result == 0 ; i++){
+		if(graph_append_node(&single, &(nodes[i]), &index) != 0){result = 1;}
+	}
+	if(result == 0 && graph_append_nodes(&bulk, nodes, 0, &index) != 0){result = 1;}
+
+	if(result == 0 && (first_index != 1 || graph_num_nodes(&bulk) != TEST_GRAPH_APPEND_NODES_BATCH + 1 || graph_num_nodes(&single) != graph_num_nodes(&bulk) || bulk.num_chunks != single.num_chunks)){result = 1;}
+	for(uint64_t i = 0 ; i < graph_num_nodes(&bulk) && result == 0 ; i++){
+		if(graph_node_at(&bulk, i)->absolute_proportion != graph_node_at(&single, i)->absolute_proportion){result = 1;}
+	}
+
+	free_graph(&bulk);
+	free_graph(&single);
+	free(nodes);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_graph_append_nodes: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_graph_append_nodes: FAIL");
+	}
+	return result;
+}
+
 #endif
@@ -0,0 +1,181 @@
+#ifndef TEST_INSTRUMENT_H
+#define TEST_INSTRUMENT_H
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "test_general.h"
+#include "instrument.h"
+
+#define TEST_INSTRUMENT_TRACE_PATH "/tmp/diversutils_test_instrument.json"
+#define TEST_INSTRUMENT_NUM_THREADS 4
+#define TEST_INSTRUMENT_SPANS_PER_THREAD 3
+
+struct test_instrument_thread_result {
+	int64_t os_tid;
+	int64_t duration_ns[TEST_INSTRUMENT_SPANS_PER_THREAD];
+	volatile double sink;
+};
+
+static double test_instrument_work(const uint32_t n){
+	double x = 0.0;
+	for(uint32_t k = 0 ; k < n ; k++){x += 1.0 / (1.0 + (double) k);}
+	return x;
+}
+
+static void* test_instrument_thread(void* args){
+	struct test_instrument_thread_result* const r = (struct test_instrument_thread_result*) args;
+	r->os_tid = (int64_t) syscall(SYS_gettid);
+	for(int32_t k = 0 ; k < TEST_INSTRUMENT_SPANS_PER_THREAD ; k++){
+		struct instrument_scope span;
+		instrument_span_begin(&span, "worker");
+		r->sink += test_instrument_work(10000);
+		r->duration_ns[k] = instrument_span_end(&span);
+	}
+	return NULL;
+}
+
+// -1 when /proc is not mounted
+static int32_t test_instrument_num_fds(void){
+	DIR * const dir = opendir("/proc/self/fd");
+	if(dir == NULL){return -1;}
+	int32_t num_fds = 0;
+	while(readdir(dir) != NULL){num_fds++;}
+	closedir(dir);
+	return num_fds;
+}
+
+static int32_t test_instrument_fail(const char * const msg){
+	error_format(__FILE__, __func__, __LINE__, msg);
+	return 1;
+}
+
+// checks the spans of the main thread (outer, inner, inner, in that order) and of the workers
+static int32_t test_instrument_check(const struct instrument_span * const spans, const uint64_t num_spans, const struct test_instrument_thread_result * const results){
+	if(num_spans != 3 + TEST_INSTRUMENT_NUM_THREADS * TEST_INSTRUMENT_SPANS_PER_THREAD){return test_instrument_fail("unexpected number of spans");}
+
+	const int64_t main_tid = (int64_t) syscall(SYS_gettid);
+	const struct instrument_span * const outer = &(spans[0]);
+	if(outer->os_tid != main_tid || strcmp(outer->name, "outer") != 0 || outer->depth != 0){return test_instrument_fail("outer span is not first on the main thread");}
+	for(int32_t k = 1 ; k <= 2 ; k++){
+		const struct instrument_span * const inner = &(spans[k]);
+		if(strcmp(inner->name, "inner") != 0 || inner->depth != 1 || inner->thread_index != outer->thread_index){return test_instrument_fail("inner span is not nested");}
+		if(inner->start_ns < outer->start_ns || inner->start_ns + inner->duration_ns > outer->start_ns + outer->duration_ns){return test_instrument_fail("inner span is not contained in outer span");}
+		if(inner->duration_ns <= 0 || inner->peak_rss_kb <= 0){return test_instrument_fail("inner span has no duration or no peak RSS");}
+	}
+	if(spans[2].start_ns < spans[1].start_ns + spans[1].duration_ns){return test_instrument_fail("sibling spans overlap");}
+
+	// every worker has its own thread index, and its spans carry its own tid and the durations it measured
+	uint32_t thread_indices[TEST_INSTRUMENT_NUM_THREADS];
+	for(int32_t t = 0 ; t < TEST_INSTRUMENT_NUM_THREADS ; t++){
+		uint32_t thread_index = 0;
+		int32_t num_found = 0;
+		for(uint64_t k = 3 ; k < num_spans ; k++){
+			if(spans[k].os_tid != results[t].os_tid){continue;}
+			if(num_found == 0){thread_index = spans[k].thread_index;}
+			if(num_found >= TEST_INSTRUMENT_SPANS_PER_THREAD || spans[k].thread_index != thread_index || spans[k].depth != 0 || spans[k].duration_ns != results[t].duration_ns[num_found]){return test_instrument_fail("worker span attributed to the wrong thread");}
+			num_found++;
+		}
+		if(num_found != TEST_INSTRUMENT_SPANS_PER_THREAD || thread_index == outer->thread_index){return test_instrument_fail("worker spans missing");}
+		thread_indices[t] = thread_index;
+		for(int32_t u = 0 ; u < t ; u++){
+			if(results[u].os_tid == results[t].os_tid || thread_indices[u] == thread_indices[t]){return test_instrument_fail("workers share a tid or a thread index");}
+		}
+	}
+
+	// counters are optional: without them a span records none rather than zeros
+	for(uint64_t k = 0 ; k < num_spans ; k++){
+		if(!instrument_counters_available() && (spans[k].counters[INSTRUMENT_COUNTER_CYCLES] >= 0 || spans[k].counters[INSTRUMENT_COUNTER_LLC_MISSES] >= 0)){return test_instrument_fail("counters recorded but not available");}
+	}
+	return 0;
+}
+
+static int32_t test_instrument_check_trace(const uint64_t num_spans){
+	FILE * const f = fopen(TEST_INSTRUMENT_TRACE_PATH, "r");
+	if(f == NULL){return test_instrument_fail("failed to open trace");}
+	fseek(f, 0, SEEK_END);
+	const size_t size = (size_t) ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char * const content = malloc(size + 1);
+	if(content == NULL || fread(content, 1, size, f) != size){fclose(f); free(content); return test_instrument_fail("failed to read trace");}
+	content[size] = '\0';
+	fclose(f);
+
+	uint64_t num_complete = 0;
+	uint64_t num_metadata = 0;
+	for(const char * c = strstr(content, "\"ph\": \"X\"") ; c != NULL ; c = strstr(c + 1, "\"ph\": \"X\"")){num_complete++;}
+	for(const char * c = strstr(content, "\"ph\": \"M\"") ; c != NULL ; c = strstr(c + 1, "\"ph\": \"M\"")){num_metadata++;}
+	const int32_t result = strncmp(content, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 42) != 0 || strstr(content, "\n]}\n") == NULL || num_complete != num_spans || num_metadata != 1 + TEST_INSTRUMENT_NUM_THREADS;
+	free(content);
+	if(result != 0){return test_instrument_fail("unexpected trace content");}
+	return 0;
+}
+
+int32_t test_instrument_spans(void){
+	pthread_t threads[TEST_INSTRUMENT_NUM_THREADS];
+	struct test_instrument_thread_result results[TEST_INSTRUMENT_NUM_THREADS];
+	struct instrument_span * spans = NULL;
+	uint64_t num_spans = 0;
+	int32_t num_created = 0;
+	int32_t result = 0;
+	volatile double sink = 0.0;
+
+	// nothing is recorded before instrument_init, but durations are still measured
+	struct instrument_scope ignored;
+	instrument_span_begin(&ignored, "ignored");
+	sink += test_instrument_work(1000);
+	if(instrument_span_end(&ignored) <= 0){result = test_instrument_fail("span has no duration");}
+
+	if(result == 0 && instrument_init(1) != 0){result = test_instrument_fail("failed to call instrument_init");}
+
+	if(result == 0){
+		struct instrument_scope outer;
+		instrument_span_begin(&outer, "outer");
+		for(int32_t k = 0 ; k < 2 ; k++){
+			struct instrument_scope inner;
+			instrument_span_begin(&inner, "inner");
+			sink += test_instrument_work(10000);
+			instrument_span_end(&inner);
+		}
+		instrument_span_end(&outer);
+
+		// the counters the workers open are closed when they exit
+		const int32_t num_fds = test_instrument_num_fds();
+		memset(results, '\0', sizeof(results));
+		for(int32_t t = 0 ; t < TEST_INSTRUMENT_NUM_THREADS ; t++){
+			if(pthread_create(&(threads[t]), NULL, test_instrument_thread, &(results[t])) != 0){result = test_instrument_fail("failed to call pthread_create"); break;}
+			num_created++;
+		}
+		for(int32_t t = 0 ; t < num_created ; t++){pthread_join(threads[t], NULL);}
+		if(result == 0 && test_instrument_num_fds() != num_fds){result = test_instrument_fail("counters of exited threads are still open");}
+	}
+
+	if(result == 0 && instrument_collect(&spans, &num_spans) != 0){result = test_instrument_fail("failed to call instrument_collect");}
+	if(result == 0){result = test_instrument_check(spans, num_spans, results);}
+	if(result == 0 && instrument_export_chrome_trace(TEST_INSTRUMENT_TRACE_PATH) != 0){result = test_instrument_fail("failed to call instrument_export_chrome_trace");}
+	if(result == 0){result = test_instrument_check_trace(num_spans);}
+	free(spans);
+	spans = NULL;
+
+	// a new session starts empty
+	instrument_free();
+	if(result == 0 && (instrument_init(0) != 0 || instrument_collect(&spans, &num_spans) != 0 || num_spans != 0)){result = test_instrument_fail("spans survived instrument_free");}
+	free(spans);
+	instrument_free();
+	remove(TEST_INSTRUMENT_TRACE_PATH);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_instrument_spans: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_instrument_spans: FAIL");
+	}
+	return result;
+}
+
+#endif
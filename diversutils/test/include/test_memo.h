@@ -0,0 +1,160 @@
+#ifndef TEST_MEMO_H
+#define TEST_MEMO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "snapshot.h"
+#include "dfunctions.h"
+
+// enough nodes for the memo to be split across TEST_MEMO_NUM_THREADS threads
+#define TEST_MEMO_NUM_NODES (4 * DFUNCTIONS_MEMO_MIN_NODES_PER_THREAD + 123)
+#define TEST_MEMO_NUM_THREADS 4
+#define TEST_MEMO_NUM_VALUES 32
+#define TEST_MEMO_TOLERANCE 1e-12
+
+static const double test_memo_orders[] = {0.5, 2.0, 3.0, 1.0};
+
+static void test_memo_evaluate(const struct graph * const g, double * const values){
+	void (* const functions[])(const struct graph * const, double * const) = {
+		simpson_dominance_index_from_graph,
+		simpson_index_from_graph,
+		berger_parker_index_from_graph,
+		shannon_evenness_from_graph,
+		junge1994_page22_from_graph,
+		mcintosh_index_from_graph,
+		type_token_ratio_from_graph,
+		sw_entropy_over_log_n_species_pielou1975_from_graph,
+		sw_e_heip_from_graph,
+		sw_e_one_minus_D_from_graph,
+		sw_e_one_over_D_williams1964_from_graph,
+		sw_e_minus_ln_D_pielou1977_from_graph,
+		sw_f_2_1_alatalo1981_from_graph,
+		sw_g_2_1_molinari1989_from_graph,
+		sw_o_bulla1994_from_graph,
+		sw_e_bulla1994_from_graph,
+		sw_e_mci_pielou1969_from_graph,
+		sw_e_var_smith_and_wilson1996_original_from_graph,
+	};
+	const size_t num_functions = sizeof(functions) / sizeof(functions[0]);
+	size_t k = 0;
+
+	for( ; k < num_functions ; k++){functions[k](g, &(values[k]));}
+	shannon_weaver_entropy_from_graph(g, &(values[k]), &(values[k + 1]));
+	k += 2;
+	for(size_t o = 0 ; o < sizeof(test_memo_orders) / sizeof(test_memo_orders[0]) ; o++){
+		renyi_entropy_from_graph(g, &(values[k]), &(values[k + 1]), test_memo_orders[o]);
+		k += 2;
+	}
+	hill_number_standard_from_graph(g, &(values[k++]), test_memo_orders[1]);
+	hill_evenness_from_graph(g, &(values[k++]), test_memo_orders[0], test_memo_orders[2]);
+	while(k < TEST_MEMO_NUM_VALUES){values[k++] = 0.0;}
+}
+
+static int32_t test_memo_compare(const double * const expected, const double * const actual, const double tolerance, const char * const what){
+	for(size_t k = 0 ; k < TEST_MEMO_NUM_VALUES ; k++){
+		const double scale = fabs(expected[k]) > 1.0 ? fabs(expected[k]) : 1.0;
+		if(!(fabs(expected[k] - actual[k]) <= tolerance * scale)){
+			const size_t log_bfr_size = 256;
+			char log_bfr[log_bfr_size];
+			snprintf(log_bfr, log_bfr_size, "%s: value %zu differs (%.17e != %.17e)", what, k, expected[k], actual[k]);
+			error_format(__FILE__, __func__, __LINE__, log_bfr);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void test_memo_request_all(struct graph * const g){
+	dfunctions_memo_request(g, DFUNCTIONS_NEEDS_SHANNON_WEAVER_ENTROPY | DFUNCTIONS_NEEDS_SIMPSON_INDEX | DFUNCTIONS_NEEDS_BERGER_PARKER_INDEX | DFUNCTIONS_NEEDS_TYPE_TOKEN_RATIO | DFUNCTIONS_NEEDS_SW_E_BULLA1994 | DFUNCTIONS_NEEDS_SW_E_MCI_PIELOU1969 | DFUNCTIONS_NEEDS_SW_E_VAR_SMITH_AND_WILSON1996_ORIGINAL);
+	for(size_t o = 0 ; o < sizeof(test_memo_orders) / sizeof(test_memo_orders[0]) ; o++){
+		dfunctions_memo_request_order(g, test_memo_orders[o]);
+	}
+}
+
+// every function must give the same value with and without the memo; a memo computed on one thread gives the very same bits
+int32_t test_dfunctions_memo(void){
+	struct graph g;
+	double direct[TEST_MEMO_NUM_VALUES];
+	double memoised[TEST_MEMO_NUM_VALUES];
+	int32_t result = 0;
+
+	if(create_graph_empty(&g) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_graph_empty");
+		return 1;
+	}
+	for(uint64_t i = 0 ; i < TEST_MEMO_NUM_NODES && result == 0 ; i++){
+		struct graph_node node = {0};
+		uint64_t index;
+		node.absolute_proportion = (uint32_t) (1 + (i * 7919) % 97 + (i % 13 == 0 ? 5000 : 0));
+		if(graph_append_node(&g, &node, &index) != 0){result = 1;}
+	}
+	if(result != 0 || graph_snapshot_refresh(&g, 0, 1) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to fill or snapshot graph");
+		free_graph(&g);
+		return 1;
+	}
+
+	test_memo_evaluate(&g, direct);
+
+	test_memo_request_all(&g);
+	if(dfunctions_memo_compute(&g, 1) != 0){result = 1;}
+	test_memo_evaluate(&g, memoised);
+	if(result == 0 && test_memo_compare(direct, memoised, 0.0, "memo on one thread") != 0){result = 1;}
+
+	// a refresh forgets the memo, which is then computed again in parallel
+	if(result == 0 && (graph_snapshot_refresh(&g, 0, 1) != 0 || g.snapshot.memo.computed != 0 || g.snapshot.memo.num_orders != 0)){
+		error_format(__FILE__, __func__, __LINE__, "refresh did not forget the memo");
+		result = 1;
+	}
+	if(result == 0){
+		test_memo_request_all(&g);
+		if(dfunctions_memo_compute(&g, TEST_MEMO_NUM_THREADS) != 0){result = 1;}
+		test_memo_evaluate(&g, memoised);
+		if(result == 0 && test_memo_compare(direct, memoised, TEST_MEMO_TOLERANCE, "memo on several threads") != 0){result = 1;}
+	}
+
+	// nodes appended after the refresh are not part of the snapshot, which the functions keep to
+	double loops_before[6];
+	double loops_after[6];
+	if(result == 0){
+		good_entropy_from_graph(&g, &(loops_before[0]), 2.0, 1.0);
+		patil_taillie_entropy_from_graph(&g, &(loops_before[1]), &(loops_before[2]), 2.0);
+		q_logarithmic_entropy_from_graph(&g, &(loops_before[3]), &(loops_before[4]), 2.0);
+		brillouin_diversity_from_graph(&g, &(loops_before[5]));
+	}
+	for(uint64_t i = 0 ; i < TEST_MEMO_NUM_NODES && result == 0 ; i++){
+		struct graph_node node = {0};
+		uint64_t index;
+		node.absolute_proportion = 1;
+		if(graph_append_node(&g, &node, &index) != 0){result = 1;}
+	}
+	if(result == 0){
+		test_memo_evaluate(&g, memoised);
+		if(test_memo_compare(direct, memoised, TEST_MEMO_TOLERANCE, "nodes appended after the refresh") != 0){result = 1;}
+		good_entropy_from_graph(&g, &(loops_after[0]), 2.0, 1.0);
+		patil_taillie_entropy_from_graph(&g, &(loops_after[1]), &(loops_after[2]), 2.0);
+		q_logarithmic_entropy_from_graph(&g, &(loops_after[3]), &(loops_after[4]), 2.0);
+		brillouin_diversity_from_graph(&g, &(loops_after[5]));
+		if(memcmp(loops_before, loops_after, sizeof(loops_before)) != 0){
+			error_format(__FILE__, __func__, __LINE__, "functions read nodes appended after the refresh");
+			result = 1;
+		}
+	}
+
+	free_graph(&g);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_dfunctions_memo: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_dfunctions_memo: FAIL");
+	}
+	return result;
+}
+
+#endif
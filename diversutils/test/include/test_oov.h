@@ -0,0 +1,191 @@
+#ifndef TEST_OOV_H
+#define TEST_OOV_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "oov/counter.h"
+
+#define TEST_OOV_NUM_TYPES 5000
+#define TEST_OOV_NUM_TOKENS 200000
+#define TEST_OOV_NUM_THREADS 4
+
+// half of the tokens are spread over 5 heavy types, the other half over TEST_OOV_NUM_TYPES types
+static uint32_t test_oov_type_of_token(const uint32_t i){
+	if(i % 2 == 0){return (i >> 1) % 5;}
+	return (uint32_t) ((((uint64_t) i) * 2654435761ULL) % TEST_OOV_NUM_TYPES);
+}
+
+static void * test_oov_counter_thread(void * args){
+	struct oov_counter * const counter = (struct oov_counter *) args;
+	char key[32];
+	for(uint32_t i = 0 ; i < TEST_OOV_NUM_TOKENS ; i++){
+		snprintf(key, 32, "oov_%u", test_oov_type_of_token(i));
+		if(oov_counter_increment(counter, key) != 0){return (void*) 1;}
+	}
+	return NULL;
+}
+
+int32_t test_oov_counter_exact(void){
+	const size_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	int32_t result = 0;
+
+	int64_t * const expected = malloc(TEST_OOV_NUM_TYPES * sizeof(int64_t));
+	if(expected == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); return 1;}
+	memset(expected, '\0', TEST_OOV_NUM_TYPES * sizeof(int64_t));
+	int64_t expected_num_types = 0;
+	for(uint32_t i = 0 ; i < TEST_OOV_NUM_TOKENS ; i++){
+		uint32_t t = test_oov_type_of_token(i);
+		if(expected[t] == 0){expected_num_types++;}
+		expected[t] += TEST_OOV_NUM_THREADS;
+	}
+
+	struct oov_counter counter;
+	if(create_oov_counter(&counter, 0) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call create_oov_counter"); free(expected); return 1;}
+
+	pthread_t threads[TEST_OOV_NUM_THREADS];
+	for(int32_t i = 0 ; i < TEST_OOV_NUM_THREADS ; i++){
+		if(pthread_create(&(threads[i]), NULL, test_oov_counter_thread, &counter) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call pthread_create"); free(expected); return 1;}
+	}
+	for(int32_t i = 0 ; i < TEST_OOV_NUM_THREADS ; i++){
+		void * thread_result = NULL;
+		pthread_join(threads[i], &thread_result);
+		if(thread_result != NULL){result = 1;}
+	}
+
+	memset(log_bfr, '\0', log_bfr_size);
+	if(oov_counter_is_exact(&counter) && oov_counter_num_types(&counter) == expected_num_types){
+		snprintf(log_bfr, log_bfr_size, "OOV counter (exact / %i threads): OK (%li types)", TEST_OOV_NUM_THREADS, oov_counter_num_types(&counter));
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "OOV counter (exact / %i threads): FAIL (%li types, expected %li)", TEST_OOV_NUM_THREADS, oov_counter_num_types(&counter), expected_num_types);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	char key[32];
+	int32_t num_mismatches = 0;
+	for(uint32_t t = 0 ; t < TEST_OOV_NUM_TYPES ; t++){
+		snprintf(key, 32, "oov_%u", t);
+		if(oov_counter_get(&counter, key) != expected[t]){num_mismatches++;}
+	}
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_mismatches == 0){
+		snprintf(log_bfr, log_bfr_size, "OOV counter (exact counts): OK");
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "OOV counter (exact counts): FAIL (%i mismatches)", num_mismatches);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	struct oov_counter_entry top[5];
+	int32_t num_top = 0;
+	oov_counter_most_frequent(&counter, top, 5, &num_top);
+	// the 5 heavy types, in decreasing order, with their exact counts
+	for(int32_t i = 0 ; i < num_top ; i++){
+		uint32_t t = TEST_OOV_NUM_TYPES;
+		if(sscanf(top[i].key, "oov_%u", &t) != 1 || t >= 5 || top[i].value != expected[t] || (i > 0 && top[i].value > top[i - 1].value)){num_top = -1; break;}
+	}
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_top == 5){
+		snprintf(log_bfr, log_bfr_size, "OOV counter (exact most frequent): OK");
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "OOV counter (exact most frequent): FAIL");
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	free_oov_counter(&counter);
+	free(expected);
+	return result;
+}
+
+int32_t test_oov_counter_approximate(void){
+	const size_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	int32_t result = 0;
+
+	int64_t * const expected = malloc(TEST_OOV_NUM_TYPES * sizeof(int64_t));
+	if(expected == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); return 1;}
+	memset(expected, '\0', TEST_OOV_NUM_TYPES * sizeof(int64_t));
+	int64_t expected_num_types = 0;
+	for(uint32_t i = 0 ; i < TEST_OOV_NUM_TOKENS ; i++){
+		uint32_t t = test_oov_type_of_token(i);
+		if(expected[t] == 0){expected_num_types++;}
+		expected[t] += TEST_OOV_NUM_THREADS;
+	}
+
+	struct oov_counter counter;
+	// smaller than the initial tables: switches on the first growth
+	if(create_oov_counter(&counter, 1 << 16) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call create_oov_counter"); free(expected); return 1;}
+
+	pthread_t threads[TEST_OOV_NUM_THREADS];
+	for(int32_t i = 0 ; i < TEST_OOV_NUM_THREADS ; i++){
+		if(pthread_create(&(threads[i]), NULL, test_oov_counter_thread, &counter) != 0){error_format(__FILE__, __func__, __LINE__, "failed to call pthread_create"); free(expected); return 1;}
+	}
+	for(int32_t i = 0 ; i < TEST_OOV_NUM_THREADS ; i++){
+		void * thread_result = NULL;
+		pthread_join(threads[i], &thread_result);
+		if(thread_result != NULL){result = 1;}
+	}
+
+	const int64_t num_types = oov_counter_num_types(&counter);
+	memset(log_bfr, '\0', log_bfr_size);
+	if(!oov_counter_is_exact(&counter) && num_types <= expected_num_types && num_types >= (expected_num_types * 9) / 10){
+		snprintf(log_bfr, log_bfr_size, "OOV counter (approximate types): OK (%li <= %li)", num_types, expected_num_types);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "OOV counter (approximate types): FAIL (exact: %u; %li types, expected about %li)", oov_counter_is_exact(&counter), num_types, expected_num_types);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	char key[32];
+	int32_t num_underestimates = 0;
+	for(uint32_t t = 0 ; t < TEST_OOV_NUM_TYPES ; t++){
+		snprintf(key, 32, "oov_%u", t);
+		if(oov_counter_get(&counter, key) < expected[t]){num_underestimates++;}
+	}
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_underestimates == 0){
+		snprintf(log_bfr, log_bfr_size, "OOV counter (Count-Min never underestimates): OK");
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "OOV counter (Count-Min never underestimates): FAIL (%i underestimates)", num_underestimates);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	struct oov_counter_entry top[5];
+	int32_t num_top = 0;
+	int32_t num_found = 0;
+	oov_counter_most_frequent(&counter, top, 5, &num_top);
+	for(int32_t i = 0 ; i < 5 ; i++){
+		snprintf(key, 32, "oov_%i", i);
+		for(int32_t j = 0 ; j < num_top ; j++){
+			if(strcmp(top[j].key, key) == 0){num_found++; break;}
+		}
+	}
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_found == 5){
+		snprintf(log_bfr, log_bfr_size, "OOV counter (approximate most frequent): OK");
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "OOV counter (approximate most frequent): FAIL (%i/5 heavy types found)", num_found);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	free_oov_counter(&counter);
+	free(expected);
+	return result;
+}
+
+#endif
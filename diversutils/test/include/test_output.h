@@ -0,0 +1,146 @@
+#ifndef TEST_OUTPUT_H
+#define TEST_OUTPUT_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "output.h"
+
+#define TEST_OUTPUT_TSV_PATH "/tmp/diversutils_test_output.tsv"
+#define TEST_OUTPUT_COLUMNAR_PATH "/tmp/diversutils_test_output.bin"
+#define TEST_OUTPUT_CONVERTED_PATH "/tmp/diversutils_test_output_converted.tsv"
+#define TEST_OUTPUT_ROW_GROUP_SIZE 3 // several groups, the last one partial
+#define TEST_OUTPUT_NUM_ROWS 20
+
+// the same rows as main_measurement would write them: counters, the vector file, then measures
+static int32_t test_output_write(const char * const path, const uint8_t format, const uint8_t compression, const uint32_t num_rows){
+	struct output_stream s;
+	int32_t result = 0;
+
+	if(create_output_stream(&s, path, format, compression, TEST_OUTPUT_ROW_GROUP_SIZE) != 0){return 1;}
+	output_header(&s, "num_active_files\tnum_discarded_types\tw2v\ts\tlexicographic_hybrid_scheiner\tmu_dist\tsigma_dist\trenyi_entropy_alpha%.4e", 2.0);
+	output_header(&s, "\n");
+	for(uint32_t r = 0 ; r < num_rows ; r++){
+		const double s_value = r % 5 == 4 ? 0.0 : 1.0 / (1.0 + (double) r);
+		output_uint(&s, r + 1);
+		output_int(&s, r % 4 == 3 ? -((int64_t) r) : (int64_t) (r * r * 1000003));
+		output_string(&s, r % 6 == 5 ? NULL : (r < 7 ? "vectors.bin" : "other vectors.bin"));
+		output_double(&s, s_value);
+		output_long_double(&s, (long double) r / 3.0L);
+		output_double(&s, r == 8 ? nan("") : (r == 9 ? -INFINITY : 1e-300 * (double) r));
+		output_string(&s, "?");
+		output_double(&s, log(2.0 + (double) r));
+		if(output_end_row(&s) != 0){result = 1;}
+	}
+	if(output_stream_finish(&s) != 0){result = 1;}
+	free_output_stream(&s);
+	return result;
+}
+
+static int32_t test_output_read(const char * const path, char ** const content, size_t * const size){
+	FILE * const f = fopen(path, "rb");
+	if(f == NULL){return 1;}
+	fseek(f, 0, SEEK_END);
+	*size = (size_t) ftell(f);
+	fseek(f, 0, SEEK_SET);
+	*content = malloc(*size + 1);
+	if(*content == NULL || fread(*content, 1, *size, f) != *size){fclose(f); free(*content); *content = NULL; return 1;}
+	(*content)[*size] = '\0';
+	fclose(f);
+	return 0;
+}
+
+static int32_t test_output_convert(void){
+	FILE * const f_in = fopen(TEST_OUTPUT_COLUMNAR_PATH, "rb");
+	if(f_in == NULL){return 1;}
+	FILE * const f_out = fopen(TEST_OUTPUT_CONVERTED_PATH, "w");
+	if(f_out == NULL){fclose(f_in); return 1;}
+	int32_t result = output_columnar_to_tsv(f_in, f_out);
+	fclose(f_in);
+	if(fclose(f_out) != 0){result = 1;}
+	return result;
+}
+
+// the columnar file, once converted, must give back the very bytes of the TSV file
+static int32_t test_output_round_trip(const uint8_t compression, const uint32_t num_rows){
+	char * tsv = NULL;
+	char * converted = NULL;
+	size_t tsv_size = 0;
+	size_t converted_size = 0;
+	int32_t result = 0;
+
+	if(test_output_write(TEST_OUTPUT_TSV_PATH, OUTPUT_FORMAT_TSV, compression, num_rows) != 0 || test_output_write(TEST_OUTPUT_COLUMNAR_PATH, OUTPUT_FORMAT_COLUMNAR, compression, num_rows) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to write output files");
+		result = 1;
+	} else if(test_output_convert() != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to convert columnar output");
+		result = 1;
+	} else if(test_output_read(TEST_OUTPUT_TSV_PATH, &tsv, &tsv_size) != 0 || test_output_read(TEST_OUTPUT_CONVERTED_PATH, &converted, &converted_size) != 0){
+		result = 1;
+	} else if(tsv_size != converted_size || memcmp(tsv, converted, tsv_size) != 0){
+		const size_t log_bfr_size = 256;
+		char log_bfr[log_bfr_size];
+		snprintf(log_bfr, log_bfr_size, "round trip differs (compression %u, %u rows, %zu != %zu bytes)", compression, num_rows, tsv_size, converted_size);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	free(tsv);
+	free(converted);
+	return result;
+}
+
+// a row with other columns is dropped, and the stream reports it when finished
+static int32_t test_output_mismatch(void){
+	struct output_stream s;
+	int32_t result = 0;
+
+	if(create_output_stream(&s, TEST_OUTPUT_COLUMNAR_PATH, OUTPUT_FORMAT_COLUMNAR, OUTPUT_COMPRESSION_DELTA_XOR, TEST_OUTPUT_ROW_GROUP_SIZE) != 0){return 1;}
+	output_uint(&s, 1);
+	output_double(&s, 1.0);
+	if(output_end_row(&s) != 0){result = 1;}
+	output_uint(&s, 2);
+	output_string(&s, "1.0");
+	if(output_end_row(&s) == 0){result = 1;}
+	// as after a value that output_push failed to add, even though the row has the right columns
+	output_uint(&s, 3);
+	output_double(&s, 3.0);
+	s.row_failed = 1;
+	if(output_end_row(&s) == 0 || s.row_length != 0){result = 1;}
+	output_uint(&s, 4);
+	output_double(&s, 4.0);
+	if(output_end_row(&s) != 0){result = 1;}
+	if(output_stream_finish(&s) == 0){result = 1;}
+	free_output_stream(&s);
+	return result;
+}
+
+int32_t test_output_columnar(void){
+	int32_t result = 0;
+
+	for(uint8_t compression = 0 ; compression <= 1 && result == 0 ; compression++){
+		if(test_output_round_trip(compression, TEST_OUTPUT_NUM_ROWS) != 0){result = 1;}
+		if(test_output_round_trip(compression, 0) != 0){result = 1;} // header only
+	}
+	if(result == 0 && test_output_mismatch() != 0){
+		error_format(__FILE__, __func__, __LINE__, "mismatched row was not reported");
+		result = 1;
+	}
+
+	remove(TEST_OUTPUT_TSV_PATH);
+	remove(TEST_OUTPUT_COLUMNAR_PATH);
+	remove(TEST_OUTPUT_CONVERTED_PATH);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_output_columnar: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_output_columnar: FAIL");
+	}
+	return result;
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef TEST_RECOMPUTE_H
+#define TEST_RECOMPUTE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "measurement.h"
+#include "recompute.h"
+#include "oov/counter.h"
+#include "jsonl/load.h"
+#include "cupt/constants.h"
+
+#define TEST_RECOMPUTE_W2V_PATH "/tmp/diversutils_test_recompute.bin"
+#define TEST_RECOMPUTE_JSONL_PATH "/tmp/diversutils_test_recompute.jsonl"
+#define TEST_RECOMPUTE_BLOCKING_PATH "/tmp/diversutils_test_recompute_blocking.tsv"
+#define TEST_RECOMPUTE_BACKGROUND_PATH "/tmp/diversutils_test_recompute_background.tsv"
+#define TEST_RECOMPUTE_NUM_VECTORS 300
+#define TEST_RECOMPUTE_NUM_DIMENSIONS 12
+#define TEST_RECOMPUTE_NUM_DOCUMENTS 80
+#define TEST_RECOMPUTE_NUM_TOKENS 25
+#define TEST_RECOMPUTE_STEP 4
+#define TEST_RECOMPUTE_QUEUE_SIZE 2
+
+static int32_t test_recompute_write_inputs(void){
+	FILE * f = fopen(TEST_RECOMPUTE_W2V_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); return 1;}
+	fprintf(f, "%u %u\n", TEST_RECOMPUTE_NUM_VECTORS, TEST_RECOMPUTE_NUM_DIMENSIONS);
+	for(uint32_t i = 0 ; i < TEST_RECOMPUTE_NUM_VECTORS ; i++){
+		float vector[TEST_RECOMPUTE_NUM_DIMENSIONS];
+		for(uint32_t d = 0 ; d < TEST_RECOMPUTE_NUM_DIMENSIONS ; d++){vector[d] = (float) ((int32_t) ((i * 31 + d * 17 + i * d) % 23) - 11);}
+		fprintf(f, "w%u ", i);
+		fwrite(vector, sizeof(float), TEST_RECOMPUTE_NUM_DIMENSIONS, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+
+	// a skewed vocabulary that keeps growing, with a few words missing from the vectors
+	f = fopen(TEST_RECOMPUTE_JSONL_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic jsonl file"); return 1;}
+	for(uint32_t d = 0 ; d < TEST_RECOMPUTE_NUM_DOCUMENTS ; d++){
+		fprintf(f, "{\"id\": \"d%u\", \"text\": \"", d);
+		for(uint32_t t = 0 ; t < TEST_RECOMPUTE_NUM_TOKENS ; t++){
+			const uint32_t range = 2 + d * 3 + t % 7;
+			const uint32_t r = (d * 7919 + t * 104729) % range;
+			if(t % 11 == 10){
+				fprintf(f, "%soov%u", t == 0 ? "" : " ", r);
+			} else {
+				fprintf(f, "%sw%u", t == 0 ? "" : " ", ((r * r) / range) % TEST_RECOMPUTE_NUM_VECTORS);
+			}
+		}
+		fprintf(f, "\"}\n");
+	}
+	fclose(f);
+	return 0;
+}
+
+// reads the synthetic corpus once, with document steps computed by the reader (queue_size == 0) or by a recompute worker
+static int32_t test_recompute_run(struct word2vec * const w2v, const char * const output_path, const int32_t queue_size){
+	struct graph g;
+	struct minimum_spanning_tree mst = {0};
+	struct graph_distance_heap heap = {0};
+	struct oov_counter oov;
+	struct recompute_worker recompute;
+	struct output_stream output;
+	int32_t result = 0;
+
+	if(create_graph_empty(&g) != 0){return 1;}
+	if(graph_bind_word2vec(&g, w2v) != 0){free_graph(&g); return 1;}
+	if(create_oov_counter(&oov, 0) != 0){free_graph(&g); return 1;}
+	if(create_output_stream(&output, output_path, OUTPUT_FORMAT_TSV, OUTPUT_COMPRESSION_NONE, 1) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to open output file");
+		free_oov_counter(&oov);
+		free_graph(&g);
+		return 1;
+	}
+
+	struct measurement_configuration mcfg = {
+		.target_column = UD_FORM,
+		.jsonl_content_key = "text",
+		.div_param = (struct measurement_diversity_parameters) {
+			.stirling_alpha = 1.0,
+			.stirling_beta = 1.0,
+			.chao_et_al_functional_diversity_alpha = 1.0,
+			.leinster_cobbold_diversity_alpha = 2.0,
+			.renyi_alpha = 2.0,
+			.hill_number_standard_alpha = 2.0,
+		},
+		.enable = (struct measurement_diversity_enabler) {
+			.stirling = 1,
+			.pairwise = 1,
+			.chao_et_al_functional_diversity = 1,
+			.leinster_cobbold_diversity = 1,
+			.functional_dispersion = 1,
+			.functional_divergence_modified = 1,
+			.non_disparity_functions = 1,
+			.disparity_functions = 1,
+			.shannon_weaver_entropy = 1,
+			.renyi_entropy = 1,
+			.simpson_index = 1,
+			.hill_number_standard = 1,
+			.berger_parker_index = 1,
+		},
+		.io = (struct measurement_io) {
+			.w2v_path = TEST_RECOMPUTE_W2V_PATH,
+			.jsonl_content_key = "text",
+			.output = &output,
+		},
+		.threading = (struct measurement_threading) {
+			.num_row_threads = 2,
+			.num_matrix_threads = 2,
+			.num_file_reading_threads = 1,
+			.enable_multithreaded_matrix_generation = 1,
+			.recompute_queue_size = queue_size,
+		},
+		.steps = (struct measurement_step_parameters) {
+			.document = (struct measurement_step) {
+				.recompute_step = TEST_RECOMPUTE_STEP,
+				.enable_count_recompute_step = 1,
+			},
+		},
+	};
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.mst = &mst,
+		.heap = &heap,
+		.w2v = w2v,
+		.oov_discarded_because_not_in_vector_database = &oov,
+		.recompute = queue_size > 0 ? &recompute : NULL,
+	};
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+		.document = (struct measurement_mutable_counters) { .count_target = 1, },
+	};
+	pthread_mutex_init(&(mmut.mutex), NULL);
+
+	if(sref.recompute != NULL && create_recompute_worker(&recompute, &mcfg, &sref, &mmut, (uint32_t) queue_size) != 0){
+		result = 1;
+	} else {
+		if(jsonl_to_graph(0, TEST_RECOMPUTE_JSONL_PATH, &mcfg, &sref, &mmut) != 0){result = 1;}
+
+		// final step, as in main_measurement
+		pthread_mutex_lock(&(g.mutex_nodes));
+		if(sref.recompute != NULL){
+			if(result == 0 && recompute_worker_submit(&recompute, 1, &g, &mmut, oov_counter_num_types(&oov), 1) != 0){result = 1;}
+			if(recompute_worker_finish(&recompute) != 0){result = 1;}
+			free_recompute_worker(&recompute);
+		} else if(result == 0){
+			mmut.num_oov_types = oov_counter_num_types(&oov);
+			if(compute_graph_relative_proportions(&g) != 0 || measurement_recompute_step(1, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+		}
+		pthread_mutex_unlock(&(g.mutex_nodes));
+	}
+
+	if(output_stream_finish(&output) != 0){result = 1;}
+	free_output_stream(&output);
+	pthread_mutex_destroy(&(mmut.mutex));
+	free_oov_counter(&oov);
+	free_graph(&g);
+	return result;
+}
+
+static int32_t test_recompute_read(const char * const path, char ** const content, size_t * const size){
+	FILE * const f = fopen(path, "r");
+	if(f == NULL){return 1;}
+	fseek(f, 0, SEEK_END);
+	*size = (size_t) ftell(f);
+	fseek(f, 0, SEEK_SET);
+	*content = malloc(*size + 1);
+	if(*content == NULL || fread(*content, 1, *size, f) != *size){fclose(f); free(*content); *content = NULL; return 1;}
+	(*content)[*size] = '\0';
+	fclose(f);
+	return 0;
+}
+
+int32_t test_recompute_matches_blocking(void){
+	struct word2vec w2v;
+	char * blocking = NULL;
+	char * background = NULL;
+	size_t blocking_size = 0;
+	size_t background_size = 0;
+	int32_t result = 0;
+
+	if(test_recompute_write_inputs() != 0){return 1;}
+	if(load_word2vec_binary(&w2v, TEST_RECOMPUTE_W2V_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call load_word2vec_binary");
+		return 1;
+	}
+
+	if(test_recompute_run(&w2v, TEST_RECOMPUTE_BLOCKING_PATH, 0) != 0 || test_recompute_run(&w2v, TEST_RECOMPUTE_BACKGROUND_PATH, TEST_RECOMPUTE_QUEUE_SIZE) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to measure the synthetic corpus");
+		result = 1;
+	} else if(test_recompute_read(TEST_RECOMPUTE_BLOCKING_PATH, &blocking, &blocking_size) != 0 || test_recompute_read(TEST_RECOMPUTE_BACKGROUND_PATH, &background, &background_size) != 0){
+		result = 1;
+	} else {
+		// one row per document step, plus the final one
+		int32_t num_rows = 0;
+		for(size_t k = 0 ; k < blocking_size ; k++){num_rows += blocking[k] == '\n';}
+		if(num_rows != TEST_RECOMPUTE_NUM_DOCUMENTS / TEST_RECOMPUTE_STEP + 1){result = 1;}
+		if(blocking_size != background_size || memcmp(blocking, background, blocking_size) != 0){result = 1;}
+	}
+
+	free(blocking);
+	free(background);
+	free_word2vec(&w2v);
+	remove(TEST_RECOMPUTE_W2V_PATH);
+	remove(TEST_RECOMPUTE_JSONL_PATH);
+	remove(TEST_RECOMPUTE_BLOCKING_PATH);
+	remove(TEST_RECOMPUTE_BACKGROUND_PATH);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_recompute_matches_blocking: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_recompute_matches_blocking: FAIL");
+	}
+	return result;
+}
+
+#endif
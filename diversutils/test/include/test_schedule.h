@@ -0,0 +1,161 @@
+#ifndef TEST_SCHEDULE_H
+#define TEST_SCHEDULE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "test_general.h"
+#include "schedule.h"
+
+#define TEST_SCHEDULE_ALL_FUNCTIONS ((1u << RECOMPUTE_COST_FIT) | (1u << RECOMPUTE_COST_DISPARITY) | (1u << RECOMPUTE_COST_NON_DISPARITY))
+
+// simulated costs: the disparity part is quadratic and the rest linear in the number of nodes
+static double test_schedule_simulated_cost(const double num_nodes){
+	return 40.0 * num_nodes * num_nodes + 7.0 * num_nodes + 3.0 * num_nodes;
+}
+
+// simulated corpus: a vocabulary following Heaps' law
+static uint64_t test_schedule_simulated_nodes(const uint64_t units){
+	return (uint64_t) (10.0 * sqrt((double) units));
+}
+
+static void test_schedule_observe_simulated_step(struct recompute_schedule * const s, const uint64_t num_nodes){
+	recompute_schedule_observe_compute(s, RECOMPUTE_COST_DISPARITY, num_nodes, (int64_t) (40.0 * num_nodes * num_nodes));
+	recompute_schedule_observe_compute(s, RECOMPUTE_COST_NON_DISPARITY, num_nodes, (int64_t) (7.0 * num_nodes));
+	recompute_schedule_observe_compute(s, RECOMPUTE_COST_FIT, num_nodes, (int64_t) (3.0 * num_nodes));
+}
+
+int32_t test_schedule_cost_model(void){
+	struct recompute_schedule s;
+	int32_t result = 0;
+
+	if(create_recompute_schedule(&s, TEST_SCHEDULE_ALL_FUNCTIONS, 0.1, 1, 0, 0) != 0){return 1;}
+
+	// nothing observed yet
+	if(recompute_schedule_cost(&s, 1000.0) != 0.0){result = 1;}
+
+	for(uint64_t n = 100 ; n <= 800 ; n *= 2){test_schedule_observe_simulated_step(&s, n);}
+	// extrapolated beyond the observations
+	const double predicted = recompute_schedule_cost(&s, 6400.0);
+	const double expected = test_schedule_simulated_cost(6400.0);
+	if(fabs(predicted - expected) > 1e-6 * expected){result = 1;}
+
+	free_recompute_schedule(&s);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_schedule_cost_model: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_schedule_cost_model: FAIL");
+	}
+	return result;
+}
+
+// steps of a simulated run, where ingesting one unit takes ns_per_unit and every step is computed on the reader
+static int32_t test_schedule_simulate(struct recompute_schedule * const s, const double ns_per_unit, const double log10_spacing, uint64_t * const boundaries, const int32_t num_boundaries){
+	uint64_t units = 1;
+	int64_t now = 1;
+
+	for(int32_t k = 0 ; k < num_boundaries ; k++){
+		const uint64_t num_nodes = test_schedule_simulated_nodes(units);
+		test_schedule_observe_simulated_step(s, num_nodes);
+		now += (int64_t) test_schedule_simulated_cost((double) num_nodes);
+		boundaries[k] = recompute_schedule_next(s, &(s->document), units, num_nodes, now, 1, log10_spacing);
+		if(boundaries[k] <= units){return 1;}
+		now += (int64_t) (ns_per_unit * (boundaries[k] - units));
+		units = boundaries[k];
+	}
+	return 0;
+}
+
+int32_t test_schedule_boundaries(void){
+	const double compute_fraction = 0.2;
+	const double ns_per_unit = 50000.0;
+	const double ratio = compute_fraction / (1.0 - compute_fraction);
+	struct recompute_schedule s;
+	uint64_t boundaries[24];
+	int32_t result = 0;
+
+	if(create_recompute_schedule(&s, TEST_SCHEDULE_ALL_FUNCTIONS, compute_fraction, 1, 0, 0) != 0){return 1;}
+	if(test_schedule_simulate(&s, ns_per_unit, 0.0, boundaries, 24) != 0){result = 1;}
+
+	// once costs and ingestion are known, every step is the smallest one keeping compute within the fraction,
+	// up to the error of the fitted vocabulary growth; the first ones are bounded by doubling the number of units read
+	for(int32_t k = 2 ; result == 0 && k < 24 ; k++){
+		const uint64_t from = boundaries[k - 1];
+		const uint64_t delta = boundaries[k] - from;
+		const double cost = test_schedule_simulated_cost((double) test_schedule_simulated_nodes(boundaries[k]));
+		const double cost_before = test_schedule_simulated_cost((double) test_schedule_simulated_nodes(boundaries[k] - 1));
+		if(delta == from){continue;}
+		if(cost > 1.03 * ratio * ns_per_unit * delta){result = 1;}
+		if(delta > 1 && cost_before < 0.97 * ratio * ns_per_unit * (delta - 1)){result = 1;}
+	}
+	// quadratic costs on a square-root vocabulary grow linearly with the units, so steps end up spaced by a constant factor,
+	// here 1 + 4000 / (ratio * ns_per_unit - 4000)
+	const double growth = ((double) boundaries[23]) / ((double) boundaries[22]);
+	if(growth < 1.44 || growth > 1.50){result = 1;}
+
+	free_recompute_schedule(&s);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_schedule_boundaries: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_schedule_boundaries: FAIL");
+	}
+	return result;
+}
+
+int32_t test_schedule_log_spacing(void){
+	const double log10_spacing = 0.25;
+	struct recompute_schedule s;
+	uint64_t boundaries[16];
+	int32_t result = 0;
+
+	if(create_recompute_schedule(&s, TEST_SCHEDULE_ALL_FUNCTIONS, 0.2, 1, 0, 0) != 0){return 1;}
+	if(test_schedule_simulate(&s, 50000.0, log10_spacing, boundaries, 16) != 0){result = 1;}
+
+	// every boundary is one of floor(10^(k * 0.25))
+	for(int32_t k = 0 ; result == 0 && k < 16 ; k++){
+		const double exponent = round(log10((double) boundaries[k]) / log10_spacing);
+		if(boundaries[k] != (uint64_t) floor(pow(10.0, exponent * log10_spacing)) && boundaries[k] != (uint64_t) floor(pow(10.0, (exponent + 1.0) * log10_spacing))){result = 1;}
+	}
+
+	free_recompute_schedule(&s);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_schedule_log_spacing: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_schedule_log_spacing: FAIL");
+	}
+	return result;
+}
+
+int32_t test_schedule_deterministic(void){
+	struct recompute_schedule s_slow;
+	struct recompute_schedule s_fast;
+	uint64_t boundaries_slow[16];
+	uint64_t boundaries_fast[16];
+	int32_t result = 0;
+
+	if(create_recompute_schedule(&s_slow, TEST_SCHEDULE_ALL_FUNCTIONS, 0.1, 1, 0, 1) != 0){return 1;}
+	if(create_recompute_schedule(&s_fast, TEST_SCHEDULE_ALL_FUNCTIONS, 0.1, 1, 0, 1) != 0){free_recompute_schedule(&s_slow); return 1;}
+
+	// whatever the timings, the boundaries only depend on the number of units and nodes
+	if(test_schedule_simulate(&s_slow, 1000000.0, 0.0, boundaries_slow, 16) != 0 || test_schedule_simulate(&s_fast, 10.0, 0.0, boundaries_fast, 16) != 0){result = 1;}
+	for(int32_t k = 0 ; result == 0 && k < 16 ; k++){
+		if(boundaries_slow[k] != boundaries_fast[k]){result = 1;}
+	}
+	if(recompute_schedule_cost(&s_slow, 100.0) != recompute_schedule_cost(&s_fast, 100.0)){result = 1;}
+
+	free_recompute_schedule(&s_slow);
+	free_recompute_schedule(&s_fast);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_schedule_deterministic: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_schedule_deterministic: FAIL");
+	}
+	return result;
+}
+
+#endif
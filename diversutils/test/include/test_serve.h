@@ -0,0 +1,633 @@
+#ifndef TEST_SERVE_H
+#define TEST_SERVE_H
+
+#include <dirent.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "measurement.h"
+#include "file_queue.h"
+#include "serve.h"
+#include "corpus.h"
+#include "oov/counter.h"
+#include "cupt/constants.h"
+
+#define TEST_SERVE_SOCKET_PATH "/tmp/diversutils_test_serve.sock"
+#define TEST_SERVE_OTHER_UID 65534 // nobody
+#define TEST_SERVE_W2V_PATH "/tmp/diversutils_test_serve.bin"
+#define TEST_SERVE_JSONL_FORMAT "/tmp/diversutils_test_serve_%u.jsonl"
+#define TEST_SERVE_LIST_PATH "/tmp/diversutils_test_serve_list.txt"
+#define TEST_SERVE_OUTPUT_FORMAT "/tmp/diversutils_test_serve_%s.tsv"
+#define TEST_SERVE_NUM_VECTORS 40
+#define TEST_SERVE_NUM_DIMENSIONS 8
+#define TEST_SERVE_NUM_FILES 3
+#define TEST_SERVE_NUM_DOCUMENTS 20
+#define TEST_SERVE_NUM_TOKENS 10
+#define TEST_SERVE_TIMEOUT_S 30
+
+// the word2vec is loaded once for every job, as main_measurement --serve does
+struct test_serve_context {
+	struct word2vec w2v;
+	uint8_t released; // jobs with the id "hold" wait for it
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+struct test_serve_server {
+	struct serve s;
+	int32_t result;
+};
+
+static int32_t test_serve_write_inputs(void){
+	FILE * f = fopen(TEST_SERVE_W2V_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); return 1;}
+	fprintf(f, "%u %u\n", TEST_SERVE_NUM_VECTORS, TEST_SERVE_NUM_DIMENSIONS);
+	for(uint32_t i = 0 ; i < TEST_SERVE_NUM_VECTORS ; i++){
+		float vector[TEST_SERVE_NUM_DIMENSIONS];
+		for(uint32_t d = 0 ; d < TEST_SERVE_NUM_DIMENSIONS ; d++){vector[d] = (float) ((int32_t) ((i * 11 + d * 23 + i * d) % 17) - 8);}
+		fprintf(f, "w%u ", i);
+		fwrite(vector, sizeof(float), TEST_SERVE_NUM_DIMENSIONS, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+
+	FILE * const list = fopen(TEST_SERVE_LIST_PATH, "w");
+	if(list == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open list of files"); return 1;}
+	for(uint32_t c = 0 ; c < TEST_SERVE_NUM_FILES ; c++){
+		char path[64];
+		snprintf(path, 64, TEST_SERVE_JSONL_FORMAT, c);
+		fprintf(list, "%s\n", path);
+		f = fopen(path, "w");
+		if(f == NULL){fclose(list); error_format(__FILE__, __func__, __LINE__, "failed to open synthetic jsonl file"); return 1;}
+		for(uint32_t d = 0 ; d < TEST_SERVE_NUM_DOCUMENTS ; d++){
+			fprintf(f, "{\"id\": \"c%ud%u\", \"text\": \"", c, d);
+			// a few words past the vocabulary, so that some tokens are OOV
+			for(uint32_t t = 0 ; t < TEST_SERVE_NUM_TOKENS ; t++){fprintf(f, "%sw%u", t == 0 ? "" : " ", (c * 13 + d * 7 + t * t) % (TEST_SERVE_NUM_VECTORS + 5));}
+			fprintf(f, "\"}\n");
+		}
+		fclose(f);
+	}
+	fclose(list);
+	return 0;
+}
+
+static void test_serve_remove_inputs(void){
+	remove(TEST_SERVE_W2V_PATH);
+	remove(TEST_SERVE_LIST_PATH);
+	for(uint32_t c = 0 ; c < TEST_SERVE_NUM_FILES ; c++){
+		char path[64];
+		snprintf(path, 64, TEST_SERVE_JSONL_FORMAT, c);
+		remove(path);
+	}
+}
+
+// reads the files of the job into a graph of the resident word2vec, and writes how many files, nodes and documents it got
+static int32_t test_serve_job(struct serve_job * const job, void * const arg){
+	struct test_serve_context * const context = (struct test_serve_context *) arg;
+	struct graph g;
+	struct minimum_spanning_tree mst = {0};
+	struct graph_distance_heap heap = {0};
+	struct oov_counter oov;
+	char ** paths = NULL;
+	int32_t num_paths = 0;
+	int32_t result = 0;
+
+	if(job->id != NULL && strcmp(job->id, "hold") == 0){
+		pthread_mutex_lock(&(context->mutex));
+		while(!context->released){pthread_cond_wait(&(context->cond), &(context->mutex));}
+		pthread_mutex_unlock(&(context->mutex));
+	}
+
+	FILE * const list = fopen(job->input_path, "r");
+	if(list == NULL){
+		snprintf(job->error, SERVE_ERROR_SIZE, "cannot open %s", job->input_path);
+		return 1;
+	}
+	char line[256];
+	while(fgets(line, sizeof(line), list) != NULL){
+		line[strcspn(line, "\n")] = '\0';
+		char ** const grown = realloc(paths, (num_paths + 1) * sizeof(char *));
+		if(grown == NULL){result = 1; break;}
+		paths = grown;
+		paths[num_paths] = malloc(strlen(line) + 1);
+		if(paths[num_paths] == NULL){result = 1; break;}
+		memcpy(paths[num_paths], line, strlen(line) + 1);
+		num_paths++;
+	}
+	fclose(list);
+
+	if(result != 0 || create_graph_empty(&g) != 0){
+		for(int32_t k = 0 ; k < num_paths ; k++){free(paths[k]);}
+		free(paths);
+		return 1;
+	}
+	if(graph_bind_word2vec(&g, &(context->w2v)) != 0 || create_oov_counter(&oov, 0) != 0){
+		free_graph(&g);
+		for(int32_t k = 0 ; k < num_paths ; k++){free(paths[k]);}
+		free(paths);
+		return 1;
+	}
+
+	const struct measurement_progress progress = {
+		.file_done = serve_job_file_done,
+		.ctx = job,
+	};
+	struct measurement_configuration mcfg = {
+		.target_column = UD_FORM,
+		.jsonl_content_key = "text",
+		.io = (struct measurement_io) {
+			.w2v_path = TEST_SERVE_W2V_PATH,
+			.jsonl_content_key = "text",
+			.progress = &progress,
+		},
+		.threading = (struct measurement_threading) {
+			.num_row_threads = 1,
+			.num_matrix_threads = 1,
+			.num_file_reading_threads = 2,
+		},
+	};
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.mst = &mst,
+		.heap = &heap,
+		.w2v = &(context->w2v),
+		.oov_discarded_because_not_in_vector_database = &oov,
+	};
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+		.document = (struct measurement_mutable_counters) { .count_target = 1, },
+	};
+	pthread_mutex_init(&(mmut.mutex), NULL);
+
+	struct file_queue q;
+	if(create_file_queue(&q, paths, NULL, num_paths, 0) != 0){
+		result = 1;
+	} else {
+		q.progress = mcfg.io.progress;
+		if(file_queue_read(&q, &mcfg, &sref, &mmut, 2) != 0){result = 1;}
+		if(result == 0){
+			FILE * const output = fopen(job->output_path, "w");
+			if(output == NULL){
+				result = 1;
+			} else {
+				fprintf(output, "%i\t%li\t%lu\n", q.num_done, g.num_nodes, mmut.document.num_all);
+				fclose(output);
+			}
+		}
+		free_file_queue(&q);
+	}
+
+	pthread_mutex_destroy(&(mmut.mutex));
+	free_oov_counter(&oov);
+	free_graph(&g);
+	for(int32_t k = 0 ; k < num_paths ; k++){free(paths[k]);}
+	free(paths);
+	return result;
+}
+
+static void * test_serve_thread(void * arg){
+	struct test_serve_server * const server = (struct test_serve_server *) arg;
+	server->result = serve_run(&(server->s));
+	return NULL;
+}
+
+static int32_t test_serve_connect(void){
+	struct sockaddr_un address;
+	struct timeval timeout = {.tv_sec = TEST_SERVE_TIMEOUT_S, .tv_usec = 0};
+
+	memset(&address, '\0', sizeof(struct sockaddr_un));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path, TEST_SERVE_SOCKET_PATH, strlen(TEST_SERVE_SOCKET_PATH));
+	const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0){return -1;}
+	// a server that stops answering fails the test instead of blocking it
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	if(connect(fd, (const struct sockaddr *) &address, sizeof(struct sockaddr_un)) != 0){
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int32_t test_serve_send(const int32_t fd, const char * const request){
+	const size_t n = strlen(request);
+	return send(fd, request, n, 0) != (ssize_t) n || send(fd, "\n", 1, 0) != 1;
+}
+
+static int32_t test_serve_next_line(const int32_t fd, char * const line, const size_t size){
+	size_t len = 0;
+	char c;
+	while(1){
+		if(recv(fd, &c, 1, 0) != 1){return 1;}
+		if(c == '\n'){break;}
+		if(len + 1 < size){line[len++] = c;}
+	}
+	line[len] = '\0';
+	return 0;
+}
+
+// skips the replies up to the first with the given id and status, which is left in line
+static int32_t test_serve_expect(const int32_t fd, const char * const id, const char * const status, char * const line, const size_t size){
+	char expected_id[64];
+	char expected_status[64];
+	snprintf(expected_id, 64, "{\"id\":\"%s\",", id);
+	snprintf(expected_status, 64, "\"status\":\"%s\"", status);
+	while(1){
+		if(test_serve_next_line(fd, line, size) != 0){return 1;}
+		if(strncmp(line, expected_id, strlen(expected_id)) == 0 && strstr(line, expected_status) != NULL){return 0;}
+	}
+}
+
+// the socket is only open to its owner whatever the umask, and, when run as root, a connection from another user is closed before any request is read
+static int32_t test_serve_permissions(void){
+	struct stat st;
+	if(stat(TEST_SERVE_SOCKET_PATH, &st) != 0 || (st.st_mode & 0777) != SERVE_SOCKET_MODE){
+		error_format(__FILE__, __func__, __LINE__, "the socket is open to other users");
+		return 1;
+	}
+	if(geteuid() != 0){return 0;}
+
+	if(chmod(TEST_SERVE_SOCKET_PATH, 0666) != 0){return 1;}
+	const pid_t pid = fork();
+	if(pid == 0){
+		char line[256];
+		if(setuid(TEST_SERVE_OTHER_UID) != 0){_exit(2);}
+		const int32_t fd = test_serve_connect();
+		if(fd < 0){_exit(3);}
+		// were it read, the shutdown would stop the server before the other tests; the send fails when the connection is already closed
+		signal(SIGPIPE, SIG_IGN);
+		(void) test_serve_send(fd, "{\"shutdown\": true}");
+		_exit(test_serve_next_line(fd, line, sizeof(line)) != 0 ? 0 : 1);
+	}
+	int status = -1;
+	const int32_t result = pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	if(chmod(TEST_SERVE_SOCKET_PATH, SERVE_SOCKET_MODE) != 0 || result != 0){
+		error_format(__FILE__, __func__, __LINE__, "a connection from another user was accepted");
+		return 1;
+	}
+	return 0;
+}
+
+static int32_t test_serve_read_output(const char * const name, int32_t * const num_files, int64_t * const num_nodes, uint64_t * const num_documents){
+	char path[64];
+	snprintf(path, 64, TEST_SERVE_OUTPUT_FORMAT, name);
+	FILE * const f = fopen(path, "r");
+	if(f == NULL){return 1;}
+	const int32_t status = fscanf(f, "%i\t%li\t%lu", num_files, num_nodes, num_documents) != 3;
+	fclose(f);
+	remove(path);
+	return status;
+}
+
+// the replies serve_request wrote to f, as a string
+static char * test_serve_replies(FILE * const f){
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	rewind(f);
+	char * const replies = calloc((size_t) size + 1, 1);
+	if(replies != NULL && fread(replies, 1, (size_t) size, f) != (size_t) size){replies[0] = '\0';}
+	fclose(f);
+	return replies;
+}
+
+// one job from start to end through serve_request, with a reply per file read
+static int32_t test_serve_request(void){
+	char request[512];
+	char output_path[64];
+	int32_t result = 0;
+
+	snprintf(output_path, 64, TEST_SERVE_OUTPUT_FORMAT, "a");
+	snprintf(request, 512, "{\"id\": \"a\", \"input_path\": \"%s\", \"output_path\": \"%s\", \"functions\": [\"shannon_weaver_entropy\"]}", TEST_SERVE_LIST_PATH, output_path);
+	FILE * const f = tmpfile();
+	if(f == NULL){return 1;}
+	if(serve_request(TEST_SERVE_SOCKET_PATH, request, f) != 0){result = 1;}
+	char * const replies = test_serve_replies(f);
+
+	int32_t num_progress = 0;
+	for(const char * p = replies ; p != NULL && (p = strstr(p, "\"status\":\"progress\"")) != NULL ; p++){num_progress++;}
+	if(replies == NULL || strncmp(replies, "{\"id\":\"a\",\"status\":\"queued\",", 28) != 0 || strstr(replies, "\"status\":\"running\"") == NULL || strstr(replies, "\"status\":\"done\"") == NULL){result = 1;}
+	if(num_progress != TEST_SERVE_NUM_FILES || strstr(replies, "\"num_done\":3,\"num_files\":3,\"fraction_of_bytes\":1.000000") == NULL){result = 1;}
+	free(replies);
+
+	int32_t num_files;
+	int64_t num_nodes;
+	uint64_t num_documents;
+	if(test_serve_read_output("a", &num_files, &num_nodes, &num_documents) != 0 || num_files != TEST_SERVE_NUM_FILES || num_nodes <= 0 || num_nodes > TEST_SERVE_NUM_VECTORS || num_documents != TEST_SERVE_NUM_FILES * TEST_SERVE_NUM_DOCUMENTS){result = 1;}
+	return result;
+}
+
+// with one worker busy and a queue of one job, a third job is rejected; the other two still run
+static int32_t test_serve_queue_full(struct test_serve_context * const context){
+	char request[512];
+	char line[SERVE_REPLY_SIZE];
+	int32_t result = 0;
+
+	const int32_t fd = test_serve_connect();
+	if(fd < 0){return 1;}
+	const char * const ids[3] = {"hold", "queued", "rejected"};
+	for(int32_t k = 0 ; k < 3 && result == 0 ; k++){
+		char output_path[64];
+		snprintf(output_path, 64, TEST_SERVE_OUTPUT_FORMAT, ids[k]);
+		snprintf(request, 512, "{\"id\": \"%s\", \"input_path\": \"%s\", \"output_path\": \"%s\"}", ids[k], TEST_SERVE_LIST_PATH, output_path);
+		if(test_serve_send(fd, request) != 0){result = 1;}
+		// the next job is sent once this one is out of the queue, or in it
+		else if(k == 0 && test_serve_expect(fd, ids[k], "running", line, sizeof(line)) != 0){result = 1;}
+		else if(k == 1 && (test_serve_expect(fd, ids[k], "queued", line, sizeof(line)) != 0 || strstr(line, "\"position\":1") == NULL)){result = 1;}
+		else if(k == 2 && (test_serve_expect(fd, ids[k], "rejected", line, sizeof(line)) != 0 || strstr(line, "the queue is full") == NULL)){result = 1;}
+	}
+
+	pthread_mutex_lock(&(context->mutex));
+	context->released = 1;
+	pthread_cond_broadcast(&(context->cond));
+	pthread_mutex_unlock(&(context->mutex));
+
+	if(result == 0 && (test_serve_expect(fd, "hold", "done", line, sizeof(line)) != 0 || test_serve_expect(fd, "queued", "done", line, sizeof(line)) != 0)){result = 1;}
+	for(int32_t k = 0 ; k < 2 && result == 0 ; k++){
+		int32_t num_files;
+		int64_t num_nodes;
+		uint64_t num_documents;
+		if(test_serve_read_output(ids[k], &num_files, &num_nodes, &num_documents) != 0 || num_files != TEST_SERVE_NUM_FILES){result = 1;}
+	}
+
+	// requests that are not jobs are answered with an error, and the connection stays usable
+	if(result == 0 && (test_serve_send(fd, "{\"id\": \"bad\", \"input_path\": \"x\", \"unknown\": 1}") != 0 || test_serve_expect(fd, "bad", "error", line, sizeof(line)) != 0 || strstr(line, "unknown key: unknown") == NULL)){result = 1;}
+	if(result == 0 && (test_serve_send(fd, "{\"id\": \"partial\", \"input_path\": \"x\"}") != 0 || test_serve_expect(fd, "partial", "error", line, sizeof(line)) != 0)){result = 1;}
+	if(result == 0 && (test_serve_send(fd, "{\"id\": \"missing\", \"input_path\": \"/nonexistent/list.txt\", \"output_path\": \"/nonexistent/out.tsv\"}") != 0 || test_serve_expect(fd, "missing", "error", line, sizeof(line)) != 0 || strstr(line, "cannot open") == NULL)){result = 1;}
+	close(fd);
+	return result;
+}
+
+int32_t test_serve_jobs(void){
+	struct test_serve_context context = {.released = 0};
+	struct test_serve_server server = {.result = 1};
+	pthread_t thread;
+	int32_t result = 0;
+
+	if(test_serve_write_inputs() != 0 || load_word2vec_binary(&(context.w2v), TEST_SERVE_W2V_PATH) != 0){
+		test_serve_remove_inputs();
+		error_format(__FILE__, __func__, __LINE__, "test_serve_jobs: FAIL");
+		return 1;
+	}
+	pthread_mutex_init(&(context.mutex), NULL);
+	pthread_cond_init(&(context.cond), NULL);
+
+	// a regular file at the socket path is never replaced
+	remove(TEST_SERVE_SOCKET_PATH);
+	FILE * const f = fopen(TEST_SERVE_SOCKET_PATH, "w");
+	if(f != NULL){fclose(f);}
+	if(f == NULL || create_serve(&(server.s), TEST_SERVE_SOCKET_PATH, 1, 1, test_serve_job, NULL, &context) == 0){
+		error_format(__FILE__, __func__, __LINE__, "a regular file was replaced by the socket");
+		result = 1;
+	}
+	remove(TEST_SERVE_SOCKET_PATH);
+
+	const mode_t previous_umask = umask(0);
+	const int32_t create_status = result == 0 ? create_serve(&(server.s), TEST_SERVE_SOCKET_PATH, 1, 1, test_serve_job, NULL, &context) : 1;
+	umask(previous_umask);
+	if(result == 0 && create_status != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_serve");
+		result = 1;
+	} else if(result == 0){
+		if(pthread_create(&thread, NULL, test_serve_thread, &server) != 0){
+			result = 1;
+		} else {
+			if(test_serve_permissions() != 0){result = 1;}
+			if(test_serve_request() != 0){
+				error_format(__FILE__, __func__, __LINE__, "unexpected replies to a job");
+				result = 1;
+			}
+			if(test_serve_queue_full(&context) != 0){
+				error_format(__FILE__, __func__, __LINE__, "unexpected replies with a full queue");
+				result = 1;
+			}
+			FILE * const r = tmpfile();
+			if(r == NULL || serve_request(TEST_SERVE_SOCKET_PATH, "{\"shutdown\": true}", r) != 0){result = 1;}
+			char * const replies = r != NULL ? test_serve_replies(r) : NULL;
+			if(replies == NULL || strstr(replies, "\"status\":\"shutting_down\"") == NULL){result = 1;}
+			free(replies);
+			pthread_join(thread, NULL);
+			if(server.result != 0){result = 1;}
+		}
+		free_serve(&(server.s));
+		if(access(TEST_SERVE_SOCKET_PATH, F_OK) == 0){
+			error_format(__FILE__, __func__, __LINE__, "the socket was left behind");
+			result = 1;
+		}
+	}
+
+	pthread_cond_destroy(&(context.cond));
+	pthread_mutex_destroy(&(context.mutex));
+	free_word2vec(&(context.w2v));
+	test_serve_remove_inputs();
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_serve_jobs: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_serve_jobs: FAIL");
+	}
+	return result;
+}
+
+static char * test_serve_read_file(const char * const path){
+	FILE * const f = fopen(path, "r");
+	if(f == NULL){return NULL;}
+	return test_serve_replies(f);
+}
+
+// file descriptors and threads of the process, which a failed job must give back
+static int32_t test_serve_count_resources(int32_t * const num_fds, int32_t * const num_threads){
+	char line[256];
+	DIR * const d = opendir("/proc/self/fd");
+	if(d == NULL){return 1;}
+	*num_fds = 0;
+	while(readdir(d) != NULL){(*num_fds)++;}
+	closedir(d);
+	FILE * const f = fopen("/proc/self/status", "r");
+	if(f == NULL){return 1;}
+	*num_threads = -1;
+	while(fgets(line, sizeof(line), f) != NULL){
+		if(strncmp(line, "Threads:", 8) == 0){*num_threads = atoi(&(line[8]));}
+	}
+	fclose(f);
+	return *num_threads < 0;
+}
+
+// the configuration of the server: jobs without a list of functions get simpson_index only
+#define TEST_SERVE_MEASUREMENT_CONFIGURATION(input, output, enable_pairwise, enable_shannon, enable_simpson) { \
+	.target_column = UD_FORM, \
+	.jsonl_content_key = "text", \
+	.div_param = (struct measurement_diversity_parameters) { \
+		.stirling_alpha = 1.0, \
+		.stirling_beta = 1.0, \
+	}, \
+	.enable = (struct measurement_diversity_enabler) { \
+		.disparity_functions = enable_pairwise, \
+		.pairwise = enable_pairwise, \
+		.non_disparity_functions = 1, \
+		.shannon_weaver_entropy = enable_shannon, \
+		.simpson_index = enable_simpson, \
+	}, \
+	.io = (struct measurement_io) { \
+		.w2v_path = TEST_SERVE_W2V_PATH, \
+		.jsonl_content_key = "text", \
+		.input_path = input, \
+		.output_path = output, \
+	}, \
+	.threading = (struct measurement_threading) { \
+		.num_row_threads = 1, \
+		.num_matrix_threads = 1, \
+		.num_file_reading_threads = 1, \
+		.recompute_queue_size = 2, \
+	}, \
+	.steps = (struct measurement_step_parameters) { \
+		.document = (struct measurement_step) { \
+			.recompute_step = 10, \
+			.enable_count_recompute_step = 1, \
+		}, \
+	}, \
+	.checkpoint = (struct measurement_checkpoint) { \
+		.path = "", \
+	}, \
+	.shard = (struct measurement_shard) { \
+		.output_path = "", \
+		.input_path = "", \
+	}, \
+}
+
+// measurement_serve_job maps each request onto a measurement of the resident word2vec; its outputs are those of measurement_corpus
+static int32_t test_serve_measurement_requests(struct word2vec * const w2v){
+	char request[512];
+	char line[SERVE_REPLY_SIZE];
+	char served_path[64];
+	char direct_path[64];
+	char default_path[64];
+	char missing_path[64];
+	int32_t result = 0;
+
+	snprintf(served_path, 64, TEST_SERVE_OUTPUT_FORMAT, "served");
+	snprintf(direct_path, 64, TEST_SERVE_OUTPUT_FORMAT, "direct");
+	snprintf(default_path, 64, TEST_SERVE_OUTPUT_FORMAT, "default");
+	snprintf(missing_path, 64, TEST_SERVE_OUTPUT_FORMAT, "missing");
+
+	// what the job asks for, measured without the server
+	struct measurement_configuration direct_mcfg = TEST_SERVE_MEASUREMENT_CONFIGURATION(TEST_SERVE_LIST_PATH, direct_path, 1, 1, 0);
+	if(measurement_corpus(&direct_mcfg, w2v, NULL, 0) != 0){return 1;}
+
+	const int32_t fd = test_serve_connect();
+	if(fd < 0){return 1;}
+
+	// a family is enabled along with its functions, and the functions of the server are left out
+	snprintf(request, 512, "{\"id\": \"served\", \"input_path\": \"%s\", \"output_path\": \"%s\", \"functions\": [\"pairwise\", \"shannon_weaver_entropy\"]}", TEST_SERVE_LIST_PATH, served_path);
+	if(test_serve_send(fd, request) != 0 || test_serve_expect(fd, "served", "done", line, sizeof(line)) != 0){result = 1;}
+	char * const served = test_serve_read_file(served_path);
+	char * const direct = test_serve_read_file(direct_path);
+	if(served == NULL || direct == NULL || strcmp(served, direct) != 0){result = 1;}
+	if(served == NULL || strstr(served, "\tpairwise\tshannon_weaver_entropy\tshannon_weaver_hill_number\n") == NULL || strstr(served, "simpson_index") != NULL){result = 1;}
+	// the header, a row every 10 documents from the first one, and the final row
+	int32_t num_rows = 0;
+	for(const char * p = served ; p != NULL && (p = strchr(p, '\n')) != NULL ; p++){num_rows++;}
+	if(num_rows != 1 + (TEST_SERVE_NUM_FILES * TEST_SERVE_NUM_DOCUMENTS) / 10 + 1){result = 1;}
+	free(served);
+	free(direct);
+
+	// an unknown function is answered before the job is queued
+	snprintf(request, 512, "{\"id\": \"unknown\", \"input_path\": \"%s\", \"output_path\": \"%s\", \"functions\": [\"shannon_weaver_entropy\", \"nope\"]}", TEST_SERVE_LIST_PATH, default_path);
+	if(result == 0 && (test_serve_send(fd, request) != 0 || test_serve_next_line(fd, line, sizeof(line)) != 0 || strstr(line, "\"status\":\"error\"") == NULL || strstr(line, "unknown function: nope") == NULL)){result = 1;}
+
+	// without a list, the job measures what the server enables
+	snprintf(request, 512, "{\"id\": \"default\", \"input_path\": \"%s\", \"output_path\": \"%s\"}", TEST_SERVE_LIST_PATH, default_path);
+	if(result == 0 && (test_serve_send(fd, request) != 0 || test_serve_expect(fd, "default", "done", line, sizeof(line)) != 0)){result = 1;}
+	char * const measured = test_serve_read_file(default_path);
+	if(measured == NULL || strstr(measured, "\tsigma_dist\tsimpson_index\n") == NULL){result = 1;}
+	free(measured);
+
+	// a list naming a missing file fails with its cause, and gives back its threads and files
+	FILE * const list = fopen(missing_path, "w");
+	if(list == NULL){result = 1;}
+	else {
+		fprintf(list, "/tmp/diversutils_test_serve_0.jsonl\n/nonexistent/diversutils_test_serve.jsonl\n");
+		fclose(list);
+	}
+	int32_t num_fds_before, num_threads_before, num_fds_after, num_threads_after;
+	if(result == 0 && test_serve_count_resources(&num_fds_before, &num_threads_before) != 0){result = 1;}
+	for(int32_t k = 0 ; k < 3 && result == 0 ; k++){
+		snprintf(request, 512, "{\"id\": \"missing\", \"input_path\": \"%s\", \"output_path\": \"%s\"}", missing_path, served_path);
+		if(test_serve_send(fd, request) != 0 || test_serve_expect(fd, "missing", "error", line, sizeof(line)) != 0 || strstr(line, "cannot stat /nonexistent/diversutils_test_serve.jsonl") == NULL){result = 1;}
+	}
+	if(result == 0 && (test_serve_count_resources(&num_fds_after, &num_threads_after) != 0 || num_fds_after != num_fds_before || num_threads_after != num_threads_before)){
+		error_format(__FILE__, __func__, __LINE__, "a failed job kept some of its threads or files");
+		result = 1;
+	}
+
+	close(fd);
+	remove(served_path);
+	remove(direct_path);
+	remove(default_path);
+	remove(missing_path);
+	return result;
+}
+
+int32_t test_serve_measurement(void){
+	struct test_serve_server server = {.result = 1};
+	struct word2vec w2v;
+	pthread_t thread;
+	int32_t result = 0;
+
+	if(test_serve_write_inputs() != 0 || load_word2vec_binary(&w2v, TEST_SERVE_W2V_PATH) != 0){
+		test_serve_remove_inputs();
+		error_format(__FILE__, __func__, __LINE__, "test_serve_measurement: FAIL");
+		return 1;
+	}
+	struct measurement_configuration mcfg = TEST_SERVE_MEASUREMENT_CONFIGURATION(NULL, NULL, 0, 0, 1);
+	struct measurement_serve_context context = {
+		.mcfg = &mcfg,
+		.w2v = &w2v,
+	};
+
+	remove(TEST_SERVE_SOCKET_PATH);
+	if(create_serve(&(server.s), TEST_SERVE_SOCKET_PATH, 1, 4, measurement_serve_job, measurement_serve_check, &context) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_serve");
+		result = 1;
+	} else {
+		if(pthread_create(&thread, NULL, test_serve_thread, &server) != 0){
+			result = 1;
+		} else {
+			if(test_serve_measurement_requests(&w2v) != 0){
+				error_format(__FILE__, __func__, __LINE__, "unexpected outputs of measurement_serve_job");
+				result = 1;
+			}
+			FILE * const r = tmpfile();
+			if(r == NULL || serve_request(TEST_SERVE_SOCKET_PATH, "{\"shutdown\": true}", r) != 0){result = 1;}
+			free(r != NULL ? test_serve_replies(r) : NULL);
+			pthread_join(thread, NULL);
+			if(server.result != 0){result = 1;}
+		}
+		free_serve(&(server.s));
+	}
+
+	free_word2vec(&w2v);
+	test_serve_remove_inputs();
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_serve_measurement: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_serve_measurement: FAIL");
+	}
+	return result;
+}
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef TEST_SHARD_H
+#define TEST_SHARD_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+#include "graph.h"
+#include "measurement.h"
+#include "shard.h"
+#include "file_queue.h"
+#include "oov/counter.h"
+#include "cupt/constants.h"
+
+#define TEST_SHARD_W2V_PATH "/tmp/diversutils_test_shard.bin"
+#define TEST_SHARD_JSONL_FORMAT "/tmp/diversutils_test_shard_%u.jsonl"
+#define TEST_SHARD_SHARD_FORMAT "/tmp/diversutils_test_shard_%u.shard"
+#define TEST_SHARD_MERGED_PATH "/tmp/diversutils_test_shard_merged.shard"
+#define TEST_SHARD_DIRECT_PATH "/tmp/diversutils_test_shard_direct.tsv"
+#define TEST_SHARD_MEASURED_PATH "/tmp/diversutils_test_shard_measured.tsv"
+#define TEST_SHARD_NUM_VECTORS 300
+#define TEST_SHARD_NUM_DIMENSIONS 8
+#define TEST_SHARD_NUM_FILES 4
+#define TEST_SHARD_NUM_SHARDS 3
+#define TEST_SHARD_NUM_DOCUMENTS 50
+#define TEST_SHARD_NUM_TOKENS 20
+
+static int32_t test_shard_write_inputs(char ** const paths){
+	FILE * f = fopen(TEST_SHARD_W2V_PATH, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); return 1;}
+	fprintf(f, "%u %u\n", TEST_SHARD_NUM_VECTORS, TEST_SHARD_NUM_DIMENSIONS);
+	for(uint32_t i = 0 ; i < TEST_SHARD_NUM_VECTORS ; i++){
+		float vector[TEST_SHARD_NUM_DIMENSIONS];
+		for(uint32_t d = 0 ; d < TEST_SHARD_NUM_DIMENSIONS ; d++){vector[d] = (float) ((int32_t) ((i * 11 + d * 31 + i * d) % 23) - 11);}
+		fprintf(f, "w%u ", i);
+		fwrite(vector, sizeof(float), TEST_SHARD_NUM_DIMENSIONS, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+
+	// every file brings types of its own and shares others (and some OOV types) with the files before it
+	for(uint32_t c = 0 ; c < TEST_SHARD_NUM_FILES ; c++){
+		paths[c] = malloc(64);
+		if(paths[c] == NULL){return 1;}
+		snprintf(paths[c], 64, TEST_SHARD_JSONL_FORMAT, c);
+		f = fopen(paths[c], "w");
+		if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic jsonl file"); return 1;}
+		for(uint32_t d = 0 ; d < TEST_SHARD_NUM_DOCUMENTS ; d++){
+			fprintf(f, "{\"id\": \"f%ud%u\", \"text\": \"", c, d);
+			for(uint32_t t = 0 ; t < TEST_SHARD_NUM_TOKENS ; t++){
+				const uint32_t r = (d * 7919 + t * 104729 + c * 37) % (5 + d + t);
+				const uint32_t index = (c * 60 + (r * r) % 150) % TEST_SHARD_NUM_VECTORS;
+				if(t % 7 == 6){
+					fprintf(f, "%soov%u", t == 0 ? "" : " ", (c + r) % 17);
+				} else {
+					fprintf(f, "%sw%u", t == 0 ? "" : " ", index);
+				}
+			}
+			fprintf(f, "\"}\n");
+		}
+		fclose(f);
+	}
+	return 0;
+}
+
+static void test_shard_remove_files(char ** const paths){
+	char path[64];
+	remove(TEST_SHARD_W2V_PATH);
+	remove(TEST_SHARD_MERGED_PATH);
+	remove(TEST_SHARD_DIRECT_PATH);
+	remove(TEST_SHARD_MEASURED_PATH);
+	for(uint32_t c = 0 ; c < TEST_SHARD_NUM_SHARDS ; c++){
+		snprintf(path, 64, TEST_SHARD_SHARD_FORMAT, c);
+		remove(path);
+	}
+	for(uint32_t c = 0 ; c < TEST_SHARD_NUM_FILES ; c++){
+		if(paths[c] == NULL){continue;}
+		remove(paths[c]);
+		free(paths[c]);
+		paths[c] = NULL;
+	}
+}
+
+/*
+ * As main_measurement does, without intermediate steps: reads the files (or restores the shard from) and then
+ * either captures the counts into to, or writes the final step to output_path.
+ */
+static int32_t test_shard_measure(struct word2vec * const w2v, char ** const paths, const int32_t num_paths, const struct shard * const from, struct shard * const to, const char * const output_path){
+	struct graph g;
+	struct minimum_spanning_tree mst = {0};
+	struct graph_distance_heap heap = {0};
+	struct oov_counter oov;
+	struct output_stream output;
+	int32_t result = 0;
+
+	if(create_graph_empty(&g) != 0){return 1;}
+	if(graph_bind_word2vec(&g, w2v) != 0){free_graph(&g); return 1;}
+	if(create_oov_counter(&oov, 0) != 0){free_graph(&g); return 1;}
+	if(output_path != NULL && create_output_stream(&output, output_path, OUTPUT_FORMAT_TSV, OUTPUT_COMPRESSION_NONE, 1) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to open output file");
+		free_oov_counter(&oov);
+		free_graph(&g);
+		return 1;
+	}
+
+	struct measurement_configuration mcfg = {
+		.target_column = UD_FORM,
+		.jsonl_content_key = "text",
+		.div_param = (struct measurement_diversity_parameters) {
+			.stirling_alpha = 1.0,
+			.stirling_beta = 1.0,
+			.leinster_cobbold_diversity_alpha = 2.0,
+			.renyi_alpha = 2.0,
+			.hill_number_standard_alpha = 2.0,
+		},
+		.enable = (struct measurement_diversity_enabler) {
+			.stirling = 1,
+			.pairwise = 1,
+			.leinster_cobbold_diversity = 1,
+			.non_disparity_functions = 1,
+			.disparity_functions = 1,
+			.shannon_weaver_entropy = 1,
+			.renyi_entropy = 1,
+			.simpson_index = 1,
+			.hill_number_standard = 1,
+			.berger_parker_index = 1,
+		},
+		.io = (struct measurement_io) {
+			.w2v_path = TEST_SHARD_W2V_PATH,
+			.jsonl_content_key = "text",
+			.output = output_path != NULL ? &output : NULL,
+		},
+		.threading = (struct measurement_threading) {
+			.num_row_threads = 2,
+			.num_matrix_threads = 2,
+			.num_file_reading_threads = 1,
+			.enable_multithreaded_matrix_generation = 1,
+		},
+	};
+	struct measurement_structure_references sref = {
+		.g = &g,
+		.mst = &mst,
+		.heap = &heap,
+		.w2v = w2v,
+		.oov_discarded_because_not_in_vector_database = &oov,
+	};
+	struct measurement_mutables mmut = {
+		.best_s = -1.0,
+		.prev_best_s = -1.0,
+		.sentence = (struct measurement_mutable_counters) { .count_target = 1, },
+		.document = (struct measurement_mutable_counters) { .count_target = 1, },
+	};
+	pthread_mutex_init(&(mmut.mutex), NULL);
+
+	int32_t i = 0;
+	int64_t num_oov_types = 0;
+	if(from != NULL){
+		if(measurement_restore_shard(from, &sref, &mmut, &num_oov_types) != 0){result = 1;}
+		i = (int32_t) from->num_files;
+	} else {
+		struct file_queue q;
+		if(create_file_queue(&q, paths, NULL, num_paths, 0) != 0){
+			result = 1;
+		} else {
+			if(file_queue_read(&q, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+			i = q.num_done;
+			free_file_queue(&q);
+		}
+		num_oov_types = oov_counter_num_types(&oov);
+	}
+
+	pthread_mutex_lock(&(g.mutex_nodes));
+	if(result == 0 && to != NULL){
+		if(measurement_capture_shard(to, &sref, &mmut, (uint64_t) i) != 0){result = 1;}
+	} else if(result == 0){
+		mmut.num_oov_types = num_oov_types;
+		if(compute_graph_relative_proportions(&g) != 0 || measurement_recompute_step(i, &mcfg, &sref, &mmut, 1) != 0){result = 1;}
+	}
+	pthread_mutex_unlock(&(g.mutex_nodes));
+
+	if(output_path != NULL){
+		if(output_stream_finish(&output) != 0){result = 1;}
+		free_output_stream(&output);
+	}
+	pthread_mutex_destroy(&(mmut.mutex));
+	free_oov_counter(&oov);
+	free_graph(&g);
+	free_graph_distance_heap(&heap);
+	free_minimum_spanning_tree(&mst);
+	return result;
+}
+
+static int32_t test_shard_same_entries(const struct shard_entry * const a, const struct shard_entry * const b, const uint64_t n){
+	for(uint64_t k = 0 ; k < n ; k++){
+		if(strcmp(a[k].key, b[k].key) != 0 || a[k].count != b[k].count || a[k].first_seen != b[k].first_seen){return 0;}
+	}
+	return 1;
+}
+
+// the merge does not depend on the number of threads, and a damaged shard is refused
+static int32_t test_shard_merge_properties(const struct shard * const inputs, const struct shard * const merged){
+	int32_t result = 0;
+	for(int32_t num_threads = 1 ; num_threads <= 5 && result == 0 ; num_threads += 4){
+		struct shard other;
+		if(shard_merge(&other, inputs, TEST_SHARD_NUM_SHARDS, num_threads) != 0){
+			error_format(__FILE__, __func__, __LINE__, "failed to call shard_merge");
+			return 1;
+		}
+		if(other.num_entries != merged->num_entries || other.num_oov_entries != merged->num_oov_entries || other.num_oov_types != merged->num_oov_types || other.num_tokens != merged->num_tokens || !test_shard_same_entries(other.entries, merged->entries, merged->num_entries) || !test_shard_same_entries(other.oov_entries, merged->oov_entries, merged->num_oov_entries)){
+			error_format(__FILE__, __func__, __LINE__, "merge depends on the number of threads");
+			result = 1;
+		}
+		free_shard(&other);
+	}
+
+	uint64_t num_documents = 0;
+	for(int32_t k = 0 ; k < TEST_SHARD_NUM_SHARDS ; k++){num_documents += inputs[k].num_documents;}
+	if(result == 0 && (num_documents != TEST_SHARD_NUM_FILES * TEST_SHARD_NUM_DOCUMENTS || merged->num_documents != num_documents || merged->num_files != TEST_SHARD_NUM_FILES || merged->num_oov_entries == 0 || merged->num_oov_types != (int64_t) merged->num_oov_entries)){
+		error_format(__FILE__, __func__, __LINE__, "unexpected totals in merged shard");
+		result = 1;
+	}
+
+	FILE * const f = fopen(TEST_SHARD_MERGED_PATH, "r+b");
+	if(result == 0 && f != NULL){
+		fseek(f, 100, SEEK_SET);
+		const int c = fgetc(f);
+		fseek(f, 100, SEEK_SET);
+		fputc(c ^ 0x20, f);
+		fclose(f);
+		struct shard damaged;
+		if(shard_read(&damaged, TEST_SHARD_MERGED_PATH) == 0){
+			error_format(__FILE__, __func__, __LINE__, "damaged shard was read");
+			free_shard(&damaged);
+			result = 1;
+		}
+	} else if(f != NULL){
+		fclose(f);
+	}
+	return result;
+}
+
+static int32_t test_shard_compare_files(const char * const path_a, const char * const path_b){
+	FILE * const fa = fopen(path_a, "r");
+	FILE * const fb = fopen(path_b, "r");
+	int32_t result = fa == NULL || fb == NULL;
+	while(result == 0){
+		const int ca = fgetc(fa);
+		const int cb = fgetc(fb);
+		if(ca != cb){result = 1;}
+		if(ca == EOF || cb == EOF){break;}
+	}
+	if(fa != NULL){fclose(fa);}
+	if(fb != NULL){fclose(fb);}
+	return result;
+}
+
+// files 0 and 1, 2, and 3 are ingested into three shards, which are merged and measured: the row is that of reading the four files at once
+int32_t test_shard_merge_matches_direct(void){
+	char * paths[TEST_SHARD_NUM_FILES] = {0};
+	const int32_t first_file[TEST_SHARD_NUM_SHARDS + 1] = {0, 2, 3, 4};
+	struct shard shards[TEST_SHARD_NUM_SHARDS];
+	struct shard merged;
+	struct shard reread;
+	struct word2vec w2v;
+	int32_t num_shards = 0;
+	int32_t merged_status = 1;
+	int32_t reread_status = 1;
+	int32_t result = 0;
+	char path[64];
+
+	memset(shards, '\0', sizeof(shards));
+	if(test_shard_write_inputs(paths) != 0){result = 1;}
+	if(result == 0 && load_word2vec_binary(&w2v, TEST_SHARD_W2V_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call load_word2vec_binary");
+		test_shard_remove_files(paths);
+		return 1;
+	}
+
+	if(result == 0 && test_shard_measure(&w2v, paths, TEST_SHARD_NUM_FILES, NULL, NULL, TEST_SHARD_DIRECT_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to measure the files directly");
+		result = 1;
+	}
+
+	// every shard goes through its file and back
+	for( ; result == 0 && num_shards < TEST_SHARD_NUM_SHARDS ; num_shards++){
+		struct shard captured;
+		snprintf(path, 64, TEST_SHARD_SHARD_FORMAT, num_shards);
+		if(test_shard_measure(&w2v, &(paths[first_file[num_shards]]), first_file[num_shards + 1] - first_file[num_shards], NULL, &captured, NULL) != 0){
+			error_format(__FILE__, __func__, __LINE__, "failed to ingest into a shard");
+			result = 1;
+			break;
+		}
+		const int32_t write_status = shard_write(&captured, path);
+		free_shard(&captured);
+		if(write_status != 0 || shard_read(&(shards[num_shards]), path) != 0){
+			error_format(__FILE__, __func__, __LINE__, "failed to write and read back a shard");
+			result = 1;
+			break;
+		}
+	}
+
+	if(result == 0){
+		merged_status = shard_merge(&merged, shards, TEST_SHARD_NUM_SHARDS, 2);
+		if(merged_status != 0 || shard_write(&merged, TEST_SHARD_MERGED_PATH) != 0 || (reread_status = shard_read(&reread, TEST_SHARD_MERGED_PATH)) != 0){
+			error_format(__FILE__, __func__, __LINE__, "failed to merge the shards");
+			result = 1;
+		}
+	}
+	if(result == 0 && test_shard_measure(&w2v, NULL, 0, &reread, NULL, TEST_SHARD_MEASURED_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to measure the merged shard");
+		result = 1;
+	}
+	if(result == 0 && test_shard_compare_files(TEST_SHARD_DIRECT_PATH, TEST_SHARD_MEASURED_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "measuring the merged shard differs from reading the files directly");
+		result = 1;
+	}
+	if(result == 0){result = test_shard_merge_properties(shards, &merged);}
+
+	if(merged_status == 0){free_shard(&merged);}
+	if(reread_status == 0){free_shard(&reread);}
+	for(int32_t k = 0 ; k < num_shards ; k++){free_shard(&(shards[k]));}
+	free_word2vec(&w2v);
+	test_shard_remove_files(paths);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_shard_merge_matches_direct: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_shard_merge_matches_direct: FAIL");
+	}
+	return result;
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef TEST_UDPIPE_H
+#define TEST_UDPIPE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_general.h"
+
+#if TOKENIZATION_METHOD == 2
+#include "udpipe/interface/cinterface.h"
+
+#define TEST_UDPIPE_NUM_THREADS 4
+#define TEST_UDPIPE_NUM_PIPELINES 2
+#define TEST_UDPIPE_NUM_TRAINING_SENTENCES 200
+#define TEST_UDPIPE_DIRECTORY "/tmp/diversutils_test_udpipe"
+
+static const char * const test_udpipe_words[] = {"the", "cat", "sat", "on", "a", "mat", "dogs", "run", "fast", "and", "birds", "sing", "loudly", "today"};
+
+static const char * const test_udpipe_texts[] = {
+	"The cat sat on the mat. Dogs run fast!",
+	"birds sing loudly today, and the dogs run.",
+	"",
+	"A cat. A mat. A dog?",
+	"Sentences without final punctuation",
+	"  leading and trailing spaces   ",
+};
+
+// writes a small CoNLL-U corpus and trains a tokenizer-only model on it with the udpipe binary of the submodule
+static int32_t test_udpipe_train_model(char * const model_path, const size_t model_path_size){
+	const size_t bfr_size = 1024;
+	char bfr[bfr_size];
+	const size_t num_words = sizeof(test_udpipe_words) / sizeof(test_udpipe_words[0]);
+
+	if(system("mkdir -p " TEST_UDPIPE_DIRECTORY) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to create " TEST_UDPIPE_DIRECTORY);
+		return 1;
+	}
+	FILE * f = fopen(TEST_UDPIPE_DIRECTORY "/train.conllu", "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open training file"); return 1;}
+	for(int32_t s = 0 ; s < TEST_UDPIPE_NUM_TRAINING_SENTENCES ; s++){
+		const int32_t len = 3 + (s % 6);
+		for(int32_t w = 0 ; w < len ; w++){
+			const char * const form = test_udpipe_words[(s * 7 + w * 3) % num_words];
+			const int8_t before_punct = (w == len - 1);
+			fprintf(f, "%i\t%s\t_\t_\t_\t_\t%i\t%s\t_\t%s\n", w + 1, form, w == 0 ? 0 : 1, w == 0 ? "root" : "dep", before_punct ? "SpaceAfter=No" : "_");
+		}
+		fprintf(f, "%i\t%s\t_\t_\t_\t_\t1\tpunct\t_\t_\n\n", len + 1, s % 3 == 0 ? "!" : (s % 3 == 1 ? "." : "?"));
+	}
+	fclose(f);
+
+	snprintf(model_path, model_path_size, "%s", TEST_UDPIPE_DIRECTORY "/tokenizer.udpipe");
+	memset(bfr, '\0', bfr_size);
+	snprintf(bfr, bfr_size, "udpipe/src/udpipe --train --tokenizer='epochs=2;dimension=8' --tagger=none --parser=none %s %s > /dev/null 2>&1", model_path, TEST_UDPIPE_DIRECTORY "/train.conllu");
+	if(system(bfr) != 0){
+		memset(bfr, '\0', bfr_size);
+		snprintf(bfr, bfr_size, "failed to train UDPipe model (is udpipe/src/udpipe built?)");
+		error_format(__FILE__, __func__, __LINE__, bfr);
+		return 1;
+	}
+	return 0;
+}
+
+// tokens of the reference path: vertical output of the pipeline, one form per non-empty line
+static int32_t test_udpipe_compare_with_reference(const char * const text, const struct udpipe_tokens * const tokens, const size_t document){
+	FILE * f = NULL;
+	void * heap_char = NULL;
+	char line[1024];
+	size_t span = tokens->document_offsets[document];
+	int32_t result = 0;
+
+	if(udpipe_pipeline_process(text, &f, &heap_char) != 0 || f == NULL){
+		free(heap_char);
+		return 1;
+	}
+	while(fgets(line, 1024, f) != NULL){
+		size_t len = strlen(line);
+		if(len > 0 && line[len - 1] == '\n'){line[--len] = '\0';}
+		if(len == 0){continue;}
+		if(span >= tokens->document_offsets[document + 1]
+		|| tokens->spans[span].length != len
+		|| strcmp(tokens->arena + tokens->spans[span].offset, line) != 0){
+			result = 1;
+			break;
+		}
+		span++;
+	}
+	if(span != tokens->document_offsets[document + 1]){result = 1;}
+	fclose(f);
+	free(heap_char);
+	return result;
+}
+
+static void * test_udpipe_batch_thread(void * args){
+	const struct udpipe_tokens * const expected = (const struct udpipe_tokens *) args;
+	const size_t num_texts = sizeof(test_udpipe_texts) / sizeof(test_udpipe_texts[0]);
+	struct udpipe_tokens tokens;
+	void * result = NULL;
+
+	memset(&tokens, '\0', sizeof(struct udpipe_tokens));
+	for(int32_t round = 0 ; round < 50 ; round++){
+		if(udpipe_pool_process_batch(test_udpipe_texts, num_texts, &tokens) != 0
+		|| tokens.num_spans != expected->num_spans
+		|| tokens.arena_size != expected->arena_size
+		|| memcmp(tokens.arena, expected->arena, tokens.arena_size) != 0
+		|| memcmp(tokens.document_offsets, expected->document_offsets, (num_texts + 1) * sizeof(size_t)) != 0){
+			result = (void*) 1;
+			break;
+		}
+	}
+	udpipe_tokens_free(&tokens);
+	return result;
+}
+
+int32_t test_udpipe_pool_equivalence(void){
+	const size_t model_path_size = 512;
+	char model_path[model_path_size];
+	const size_t num_texts = sizeof(test_udpipe_texts) / sizeof(test_udpipe_texts[0]);
+	struct udpipe_tokens tokens;
+	int32_t result = 0;
+
+	if(test_udpipe_train_model(model_path, model_path_size) != 0){return 1;}
+
+	udpipe_pipeline_create_global(model_path, "tokenizer", "none", "none", "vertical");
+	if(udpipe_pool_create_global(model_path, TEST_UDPIPE_NUM_PIPELINES) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call udpipe_pool_create_global");
+		return 1;
+	}
+
+	memset(&tokens, '\0', sizeof(struct udpipe_tokens));
+	if(udpipe_pool_process_batch(test_udpipe_texts, num_texts, &tokens) != 0 || tokens.num_documents != num_texts){
+		error_format(__FILE__, __func__, __LINE__, "failed to call udpipe_pool_process_batch");
+		result = 1;
+		goto free_all;
+	}
+	for(size_t i = 0 ; i < num_texts ; i++){
+		if(test_udpipe_compare_with_reference(test_udpipe_texts[i], &tokens, i) != 0){
+			error_format(__FILE__, __func__, __LINE__, "batch tokens differ from pipeline output");
+			result = 1;
+			goto free_all;
+		}
+	}
+
+	// more threads than pipelines, so that slots are contended for
+	pthread_t threads[TEST_UDPIPE_NUM_THREADS];
+	for(int32_t i = 0 ; i < TEST_UDPIPE_NUM_THREADS ; i++){
+		if(pthread_create(&(threads[i]), NULL, test_udpipe_batch_thread, &tokens) != 0){
+			error_format(__FILE__, __func__, __LINE__, "failed to call pthread_create");
+			result = 1;
+			goto free_all;
+		}
+	}
+	for(int32_t i = 0 ; i < TEST_UDPIPE_NUM_THREADS ; i++){
+		void * thread_result = NULL;
+		pthread_join(threads[i], &thread_result);
+		if(thread_result != NULL){result = 1;}
+	}
+	if(result != 0){error_format(__FILE__, __func__, __LINE__, "concurrent batches differ from sequential batch");}
+
+	free_all:
+	udpipe_tokens_free(&tokens);
+	udpipe_pool_free_global();
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_udpipe_pool_equivalence: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_udpipe_pool_equivalence: FAIL");
+	}
+	return result;
+}
+#endif
+
+#endif
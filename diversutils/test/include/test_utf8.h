@@ -0,0 +1,205 @@
+#ifndef TEST_UTF8_H
+#define TEST_UTF8_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_general.h"
+#include "unicode/unicode.h"
+#include "unicode/utf8.h"
+
+#define TEST_UTF8_MAX_CODE_POINT 0x1fffff
+#define TEST_UTF8_TOKEN_BUFFER_SIZE 128 // utf8_normalise may read up to 64 bytes, plus a truncated sequence
+
+// utf8_normalise as it was before the tables, decoding every character and classifying it with the ranges
+static char * test_utf8_normalise_reference(char * const s){
+	int32_t count_number = 0;
+	int32_t count_punctuation = 0;
+	int32_t count_currency = 0;
+	int32_t count_emoticon = 0;
+	int8_t found_hyphen = 0;
+	int8_t found_non_hyphen = 0;
+	int8_t len;
+	int32_t index = 0;
+	while(index < 64 && s[index] != '\0'){
+		const unicode_t code = utf8_to_unicode(&s[index], &len);
+		if(len == -1){index++; continue;}
+		switch(unicode_to_subset_ranges(code)){
+			case UNICODE_NUMBER:
+				count_number++;
+				break;
+			case UNICODE_PUNCTUATION:
+				count_punctuation++;
+				if(len == 1){
+					if(s[index] == '-'){found_hyphen = 1;}
+					else {found_non_hyphen = 1;}
+				}
+				break;
+			case UNICODE_CURRENCY:
+				count_currency++;
+				break;
+			case UNICODE_EMOTICON:
+				count_emoticon++;
+				break;
+			default:
+				break;
+		}
+		index += len;
+	}
+	if(found_hyphen && !found_non_hyphen){return s;}
+	if(count_number >= 2){return "[NUMBER]";}
+	if(count_emoticon >= 1){return "[EMOTICON]";}
+	if(count_punctuation >= 2){return "[PUNCTUATION_GROUP]";}
+	if(count_currency >= 1){return "[CURRENCY]";}
+	return s;
+}
+
+static int32_t test_utf8_encode(const unicode_t code, char * const s){
+	if(code < 0x80){s[0] = (char) code; return 1;}
+	if(code < 0x800){s[0] = (char) (0xc0 | (code >> 6)); s[1] = (char) (0x80 | (code & 0x3f)); return 2;}
+	if(code < 0x10000){s[0] = (char) (0xe0 | (code >> 12)); s[1] = (char) (0x80 | ((code >> 6) & 0x3f)); s[2] = (char) (0x80 | (code & 0x3f)); return 3;}
+	s[0] = (char) (0xf0 | (code >> 18)); s[1] = (char) (0x80 | ((code >> 12) & 0x3f)); s[2] = (char) (0x80 | ((code >> 6) & 0x3f)); s[3] = (char) (0x80 | (code & 0x3f));
+	return 4;
+}
+
+static int32_t test_utf8_same_normalisation(char * const s){
+	char copy[TEST_UTF8_TOKEN_BUFFER_SIZE];
+	memcpy(copy, s, TEST_UTF8_TOKEN_BUFFER_SIZE);
+	const char * const expected = test_utf8_normalise_reference(copy);
+	const char * const obtained = utf8_normalise(s);
+	if(expected == copy){return obtained == s;}
+	return obtained != s && strcmp(expected, obtained) == 0;
+}
+
+int32_t test_utf8_exhaustive(void){
+	const size_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	int32_t result = 0;
+	int64_t num_subset_mismatches = 0;
+	int64_t num_normalise_mismatches = 0;
+	char token[TEST_UTF8_TOKEN_BUFFER_SIZE];
+
+	for(unicode_t code = 0 ; code <= TEST_UTF8_MAX_CODE_POINT ; code++){
+		if(unicode_to_subset(code) != unicode_to_subset_ranges(code)){num_subset_mismatches++;}
+
+		// the code point twice, so that two-occurrence thresholds are reached, then alone after a hyphen
+		memset(token, '\0', TEST_UTF8_TOKEN_BUFFER_SIZE);
+		int32_t len = test_utf8_encode(code, token);
+		test_utf8_encode(code, token + len);
+		if(code != 0 && !test_utf8_same_normalisation(token)){num_normalise_mismatches++;}
+		memset(token, '\0', TEST_UTF8_TOKEN_BUFFER_SIZE);
+		token[0] = '-';
+		test_utf8_encode(code, token + 1);
+		if(!test_utf8_same_normalisation(token)){num_normalise_mismatches++;}
+	}
+
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_subset_mismatches == 0 && num_normalise_mismatches == 0){
+		snprintf(log_bfr, log_bfr_size, "UTF-8 classification (all code points up to 0x%x): OK", TEST_UTF8_MAX_CODE_POINT);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "UTF-8 classification (all code points up to 0x%x): FAIL (%li subset mismatches, %li normalisation mismatches)", TEST_UTF8_MAX_CODE_POINT, num_subset_mismatches, num_normalise_mismatches);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	return result;
+}
+
+// fills a token with a mix of ASCII, code points around the classified ranges, and malformed bytes
+static void test_utf8_generate_token(uint32_t * const state, char * const token){
+	static const unicode_t interesting[] = {0x2d, 0x30, 0x39, 0x41, 0x61, 0x6a, 0x6b, 0x7e, 0xe9, 0x1d00, 0x1dbf, 0x1dc0, 0x2000, 0x20a0, 0x20ac, 0x20b9, 0x20ba, 0x2e00, 0x2e31, 0x2e32, 0x1f600, 0x1f601, 0x1f64f, 0x1f650};
+	const int32_t num_interesting = sizeof(interesting) / sizeof(unicode_t);
+	memset(token, '\0', TEST_UTF8_TOKEN_BUFFER_SIZE);
+	(*state) = (*state) * 1103515245u + 12345u;
+	const int32_t num_characters = 1 + (((*state) >> 16) % 24);
+	int32_t index = 0;
+	for(int32_t i = 0 ; i < num_characters && index < 72 ; i++){
+		(*state) = (*state) * 1103515245u + 12345u;
+		const uint32_t r = (*state) >> 8;
+		switch(r % 4){
+			case 0:
+				token[index++] = (char) (0x20 + ((r >> 4) % 0x5f));
+				break;
+			case 1:
+				index += test_utf8_encode(interesting[(r >> 4) % num_interesting], token + index);
+				break;
+			case 2:
+				index += test_utf8_encode((unicode_t) (((r >> 4) % TEST_UTF8_MAX_CODE_POINT) + 1), token + index);
+				break;
+			default:
+				token[index++] = (char) (0x80 + ((r >> 4) % 0x80)); // lone continuation or lead byte
+				break;
+		}
+	}
+}
+
+int32_t test_utf8_fuzz(void){
+	const size_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	int32_t result = 0;
+	const int32_t num_tokens = 1000000;
+	int32_t num_mismatches = 0;
+	char token[TEST_UTF8_TOKEN_BUFFER_SIZE];
+	uint32_t state = 1;
+
+	for(int32_t i = 0 ; i < num_tokens ; i++){
+		test_utf8_generate_token(&state, token);
+		if(!test_utf8_same_normalisation(token)){num_mismatches++;}
+	}
+
+	memset(log_bfr, '\0', log_bfr_size);
+	if(num_mismatches == 0){
+		snprintf(log_bfr, log_bfr_size, "UTF-8 normalisation (%i fuzzed tokens): OK", num_tokens);
+		info_format(__FILE__, __func__, __LINE__, log_bfr);
+	} else {
+		snprintf(log_bfr, log_bfr_size, "UTF-8 normalisation (%i fuzzed tokens): FAIL (%i mismatches)", num_tokens, num_mismatches);
+		error_format(__FILE__, __func__, __LINE__, log_bfr);
+		result = 1;
+	}
+
+	return result;
+}
+
+// benchmark rather than test: reports tokens per second for the reference and the table-driven normalisation
+int32_t test_utf8_throughput(void){
+	const size_t log_bfr_size = 256;
+	char log_bfr[log_bfr_size];
+	const int32_t num_tokens = 100000;
+	const int32_t num_repetitions = 20;
+	static const char * const words[] = {"le", "chat", "dort", "2024", "--", "...", "$", "canapé", "être", "€10", "à", "Ωmega"};
+	const int32_t num_words = sizeof(words) / sizeof(char*);
+
+	char (* const tokens)[TEST_UTF8_TOKEN_BUFFER_SIZE] = malloc(num_tokens * TEST_UTF8_TOKEN_BUFFER_SIZE);
+	if(tokens == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); return 1;}
+	for(int32_t i = 0 ; i < num_tokens ; i++){
+		memset(tokens[i], '\0', TEST_UTF8_TOKEN_BUFFER_SIZE);
+		memcpy(tokens[i], words[i % num_words], strlen(words[i % num_words]));
+	}
+
+	double elapsed[2] = {0.0, 0.0};
+	int64_t checksum = 0;
+	for(int32_t method = 0 ; method < 2 ; method++){
+		const clock_t start = clock();
+		for(int32_t r = 0 ; r < num_repetitions ; r++){
+			for(int32_t i = 0 ; i < num_tokens ; i++){
+				const char * const res = method == 0 ? test_utf8_normalise_reference(tokens[i]) : utf8_normalise(tokens[i]);
+				checksum += (res != tokens[i]);
+			}
+		}
+		elapsed[method] = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+	}
+
+	const double total = (double) num_tokens * num_repetitions;
+	memset(log_bfr, '\0', log_bfr_size);
+	snprintf(log_bfr, log_bfr_size, "UTF-8 normalisation throughput: reference %.0f tokens/s; tables %.0f tokens/s (checksum %li)", elapsed[0] > 0.0 ? total / elapsed[0] : 0.0, elapsed[1] > 0.0 ? total / elapsed[1] : 0.0, checksum);
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+	free(tokens);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef TEST_WORD2VEC_H
+#define TEST_WORD2VEC_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_general.h"
+#include "graph.h"
+
+#define TEST_WORD2VEC_PATH "/tmp/diversutils_test_word2vec.bin"
+#define TEST_WORD2VEC_NUM_VECTORS 5000
+#define TEST_WORD2VEC_NUM_DIMENSIONS 8
+#define TEST_WORD2VEC_NUM_THREADS 8
+#define TEST_WORD2VEC_NUM_ROUNDS 20
+
+#ifndef TEST_WORD2VEC_MEMORY_NUM_VECTORS
+#define TEST_WORD2VEC_MEMORY_NUM_VECTORS 2000000
+#endif
+#ifndef TEST_WORD2VEC_MEMORY_NUM_DIMENSIONS
+#define TEST_WORD2VEC_MEMORY_NUM_DIMENSIONS 300
+#endif
+
+// every 97th key is longer than WORD2VEC_KEY_BUFFER_SIZE, to exercise truncation
+static void test_word2vec_key(const uint32_t i, char * const key, const size_t key_size){
+	if(i % 97 == 0){
+		snprintf(key, key_size, "long_%07u_%0100u", i, 0);
+	} else {
+		snprintf(key, key_size, "w%u", i * 2654435761u);
+	}
+}
+
+static float test_word2vec_value(const uint32_t i, const uint32_t d){
+	return (float) (i % 1000) + ((float) d) / 16.0f;
+}
+
+static int32_t test_word2vec_write(const char * const path, const uint32_t num_vectors, const uint32_t num_dimensions){
+	char key[160];
+	float * const vector = malloc(num_dimensions * sizeof(float));
+	if(vector == NULL){error_format(__FILE__, __func__, __LINE__, "malloc failed"); return 1;}
+	FILE * const f = fopen(path, "w");
+	if(f == NULL){error_format(__FILE__, __func__, __LINE__, "failed to open synthetic word2vec file"); free(vector); return 1;}
+	fprintf(f, "%u %u\n", num_vectors, num_dimensions);
+	for(uint32_t i = 0 ; i < num_vectors ; i++){
+		test_word2vec_key(i, key, 160);
+		for(uint32_t d = 0 ; d < num_dimensions ; d++){vector[d] = test_word2vec_value(i, d);}
+		fprintf(f, "%s ", key);
+		fwrite(vector, sizeof(float), num_dimensions, f);
+		fputc('\n', f);
+	}
+	fclose(f);
+	free(vector);
+	return 0;
+}
+
+int32_t test_word2vec_load(void){
+	struct word2vec w2v;
+	char key[160];
+	int32_t result = 0;
+
+	if(test_word2vec_write(TEST_WORD2VEC_PATH, TEST_WORD2VEC_NUM_VECTORS, TEST_WORD2VEC_NUM_DIMENSIONS) != 0){return 1;}
+	if(load_word2vec_binary(&w2v, TEST_WORD2VEC_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call load_word2vec_binary");
+		return 1;
+	}
+
+	for(uint64_t i = 1 ; i < w2v.num_vectors && result == 0 ; i++){
+		if(strcmp(w2v.keys[i - 1].key, w2v.keys[i].key) >= 0){result = 1;}
+	}
+	for(uint32_t i = 0 ; i < TEST_WORD2VEC_NUM_VECTORS && result == 0 ; i++){
+		test_word2vec_key(i, key, 160);
+		key[WORD2VEC_KEY_BUFFER_SIZE - 1] = '\0';
+		const int32_t index = word2vec_key_to_index(&w2v, key);
+		if(index == -1 || strlen(w2v.keys[index].key) != strlen(key)){result = 1; break;}
+		for(uint32_t d = 0 ; d < TEST_WORD2VEC_NUM_DIMENSIONS ; d++){
+			if(w2v.keys[index].vector[d] != test_word2vec_value(i, d)){result = 1; break;}
+		}
+	}
+	if(word2vec_key_to_index(&w2v, "~~~ after every key") != -1 || word2vec_key_to_index(&w2v, "") != -1){result = 1;}
+
+	free_word2vec(&w2v);
+	remove(TEST_WORD2VEC_PATH);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_word2vec_load: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_word2vec_load: FAIL");
+	}
+	return result;
+}
+
+struct test_word2vec_thread_args {
+	struct graph* g;
+	struct word2vec* w2v;
+	uint32_t offset;
+};
+
+// all threads add every key TEST_WORD2VEC_NUM_ROUNDS times, each starting at a different key so that first sightings collide
+static void * test_word2vec_occurrence_thread(void * args){
+	const struct test_word2vec_thread_args * const a = (const struct test_word2vec_thread_args *) args;
+	for(uint32_t r = 0 ; r < TEST_WORD2VEC_NUM_ROUNDS ; r++){
+		for(uint64_t k = 0 ; k < a->w2v->num_vectors ; k++){
+			const uint64_t index = (k + a->offset) % a->w2v->num_vectors;
+			if(graph_add_word2vec_occurrence(a->g, a->w2v, &(a->w2v->keys[index])) != 0){return (void*) 1;}
+			__atomic_fetch_add(&(a->w2v->keys[index].num_occurrences), 1, __ATOMIC_RELAXED);
+		}
+	}
+	return NULL;
+}
+
+int32_t test_word2vec_concurrent_occurrences(void){
+	struct word2vec w2v;
+	struct graph g;
+	struct test_word2vec_thread_args args[TEST_WORD2VEC_NUM_THREADS];
+	pthread_t threads[TEST_WORD2VEC_NUM_THREADS];
+	int32_t result = 0;
+
+	if(test_word2vec_write(TEST_WORD2VEC_PATH, TEST_WORD2VEC_NUM_VECTORS, TEST_WORD2VEC_NUM_DIMENSIONS) != 0){return 1;}
+	if(load_word2vec_binary(&w2v, TEST_WORD2VEC_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call load_word2vec_binary");
+		return 1;
+	}
+	remove(TEST_WORD2VEC_PATH);
+	if(create_graph_empty(&g) != 0 || graph_bind_word2vec(&g, &w2v) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call create_graph_empty");
+		free_word2vec(&w2v);
+		return 1;
+	}
+
+	for(int32_t i = 0 ; i < TEST_WORD2VEC_NUM_THREADS ; i++){
+		args[i] = (struct test_word2vec_thread_args) { .g = &g, .w2v = &w2v, .offset = (uint32_t) i * 7, };
+		pthread_create(&(threads[i]), NULL, test_word2vec_occurrence_thread, &(args[i]));
+	}
+	for(int32_t i = 0 ; i < TEST_WORD2VEC_NUM_THREADS ; i++){
+		void * thread_result = NULL;
+		pthread_join(threads[i], &thread_result);
+		if(thread_result != NULL){result = 1;}
+	}
+
+	// exactly one node per key, holding every occurrence
+	const uint32_t expected = TEST_WORD2VEC_NUM_THREADS * TEST_WORD2VEC_NUM_ROUNDS;
+	if(graph_num_nodes(&g) != w2v.num_vectors){result = 1;}
+	for(uint64_t i = 0 ; i < w2v.num_vectors && result == 0 ; i++){
+		const struct word2vec_entry * const entry = &(w2v.keys[i]);
+		const struct graph_node * const node = graph_word2vec_node(&g, &w2v, entry);
+		if(node == NULL || node != graph_node_at(&g, g.word2vec_slots[i].node_index) || node->word2vec_entry_pointer != entry || node->vector.fp32 != entry->vector || node->absolute_proportion != expected || entry->num_occurrences != expected){
+			result = 1;
+		}
+	}
+
+	free_graph(&g);
+	free_word2vec(&w2v);
+
+	if(result == 0){
+		info_format(__FILE__, __func__, __LINE__, "test_word2vec_concurrent_occurrences: OK");
+	} else {
+		error_format(__FILE__, __func__, __LINE__, "test_word2vec_concurrent_occurrences: FAIL");
+	}
+	return result;
+}
+
+static int64_t test_word2vec_rss(void){
+	long num_pages = 0;
+	long num_resident_pages = 0;
+	FILE * const f = fopen("/proc/self/statm", "r");
+	if(f == NULL){return -1;}
+	if(fscanf(f, "%ld %ld", &num_pages, &num_resident_pages) != 2){num_resident_pages = -1;}
+	fclose(f);
+	const long page_size = sysconf(_SC_PAGESIZE);
+	return num_resident_pages < 0 || page_size <= 0 ? -1 : ((int64_t) num_resident_pages) * ((int64_t) page_size);
+}
+
+// benchmark: resident memory spent on a synthetic model beyond the vectors themselves
+int32_t test_word2vec_memory(void){
+	const size_t log_bfr_size = 512;
+	char log_bfr[log_bfr_size];
+	struct word2vec w2v;
+	struct graph g;
+
+	if(test_word2vec_write(TEST_WORD2VEC_PATH, TEST_WORD2VEC_MEMORY_NUM_VECTORS, TEST_WORD2VEC_MEMORY_NUM_DIMENSIONS) != 0){return 1;}
+	const int64_t rss_before = test_word2vec_rss();
+	if(load_word2vec_binary(&w2v, TEST_WORD2VEC_PATH) != 0){
+		error_format(__FILE__, __func__, __LINE__, "failed to call load_word2vec_binary");
+		remove(TEST_WORD2VEC_PATH);
+		return 1;
+	}
+	remove(TEST_WORD2VEC_PATH);
+	const int64_t rss_loaded = test_word2vec_rss();
+
+	// every key in the graph once, as after a large corpus
+	if(create_graph_empty(&g) != 0){free_word2vec(&w2v); return 1;}
+	if(graph_bind_word2vec(&g, &w2v) != 0){free_graph(&g); free_word2vec(&w2v); return 1;}
+	for(uint64_t i = 0 ; i < w2v.num_vectors ; i++){
+		if(graph_add_word2vec_occurrence(&g, &w2v, &(w2v.keys[i])) != 0){free_graph(&g); free_word2vec(&w2v); return 1;}
+	}
+	const int64_t rss_graph = test_word2vec_rss();
+
+	const int64_t vectors_size = ((int64_t) TEST_WORD2VEC_MEMORY_NUM_VECTORS) * TEST_WORD2VEC_MEMORY_NUM_DIMENSIONS * sizeof(float);
+	memset(log_bfr, '\0', log_bfr_size);
+	snprintf(log_bfr, log_bfr_size, "%u x %u model: vectors %.1f MB; RSS before %.1f MB, after loading %.1f MB (%.1f bytes per key beyond vectors; sizeof(struct word2vec_entry) = %zu, key blob %.1f MB), after filling the graph %.1f MB (%.1f bytes per node; sizeof(struct graph_node) = %zu)",
+		TEST_WORD2VEC_MEMORY_NUM_VECTORS, TEST_WORD2VEC_MEMORY_NUM_DIMENSIONS, vectors_size / 1.0e6,
+		rss_before / 1.0e6, rss_loaded / 1.0e6, ((double) (rss_loaded - rss_before - vectors_size)) / TEST_WORD2VEC_MEMORY_NUM_VECTORS, sizeof(struct word2vec_entry), w2v.key_blob_size / 1.0e6,
+		rss_graph / 1.0e6, ((double) (rss_graph - rss_loaded)) / TEST_WORD2VEC_MEMORY_NUM_VECTORS, sizeof(struct graph_node));
+	info_format(__FILE__, __func__, __LINE__, log_bfr);
+
+	free_graph(&g);
+	free_word2vec(&w2v);
+
+	if(rss_before < 0 || rss_loaded < 0 || rss_graph < 0){
+		error_format(__FILE__, __func__, __LINE__, "test_word2vec_memory: FAIL (cannot read /proc/self/statm)");
+		return 1;
+	}
+	info_format(__FILE__, __func__, __LINE__, "test_word2vec_memory: OK");
+	return 0;
+}
+
+#endif
@@ -1,18 +1,57 @@
+#ifndef _GNU_SOURCE
+// for syscall, used by test_instrument.h
+#define _GNU_SOURCE
+#endif
+
 #include <stdint.h>
 #include <stdlib.h>
 
 #include "test_general.h"
 #include "test_graph.h"
+#include "test_word2vec.h"
 #include "test_entropy.h"
 #include "test_equivalence.h"
+#include "test_oov.h"
+#include "test_filter.h"
+#include "test_utf8.h"
+#include "test_udpipe.h"
+#include "test_coprocess.h"
+#include "test_recompute.h"
+#include "test_file_queue.h"
+#include "test_schedule.h"
+#include "test_memo.h"
+#include "test_output.h"
+#include "test_instrument.h"
+#include "test_checkpoint.h"
+#include "test_batch.h"
+#include "test_shard.h"
+#include "test_serve.h"
 
 #ifdef TEST_ALL
 #define TEST_GRAPH_RELATIVE_PROPORTION
+#define TEST_GRAPH_CONCURRENT_APPEND
+#define TEST_GRAPH_APPEND_NODES
+#define TEST_GRAPH_SNAPSHOT
+#define TEST_RECOMPUTE
+#define TEST_FILE_QUEUE
+#define TEST_SCHEDULE
+#define TEST_WORD2VEC
 #define TEST_ENTROPY_SHANNON_WEAVER
 #define TEST_ENTROPY_RENYI
 #define TEST_ENTROPY_PATIL_TAILLIE
 #define TEST_ENTROPY_Q_LOGARITHMIC
 #define TEST_EQUIVALENCE_ENTROPY
+#define TEST_MEMO
+#define TEST_OUTPUT
+#define TEST_INSTRUMENT
+#define TEST_CHECKPOINT
+#define TEST_BATCH
+#define TEST_SHARD
+#define TEST_SERVE
+#define TEST_OOV_COUNTER
+#define TEST_FILTER
+#define TEST_UTF8
+#define TEST_COPROCESS
 #endif
 
 static int32_t num_calls_info;
@@ -23,6 +62,37 @@ struct test_case cases[] = {
 	#ifdef TEST_GRAPH_RELATIVE_PROPORTION
 	{test_compute_graph_relative_proportions, 0},
 	#endif
+	#ifdef TEST_GRAPH_CONCURRENT_APPEND
+	{test_graph_concurrent_append, 0},
+	#endif
+	#ifdef TEST_GRAPH_APPEND_NODES
+	{test_graph_append_nodes, 0},
+	#endif
+	#ifdef TEST_GRAPH_SNAPSHOT
+	{test_graph_snapshot, 0},
+	#endif
+	#if defined(TEST_RECOMPUTE) && TOKENIZATION_METHOD == 0
+	{test_recompute_matches_blocking, 0},
+	#endif
+	#ifdef TEST_FILE_QUEUE
+	{test_file_queue_largest_first, 0},
+	#endif
+	#if defined(TEST_FILE_QUEUE) && TOKENIZATION_METHOD == 0
+	{test_file_queue_matches_list_order, 0},
+	#endif
+	#ifdef TEST_SCHEDULE
+	{test_schedule_cost_model, 0},
+	{test_schedule_boundaries, 0},
+	{test_schedule_log_spacing, 0},
+	{test_schedule_deterministic, 0},
+	#endif
+	#ifdef TEST_WORD2VEC
+	{test_word2vec_load, 0},
+	{test_word2vec_concurrent_occurrences, 0},
+	#endif
+	#ifdef TEST_WORD2VEC_MEMORY
+	{test_word2vec_memory, 1},
+	#endif
 	#ifdef TEST_ENTROPY_SHANNON_WEAVER
 	{test_shannon_weaver_entropy, 0},
 	#endif
@@ -38,6 +108,49 @@ struct test_case cases[] = {
 	#ifdef TEST_EQUIVALENCE_ENTROPY
 	{test_equivalence_entropy, 0},
 	#endif
+	#ifdef TEST_MEMO
+	{test_dfunctions_memo, 0},
+	#endif
+	#ifdef TEST_OUTPUT
+	{test_output_columnar, 0},
+	#endif
+	#ifdef TEST_INSTRUMENT
+	{test_instrument_spans, 0},
+	#endif
+	#ifdef TEST_CHECKPOINT
+	{test_checkpoint_resume, 0},
+	#endif
+	#ifdef TEST_BATCH
+	{test_batch_matches_standalone, 0},
+	#endif
+	#ifdef TEST_SHARD
+	{test_shard_merge_matches_direct, 0},
+	#endif
+	#if defined(TEST_SERVE) && TOKENIZATION_METHOD == 0
+	{test_serve_jobs, 0},
+	{test_serve_measurement, 0},
+	#endif
+	#ifdef TEST_OOV_COUNTER
+	{test_oov_counter_exact, 0},
+	{test_oov_counter_approximate, 0},
+	#endif
+	#if defined(TEST_FILTER) && ENABLE_FILTER == 1
+	{test_filter_equivalence, 0},
+	{test_filter_throughput, 1},
+	#endif
+	#ifdef TEST_UTF8
+	{test_utf8_exhaustive, 0},
+	{test_utf8_fuzz, 0},
+	{test_utf8_throughput, 1},
+	#endif
+	#if defined(TEST_UDPIPE) && TOKENIZATION_METHOD == 2
+	{test_udpipe_pool_equivalence, 0},
+	#endif
+	#ifdef TEST_COPROCESS
+	{test_coprocess_pool, 0},
+	{test_coprocess_restart, 0},
+	{test_coprocess_large_document, 0},
+	#endif
 };
 
 int32_t main(void){
@@ -0,0 +1,86 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Stand-in for "udpipe --tokenize --immediate --output=conllu", used by test_coprocess.h.
+ * Paragraphs are separated by blank lines; tokens are separated by whitespace, trailing .,!?;: are split off and "du" is expanded to the words "de" and "le".
+ * Words are written as soon as their line has been read; a paragraph is flushed when it ends.
+ * --crash-after=N makes the process die in the middle of its N-th word.
+ */
+
+static int64_t num_words_written;
+static int64_t crash_after = -1;
+static int32_t word_id;
+
+static void mock_tokenizer_word(const char * const form, const size_t form_size){
+	word_id++;
+	num_words_written++;
+	if(num_words_written == crash_after){
+		printf("%i\t%.*s", word_id, (int) (form_size / 2), form);
+		fflush(stdout);
+		_exit(1);
+	}
+	printf("%i\t%.*s\t_\t_\t_\t_\t%i\t%s\t_\t_\n", word_id, (int) form_size, form, word_id == 1 ? 0 : 1, word_id == 1 ? "root" : "dep");
+}
+
+static void mock_tokenizer_chunk(const char * const chunk, size_t chunk_size){
+	size_t num_punct = 0;
+	while(num_punct < chunk_size && strchr(".,!?;:", chunk[chunk_size - num_punct - 1]) != NULL){num_punct++;}
+	if(num_punct == chunk_size){num_punct--;} // a chunk made only of punctuation keeps its first character as a word
+	const size_t stem_size = chunk_size - num_punct;
+	if(stem_size == 2 && memcmp(chunk, "du", 2) == 0){
+		printf("%i-%i\tdu\t_\t_\t_\t_\t_\t_\t_\t_\n", word_id + 1, word_id + 2);
+		mock_tokenizer_word("de", 2);
+		mock_tokenizer_word("le", 2);
+	} else {
+		mock_tokenizer_word(chunk, stem_size);
+	}
+	for(size_t i = stem_size ; i < chunk_size ; i++){
+		mock_tokenizer_word(chunk + i, 1);
+	}
+}
+
+int main(int argc, char ** argv){
+	for(int i = 1 ; i < argc ; i++){
+		if(strncmp(argv[i], "--crash-after=", 14) == 0){crash_after = strtol(argv[i] + 14, NULL, 10);}
+	}
+
+	char * line = NULL;
+	size_t line_capacity = 0;
+	ssize_t line_size;
+	int8_t in_paragraph = 0;
+	while((line_size = getline(&line, &line_capacity, stdin)) != -1){
+		ssize_t start = 0;
+		int8_t blank = 1;
+		for(ssize_t i = 0 ; i <= line_size ; i++){
+			if(i == line_size || line[i] == ' ' || line[i] == '\t' || line[i] == '\n' || line[i] == '\r'){
+				if(i > start){
+					if(!in_paragraph){
+						printf("# sent_id = %lli\n", (long long) num_words_written);
+						in_paragraph = 1;
+						word_id = 0;
+					}
+					mock_tokenizer_chunk(line + start, (size_t) (i - start));
+					blank = 0;
+				}
+				start = i + 1;
+			}
+		}
+		if(blank && in_paragraph){
+			printf("\n");
+			fflush(stdout);
+			in_paragraph = 0;
+		}
+	}
+	if(in_paragraph){printf("\n");}
+	fflush(stdout);
+	free(line);
+	return 0;
+}
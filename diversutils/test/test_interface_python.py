@@ -64,3 +64,512 @@ def test_disparity_not_nan():
     assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
     assert (diversutils.free_w2v(w2v_index) == 0), "failed to free w2v"
 """
+
+import gc
+import weakref
+import numpy as np
+import pytest
+import json
+
+def test_add_node_vector_buffer_is_held():
+    g_index = diversutils.create_empty_graph(0, 4)
+    vector = np.arange(4, dtype=np.float32)
+    ref = weakref.ref(vector)
+    assert (diversutils.add_node(g_index, 3, vector) == 0), "failed to add node from a buffer"
+    del vector
+    gc.collect()
+    assert (ref() is not None), "vector released while the graph still points into it"
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+    gc.collect()
+    assert (ref() is None), "vector still held after free_graph"
+
+def test_add_node_vector_errors():
+    g_index = diversutils.create_empty_graph(0, 4)
+    with pytest.raises(BufferError):
+        diversutils.add_node(g_index, 1, np.zeros((2, 4), dtype=np.float32)[:, 0])
+    with pytest.raises(BufferError):
+        diversutils.add_node(g_index, 1, np.zeros(4, dtype=np.float64))
+    with pytest.raises(BufferError):
+        diversutils.add_node(g_index, 1, np.zeros(3, dtype=np.float32))
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_set_counts():
+    g_index = diversutils.create_empty_graph(0, 0)
+    for _ in range(3):
+        assert (diversutils.add_node(g_index, 1) == 0), "failed to add node"
+    for dtype in (np.int32, np.uint32, np.int64, np.uint16):
+        assert (diversutils.set_counts(g_index, np.array([1, 1, 2], dtype=dtype)) == 0), f"failed to set counts from {dtype}"
+    assert (diversutils.compute_relative_proportion(g_index) == 0), "failed to compute relative frequencies"
+    assert (np.array_equal(diversutils.node_proportions(g_index), [0.25, 0.25, 0.5])), "proportions do not follow the counts"
+    with pytest.raises(ValueError):
+        diversutils.set_counts(g_index, np.array([1, -1, 2], dtype=np.int64))
+    with pytest.raises(BufferError):
+        diversutils.set_counts(g_index, np.array([1.0, 1.0, 2.0]))
+    with pytest.raises(BufferError):
+        diversutils.set_counts(g_index, np.array([1, 1], dtype=np.int32))
+    with pytest.raises(BufferError):
+        diversutils.set_counts(g_index, np.arange(6, dtype=np.int32)[::2])
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_node_proportions_view_aliases_graph():
+    g_index = diversutils.create_empty_graph(0, 0)
+    assert (diversutils.add_node(g_index, 1) == 0), "failed to add node"
+    assert (diversutils.add_node(g_index, 3) == 0), "failed to add node"
+    view = diversutils.node_proportions(g_index)
+    assert (not view.flags.writeable), "proportion view is writeable"
+    assert (view.dtype == np.float64 and np.array_equal(view, [0.25, 0.75])), "unexpected proportion view"
+    with pytest.raises(ValueError):
+        view[0] = 1.0
+    # recomputing writes into the memory the view shows
+    assert (diversutils.set_counts(g_index, np.array([3, 1], dtype=np.int32)) == 0), "failed to set counts"
+    assert (diversutils.compute_relative_proportion(g_index) == 0), "failed to compute relative frequencies"
+    assert (np.array_equal(view, [0.75, 0.25])), "view does not alias the graph"
+    assert (np.shares_memory(view, diversutils.node_proportions(g_index))), "two views of a graph do not share memory"
+
+def test_views_pin_graph():
+    g_index = diversutils.create_empty_graph(0, 0)
+    assert (diversutils.add_node(g_index, 1) == 0), "failed to add node"
+    view = diversutils.node_proportions(g_index)
+    derived = view[:1]
+    del view
+    gc.collect()
+    with pytest.raises(BufferError):
+        diversutils.add_node(g_index, 1)
+    with pytest.raises(BufferError):
+        diversutils.free_graph(g_index)
+    del derived
+    gc.collect()
+    assert (diversutils.add_node(g_index, 1) == 0), "graph still pinned after its views died"
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+    with pytest.raises(Exception):
+        diversutils.node_proportions(g_index)
+
+def test_distance_matrix_zero_copy():
+    g_index = diversutils.create_empty_graph(0, 0)
+    for _ in range(3):
+        assert (diversutils.add_node(g_index, 2) == 0), "failed to add node"
+    assert (diversutils.compute_relative_proportion(g_index) == 0), "failed to compute relative frequencies"
+    for dtype in (np.float32, np.float64):
+        matrix = np.array([[0.0, 1.0, 1.0], [1.0, 0.0, 1.0], [1.0, 1.0, 0.0]], dtype=dtype)
+        ref = weakref.ref(matrix)
+        diversutils.attach_distance_matrix(g_index, matrix)
+        view = diversutils.distance_matrix(g_index)
+        assert (view.dtype == dtype and not view.flags.writeable), "unexpected distance matrix view"
+        assert (np.shares_memory(view, matrix)), "distance matrix was copied"
+        pairwise = diversutils.individual_measure(g_index, diversutils.DF_DISPARITY_PAIRWISE)[0]
+        # the graph reads the caller's array in place
+        matrix *= 2.0
+        assert (view[0, 1] == 2.0), "view does not alias the attached matrix"
+        assert (math.isclose(diversutils.individual_measure(g_index, diversutils.DF_DISPARITY_PAIRWISE)[0], 2.0 * pairwise)), "measure does not see the attached matrix"
+        with pytest.raises(BufferError):
+            diversutils.attach_distance_matrix(g_index, matrix)
+        del view, matrix
+        gc.collect()
+        assert (ref() is not None), "matrix released while attached"
+    diversutils.attach_distance_matrix(g_index, np.zeros((3, 3), dtype=np.float32))
+    gc.collect()
+    assert (ref() is None), "matrix still held after being replaced"
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_distance_matrix_errors():
+    g_index = diversutils.create_empty_graph(0, 0)
+    for _ in range(3):
+        assert (diversutils.add_node(g_index, 2) == 0), "failed to add node"
+    with pytest.raises(Exception):
+        diversutils.distance_matrix(g_index)
+    with pytest.raises(BufferError):
+        diversutils.attach_distance_matrix(g_index, np.zeros((3, 6), dtype=np.float32)[:, ::2])
+    with pytest.raises(BufferError):
+        diversutils.attach_distance_matrix(g_index, np.asfortranarray(np.arange(9, dtype=np.float32).reshape(3, 3)))
+    with pytest.raises(BufferError):
+        diversutils.attach_distance_matrix(g_index, np.zeros((2, 2), dtype=np.float32))
+    with pytest.raises(BufferError):
+        diversutils._attach_distance_matrix(g_index, np.zeros((3, 3), dtype=np.int32))
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_add_nodes_matches_add_node():
+    rng = np.random.default_rng(0)
+    counts = rng.integers(1, 50, size=200)
+    vectors = rng.standard_normal((200, 8)).astype(np.float32)
+    g_bulk = diversutils.create_empty_graph(0, 8)
+    g_loop = diversutils.create_empty_graph(0, 8)
+    assert (diversutils.add_nodes(g_bulk, vectors[:1], counts[:1]) == 0), "first bulk node not at index 0"
+    assert (diversutils.add_nodes(g_bulk, vectors[1:], counts[1:]) == 1), "second batch not appended after the first"
+    for i in range(200):
+        assert (diversutils.add_node(g_loop, int(counts[i]), vectors[i]) == 0), "failed to add node"
+    assert (np.array_equal(diversutils.node_proportions(g_bulk), diversutils.node_proportions(g_loop))), "bulk and loop proportions differ"
+    for g_index in (g_bulk, g_loop):
+        assert (diversutils.compute_relative_proportion(g_index) == 0), "failed to compute relative frequencies"
+    assert (diversutils.individual_measure(g_bulk, diversutils.DF_ENTROPY_SHANNON_WEAVER) == diversutils.individual_measure(g_loop, diversutils.DF_ENTROPY_SHANNON_WEAVER)), "bulk and loop entropies differ"
+    gc.collect()
+    assert (diversutils.free_graph(g_bulk) == 0 and diversutils.free_graph(g_loop) == 0), "failed to free graph"
+
+def test_add_nodes_errors_leave_graph_unchanged():
+    g_index = diversutils.create_empty_graph(0, 4)
+    vectors = np.zeros((3, 4), dtype=np.float32)
+    with pytest.raises(ValueError):
+        diversutils.add_nodes(g_index, vectors, [1, -2, 3])
+    with pytest.raises(BufferError):
+        diversutils.add_nodes(g_index, vectors, [1, 2])
+    with pytest.raises(BufferError):
+        diversutils.add_nodes(g_index, np.zeros((3, 8), dtype=np.float32)[:, ::2], [1, 2, 3])
+    with pytest.raises(BufferError):
+        diversutils.add_nodes(g_index, vectors.astype(np.float64), [1, 2, 3])
+    with pytest.raises(Exception):
+        diversutils.add_nodes(g_index, None, [1, 2, 3], ["a", "b", "c"])
+    assert (len(diversutils.node_proportions(g_index)) == 0), "failed call added nodes"
+    gc.collect()
+    assert (diversutils.add_nodes(g_index, None, np.array([], dtype=np.int32)) == 0), "empty batch failed"
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_update_counts():
+    g_index = diversutils.create_empty_graph(0, 0)
+    diversutils.add_nodes(g_index, None, [1, 1, 1, 1])
+    assert (diversutils.update_counts(g_index, [0, 3, 3], [2, 1, 1]) == 0), "failed to update counts"
+    with pytest.raises(ValueError):
+        diversutils.update_counts(g_index, [1, 2, 1], [5, 1, -7])
+    with pytest.raises(IndexError):
+        diversutils.update_counts(g_index, [1, 4], [1, 1])
+    with pytest.raises(ValueError):
+        diversutils.update_counts(g_index, [1], [1, 1])
+    assert (diversutils.compute_relative_proportion(g_index) == 0), "failed to compute relative frequencies"
+    assert (np.array_equal(diversutils.node_proportions(g_index), [3 / 8, 1 / 8, 1 / 8, 3 / 8])), "failed updates were not undone"
+    gc.collect()
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_counts_beyond_32_bits():
+    g_index = diversutils.create_empty_graph(0, 0)
+    diversutils.add_nodes(g_index, None, np.array([2 ** 33, 2 ** 32], dtype=np.int64))
+    assert (diversutils.update_counts(g_index, [1], [2 ** 32]) == 0), "failed to update counts"
+    diversutils.add_node(g_index, 2 ** 34)
+    assert (diversutils.compute_relative_proportion(g_index) == 0), "failed to compute relative frequencies"
+    assert (np.array_equal(diversutils.node_proportions(g_index), [1 / 4, 1 / 4, 1 / 2])), "counts were truncated to 32 bits"
+    with pytest.raises(ValueError):
+        diversutils.update_counts(g_index, [2], [2 ** 63 - 2 ** 34])
+    gc.collect()
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_measures_follow_count_changes():
+    def entropy(counts):
+        return -sum(c / sum(counts) * math.log(c / sum(counts)) for c in counts)
+    g_index = diversutils.create_empty_graph(0, 0)
+    diversutils.add_nodes(g_index, None, [1, 1, 1])
+    assert (math.isclose(diversutils.individual_measure(g_index, diversutils.DF_ENTROPY_SHANNON_WEAVER)[0], entropy([1, 1, 1]))), "unexpected entropy"
+    # neither call changes the number of nodes, and no compute_relative_proportion comes in between
+    diversutils.update_counts(g_index, [0], [100])
+    assert (math.isclose(diversutils.individual_measure(g_index, diversutils.DF_ENTROPY_SHANNON_WEAVER)[0], entropy([101, 1, 1]))), "measure ignores update_counts"
+    assert (np.allclose(diversutils.node_proportions(g_index), [101 / 103, 1 / 103, 1 / 103])), "proportions ignore update_counts"
+    diversutils.set_counts(g_index, np.array([1, 2, 3], dtype=np.int32))
+    assert (math.isclose(diversutils.measure_many(g_index, [diversutils.DF_ENTROPY_SHANNON_WEAVER])[0][0], entropy([1, 2, 3]))), "measure ignores set_counts"
+    gc.collect()
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+# benchmark rather than test: reports the time of one add_nodes call against a loop of add_node
+def test_add_nodes_benchmark():
+    import time
+    num_nodes, num_dimensions = 100000, 16
+    rng = np.random.default_rng(0)
+    counts = rng.integers(1, 100, size=num_nodes, dtype=np.int64)
+    vectors = rng.standard_normal((num_nodes, num_dimensions)).astype(np.float32)
+
+    g_loop = diversutils.create_empty_graph(0, num_dimensions)
+    start = time.perf_counter()
+    for i in range(num_nodes):
+        diversutils.add_node(g_loop, int(counts[i]), vectors[i])
+    time_loop = time.perf_counter() - start
+
+    g_bulk = diversutils.create_empty_graph(0, num_dimensions)
+    start = time.perf_counter()
+    diversutils.add_nodes(g_bulk, vectors, counts)
+    time_bulk = time.perf_counter() - start
+
+    print(f"{num_nodes} nodes: add_node loop {time_loop:.4f} s; add_nodes {time_bulk:.4f} s; speedup {time_loop / time_bulk:.1f}x")
+    assert (time_bulk < time_loop), "add_nodes slower than a loop of add_node"
+    assert (diversutils.free_graph(g_loop) == 0 and diversutils.free_graph(g_bulk) == 0), "failed to free graph"
+
+def _random_graph(seed, num_nodes, num_dimensions):
+    rng = np.random.default_rng(seed)
+    g_index = diversutils.create_empty_graph(0, num_dimensions)
+    # non-negative components keep cosine distances within [0, 1], which Ricotta-Szeidl requires
+    vectors = rng.random((num_nodes, num_dimensions), dtype=np.float32)
+    diversutils.add_nodes(g_index, vectors, rng.integers(1, 100, size=num_nodes))
+    return g_index, vectors
+
+_CONCURRENT_FUNCTIONS = ("DF_ENTROPY_SHANNON_WEAVER", "DF_ENTROPY_RENYI", "DF_INDEX_SIMPSON", "DF_INDEX_E_PRIME_CAMARGO1993", "DF_DISPARITY_PAIRWISE", "DF_DISPARITY_STIRLING", "DF_DISPARITY_AGG_MST")
+
+def _measure_all(g_index, num_threads=1):
+    diversutils.compute_relative_proportion(g_index, num_threads=num_threads)
+    return [v for f in _CONCURRENT_FUNCTIONS for v in diversutils.individual_measure(g_index, getattr(diversutils, f), alpha=2.0, num_threads=num_threads)]
+
+def test_measures_concurrent_graphs():
+    from concurrent.futures import ThreadPoolExecutor
+    graphs = [_random_graph(seed, 200, 16)[0] for seed in range(8)]
+    serial = [_measure_all(g_index) for g_index in graphs]
+    # a second round reads the matrices and MSTs computed by the first one
+    for _ in range(2):
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            concurrent = list(pool.map(lambda g_index: _measure_all(g_index, num_threads=2), graphs))
+        for s, c in zip(serial, concurrent):
+            assert (np.allclose(s, c, rtol=1e-9)), "concurrent measures differ from serial ones"
+    for g_index in graphs:
+        assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def test_measures_concurrent_with_growth():
+    from concurrent.futures import ThreadPoolExecutor
+    rng = np.random.default_rng(1)
+    num_batches, batch_size, num_dimensions = 10, 20, 8
+    vectors = rng.standard_normal((num_batches * batch_size, num_dimensions)).astype(np.float32)
+    counts = rng.integers(1, 100, size=num_batches * batch_size)
+    g_index = diversutils.create_empty_graph(0, num_dimensions)
+    diversutils.add_nodes(g_index, vectors[:batch_size], counts[:batch_size])
+
+    def grow():
+        for b in range(1, num_batches):
+            diversutils.add_nodes(g_index, vectors[b * batch_size:(b + 1) * batch_size], counts[b * batch_size:(b + 1) * batch_size])
+
+    def measure():
+        for _ in range(10):
+            assert (not any(math.isnan(v) for v in _measure_all(g_index, num_threads=2))), "nan measured while the graph grew"
+
+    with ThreadPoolExecutor(max_workers=3) as pool:
+        futures = [pool.submit(grow), pool.submit(measure), pool.submit(measure)]
+        for future in futures:
+            future.result()
+
+    g_serial = diversutils.create_empty_graph(0, num_dimensions)
+    diversutils.add_nodes(g_serial, vectors, counts)
+    assert (np.allclose(_measure_all(g_index), _measure_all(g_serial), rtol=1e-9)), "graph grown under concurrent measures differs from a serial one"
+    assert (diversutils.free_graph(g_index) == 0 and diversutils.free_graph(g_serial) == 0), "failed to free graph"
+
+def test_individual_measure_keywords():
+    g_index, vectors = _random_graph(2, 10, 4)
+    diversutils.compute_relative_proportion(g_index)
+    assert (diversutils.individual_measure(graph_index=g_index, function=diversutils.DF_ENTROPY_RENYI, alpha=2.0) == diversutils.individual_measure(g_index, diversutils.DF_ENTROPY_RENYI, 2.0)), "keywords and positions differ"
+    with pytest.raises(ValueError):
+        diversutils.individual_measure(g_index, diversutils.DF_ENTROPY_RENYI, num_threads=0)
+    with pytest.raises(ValueError):
+        diversutils.compute_relative_proportion(g_index, num_threads=-1)
+    g_no_vectors = diversutils.create_empty_graph(0, 4)
+    diversutils.add_nodes(g_no_vectors, None, [1, 2])
+    with pytest.raises(Exception):
+        diversutils.individual_measure(g_no_vectors, diversutils.DF_DISPARITY_PAIRWISE)
+    assert (diversutils.free_graph(g_index) == 0 and diversutils.free_graph(g_no_vectors) == 0), "failed to free graph"
+
+def test_measure_many_matches_individual_measure():
+    ids = [getattr(diversutils, name) for name in dir(diversutils) if name.startswith("DF_")]
+    g_many, _ = _random_graph(3, 150, 8)
+    g_single, _ = _random_graph(3, 150, 8)
+    for params in ({}, {"alpha": 2.0, "beta": 3.0}):
+        values, seconds, shared_seconds = diversutils.measure_many(g_many, ids, params, num_threads=2, timings=True)
+        assert (values.dtype == np.float64 and values.shape == (len(ids), 2)), "unexpected shape of measure_many"
+        assert (seconds.shape == (len(ids),) and np.all(seconds >= 0.0) and shared_seconds >= 0.0), "unexpected timings"
+        for row, i in zip(values, ids):
+            expected = diversutils.individual_measure(g_single, i, params.get("alpha", 1.0), params.get("beta", 1.0))
+            assert (np.allclose(row[~np.isnan(row)], expected, rtol=1e-12)), f"measure_many differs from individual_measure for {i}"
+    assert (diversutils.measure_many(g_many, []).shape == (0, 2)), "empty measure_many"
+    with pytest.raises(ValueError):
+        diversutils.measure_many(g_many, ids, {"gamma": 1.0})
+    with pytest.raises(Exception):
+        diversutils.measure_many(g_many, [-1])
+    assert (diversutils.free_graph(g_many) == 0 and diversutils.free_graph(g_single) == 0), "failed to free graph"
+
+_FIXTURE_WORDS = [f"w{i}" for i in range(30)]
+
+def _write_fixtures(directory, num_files=4):
+    rng = np.random.default_rng(5)
+    w2v_path = directory / "vectors.bin"
+    with open(w2v_path, "wb") as f:
+        f.write(f"{len(_FIXTURE_WORDS)} 8\n".encode())
+        for word in _FIXTURE_WORDS:
+            f.write(word.encode() + b" " + rng.random(8, dtype=np.float32).tobytes() + b"\n")
+    paths = []
+    for k in range(num_files):
+        if k % 2 == 0:
+            path = directory / f"corpus{k}.jsonl"
+            with open(path, "w") as f:
+                for d in range(5 + 3 * k):
+                    tokens = [_FIXTURE_WORDS[(k * 7 + d * 11 + t * t) % len(_FIXTURE_WORDS)] for t in range(12)] + [f"oov{k}"]
+                    f.write(json.dumps({"id": f"{k}-{d}", "text": " ".join(tokens)}) + "\n")
+        else:
+            path = directory / f"corpus{k}.cupt"
+            with open(path, "w") as f:
+                f.write("# global.columns = ID FORM LEMMA UPOS XPOS FEATS HEAD DEPREL DEPS MISC PARSEME:MWE\n")
+                for s in range(6 + 2 * k):
+                    f.write(f"# sent_id = {k}-{s}\n")
+                    for t in range(8):
+                        word = _FIXTURE_WORDS[(k * 5 + s * 3 + t * 7) % len(_FIXTURE_WORDS)]
+                        f.write(f"{t + 1}\t{word}\t{word}\tNOUN\t_\t_\t0\troot\t_\t_\t*\n")
+                    f.write("\n")
+        paths.append(str(path))
+    return str(w2v_path), paths
+
+_SCORE_FUNCTIONS = ("DF_ENTROPY_SHANNON_WEAVER", "DF_INDEX_RICHNESS", "DF_DISPARITY_PAIRWISE", "DF_DISPARITY_STIRLING", "DF_DISPARITY_AGG_MST")
+
+def _score_values(record):
+    return [v for f in _SCORE_FUNCTIONS for v in record[f] if not math.isnan(v)]
+
+def test_score_files(tmp_path):
+    w2v_path, paths = _write_fixtures(tmp_path)
+    w2v_index = diversutils.load_w2v(w2v_path)
+    functions = [getattr(diversutils, f) for f in _SCORE_FUNCTIONS]
+
+    scores = diversutils.score_files(paths, functions, w2v_index, target_column=1)
+    assert (len(scores) == len(paths) and list(scores.path) == paths), "one row per file expected"
+    for record, path in zip(scores, paths):
+        expected = [v for r in diversutils.score_file([path], [], functions, w2v_index, 1) for v in r]
+        assert (np.allclose(_score_values(record), expected, rtol=1e-9)), f"score_files differs from score_file for {path}"
+        assert (record.num_nodes > 0 and record.num_oov_types == (1 if path.endswith(".jsonl") else 0)), f"unexpected counters for {path}"
+        assert ((record.num_documents > 0) if path.endswith(".jsonl") else (record.num_sentences > 0)), f"unexpected counters for {path}"
+
+    concurrent = diversutils.score_files(paths, functions, w2v_index, target_column=1, num_threads=4)
+    for s, c in zip(scores, concurrent):
+        assert (s.num_nodes == c.num_nodes and np.allclose(_score_values(s), _score_values(c), rtol=1e-9)), "concurrent reading differs from serial reading"
+
+    shared = diversutils.score_files(paths, functions, w2v_index, target_column=1, shared=True, num_threads=4)
+    expected = [v for r in diversutils.score_file(paths, [], functions, w2v_index, 1) for v in r]
+    assert (len(shared) == 1 and shared[0].path is None), "one row expected for the shared graph"
+    assert (shared[0].num_nodes == len(_FIXTURE_WORDS) and np.allclose(_score_values(shared[0]), expected, rtol=1e-9)), "shared graph differs from score_file"
+    assert (shared[0].num_documents == sum(scores.num_documents) and shared[0].num_sentences == sum(scores.num_sentences)), "shared counters differ from per-file ones"
+    assert (diversutils.free_w2v(w2v_index) == 0), "failed to free w2v"
+
+def test_score_files_callback(tmp_path):
+    w2v_path, paths = _write_fixtures(tmp_path)
+    w2v_index = diversutils.load_w2v(w2v_path)
+    functions = [diversutils.DF_INDEX_RICHNESS, diversutils.DF_DISPARITY_PAIRWISE]
+
+    steps = []
+    final = diversutils.score_files(paths, functions, w2v_index, target_column=1, num_threads=2, step=2, callback=steps.append)
+    assert (len(steps) > 0), "callback never called"
+    for record in steps:
+        assert (record.path in paths and record.num_nodes > 0), "unexpected row in callback"
+        assert ((record.num_documents if record.path.endswith(".jsonl") else record.num_sentences) % 2 == 0), "callback called outside of a step"
+        last = final[paths.index(record.path)]
+        assert (record.num_nodes <= last.num_nodes and record.DF_INDEX_RICHNESS[0] <= last.DF_INDEX_RICHNESS[0]), "step after the end of its file"
+    assert (diversutils.score_files(paths, functions, w2v_index, target_column=1, step=2).shape == (len(paths),)), "steps without callback"
+
+    def fail(record):
+        raise KeyError("stop")
+    with pytest.raises(KeyError):
+        diversutils.score_files(paths, functions, w2v_index, target_column=1, num_threads=2, step=1, callback=fail)
+    assert (diversutils.free_w2v(w2v_index) == 0), "failed to free w2v"
+
+def _fresh_measures(vectors, counts, ids):
+    g_index = diversutils.create_empty_graph(0, vectors.shape[1])
+    diversutils.add_nodes(g_index, vectors, counts)
+    diversutils.compute_relative_proportion(g_index)
+    values = diversutils.measure_many(g_index, ids)
+    matrix = diversutils.distance_matrix(g_index).copy()
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+    return values, matrix
+
+def test_cached_matrix_and_mst_match_fresh_computation():
+    rng = np.random.default_rng(7)
+    num_dimensions = 6
+    ids = [getattr(diversutils, name) for name in dir(diversutils) if name.startswith("DF_")]
+    g_index = diversutils.create_empty_graph(0, num_dimensions)
+    vectors = rng.random((3, num_dimensions), dtype=np.float32)
+    counts = rng.integers(1, 20, size=3)
+    diversutils.add_nodes(g_index, vectors, counts)
+
+    for _ in range(40):
+        operation = rng.integers(0, 3)
+        if operation == 0:
+            k = int(rng.integers(1, 6))
+            new_vectors = rng.random((k, num_dimensions), dtype=np.float32)
+            new_counts = rng.integers(1, 20, size=k)
+            diversutils.add_nodes(g_index, new_vectors, new_counts)
+            vectors = np.concatenate([vectors, new_vectors])
+            counts = np.concatenate([counts, new_counts])
+        elif operation == 1:
+            indices = rng.integers(0, len(counts), size=4)
+            deltas = rng.integers(0, 5, size=4)
+            before = diversutils.distance_matrix(g_index).__array_interface__["data"][0]
+            diversutils.update_counts(g_index, indices, deltas)
+            np.add.at(counts, indices, deltas)
+            assert (diversutils.distance_matrix(g_index).__array_interface__["data"][0] == before), "update_counts replaced the distance matrix"
+        diversutils.compute_relative_proportion(g_index)
+        values = diversutils.measure_many(g_index, ids, num_threads=int(rng.integers(1, 4)))
+        expected_values, expected_matrix = _fresh_measures(vectors, counts, ids)
+        assert (np.allclose(values, expected_values, rtol=1e-6, equal_nan=True)), f"cached measures differ from fresh ones with {len(counts)} nodes"
+        assert (np.array_equal(diversutils.distance_matrix(g_index), expected_matrix)), f"cached matrix differs from fresh one with {len(counts)} nodes"
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+
+def _ingest_texts(seed, num_documents):
+    rng = np.random.default_rng(seed)
+    words = _FIXTURE_WORDS + ["oov", "Unknown"]
+    return [" ".join(words[i] for i in rng.integers(0, len(words), size=int(rng.integers(0, 20)))) + rng.choice(["", ".", " !"]) for _ in range(num_documents)]
+
+def test_ingest_matches_files(tmp_path):
+    w2v_path, _ = _write_fixtures(tmp_path, num_files=0)
+    w2v_index = diversutils.load_w2v(w2v_path)
+    texts = _ingest_texts(11, 200)
+    path = tmp_path / "texts.jsonl"
+    with open(path, "w") as f:
+        for d, text in enumerate(texts):
+            f.write(json.dumps({"id": str(d), "text": text}) + "\n")
+    expected = diversutils.score_files([str(path)], [diversutils.DF_INDEX_RICHNESS, diversutils.DF_ENTROPY_SHANNON_WEAVER], w2v_index, target_column=1)[0]
+
+    g_documents = diversutils.create_empty_graph(0, 8)
+    diversutils.bind_w2v(g_documents, w2v_index)
+    num_documents, num_oov = diversutils.ingest_documents(g_documents, iter(texts), batch_size=7)
+    assert (num_documents == len(texts) and num_oov > 0), "unexpected ingest_documents counters"
+    diversutils.compute_relative_proportion(g_documents)
+    assert (diversutils.individual_measure(g_documents, diversutils.DF_INDEX_RICHNESS)[0] == expected.DF_INDEX_RICHNESS[0]), "ingest_documents differs from the file"
+    assert (np.allclose(diversutils.individual_measure(g_documents, diversutils.DF_ENTROPY_SHANNON_WEAVER), expected.DF_ENTROPY_SHANNON_WEAVER, rtol=1e-12)), "ingest_documents differs from the file"
+
+    # one token per document, so that the tokenizer of the file path leaves every token as it is
+    tokens = [t for text in texts for t in text.replace(".", " ").replace("!", " ").split()]
+    with open(path, "w") as f:
+        for d, token in enumerate(tokens):
+            f.write(json.dumps({"id": str(d), "text": token}) + "\n")
+    g_file = diversutils.score_files([str(path)], [diversutils.DF_ENTROPY_SHANNON_WEAVER], w2v_index, target_column=1)[0]
+    g_tokens = diversutils.create_empty_graph(0, 8)
+    diversutils.bind_w2v(g_tokens, w2v_index)
+    # a graph with nodes already added by key keeps them
+    diversutils.add_nodes(g_tokens, None, [1], [_FIXTURE_WORDS[0]])
+    diversutils.update_counts(g_tokens, [0], [-1])
+    assert (diversutils.ingest_tokens(g_tokens, (t for t in tokens), batch_size=50) == (len(tokens), tokens.count("oov") + tokens.count("Unknown"))), "unexpected ingest_tokens counters"
+    diversutils.compute_relative_proportion(g_tokens)
+    assert (np.allclose(diversutils.individual_measure(g_tokens, diversutils.DF_ENTROPY_SHANNON_WEAVER), g_file.DF_ENTROPY_SHANNON_WEAVER, rtol=1e-12)), "ingest_tokens differs from the file"
+    # tokens of nodes already in the graph reach the next measure without compute_relative_proportion
+    before = diversutils.individual_measure(g_tokens, diversutils.DF_ENTROPY_SHANNON_WEAVER)
+    diversutils.ingest_tokens(g_tokens, [_FIXTURE_WORDS[0]] * 50)
+    after = diversutils.individual_measure(g_tokens, diversutils.DF_ENTROPY_SHANNON_WEAVER)
+    diversutils.compute_relative_proportion(g_tokens)
+    assert (after != before and np.allclose(after, diversutils.individual_measure(g_tokens, diversutils.DF_ENTROPY_SHANNON_WEAVER), rtol=1e-12)), "measure ignores ingest_tokens"
+
+    with pytest.raises(TypeError):
+        diversutils.ingest_tokens(g_tokens, ["w1", 2])
+    g_unbound = diversutils.create_empty_graph(0, 8)
+    with pytest.raises(Exception):
+        diversutils.ingest_tokens(g_unbound, ["w1"])
+    for g_index in (g_documents, g_tokens, g_unbound):
+        assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+    assert (diversutils.free_w2v(w2v_index) == 0), "failed to free w2v"
+
+def test_benchmark_ingest_documents(tmp_path):
+    import time
+    w2v_path, _ = _write_fixtures(tmp_path, num_files=0)
+    w2v_index = diversutils.load_w2v(w2v_path)
+    texts = _ingest_texts(12, 20000)
+
+    start = time.perf_counter()
+    path = tmp_path / "texts.jsonl"
+    with open(path, "w") as f:
+        for d, text in enumerate(texts):
+            f.write(json.dumps({"id": str(d), "text": text}) + "\n")
+    diversutils.score_files([str(path)], [diversutils.DF_INDEX_RICHNESS], w2v_index, target_column=1)
+    time_file = time.perf_counter() - start
+
+    start = time.perf_counter()
+    g_index = diversutils.create_empty_graph(0, 8)
+    diversutils.bind_w2v(g_index, w2v_index)
+    diversutils.ingest_documents(g_index, texts)
+    diversutils.compute_relative_proportion(g_index)
+    diversutils.individual_measure(g_index, diversutils.DF_INDEX_RICHNESS)
+    time_ingest = time.perf_counter() - start
+
+    print(f"{len(texts)} documents: temporary file {time_file:.4f} s; ingest_documents {time_ingest:.4f} s; speedup {time_file / time_ingest:.1f}x")
+    assert (time_ingest < time_file), "ingest_documents slower than a temporary file"
+    assert (diversutils.free_graph(g_index) == 0), "failed to free graph"
+    assert (diversutils.free_w2v(w2v_index) == 0), "failed to free w2v"
@@ -24,7 +24,7 @@ setup(
         Extension(
             name="_diversutils",
             sources=[f"diversutils/{'src' if ENABLE_LIB else 'build'}/_diversutilsmodule.c"],
-            include_dirs=["diversutils/src/include"],
+            include_dirs=["diversutils/src/include", "diversutils/build"],
             define_macros=[("ENABLE_AVX256", "0"), ("ENABLE_AVX512", "0"), ("TOKENIZATION_METHOD", "0")],
             library_dirs=[f"{os.environ['HOME']}/.local/lib/diversutils"] if ENABLE_LIB or ENABLE_UDPIPE else [],
             libraries=["m", "rt"] + (["diversutils"] if ENABLE_LIB else []) + (["udpipe"] if ENABLE_UDPIPE else []),